@@ -0,0 +1,61 @@
+
+#include "bench.h"
+
+#include <rpp/arena.h>
+
+i32 main(i32 argc, char** argv) {
+    Bench bench{"allocators"_v, argc, argv};
+
+    constexpr u64 N = 10000;
+    Vec<void*> blocks(N);
+
+    bench.run("Mdefault 64B"_v, N, [&]() {
+        for(u64 i = 0; i < N; i++) blocks.push(Mdefault::alloc(64));
+        for(void* block : blocks) Mdefault::free(block);
+        blocks.clear();
+    });
+    bench.run("Mdefault 4KB"_v, N, [&]() {
+        for(u64 i = 0; i < N; i++) blocks.push(Mdefault::alloc(4096));
+        for(void* block : blocks) Mdefault::free(block);
+        blocks.clear();
+    });
+    bench.run("Mpool 64B"_v, N, [&]() {
+        struct Block {
+            u8 data[64];
+        };
+        for(u64 i = 0; i < N; i++) blocks.push(Mpool::make<Block>());
+        for(void* block : blocks) Mpool::destroy(reinterpret_cast<Block*>(block));
+        blocks.clear();
+    });
+    bench.run("Region 64B"_v, N, [&]() {
+        Region(R) {
+            for(u64 i = 0; i < N; i++) blocks.push(Mregion<R>::alloc(64));
+            keep(blocks.back());
+        }
+        blocks.clear();
+    });
+    bench.run("Region Vec"_v, N, [&]() {
+        Region(R) {
+            Vec<u64, Mregion<R>> vec;
+            for(u64 i = 0; i < N; i++) vec.push(i);
+            keep(vec.back());
+        }
+    });
+
+    Linear_Arena<> arena;
+    bench.run("Linear_Arena 64B"_v, N, [&]() {
+        for(u64 i = 0; i < N; i++) blocks.push(arena.alloc(64));
+        keep(blocks.back());
+        arena.reset();
+        blocks.clear();
+    });
+    bench.run("Linear_Arena Vec"_v, N, [&]() {
+        {
+            Vec<u64, Marena<Linear_Arena<>>> vec{Marena{arena}};
+            for(u64 i = 0; i < N; i++) vec.push(i);
+            keep(vec.back());
+        }
+        arena.reset();
+    });
+    return 0;
+}
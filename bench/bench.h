@@ -0,0 +1,221 @@
+
+#include <rpp/base.h>
+#include <rpp/files.h>
+#include <rpp/sort.h>
+
+using namespace rpp;
+
+// Keeps the compiler from discarding a computed value or the stores leading up to it.
+template<typename T>
+RPP_FORCE_INLINE void keep(const T& value) noexcept {
+#ifdef RPP_COMPILER_MSVC
+    static_cast<void>(*reinterpret_cast<const volatile u8*>(&value));
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+// Times each benchmark over a few warmup runs and then a number of repetitions, reporting
+// nanoseconds per operation. Options:
+//   --reps N, --warmup N   repetition counts
+//   --filter TEXT          only run benchmarks whose name contains TEXT
+//   --counters             read hardware counters through a Profile frame around the repetitions
+//   --csv PATH             also write the results as CSV, one row per benchmark
+// A suite names its own options in suite_flags and queries them with flag(); any other option is
+// rejected.
+struct Bench {
+    using Alloc = Mallocator<"Bench">;
+
+    struct Result {
+        String<Alloc> name;
+        u64 threads = 1;
+        u64 ops = 0;
+        u64 samples = 0;
+        // Nanoseconds per operation.
+        f64 min = 0.0, p50 = 0.0, p99 = 0.0, p999 = 0.0, max = 0.0;
+        f64 mean = 0.0, stddev = 0.0;
+        f64 ops_per_second = 0.0;
+        // Per operation, when counters are enabled and the platform provides them.
+        f64 cycles = 0.0, instructions = 0.0, cache_misses = 0.0, branch_misses = 0.0;
+    };
+
+    explicit Bench(String_View suite, i32 argc, char** argv,
+                   Slice<String_View> suite_flags = Slice<String_View>{}) noexcept
+        : suite(suite) {
+        for(i32 i = 1; i < argc; i++) {
+            String_View arg{argv[i]};
+            bool has_value = i + 1 < argc;
+            if(arg == "--counters"_v) {
+                counters = true;
+            } else if(arg == "--reps"_v && has_value) {
+                repetitions = count(argv[++i], 1);
+            } else if(arg == "--warmup"_v && has_value) {
+                warmup = count(argv[++i], 0);
+            } else if(arg == "--filter"_v && has_value) {
+                filter = String_View{argv[++i]};
+            } else if(arg == "--csv"_v && has_value) {
+                csv = String_View{argv[++i]};
+            } else if(known(suite_flags, arg)) {
+                flags.push(arg);
+            } else {
+                die("Unknown benchmark option %.", arg);
+            }
+        }
+        if(counters) Profile::set_counters(true);
+    }
+
+    ~Bench() noexcept {
+        if(csv.empty()) return;
+        Vec<u8, Alloc> out;
+        append(out, "suite,name,threads,ops,samples,min_ns,p50_ns,p99_ns,p999_ns,max_ns,mean_ns,"
+                    "stddev_ns,ops_per_second,cycles,instructions,cache_misses,branch_misses\n"_v);
+        for(const Result& r : results) {
+            append(out, format<Alloc>("%,%,%,%,%,%,%,%,%,%,%,%,%,%,%,%,%\n"_v, suite, r.name,
+                                      r.threads, r.ops, r.samples, r.min, r.p50, r.p99, r.p999,
+                                      r.max, r.mean, r.stddev, r.ops_per_second, r.cycles,
+                                      r.instructions, r.cache_misses, r.branch_misses)
+                            .view());
+        }
+        if(!Files::write(csv, out.slice())) warn("Failed to write %.", csv);
+    }
+
+    Bench(const Bench&) noexcept = delete;
+    Bench& operator=(const Bench&) noexcept = delete;
+
+    Bench(Bench&&) noexcept = delete;
+    Bench& operator=(Bench&&) noexcept = delete;
+
+    [[nodiscard]] bool enabled(String_View name) const noexcept {
+        return filter.empty() || name.find(filter).ok();
+    }
+    [[nodiscard]] bool flag(String_View name) const noexcept {
+        for(String_View f : flags) {
+            if(f == name) return true;
+        }
+        return false;
+    }
+
+    // Each call of f performs ops operations; every repetition is one sample.
+    template<typename F>
+        requires Invocable<F>
+    void run(String_View name, u64 ops, F&& f) noexcept {
+        run(name, 1, ops, rpp::forward<F>(f));
+    }
+    // Same, but labels the result with the number of threads f spreads its work over.
+    template<typename F>
+        requires Invocable<F>
+    void run(String_View name, u64 threads, u64 ops, F&& f) noexcept {
+        if(!enabled(name)) return;
+
+        for(u64 i = 0; i < warmup; i++) f();
+
+        Vec<f64, Alloc> times(repetitions);
+        Profile::Counters total;
+        Profile::Time_Point elapsed = 0;
+        auto measure = [&]() {
+            for(u64 i = 0; i < repetitions; i++) {
+                Profile::Time_Point begin = Profile::timestamp();
+                f();
+                Profile::Time_Point end = Profile::timestamp();
+                elapsed += end - begin;
+                times.push(nanoseconds(end - begin) / static_cast<f64>(ops));
+            }
+        };
+        if(counters) {
+            Profile::begin_frame();
+            Trace(name) {
+                measure();
+            }
+            Profile::end_frame();
+            Thread::Id self = Thread::this_id();
+            Profile::iterate_timings([&](Thread::Id id, const Profile::Timing_Node& node) {
+                if(id == self && node.loc.function == name) total = node.heir_counters;
+            });
+        } else {
+            measure();
+        }
+
+        report(name, threads, ops * repetitions, times, elapsed, total);
+    }
+
+    // Records a benchmark measured by the suite itself: one latency sample per operation, in
+    // nanoseconds, over elapsed wall time on the given number of threads.
+    void report(String_View name, u64 threads, u64 ops, Vec<f64, Alloc>& samples,
+                Profile::Time_Point elapsed, const Profile::Counters& total = {}) noexcept {
+        if(samples.empty()) return;
+        Sort::sort(samples);
+
+        Result r;
+        r.name = name.string<Alloc>();
+        r.threads = threads;
+        r.ops = ops;
+        r.samples = samples.length();
+        r.min = samples[0];
+        r.max = samples.back();
+        r.p50 = percentile(samples, 0.5);
+        r.p99 = percentile(samples, 0.99);
+        r.p999 = percentile(samples, 0.999);
+        for(f64 t : samples) r.mean += t;
+        r.mean /= static_cast<f64>(samples.length());
+        for(f64 t : samples) r.stddev += (t - r.mean) * (t - r.mean);
+        r.stddev = Math::sqrt(r.stddev / static_cast<f64>(samples.length()));
+        if(elapsed) r.ops_per_second = static_cast<f64>(ops) / (nanoseconds(elapsed) / 1e9);
+
+        f64 per = static_cast<f64>(ops);
+        r.cycles = static_cast<f64>(total.cycles) / per;
+        r.instructions = static_cast<f64>(total.instructions) / per;
+        r.cache_misses = static_cast<f64>(total.cache_misses) / per;
+        r.branch_misses = static_cast<f64>(total.branch_misses) / per;
+
+        print(r);
+        results.push(rpp::move(r));
+    }
+
+    [[nodiscard]] static f64 nanoseconds(Profile::Time_Point duration) noexcept {
+        return static_cast<f64>(duration) * 1e9 / static_cast<f64>(Thread::perf_frequency());
+    }
+
+    String_View suite;
+    String_View filter;
+    String_View csv;
+    u64 warmup = 3;
+    u64 repetitions = 15;
+    bool counters = false;
+    Vec<String_View, Alloc> flags;
+    Vec<Result, Alloc> results;
+
+private:
+    // Nearest rank, so p999 of fewer than 1000 samples is the maximum.
+    [[nodiscard]] static f64 percentile(const Vec<f64, Alloc>& sorted, f64 p) noexcept {
+        u64 rank = static_cast<u64>(Math::ceil(p * static_cast<f64>(sorted.length())));
+        return sorted[Math::clamp<u64>(rank, 1, sorted.length()) - 1];
+    }
+
+    void print(const Result& r) const noexcept {
+        if(counters) {
+            info("%/% (% threads): p50 % ns, p99 %, mean % +- %, % ops/s (% cycles, % "
+                 "instructions)",
+                 suite, r.name, r.threads, r.p50, r.p99, r.mean, r.stddev, r.ops_per_second,
+                 r.cycles, r.instructions);
+        } else {
+            info("%/% (% threads): p50 % ns, p99 %, mean % +- %, % ops/s", suite, r.name,
+                 r.threads, r.p50, r.p99, r.mean, r.stddev, r.ops_per_second);
+        }
+    }
+
+    [[nodiscard]] static bool known(Slice<String_View> suite_flags, String_View arg) noexcept {
+        for(String_View f : suite_flags) {
+            if(f == arg) return true;
+        }
+        return false;
+    }
+
+    [[nodiscard]] static u64 count(const char* arg, i64 least) noexcept {
+        return static_cast<u64>(Math::max(Libc::strtoll(arg, null, 10), least));
+    }
+
+    static void append(Vec<u8, Alloc>& out, String_View text) noexcept {
+        for(u8 c : text) out.push(c);
+    }
+};
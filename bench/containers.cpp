@@ -0,0 +1,72 @@
+
+#include "bench.h"
+
+#include <rpp/rng.h>
+#include <rpp/swiss_map.h>
+
+i32 main(i32 argc, char** argv) {
+    Bench bench{"containers"_v, argc, argv};
+
+    constexpr u64 N = 100000;
+
+    Vec<u64> keys(N);
+    RNG::Stream rng{1};
+    for(u64 i = 0; i < N; i++) keys.push(rng.range(u64{0}, u64{1} << 40));
+
+    bench.run("Vec push"_v, N, [&]() {
+        Vec<u64> vec;
+        for(u64 i = 0; i < N; i++) vec.push(i);
+        keep(vec.back());
+    });
+    bench.run("Vec reserved push"_v, N, [&]() {
+        Vec<u64> vec(N);
+        for(u64 i = 0; i < N; i++) vec.push(i);
+        keep(vec.back());
+    });
+    bench.run("Queue push pop"_v, N, [&]() {
+        Queue<u64> queue;
+        u64 sum = 0;
+        for(u64 i = 0; i < N; i++) {
+            queue.push(u64{i});
+            if(queue.length() > 64) {
+                sum += queue.front();
+                queue.pop();
+            }
+        }
+        keep(sum);
+    });
+
+    Map<u64, u64> map;
+    Swiss_Map<u64, u64> swiss;
+    for(u64 key : keys) {
+        map.insert(key, key);
+        swiss.insert(key, key);
+    }
+
+    bench.run("Map insert"_v, N, [&]() {
+        Map<u64, u64> m;
+        for(u64 key : keys) m.insert(key, key);
+        keep(m.length());
+    });
+    bench.run("Map get"_v, N, [&]() {
+        u64 sum = 0;
+        for(u64 key : keys) sum += **map.try_get(key);
+        keep(sum);
+    });
+    bench.run("Map miss"_v, N, [&]() {
+        u64 found = 0;
+        for(u64 key : keys) found += map.try_get(key + (u64{1} << 41)).ok();
+        keep(found);
+    });
+    bench.run("Swiss_Map insert"_v, N, [&]() {
+        Swiss_Map<u64, u64> m;
+        for(u64 key : keys) m.insert(key, key);
+        keep(m.length());
+    });
+    bench.run("Swiss_Map get"_v, N, [&]() {
+        u64 sum = 0;
+        for(u64 key : keys) sum += **swiss.try_get(key);
+        keep(sum);
+    });
+    return 0;
+}
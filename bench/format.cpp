@@ -0,0 +1,34 @@
+
+#include "bench.h"
+
+i32 main(i32 argc, char** argv) {
+    Bench bench{"format"_v, argc, argv};
+
+    constexpr u64 N = 10000;
+
+    bench.run("u64"_v, N, [&]() {
+        for(u64 i = 0; i < N; i++) keep(format<Mdefault>("%"_v, i * 7919).length());
+    });
+    bench.run("f64"_v, N, [&]() {
+        for(u64 i = 0; i < N; i++) {
+            keep(format<Mdefault>("%"_v, static_cast<f64>(i) * 1.37).length());
+        }
+    });
+    bench.run("String_View"_v, N, [&]() {
+        for(u64 i = 0; i < N; i++) {
+            keep(format<Mdefault>("name: %, id: %"_v, "benchmark"_v, i).length());
+        }
+    });
+    bench.run("Vec"_v, N, [&]() {
+        Vec<u64> vec{1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u};
+        for(u64 i = 0; i < N; i++) keep(format<Mdefault>("%"_v, vec).length());
+    });
+    bench.run("Region u64"_v, N, [&]() {
+        for(u64 i = 0; i < N; i++) {
+            Region(R) {
+                keep(format<Mregion<R>>("%"_v, i * 7919).length());
+            }
+        }
+    });
+    return 0;
+}
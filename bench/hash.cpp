@@ -0,0 +1,34 @@
+
+#include "bench.h"
+
+i32 main(i32 argc, char** argv) {
+    Bench bench{"hash"_v, argc, argv};
+
+    constexpr u64 N = 100000;
+
+    bench.run("u64"_v, N, [&]() {
+        u64 h = 0;
+        for(u64 i = 0; i < N; i++) h ^= hash(i);
+        keep(h);
+    });
+    bench.run("hash_combine"_v, N, [&]() {
+        u64 h = 0;
+        for(u64 i = 0; i < N; i++) h = hash_combine(h, i);
+        keep(h);
+    });
+
+    String<> text{256};
+    text.set_length(256);
+    for(u64 i = 0; i < text.length(); i++) text[i] = static_cast<u8>('a' + i % 26);
+
+    for(u64 length : {8, 64, 256}) {
+        String_View view = text.view().sub(0, length);
+        String<> name = format<Mdefault>("String_View % bytes"_v, length);
+        bench.run(name.view(), N, [&]() {
+            u64 h = 0;
+            for(u64 i = 0; i < N; i++) h ^= hash(view);
+            keep(h);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,246 @@
+
+#include "bench.h"
+
+#include <rpp/asyncio.h>
+#include <rpp/channel.h>
+
+using Sched_Pool = Async::Pool<>;
+using Samples = Vec<f64, Bench::Alloc>;
+using Pipe = Async::Channel<u64, 1>;
+
+// Each task spawns ten children until a leaf, and the leaves return their ids.
+[[nodiscard]] static Async::Task<u64> skynet(Sched_Pool& pool, u64 id, u64 size) noexcept {
+    co_await pool.suspend();
+    if(size == 1) co_return id;
+    Vec<Async::Task<u64>, Bench::Alloc> children(10);
+    u64 step = size / 10;
+    for(u64 i = 0; i < 10; i++) children.push(skynet(pool, id + i * step, step));
+    u64 sum = 0;
+    for(Async::Task<u64>& child : children) sum += co_await child;
+    co_return sum;
+}
+
+[[nodiscard]] static Async::Task<void> pong(Sched_Pool& pool, Pipe& in, Pipe& out) noexcept {
+    co_await pool.suspend();
+    for(;;) {
+        Opt<u64> value = co_await in.recv();
+        if(!value.ok() || !co_await out.send(*value)) break;
+    }
+    out.close();
+}
+
+[[nodiscard]] static Async::Task<void> ping(Sched_Pool& pool, Pipe& out, Pipe& in, u64 rounds,
+                                            Samples& samples) noexcept {
+    co_await pool.suspend();
+    for(u64 i = 0; i < rounds; i++) {
+        Profile::Time_Point begin = Profile::timestamp();
+        if(!co_await out.send(i)) break;
+        if(!(co_await in.recv()).ok()) break;
+        samples.push(Bench::nanoseconds(Profile::timestamp() - begin));
+    }
+    out.close();
+}
+
+// One exchange between a ping and a pong task; the frame keeps both channels alive.
+[[nodiscard]] static Async::Task<void> rally(Sched_Pool& pool, u64 rounds,
+                                             Samples& samples) noexcept {
+    Pipe there{pool}, back{pool};
+    Async::Task<void> server = pong(pool, there, back);
+    Async::Task<void> client = ping(pool, there, back, rounds, samples);
+    co_await client;
+    co_await server;
+}
+
+// Records how much later than requested the timer resumed the task.
+[[nodiscard]] static Async::Task<void> sleep(Sched_Pool& pool, u64 ms, f64& late) noexcept {
+    Profile::Time_Point begin = Profile::timestamp();
+    co_await Async::wait(pool, ms);
+    late = Bench::nanoseconds(Profile::timestamp() - begin) - static_cast<f64>(ms) * 1e6;
+}
+
+// Each datagram carries the timestamp it was sent at.
+[[nodiscard]] static Async::Task<void> wake(Sched_Pool& pool, Net::Udp& udp, u64 rounds,
+                                            Samples& samples, Thread::Atomic& received) noexcept {
+    Net::Packet packet;
+    for(u64 i = 0; i < rounds; i++) {
+        Net::Udp::Data data = co_await Async::recv(pool, udp, packet);
+        Profile::Time_Point now = Profile::timestamp();
+        Profile::Time_Point sent = 0;
+        if(data.length == sizeof(sent)) {
+            Libc::memcpy(&sent, packet.data(), sizeof(sent));
+            samples.push(Bench::nanoseconds(now - sent));
+        }
+        received.incr();
+    }
+}
+
+// Echoes datagrams back to their sender until one shorter than a u64 arrives.
+[[nodiscard]] static Async::Task<void> echo(Sched_Pool& pool, Net::Udp& udp) noexcept {
+    Net::Packet packet;
+    for(;;) {
+        Net::Udp::Data data = co_await Async::recv(pool, udp, packet);
+        if(data.length < sizeof(u64)) break;
+        u64 sent = co_await Async::send(pool, udp, data.from, packet, data.length);
+        keep(sent);
+    }
+}
+
+[[nodiscard]] static Async::Task<void> call(Sched_Pool& pool, Net::Udp& udp, Net::Address server,
+                                            u64 rounds, Samples& samples) noexcept {
+    Net::Packet packet;
+    for(u64 i = 0; i < rounds; i++) {
+        Profile::Time_Point begin = Profile::timestamp();
+        Libc::memcpy(packet.data(), &i, sizeof(i));
+        u64 sent = co_await Async::send(pool, udp, server, packet, sizeof(i));
+        Net::Udp::Data data = co_await Async::recv(pool, udp, packet);
+        keep(sent + data.length);
+        samples.push(Bench::nanoseconds(Profile::timestamp() - begin));
+    }
+    u64 sent = co_await Async::send(pool, udp, server, packet, 1);
+    keep(sent);
+}
+
+// Runs f(samples) for the warmup passes and then once more, reporting one sample per operation.
+template<typename F>
+    requires Invocable<F, Samples&>
+static void latency(Bench& bench, String_View name, u64 threads, F&& f) noexcept {
+    if(!bench.enabled(name)) return;
+    Samples samples;
+    for(u64 i = 0; i < bench.warmup; i++) {
+        samples.clear();
+        f(samples);
+    }
+    samples.clear();
+    Profile::Time_Point begin = Profile::timestamp();
+    f(samples);
+    Profile::Time_Point elapsed = Profile::timestamp() - begin;
+    bench.report(name, threads, samples.length(), samples, elapsed);
+}
+
+struct Sched_Variant {
+    u64 threads = 1;
+    u64 event_threads = 1;
+    Async::Placement placement = Async::Placement::threads;
+};
+
+[[nodiscard]] static String<Bench::Alloc> label(String_View name, const Sched_Variant& v) noexcept {
+    String_View pinned = v.placement == Async::Placement::none ? "unpinned"_v : "pinned"_v;
+    return format<Bench::Alloc>("%/events %/%"_v, name, v.event_threads, pinned);
+}
+
+static void run(Bench& bench, const Sched_Variant& v, u16 port, String_View file) noexcept {
+    Sched_Pool pool{Async::Pool_Config{
+        .threads = v.threads, .event_threads = v.event_threads, .placement = v.placement}};
+    u64 threads = v.threads;
+
+    constexpr u64 LEAVES = 100000;
+    // Six levels of ten-way fan-out: 1 + 10 + ... + 100000 tasks.
+    constexpr u64 TASKS = 111111;
+    bench.run(label("Skynet"_v, v).view(), threads, TASKS, [&]() {
+        u64 sum = skynet(pool, 0, LEAVES).block();
+        assert(sum == LEAVES * (LEAVES - 1) / 2);
+    });
+
+    // One ping and pong pair per worker, so the exchanges contend for the scheduler.
+    latency(bench, label("Ping pong"_v, v).view(), threads, [&](Samples& samples) {
+        Vec<Samples, Bench::Alloc> each = Vec<Samples, Bench::Alloc>::make(threads);
+        Vec<Async::Task<void>, Bench::Alloc> tasks(threads);
+        for(u64 i = 0; i < threads; i++) tasks.push(rally(pool, 10000, each[i]));
+        for(Async::Task<void>& task : tasks) task.block();
+        for(Samples& s : each) {
+            for(f64 t : s) samples.push(t);
+        }
+    });
+
+    latency(bench, label("Timers"_v, v).view(), threads, [&](Samples& samples) {
+        constexpr u64 TIMERS = 1000;
+        Samples late = Samples::make(TIMERS);
+        Vec<Async::Task<void>, Bench::Alloc> tasks(TIMERS);
+        for(u64 i = 0; i < TIMERS; i++) tasks.push(sleep(pool, 1 + i % 4, late[i]));
+        for(Async::Task<void>& task : tasks) task.block();
+        for(f64 t : late) samples.push(t);
+    });
+
+    // The main thread sends each datagram once the previous one was received, so every sample
+    // is one wakeup of a task parked in the reactor.
+    latency(bench, label("Event wakeup"_v, v).view(), threads, [&](Samples& samples) {
+        constexpr u64 ROUNDS = 5000;
+        Net::Address address{"127.0.0.1"_v, port};
+        Net::Udp receiver, sender;
+        receiver.bind(address);
+        Thread::Atomic received;
+        Async::Task<void> waiter = wake(pool, receiver, ROUNDS, samples, received);
+        Net::Packet packet;
+        for(u64 i = 0; i < ROUNDS; i++) {
+            Profile::Time_Point now = Profile::timestamp();
+            Libc::memcpy(packet.data(), &now, sizeof(now));
+            u64 sent = sender.send(address, packet, sizeof(now));
+            keep(sent);
+            while(static_cast<u64>(received.load()) <= i) Thread::pause();
+        }
+        waiter.block();
+    });
+
+    latency(bench, label("UDP echo"_v, v).view(), threads, [&](Samples& samples) {
+        constexpr u64 ROUNDS = 5000;
+        Vec<Net::Udp, Bench::Alloc> servers = Vec<Net::Udp, Bench::Alloc>::make(threads);
+        Vec<Net::Udp, Bench::Alloc> clients = Vec<Net::Udp, Bench::Alloc>::make(threads);
+        Vec<Samples, Bench::Alloc> each = Vec<Samples, Bench::Alloc>::make(threads);
+        Vec<Async::Task<void>, Bench::Alloc> tasks(2 * threads);
+        for(u64 i = 0; i < threads; i++) {
+            Net::Address address{"127.0.0.1"_v, static_cast<u16>(port + 1 + i)};
+            servers[i].bind(address);
+            tasks.push(echo(pool, servers[i]));
+            tasks.push(call(pool, clients[i], address, ROUNDS, each[i]));
+        }
+        for(Async::Task<void>& task : tasks) task.block();
+        for(Samples& s : each) {
+            for(f64 t : s) samples.push(t);
+        }
+    });
+
+    bench.run(label("File read"_v, v).view(), threads, 1, [&]() {
+        Opt<Vec<u8, Files::Alloc>> data = Async::read(pool, file).block();
+        assert(data.ok());
+        keep(data->length());
+    });
+}
+
+// Options, besides the common ones:
+//   --compare   also run every case on pools with two event loops and with unpinned workers
+i32 main(i32 argc, char** argv) {
+    String_View flags[] = {"--compare"_v};
+    Bench bench{"scheduler"_v, argc, argv, Slice<String_View>{flags, 1}};
+
+    constexpr u16 PORT = 25700;
+    String_View file = "bench_scheduler.tmp"_v;
+    {
+        Vec<u8, Bench::Alloc> data = Vec<u8, Bench::Alloc>::make(1 << 20);
+        for(u64 i = 0; i < data.length(); i++) data[i] = static_cast<u8>(i * 31);
+        if(!Files::write(file, data.slice())) die("Failed to write %.", file);
+    }
+
+    // 1, 2 and 4 workers, then all but one processor; the calling thread blocks on the results.
+    Vec<u64, Bench::Alloc> counts;
+    u64 most = Math::max<u64>(Thread::hardware_threads(), 2) - 1;
+    u64 fixed[] = {1, 2, 4};
+    for(u64 n : fixed) {
+        if(n < most) counts.push(n);
+    }
+    counts.push(most);
+
+    bool compare = bench.flag("--compare"_v);
+    u64 event_threads[] = {1, 2};
+    Async::Placement placements[] = {Async::Placement::threads, Async::Placement::none};
+
+    for(u64 threads : counts) {
+        for(u64 events : event_threads) {
+            for(Async::Placement placement : placements) {
+                bool baseline = events == 1 && placement == Async::Placement::threads;
+                if(!baseline && !compare) continue;
+                run(bench, Sched_Variant{threads, events, placement}, PORT, file);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+
+#include "bench.h"
+
+#include <rpp/bitset.h>
+#include <rpp/simd.h>
+
+using namespace SIMD;
+
+i32 main(i32 argc, char** argv) {
+    Bench bench{"simd"_v, argc, argv};
+
+    constexpr u64 N = 1 << 16;
+
+    Vec<f32> a(N), b(N);
+    for(u64 i = 0; i < N; i++) {
+        a.push(static_cast<f32>(i % 17));
+        b.push(static_cast<f32>(i % 13));
+    }
+
+    bench.run("dot scalar"_v, N, [&]() {
+        f32 sum = 0.0f;
+        for(u64 i = 0; i < N; i++) sum += a[i] * b[i];
+        keep(sum);
+    });
+    bench.run("dot F32x4"_v, N, [&]() {
+        F32x4 sum = F32x4::zero();
+        for(u64 i = 0; i < N; i += 4) {
+            sum = F32x4::fma(F32x4::load(a.data() + i), F32x4::load(b.data() + i), sum);
+        }
+        keep(F32x4::hsum(sum));
+    });
+    bench.run("dot F32x8"_v, N, [&]() {
+        F32x8 sum = F32x8::zero();
+        for(u64 i = 0; i < N; i += 8) {
+            sum = F32x8::add(sum, F32x8::mul(F32x8::load(a.data() + i), F32x8::load(b.data() + i)));
+        }
+        keep(F32x8::hsum(sum));
+    });
+
+    Dynamic_Bitset<> x{N}, y{N};
+    for(u64 i = 0; i < N; i += 3) x.set(i);
+    for(u64 i = 0; i < N; i += 5) y.set(i);
+    bench.run("Bitset intersect count"_v, N, [&]() {
+        Dynamic_Bitset<> z = x.clone();
+        z.intersect(y);
+        keep(z.count());
+    });
+    return 0;
+}
@@ -8,9 +8,20 @@
 namespace rpp {
 
 [[nodiscard]] void* sys_alloc(u64 size) noexcept;
+[[nodiscard]] void* sys_alloc(u64 size, u64 align) noexcept;
 void sys_free(void* mem) noexcept;
 [[nodiscard]] i64 sys_net_allocs() noexcept;
 
+[[nodiscard]] void* sys_reserve(u64 size) noexcept;
+void sys_commit(void* mem, u64 size) noexcept;
+void sys_decommit(void* mem, u64 size) noexcept;
+void sys_release(void* mem, u64 size) noexcept;
+// Grows a committed mapping in place; returns false, leaving it unchanged, when that is not
+// possible.
+[[nodiscard]] bool sys_extend(void* mem, u64 size, u64 new_size) noexcept;
+// Returns whether a block from sys_alloc already has room for size bytes without moving.
+[[nodiscard]] bool sys_expand(void* mem, u64 size) noexcept;
+
 template<typename A>
 concept Allocator = requires(u64 size, void* address) {
     Same<Literal, decltype(A::name)>;
@@ -18,6 +29,73 @@ concept Allocator = requires(u64 size, void* address) {
     { A::free(address) } -> Same<void>;
 };
 
+template<typename A>
+concept Aligned_Allocator = Allocator<A> && requires(u64 size, u64 align) {
+    { A::alloc(size, align) } -> Same<void*>;
+};
+
+// Allocators that can sometimes grow a block without moving it. try_expand returns false, and
+// leaves the block untouched, when the block cannot grow to new_size bytes in place.
+template<typename A>
+concept Expanding_Allocator =
+    Allocator<A> && requires(void* address, u64 size, u64 new_size) {
+        { A::try_expand(address, size, new_size) } -> Same<bool>;
+    };
+
+template<Allocator A>
+[[nodiscard]] bool alloc_expand(void* mem, u64 size, u64 new_size) noexcept {
+    if constexpr(Expanding_Allocator<A>) {
+        return mem && A::try_expand(mem, size, new_size);
+    } else {
+        return false;
+    }
+}
+
+// alloc(size) only guarantees ALLOC_ALIGNMENT; over-aligned types use alloc(size, align).
+constexpr u64 ALLOC_ALIGNMENT = 16;
+
+template<Allocator A, u64 Align>
+    requires((Align & (Align - 1)) == 0)
+[[nodiscard]] void* alloc_aligned(u64 size) noexcept {
+    if constexpr(Align <= ALLOC_ALIGNMENT) {
+        return A::alloc(size);
+    } else {
+        static_assert(Aligned_Allocator<A>, "Allocator does not support over-aligned types.");
+        return A::alloc(size, Align);
+    }
+}
+
+// Allocators used through an instance. Static allocators qualify as empty instances; stateful
+// ones, like Marena, point at the memory they hand out. Containers that store their allocator,
+// like Vec, only grow when the allocator is not empty.
+template<typename A>
+concept Allocator_Instance = Copy_Constructable<A> && requires(A& a, u64 size, void* address) {
+    Same<Literal, decltype(A::name)>;
+    { a.alloc(size) } -> Same<void*>;
+    { a.free(address) } -> Same<void>;
+};
+
+template<u64 Align, Allocator_Instance A>
+    requires((Align & (Align - 1)) == 0)
+[[nodiscard]] void* alloc_aligned(A& allocator, u64 size) noexcept {
+    if constexpr(Align <= ALLOC_ALIGNMENT) {
+        return allocator.alloc(size);
+    } else {
+        static_assert(requires { allocator.alloc(size, Align); },
+                      "Allocator does not support over-aligned types.");
+        return allocator.alloc(size, Align);
+    }
+}
+
+template<Allocator_Instance A>
+[[nodiscard]] bool alloc_expand(A& allocator, void* mem, u64 size, u64 new_size) noexcept {
+    if constexpr(requires { allocator.try_expand(mem, size, new_size); }) {
+        return mem && allocator.try_expand(mem, size, new_size);
+    } else {
+        return false;
+    }
+}
+
 template<typename A>
 concept Pool = requires(Empty<> t) { // Can't express forall types T
     { A::template make<Empty<>>(t) } -> Same<Empty<>*>;
@@ -34,7 +112,7 @@ struct Scalar_Adaptor {
     template<typename T, typename... Args>
         requires Allocator<A> && Constructable<T, Args...>
     [[nodiscard]] static T* make(Args&&... args) noexcept {
-        T* mem = reinterpret_cast<T*>(A::alloc(sizeof(T)));
+        T* mem = reinterpret_cast<T*>(alloc_aligned<A, alignof(T)>(sizeof(T)));
         new(mem) T{rpp::forward<Args>(args)...};
         return mem;
     }
@@ -58,7 +136,9 @@ template<Literal N, bool Log = true>
 struct Mallocator {
     constexpr static Literal name = N;
     static void* alloc(u64 size) noexcept;
+    static void* alloc(u64 size, u64 align) noexcept;
     static void free(void* mem) noexcept;
+    [[nodiscard]] static bool try_expand(void* mem, u64 size, u64 new_size) noexcept;
 };
 
 using Region = u64;
@@ -82,7 +162,11 @@ struct Region_Allocator {
     };
 
     [[nodiscard]] static void* alloc(Region region, u64 size) noexcept;
+    [[nodiscard]] static void* alloc(Region region, u64 size, u64 align) noexcept;
     static void free(Region region, void* mem) noexcept;
+    // Only the most recent allocation of the innermost region can grow.
+    [[nodiscard]] static bool try_expand(Region region, void* mem, u64 size,
+                                         u64 new_size) noexcept;
 
     static u64 depth() noexcept;
     static u64 size() noexcept;
@@ -100,9 +184,15 @@ struct Mregion {
     [[nodiscard]] static void* alloc(u64 size) noexcept {
         return Region_Allocator::alloc(R, size);
     }
+    [[nodiscard]] static void* alloc(u64 size, u64 align) noexcept {
+        return Region_Allocator::alloc(R, size, align);
+    }
     static void free(void* mem) noexcept {
         Region_Allocator::free(R, mem);
     }
+    [[nodiscard]] static bool try_expand(void* mem, u64 size, u64 new_size) noexcept {
+        return Region_Allocator::try_expand(R, mem, size, new_size);
+    }
 };
 
 #define RPP_REGION2(COUNTER) __region_##COUNTER
@@ -115,7 +205,9 @@ struct Mregion {
 using Mdefault = Mallocator<"Default">;
 using Mhidden = Mallocator<"Hidden", false>;
 
-template<typename T, Allocator Base>
+// With Slab > 0, nodes are carved out of Slab-byte chunks and clear() releases whole chunks,
+// including any nodes still in use. Otherwise each node is allocated individually.
+template<typename T, Allocator Base, u64 Slab = 0>
 struct Free_List {
 
     Free_List() noexcept = default;
@@ -126,13 +218,16 @@ struct Free_List {
     Free_List(const Free_List&) noexcept = delete;
     Free_List& operator=(const Free_List&) noexcept = delete;
 
-    Free_List(Free_List&& src) noexcept : list_(src.list_) {
+    Free_List(Free_List&& src) noexcept : list_(src.list_), chunks_(src.chunks_) {
         src.list_ = null;
+        src.chunks_ = null;
     }
     Free_List& operator=(Free_List&& src) noexcept {
         this->~Free_List();
         list_ = src.list_;
+        chunks_ = src.chunks_;
         src.list_ = null;
+        src.chunks_ = null;
         return *this;
     }
 
@@ -149,22 +244,47 @@ struct Free_List {
         free(value);
     }
 
+    // Batched versions of make/destroy that move uninitialized nodes in and out of the list.
+    void take(T** out, u64 n) noexcept {
+        for(u64 i = 0; i < n; i++) {
+            out[i] = alloc();
+        }
+    }
+
+    void give(T** in, u64 n) noexcept {
+        for(u64 i = 0; i < n; i++) {
+            free(in[i]);
+        }
+    }
+
     void clear() noexcept {
-        while(list_) {
-            Free_Node* next = list_->next;
-            Base::free(list_);
-            list_ = next;
+        if constexpr(Slab > 0) {
+            while(chunks_) {
+                Chunk* next = chunks_->next;
+                Base::free(chunks_);
+                chunks_ = next;
+            }
+            list_ = null;
+        } else {
+            while(list_) {
+                Free_Node* next = list_->next;
+                Base::free(list_);
+                list_ = next;
+            }
         }
     }
 
 private:
     [[nodiscard]] T* alloc() noexcept {
-        if(list_) {
+        if constexpr(Slab > 0) {
+            if(!list_) carve();
+        }
+        if(Slab > 0 || list_) {
             Free_Node* ret = list_;
             list_ = list_->next;
             return reinterpret_cast<T*>(ret);
         }
-        void* new_node = Base::alloc(sizeof(Free_Node));
+        void* new_node = alloc_aligned<Base, alignof(Free_Node)>(sizeof(Free_Node));
         return reinterpret_cast<T*>(new_node);
     }
 
@@ -180,7 +300,30 @@ private:
         Free_Node* next = null;
     };
 
+    struct Chunk {
+        Chunk* next;
+    };
+
+    constexpr static u64 chunk_header = Math::align(sizeof(Chunk), alignof(Free_Node));
+
+    void carve() noexcept {
+        static_assert(Slab >= chunk_header + sizeof(Free_Node), "Slab too small for one node.");
+        constexpr u64 count = (Slab - chunk_header) / sizeof(Free_Node);
+
+        u8* mem = reinterpret_cast<u8*>(alloc_aligned<Base, alignof(Free_Node)>(Slab));
+        Chunk* chunk = reinterpret_cast<Chunk*>(mem);
+        chunk->next = chunks_;
+        chunks_ = chunk;
+
+        Free_Node* nodes = reinterpret_cast<Free_Node*>(mem + chunk_header);
+        for(u64 i = count; i > 0; i--) {
+            nodes[i - 1].next = list_;
+            list_ = &nodes[i - 1];
+        }
+    }
+
     Free_Node* list_ = null;
+    Chunk* chunks_ = null;
 };
 
 } // namespace rpp
@@ -23,7 +23,12 @@ namespace detail {
     return ret;
 }
 
-template<u64 N>
+constexpr u64 POOL_MAGAZINE = 32;
+
+// Each thread keeps a magazine of free blocks in front of the shared list, so the global lock is
+// only taken to refill or drain half a magazine at a time. Blocks are interchangeable, so a block
+// freed on another thread simply joins that thread's magazine.
+template<u64 N, u64 M = POOL_MAGAZINE>
 struct Pool {
     constexpr static Literal name = pool_name(N);
 
@@ -32,9 +37,13 @@ struct Pool {
     [[nodiscard]] static T* make(Args&&... args) noexcept {
         finalizer.keep_alive();
         Block* block = null;
-        {
+        if constexpr(M > 0) {
+            Magazine& mag = magazine;
+            if(mag.count == 0) mag.refill();
+            block = mag.blocks[--mag.count];
+        } else {
             Thread::Lock lock(mutex);
-            block = list.make();
+            list.take(&block, 1);
         }
         new(block->data) T{rpp::forward<Args>(args)...};
         return reinterpret_cast<T*>(block);
@@ -47,47 +56,149 @@ struct Pool {
         if constexpr(Must_Destruct<T>) {
             value->~T();
         }
-        {
+        Block* block = reinterpret_cast<Block*>(value);
+        if constexpr(M > 0) {
+            Magazine& mag = magazine;
+            if(mag.count == M) mag.drain(Magazine::batch);
+            mag.blocks[mag.count++] = block;
+        } else {
             Thread::Lock lock(mutex);
-            list.destroy(reinterpret_cast<Block*>(value));
+            list.give(&block, 1);
         }
     }
 
 private:
     using Backing = Mallocator<name>;
+    using List = Free_List<Block, Backing, Math::max<u64>(Math::KB(4), 16 * N)>;
 
+    // Every type of size N is aligned to at most the largest power of two dividing N.
     struct Block {
-        alignas(Math::min<u64>(N, 16)) u8 data[N];
+        alignas(Math::min<u64>(N & (~N + 1), 64)) u8 data[N];
+    };
+
+    struct Magazine {
+        constexpr static u64 batch = Math::max<u64>(M / 2, 1);
+
+        Magazine() noexcept = default;
+        ~Magazine() noexcept {
+            drain(count);
+        }
+
+        Magazine(const Magazine&) noexcept = delete;
+        Magazine& operator=(const Magazine&) noexcept = delete;
+
+        Magazine(Magazine&&) noexcept = delete;
+        Magazine& operator=(Magazine&&) noexcept = delete;
+
+        void refill() noexcept {
+            Thread::Lock lock(mutex);
+            list.take(blocks, batch);
+            count = batch;
+        }
+
+        void drain(u64 n) noexcept {
+            if(n == 0) return;
+            count -= n;
+            Thread::Lock lock(mutex);
+            list.give(blocks + count, n);
+        }
+
+        Block* blocks[Math::max<u64>(M, 1)] = {};
+        u64 count = 0;
     };
 
     struct Finalizer {
-        Finalizer(Free_List<Block, Backing>& l) noexcept {
-            Profile::finalizer([&l]() { l.clear(); });
+        Finalizer(List& l) noexcept {
+            // Other threads have exited by now, so only the finalizing thread may hold blocks.
+            Profile::finalizer([&l]() {
+                if constexpr(M > 0) {
+                    magazine.drain(magazine.count);
+                }
+                l.clear();
+            });
         }
         consteval void keep_alive() noexcept {
         }
     };
 
     static inline Thread::Mutex mutex;
-    static inline Free_List<Block, Backing> list;
+    static inline List list;
+    static inline thread_local Magazine magazine;
     static inline Finalizer finalizer{list};
 };
 
 } // namespace detail
 
-struct Mpool {
+template<u64 M = detail::POOL_MAGAZINE>
+struct Mpool_Cache {
     template<typename T, typename... Args>
         requires Constructable<T, Args...>
     [[nodiscard]] constexpr static T* make(Args&&... args) noexcept {
-        return detail::Pool<sizeof(T)>::template make<T, Args...>(rpp::forward<Args>(args)...);
+        return detail::Pool<sizeof(T), M>::template make<T, Args...>(rpp::forward<Args>(args)...);
     }
 
     template<typename T>
     constexpr static void destroy(T* value) noexcept {
-        detail::Pool<sizeof(T)>::template destroy<T>(value);
+        detail::Pool<sizeof(T), M>::template destroy<T>(value);
+    }
+};
+
+using Mpool = Mpool_Cache<>;
+
+namespace detail {
+
+template<u64 N>
+struct Class_Block {
+    Class_Block() noexcept {
+    }
+    u8 data[N];
+};
+
+} // namespace detail
+
+// Like Mpool, but sizes are rounded up to a multiple of G, so types of similar size share one
+// pool and its magazines instead of each getting their own.
+template<u64 G = 16, u64 M = detail::POOL_MAGAZINE>
+    requires((G & (G - 1)) == 0)
+struct Mpool_Classes {
+    template<typename T, typename... Args>
+        requires Constructable<T, Args...>
+    [[nodiscard]] static T* make(Args&&... args) noexcept {
+        using Block = detail::Class_Block<size_of<T>>;
+        static_assert(alignof(T) <= Math::min<u64>(size_of<T> & (~size_of<T> + 1), 64));
+        T* value = reinterpret_cast<T*>(detail::Pool<size_of<T>, M>::template make<Block>());
+        new(value) T{rpp::forward<Args>(args)...};
+        return value;
+    }
+
+    template<typename T>
+    static void destroy(T* value) noexcept {
+        using Block = detail::Class_Block<size_of<T>>;
+        if constexpr(Must_Destruct<T>) {
+            value->~T();
+        }
+        detail::Pool<size_of<T>, M>::template destroy<Block>(reinterpret_cast<Block*>(value));
     }
+
+private:
+    template<typename T>
+    constexpr static u64 size_of = Math::align_pow2(sizeof(T), G);
 };
 
+namespace detail {
+
+template<typename F, typename... Args>
+[[nodiscard]] F* function_spill(Args&&... args) noexcept {
+    return Mpool_Classes<>::make<F>(rpp::forward<Args>(args)...);
+}
+
+template<typename F>
+void function_unspill(F* f) noexcept {
+    Mpool_Classes<>::destroy(f);
+}
+
+} // namespace detail
+
 template<Literal N, bool log>
 [[nodiscard]] void* Mallocator<N, log>::alloc(u64 size) noexcept {
     if(!size) return null;
@@ -98,6 +209,26 @@ template<Literal N, bool log>
     return ret;
 }
 
+template<Literal N, bool log>
+[[nodiscard]] void* Mallocator<N, log>::alloc(u64 size, u64 align) noexcept {
+    if(!size) return null;
+    void* ret = sys_alloc(size, align);
+    if constexpr(log) {
+        Profile::alloc({String_View{N}, ret, size});
+    }
+    return ret;
+}
+
+template<Literal N, bool log>
+[[nodiscard]] bool Mallocator<N, log>::try_expand(void* mem, u64, u64 new_size) noexcept {
+    if(!sys_expand(mem, new_size)) return false;
+    if constexpr(log) {
+        Profile::alloc({String_View{N}, mem, 0});
+        Profile::alloc({String_View{N}, mem, new_size});
+    }
+    return true;
+}
+
 template<Literal N, bool log>
 void Mallocator<N, log>::free(void* mem) noexcept {
     if(!mem) return;
@@ -0,0 +1,176 @@
+
+#pragma once
+
+#include "base.h"
+
+namespace rpp {
+
+// Bump allocator over chunks taken from Base. Individual frees do nothing: reset() reclaims
+// everything at once and keeps the newest chunk for reuse. Containers allocate from an arena
+// through a Marena instance, so the arena itself may not move.
+template<Allocator Base = Mdefault>
+struct Linear_Arena {
+    constexpr static u64 CHUNK = Math::KB(64);
+    constexpr static u64 MAX_CHUNK = Math::MB(16);
+
+    explicit Linear_Arena(u64 chunk = CHUNK) noexcept : chunk_(chunk) {
+    }
+    ~Linear_Arena() noexcept {
+        release(null);
+    }
+
+    Linear_Arena(const Linear_Arena&) noexcept = delete;
+    Linear_Arena& operator=(const Linear_Arena&) noexcept = delete;
+
+    Linear_Arena(Linear_Arena&&) noexcept = delete;
+    Linear_Arena& operator=(Linear_Arena&&) noexcept = delete;
+
+    [[nodiscard]] void* alloc(u64 size, u64 align = ALLOC_ALIGNMENT) noexcept {
+        if(!size) return null;
+        u8* ret = align_top(align);
+        if(!chunks_ || ret + size > end_) {
+            new_chunk(size + align);
+            ret = align_top(align);
+        }
+        top_ = ret + size;
+        used_ += size;
+        return ret;
+    }
+
+    // Grows the most recent allocation when its chunk has room left.
+    [[nodiscard]] bool try_expand(void* mem, u64 size, u64 new_size) noexcept {
+        u8* block = reinterpret_cast<u8*>(mem);
+        if(!block || block + size != top_ || new_size > static_cast<u64>(end_ - block)) {
+            return false;
+        }
+        top_ = block + new_size;
+        used_ += new_size - size;
+        return true;
+    }
+
+    // Invalidates every allocation made so far.
+    void reset() noexcept {
+        if(!chunks_) return;
+        release(chunks_);
+        top_ = reinterpret_cast<u8*>(chunks_ + 1);
+        end_ = top_ + chunks_->size;
+        used_ = 0;
+    }
+
+    // Bytes handed out since the last reset.
+    [[nodiscard]] u64 used() const noexcept {
+        return used_;
+    }
+
+private:
+    struct Chunk {
+        Chunk* next;
+        u64 size;
+    };
+
+    [[nodiscard]] u8* align_top(u64 align) const noexcept {
+        return reinterpret_cast<u8*>(Math::align_pow2(reinterpret_cast<u64>(top_), align));
+    }
+
+    void new_chunk(u64 request) noexcept {
+        u64 size = Math::max(request, chunks_ ? Math::min(2 * chunks_->size, MAX_CHUNK) : chunk_);
+        Chunk* chunk = reinterpret_cast<Chunk*>(Base::alloc(sizeof(Chunk) + size));
+        chunk->next = chunks_;
+        chunk->size = size;
+        chunks_ = chunk;
+        top_ = reinterpret_cast<u8*>(chunk + 1);
+        end_ = top_ + size;
+    }
+
+    // Frees every chunk except keep, which must be the newest.
+    void release(Chunk* keep) noexcept {
+        Chunk* chunk = keep ? keep->next : chunks_;
+        while(chunk) {
+            Chunk* next = chunk->next;
+            Base::free(chunk);
+            chunk = next;
+        }
+        if(keep) keep->next = null;
+        else chunks_ = null;
+    }
+
+    Chunk* chunks_ = null;
+    u8* top_ = null;
+    u8* end_ = null;
+    u64 used_ = 0;
+    u64 chunk_ = CHUNK;
+};
+
+// Two linear arenas used on alternating frames. Memory allocated during one frame stays valid
+// through the next, so per-frame data can still be read one frame later, and is reclaimed when
+// the frame after that begins.
+template<Allocator Base = Mdefault>
+struct Frame_Arena {
+
+    explicit Frame_Arena(u64 chunk = Linear_Arena<Base>::CHUNK) noexcept
+        : arenas_{Linear_Arena<Base>{chunk}, Linear_Arena<Base>{chunk}} {
+    }
+
+    Frame_Arena(const Frame_Arena&) noexcept = delete;
+    Frame_Arena& operator=(const Frame_Arena&) noexcept = delete;
+
+    Frame_Arena(Frame_Arena&&) noexcept = delete;
+    Frame_Arena& operator=(Frame_Arena&&) noexcept = delete;
+
+    [[nodiscard]] void* alloc(u64 size, u64 align = ALLOC_ALIGNMENT) noexcept {
+        return current().alloc(size, align);
+    }
+    [[nodiscard]] bool try_expand(void* mem, u64 size, u64 new_size) noexcept {
+        return current().try_expand(mem, size, new_size);
+    }
+
+    // Call once per frame: the arena of the frame before last is reset and becomes current.
+    void begin_frame() noexcept {
+        current_ ^= 1;
+        arenas_[current_].reset();
+    }
+
+    [[nodiscard]] Linear_Arena<Base>& current() noexcept {
+        return arenas_[current_];
+    }
+    [[nodiscard]] Linear_Arena<Base>& previous() noexcept {
+        return arenas_[current_ ^ 1];
+    }
+
+private:
+    Linear_Arena<Base> arenas_[2];
+    u64 current_ = 0;
+};
+
+// Allocator instance drawing from an arena, for containers that store their allocator, like
+// Vec. Frees are no-ops; the arena reclaims its memory in bulk.
+template<typename Arena>
+struct Marena {
+    constexpr static Literal name = "Arena";
+
+    Marena() noexcept = default;
+    explicit Marena(Arena& arena) noexcept : arena_(&arena) {
+    }
+
+    [[nodiscard]] void* alloc(u64 size) noexcept {
+        return alloc(size, ALLOC_ALIGNMENT);
+    }
+    [[nodiscard]] void* alloc(u64 size, u64 align) noexcept {
+        assert(arena_);
+        return arena_->alloc(size, align);
+    }
+    [[nodiscard]] bool try_expand(void* mem, u64 size, u64 new_size) noexcept {
+        return arena_ && arena_->try_expand(mem, size, new_size);
+    }
+    void free(void*) noexcept {
+    }
+
+    [[nodiscard]] Arena* arena() const noexcept {
+        return arena_;
+    }
+
+private:
+    Arena* arena_ = null;
+};
+
+} // namespace rpp
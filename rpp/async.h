@@ -42,10 +42,234 @@ struct Promise;
 template<typename R = void, Allocator A = Alloc>
 struct Task;
 
+template<typename R = void, Allocator A = Alloc>
+struct Lazy_Promise;
+
+template<typename R = void, Allocator A = Alloc>
+struct Lazy;
+
+template<Allocator A>
+struct Pool;
+
 constexpr i64 TASK_START = 0;
 constexpr i64 TASK_DONE = 1;
 constexpr i64 TASK_ABANDONED = 2;
 
+namespace detail {
+
+// Coroutine frames are rounded up to a size class and taken from the matching block pool, whose
+// per-thread magazines let a worker reuse the frames of its finished tasks without touching the
+// heap. Larger frames fall back to the task's allocator.
+constexpr u64 FRAME_GRANULARITY = 64;
+constexpr u64 FRAME_CLASSES = 16;
+
+template<u64 N>
+struct Frame {
+    Frame() noexcept {
+    }
+    alignas(16) u8 data[N];
+};
+
+template<u64 I = 0>
+[[nodiscard]] void* alloc_frame_class(u64 size_class) noexcept {
+    constexpr u64 N = (I + 1) * FRAME_GRANULARITY;
+    if constexpr(I + 1 < FRAME_CLASSES) {
+        if(size_class != I) return alloc_frame_class<I + 1>(size_class);
+    }
+    return rpp::detail::Pool<N>::template make<Frame<N>>();
+}
+
+template<u64 I = 0>
+void free_frame_class(void* frame, u64 size_class) noexcept {
+    constexpr u64 N = (I + 1) * FRAME_GRANULARITY;
+    if constexpr(I + 1 < FRAME_CLASSES) {
+        if(size_class != I) return free_frame_class<I + 1>(frame, size_class);
+    }
+    rpp::detail::Pool<N>::template destroy<Frame<N>>(reinterpret_cast<Frame<N>*>(frame));
+}
+
+template<Allocator A>
+[[nodiscard]] void* alloc_frame(u64 size) noexcept {
+    if(size > FRAME_GRANULARITY * FRAME_CLASSES) return A::alloc(size);
+    return alloc_frame_class((size - 1) / FRAME_GRANULARITY);
+}
+
+template<Allocator A>
+void free_frame(void* frame, u64 size) noexcept {
+    if(size > FRAME_GRANULARITY * FRAME_CLASSES) return A::free(frame);
+    free_frame_class(frame, (size - 1) / FRAME_GRANULARITY);
+}
+
+struct Arena_Link;
+
+} // namespace detail
+
+// Bump allocator owned by one task. The task's promise makes it current on whichever thread
+// resumes the task, so Mtask allocations follow the task across workers, and every chunk is
+// released at once when the owning task's frame is destroyed.
+struct Task_Arena {
+    constexpr static u64 CHUNK = Math::KB(16);
+    constexpr static u64 MAX_CHUNK = Math::MB(1);
+
+    Task_Arena() noexcept = default;
+    ~Task_Arena() noexcept {
+        while(chunks_) {
+            Chunk* next = chunks_->next;
+            Backing::free(chunks_);
+            chunks_ = next;
+        }
+    }
+
+    Task_Arena(const Task_Arena&) noexcept = delete;
+    Task_Arena& operator=(const Task_Arena&) noexcept = delete;
+
+    Task_Arena(Task_Arena&&) noexcept = delete;
+    Task_Arena& operator=(Task_Arena&&) noexcept = delete;
+
+    // Child tasks that borrow the arena may run in parallel, so allocation takes a lock.
+    [[nodiscard]] void* alloc(u64 size, u64 align) noexcept {
+        Thread::Lock lock(mutex_);
+        u8* ret = align_top(align);
+        if(!chunks_ || ret + size > end_) {
+            new_chunk(size + align);
+            ret = align_top(align);
+        }
+        top_ = ret + size;
+        size_ += size;
+        return ret;
+    }
+
+    // Bytes handed out so far.
+    [[nodiscard]] u64 size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] static Task_Arena* current() noexcept {
+        return current_;
+    }
+
+private:
+    using Backing = Mallocator<"Task_Arena">;
+
+    struct Chunk {
+        Chunk* next;
+        u64 size;
+    };
+
+    [[nodiscard]] u8* align_top(u64 align) const noexcept {
+        return reinterpret_cast<u8*>(Math::align_pow2(reinterpret_cast<u64>(top_), align));
+    }
+
+    void new_chunk(u64 request) noexcept {
+        u64 size = Math::max(request, chunks_ ? Math::min(2 * chunks_->size, MAX_CHUNK) : CHUNK);
+        Chunk* chunk = reinterpret_cast<Chunk*>(Backing::alloc(sizeof(Chunk) + size));
+        chunk->next = chunks_;
+        chunk->size = size;
+        chunks_ = chunk;
+        top_ = reinterpret_cast<u8*>(chunk + 1);
+        end_ = top_ + size;
+    }
+
+    Thread::Mutex mutex_;
+    Chunk* chunks_ = null;
+    u8* top_ = null;
+    u8* end_ = null;
+    u64 size_ = 0;
+
+    static inline thread_local Task_Arena* current_ = null;
+
+    friend struct detail::Arena_Link;
+};
+
+// Allocates from the arena of the task running on this thread. Frees are no-ops: the memory is
+// reclaimed when the arena's owner finishes.
+struct Mtask {
+    constexpr static Literal name = "Task_Arena";
+
+    [[nodiscard]] static void* alloc(u64 size) noexcept {
+        return alloc(size, ALLOC_ALIGNMENT);
+    }
+    [[nodiscard]] static void* alloc(u64 size, u64 align) noexcept {
+        if(!size) return null;
+        Task_Arena* arena = Task_Arena::current();
+        if(!arena) die("Mtask used outside of a task with an arena!");
+        return arena->alloc(size, align);
+    }
+    static void free(void*) noexcept {
+    }
+};
+
+namespace detail {
+
+// Tracks the arena a task allocates from. A task borrows the arena that was current where it was
+// created, so it must finish before that arena's owner does, until it opens its own with
+// co_await Async::arena().
+struct Arena_Link {
+    Arena_Link() noexcept : arena{Task_Arena::current_}, outer{Task_Arena::current_} {
+    }
+    ~Arena_Link() noexcept {
+        if(owned) {
+            arena->~Task_Arena();
+            Alloc::free(arena);
+        }
+    }
+
+    Arena_Link(const Arena_Link&) noexcept = delete;
+    Arena_Link& operator=(const Arena_Link&) noexcept = delete;
+
+    Arena_Link(Arena_Link&&) noexcept = delete;
+    Arena_Link& operator=(Arena_Link&&) noexcept = delete;
+
+    void enter() noexcept {
+        if(arena && Task_Arena::current_ != arena) {
+            outer = Task_Arena::current_;
+            Task_Arena::current_ = arena;
+        }
+    }
+    void leave() noexcept {
+        if(arena && Task_Arena::current_ == arena) Task_Arena::current_ = outer;
+    }
+
+    [[nodiscard]] Task_Arena& own() noexcept {
+        if(!owned) {
+            leave();
+            arena = new(Alloc::alloc(sizeof(Task_Arena))) Task_Arena{};
+            owned = true;
+            enter();
+        }
+        return *arena;
+    }
+
+    Task_Arena* arena = null;
+    Task_Arena* outer = null;
+    bool owned = false;
+};
+
+// Wraps every co_await of a task, so its arena is current exactly while the task runs.
+template<typename T>
+struct Arena_Await {
+    [[nodiscard]] bool await_ready() noexcept {
+        return awaitable.await_ready();
+    }
+    template<typename P>
+    decltype(auto) await_suspend(std::coroutine_handle<P> handle) noexcept {
+        // Once the inner await_suspend runs, the task may already be resuming on another thread.
+        link.leave();
+        return awaitable.await_suspend(handle);
+    }
+    decltype(auto) await_resume() noexcept {
+        link.enter();
+        return awaitable.await_resume();
+    }
+
+    T& awaitable;
+    Arena_Link& link;
+};
+
+} // namespace detail
+
+struct Use_Arena;
+
 struct Final_Suspend {
     [[nodiscard]] bool await_ready() noexcept {
         return false;
@@ -53,9 +277,8 @@ struct Final_Suspend {
     void await_resume() noexcept {
     }
 
-    template<typename R, Allocator A>
-    [[nodiscard]] std::coroutine_handle<>
-    await_suspend(std::coroutine_handle<Promise<R, A>> handle) noexcept {
+    template<typename P>
+    [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept {
 
         i64 state = handle.promise().state.exchange(TASK_DONE);
 
@@ -85,17 +308,24 @@ struct Promise_Base {
         return {};
     }
     [[nodiscard]] Final_Suspend final_suspend() noexcept {
+        arena.leave();
         return Final_Suspend{};
     }
     void unhandled_exception() noexcept {
         die("Unhandled exception in coroutine.");
     }
 
+    template<typename T>
+    [[nodiscard]] detail::Arena_Await<typename Remove_Reference<T>::type>
+    await_transform(T&& awaitable) noexcept {
+        return {awaitable, arena};
+    }
+
     [[nodiscard]] void* operator new(size_t size) noexcept {
-        return A::alloc(size);
+        return detail::alloc_frame<A>(size);
     }
-    void operator delete(void* ptr, size_t) noexcept {
-        A::free(ptr);
+    void operator delete(void* ptr, size_t size) noexcept {
+        detail::free_frame<A>(ptr, size);
     }
 
     void block() noexcept {
@@ -105,9 +335,12 @@ struct Promise_Base {
 protected:
     Thread::Atomic state{TASK_START};
     Thread::Flag flag;
+    detail::Arena_Link arena;
 
     friend struct Task<R, A>;
+    friend struct Lazy<R, A>;
     friend struct Final_Suspend;
+    friend struct Use_Arena;
 };
 
 template<typename R, Allocator A>
@@ -240,6 +473,392 @@ struct Promise<void, A> : Promise_Base<void, A> {
     }
 };
 
+// Gives the calling task its own Task_Arena, which tasks it creates from then on borrow. Resolves
+// to the arena without suspending.
+struct Use_Arena {
+    [[nodiscard]] bool await_ready() noexcept {
+        return false;
+    }
+    template<typename P>
+    [[nodiscard]] bool await_suspend(std::coroutine_handle<P> handle) noexcept {
+        arena = &handle.promise().arena.own();
+        return false;
+    }
+    [[nodiscard]] Task_Arena& await_resume() noexcept {
+        return *arena;
+    }
+    Task_Arena* arena = null;
+};
+
+[[nodiscard]] inline Use_Arena arena() noexcept {
+    return Use_Arena{};
+}
+
+namespace detail {
+
+// Lazy tasks start suspended, so their arena is made current when they first run.
+struct Lazy_Start {
+    [[nodiscard]] bool await_ready() noexcept {
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<>) noexcept {
+    }
+    void await_resume() noexcept {
+        link.enter();
+    }
+    Arena_Link& link;
+};
+
+} // namespace detail
+
+template<typename R, Allocator A>
+struct Lazy_Promise : Promise_Base<R, A> {
+    [[nodiscard]] Lazy<R, A> get_return_object() noexcept {
+        return Lazy<R, A>{*this};
+    }
+    [[nodiscard]] detail::Lazy_Start initial_suspend() noexcept {
+        return detail::Lazy_Start{this->arena};
+    }
+    void return_value(const R& val) noexcept {
+        value = val;
+        this->flag.signal();
+    }
+    void return_value(R&& val) noexcept {
+        value = rpp::move(val);
+        this->flag.signal();
+    }
+
+private:
+    R value;
+    friend struct Lazy<R, A>;
+};
+
+template<Allocator A>
+struct Lazy_Promise<void, A> : Promise_Base<void, A> {
+    [[nodiscard]] Lazy<void, A> get_return_object() noexcept {
+        return Lazy<void, A>{*this};
+    }
+    [[nodiscard]] detail::Lazy_Start initial_suspend() noexcept {
+        return detail::Lazy_Start{this->arena};
+    }
+    void return_void() noexcept {
+#ifdef RPP_COMPILER_MSVC
+        Libc::keep_alive();
+#endif
+        this->flag.signal();
+    }
+};
+
+// A task that does not run until it is awaited, started, or launched on a pool. Awaiting a lazy
+// task that has not started transfers control straight into it, and its completion transfers
+// straight back to the awaiter, so chains of lazy tasks neither grow the stack nor go through a
+// queue. Once started or launched, awaiting it works like awaiting a Task.
+template<typename R, Allocator A>
+struct Lazy {
+
+    using promise_type = Lazy_Promise<R, A>;
+    using return_type = R;
+
+    Lazy() noexcept : handle{null} {
+    }
+    explicit Lazy(Lazy_Promise<R, A>& promise) noexcept
+        : handle{std::coroutine_handle<promise_type>::from_promise(promise)} {
+    }
+
+    ~Lazy() noexcept {
+        if(handle && !launched) {
+            handle.destroy();
+        } else if(handle) {
+            auto state = handle.promise().state.exchange(TASK_ABANDONED);
+            if(state == TASK_DONE) {
+                handle.destroy();
+            } else if(state != TASK_START) {
+                die("Task abandoned while being waited upon.");
+            }
+        }
+        handle = null;
+        launched = false;
+    }
+
+    Lazy(const Lazy&) noexcept = delete;
+    Lazy& operator=(const Lazy&) noexcept = delete;
+
+    Lazy(Lazy&& src) noexcept {
+        handle = src.handle;
+        launched = src.launched;
+        src.handle = null;
+        src.launched = false;
+    }
+    Lazy& operator=(Lazy&& src) noexcept {
+        this->~Lazy();
+        handle = src.handle;
+        launched = src.launched;
+        src.handle = null;
+        src.launched = false;
+        return *this;
+    }
+
+    [[nodiscard]] bool await_ready() noexcept {
+        assert(handle);
+        return launched && handle.promise().state.load() == TASK_DONE;
+    }
+    [[nodiscard]] std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<> continuation) noexcept {
+        assert(handle);
+        i64 cont = reinterpret_cast<i64>(continuation.address());
+        if(!launched) {
+            // Nothing else can see the task yet, so the continuation is stored before it runs.
+            launched = true;
+            handle.promise().state.store(cont);
+            return handle;
+        }
+        if(handle.promise().state.compare_and_swap(TASK_START, cont) == TASK_START) {
+            return std::noop_coroutine();
+        }
+        return continuation;
+    }
+    [[nodiscard]] R await_resume() noexcept {
+        assert(handle);
+        if constexpr(Same<R, void>) {
+            return;
+        } else {
+            return rpp::move(handle.promise().value);
+        }
+    }
+
+    // Runs the task on this thread until it first suspends.
+    void start() noexcept {
+        assert(handle && !launched);
+        launched = true;
+        handle.resume();
+    }
+
+    [[nodiscard]] bool started() const noexcept {
+        return launched;
+    }
+    [[nodiscard]] bool done() noexcept {
+        assert(handle);
+        return await_ready();
+    }
+    [[nodiscard]] R block() noexcept {
+        assert(handle);
+        if(!launched) start();
+        handle.promise().block();
+        return await_resume();
+    }
+
+    [[nodiscard]] bool ok() const noexcept {
+        return handle != null;
+    }
+
+private:
+    [[nodiscard]] std::coroutine_handle<> launch() noexcept {
+        assert(handle && !launched);
+        launched = true;
+        return handle;
+    }
+
+    std::coroutine_handle<Lazy_Promise<R, A>> handle;
+    bool launched = false;
+
+    template<Allocator>
+    friend struct Pool;
+};
+
+namespace detail {
+
+struct Group_State {
+    // One count per running task plus one held by the group until its owner awaits when_all.
+    Thread::Atomic remaining{1};
+    Thread::Atomic first{-1};
+    Thread::Atomic any_waiter;
+    std::coroutine_handle<> all_waiter;
+};
+
+constexpr i64 ANY_DONE = 1;
+
+template<typename R, Allocator A>
+struct Join_Promise;
+
+template<typename R, Allocator A>
+struct Join {
+    using promise_type = Join_Promise<R, A>;
+    std::coroutine_handle<Join_Promise<R, A>> handle;
+};
+
+// Waits for a task to finish without taking its result.
+template<typename R, Allocator A>
+struct Join_Ready {
+    [[nodiscard]] bool await_ready() noexcept {
+        return task.done();
+    }
+    [[nodiscard]] bool await_suspend(std::coroutine_handle<> join) noexcept {
+        return task.await_suspend(join);
+    }
+    void await_resume() noexcept {
+    }
+    Task<R, A>& task;
+};
+
+// Counts down the group when its task finishes. The last task of a when_all resumes the group's
+// owner directly, and the first task of a when_any claims the wake-up of a waiting owner.
+struct Join_Final {
+    [[nodiscard]] bool await_ready() noexcept {
+        return false;
+    }
+    void await_resume() noexcept {
+    }
+
+    template<typename R, Allocator A>
+    [[nodiscard]] std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<Join_Promise<R, A>> handle) noexcept {
+        Join_Promise<R, A>& promise = handle.promise();
+        Group_State& state = *promise.state;
+
+        std::coroutine_handle<> next = std::noop_coroutine();
+        if(state.first.compare_and_swap(-1, static_cast<i64>(promise.index)) == -1) {
+            i64 waiter = state.any_waiter.exchange(ANY_DONE);
+            if(waiter != 0) {
+                next = std::coroutine_handle<>::from_address(reinterpret_cast<void*>(waiter));
+            }
+        }
+        // The owner awaits one of when_all or when_any at a time, so at most one is resumed. Once
+        // the count drops the group may be destroyed, unless we are the last task of a when_all.
+        if(state.remaining.decr() == 0) return state.all_waiter;
+        return next;
+    }
+};
+
+template<typename R, Allocator A>
+struct Join_Promise {
+
+    Join_Promise(Task<R, A>& task, Group_State* state, u64 index) noexcept
+        : task{&task}, state{state}, index{index} {
+    }
+    ~Join_Promise() noexcept = default;
+
+    Join_Promise(const Join_Promise&) noexcept = delete;
+    Join_Promise& operator=(const Join_Promise&) noexcept = delete;
+
+    Join_Promise(Join_Promise&&) noexcept = delete;
+    Join_Promise& operator=(Join_Promise&&) noexcept = delete;
+
+    [[nodiscard]] Join<R, A> get_return_object() noexcept {
+        return Join<R, A>{std::coroutine_handle<Join_Promise>::from_promise(*this)};
+    }
+    [[nodiscard]] Continue initial_suspend() noexcept {
+        return {};
+    }
+    [[nodiscard]] Join_Final final_suspend() noexcept {
+        return {};
+    }
+    void return_void() noexcept {
+    }
+    void unhandled_exception() noexcept {
+        die("Unhandled exception in coroutine.");
+    }
+
+    [[nodiscard]] void* operator new(size_t size) noexcept {
+        return detail::alloc_frame<A>(size);
+    }
+    void operator delete(void* ptr, size_t size) noexcept {
+        detail::free_frame<A>(ptr, size);
+    }
+
+    // Points into the coroutine frame, which owns the task.
+    Task<R, A>* task;
+    Group_State* state;
+    u64 index;
+};
+
+template<typename R, Allocator A>
+[[nodiscard]] Join<R, A> join(Task<R, A> task, Group_State*, u64) noexcept {
+    co_await Join_Ready<R, A>{task};
+}
+
+} // namespace detail
+
+// Owns a set of tasks and lets one coroutine await all or any of them with a single resumption,
+// rather than suspending once per task. Tasks keep their results, which can be taken with
+// co_await or block once the group reports them finished.
+//
+// The group must not be destroyed while any of its tasks are running, e.g. after when_any,
+// await when_all before letting it go out of scope.
+template<typename R = void, Allocator A = Alloc>
+struct Task_Group {
+
+    Task_Group() noexcept = default;
+    ~Task_Group() noexcept {
+        if(state.remaining.load() != 1) {
+            die("Task group destroyed while tasks are running.");
+        }
+        for(auto& join : joins) join.destroy();
+        joins.clear();
+    }
+
+    Task_Group(const Task_Group&) noexcept = delete;
+    Task_Group& operator=(const Task_Group&) noexcept = delete;
+
+    Task_Group(Task_Group&&) noexcept = delete;
+    Task_Group& operator=(Task_Group&&) noexcept = delete;
+
+    void spawn(Task<R, A>&& task) noexcept {
+        assert(task.ok());
+        state.remaining.incr();
+        joins.push(detail::join(rpp::move(task), &state, joins.length()).handle);
+    }
+
+    [[nodiscard]] u64 length() const noexcept {
+        return joins.length();
+    }
+    [[nodiscard]] Task<R, A>& operator[](u64 idx) noexcept {
+        return *joins[idx].promise().task;
+    }
+
+    struct When_All {
+        [[nodiscard]] bool await_ready() noexcept {
+            return group.state.remaining.load() == 1;
+        }
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> waiter) noexcept {
+            group.state.all_waiter = waiter;
+            // Whoever drops the count to zero resumes the waiter, so if that was us, don't wait.
+            return group.state.remaining.decr() != 0;
+        }
+        void await_resume() noexcept {
+            if(group.state.remaining.load() == 0) group.state.remaining.incr();
+        }
+        Task_Group& group;
+    };
+
+    struct When_Any {
+        [[nodiscard]] bool await_ready() noexcept {
+            return group.state.first.load() != -1;
+        }
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> waiter) noexcept {
+            i64 address = reinterpret_cast<i64>(waiter.address());
+            return group.state.any_waiter.compare_and_swap(0, address) == 0;
+        }
+        [[nodiscard]] u64 await_resume() noexcept {
+            return static_cast<u64>(group.state.first.load());
+        }
+        Task_Group& group;
+    };
+
+    // Resumes the awaiting coroutine once every task has finished.
+    [[nodiscard]] When_All when_all() noexcept {
+        return When_All{*this};
+    }
+    // Resumes the awaiting coroutine once any task has finished, returning the index of the first.
+    [[nodiscard]] When_Any when_any() noexcept {
+        assert(!joins.empty());
+        return When_Any{*this};
+    }
+
+private:
+    detail::Group_State state;
+    Vec<std::coroutine_handle<detail::Join_Promise<R, A>>, A> joins;
+};
+
 struct Event {
 
     Event() noexcept;
@@ -257,6 +876,9 @@ struct Event {
     void reset() const noexcept;
     [[nodiscard]] bool try_wait() const noexcept;
 
+    // Identifies the underlying descriptor or handle, e.g. for sharding events between reactors.
+    [[nodiscard]] u64 key() const noexcept;
+
 #ifdef RPP_OS_WINDOWS
     [[nodiscard]] static Event of_sys(void* event) noexcept;
 #elif defined RPP_OS_LINUX
@@ -282,6 +904,50 @@ private:
     i32 signal_fd = -1;
     i16 mask = 0;
 #endif
+
+    friend struct Reactor;
+};
+
+// Persistent wait set owned by one thread. Events are registered once and each wait collects
+// every ready event up to the given capacity, so the cost of a wake-up does not depend on how
+// many events are pending. Each registration is reported at most once, after which the event
+// must still be removed before it is destroyed.
+struct Reactor {
+
+    constexpr static u64 WAKE = static_cast<u64>(-1);
+    constexpr static u64 FOREVER = static_cast<u64>(-1);
+
+    Reactor() noexcept;
+    ~Reactor() noexcept;
+
+    Reactor(const Reactor&) noexcept = delete;
+    Reactor& operator=(const Reactor&) noexcept = delete;
+
+    Reactor(Reactor&&) noexcept = delete;
+    Reactor& operator=(Reactor&&) noexcept = delete;
+
+    void add(const Event& event, u64 id) noexcept;
+    void remove(const Event& event) noexcept;
+
+    // Interrupts the current or next wait, which then reports WAKE among the ready ids.
+    void wake() noexcept;
+
+    // Returns zero ready ids if timeout_ms passes first.
+    [[nodiscard]] u64 wait(u64* ready, u64 capacity, u64 timeout_ms = FOREVER) noexcept;
+
+private:
+    constexpr static u64 MAX_BATCH = 64;
+#ifdef RPP_OS_WINDOWS
+    // An I/O completion port. Each registered event owns a wait completion packet that posts its
+    // id to the port once the event is signaled, so there is no limit on pending events.
+    void* port = null;
+    Map<u64, void*, Alloc> packets;
+    Vec<void*, Alloc> spare;
+    Thread::Atomic woken;
+#else
+    Event wake_;
+    i32 fd = -1;
+#endif
 };
 
 } // namespace rpp::Async
@@ -3,13 +3,147 @@
 
 #include "async.h"
 #include "files.h"
+#include "net.h"
 #include "pool.h"
 
 namespace rpp::Async {
 
-[[nodiscard]] Task<void> wait(Pool<>& pool, u64 ms) noexcept;
+[[nodiscard]] inline Task<void> wait(Pool<>& pool, u64 ms) noexcept {
+    co_await pool.timer(ms);
+}
+
+// Returns false if the token was cancelled or reached its deadline first.
+[[nodiscard]] inline Task<bool> wait(Pool<>& pool, u64 ms, Cancel_Token& token) noexcept {
+    co_return co_await pool.timer(ms, token);
+}
 
 [[nodiscard]] Task<Opt<Vec<u8, Files::Alloc>>> read(Pool<>& pool, String_View path) noexcept;
+// Reads up to length bytes starting at offset into data, returning the number of bytes read.
+[[nodiscard]] Task<Opt<u64>> read(Pool<>& pool, String_View path, u64 offset, u8* data,
+                                  u64 length) noexcept;
 [[nodiscard]] Task<bool> write(Pool<>& pool, String_View path, Slice<u8> data) noexcept;
 
+// Waits until a packet arrives on udp and receives it.
+[[nodiscard]] inline Task<Net::Udp::Data> recv(Pool<>& pool, Net::Udp& udp,
+                                              Net::Packet& in) noexcept {
+    for(;;) {
+        if(Opt<Net::Udp::Data> data = udp.recv(in); data.ok()) co_return rpp::move(*data);
+        co_await pool.event(udp.readable());
+    }
+}
+
+// Gives up if the token is cancelled or reaches its deadline first.
+[[nodiscard]] inline Task<Opt<Net::Udp::Data>> recv(Pool<>& pool, Net::Udp& udp, Net::Packet& in,
+                                                   Cancel_Token& token) noexcept {
+    for(;;) {
+        if(Opt<Net::Udp::Data> data = udp.recv(in); data.ok()) co_return rpp::move(data);
+        if(!co_await pool.event(udp.readable(), token)) co_return Opt<Net::Udp::Data>{};
+    }
+}
+
+// Waits until a packet arrives on udp and receives it into a pooled buffer.
+[[nodiscard]] inline Task<Net::Packet_Ref> recv(Pool<>& pool, Net::Udp& udp) noexcept {
+    for(;;) {
+        if(Opt<Net::Packet_Ref> packet = udp.recv(); packet.ok()) co_return rpp::move(*packet);
+        co_await pool.event(udp.readable());
+    }
+}
+
+// Waits until packets arrive on udp and receives as many as are ready, up to N.
+template<u64 N>
+[[nodiscard]] Task<u64> recv(Pool<>& pool, Net::Udp& udp, Array<Net::Packet, N>& in,
+                             Array<Net::Udp::Data, N>& data) noexcept {
+    for(;;) {
+        if(u64 n = udp.recv(in, data); n > 0) co_return n;
+        co_await pool.event(udp.readable());
+    }
+}
+
+// Sends a packet, waiting for space in the socket buffer if it is full.
+[[nodiscard]] inline Task<u64> send(Pool<>& pool, Net::Udp& udp, Net::Address address,
+                                    const Net::Packet& out, u64 length) noexcept {
+    for(;;) {
+        if(Opt<u64> sent = udp.try_send(address, out, length); sent.ok()) co_return *sent;
+        co_await pool.event(udp.writable());
+    }
+}
+
+// Connects to address, waiting for the handshake to complete.
+[[nodiscard]] inline Task<Opt<Net::Tcp_Stream>> connect(Pool<>& pool,
+                                                       Net::Address address) noexcept {
+    Opt<Net::Tcp_Stream> stream = Net::Tcp_Stream::connect(address);
+    if(!stream.ok()) co_return Opt<Net::Tcp_Stream>{};
+    co_await pool.event(stream->writable());
+    if(!stream->finish_connect()) co_return Opt<Net::Tcp_Stream>{};
+    co_return rpp::move(stream);
+}
+
+// Waits until a connection arrives on listener and accepts it.
+[[nodiscard]] inline Task<Opt<Net::Tcp_Stream>> accept(Pool<>& pool,
+                                                      Net::Tcp_Listener& listener) noexcept {
+    for(;;) {
+        if(Opt<Net::Tcp_Stream> stream = listener.accept(); stream.ok()) {
+            co_return rpp::move(stream);
+        }
+        co_await pool.event(listener.readable());
+    }
+}
+
+// Gives up if the token is cancelled or reaches its deadline first.
+[[nodiscard]] inline Task<Opt<Net::Tcp_Stream>>
+accept(Pool<>& pool, Net::Tcp_Listener& listener, Cancel_Token& token) noexcept {
+    for(;;) {
+        if(Opt<Net::Tcp_Stream> stream = listener.accept(); stream.ok()) {
+            co_return rpp::move(stream);
+        }
+        if(!co_await pool.event(listener.readable(), token)) co_return Opt<Net::Tcp_Stream>{};
+    }
+}
+
+// Waits until data arrives on stream and reads up to length bytes of it, returning zero once the
+// connection is closed.
+[[nodiscard]] inline Task<u64> read(Pool<>& pool, Net::Tcp_Stream& stream, u8* data,
+                                    u64 length) noexcept {
+    for(;;) {
+        if(Opt<u64> n = stream.read(data, length); n.ok()) co_return *n;
+        co_await pool.event(stream.readable());
+    }
+}
+
+// Gives up, returning none, if the token is cancelled or reaches its deadline first.
+[[nodiscard]] inline Task<Opt<u64>> read(Pool<>& pool, Net::Tcp_Stream& stream, u8* data,
+                                         u64 length, Cancel_Token& token) noexcept {
+    for(;;) {
+        if(Opt<u64> n = stream.read(data, length); n.ok()) co_return rpp::move(n);
+        if(!co_await pool.event(stream.readable(), token)) co_return Opt<u64>{};
+    }
+}
+
+// Writes all of buffers, waiting for space in the socket buffer as needed. Returns false if the
+// connection failed first.
+[[nodiscard]] inline Task<bool> write(Pool<>& pool, Net::Tcp_Stream& stream,
+                                      Slice<Slice<u8>> buffers) noexcept {
+    u64 total = 0;
+    for(Slice<u8> buffer : buffers) total += buffer.length();
+
+    u64 written = 0;
+    while(written < total) {
+        Opt<u64> n = stream.write(buffers, written);
+        if(!n.ok()) {
+            co_await pool.event(stream.writable());
+            continue;
+        }
+        if(*n == 0) co_return false;
+        written += *n;
+    }
+    co_return true;
+}
+
+[[nodiscard]] inline Task<bool> write(Pool<>& pool, Net::Tcp_Stream& stream,
+                                      Slice<u8> data) noexcept {
+    // The coroutine frame keeps this copy alive while the write is suspended.
+    Slice<u8> buffers[1] = {data};
+    co_return co_await write(pool, stream, Slice<Slice<u8>>{buffers, 1});
+}
+
 } // namespace rpp::Async
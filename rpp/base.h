@@ -10,6 +10,8 @@
 #define RPP_COMPILER_MSVC
 #define RPP_FORCE_INLINE __forceinline
 #define RPP_MSVC_INTRINSIC [[msvc::intrinsic]]
+#define RPP_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#include <intrin.h>
 #include <vcruntime_new.h>
 
 #if _MSC_VER < 1939
@@ -26,6 +28,7 @@
 #define RPP_COMPILER_CLANG
 #define RPP_FORCE_INLINE __attribute__((always_inline)) inline
 #define RPP_MSVC_INTRINSIC
+#define RPP_NO_UNIQUE_ADDRESS [[no_unique_address]]
 #include <new>
 
 #if __clang_major__ < 17
@@ -112,6 +115,7 @@ namespace Libc {
 [[nodiscard]] u64 strlen(const char* str) noexcept;
 void* memset(void* dest, i32 value, u64 bytes) noexcept;
 void* memcpy(void* dest, const void* src, u64 bytes) noexcept;
+void* memmove(void* dest, const void* src, u64 bytes) noexcept;
 [[nodiscard]] i32 memcmp(const void* a, const void* b, u64 bytes) noexcept;
 [[nodiscard]] i32 snprintf(u8* buffer, u64 buffer_size, const char* fmt, ...) noexcept;
 [[nodiscard]] i64 strtoll(const char* str, char** endptr, i32 base) noexcept;
@@ -169,6 +173,8 @@ void keep_alive() noexcept;
 
 #include "function.h"
 
+#include "symbol.h"
+
 #include "profile.h"
 
 #include "alloc1.h"
@@ -176,3 +182,7 @@ void keep_alive() noexcept;
 #include "box.h"
 
 #include "format1.h"
+
+#ifdef RPP_EXTERN_TEMPLATES
+#include "instances.h"
+#endif
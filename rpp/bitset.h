@@ -0,0 +1,627 @@
+
+#pragma once
+
+#include "base.h"
+#include "simd.h"
+#include "sort.h"
+
+namespace rpp {
+
+namespace detail {
+
+enum class Bit_Op : u8 { and_, or_, and_not };
+
+// Combines n words of src into dst, two words per vector operation.
+template<Bit_Op op>
+void combine_words(u64* dst, const u64* src, u64 n) noexcept {
+    u64 i = 0;
+    for(; i + 2 <= n; i += 2) {
+        SIMD::U8x16 a = SIMD::U8x16::load(reinterpret_cast<const u8*>(dst + i));
+        SIMD::U8x16 b = SIMD::U8x16::load(reinterpret_cast<const u8*>(src + i));
+        if constexpr(op == Bit_Op::and_) a = SIMD::U8x16::bit_and(a, b);
+        else if constexpr(op == Bit_Op::or_) a = SIMD::U8x16::bit_or(a, b);
+        else a = SIMD::U8x16::bit_andnot(a, b);
+        SIMD::U8x16::store(a, reinterpret_cast<u8*>(dst + i));
+    }
+    for(; i < n; i++) {
+        if constexpr(op == Bit_Op::and_) dst[i] &= src[i];
+        else if constexpr(op == Bit_Op::or_) dst[i] |= src[i];
+        else dst[i] &= ~src[i];
+    }
+}
+
+[[nodiscard]] inline u64 count_words(const u64* words, u64 n) noexcept {
+    u64 count = 0;
+    for(u64 i = 0; i < n; i++) count += Math::popcount(words[i]);
+    return count;
+}
+
+[[nodiscard]] inline bool any_words(const u64* words, u64 n) noexcept {
+    for(u64 i = 0; i < n; i++) {
+        if(words[i]) return true;
+    }
+    return false;
+}
+
+// Index of the first set bit at or after bit.
+[[nodiscard]] inline Opt<u64> next_set(const u64* words, u64 n, u64 bit) noexcept {
+    u64 w = bit / 64;
+    if(w >= n) return {};
+    u64 word = words[w] & (~u64{0} << (bit % 64));
+    for(;;) {
+        if(word) return Opt<u64>{w * 64 + Math::cttz(word)};
+        if(++w == n) return {};
+        word = words[w];
+    }
+}
+
+template<typename F>
+void each_set(const u64* words, u64 n, F&& f) noexcept {
+    for(u64 w = 0; w < n; w++) {
+        for(u64 word = words[w]; word; word &= word - 1) f(w * 64 + Math::cttz(word));
+    }
+}
+
+} // namespace detail
+
+// Fixed size set of N bits.
+template<u64 N>
+struct Bitset {
+    static_assert(N > 0);
+
+    constexpr static u64 WORDS = (N + 63) / 64;
+
+    Bitset() noexcept = default;
+
+    [[nodiscard]] constexpr static u64 length() noexcept {
+        return N;
+    }
+    [[nodiscard]] Slice<u64> words() const noexcept {
+        return Slice<u64>{words_, WORDS};
+    }
+
+    [[nodiscard]] bool test(u64 i) const noexcept {
+        assert(i < N);
+        return (words_[i / 64] >> (i % 64)) & 1;
+    }
+    void set(u64 i) noexcept {
+        assert(i < N);
+        words_[i / 64] |= u64{1} << (i % 64);
+    }
+    void set(u64 i, bool value) noexcept {
+        if(value) set(i);
+        else reset(i);
+    }
+    void reset(u64 i) noexcept {
+        assert(i < N);
+        words_[i / 64] &= ~(u64{1} << (i % 64));
+    }
+    void flip(u64 i) noexcept {
+        assert(i < N);
+        words_[i / 64] ^= u64{1} << (i % 64);
+    }
+
+    void clear() noexcept {
+        Libc::memset(words_, 0, sizeof(words_));
+    }
+    void fill() noexcept {
+        Libc::memset(words_, 0xff, sizeof(words_));
+        if constexpr(N % 64) words_[WORDS - 1] = (u64{1} << (N % 64)) - 1;
+    }
+
+    [[nodiscard]] u64 count() const noexcept {
+        return detail::count_words(words_, WORDS);
+    }
+    [[nodiscard]] bool any() const noexcept {
+        return detail::any_words(words_, WORDS);
+    }
+    [[nodiscard]] bool none() const noexcept {
+        return !any();
+    }
+
+    [[nodiscard]] Opt<u64> first() const noexcept {
+        return detail::next_set(words_, WORDS, 0);
+    }
+    // First set bit at or after i.
+    [[nodiscard]] Opt<u64> next(u64 i) const noexcept {
+        return detail::next_set(words_, WORDS, i);
+    }
+
+    void intersect(const Bitset& other) noexcept {
+        detail::combine_words<detail::Bit_Op::and_>(words_, other.words_, WORDS);
+    }
+    void unite(const Bitset& other) noexcept {
+        detail::combine_words<detail::Bit_Op::or_>(words_, other.words_, WORDS);
+    }
+    void subtract(const Bitset& other) noexcept {
+        detail::combine_words<detail::Bit_Op::and_not>(words_, other.words_, WORDS);
+    }
+
+    [[nodiscard]] bool operator==(const Bitset& other) const noexcept {
+        return Libc::memcmp(words_, other.words_, sizeof(words_)) == 0;
+    }
+
+    // Calls f(i) for every set bit in increasing order.
+    template<typename F>
+        requires Invocable<F, u64>
+    void each(F&& f) const noexcept {
+        detail::each_set(words_, WORDS, rpp::forward<F>(f));
+    }
+
+private:
+    u64 words_[WORDS] = {};
+
+    friend struct Reflect::Refl<Bitset>;
+};
+
+// Set of bits whose length is chosen at runtime. Bits past the length are always zero.
+template<Allocator A = Mdefault>
+struct Dynamic_Bitset {
+
+    Dynamic_Bitset() noexcept = default;
+
+    explicit Dynamic_Bitset(u64 length) noexcept {
+        resize(length);
+    }
+
+    ~Dynamic_Bitset() noexcept = default;
+
+    Dynamic_Bitset(const Dynamic_Bitset& src) noexcept = delete;
+    Dynamic_Bitset& operator=(const Dynamic_Bitset& src) noexcept = delete;
+
+    Dynamic_Bitset(Dynamic_Bitset&& src) noexcept = default;
+    Dynamic_Bitset& operator=(Dynamic_Bitset&& src) noexcept = default;
+
+    template<Allocator B = A>
+    [[nodiscard]] Dynamic_Bitset<B> clone() const noexcept {
+        Dynamic_Bitset<B> ret;
+        ret.words_ = words_.template clone<B>();
+        ret.length_ = length_;
+        return ret;
+    }
+
+    [[nodiscard]] u64 length() const noexcept {
+        return length_;
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return length_ == 0;
+    }
+    [[nodiscard]] Slice<u64> words() const noexcept {
+        return words_.slice();
+    }
+
+    // New bits are zero.
+    void resize(u64 length) noexcept {
+        words_.resize((length + 63) / 64);
+        length_ = length;
+        if(length_ % 64) words_.back() &= (u64{1} << (length_ % 64)) - 1;
+    }
+
+    [[nodiscard]] bool test(u64 i) const noexcept {
+        assert(i < length_);
+        return (words_[i / 64] >> (i % 64)) & 1;
+    }
+    void set(u64 i) noexcept {
+        assert(i < length_);
+        words_[i / 64] |= u64{1} << (i % 64);
+    }
+    void set(u64 i, bool value) noexcept {
+        if(value) set(i);
+        else reset(i);
+    }
+    void reset(u64 i) noexcept {
+        assert(i < length_);
+        words_[i / 64] &= ~(u64{1} << (i % 64));
+    }
+    void flip(u64 i) noexcept {
+        assert(i < length_);
+        words_[i / 64] ^= u64{1} << (i % 64);
+    }
+
+    void clear() noexcept {
+        Libc::memset(words_.data(), 0, words_.length() * sizeof(u64));
+    }
+    void fill() noexcept {
+        Libc::memset(words_.data(), 0xff, words_.length() * sizeof(u64));
+        if(length_ % 64) words_.back() = (u64{1} << (length_ % 64)) - 1;
+    }
+
+    [[nodiscard]] u64 count() const noexcept {
+        return detail::count_words(words_.data(), words_.length());
+    }
+    [[nodiscard]] bool any() const noexcept {
+        return detail::any_words(words_.data(), words_.length());
+    }
+    [[nodiscard]] bool none() const noexcept {
+        return !any();
+    }
+
+    [[nodiscard]] Opt<u64> first() const noexcept {
+        return detail::next_set(words_.data(), words_.length(), 0);
+    }
+    // First set bit at or after i.
+    [[nodiscard]] Opt<u64> next(u64 i) const noexcept {
+        return detail::next_set(words_.data(), words_.length(), i);
+    }
+
+    // Both sides must have the same length.
+    template<Allocator B>
+    void intersect(const Dynamic_Bitset<B>& other) noexcept {
+        assert(length_ == other.length());
+        detail::combine_words<detail::Bit_Op::and_>(words_.data(), other.words().data(),
+                                                    words_.length());
+    }
+    template<Allocator B>
+    void unite(const Dynamic_Bitset<B>& other) noexcept {
+        assert(length_ == other.length());
+        detail::combine_words<detail::Bit_Op::or_>(words_.data(), other.words().data(),
+                                                   words_.length());
+    }
+    template<Allocator B>
+    void subtract(const Dynamic_Bitset<B>& other) noexcept {
+        assert(length_ == other.length());
+        detail::combine_words<detail::Bit_Op::and_not>(words_.data(), other.words().data(),
+                                                       words_.length());
+    }
+
+    template<Allocator B>
+    [[nodiscard]] bool operator==(const Dynamic_Bitset<B>& other) const noexcept {
+        if(length_ != other.length()) return false;
+        return Libc::memcmp(words_.data(), other.words().data(), words_.length() * sizeof(u64)) ==
+               0;
+    }
+
+    // Calls f(i) for every set bit in increasing order.
+    template<typename F>
+        requires Invocable<F, u64>
+    void each(F&& f) const noexcept {
+        detail::each_set(words_.data(), words_.length(), rpp::forward<F>(f));
+    }
+
+private:
+    Vec<u64, A> words_;
+    u64 length_ = 0;
+
+    template<Allocator>
+    friend struct Dynamic_Bitset;
+    friend struct Reflect::Refl<Dynamic_Bitset>;
+};
+
+namespace detail {
+
+// Holds the set low 16 bits of the ids sharing one high half. Containers with at most
+// ARRAY_MAX values keep them as a sorted array; larger ones switch to a 65536 bit bitmap.
+template<Allocator A>
+struct Roaring_Container {
+    constexpr static u64 ARRAY_MAX = 4096;
+    constexpr static u64 BITMAP_WORDS = 65536 / 64;
+
+    [[nodiscard]] Roaring_Container clone() const noexcept {
+        Roaring_Container ret;
+        ret.array = array.clone();
+        ret.bits = bits.clone();
+        ret.count = count;
+        return ret;
+    }
+
+    [[nodiscard]] bool bitmap() const noexcept {
+        return !bits.empty();
+    }
+
+    [[nodiscard]] bool contains(u16 low) const noexcept {
+        if(bitmap()) return (bits[low / 64] >> (low % 64)) & 1;
+        u64 i = Sort::lower_bound(array.data(), array.length(), low);
+        return i < array.length() && array[i] == low;
+    }
+
+    bool add(u16 low) noexcept {
+        if(bitmap()) {
+            u64 bit = u64{1} << (low % 64);
+            if(bits[low / 64] & bit) return false;
+            bits[low / 64] |= bit;
+            count++;
+            return true;
+        }
+        u64 i = Sort::lower_bound(array.data(), array.length(), low);
+        if(i < array.length() && array[i] == low) return false;
+        if(array.length() == ARRAY_MAX) {
+            to_bitmap();
+            return add(low);
+        }
+        array.push(low);
+        for(u64 j = array.length() - 1; j > i; j--) rpp::swap(array[j], array[j - 1]);
+        count++;
+        return true;
+    }
+
+    bool remove(u16 low) noexcept {
+        if(bitmap()) {
+            u64 bit = u64{1} << (low % 64);
+            if(!(bits[low / 64] & bit)) return false;
+            bits[low / 64] &= ~bit;
+            count--;
+            if(count <= ARRAY_MAX) to_array();
+            return true;
+        }
+        u64 i = Sort::lower_bound(array.data(), array.length(), low);
+        if(i == array.length() || array[i] != low) return false;
+        for(u64 j = i; j + 1 < array.length(); j++) array[j] = array[j + 1];
+        array.pop();
+        count--;
+        return true;
+    }
+
+    template<typename F>
+    void each(u32 high, F&& f) const noexcept {
+        if(bitmap()) {
+            each_set(bits.data(), bits.length(),
+                     [&](u64 low) { f(high | static_cast<u32>(low)); });
+        } else {
+            for(u16 low : array) f(high | low);
+        }
+    }
+
+    void unite(const Roaring_Container& other) noexcept {
+        if(other.bitmap()) {
+            if(!bitmap()) {
+                Vec<u16, A> mine = rpp::move(array);
+                bits = other.bits.clone();
+                for(u16 low : mine) bits[low / 64] |= u64{1} << (low % 64);
+            } else {
+                combine_words<Bit_Op::or_>(bits.data(), other.bits.data(), BITMAP_WORDS);
+            }
+            count = count_words(bits.data(), BITMAP_WORDS);
+        } else if(bitmap()) {
+            for(u16 low : other.array) bits[low / 64] |= u64{1} << (low % 64);
+            count = count_words(bits.data(), BITMAP_WORDS);
+        } else {
+            Vec<u16, A> merged(array.length() + other.array.length());
+            u64 i = 0, j = 0;
+            while(i < array.length() && j < other.array.length()) {
+                u16 a = array[i], b = other.array[j];
+                merged.push(a < b ? a : b);
+                i += a <= b;
+                j += b <= a;
+            }
+            for(; i < array.length(); i++) merged.push(array[i]);
+            for(; j < other.array.length(); j++) merged.push(other.array[j]);
+            array = rpp::move(merged);
+            count = array.length();
+            if(count > ARRAY_MAX) to_bitmap();
+        }
+    }
+
+    void intersect(const Roaring_Container& other) noexcept {
+        if(bitmap() && other.bitmap()) {
+            combine_words<Bit_Op::and_>(bits.data(), other.bits.data(), BITMAP_WORDS);
+            shrink();
+        } else if(bitmap()) {
+            Vec<u16, A> kept(other.array.length());
+            for(u16 low : other.array) {
+                if(contains(low)) kept.push(low);
+            }
+            bits = Vec<u64, A>{};
+            array = rpp::move(kept);
+            count = array.length();
+        } else {
+            filter([&](u16 low) { return other.contains(low); });
+        }
+    }
+
+    void subtract(const Roaring_Container& other) noexcept {
+        if(bitmap() && other.bitmap()) {
+            combine_words<Bit_Op::and_not>(bits.data(), other.bits.data(), BITMAP_WORDS);
+            shrink();
+        } else if(bitmap()) {
+            for(u16 low : other.array) bits[low / 64] &= ~(u64{1} << (low % 64));
+            shrink();
+        } else {
+            filter([&](u16 low) { return !other.contains(low); });
+        }
+    }
+
+    Vec<u16, A> array;
+    Vec<u64, A> bits;
+    u64 count = 0;
+
+private:
+    template<typename F>
+    void filter(F&& keep) noexcept {
+        u64 n = 0;
+        for(u64 i = 0; i < array.length(); i++) {
+            if(keep(array[i])) array[n++] = array[i];
+        }
+        while(array.length() > n) array.pop();
+        count = n;
+    }
+
+    // Recounts a bitmap after a bulk operation and drops back to an array when small enough.
+    void shrink() noexcept {
+        count = count_words(bits.data(), BITMAP_WORDS);
+        if(count <= ARRAY_MAX) to_array();
+    }
+
+    void to_bitmap() noexcept {
+        bits.resize(BITMAP_WORDS);
+        for(u16 low : array) bits[low / 64] |= u64{1} << (low % 64);
+        array = Vec<u16, A>{};
+    }
+
+    void to_array() noexcept {
+        Vec<u16, A> values(count);
+        each_set(bits.data(), BITMAP_WORDS,
+                 [&](u64 low) { values.push(static_cast<u16>(low)); });
+        array = rpp::move(values);
+        bits = Vec<u64, A>{};
+    }
+};
+
+} // namespace detail
+
+// Compressed set of 32 bit ids, after Roaring bitmaps. Ids are grouped by their high 16 bits
+// into containers kept sorted by that key; each container stores the low halves as a sorted
+// array while sparse and as a plain bitmap once dense, so memory follows the number of ids
+// rather than the size of the id space, and set operations on dense regions run word-wise.
+template<Allocator A = Mdefault>
+struct Roaring_Bitmap {
+    using Container = detail::Roaring_Container<A>;
+
+    Roaring_Bitmap() noexcept = default;
+    ~Roaring_Bitmap() noexcept = default;
+
+    Roaring_Bitmap(const Roaring_Bitmap& src) noexcept = delete;
+    Roaring_Bitmap& operator=(const Roaring_Bitmap& src) noexcept = delete;
+
+    Roaring_Bitmap(Roaring_Bitmap&& src) noexcept = default;
+    Roaring_Bitmap& operator=(Roaring_Bitmap&& src) noexcept = default;
+
+    [[nodiscard]] Roaring_Bitmap clone() const noexcept {
+        Roaring_Bitmap ret;
+        ret.keys_ = keys_.clone();
+        ret.containers_ = containers_.clone();
+        return ret;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return keys_.empty();
+    }
+    [[nodiscard]] u64 count() const noexcept {
+        u64 count = 0;
+        for(const Container& container : containers_) count += container.count;
+        return count;
+    }
+
+    void clear() noexcept {
+        keys_.clear();
+        containers_.clear();
+    }
+
+    [[nodiscard]] bool contains(u32 id) const noexcept {
+        Opt<u64> idx = find(static_cast<u16>(id >> 16));
+        return idx.ok() && containers_[*idx].contains(static_cast<u16>(id));
+    }
+
+    // Returns whether the id was newly added.
+    bool add(u32 id) noexcept {
+        u16 key = static_cast<u16>(id >> 16);
+        u64 idx = Sort::lower_bound(keys_.data(), keys_.length(), key);
+        if(idx == keys_.length() || keys_[idx] != key) {
+            keys_.push(key);
+            containers_.push(Container{});
+            for(u64 i = keys_.length() - 1; i > idx; i--) {
+                rpp::swap(keys_[i], keys_[i - 1]);
+                rpp::swap(containers_[i], containers_[i - 1]);
+            }
+        }
+        return containers_[idx].add(static_cast<u16>(id));
+    }
+
+    // Returns whether the id was present.
+    bool remove(u32 id) noexcept {
+        Opt<u64> idx = find(static_cast<u16>(id >> 16));
+        if(!idx.ok()) return false;
+        if(!containers_[*idx].remove(static_cast<u16>(id))) return false;
+        if(containers_[*idx].count == 0) {
+            for(u64 i = *idx; i + 1 < keys_.length(); i++) {
+                rpp::swap(keys_[i], keys_[i + 1]);
+                rpp::swap(containers_[i], containers_[i + 1]);
+            }
+            keys_.pop();
+            containers_.pop();
+        }
+        return true;
+    }
+
+    void unite(const Roaring_Bitmap& other) noexcept {
+        Vec<u16, A> keys(keys_.length() + other.keys_.length());
+        Vec<Container, A> containers(keys_.length() + other.keys_.length());
+        u64 i = 0, j = 0;
+        while(i < keys_.length() || j < other.keys_.length()) {
+            if(j == other.keys_.length() || (i < keys_.length() && keys_[i] < other.keys_[j])) {
+                keys.push(keys_[i]);
+                containers.push(rpp::move(containers_[i++]));
+            } else if(i == keys_.length() || other.keys_[j] < keys_[i]) {
+                keys.push(other.keys_[j]);
+                containers.push(other.containers_[j++].clone());
+            } else {
+                containers_[i].unite(other.containers_[j++]);
+                keys.push(keys_[i]);
+                containers.push(rpp::move(containers_[i++]));
+            }
+        }
+        keys_ = rpp::move(keys);
+        containers_ = rpp::move(containers);
+    }
+
+    void intersect(const Roaring_Bitmap& other) noexcept {
+        u64 n = 0, j = 0;
+        for(u64 i = 0; i < keys_.length(); i++) {
+            while(j < other.keys_.length() && other.keys_[j] < keys_[i]) j++;
+            if(j == other.keys_.length() || other.keys_[j] != keys_[i]) continue;
+            containers_[i].intersect(other.containers_[j]);
+            if(containers_[i].count == 0) continue;
+            keys_[n] = keys_[i];
+            if(n != i) containers_[n] = rpp::move(containers_[i]);
+            n++;
+        }
+        truncate(n);
+    }
+
+    void subtract(const Roaring_Bitmap& other) noexcept {
+        u64 n = 0, j = 0;
+        for(u64 i = 0; i < keys_.length(); i++) {
+            while(j < other.keys_.length() && other.keys_[j] < keys_[i]) j++;
+            if(j < other.keys_.length() && other.keys_[j] == keys_[i]) {
+                containers_[i].subtract(other.containers_[j]);
+                if(containers_[i].count == 0) continue;
+            }
+            keys_[n] = keys_[i];
+            if(n != i) containers_[n] = rpp::move(containers_[i]);
+            n++;
+        }
+        truncate(n);
+    }
+
+    // Calls f(id) for every id in increasing order.
+    template<typename F>
+        requires Invocable<F, u32>
+    void each(F&& f) const noexcept {
+        for(u64 i = 0; i < keys_.length(); i++) {
+            containers_[i].each(static_cast<u32>(keys_[i]) << 16, f);
+        }
+    }
+
+private:
+    [[nodiscard]] Opt<u64> find(u16 key) const noexcept {
+        u64 idx = Sort::lower_bound(keys_.data(), keys_.length(), key);
+        if(idx < keys_.length() && keys_[idx] == key) return Opt<u64>{idx};
+        return {};
+    }
+
+    void truncate(u64 n) noexcept {
+        while(keys_.length() > n) {
+            keys_.pop();
+            containers_.pop();
+        }
+    }
+
+    Vec<u16, A> keys_;
+    Vec<Container, A> containers_;
+
+    friend struct Reflect::Refl<Roaring_Bitmap>;
+};
+
+template<u64 N>
+RPP_TEMPLATE_RECORD(Bitset, N, RPP_FIELD(words_));
+
+template<Allocator A>
+RPP_TEMPLATE_RECORD(Dynamic_Bitset, A, RPP_FIELD(words_), RPP_FIELD(length_));
+
+template<Allocator A>
+RPP_NAMED_TEMPLATE_RECORD(::rpp::detail::Roaring_Container, "Roaring_Container", A,
+                          RPP_FIELD(array), RPP_FIELD(bits), RPP_FIELD(count));
+
+template<Allocator A>
+RPP_TEMPLATE_RECORD(Roaring_Bitmap, A, RPP_FIELD(keys_), RPP_FIELD(containers_));
+
+} // namespace rpp
@@ -0,0 +1,406 @@
+
+#pragma once
+
+#include "base.h"
+#include "sort.h"
+
+namespace rpp {
+
+namespace detail {
+
+// Leaves hold the entries and link to the next leaf, so range scans walk leaves in order. Inner
+// nodes hold copies of separator keys: keys in children[i] are less than keys[i], which is less
+// than or equal to every key in children[i + 1].
+template<typename K, typename V, u64 W>
+struct BTree_Node {
+    [[nodiscard]] const K* key_data() const noexcept {
+        return reinterpret_cast<const K*>(keys);
+    }
+    u64 length = 0;
+    bool leaf = true;
+    Storage<K> keys[W];
+};
+
+template<typename K, typename V, u64 W>
+struct BTree_Leaf : BTree_Node<K, V, W> {
+    BTree_Leaf* next = null;
+    Storage<V> values[W];
+};
+
+template<typename K, typename V, u64 W>
+struct BTree_Inner : BTree_Node<K, V, W> {
+    BTree_Node<K, V, W>* children[W + 1] = {};
+};
+
+} // namespace detail
+
+// Ordered map stored as a B+ tree. Nodes hold enough keys to fill a few cache lines, so a lookup
+// touches few nodes and searches each one like a small sorted array. Erasing never merges nodes:
+// a tree that shrinks keeps its shape until it's cleared.
+template<Ordered K, Movable V, Allocator A = Mdefault>
+struct BTree_Map {
+
+    // Keys per node: the key array spans four cache lines, within sensible bounds.
+    constexpr static u64 WIDTH = Math::max<u64>(8, Math::min<u64>(64, 256 / sizeof(K)));
+
+    using Node = detail::BTree_Node<K, V, WIDTH>;
+    using Leaf = detail::BTree_Leaf<K, V, WIDTH>;
+    using Inner = detail::BTree_Inner<K, V, WIDTH>;
+
+    static_assert(Clone<K> || Copy_Constructable<K>, "Separator keys must be copyable.");
+
+    BTree_Map() noexcept = default;
+    ~BTree_Map() noexcept {
+        clear();
+    }
+
+    BTree_Map(const BTree_Map& src) noexcept = delete;
+    BTree_Map& operator=(const BTree_Map& src) noexcept = delete;
+
+    BTree_Map(BTree_Map&& src) noexcept : root_(src.root_), length_(src.length_) {
+        src.root_ = null;
+        src.length_ = 0;
+    }
+    BTree_Map& operator=(BTree_Map&& src) noexcept {
+        this->~BTree_Map();
+        root_ = src.root_;
+        length_ = src.length_;
+        src.root_ = null;
+        src.length_ = 0;
+        return *this;
+    }
+
+    void clear() noexcept {
+        if(root_) destroy(root_);
+        root_ = null;
+        length_ = 0;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return length_ == 0;
+    }
+    [[nodiscard]] u64 length() const noexcept {
+        return length_;
+    }
+
+    V& insert(K&& key, V&& value) noexcept {
+        if(!root_) root_ = make_leaf();
+        V* slot = null;
+        Split split;
+        if(insert(root_, rpp::move(key), rpp::move(value), slot, split)) {
+            Inner* root = make_inner();
+            root->keys[0].construct(rpp::move(*split.key));
+            split.key.destruct();
+            root->children[0] = root_;
+            root->children[1] = split.right;
+            root->length = 1;
+            root_ = root;
+        }
+        return *slot;
+    }
+    V& insert(const K& key, V&& value) noexcept
+        requires Copy_Constructable<K>
+    {
+        return insert(K{key}, rpp::move(value));
+    }
+    V& insert(const K& key, const V& value) noexcept
+        requires Copy_Constructable<K> && Copy_Constructable<V>
+    {
+        return insert(K{key}, V{value});
+    }
+
+    [[nodiscard]] Opt<Ref<V>> try_get(const K& key) noexcept {
+        if(!root_) return {};
+        Leaf* leaf = find_leaf(key);
+        u64 idx = search(leaf, key);
+        if(idx < leaf->length && !(key < *leaf->keys[idx])) return Opt{Ref{*leaf->values[idx]}};
+        return {};
+    }
+    [[nodiscard]] Opt<Ref<const V>> try_get(const K& key) const noexcept {
+        if(!root_) return {};
+        const Leaf* leaf = find_leaf(key);
+        u64 idx = search(leaf, key);
+        if(idx < leaf->length && !(key < *leaf->keys[idx])) {
+            return Opt{Ref<const V>{*leaf->values[idx]}};
+        }
+        return {};
+    }
+
+    [[nodiscard]] bool contains(const K& key) const noexcept {
+        return try_get(key).ok();
+    }
+
+    [[nodiscard]] V& get(const K& key) noexcept {
+        Opt<Ref<V>> value = try_get(key);
+        if(!value.ok()) die("Failed to find key %!", key);
+        return **value;
+    }
+    [[nodiscard]] const V& get(const K& key) const noexcept {
+        Opt<Ref<const V>> value = try_get(key);
+        if(!value.ok()) die("Failed to find key %!", key);
+        return **value;
+    }
+
+    [[nodiscard]] bool try_erase(const K& key) noexcept {
+        if(!root_) return false;
+        Leaf* leaf = find_leaf(key);
+        u64 idx = search(leaf, key);
+        if(idx == leaf->length || key < *leaf->keys[idx]) return false;
+        leaf->keys[idx].destruct();
+        leaf->values[idx].destruct();
+        for(u64 i = idx; i + 1 < leaf->length; i++) {
+            relocate(leaf->keys[i], leaf->keys[i + 1]);
+            relocate(leaf->values[i], leaf->values[i + 1]);
+        }
+        leaf->length--;
+        length_--;
+        return true;
+    }
+    void erase(const K& key) noexcept {
+        if(!try_erase(key)) die("Failed to erase key %!", key);
+    }
+
+    // Calls f(key, value) for every key in order.
+    template<typename F>
+        requires Invocable<F, const K&, V&>
+    void each(F&& f) noexcept {
+        for(Leaf* leaf = first_leaf(); leaf; leaf = leaf->next) {
+            for(u64 i = 0; i < leaf->length; i++) f(*leaf->keys[i], *leaf->values[i]);
+        }
+    }
+    template<typename F>
+        requires Invocable<F, const K&, const V&>
+    void each(F&& f) const noexcept {
+        for(const Leaf* leaf = first_leaf(); leaf; leaf = leaf->next) {
+            for(u64 i = 0; i < leaf->length; i++) f(*leaf->keys[i], *leaf->values[i]);
+        }
+    }
+
+    // Calls f(key, value) for every key in [low, high), in order.
+    template<typename F>
+        requires Invocable<F, const K&, V&>
+    void each_in(const K& low, const K& high, F&& f) noexcept {
+        if(!root_) return;
+        Leaf* leaf = find_leaf(low);
+        for(u64 i = search(leaf, low); leaf; leaf = leaf->next, i = 0) {
+            for(; i < leaf->length; i++) {
+                if(!(*leaf->keys[i] < high)) return;
+                f(*leaf->keys[i], *leaf->values[i]);
+            }
+        }
+    }
+    template<typename F>
+        requires Invocable<F, const K&, const V&>
+    void each_in(const K& low, const K& high, F&& f) const noexcept {
+        if(!root_) return;
+        const Leaf* leaf = find_leaf(low);
+        for(u64 i = search(leaf, low); leaf; leaf = leaf->next, i = 0) {
+            for(; i < leaf->length; i++) {
+                if(!(*leaf->keys[i] < high)) return;
+                f(*leaf->keys[i], *leaf->values[i]);
+            }
+        }
+    }
+
+private:
+    // A node split in two: key separates the original node from right.
+    struct Split {
+        Storage<K> key;
+        Node* right = null;
+    };
+
+    [[nodiscard]] static Leaf* make_leaf() noexcept {
+        return new(alloc_aligned<A, alignof(Leaf)>(sizeof(Leaf))) Leaf;
+    }
+    [[nodiscard]] static Inner* make_inner() noexcept {
+        Inner* inner = new(alloc_aligned<A, alignof(Inner)>(sizeof(Inner))) Inner;
+        inner->leaf = false;
+        return inner;
+    }
+
+    template<typename T>
+    static void relocate(Storage<T>& dst, Storage<T>& src) noexcept {
+        dst.construct(rpp::move(*src));
+        src.destruct();
+    }
+
+    [[nodiscard]] static K copy(const K& key) noexcept {
+        if constexpr(Clone<K>) {
+            return key.clone();
+        } else {
+            return K{key};
+        }
+    }
+
+    // Index of the first key in node not less than key.
+    [[nodiscard]] static u64 search(const Node* node, const K& key) noexcept {
+        return Sort::lower_bound(node->key_data(), node->length, key);
+    }
+    // Index of the child of inner that may contain key.
+    [[nodiscard]] static u64 route(const Inner* inner, const K& key) noexcept {
+        u64 idx = search(inner, key);
+        return idx < inner->length && !(key < *inner->keys[idx]) ? idx + 1 : idx;
+    }
+
+    [[nodiscard]] Leaf* find_leaf(const K& key) const noexcept {
+        Node* node = root_;
+        while(!node->leaf) {
+            Inner* inner = static_cast<Inner*>(node);
+            node = inner->children[route(inner, key)];
+        }
+        return static_cast<Leaf*>(node);
+    }
+    [[nodiscard]] Leaf* first_leaf() const noexcept {
+        Node* node = root_;
+        if(!node) return null;
+        while(!node->leaf) node = static_cast<Inner*>(node)->children[0];
+        return static_cast<Leaf*>(node);
+    }
+
+    // Returns whether node split, in which case split holds the new right sibling.
+    [[nodiscard]] bool insert(Node* node, K&& key, V&& value, V*& slot, Split& split) noexcept {
+        if(node->leaf) return insert_leaf(static_cast<Leaf*>(node), rpp::move(key),
+                                          rpp::move(value), slot, split);
+
+        Inner* inner = static_cast<Inner*>(node);
+        u64 idx = route(inner, key);
+        Split child;
+        if(!insert(inner->children[idx], rpp::move(key), rpp::move(value), slot, child)) {
+            return false;
+        }
+
+        bool splits = inner->length == WIDTH;
+        if(splits) {
+            // The middle key moves up and the keys after it move to the right sibling.
+            u64 mid = WIDTH / 2;
+            Inner* right = make_inner();
+            for(u64 i = mid + 1; i < WIDTH; i++) {
+                relocate(right->keys[i - mid - 1], inner->keys[i]);
+                right->children[i - mid - 1] = inner->children[i];
+            }
+            right->children[WIDTH - mid - 1] = inner->children[WIDTH];
+            right->length = WIDTH - mid - 1;
+            relocate(split.key, inner->keys[mid]);
+            split.right = right;
+            inner->length = mid;
+            if(idx > mid) {
+                idx -= mid + 1;
+                inner = right;
+            }
+        }
+
+        for(u64 i = inner->length; i > idx; i--) {
+            relocate(inner->keys[i], inner->keys[i - 1]);
+            inner->children[i + 1] = inner->children[i];
+        }
+        relocate(inner->keys[idx], child.key);
+        inner->children[idx + 1] = child.right;
+        inner->length++;
+        return splits;
+    }
+
+    [[nodiscard]] bool insert_leaf(Leaf* leaf, K&& key, V&& value, V*& slot,
+                                   Split& split) noexcept {
+        u64 idx = search(leaf, key);
+        if(idx < leaf->length && !(key < *leaf->keys[idx])) {
+            *leaf->values[idx] = rpp::move(value);
+            slot = &*leaf->values[idx];
+            return false;
+        }
+
+        bool splits = leaf->length == WIDTH;
+        if(splits) {
+            u64 mid = WIDTH / 2;
+            Leaf* right = make_leaf();
+            for(u64 i = mid; i < WIDTH; i++) {
+                relocate(right->keys[i - mid], leaf->keys[i]);
+                relocate(right->values[i - mid], leaf->values[i]);
+            }
+            right->length = WIDTH - mid;
+            right->next = leaf->next;
+            leaf->next = right;
+            leaf->length = mid;
+            if(idx > mid) {
+                idx -= mid;
+                leaf = right;
+            }
+            split.right = right;
+        }
+
+        for(u64 i = leaf->length; i > idx; i--) {
+            relocate(leaf->keys[i], leaf->keys[i - 1]);
+            relocate(leaf->values[i], leaf->values[i - 1]);
+        }
+        leaf->keys[idx].construct(rpp::move(key));
+        leaf->values[idx].construct(rpp::move(value));
+        leaf->length++;
+        slot = &*leaf->values[idx];
+        length_++;
+
+        if(splits) split.key.construct(copy(*static_cast<Leaf*>(split.right)->keys[0]));
+        return splits;
+    }
+
+    static void destroy(Node* node) noexcept {
+        for(u64 i = 0; i < node->length; i++) node->keys[i].destruct();
+        if(node->leaf) {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            for(u64 i = 0; i < leaf->length; i++) leaf->values[i].destruct();
+            leaf->~Leaf();
+        } else {
+            Inner* inner = static_cast<Inner*>(node);
+            for(u64 i = 0; i <= inner->length; i++) destroy(inner->children[i]);
+            inner->~Inner();
+        }
+        A::free(node);
+    }
+
+    Node* root_ = null;
+    u64 length_ = 0;
+
+    friend struct Reflect::Refl<BTree_Map>;
+};
+
+template<typename K, typename V, u64 W>
+RPP_NAMED_TEMPLATE_RECORD(::rpp::detail::BTree_Node, "BTree_Node", RPP_PACK(K, V, W),
+                          RPP_FIELD(length), RPP_FIELD(leaf));
+
+template<Ordered K, Movable V, Allocator A>
+RPP_TEMPLATE_RECORD(BTree_Map, RPP_PACK(K, V, A), RPP_FIELD(root_), RPP_FIELD(length_));
+
+namespace Format {
+
+template<Reflectable K, Reflectable V, Allocator A>
+struct Measure<BTree_Map<K, V, A>> {
+    [[nodiscard]] static u64 measure(const BTree_Map<K, V, A>& map) noexcept {
+        u64 n = 0;
+        u64 length = 11;
+        map.each([&](const K& key, const V& value) {
+            length += 5 + Measure<K>::measure(key) + Measure<V>::measure(value);
+            if(++n < map.length()) length += 2;
+        });
+        return length;
+    }
+};
+
+template<Allocator O, Reflectable K, Reflectable V, Allocator A>
+struct Write<O, BTree_Map<K, V, A>> {
+    [[nodiscard]] static u64 write(String<O>& output, u64 idx,
+                                   const BTree_Map<K, V, A>& map) noexcept {
+        idx = output.write(idx, "BTree_Map["_v);
+        u64 n = 0;
+        map.each([&](const K& key, const V& value) {
+            idx = output.write(idx, "{"_v);
+            idx = Write<O, K>::write(output, idx, key);
+            idx = output.write(idx, " : "_v);
+            idx = Write<O, V>::write(output, idx, value);
+            idx = output.write(idx, '}');
+            if(++n < map.length()) idx = output.write(idx, ", "_v);
+        });
+        return output.write(idx, ']');
+    }
+};
+
+} // namespace Format
+
+} // namespace rpp
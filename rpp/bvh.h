@@ -0,0 +1,320 @@
+#pragma once
+
+#include "async.h"
+#include "base.h"
+#include "pool.h"
+#include "vmath.h"
+
+namespace rpp::Math {
+
+// Bounding volume hierarchy over a slice of boxes, built top-down with the binned surface area
+// heuristic. Primitives are identified by their index in the slice.
+//
+// Nodes are stored flat in depth-first order, 32 bytes each, so a node's first child directly
+// follows it and traversal walks mostly forward through memory. Building on a pool forks large
+// subtrees onto other workers; the result is identical to building serially.
+template<Allocator A = Mdefault>
+struct BVH {
+
+    // Interior nodes have count zero, and their second child is at offset. Leaves hold count
+    // primitives, starting at offset in primitives().
+    struct Node {
+        BBox box;
+        u32 offset = 0;
+        u32 count = 0;
+
+        [[nodiscard]] bool leaf() const noexcept {
+            return count > 0;
+        }
+    };
+    static_assert(sizeof(Node) == 32);
+
+    constexpr static u32 BINS = 16;
+    constexpr static u32 LEAF_SIZE = 4;
+    // Below this depth, nodes split at the median instead, which bounds the depth of the tree.
+    constexpr static u32 SAH_DEPTH = 32;
+    constexpr static u32 MAX_DEPTH = SAH_DEPTH + 32;
+    // Subtrees with fewer primitives than this are built by the worker that split them.
+    constexpr static u32 FORK_SIZE = 4096;
+
+    BVH() noexcept = default;
+    ~BVH() noexcept = default;
+
+    BVH(const BVH&) noexcept = delete;
+    BVH& operator=(const BVH&) noexcept = delete;
+
+    BVH(BVH&&) noexcept = default;
+    BVH& operator=(BVH&&) noexcept = default;
+
+    [[nodiscard]] static BVH build(Slice<BBox> boxes) noexcept {
+        BVH bvh;
+        Builder builder{boxes, bvh};
+        if(!boxes.empty()) build_node(builder, 0, builder.length, 0, 0);
+        bvh.compact(builder);
+        return bvh;
+    }
+
+    template<Allocator P>
+    [[nodiscard]] static Async::Task<BVH> build(Async::Pool<P>& pool, Slice<BBox> boxes) noexcept {
+        co_await pool.suspend();
+        BVH bvh;
+        Builder builder{boxes, bvh};
+        if(!boxes.empty()) co_await build_tasks(pool, builder, 0, builder.length, 0, 0);
+        bvh.compact(builder);
+        co_return bvh;
+    }
+
+    // Calls f(primitive, t_max) for every primitive in a leaf the ray enters before t_max, visiting
+    // nearer children first. f returns the new t_max, so a closest-hit search can shrink it to
+    // skip subtrees behind the closest hit so far.
+    template<typename F>
+        requires Invocable<F&, u32, f32>
+    void traverse(const Ray& ray, f32 t_max, F f) const noexcept {
+        if(nodes_.empty() || !nodes_[0].box.hit(ray, 0.0f, t_max).ok()) return;
+
+        struct Entry {
+            u32 node;
+            f32 t;
+        };
+        Entry stack[MAX_DEPTH];
+        u32 top = 0;
+        u32 node = 0;
+        for(;;) {
+            const Node& n = nodes_[node];
+            if(n.leaf()) {
+                for(u32 i = 0; i < n.count; i++) t_max = f(primitives_[n.offset + i], t_max);
+            } else {
+                u32 first = node + 1;
+                u32 second = n.offset;
+                Opt<f32> hit_first = nodes_[first].box.hit(ray, 0.0f, t_max);
+                Opt<f32> hit_second = nodes_[second].box.hit(ray, 0.0f, t_max);
+                if(hit_first.ok() && hit_second.ok()) {
+                    f32 t_second = *hit_second;
+                    if(t_second < *hit_first) {
+                        rpp::swap(first, second);
+                        t_second = *hit_first;
+                    }
+                    assert(top < MAX_DEPTH);
+                    stack[top++] = Entry{second, t_second};
+                    node = first;
+                    continue;
+                }
+                if(hit_first.ok()) {
+                    node = first;
+                    continue;
+                }
+                if(hit_second.ok()) {
+                    node = second;
+                    continue;
+                }
+            }
+            // Pushed nodes may lie behind hits found since.
+            do {
+                if(!top) return;
+                top--;
+            } while(stack[top].t > t_max);
+            node = stack[top].node;
+        }
+    }
+
+    [[nodiscard]] BBox bounds() const noexcept {
+        return nodes_.empty() ? BBox{} : nodes_[0].box;
+    }
+    [[nodiscard]] Slice<Node> nodes() const noexcept {
+        return Slice<Node>{nodes_};
+    }
+    [[nodiscard]] Slice<u32> primitives() const noexcept {
+        return Slice<u32>{primitives_};
+    }
+
+private:
+    // While building, a subtree over n primitives owns the 2n - 1 node slots starting at its
+    // root, which is enough for any tree with non-empty leaves. Its left subtree takes the slots
+    // after the root, so subtrees build in parallel, and compact() drops unused slots afterwards.
+    struct Builder {
+        explicit Builder(Slice<BBox> boxes, BVH& bvh) noexcept
+            : boxes{boxes}, length{static_cast<u32>(boxes.length())},
+              slots{Vec<Node, A>::make(length ? 2 * length - 1 : 0)} {
+            assert(boxes.length() <= Limits<u32>::max() / 2);
+            bvh.primitives_ = Vec<u32, A>::make(length);
+            for(u32 i = 0; i < length; i++) bvh.primitives_[i] = i;
+            primitives = bvh.primitives_.data();
+        }
+
+        Slice<BBox> boxes;
+        u32 length;
+        u32* primitives = null;
+        Vec<Node, A> slots;
+    };
+
+    struct Bin {
+        BBox box;
+        u32 count = 0;
+    };
+
+    [[nodiscard]] static u32 bin_of(f32 center, f32 min, f32 scale) noexcept {
+        return Math::min(static_cast<u32>((center - min) * scale), BINS - 1);
+    }
+
+    // Fills in the node at slot and partitions its primitives, returning the first primitive of
+    // the second child, or end for a leaf.
+    [[nodiscard]] static u32 split(Builder& builder, u32 begin, u32 end, u32 slot,
+                                   u32 depth) noexcept {
+        u32* primitives = builder.primitives;
+        BBox box, centers;
+        for(u32 i = begin; i < end; i++) {
+            const BBox& b = builder.boxes[primitives[i]];
+            box.enclose(b);
+            centers.enclose(b.center());
+        }
+
+        Node& node = builder.slots[slot];
+        node.box = box;
+        u32 count = end - begin;
+        if(count <= 1) {
+            node.offset = begin;
+            node.count = count;
+            return end;
+        }
+
+        u32 best_axis = 0;
+        u32 best_bin = 0;
+        f32 best_cost = Limits<f32>::max();
+        if(depth < SAH_DEPTH) {
+            for(u32 axis = 0; axis < 3; axis++) {
+                f32 extent = centers.max[axis] - centers.min[axis];
+                if(!(extent > 0.0f)) continue;
+                f32 scale = static_cast<f32>(BINS) / extent;
+
+                Bin bins[BINS];
+                for(u32 i = begin; i < end; i++) {
+                    const BBox& b = builder.boxes[primitives[i]];
+                    Bin& bin = bins[bin_of(b.center()[axis], centers.min[axis], scale)];
+                    bin.box.enclose(b);
+                    bin.count++;
+                }
+
+                // Cost of splitting after bin i, summed from the right.
+                f32 right_costs[BINS];
+                BBox right;
+                u32 right_count = 0;
+                for(u32 i = BINS - 1; i > 0; i--) {
+                    right.enclose(bins[i].box);
+                    right_count += bins[i].count;
+                    right_costs[i - 1] = right_count ? right.surface_area() * right_count : 0.0f;
+                }
+                BBox left;
+                u32 left_count = 0;
+                for(u32 i = 0; i + 1 < BINS; i++) {
+                    left.enclose(bins[i].box);
+                    left_count += bins[i].count;
+                    if(!left_count || left_count == count) continue;
+                    f32 cost = left.surface_area() * left_count + right_costs[i];
+                    if(cost < best_cost) {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_bin = i;
+                    }
+                }
+            }
+        }
+
+        // With unit cost per traversal step and per primitive, a leaf costs count times the
+        // node's area and a split costs the area plus each child's area times its count.
+        f32 area = box.surface_area();
+        bool sah = best_cost < Limits<f32>::max();
+        if(count <= LEAF_SIZE && (!sah || area * count <= area + best_cost)) {
+            node.offset = begin;
+            node.count = count;
+            return end;
+        }
+
+        u32 mid = begin + count / 2;
+        if(sah) {
+            f32 min = centers.min[best_axis];
+            f32 scale = static_cast<f32>(BINS) / (centers.max[best_axis] - min);
+            u32 i = begin;
+            u32 j = end;
+            while(i < j) {
+                f32 center = builder.boxes[primitives[i]].center()[best_axis];
+                if(bin_of(center, min, scale) <= best_bin) {
+                    i++;
+                } else {
+                    rpp::swap(primitives[i], primitives[--j]);
+                }
+            }
+            mid = i;
+        }
+        assert(mid > begin && mid < end);
+
+        node.offset = slot + 2 * (mid - begin);
+        node.count = 0;
+        return mid;
+    }
+
+    static void build_node(Builder& builder, u32 begin, u32 end, u32 slot, u32 depth) noexcept {
+        u32 mid = split(builder, begin, end, slot, depth);
+        if(mid == end) return;
+        u32 second = builder.slots[slot].offset;
+        build_node(builder, begin, mid, slot + 1, depth + 1);
+        build_node(builder, mid, end, second, depth + 1);
+    }
+
+    template<Allocator P>
+    [[nodiscard]] static Async::Task<void> build_tasks(Async::Pool<P>& pool, Builder& builder,
+                                                       u32 begin, u32 end, u32 slot,
+                                                       u32 depth) noexcept;
+
+    template<Allocator P>
+    [[nodiscard]] static Async::Task<void> fork_tasks(Async::Pool<P>& pool, Builder& builder,
+                                                      u32 begin, u32 end, u32 slot,
+                                                      u32 depth) noexcept {
+        co_await pool.suspend();
+        co_await build_tasks(pool, builder, begin, end, slot, depth);
+    }
+
+    template<Allocator P>
+    [[nodiscard]] static Async::Task<void> build_tasks(Async::Pool<P>& pool, Builder& builder,
+                                                       u32 begin, u32 end, u32 slot,
+                                                       u32 depth) noexcept {
+        if(end - begin <= FORK_SIZE) {
+            build_node(builder, begin, end, slot, depth);
+            co_return;
+        }
+        u32 mid = split(builder, begin, end, slot, depth);
+        if(mid == end) co_return;
+        u32 second = builder.slots[slot].offset;
+        Async::Task<void> right = fork_tasks(pool, builder, mid, end, second, depth + 1);
+        co_await build_tasks(pool, builder, begin, mid, slot + 1, depth + 1);
+        co_await right;
+    }
+
+    // Copies the used slots into nodes_ in depth-first order.
+    void compact(const Builder& builder) noexcept {
+        if(!builder.length) return;
+        struct Entry {
+            u32 slot;
+            u32 parent;
+        };
+        constexpr u32 ROOT = Limits<u32>::max();
+        Entry stack[MAX_DEPTH + 1];
+        u32 top = 0;
+        stack[top++] = Entry{0, ROOT};
+        while(top) {
+            Entry entry = stack[--top];
+            u32 index = static_cast<u32>(nodes_.length());
+            if(entry.parent != ROOT) nodes_[entry.parent].offset = index;
+            const Node& node = builder.slots[entry.slot];
+            nodes_.push(Node{node});
+            if(!node.leaf()) {
+                stack[top++] = Entry{node.offset, index};
+                stack[top++] = Entry{entry.slot + 1, ROOT};
+            }
+        }
+    }
+
+    Vec<Node, A> nodes_;
+    Vec<u32, A> primitives_;
+};
+
+} // namespace rpp::Math
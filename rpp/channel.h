@@ -0,0 +1,251 @@
+#pragma once
+
+#include "async.h"
+#include "base.h"
+#include "concurrent_queue.h"
+#include "pool.h"
+
+namespace rpp::Async {
+
+// Bounded MPMC channel between coroutines on a pool. Values travel through a lock-free ring, so
+// while it is neither full nor empty, send and recv complete without suspending or locking.
+//
+// A sender that finds the ring full, or a receiver that finds it empty, takes the waiter lock,
+// announces itself, retries, and only then parks its coroutine. Every successful push or pop
+// checks for announced waiters and hands them a value or a free slot, rescheduling them on the
+// pool. Full channels thus apply backpressure to producers without blocking a worker thread.
+//
+// After close, sends fail and receives drain the remaining values, then return none.
+template<Movable T, u64 N, Allocator A = Alloc>
+struct Channel {
+
+    struct Send;
+    struct Recv;
+
+    explicit Channel(Pool<A>& pool) noexcept : pool{pool} {
+    }
+    ~Channel() noexcept {
+        assert(!senders.head && !receivers.head);
+    }
+
+    Channel(const Channel&) noexcept = delete;
+    Channel& operator=(const Channel&) noexcept = delete;
+
+    Channel(Channel&&) noexcept = delete;
+    Channel& operator=(Channel&&) noexcept = delete;
+
+    [[nodiscard]] constexpr static u64 capacity() noexcept {
+        return N;
+    }
+
+    // Resumes with false if the channel was closed, dropping the value.
+    [[nodiscard]] Send send(T value) noexcept {
+        return Send{*this, rpp::move(value)};
+    }
+    // Resumes with none once the channel is closed and drained.
+    [[nodiscard]] Recv recv() noexcept {
+        return Recv{*this};
+    }
+
+    [[nodiscard]] bool try_send(T&& value) noexcept {
+        if(closed.load()) return false;
+        if(!ring.try_push(rpp::move(value))) return false;
+        pump();
+        return true;
+    }
+    [[nodiscard]] Opt<T> try_recv() noexcept {
+        Opt<T> value = ring.try_pop();
+        if(value.ok()) pump();
+        return value;
+    }
+
+    void close() noexcept {
+        Send* failed = null;
+        Recv* drained = null;
+        {
+            Thread::Lock lock(mut);
+            static_cast<void>(closed.exchange(1));
+            failed = senders.head;
+            senders.head = senders.tail = null;
+            senders_waiting.store(0);
+            // Receivers only wait on an empty ring, but values may have landed since.
+            drained = receivers.head;
+            receivers.head = receivers.tail = null;
+            receivers_waiting.store(0);
+            for(Recv* r = drained; r; r = r->next) r->value = ring.try_pop();
+        }
+        while(failed) {
+            Send* next = failed->next;
+            failed->sent = false;
+            pool.enqueue(Handle<>{failed->handle});
+            failed = next;
+        }
+        while(drained) {
+            Recv* next = drained->next;
+            pool.enqueue(Handle<>{drained->handle});
+            drained = next;
+        }
+    }
+
+    struct Send {
+        [[nodiscard]] bool await_ready() noexcept {
+            if(channel.closed.load()) {
+                sent = false;
+                return true;
+            }
+            if(!channel.ring.try_push(rpp::move(value))) return false;
+            channel.pump();
+            return true;
+        }
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> task) noexcept {
+            handle = task;
+            {
+                Thread::Lock lock(channel.mut);
+                channel.senders_waiting.incr();
+                if(channel.closed.load()) {
+                    channel.senders_waiting.decr();
+                    sent = false;
+                    return false;
+                }
+                if(!channel.ring.try_push(rpp::move(value))) {
+                    channel.senders.push(this);
+                    return true;
+                }
+                channel.senders_waiting.decr();
+            }
+            channel.pump();
+            return false;
+        }
+        bool await_resume() noexcept {
+            return sent;
+        }
+
+    private:
+        explicit Send(Channel& channel, T&& value) noexcept
+            : channel{channel}, value{rpp::move(value)} {
+        }
+
+        Channel& channel;
+        T value;
+        bool sent = true;
+        std::coroutine_handle<> handle;
+        Send* next = null;
+
+        friend struct Channel;
+    };
+
+    struct Recv {
+        [[nodiscard]] bool await_ready() noexcept {
+            value = channel.ring.try_pop();
+            if(value.ok()) {
+                channel.pump();
+                return true;
+            }
+            return channel.closed.load() != 0;
+        }
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> task) noexcept {
+            handle = task;
+            {
+                Thread::Lock lock(channel.mut);
+                channel.receivers_waiting.incr();
+                value = channel.ring.try_pop();
+                if(!value.ok() && !channel.closed.load()) {
+                    channel.receivers.push(this);
+                    return true;
+                }
+                channel.receivers_waiting.decr();
+            }
+            if(value.ok()) channel.pump();
+            return false;
+        }
+        [[nodiscard]] Opt<T> await_resume() noexcept {
+            return rpp::move(value);
+        }
+
+    private:
+        explicit Recv(Channel& channel) noexcept : channel{channel} {
+        }
+
+        Channel& channel;
+        Opt<T> value;
+        std::coroutine_handle<> handle;
+        Recv* next = null;
+
+        friend struct Channel;
+    };
+
+private:
+    template<typename W>
+    struct Waiters {
+        void push(W* waiter) noexcept {
+            waiter->next = null;
+            if(tail) {
+                tail->next = waiter;
+            } else {
+                head = waiter;
+            }
+            tail = waiter;
+        }
+        [[nodiscard]] W* pop() noexcept {
+            W* waiter = head;
+            head = waiter->next;
+            if(!head) tail = null;
+            return waiter;
+        }
+
+        W* head = null;
+        W* tail = null;
+    };
+
+    // Matches announced waiters against the ring until neither side can make progress. Handing a
+    // receiver a value frees a slot for a sender, and vice versa, so both sides are retried.
+    void pump() noexcept {
+        for(;;) {
+            bool progress = false;
+            if(receivers_waiting.load()) progress = wake_receiver() || progress;
+            if(senders_waiting.load()) progress = wake_sender() || progress;
+            if(!progress) return;
+        }
+    }
+
+    [[nodiscard]] bool wake_receiver() noexcept {
+        Recv* receiver = null;
+        {
+            Thread::Lock lock(mut);
+            if(!receivers.head) return false;
+            Opt<T> value = ring.try_pop();
+            if(!value.ok()) return false;
+            receiver = receivers.pop();
+            receiver->value = rpp::move(value);
+            receivers_waiting.decr();
+        }
+        pool.enqueue(Handle<>{receiver->handle});
+        return true;
+    }
+
+    [[nodiscard]] bool wake_sender() noexcept {
+        Send* sender = null;
+        {
+            Thread::Lock lock(mut);
+            if(!senders.head) return false;
+            if(!ring.try_push(rpp::move(senders.head->value))) return false;
+            sender = senders.pop();
+            senders_waiting.decr();
+        }
+        pool.enqueue(Handle<>{sender->handle});
+        return true;
+    }
+
+    Pool<A>& pool;
+    Concurrent_Queue<T, N> ring;
+
+    Thread::Atomic closed;
+    Thread::Atomic senders_waiting;
+    Thread::Atomic receivers_waiting;
+
+    Thread::Mutex mut;
+    Waiters<Send> senders;
+    Waiters<Recv> receivers;
+};
+
+} // namespace rpp::Async
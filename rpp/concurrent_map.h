@@ -0,0 +1,260 @@
+#pragma once
+
+#include "base.h"
+
+namespace rpp {
+
+// Hash map for read-mostly state shared between threads. Keys are split into stripes by hash:
+// writers lock a single stripe, while readers copy results out under the stripe's sequence lock
+// and retry if a writer intervened. Stripes grow independently, so a resize only rehashes a
+// fraction of the map. Replaced stripe tables are kept until the map is destroyed, since readers
+// may still be probing them. Keys and values are copied racily and validated afterwards, so both
+// must be trivially copyable.
+template<Key K, Movable V, Allocator A = Mdefault, u64 Stripes = 64>
+    requires Trivially_Copyable<K> && Trivially_Copyable<V> &&
+             (Stripes > 0 && (Stripes & (Stripes - 1)) == 0)
+struct Concurrent_Map {
+    using Slot = detail::Map_Slot<K, V>;
+
+    Concurrent_Map() noexcept = default;
+    ~Concurrent_Map() noexcept {
+        for(Stripe& stripe : stripes) {
+            A::free(stripe.table());
+            while(Table* table = stripe.retired) {
+                stripe.retired = table->retired;
+                A::free(table);
+            }
+        }
+    }
+
+    Concurrent_Map(const Concurrent_Map&) noexcept = delete;
+    Concurrent_Map& operator=(const Concurrent_Map&) noexcept = delete;
+
+    Concurrent_Map(Concurrent_Map&&) noexcept = delete;
+    Concurrent_Map& operator=(Concurrent_Map&&) noexcept = delete;
+
+    [[nodiscard]] u64 length() const noexcept {
+        return length_.load<u64>();
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return length() == 0;
+    }
+
+    void insert(K key, V value) noexcept {
+        u64 hash = hash_nonzero(key);
+        Stripe& stripe = stripe_of(hash);
+        Thread::Lock lock(stripe.mutex);
+
+        Table* table = stripe.table();
+        if(!table || stripe.length >= table->usable()) {
+            grow(stripe);
+            table = stripe.table();
+        }
+
+        begin_write(stripe);
+        bool added = insert_slot(*table, Slot{rpp::move(key), rpp::move(value)});
+        end_write(stripe);
+
+        if(added) {
+            stripe.length++;
+            length_.incr();
+        }
+    }
+
+    [[nodiscard]] bool try_erase(const K& key) noexcept {
+        u64 hash = hash_nonzero(key);
+        Stripe& stripe = stripe_of(hash);
+        Thread::Lock lock(stripe.mutex);
+
+        Table* table = stripe.table();
+        if(!table) return false;
+
+        Opt<u64> idx = find(*table, hash, key);
+        if(!idx.ok()) return false;
+
+        begin_write(stripe);
+        table->slots()[*idx].~Slot();
+        fix_up(*table, *idx);
+        end_write(stripe);
+
+        stripe.length--;
+        length_.decr();
+        return true;
+    }
+
+    [[nodiscard]] Opt<V> try_get(const K& key) const noexcept {
+        u64 hash = hash_nonzero(key);
+        const Stripe& stripe = stripe_of(hash);
+        for(;;) {
+            i64 version = stripe.version.load();
+            if(version & 1) {
+                Thread::pause();
+                continue;
+            }
+            Opt<V> ret;
+            if(const Table* table = stripe.table()) {
+                if(Opt<u64> idx = find(*table, hash, key); idx.ok()) {
+                    ret = Opt<V>{V{table->slots()[*idx].data->second}};
+                }
+            }
+            if(stripe.version.load() == version) return ret;
+        }
+    }
+
+    [[nodiscard]] bool contains(const K& key) const noexcept {
+        return try_get(key).ok();
+    }
+
+    // Visits a consistent snapshot of each stripe in turn, holding that stripe's lock.
+    template<typename F>
+        requires Invocable<F, const K&, const V&>
+    void for_each(F&& f) const noexcept {
+        for(const Stripe& stripe : stripes) {
+            Thread::Lock lock(stripe.mutex);
+            const Table* table = stripe.table();
+            if(!table) continue;
+            for(u64 i = 0; i < table->capacity; i++) {
+                const Slot& slot = table->slots()[i];
+                if(slot.hash != Slot::EMPTY) f(slot.data->first, slot.data->second);
+            }
+        }
+    }
+
+private:
+    struct Table {
+        u64 capacity;
+        u64 shift;
+        Table* retired;
+
+        [[nodiscard]] u64 usable() const noexcept {
+            return (capacity / 4) * 3;
+        }
+        [[nodiscard]] Slot* slots() noexcept {
+            return reinterpret_cast<Slot*>(reinterpret_cast<u8*>(this) + slots_offset);
+        }
+        [[nodiscard]] const Slot* slots() const noexcept {
+            return reinterpret_cast<const Slot*>(reinterpret_cast<const u8*>(this) +
+                                                 slots_offset);
+        }
+    };
+
+    constexpr static u64 slots_offset = Math::align(sizeof(Table), alignof(Slot));
+    constexpr static u64 table_align = Math::max<u64>(alignof(Table), alignof(Slot));
+
+    struct Stripe {
+        [[nodiscard]] Table* table() const noexcept {
+            return reinterpret_cast<Table*>(table_.load());
+        }
+
+        Thread::Atomic version;
+        Thread::Atomic table_;
+        mutable Thread::Mutex mutex;
+        Table* retired = null;
+        u64 length = 0;
+    };
+
+    [[nodiscard]] Stripe& stripe_of(u64 hash) noexcept {
+        return stripes[(hash >> 1) & (Stripes - 1)];
+    }
+    [[nodiscard]] const Stripe& stripe_of(u64 hash) const noexcept {
+        return stripes[(hash >> 1) & (Stripes - 1)];
+    }
+
+    static void begin_write(Stripe& stripe) noexcept {
+        stripe.version.incr();
+    }
+    static void end_write(Stripe& stripe) noexcept {
+        stripe.version.incr();
+    }
+
+    [[nodiscard]] static Table* make_table(u64 capacity) noexcept {
+        u64 size = slots_offset + capacity * sizeof(Slot);
+        Table* table = reinterpret_cast<Table*>(alloc_aligned<A, table_align>(size));
+        Libc::memset(table, 0, size);
+        table->capacity = capacity;
+        table->shift = Math::ctlz(capacity) + 1;
+        table->retired = null;
+        return table;
+    }
+
+    // The old table is copied rather than moved, readers may still be probing it.
+    static void grow(Stripe& stripe) noexcept {
+        Table* old = stripe.table();
+        Table* table = make_table(old ? 2 * old->capacity : 8);
+        if(old) {
+            for(u64 i = 0; i < old->capacity; i++) {
+                const Slot& slot = old->slots()[i];
+                if(slot.hash != Slot::EMPTY) {
+                    static_cast<void>(
+                        insert_slot(*table, Slot{K{slot.data->first}, V{slot.data->second}}));
+                }
+            }
+            old->retired = stripe.retired;
+            stripe.retired = old;
+        }
+        begin_write(stripe);
+        static_cast<void>(stripe.table_.exchange(reinterpret_cast<i64>(table)));
+        end_write(stripe);
+    }
+
+    [[nodiscard]] static bool insert_slot(Table& table, Slot&& slot) noexcept {
+        Slot* slots = table.slots();
+        u64 idx = slot.hash >> table.shift;
+        u64 dist = 0;
+        for(;;) {
+            u64 hash = slots[idx].hash;
+            if(hash == Slot::EMPTY) {
+                slots[idx] = rpp::move(slot);
+                return true;
+            }
+            if(hash == slot.hash && slots[idx].data->first == slot.data->first) {
+                slots[idx] = rpp::move(slot);
+                return false;
+            }
+            u64 hashidx = hash >> table.shift;
+            u64 hashdist = hashidx <= idx ? idx - hashidx : table.capacity + idx - hashidx;
+            if(hashdist < dist) {
+                swap(slots[idx], slot);
+                dist = hashdist;
+            }
+            dist++;
+            if(++idx == table.capacity) idx = 0;
+        }
+    }
+
+    static void fix_up(Table& table, u64 idx) noexcept {
+        Slot* slots = table.slots();
+        for(;;) {
+            u64 next = idx == table.capacity - 1 ? 0 : idx + 1;
+            u64 nexthash_ = slots[next].hash;
+            if(nexthash_ == Slot::EMPTY) return;
+            u64 next_ideal = nexthash_ >> table.shift;
+            if(next == next_ideal) return;
+            slots[idx] = rpp::move(slots[next]);
+            idx = next;
+        }
+    }
+
+    // Bounded by capacity, since a racing reader may observe a table mid-update.
+    [[nodiscard]] static Opt<u64> find(const Table& table, u64 hash, const K& key) noexcept {
+        const Slot* slots = table.slots();
+        u64 idx = hash >> table.shift;
+        for(u64 dist = 0; dist < table.capacity; dist++) {
+            u64 k = slots[idx].hash;
+            if(k == Slot::EMPTY) return {};
+            if(k == hash && slots[idx].data->first == key) {
+                return Opt<u64>{idx};
+            }
+            u64 kidx = k >> table.shift;
+            u64 kdist = kidx <= idx ? idx - kidx : table.capacity + idx - kidx;
+            if(kdist < dist) return {};
+            if(++idx == table.capacity) idx = 0;
+        }
+        return {};
+    }
+
+    Thread::Atomic length_;
+    Stripe stripes[Stripes];
+};
+
+} // namespace rpp
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "base.h"
+
+namespace rpp {
+
+enum class Queue_Mode : u8 { mpmc, mpsc, spsc };
+
+// Bounded lock-free ring buffer for handing values between threads. Each slot carries a sequence
+// number recording which lap of the ring may use it next (Vyukov style), so producers and
+// consumers claim slots with a single compare-and-swap on their own cursor and never touch a lock.
+// Single producer or consumer modes skip the compare-and-swap on that side.
+//
+// push and pop block on a futex eventcount when the queue is full or empty. The futex is only
+// touched when a thread is actually waiting, so uncontended handoff stays on the fast path.
+template<Movable T, u64 N, Queue_Mode M = Queue_Mode::mpmc>
+    requires(N > 0 && (N & (N - 1)) == 0)
+struct Concurrent_Queue {
+
+    Concurrent_Queue() noexcept {
+        for(u64 i = 0; i < N; i++) {
+            static_cast<void>(slots[i].sequence.exchange(static_cast<i64>(i)));
+        }
+    }
+    ~Concurrent_Queue() noexcept {
+        while(try_pop().ok()) {
+        }
+    }
+
+    Concurrent_Queue(const Concurrent_Queue&) noexcept = delete;
+    Concurrent_Queue& operator=(const Concurrent_Queue&) noexcept = delete;
+
+    Concurrent_Queue(Concurrent_Queue&&) noexcept = delete;
+    Concurrent_Queue& operator=(Concurrent_Queue&&) noexcept = delete;
+
+    [[nodiscard]] constexpr static u64 capacity() noexcept {
+        return N;
+    }
+
+    // Approximate while other threads are pushing or popping.
+    [[nodiscard]] u64 length() const noexcept {
+        i64 length = tail.cursor.load() - head.cursor.load();
+        return length < 0 ? 0 : Math::min(static_cast<u64>(length), N);
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return length() == 0;
+    }
+
+    // Returns false if the queue is full, leaving the arguments untouched.
+    template<typename... Args>
+        requires Constructable<T, Args...>
+    [[nodiscard]] bool try_emplace(Args&&... args) noexcept {
+        i64 position = 0;
+        Slot* slot = claim_push(position);
+        if(!slot) return false;
+        slot->value.construct(rpp::forward<Args>(args)...);
+        static_cast<void>(slot->sequence.exchange(position + 1));
+        notify(not_empty, consumers_waiting);
+        return true;
+    }
+    [[nodiscard]] bool try_push(T&& value) noexcept {
+        return try_emplace(rpp::move(value));
+    }
+    [[nodiscard]] bool try_push(const T& value) noexcept
+        requires Copy_Constructable<T>
+    {
+        return try_emplace(value);
+    }
+
+    [[nodiscard]] Opt<T> try_pop() noexcept {
+        i64 position = 0;
+        Slot* slot = claim_pop(position);
+        if(!slot) return {};
+        Opt<T> ret{rpp::move(*slot->value)};
+        slot->value.destruct();
+        static_cast<void>(slot->sequence.exchange(position + static_cast<i64>(N)));
+        notify(not_full, producers_waiting);
+        return ret;
+    }
+
+    // Blocks while the queue is full.
+    void push(T&& value) noexcept {
+        wait_until(not_full, producers_waiting, [&]() { return try_push(rpp::move(value)); });
+    }
+    void push(const T& value) noexcept
+        requires Copy_Constructable<T>
+    {
+        wait_until(not_full, producers_waiting, [&]() { return try_push(value); });
+    }
+
+    // Blocks while the queue is empty.
+    [[nodiscard]] T pop() noexcept {
+        Opt<T> ret;
+        wait_until(not_empty, consumers_waiting, [&]() {
+            ret = try_pop();
+            return ret.ok();
+        });
+        return rpp::move(*ret);
+    }
+
+private:
+    constexpr static u64 mask = N - 1;
+    constexpr static bool multi_producer = M != Queue_Mode::spsc;
+    constexpr static bool multi_consumer = M == Queue_Mode::mpmc;
+
+    struct Slot {
+        Thread::Atomic sequence;
+        Storage<T> value;
+    };
+
+    struct alignas(64) Cursor {
+        Thread::Atomic cursor;
+    };
+
+    [[nodiscard]] Slot* claim_push(i64& position) noexcept {
+        position = tail.cursor.load();
+        for(;;) {
+            Slot& slot = slots[static_cast<u64>(position) & mask];
+            i64 diff = slot.sequence.load() - position;
+            if(diff < 0) return null;
+            if(diff == 0) {
+                if constexpr(multi_producer) {
+                    i64 found = tail.cursor.compare_and_swap(position, position + 1);
+                    if(found != position) {
+                        position = found;
+                        continue;
+                    }
+                } else {
+                    static_cast<void>(tail.cursor.exchange(position + 1));
+                }
+                return &slot;
+            }
+            position = tail.cursor.load();
+        }
+    }
+
+    [[nodiscard]] Slot* claim_pop(i64& position) noexcept {
+        position = head.cursor.load();
+        for(;;) {
+            Slot& slot = slots[static_cast<u64>(position) & mask];
+            i64 diff = slot.sequence.load() - (position + 1);
+            if(diff < 0) return null;
+            if(diff == 0) {
+                if constexpr(multi_consumer) {
+                    i64 found = head.cursor.compare_and_swap(position, position + 1);
+                    if(found != position) {
+                        position = found;
+                        continue;
+                    }
+                } else {
+                    static_cast<void>(head.cursor.exchange(position + 1));
+                }
+                return &slot;
+            }
+            position = head.cursor.load();
+        }
+    }
+
+    static void notify(Thread::Futex& futex, Thread::Atomic& waiting) noexcept {
+        if(waiting.load() > 0) futex.incr_and_wake(1);
+    }
+
+    // Waiters announce themselves before retrying, so a concurrent producer or consumer either
+    // sees the announcement and wakes them, or its result is visible to the retry.
+    template<typename F>
+    static void wait_until(Thread::Futex& futex, Thread::Atomic& waiting, F&& attempt) noexcept {
+        for(;;) {
+            if(attempt()) return;
+            u32 key = futex.load();
+            waiting.incr();
+            if(attempt()) {
+                waiting.decr();
+                return;
+            }
+            futex.wait(key);
+            waiting.decr();
+        }
+    }
+
+    Cursor tail;
+    Cursor head;
+
+    Thread::Futex not_empty;
+    Thread::Futex not_full;
+    Thread::Atomic consumers_waiting;
+    Thread::Atomic producers_waiting;
+
+    Slot slots[N];
+};
+
+template<Movable T, u64 N>
+using Spsc_Queue = Concurrent_Queue<T, N, Queue_Mode::spsc>;
+
+template<Movable T, u64 N>
+using Mpsc_Queue = Concurrent_Queue<T, N, Queue_Mode::mpsc>;
+
+} // namespace rpp
@@ -0,0 +1,363 @@
+
+#pragma once
+
+#include "base.h"
+
+namespace rpp {
+
+namespace detail {
+
+// Elements per deque block: the power of two that fills about 4 KB, but at least eight.
+[[nodiscard]] constexpr u64 deque_block(u64 size) noexcept {
+    u64 n = 8;
+    while(2 * n * size <= 4096) n *= 2;
+    return n;
+}
+
+} // namespace detail
+
+// Double-ended queue stored in fixed-size blocks, which are listed in a small ring of pointers.
+// Growing at either end adds a block and at most reallocates the ring, so elements never move and
+// references to them stay valid until they are popped. Emptied blocks are kept on a short free
+// list for reuse, and released beyond that, so a deque that drains gives its memory back.
+//
+// push, emplace and pop work at the same ends as they do for a Queue.
+template<Movable T, Allocator A = Mdefault>
+struct Deque {
+
+    constexpr static u64 BLOCK = detail::deque_block(sizeof(T));
+    constexpr static u64 MAX_FREE = 4;
+
+    Deque() noexcept = default;
+    ~Deque() noexcept {
+        clear();
+        while(free_) {
+            T* next = next_free(free_);
+            A::free(free_);
+            free_ = next;
+        }
+        A::free(index_);
+        index_ = null;
+        index_capacity_ = 0;
+        n_free_ = 0;
+    }
+
+    Deque(const Deque& src) noexcept = delete;
+    Deque& operator=(const Deque& src) noexcept = delete;
+
+    Deque(Deque&& src) noexcept {
+        take(src);
+    }
+    Deque& operator=(Deque&& src) noexcept {
+        this->~Deque();
+        take(src);
+        return *this;
+    }
+
+    T& push(const T& value) noexcept
+        requires Copy_Constructable<T>
+    {
+        return push(T{value});
+    }
+    T& push(T&& value) noexcept
+        requires Move_Constructable<T>
+    {
+        return *new(back_slot()) T{rpp::move(value)};
+    }
+    template<typename... Args>
+    T& emplace(Args&&... args) noexcept
+        requires Constructable<T, Args...>
+    {
+        return *new(back_slot()) T{rpp::forward<Args>(args)...};
+    }
+
+    T& push_front(const T& value) noexcept
+        requires Copy_Constructable<T>
+    {
+        return push_front(T{value});
+    }
+    T& push_front(T&& value) noexcept
+        requires Move_Constructable<T>
+    {
+        return *new(front_slot()) T{rpp::move(value)};
+    }
+    template<typename... Args>
+    T& emplace_front(Args&&... args) noexcept
+        requires Constructable<T, Args...>
+    {
+        return *new(front_slot()) T{rpp::forward<Args>(args)...};
+    }
+
+    // Removes the front element.
+    void pop() noexcept {
+        assert(length_ > 0);
+        slot(head_)->~T();
+        head_++;
+        length_--;
+        if(!length_) return release_all();
+        if(head_ == BLOCK) {
+            release(block(0));
+            first_ = (first_ + 1) & (index_capacity_ - 1);
+            n_blocks_--;
+            head_ = 0;
+        }
+    }
+
+    void pop_back() noexcept {
+        assert(length_ > 0);
+        length_--;
+        slot(head_ + length_)->~T();
+        if(!length_) return release_all();
+        if(head_ + length_ <= (n_blocks_ - 1) * BLOCK) {
+            release(block(n_blocks_ - 1));
+            n_blocks_--;
+        }
+    }
+
+    void clear() noexcept {
+        if constexpr(Must_Destruct<T>) {
+            for(u64 i = 0; i < length_; i++) slot(head_ + i)->~T();
+        }
+        length_ = 0;
+        release_all();
+    }
+
+    [[nodiscard]] T& front() noexcept {
+        assert(!empty());
+        return *slot(head_);
+    }
+    [[nodiscard]] const T& front() const noexcept {
+        assert(!empty());
+        return *slot(head_);
+    }
+
+    [[nodiscard]] T& back() noexcept {
+        assert(!empty());
+        return *slot(head_ + length_ - 1);
+    }
+    [[nodiscard]] const T& back() const noexcept {
+        assert(!empty());
+        return *slot(head_ + length_ - 1);
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return length_ == 0;
+    }
+    [[nodiscard]] u64 length() const noexcept {
+        return length_;
+    }
+    // Blocks holding elements, not counting the free list.
+    [[nodiscard]] u64 blocks() const noexcept {
+        return n_blocks_;
+    }
+
+    [[nodiscard]] T& operator[](u64 idx) noexcept {
+        assert(idx < length_);
+        return *slot(head_ + idx);
+    }
+    [[nodiscard]] const T& operator[](u64 idx) const noexcept {
+        assert(idx < length_);
+        return *slot(head_ + idx);
+    }
+
+    template<bool is_const>
+    struct Iterator {
+        using D = If<is_const, const Deque, Deque>;
+
+        Iterator operator++() noexcept {
+            count_++;
+            return *this;
+        }
+        Iterator operator++(int) noexcept {
+            Iterator prev{deque_, count_};
+            count_++;
+            return prev;
+        }
+
+        [[nodiscard]] T& operator*() const noexcept
+            requires(!is_const)
+        {
+            return deque_[count_];
+        }
+        [[nodiscard]] const T& operator*() const noexcept {
+            return deque_[count_];
+        }
+
+        [[nodiscard]] T* operator->() const noexcept
+            requires(!is_const)
+        {
+            return &deque_[count_];
+        }
+        [[nodiscard]] const T* operator->() const noexcept {
+            return &deque_[count_];
+        }
+
+        [[nodiscard]] bool operator==(const Iterator& rhs) const noexcept {
+            return &deque_ == &rhs.deque_ && count_ == rhs.count_;
+        }
+
+    private:
+        Iterator(D& deque, u64 count) noexcept : deque_(deque), count_(count) {
+        }
+
+        D& deque_;
+        u64 count_ = 0;
+
+        friend struct Deque;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    [[nodiscard]] iterator begin() noexcept {
+        return iterator{*this, 0};
+    }
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return const_iterator{*this, 0};
+    }
+
+    [[nodiscard]] iterator end() noexcept {
+        return iterator{*this, length_};
+    }
+    [[nodiscard]] const_iterator end() const noexcept {
+        return const_iterator{*this, length_};
+    }
+
+private:
+    // Positions count from the start of the first block.
+    [[nodiscard]] T* slot(u64 pos) const noexcept {
+        return index_[(first_ + pos / BLOCK) & (index_capacity_ - 1)] + pos % BLOCK;
+    }
+    [[nodiscard]] T*& block(u64 i) noexcept {
+        return index_[(first_ + i) & (index_capacity_ - 1)];
+    }
+
+    [[nodiscard]] T* back_slot() noexcept {
+        if(head_ + length_ == n_blocks_ * BLOCK) {
+            grow_index();
+            block(n_blocks_++) = acquire();
+        }
+        return slot(head_ + length_++);
+    }
+    [[nodiscard]] T* front_slot() noexcept {
+        if(head_ == 0) {
+            grow_index();
+            first_ = (first_ - 1) & (index_capacity_ - 1);
+            block(0) = acquire();
+            n_blocks_++;
+            head_ = BLOCK;
+        }
+        head_--;
+        length_++;
+        return slot(head_);
+    }
+
+    // Makes room in the ring for one more block, moving only the block pointers.
+    void grow_index() noexcept {
+        if(n_blocks_ < index_capacity_) return;
+        u64 capacity = index_capacity_ ? 2 * index_capacity_ : 8;
+        T** index = reinterpret_cast<T**>(A::alloc(capacity * sizeof(T*)));
+        for(u64 i = 0; i < n_blocks_; i++) index[i] = block(i);
+        A::free(index_);
+        index_ = index;
+        index_capacity_ = capacity;
+        first_ = 0;
+    }
+
+    [[nodiscard]] T* acquire() noexcept {
+        if(!free_) return reinterpret_cast<T*>(alloc_aligned<A, alignof(T)>(BLOCK * sizeof(T)));
+        T* ret = free_;
+        free_ = next_free(ret);
+        n_free_--;
+        return ret;
+    }
+    // Free blocks hold the pointer to the next one in their first bytes.
+    void release(T* block) noexcept {
+        if(n_free_ == MAX_FREE) return A::free(block);
+        Libc::memcpy(block, &free_, sizeof(T*));
+        free_ = block;
+        n_free_++;
+    }
+    void release_all() noexcept {
+        for(u64 i = 0; i < n_blocks_; i++) release(block(i));
+        n_blocks_ = 0;
+        first_ = 0;
+        head_ = 0;
+    }
+    [[nodiscard]] static T* next_free(T* block) noexcept {
+        T* next = null;
+        Libc::memcpy(&next, block, sizeof(T*));
+        return next;
+    }
+
+    void take(Deque& src) noexcept {
+        index_ = src.index_;
+        index_capacity_ = src.index_capacity_;
+        first_ = src.first_;
+        n_blocks_ = src.n_blocks_;
+        head_ = src.head_;
+        length_ = src.length_;
+        free_ = src.free_;
+        n_free_ = src.n_free_;
+        src.index_ = null;
+        src.index_capacity_ = 0;
+        src.first_ = 0;
+        src.n_blocks_ = 0;
+        src.head_ = 0;
+        src.length_ = 0;
+        src.free_ = null;
+        src.n_free_ = 0;
+    }
+
+    T** index_ = null;
+    u64 index_capacity_ = 0;
+    // Ring position of the first block.
+    u64 first_ = 0;
+    u64 n_blocks_ = 0;
+    // Position of the front element in the first block.
+    u64 head_ = 0;
+    u64 length_ = 0;
+    T* free_ = null;
+    u64 n_free_ = 0;
+
+    friend struct Reflect::Refl<Deque>;
+    template<bool>
+    friend struct Iterator;
+};
+
+template<Movable T, Allocator A>
+RPP_TEMPLATE_RECORD(Deque, RPP_PACK(T, A), RPP_FIELD(n_blocks_), RPP_FIELD(head_),
+                    RPP_FIELD(length_));
+
+namespace Format {
+
+template<Reflectable T, Allocator A>
+struct Measure<Deque<T, A>> {
+    [[nodiscard]] static u64 measure(const Deque<T, A>& deque) noexcept {
+        u64 n = 0;
+        u64 length = 7;
+        for(const T& item : deque) {
+            length += Measure<T>::measure(item);
+            if(n + 1 < deque.length()) length += 2;
+            n++;
+        }
+        return length;
+    }
+};
+template<Allocator O, Reflectable T, Allocator A>
+struct Write<O, Deque<T, A>> {
+    [[nodiscard]] static u64 write(String<O>& output, u64 idx, const Deque<T, A>& deque) noexcept {
+        idx = output.write(idx, "Deque["_v);
+        u64 n = 0;
+        for(const T& item : deque) {
+            idx = Write<O, T>::write(output, idx, item);
+            if(n + 1 < deque.length()) idx = output.write(idx, ", "_v);
+            n++;
+        }
+        return output.write(idx, ']');
+    }
+};
+
+} // namespace Format
+
+} // namespace rpp
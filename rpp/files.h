@@ -11,11 +11,111 @@ using File_Time = u64;
 
 [[nodiscard]] Opt<Vec<u8, Alloc>> read(String_View path) noexcept;
 [[nodiscard]] bool write(String_View path, Slice<u8> data) noexcept;
+// Writes the concatenation of buffers without joining them into one allocation first.
+[[nodiscard]] bool write(String_View path, Slice<Slice<u8>> buffers) noexcept;
+
+// Reads up to length bytes starting at offset into data, returning the number of bytes read.
+// Fewer than length bytes are only returned at the end of the file.
+[[nodiscard]] Opt<u64> read(String_View path, u64 offset, u8* data, u64 length) noexcept;
+
+// Streams a file front to back in chunks the size of the caller's buffer, so files of any size
+// can be processed in bounded memory without allocating.
+struct Reader {
+
+    [[nodiscard]] static Opt<Reader> open(String_View path) noexcept;
+
+    Reader() noexcept = default;
+    ~Reader() noexcept;
+
+    Reader(const Reader&) noexcept = delete;
+    Reader& operator=(const Reader&) noexcept = delete;
+
+    Reader(Reader&& src) noexcept;
+    Reader& operator=(Reader&& src) noexcept;
+
+    [[nodiscard]] u64 size() const noexcept {
+        return size_;
+    }
+    [[nodiscard]] u64 offset() const noexcept {
+        return offset_;
+    }
+    [[nodiscard]] bool done() const noexcept {
+        return offset_ >= size_;
+    }
+    void seek(u64 offset) noexcept {
+        offset_ = offset;
+    }
+
+    // Reads the next chunk into data, returning the filled prefix, which is empty at the end of
+    // the file.
+    [[nodiscard]] Opt<Slice<u8>> next(u8* data, u64 length) noexcept;
+
+    template<u64 N>
+    [[nodiscard]] Opt<Slice<u8>> next(Array<u8, N>& chunk) noexcept {
+        return next(chunk.data(), N);
+    }
+
+private:
+#ifdef RPP_OS_WINDOWS
+    void* handle = null;
+#else
+    i32 fd = -1;
+#endif
+    u64 size_ = 0;
+    u64 offset_ = 0;
+};
 
 [[nodiscard]] Opt<File_Time> last_write_time(String_View path) noexcept;
 
+[[nodiscard]] bool remove(String_View path) noexcept;
+
 [[nodiscard]] bool before(const File_Time& first, const File_Time& second) noexcept;
 
+// Maps a whole file into memory. Read-only mappings share page cache pages with other
+// processes; copy-on-write mappings may be modified in memory without affecting the file.
+struct Mapping {
+
+    enum class Access : u8 { read, copy_on_write };
+    enum class Advice : u8 { normal, sequential, random, will_need, dont_need };
+
+    [[nodiscard]] static Opt<Mapping> open(String_View path,
+                                           Access access = Access::read) noexcept;
+
+    Mapping() noexcept = default;
+    ~Mapping() noexcept;
+
+    Mapping(const Mapping&) noexcept = delete;
+    Mapping& operator=(const Mapping&) noexcept = delete;
+
+    Mapping(Mapping&& src) noexcept;
+    Mapping& operator=(Mapping&& src) noexcept;
+
+    [[nodiscard]] Slice<u8> bytes() const noexcept {
+        return Slice<u8>{data_, length_};
+    }
+    [[nodiscard]] u8* data() noexcept {
+        assert(access_ == Access::copy_on_write);
+        return data_;
+    }
+    [[nodiscard]] u64 length() const noexcept {
+        return length_;
+    }
+    [[nodiscard]] Access access() const noexcept {
+        return access_;
+    }
+
+    // Hints how the whole mapping will be accessed. Dropping pages of a copy-on-write mapping
+    // discards any changes made to them.
+    void advise(Advice advice) noexcept;
+    // Starts reading [offset, offset + length) into memory ahead of use.
+    void prefetch(u64 offset, u64 length) noexcept;
+
+private:
+    u8* data_ = null;
+    u64 length_ = 0;
+    Access access_ = Access::read;
+};
+
 struct Write_Watcher {
 
     explicit Write_Watcher(String_View path) noexcept : path_(rpp::move(path)) {
@@ -39,6 +139,19 @@ struct Write_Watcher {
         return ret;
     }
 
+    [[nodiscard]] Opt<Mapping> map(Mapping::Access access = Mapping::Access::read) const noexcept {
+        return Mapping::open(path_, access);
+    }
+
+    // Replaces mapping with a fresh view of the file if it was written since the last poll.
+    [[nodiscard]] bool remap(Mapping& mapping) noexcept {
+        if(!poll()) return false;
+        Opt<Mapping> fresh = Mapping::open(path_, mapping.access());
+        if(!fresh.ok()) return false;
+        mapping = rpp::move(*fresh);
+        return true;
+    }
+
 private:
     String_View path_;
     File_Time last_write_time_ = 0;
@@ -0,0 +1,580 @@
+#pragma once
+
+#include "base.h"
+
+namespace rpp::Flat {
+
+using namespace Reflect;
+
+// In-place readable layout of reflected values. Numbers, bools and enums are stored as in memory,
+// and records and arrays as their fields, laid out in order with natural alignment. Each Vec,
+// String and Map becomes a header holding a forward offset, relative to the header, to its
+// elements, so a buffer can be read wherever it is loaded or mapped. Maps are stored as open
+// addressed hash tables, so lookups don't need to rebuild anything.
+//
+// Buffers must start aligned to ALIGN, and open() validates every offset, length and value, so
+// Views of an opened buffer never read out of bounds. Validation visits every stored value, so
+// its cost grows with the number of values rather than the size of the buffer, which headers
+// sharing their elements can inflate.
+
+constexpr u64 ALIGN = ALLOC_ALIGNMENT;
+
+template<typename T>
+struct Layout;
+
+template<typename T>
+struct View;
+
+namespace detail {
+
+struct Header {
+    u64 offset;
+    u64 length;
+};
+
+struct Map_Header {
+    u64 offset;
+    u64 length;
+    u64 capacity;
+};
+
+template<typename T>
+[[nodiscard]] T load(const u8* data) noexcept {
+    T value;
+    Libc::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+template<Allocator A, typename T>
+void store(Vec<u8, A>& out, u64 at, const T& value) noexcept {
+    Libc::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+// Appends zeroed space for length bytes aligned to align, returning its position.
+template<Allocator A>
+[[nodiscard]] u64 append(Vec<u8, A>& out, u64 align, u64 length) noexcept {
+    u64 at = Math::align(out.length(), align);
+    out.resize(at + length);
+    return at;
+}
+
+// Checks a header at at and returns the position of its elements.
+[[nodiscard]] inline Opt<u64> elements(Slice<u8> bytes, u64 at, u64 offset, u64 length,
+                                       u64 align, u64 stride) noexcept {
+    if(!length) return Opt<u64>{u64{0}};
+    if(offset < sizeof(Header) || offset > bytes.length() - at) return {};
+    u64 begin = at + offset;
+    if(begin % align) return {};
+    if(length > (bytes.length() - begin) / stride) return {};
+    return Opt<u64>{begin};
+}
+
+template<typename T>
+[[nodiscard]] bool validate_elements(Slice<u8> bytes, u64 begin, u64 length) noexcept {
+    if constexpr(!Layout<T>::plain) {
+        for(u64 i = 0; i < length; i++) {
+            if(!Layout<T>::validate(bytes, begin + i * Layout<T>::size)) return false;
+        }
+    }
+    return true;
+}
+
+template<u64 N>
+struct Record_Layout {
+    u64 offsets[N + 1] = {};
+    u64 size = 0;
+    u64 align = 1;
+    bool plain = true;
+};
+
+template<typename R>
+struct Place_Fields {
+    template<typename F>
+    constexpr void apply() noexcept {
+        using U = Decay<typename F::type>;
+        u64 at = Math::align(layout.size, Layout<U>::align);
+        layout.offsets[n++] = at;
+        layout.plain = layout.plain && Layout<U>::plain && at == F::offset;
+        layout.size = at + Layout<U>::size;
+        layout.align = Math::max(layout.align, Layout<U>::align);
+    }
+    Record_Layout<List_Length<typename Refl<R>::members>> layout;
+    u64 n = 0;
+};
+
+template<typename R>
+[[nodiscard]] consteval auto record_layout() noexcept {
+    Place_Fields<R> place;
+    Iter<Place_Fields<R>, typename Refl<R>::members>::apply(place);
+    place.layout.size = Math::align(place.layout.size, place.layout.align);
+    place.layout.plain = place.layout.plain && Trivially_Copyable<R> &&
+                         place.layout.size == sizeof(R) && place.layout.align == alignof(R);
+    return place.layout;
+}
+
+struct Shape {
+    u64 size = 0;
+    u64 align = 1;
+    bool plain = false;
+};
+
+template<typename T>
+[[nodiscard]] consteval Shape shape() noexcept {
+    using R = Refl<T>;
+    if constexpr(Int<T> || Float<T> || Same<T, char>) {
+        return Shape{sizeof(T), alignof(T), true};
+    } else if constexpr(R::kind == Kind::bool_ || R::kind == Kind::enum_) {
+        return Shape{sizeof(T), alignof(T), false};
+    } else if constexpr(R::kind == Kind::array_) {
+        using U = typename R::underlying;
+        u64 size = R::length * Layout<U>::size;
+        return Shape{size, Layout<U>::align, Layout<U>::plain && sizeof(T) == size};
+    } else if constexpr(R::kind == Kind::record_) {
+        auto layout = record_layout<T>();
+        return Shape{layout.size, layout.align, layout.plain};
+    } else {
+        static_assert(R::kind != Kind::pointer_, "Pointers can't be stored in flat buffers.");
+        return Shape{};
+    }
+}
+
+template<typename T>
+[[nodiscard]] consteval auto field_offsets() noexcept {
+    if constexpr(Refl<T>::kind == Kind::record_) {
+        return record_layout<T>();
+    } else {
+        return Record_Layout<0>{};
+    }
+}
+
+template<Allocator A, typename R>
+struct Write_Fields {
+    template<typename T>
+    void apply(const Literal&, const T& value) noexcept {
+        Layout<Decay<T>>::write(out, at + Layout<R>::offsets[n++], value);
+    }
+    Vec<u8, A>& out;
+    u64 at;
+    u64 n = 0;
+};
+
+struct Validate_Fields {
+    template<typename F>
+    void apply() noexcept {
+        using U = Decay<typename F::type>;
+        ok = ok && Layout<U>::validate(bytes, at + offsets[n++]);
+    }
+    Slice<u8> bytes;
+    u64 at;
+    const u64* offsets;
+    u64 n = 0;
+    bool ok = true;
+};
+
+} // namespace detail
+
+template<typename T>
+struct Layout {
+    using R = Refl<T>;
+
+    constexpr static detail::Shape shape = detail::shape<T>();
+    constexpr static u64 size = shape.size;
+    constexpr static u64 align = shape.align;
+    // Plain values are stored exactly as in memory, so Views hand out references to them.
+    constexpr static bool plain = shape.plain;
+
+    constexpr static auto fields = detail::field_offsets<T>();
+    constexpr static const u64* offsets = fields.offsets;
+
+    static_assert(align <= ALIGN);
+
+    template<Allocator A>
+    static void write(Vec<u8, A>& out, u64 at, const T& value) noexcept {
+        if constexpr(plain) {
+            detail::store(out, at, value);
+        } else if constexpr(R::kind == Kind::bool_) {
+            out[at] = value ? 1 : 0;
+        } else if constexpr(R::kind == Kind::enum_) {
+            detail::store(out, at, static_cast<typename R::underlying>(value));
+        } else if constexpr(R::kind == Kind::array_) {
+            using U = typename R::underlying;
+            for(u64 i = 0; i < R::length; i++) {
+                Layout<U>::write(out, at + i * Layout<U>::size, value[i]);
+            }
+        } else {
+            static_assert(R::kind == Kind::record_);
+            detail::Write_Fields<A, T> writer{out, at};
+            iterate_record(writer, value);
+        }
+    }
+
+    // The caller has checked that [at, at + size) is in bounds and aligned.
+    [[nodiscard]] static bool validate(Slice<u8> bytes, u64 at) noexcept {
+        if constexpr(plain) {
+            return true;
+        } else if constexpr(R::kind == Kind::bool_) {
+            return bytes[at] <= 1;
+        } else if constexpr(R::kind == Kind::enum_) {
+            using U = typename R::underlying;
+            U bits = detail::load<U>(bytes.data() + at);
+            bool known = false;
+            iterate_enum<T>([&](const Literal&, T check) {
+                if(static_cast<U>(check) == bits) known = true;
+            });
+            return known;
+        } else if constexpr(R::kind == Kind::array_) {
+            return detail::validate_elements<typename R::underlying>(bytes, at, R::length);
+        } else {
+            static_assert(R::kind == Kind::record_);
+            detail::Validate_Fields checker{bytes, at, offsets};
+            Iter<detail::Validate_Fields, typename R::members>::apply(checker);
+            return checker.ok;
+        }
+    }
+};
+
+template<typename T, Allocator VA>
+struct Layout<Vec<T, VA>> {
+    constexpr static u64 size = sizeof(detail::Header);
+    constexpr static u64 align = alignof(detail::Header);
+    constexpr static bool plain = false;
+
+    template<Allocator A>
+    static void write(Vec<u8, A>& out, u64 at, const Vec<T, VA>& vec) noexcept {
+        static_assert(Layout<T>::size > 0, "Empty records can't be stored in flat vectors.");
+        u64 length = vec.length();
+        if(!length) {
+            detail::store(out, at, detail::Header{0, 0});
+            return;
+        }
+        u64 begin = detail::append(out, Layout<T>::align, length * Layout<T>::size);
+        detail::store(out, at, detail::Header{begin - at, length});
+        if constexpr(Layout<T>::plain) {
+            Libc::memcpy(out.data() + begin, vec.data(), length * sizeof(T));
+        } else {
+            for(u64 i = 0; i < length; i++) {
+                Layout<T>::write(out, begin + i * Layout<T>::size, vec[i]);
+            }
+        }
+    }
+
+    [[nodiscard]] static bool validate(Slice<u8> bytes, u64 at) noexcept {
+        static_assert(Layout<T>::size > 0, "Empty records can't be stored in flat vectors.");
+        auto header = detail::load<detail::Header>(bytes.data() + at);
+        Opt<u64> begin = detail::elements(bytes, at, header.offset, header.length,
+                                          Layout<T>::align, Layout<T>::size);
+        return begin.ok() && detail::validate_elements<T>(bytes, *begin, header.length);
+    }
+};
+
+template<>
+struct Layout<String_View> {
+    constexpr static u64 size = sizeof(detail::Header);
+    constexpr static u64 align = alignof(detail::Header);
+    constexpr static bool plain = false;
+
+    template<Allocator A>
+    static void write(Vec<u8, A>& out, u64 at, String_View string) noexcept {
+        if(string.empty()) {
+            detail::store(out, at, detail::Header{0, 0});
+            return;
+        }
+        u64 begin = detail::append(out, 1, string.length());
+        detail::store(out, at, detail::Header{begin - at, string.length()});
+        Libc::memcpy(out.data() + begin, string.data(), string.length());
+    }
+
+    [[nodiscard]] static bool validate(Slice<u8> bytes, u64 at) noexcept {
+        auto header = detail::load<detail::Header>(bytes.data() + at);
+        return detail::elements(bytes, at, header.offset, header.length, 1, 1).ok();
+    }
+};
+
+template<Allocator SA>
+struct Layout<String<SA>> : Layout<String_View> {
+    template<Allocator A>
+    static void write(Vec<u8, A>& out, u64 at, const String<SA>& string) noexcept {
+        Layout<String_View>::write(out, at, string.view());
+    }
+};
+
+template<typename T>
+struct Layout<Opt<T>> {
+    constexpr static u64 value_offset = Layout<T>::align;
+    constexpr static u64 align = Layout<T>::align;
+    constexpr static u64 size = value_offset + Layout<T>::size;
+    constexpr static bool plain = false;
+
+    template<Allocator A>
+    static void write(Vec<u8, A>& out, u64 at, const Opt<T>& opt) noexcept {
+        out[at] = opt.ok() ? 1 : 0;
+        if(opt.ok()) Layout<T>::write(out, at + value_offset, *opt);
+    }
+
+    [[nodiscard]] static bool validate(Slice<u8> bytes, u64 at) noexcept {
+        if(bytes[at] > 1) return false;
+        return !bytes[at] || Layout<T>::validate(bytes, at + value_offset);
+    }
+};
+
+// Slots hold the key's hash, which is never zero in an occupied slot, then the key and value.
+template<typename K, typename V, Allocator MA>
+struct Layout<Map<K, V, MA>> {
+    constexpr static u64 size = sizeof(detail::Map_Header);
+    constexpr static u64 align = alignof(detail::Map_Header);
+    constexpr static bool plain = false;
+
+    constexpr static u64 key_offset = Math::align(u64{8}, Layout<K>::align);
+    constexpr static u64 value_offset = Math::align(key_offset + Layout<K>::size,
+                                                    Layout<V>::align);
+    constexpr static u64 slot_align = Math::max(u64{8}, Math::max(Layout<K>::align,
+                                                                   Layout<V>::align));
+    constexpr static u64 slot_size = Math::align(value_offset + Layout<V>::size, slot_align);
+
+    // Strings are looked up by view, which hashes the same as the string.
+    using Key = If<Layout<K>::plain, K, String_View>;
+
+    [[nodiscard]] static u64 slot_hash(const Key& key) noexcept {
+        return Math::max(hash(key), u64{1});
+    }
+
+    template<Allocator A>
+    static void write(Vec<u8, A>& out, u64 at, const Map<K, V, MA>& map) noexcept {
+        u64 length = map.length();
+        if(!length) {
+            detail::store(out, at, detail::Map_Header{0, 0, 0});
+            return;
+        }
+        u64 capacity = Math::next_pow2(length + length / 3 + 1);
+        u64 begin = detail::append(out, slot_align, capacity * slot_size);
+        detail::store(out, at, detail::Map_Header{begin - at, length, capacity});
+        for(const auto& pair : map) {
+            u64 h = Math::max(hash(pair.first), u64{1});
+            u64 i = h & (capacity - 1);
+            while(detail::load<u64>(out.data() + begin + i * slot_size)) {
+                i = (i + 1) & (capacity - 1);
+            }
+            u64 slot = begin + i * slot_size;
+            detail::store(out, slot, h);
+            Layout<K>::write(out, slot + key_offset, pair.first);
+            Layout<V>::write(out, slot + value_offset, pair.second);
+        }
+    }
+
+    // Leaving a slot empty keeps every probe sequence finite.
+    [[nodiscard]] static bool validate(Slice<u8> bytes, u64 at) noexcept {
+        auto header = detail::load<detail::Map_Header>(bytes.data() + at);
+        if(!header.length) return header.capacity == 0;
+        if(header.capacity & (header.capacity - 1) || header.length >= header.capacity) {
+            return false;
+        }
+        Opt<u64> begin = detail::elements(bytes, at, header.offset, header.capacity, slot_align,
+                                          slot_size);
+        if(!begin.ok()) return false;
+        u64 occupied = 0;
+        for(u64 i = 0; i < header.capacity; i++) {
+            u64 slot = *begin + i * slot_size;
+            if(!detail::load<u64>(bytes.data() + slot)) continue;
+            occupied++;
+            if(!Layout<K>::validate(bytes, slot + key_offset)) return false;
+            if(!Layout<V>::validate(bytes, slot + value_offset)) return false;
+        }
+        return occupied == header.length;
+    }
+};
+
+template<typename T>
+struct View {
+    using R = Refl<T>;
+
+    explicit View(const u8* data) noexcept : data{data} {
+    }
+
+    [[nodiscard]] const T& get() const noexcept
+        requires Layout<T>::plain
+    {
+        return *reinterpret_cast<const T*>(data);
+    }
+    [[nodiscard]] T get() const noexcept
+        requires(R::kind == Kind::bool_ || R::kind == Kind::enum_)
+    {
+        return detail::load<T>(data);
+    }
+
+    template<Literal N>
+        requires(R::kind == Kind::record_ && Index_Of<typename R::members, N> <
+                                                 List_Length<typename R::members>)
+    [[nodiscard]] auto get() const noexcept {
+        constexpr u64 index = Index_Of<typename R::members, N>;
+        using F = Decay<typename Nth<typename R::members, index>::type>;
+        return View<F>{data + Layout<T>::offsets[index]};
+    }
+
+    [[nodiscard]] auto operator[](u64 i) const noexcept
+        requires(R::kind == Kind::array_)
+    {
+        using U = typename R::underlying;
+        assert(i < R::length);
+        return View<U>{data + i * Layout<U>::size};
+    }
+
+private:
+    const u8* data;
+};
+
+template<typename T, Allocator VA>
+struct View<Vec<T, VA>> {
+
+    explicit View(const u8* data) noexcept : data{data} {
+    }
+
+    [[nodiscard]] u64 length() const noexcept {
+        return header().length;
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return length() == 0;
+    }
+
+    [[nodiscard]] View<T> operator[](u64 i) const noexcept {
+        assert(i < length());
+        return View<T>{data + header().offset + i * Layout<T>::size};
+    }
+
+    [[nodiscard]] Slice<T> slice() const noexcept
+        requires Layout<T>::plain
+    {
+        detail::Header h = header();
+        if(!h.length) return Slice<T>{};
+        return Slice<T>{reinterpret_cast<const T*>(data + h.offset), h.length};
+    }
+
+private:
+    [[nodiscard]] detail::Header header() const noexcept {
+        return detail::load<detail::Header>(data);
+    }
+
+    const u8* data;
+};
+
+template<>
+struct View<String_View> {
+
+    explicit View(const u8* data) noexcept : data{data} {
+    }
+
+    [[nodiscard]] u64 length() const noexcept {
+        return detail::load<detail::Header>(data).length;
+    }
+
+    [[nodiscard]] String_View view() const noexcept {
+        auto header = detail::load<detail::Header>(data);
+        if(!header.length) return String_View{};
+        return String_View{data + header.offset, header.length};
+    }
+
+private:
+    const u8* data;
+};
+
+template<Allocator SA>
+struct View<String<SA>> : View<String_View> {
+    using View<String_View>::View;
+};
+
+template<typename T>
+struct View<Opt<T>> {
+
+    explicit View(const u8* data) noexcept : data{data} {
+    }
+
+    [[nodiscard]] bool ok() const noexcept {
+        return *data == 1;
+    }
+    [[nodiscard]] View<T> operator*() const noexcept {
+        assert(ok());
+        return View<T>{data + Layout<Opt<T>>::value_offset};
+    }
+
+private:
+    const u8* data;
+};
+
+template<typename K, typename V, Allocator MA>
+struct View<Map<K, V, MA>> {
+    using L = Layout<Map<K, V, MA>>;
+    using Key = typename L::Key;
+
+    static_assert(Layout<K>::plain || Same<K, String_View> || Same<K, String<MA>>,
+                  "Flat map keys must be plain or strings.");
+
+    explicit View(const u8* data) noexcept : data{data} {
+    }
+
+    [[nodiscard]] u64 length() const noexcept {
+        return header().length;
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return length() == 0;
+    }
+
+    [[nodiscard]] Opt<View<V>> find(const Key& key) const noexcept {
+        detail::Map_Header h = header();
+        if(!h.length) return {};
+        u64 hash = L::slot_hash(key);
+        for(u64 i = hash & (h.capacity - 1);; i = (i + 1) & (h.capacity - 1)) {
+            const u8* slot = data + h.offset + i * L::slot_size;
+            u64 stored = detail::load<u64>(slot);
+            if(!stored) return {};
+            if(stored == hash && equal(View<K>{slot + L::key_offset}, key)) {
+                return Opt<View<V>>{View<V>{slot + L::value_offset}};
+            }
+        }
+    }
+
+    // Calls f(key, value) with the views of every entry, in slot order.
+    template<typename F>
+        requires Invocable<F, View<K>, View<V>>
+    void each(F&& f) const noexcept {
+        detail::Map_Header h = header();
+        for(u64 i = 0; i < h.capacity; i++) {
+            const u8* slot = data + h.offset + i * L::slot_size;
+            if(!detail::load<u64>(slot)) continue;
+            f(View<K>{slot + L::key_offset}, View<V>{slot + L::value_offset});
+        }
+    }
+
+private:
+    [[nodiscard]] static bool equal(View<K> stored, const Key& key) noexcept {
+        if constexpr(Layout<K>::plain) {
+            return stored.get() == key;
+        } else {
+            return stored.view() == key;
+        }
+    }
+
+    [[nodiscard]] detail::Map_Header header() const noexcept {
+        return detail::load<detail::Map_Header>(data);
+    }
+
+    const u8* data;
+};
+
+// Appends value to out, returning the position of its root. Out must start aligned to ALIGN,
+// which holds for allocations from the rpp allocators.
+template<typename T, Allocator A>
+[[nodiscard]] u64 write(Vec<u8, A>& out, const T& value) noexcept {
+    u64 root = detail::append(out, ALIGN, Layout<T>::size);
+    Layout<T>::write(out, root, value);
+    return root;
+}
+
+// Validates the value of type T at root, then views it in place. The view borrows bytes.
+template<typename T>
+[[nodiscard]] Opt<View<T>> open(Slice<u8> bytes, u64 root = 0) noexcept {
+    if(reinterpret_cast<uptr>(bytes.data()) % ALIGN || root % Layout<T>::align) return {};
+    if(root > bytes.length() || Layout<T>::size > bytes.length() - root) return {};
+    if(!Layout<T>::validate(bytes, root)) return {};
+    return Opt<View<T>>{View<T>{bytes.data() + root}};
+}
+
+} // namespace rpp::Flat
@@ -0,0 +1,277 @@
+
+#pragma once
+
+#include "base.h"
+#include "sort.h"
+
+namespace rpp {
+
+namespace detail {
+
+template<typename K>
+struct Flat_Map_Staged {
+    [[nodiscard]] bool operator<(const Flat_Map_Staged& r) const noexcept {
+        if(*key < *r.key) return true;
+        if(*r.key < *key) return false;
+        return index < r.index;
+    }
+    const K* key = null;
+    u64 index = 0;
+};
+
+} // namespace detail
+
+// Ordered map over two sorted arrays, keys and values, so lookups search a dense key array and
+// range scans read memory in order. Single inserts and erases shift the arrays; bulk loads
+// should stage entries and commit them at once, which sorts the batch and merges it in one pass.
+// Staged entries are not visible until commit.
+template<Ordered K, Movable V, Allocator A = Mdefault>
+struct Flat_Map {
+
+    Flat_Map() noexcept = default;
+
+    explicit Flat_Map(u64 capacity) noexcept {
+        reserve(capacity);
+    }
+
+    ~Flat_Map() noexcept = default;
+
+    Flat_Map(const Flat_Map& src) noexcept = delete;
+    Flat_Map& operator=(const Flat_Map& src) noexcept = delete;
+
+    Flat_Map(Flat_Map&& src) noexcept = default;
+    Flat_Map& operator=(Flat_Map&& src) noexcept = default;
+
+    void reserve(u64 capacity) noexcept {
+        keys_.reserve(capacity);
+        values_.reserve(capacity);
+    }
+
+    void clear() noexcept {
+        keys_.clear();
+        values_.clear();
+        staged_.clear();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return keys_.empty();
+    }
+    [[nodiscard]] u64 length() const noexcept {
+        return keys_.length();
+    }
+
+    [[nodiscard]] Slice<K> keys() const noexcept {
+        return keys_.slice();
+    }
+    [[nodiscard]] Slice<V> values() const noexcept {
+        return values_.slice();
+    }
+    [[nodiscard]] const K& key(u64 idx) const noexcept {
+        return keys_[idx];
+    }
+    [[nodiscard]] V& value(u64 idx) noexcept {
+        return values_[idx];
+    }
+    [[nodiscard]] const V& value(u64 idx) const noexcept {
+        return values_[idx];
+    }
+
+    // Index of the first key not less than key.
+    [[nodiscard]] u64 lower_bound(const K& key) const noexcept {
+        return Sort::lower_bound(keys_.data(), keys_.length(), key);
+    }
+    // Index of the first key greater than key.
+    [[nodiscard]] u64 upper_bound(const K& key) const noexcept {
+        u64 idx = lower_bound(key);
+        return idx < keys_.length() && !(key < keys_[idx]) ? idx + 1 : idx;
+    }
+
+    V& insert(K&& key, V&& value) noexcept {
+        u64 idx = lower_bound(key);
+        if(idx < keys_.length() && !(key < keys_[idx])) {
+            values_[idx] = rpp::move(value);
+            return values_[idx];
+        }
+        keys_.push(rpp::move(key));
+        values_.push(rpp::move(value));
+        for(u64 i = keys_.length() - 1; i > idx; i--) {
+            rpp::swap(keys_[i], keys_[i - 1]);
+            rpp::swap(values_[i], values_[i - 1]);
+        }
+        return values_[idx];
+    }
+    V& insert(const K& key, V&& value) noexcept
+        requires Copy_Constructable<K>
+    {
+        return insert(K{key}, rpp::move(value));
+    }
+    V& insert(const K& key, const V& value) noexcept
+        requires Copy_Constructable<K> && Copy_Constructable<V>
+    {
+        return insert(K{key}, V{value});
+    }
+
+    // Queues an entry for the next commit. When a key is staged twice, the later value wins.
+    void stage(K&& key, V&& value) noexcept {
+        staged_.push(Pair<K, V>{rpp::move(key), rpp::move(value)});
+    }
+    void stage(const K& key, const V& value) noexcept
+        requires Copy_Constructable<K> && Copy_Constructable<V>
+    {
+        stage(K{key}, V{value});
+    }
+
+    void commit() noexcept {
+        if(staged_.empty()) return;
+
+        Vec<detail::Flat_Map_Staged<K>, A> order(staged_.length());
+        for(u64 i = 0; i < staged_.length(); i++) {
+            order.push(detail::Flat_Map_Staged<K>{&staged_[i].first, i});
+        }
+        Sort::sort(order);
+
+        Vec<K, A> keys(keys_.length() + staged_.length());
+        Vec<V, A> values(keys_.length() + staged_.length());
+        u64 i = 0;
+        for(u64 j = 0; j < order.length(); j++) {
+            const K& next = *order[j].key;
+            // Only the last of a run of equal staged keys is kept.
+            if(j + 1 < order.length() && !(next < *order[j + 1].key)) continue;
+            for(; i < keys_.length() && keys_[i] < next; i++) {
+                keys.push(rpp::move(keys_[i]));
+                values.push(rpp::move(values_[i]));
+            }
+            if(i < keys_.length() && !(next < keys_[i])) i++;
+            Pair<K, V>& entry = staged_[order[j].index];
+            keys.push(rpp::move(entry.first));
+            values.push(rpp::move(entry.second));
+        }
+        for(; i < keys_.length(); i++) {
+            keys.push(rpp::move(keys_[i]));
+            values.push(rpp::move(values_[i]));
+        }
+        keys_ = rpp::move(keys);
+        values_ = rpp::move(values);
+        staged_.clear();
+    }
+
+    [[nodiscard]] Opt<u64> find(const K& key) const noexcept {
+        u64 idx = lower_bound(key);
+        if(idx < keys_.length() && !(key < keys_[idx])) return Opt<u64>{idx};
+        return {};
+    }
+
+    [[nodiscard]] Opt<Ref<V>> try_get(const K& key) noexcept {
+        if(Opt<u64> idx = find(key); idx.ok()) return Opt{Ref{values_[*idx]}};
+        return {};
+    }
+    [[nodiscard]] Opt<Ref<const V>> try_get(const K& key) const noexcept {
+        if(Opt<u64> idx = find(key); idx.ok()) return Opt{Ref<const V>{values_[*idx]}};
+        return {};
+    }
+
+    [[nodiscard]] bool contains(const K& key) const noexcept {
+        return find(key).ok();
+    }
+
+    [[nodiscard]] V& get(const K& key) noexcept {
+        Opt<Ref<V>> value = try_get(key);
+        if(!value.ok()) die("Failed to find key %!", key);
+        return **value;
+    }
+    [[nodiscard]] const V& get(const K& key) const noexcept {
+        Opt<Ref<const V>> value = try_get(key);
+        if(!value.ok()) die("Failed to find key %!", key);
+        return **value;
+    }
+
+    [[nodiscard]] bool try_erase(const K& key) noexcept {
+        Opt<u64> idx = find(key);
+        if(!idx.ok()) return false;
+        for(u64 i = *idx; i + 1 < keys_.length(); i++) {
+            rpp::swap(keys_[i], keys_[i + 1]);
+            rpp::swap(values_[i], values_[i + 1]);
+        }
+        keys_.pop();
+        values_.pop();
+        return true;
+    }
+    void erase(const K& key) noexcept {
+        if(!try_erase(key)) die("Failed to erase key %!", key);
+    }
+
+    // Calls f(key, value) for every key in order.
+    template<typename F>
+        requires Invocable<F, const K&, V&>
+    void each(F&& f) noexcept {
+        for(u64 i = 0; i < keys_.length(); i++) f(keys_[i], values_[i]);
+    }
+    template<typename F>
+        requires Invocable<F, const K&, const V&>
+    void each(F&& f) const noexcept {
+        for(u64 i = 0; i < keys_.length(); i++) f(keys_[i], values_[i]);
+    }
+
+    // Calls f(key, value) for every key in [low, high), in order.
+    template<typename F>
+        requires Invocable<F, const K&, V&>
+    void each_in(const K& low, const K& high, F&& f) noexcept {
+        for(u64 i = lower_bound(low); i < keys_.length() && keys_[i] < high; i++) {
+            f(keys_[i], values_[i]);
+        }
+    }
+    template<typename F>
+        requires Invocable<F, const K&, const V&>
+    void each_in(const K& low, const K& high, F&& f) const noexcept {
+        for(u64 i = lower_bound(low); i < keys_.length() && keys_[i] < high; i++) {
+            f(keys_[i], values_[i]);
+        }
+    }
+
+private:
+    Vec<K, A> keys_;
+    Vec<V, A> values_;
+    Vec<Pair<K, V>, A> staged_;
+
+    friend struct Reflect::Refl<Flat_Map>;
+};
+
+template<Ordered K, Movable V, Allocator A>
+RPP_TEMPLATE_RECORD(Flat_Map, RPP_PACK(K, V, A), RPP_FIELD(keys_), RPP_FIELD(values_),
+                    RPP_FIELD(staged_));
+
+namespace Format {
+
+template<Reflectable K, Reflectable V, Allocator A>
+struct Measure<Flat_Map<K, V, A>> {
+    [[nodiscard]] static u64 measure(const Flat_Map<K, V, A>& map) noexcept {
+        u64 length = 10;
+        for(u64 i = 0; i < map.length(); i++) {
+            length += 5;
+            length += Measure<K>::measure(map.key(i)) + Measure<V>::measure(map.value(i));
+            if(i + 1 < map.length()) length += 2;
+        }
+        return length;
+    }
+};
+
+template<Allocator O, Reflectable K, Reflectable V, Allocator A>
+struct Write<O, Flat_Map<K, V, A>> {
+    [[nodiscard]] static u64 write(String<O>& output, u64 idx,
+                                   const Flat_Map<K, V, A>& map) noexcept {
+        idx = output.write(idx, "Flat_Map["_v);
+        for(u64 i = 0; i < map.length(); i++) {
+            idx = output.write(idx, "{"_v);
+            idx = Write<O, K>::write(output, idx, map.key(i));
+            idx = output.write(idx, " : "_v);
+            idx = Write<O, V>::write(output, idx, map.value(i));
+            idx = output.write(idx, '}');
+            if(i + 1 < map.length()) idx = output.write(idx, ", "_v);
+        }
+        return output.write(idx, ']');
+    }
+};
+
+} // namespace Format
+
+} // namespace rpp
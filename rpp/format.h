@@ -17,18 +17,107 @@ struct Measure;
 template<Allocator A, Reflectable T>
 struct Write;
 
-template<Allocator A, Reflectable T>
-[[nodiscard]] u64 snprintf(String<A>& output, u64 idx, const char* fmt, const T& value) noexcept {
-    Region(R) {
-        i32 expect = Libc::snprintf(null, 0, fmt, value);
-        u64 val_len = static_cast<u64>(expect);
-        String<Mregion<R>> buffer{val_len + 1};
-        buffer.set_length(val_len + 1);
-        assert(Libc::snprintf(buffer.data(), buffer.length(), fmt, value) == expect);
-        return output.write(idx, buffer.sub(0, val_len));
+namespace detail {
+
+constexpr char DIGIT_PAIRS[] = "0001020304050607080910111213141516171819"
+                               "2021222324252627282930313233343536373839"
+                               "4041424344454647484950515253545556575859"
+                               "6061626364656667686970717273747576777879"
+                               "8081828384858687888990919293949596979899";
+
+// Upper bound on the length of a formatted f32 or f64.
+constexpr u64 FLOAT_LENGTH = 25;
+
+// Shortest digits that parse back to value, in plain or scientific notation. Defined in
+// impl/format.cpp.
+[[nodiscard]] u64 write_float(u8* out, f64 value) noexcept;
+[[nodiscard]] u64 write_float(u8* out, f32 value) noexcept;
+
+[[nodiscard]] constexpr u64 count_digits(u64 value) noexcept {
+    u64 digits = 1;
+    for(;;) {
+        if(value < 10) return digits;
+        if(value < 100) return digits + 1;
+        if(value < 1000) return digits + 2;
+        if(value < 10000) return digits + 3;
+        value /= 10000;
+        digits += 4;
+    }
+}
+
+[[nodiscard]] constexpr u64 count_hex_digits(u64 value) noexcept {
+    u64 digits = 1;
+    while(value >>= 4) digits++;
+    return digits;
+}
+
+template<Int I>
+[[nodiscard]] constexpr u64 magnitude(I value) noexcept {
+    if constexpr(Signed_Int<I>) {
+        return value < 0 ? 0ul - static_cast<u64>(value) : static_cast<u64>(value);
+    } else {
+        return static_cast<u64>(value);
     }
 }
 
+template<Int I>
+[[nodiscard]] constexpr u64 measure_int(I value) noexcept {
+    u64 sign = 0;
+    if constexpr(Signed_Int<I>) sign = value < 0;
+    return sign + count_digits(magnitude(value));
+}
+
+// Writes the decimal digits of value backwards from end, two at a time.
+inline void write_digits(u8* end, u64 value) noexcept {
+    while(value >= 100) {
+        u64 pair = (value % 100) * 2;
+        value /= 100;
+        *--end = DIGIT_PAIRS[pair + 1];
+        *--end = DIGIT_PAIRS[pair];
+    }
+    if(value >= 10) {
+        *--end = DIGIT_PAIRS[value * 2 + 1];
+        *--end = DIGIT_PAIRS[value * 2];
+    } else {
+        *--end = static_cast<u8>('0' + value);
+    }
+}
+
+template<Allocator A, Int I>
+[[nodiscard]] u64 write_int(String<A>& output, u64 idx, I value) noexcept {
+    u64 length = measure_int(value);
+    assert(idx + length <= output.length());
+    u8* out = output.data() + idx;
+    if constexpr(Signed_Int<I>) {
+        if(value < 0) *out = '-';
+    }
+    write_digits(out + length, magnitude(value));
+    return idx + length;
+}
+
+template<Allocator A, Float F>
+[[nodiscard]] u64 write_float(String<A>& output, u64 idx, F value) noexcept {
+    u8 buffer[FLOAT_LENGTH];
+    u64 length = write_float(buffer, value);
+    return output.write(idx, String_View{buffer, length});
+}
+
+template<Allocator A>
+[[nodiscard]] u64 write_hex(String<A>& output, u64 idx, u64 value) noexcept {
+    u64 length = count_hex_digits(value);
+    assert(idx + 2 + length <= output.length());
+    u8* out = output.data() + idx;
+    out[0] = '0';
+    out[1] = 'x';
+    for(u64 i = length; i > 0; i--) {
+        out[1 + i] = static_cast<u8>("0123456789abcdef"[value & 0xf]);
+        value >>= 4;
+    }
+    return idx + 2 + length;
+}
+
+} // namespace detail
+
 template<u64 N>
 struct Record_Length {
     template<Reflectable T>
@@ -67,32 +156,14 @@ struct Measure {
             return 4;
         } else if constexpr(R::kind == Kind::char_) {
             return 1;
-        } else if constexpr(R::kind == Kind::i8_) {
-            return Libc::snprintf(null, 0, "%hhd", value);
-        } else if constexpr(R::kind == Kind::i16_) {
-            return Libc::snprintf(null, 0, "%hd", value);
-        } else if constexpr(R::kind == Kind::i32_) {
-            return Libc::snprintf(null, 0, "%d", value);
-        } else if constexpr(R::kind == Kind::i64_) {
-#ifdef RPP_COMPILER_MSVC
-            return Libc::snprintf(null, 0, "%lld", value);
-#else
-            return Libc::snprintf(null, 0, "%ld", value);
-#endif
-        } else if constexpr(R::kind == Kind::u8_) {
-            return Libc::snprintf(null, 0, "%hhu", value);
-        } else if constexpr(R::kind == Kind::u16_) {
-            return Libc::snprintf(null, 0, "%hu", value);
-        } else if constexpr(R::kind == Kind::u32_) {
-            return Libc::snprintf(null, 0, "%u", value);
-        } else if constexpr(R::kind == Kind::u64_) {
-#ifdef RPP_COMPILER_MSVC
-            return Libc::snprintf(null, 0, "%llu", value);
-#else
-            return Libc::snprintf(null, 0, "%lu", value);
-#endif
+        } else if constexpr(R::kind == Kind::i8_ || R::kind == Kind::i16_ ||
+                            R::kind == Kind::i32_ || R::kind == Kind::i64_ ||
+                            R::kind == Kind::u8_ || R::kind == Kind::u16_ ||
+                            R::kind == Kind::u32_ || R::kind == Kind::u64_) {
+            return detail::measure_int(value);
         } else if constexpr(R::kind == Kind::f32_ || R::kind == Kind::f64_) {
-            return Libc::snprintf(null, 0, "%f", value);
+            // An upper bound, so each float is only converted once.
+            return detail::FLOAT_LENGTH;
         } else if constexpr(R::kind == Kind::bool_) {
             return value ? 4 : 5;
         } else if constexpr(R::kind == Kind::array_) {
@@ -104,7 +175,7 @@ struct Measure {
             return length;
         } else if constexpr(R::kind == Kind::pointer_) {
             if(value == null) return 6;
-            return 2 + Libc::snprintf(null, 0, "%p", value);
+            return 4 + detail::count_hex_digits(reinterpret_cast<uptr>(value));
         } else if constexpr(R::kind == Kind::record_) {
             u64 name_len = String_View{R::name}.length();
             Record_Length<List_Length<typename R::members>> iterator;
@@ -131,32 +202,13 @@ struct Write {
             return output.write(idx, "void"_v);
         } else if constexpr(R::kind == Kind::char_) {
             return output.write(idx, value);
-        } else if constexpr(R::kind == Kind::i8_) {
-            return snprintf(output, idx, "%hhd", value);
-        } else if constexpr(R::kind == Kind::i16_) {
-            return snprintf(output, idx, "%hd", value);
-        } else if constexpr(R::kind == Kind::i32_) {
-            return snprintf(output, idx, "%d", value);
-        } else if constexpr(R::kind == Kind::i64_) {
-#ifdef RPP_COMPILER_MSVC
-            return snprintf(output, idx, "%lld", value);
-#else
-            return snprintf(output, idx, "%ld", value);
-#endif
-        } else if constexpr(R::kind == Kind::u8_) {
-            return snprintf(output, idx, "%hhu", value);
-        } else if constexpr(R::kind == Kind::u16_) {
-            return snprintf(output, idx, "%hu", value);
-        } else if constexpr(R::kind == Kind::u32_) {
-            return snprintf(output, idx, "%u", value);
-        } else if constexpr(R::kind == Kind::u64_) {
-#ifdef RPP_COMPILER_MSVC
-            return snprintf(output, idx, "%llu", value);
-#else
-            return snprintf(output, idx, "%lu", value);
-#endif
+        } else if constexpr(R::kind == Kind::i8_ || R::kind == Kind::i16_ ||
+                            R::kind == Kind::i32_ || R::kind == Kind::i64_ ||
+                            R::kind == Kind::u8_ || R::kind == Kind::u16_ ||
+                            R::kind == Kind::u32_ || R::kind == Kind::u64_) {
+            return detail::write_int(output, idx, value);
         } else if constexpr(R::kind == Kind::f32_ || R::kind == Kind::f64_) {
-            return snprintf(output, idx, "%f", value);
+            return detail::write_float(output, idx, value);
         } else if constexpr(R::kind == Kind::bool_) {
             return value ? output.write(idx, "true"_v) : output.write(idx, "false"_v);
         } else if constexpr(R::kind == Kind::array_) {
@@ -169,7 +221,7 @@ struct Write {
         } else if constexpr(R::kind == Kind::pointer_) {
             if(value == null) return output.write(idx, "(null)"_v);
             idx = output.write(idx, '(');
-            idx += Libc::snprintf(output.data() + idx, output.length() - idx, "%p", value);
+            idx = detail::write_hex(output, idx, reinterpret_cast<uptr>(value));
             return output.write(idx, ')');
         } else if constexpr(R::kind == Kind::record_) {
             idx = output.write(idx, String_View{R::name});
@@ -249,8 +301,71 @@ template<Allocator A, typename T, typename... Ts>
     return length;
 }
 
+namespace detail {
+
+struct Fmt_Segment {
+    u64 offset = 0;
+    u64 length = 0;
+    bool escaped = false;
+};
+
+// Never defined: reaching either from the consteval Format_String constructor fails compilation.
+void format_string_has_too_few_arguments() noexcept;
+void format_string_has_too_many_arguments() noexcept;
+
+template<Allocator A>
+[[nodiscard]] u64 write_segment(String<A>& output, u64 idx, const char* text,
+                                Fmt_Segment segment) noexcept {
+    String_View literal{reinterpret_cast<const u8*>(text) + segment.offset, segment.length};
+    if(!segment.escaped) return output.write(idx, literal);
+    for(u64 i = 0; i < literal.length(); i++) {
+        idx = output.write(idx, literal[i]);
+        if(literal[i] == '%') i++;
+    }
+    return idx;
+}
+
+} // namespace detail
+
 } // namespace Format
 
+// Format string split into literal segments around its argument slots at compile time, so
+// formatting copies each segment directly. A literal whose slot count doesn't match the argument
+// types fails to compile.
+template<typename... Ts>
+struct Format_String {
+    template<u64 N>
+    consteval Format_String(const char (&literal)[N]) noexcept : text{literal}, text_length{N - 1} {
+        u64 segment = 0;
+        for(u64 i = 0; i + 1 < N; i++) {
+            if(literal[i] != '%') {
+                segments[segment].length++;
+                length++;
+            } else if(i + 2 < N && literal[i + 1] == '%') {
+                segments[segment].length += 2;
+                segments[segment].escaped = true;
+                length++;
+                i++;
+            } else {
+                if(segment == sizeof...(Ts)) Format::detail::format_string_has_too_few_arguments();
+                segments[++segment].offset = i + 1;
+            }
+        }
+        if(segment != sizeof...(Ts)) Format::detail::format_string_has_too_many_arguments();
+    }
+
+    [[nodiscard]] String_View view() const noexcept {
+        return String_View{reinterpret_cast<const u8*>(text), text_length};
+    }
+
+    const char* text = null;
+    u64 text_length = 0;
+    // Characters written by the literal segments.
+    u64 length = 0;
+    Format::detail::Fmt_Segment segments[sizeof...(Ts) + 1];
+};
+
+// An upper bound on the formatted length: floats are measured by their longest representation.
 template<typename... Ts>
     requires(Reflectable<Ts> && ...)
 [[nodiscard]] constexpr u64 format_length(String_View fmt, const Ts&... args) noexcept {
@@ -273,7 +388,24 @@ template<Allocator A, typename... Ts>
     String<A> output{length};
     output.set_length(length);
     u64 idx = Format::write(fmt, 0, output, 0, args...);
-    assert(idx == length);
+    assert(idx <= length);
+    output.set_length(idx);
+    return output;
+}
+
+template<Allocator A, typename... Ts>
+    requires(Reflectable<Ts> && ...)
+[[nodiscard]] String<A> format(Format_String<Identity<Ts>...> fmt, const Ts&... args) noexcept {
+    u64 length = (fmt.length + ... + Format::Measure<Ts>::measure(args));
+    String<A> output{length};
+    output.set_length(length);
+    u64 idx = Format::detail::write_segment(output, 0, fmt.text, fmt.segments[0]);
+    u64 segment = 1;
+    ((idx = Format::Write<A, Ts>::write(output, idx, args),
+      idx = Format::detail::write_segment(output, idx, fmt.text, fmt.segments[segment++])),
+     ...);
+    assert(idx <= length);
+    output.set_length(idx);
     return output;
 }
 
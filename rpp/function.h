@@ -9,9 +9,20 @@ namespace rpp {
 
 namespace detail {
 
+// Callables that do not fit inline are moved into pooled memory. Defined in alloc1.h.
+template<typename F, typename... Args>
+[[nodiscard]] F* function_spill(Args&&... args) noexcept;
+template<typename F>
+void function_unspill(F* f) noexcept;
+
 template<u64 Words, typename F>
 struct Function;
 
+// Owning, move-only callable. Small callables live in the inline storage and larger ones spill to
+// a pooled allocation. Plain functions and captureless lambdas are stored as function pointers and
+// called directly. The invoke thunk is stored in the object itself, so calling costs one indirect
+// call and no table lookup. Callables that are trivially movable and destructible have no ops
+// table at all.
 template<u64 Words, typename R, typename... Args>
 struct Function<Words, R(Args...)> {
 
@@ -22,7 +33,10 @@ struct Function<Words, R(Args...)> {
     template<typename F>
         requires Same<Invoke_Result<F, Args...>, R>
     Function(F&& f) noexcept {
-        construct(rpp::forward<F>(f));
+        construct<Decay<F>>(rpp::forward<F>(f));
+    }
+    Function(Fn* f) noexcept {
+        new(storage) Fn*{f};
     }
     ~Function() noexcept {
         destruct();
@@ -32,79 +46,155 @@ struct Function<Words, R(Args...)> {
     Function& operator=(const Function& src) noexcept = delete;
 
     Function(Function&& src) noexcept {
-        if(src.vtable) src.move(storage);
-        vtable = src.vtable;
-        src.vtable = null;
+        take(src);
     }
     Function& operator=(Function&& src) noexcept {
-        destruct();
-        if(src.vtable) src.move(storage);
-        vtable = src.vtable;
-        src.vtable = null;
+        if(this != &src) {
+            destruct();
+            take(src);
+        }
         return *this;
     }
 
     [[nodiscard]] R operator()(Args... args) noexcept {
-        assert(vtable);
-        return invoke(rpp::forward<Args>(args)...);
+        if(call) return call(storage, rpp::forward<Args>(args)...);
+        Fn* f = direct();
+        assert(f);
+        return f(rpp::forward<Args>(args)...);
     }
 
-private:
-    using VoidFn = void (*)();
     constexpr static u64 MAX_ALIGN = 16;
 
+    // Whether a callable of type F is stored without allocating.
     template<typename F>
-        requires Same<Invoke_Result<F, Args...>, R>
-    void construct(F&& f) noexcept {
-        static_assert(alignof(F) <= MAX_ALIGN);
-        static_assert(sizeof(F) <= Words * 8);
-        static VoidFn f_vtable[] = {reinterpret_cast<VoidFn>(&f_destruct<F>),
-                                    reinterpret_cast<VoidFn>(&f_move<F>),
-                                    reinterpret_cast<VoidFn>(&f_invoke<F>)};
-        new(storage) F{rpp::forward<F>(f)};
-        vtable = static_cast<VoidFn*>(f_vtable);
+    constexpr static bool fits = sizeof(F) <= Words * 8 && alignof(F) <= MAX_ALIGN;
+
+private:
+    // Null entries mean the callable needs no destructor or may be moved by copying its bytes.
+    struct Ops {
+        void (*destruct)(void*) noexcept;
+        void (*relocate)(void* dst, void* src) noexcept;
+    };
+
+    template<typename F>
+    void construct(auto&& f) noexcept {
+        if constexpr(Constructable<Fn*, F>) {
+            new(storage) Fn*{static_cast<Fn*>(f)};
+        } else if constexpr(fits<F>) {
+            new(storage) F{rpp::forward<decltype(f)>(f)};
+            call = &f_invoke<F>;
+            if constexpr(Must_Destruct<F> || !Trivially_Movable<F>) ops = &f_inline_ops<F>;
+        } else {
+            new(storage) F*{function_spill<F>(rpp::forward<decltype(f)>(f))};
+            call = &f_invoke_spilled<F>;
+            ops = &f_spilled_ops<F>;
+        }
     }
     void destruct() noexcept {
-        if(vtable) {
-            void (*do_destruct)(void*) = reinterpret_cast<void (*)(void*)>(vtable[0]);
-            do_destruct(storage);
+        if(ops && ops->destruct) ops->destruct(storage);
+        clear();
+    }
+    void take(Function& src) noexcept {
+        if(src.ops && src.ops->relocate) {
+            src.ops->relocate(storage, src.storage);
+        } else {
+            Libc::memcpy(storage, src.storage, sizeof(storage));
         }
-        vtable = null;
+        call = src.call;
+        ops = src.ops;
+        src.clear();
     }
-    void move(void* dst) noexcept {
-        void (*do_move)(void*, void*) = reinterpret_cast<void (*)(void*, void*)>(vtable[1]);
-        do_move(dst, storage);
+    void clear() noexcept {
+        call = null;
+        ops = null;
+        new(storage) Fn*{null};
     }
-    [[nodiscard]] R invoke(Args... args) noexcept {
-        R (*do_invoke)(void*, Args...) = reinterpret_cast<R (*)(void*, Args...)>(vtable[2]);
-        return do_invoke(storage, rpp::forward<Args>(args)...);
+    [[nodiscard]] Fn* direct() noexcept {
+        return *reinterpret_cast<Fn**>(storage);
     }
 
     template<typename F>
-    static void f_destruct(F* src) noexcept {
+    static void f_destruct(void* src) noexcept {
+        static_cast<F*>(src)->~F();
+    }
+    template<typename F>
+    static void f_relocate(void* dst, void* src) noexcept {
+        new(dst) F{rpp::move(*static_cast<F*>(src))};
         if constexpr(Must_Destruct<F>) {
-            src->~F();
+            static_cast<F*>(src)->~F();
         }
     }
     template<typename F>
-    static void f_move(F* dst, F* src) noexcept {
-        if constexpr(Trivially_Movable<F>) {
-            Libc::memcpy(dst, src, sizeof(F));
-        } else {
-            new(dst) F{rpp::move(*src)};
-        }
+    [[nodiscard]] static R f_invoke(void* src, Args... args) noexcept {
+        return static_cast<F*>(src)->operator()(rpp::forward<Args>(args)...);
+    }
+
+    template<typename F>
+    static void f_unspill(void* src) noexcept {
+        function_unspill(*static_cast<F**>(src));
     }
     template<typename F>
-    [[nodiscard]] static R f_invoke(F* src, Args... args) noexcept {
-        return src->operator()(rpp::forward<Args>(args)...);
+    [[nodiscard]] static R f_invoke_spilled(void* src, Args... args) noexcept {
+        return (*static_cast<F**>(src))->operator()(rpp::forward<Args>(args)...);
     }
 
+    template<typename F>
+    constexpr static Ops f_inline_ops = {Must_Destruct<F> ? &f_destruct<F> : null,
+                                         Trivially_Movable<F> ? null : &f_relocate<F>};
+    template<typename F>
+    constexpr static Ops f_spilled_ops = {&f_unspill<F>, null};
+
     alignas(MAX_ALIGN) u8 storage[Words * 8] = {};
-    VoidFn* vtable = null;
+    R (*call)(void*, Args...) noexcept = null;
+    const Ops* ops = null;
 
     friend struct Reflect::Refl<Function<Words, Fn>>;
 };
 
+template<typename F>
+struct Function_Ref;
+
+// Non-owning view of a callable, for callbacks that are only invoked while the caller keeps the
+// callable alive. Two words, never allocates. Plain functions and captureless lambdas are stored
+// by value as function pointers.
+template<typename R, typename... Args>
+struct Function_Ref<R(Args...)> {
+
+    using Result = R;
+    using Parameters = List<Args...>;
+    using Fn = R(Args...);
+
+    template<typename F>
+        requires(!Same<Decay<F>, Function_Ref> && !Constructable<Fn*, F> &&
+                 Same<Invoke_Result<F&, Args...>, R>)
+    Function_Ref(F&& f) noexcept
+        : object{const_cast<void*>(static_cast<const void*>(&f))}, call{&f_invoke<Decay<F>>} {
+    }
+    Function_Ref(Fn* f) noexcept : function{f}, call{null} {
+    }
+
+    Function_Ref(const Function_Ref&) noexcept = default;
+    Function_Ref& operator=(const Function_Ref&) noexcept = default;
+
+    [[nodiscard]] R operator()(Args... args) const noexcept {
+        if(call) return call(object, rpp::forward<Args>(args)...);
+        assert(function);
+        return function(rpp::forward<Args>(args)...);
+    }
+
+private:
+    template<typename F>
+    [[nodiscard]] static R f_invoke(void* src, Args... args) noexcept {
+        return static_cast<F*>(src)->operator()(rpp::forward<Args>(args)...);
+    }
+
+    union {
+        void* object;
+        Fn* function;
+    };
+    R (*call)(void*, Args...) noexcept;
+};
+
 } // namespace detail
 
 template<typename F>
@@ -113,6 +203,9 @@ using Function = detail::Function<4, F>;
 template<u64 Words, typename F>
 using FunctionN = detail::Function<Words, F>;
 
+template<typename F>
+using Function_Ref = detail::Function_Ref<F>;
+
 namespace Format {
 
 template<Reflectable R, typename... Args>
@@ -180,4 +273,7 @@ RPP_TEMPLATE_RECORD(Function, F);
 template<u64 N, typename F>
 RPP_TEMPLATE_RECORD(FunctionN, RPP_PACK(N, F));
 
+template<typename F>
+RPP_TEMPLATE_RECORD(Function_Ref, F);
+
 } // namespace rpp
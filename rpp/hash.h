@@ -34,6 +34,118 @@ namespace Hash {
     return squirrel5(h1 + h2);
 }
 
+namespace detail {
+
+constexpr u64 WY_SECRET0 = 0x2d358dccaa6c78a5ul;
+constexpr u64 WY_SECRET1 = 0x8bb84b93962eacc9ul;
+constexpr u64 WY_SECRET2 = 0x4b33a62ed433d4a3ul;
+constexpr u64 WY_SECRET3 = 0x4d5a2da51de1aa47ul;
+
+// Full 64x64 -> 128 bit product, returned as lo and hi.
+constexpr void multiply(u64& a, u64& b) noexcept {
+    if(!is_constexpr()) {
+#ifdef RPP_COMPILER_MSVC
+        u64 hi = 0;
+        a = _umul128(a, b, &hi);
+        b = hi;
+        return;
+#else
+        unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+        a = static_cast<u64>(r);
+        b = static_cast<u64>(r >> 64);
+        return;
+#endif
+    }
+    u64 ha = a >> 32, hb = b >> 32, la = static_cast<u32>(a), lb = static_cast<u32>(b);
+    u64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    u64 t = rl + (rm0 << 32);
+    u64 c = t < rl;
+    u64 lo = t + (rm1 << 32);
+    c += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+}
+
+[[nodiscard]] constexpr u64 mix(u64 a, u64 b) noexcept {
+    multiply(a, b);
+    return a ^ b;
+}
+
+// Little-endian unaligned loads. C is char for literals, u8 for string data.
+template<typename C>
+[[nodiscard]] constexpr u64 read(const C* p, u64 bytes) noexcept {
+    if(!is_constexpr()) {
+        if(bytes == 8) {
+            u64 v = 0;
+#ifdef RPP_COMPILER_MSVC
+            Libc::memcpy(&v, p, 8);
+#else
+            __builtin_memcpy(&v, p, 8);
+#endif
+            return v;
+        }
+        if(bytes == 4) {
+            u32 v = 0;
+#ifdef RPP_COMPILER_MSVC
+            Libc::memcpy(&v, p, 4);
+#else
+            __builtin_memcpy(&v, p, 4);
+#endif
+            return v;
+        }
+    }
+    u64 v = 0;
+    for(u64 i = 0; i < bytes; i++) v |= static_cast<u64>(static_cast<u8>(p[i])) << (8 * i);
+    return v;
+}
+
+} // namespace detail
+
+// Word-at-a-time hash of a byte string (wyhash). Inputs of 48 bytes or more are consumed by three
+// independent multiply chains, so long keys run at several bytes per cycle.
+template<typename C>
+    requires(sizeof(C) == 1)
+[[nodiscard]] constexpr u64 bytes(const C* p, u64 length, u64 seed = 0) noexcept {
+    using namespace detail;
+    seed ^= mix(seed ^ WY_SECRET0, WY_SECRET1);
+    u64 a = 0, b = 0;
+    if(length <= 16) {
+        if(length >= 4) {
+            u64 step = (length >> 3) << 2;
+            a = (read(p, 4) << 32) | read(p + step, 4);
+            b = (read(p + length - 4, 4) << 32) | read(p + length - 4 - step, 4);
+        } else if(length > 0) {
+            a = (static_cast<u64>(static_cast<u8>(p[0])) << 16) |
+                (static_cast<u64>(static_cast<u8>(p[length >> 1])) << 8) |
+                static_cast<u64>(static_cast<u8>(p[length - 1]));
+        }
+    } else {
+        u64 i = length;
+        if(i >= 48) {
+            u64 seed1 = seed, seed2 = seed;
+            do {
+                seed = mix(read(p, 8) ^ WY_SECRET1, read(p + 8, 8) ^ seed);
+                seed1 = mix(read(p + 16, 8) ^ WY_SECRET2, read(p + 24, 8) ^ seed1);
+                seed2 = mix(read(p + 32, 8) ^ WY_SECRET3, read(p + 40, 8) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while(i >= 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while(i > 16) {
+            seed = mix(read(p, 8) ^ WY_SECRET1, read(p + 8, 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = read(p + i - 16, 8);
+        b = read(p + i - 8, 8);
+    }
+    a ^= WY_SECRET1;
+    b ^= seed;
+    multiply(a, b);
+    return mix(a ^ WY_SECRET0 ^ length, b ^ WY_SECRET1);
+}
+
 template<typename K>
 struct Hash;
 
@@ -65,6 +177,16 @@ struct Hash<f64> {
     }
 };
 
+// Hashes the same as a String_View of the same text.
+template<>
+struct Hash<Literal> {
+    [[nodiscard]] constexpr static u64 hash(const Literal& key) noexcept {
+        u64 length = 0;
+        while(length < Literal::max_len && key.c_string[length]) length++;
+        return bytes(key.c_string, length);
+    }
+};
+
 template<typename T>
 struct Hash<T*> {
     [[nodiscard]] constexpr static u64 hash(T* key) noexcept {
@@ -96,10 +218,8 @@ template<Hashable... Ts>
 
 template<size_t N>
 [[nodiscard]] consteval u64 hash_literal(const char (&literal)[N], u64 seed = 0) noexcept {
-    for(size_t i = 0; i < N - 1; i++) {
-        seed = Hash::hash_combine(seed, hash(literal[i]));
-    }
-    return seed ? seed : 1;
+    u64 h = Hash::bytes(literal, N - 1, seed);
+    return h ? h : 1;
 }
 
 } // namespace rpp
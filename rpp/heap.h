@@ -5,13 +5,16 @@
 
 namespace rpp {
 
-template<Ordered T, Allocator A = Mdefault>
+// Min-heap with D children per node. Wider nodes make the heap shallower, and with D = 4 or 8
+// the children compared on the way down usually share a cache line, so large heaps pop faster.
+template<Ordered T, Allocator A = Mdefault, u64 D = 2>
+    requires(D >= 2)
 struct Heap {
 
     Heap() noexcept = default;
 
     explicit Heap(u64 capacity) noexcept {
-        data_ = reinterpret_cast<T*>(A::alloc(capacity * sizeof(T)));
+        data_ = reinterpret_cast<T*>(alloc_aligned<A, alignof(T)>(capacity * sizeof(T)));
         length_ = 0;
         capacity_ = capacity;
     }
@@ -58,11 +61,11 @@ struct Heap {
     }
 
     template<Allocator B = A>
-    [[nodiscard]] Heap<T, B> clone() const noexcept
+    [[nodiscard]] Heap<T, B, D> clone() const noexcept
         requires(Clone<T> || Copy_Constructable<T>)
     {
-        Heap<T, B> ret;
-        ret.data_ = reinterpret_cast<T*>(B::alloc(capacity_ * sizeof(T)));
+        Heap<T, B, D> ret;
+        ret.data_ = reinterpret_cast<T*>(alloc_aligned<B, alignof(T)>(capacity_ * sizeof(T)));
         ret.length_ = length_;
         ret.capacity_ = capacity_;
         if constexpr(Trivially_Copyable<T>) {
@@ -85,7 +88,7 @@ struct Heap {
     {
         if(new_capacity <= capacity_) return;
 
-        T* new_data = reinterpret_cast<T*>(A::alloc(new_capacity * sizeof(T)));
+        T* new_data = reinterpret_cast<T*>(alloc_aligned<A, alignof(T)>(new_capacity * sizeof(T)));
         if constexpr(Trivially_Movable<T>) {
             Libc::memcpy(new_data, data_, length_ * sizeof(T));
         } else {
@@ -197,10 +200,8 @@ private:
         requires Move_Constructable<T>
     {
         while(idx) {
-            u64 parent_idx = (idx - 1) / 2;
-            T& elem = data_[idx];
-            T& parent = data_[parent_idx];
-            if(elem < parent) {
+            u64 parent_idx = (idx - 1) / D;
+            if(data_[idx] < data_[parent_idx]) {
                 swap(idx, parent_idx);
                 idx = parent_idx;
             } else {
@@ -213,29 +214,18 @@ private:
         requires Move_Constructable<T>
     {
         while(true) {
-            T& parent = data_[idx];
-
-            u64 left = idx * 2 + 1;
-            u64 right = left + 1;
-
-            if(right < length_) {
-                T& lchild = data_[left];
-                T& rchild = data_[right];
-                if(lchild < parent && !(rchild < lchild)) {
-                    swap(idx, left);
-                    idx = left;
-                } else if(rchild < parent && !(lchild < rchild)) {
-                    swap(idx, right);
-                    idx = right;
-                } else {
-                    return;
-                }
-            } else if(left < length_) {
-                T& lchild = data_[left];
-                if(lchild < parent) {
-                    swap(idx, left);
-                }
-                return;
+            u64 first = idx * D + 1;
+            if(first >= length_) return;
+
+            u64 last = Math::min(first + D, length_);
+            u64 min = first;
+            for(u64 child = first + 1; child < last; child++) {
+                if(data_[child] < data_[min]) min = child;
+            }
+
+            if(data_[min] < data_[idx]) {
+                swap(idx, min);
+                idx = min;
             } else {
                 return;
             }
@@ -249,15 +239,183 @@ private:
     friend struct Reflect::Refl<Heap>;
 };
 
-template<typename T, Allocator A>
-RPP_TEMPLATE_RECORD(Heap, RPP_PACK(T, A), RPP_FIELD(data_), RPP_FIELD(length_),
+// Min-heap whose entries can be re-prioritized or removed through the handle returned by push,
+// without a pop and push. Each entry records its slot, so moves keep the handle table current.
+template<Ordered T, Allocator A = Mdefault, u64 D = 4>
+    requires(D >= 2)
+struct Handle_Heap {
+    using Handle = u64;
+
+    Handle_Heap() noexcept = default;
+    ~Handle_Heap() noexcept = default;
+
+    Handle_Heap(const Handle_Heap&) noexcept = delete;
+    Handle_Heap& operator=(const Handle_Heap&) noexcept = delete;
+
+    Handle_Heap(Handle_Heap&&) noexcept = default;
+    Handle_Heap& operator=(Handle_Heap&&) noexcept = default;
+
+    [[nodiscard]] bool empty() const noexcept {
+        return entries.empty();
+    }
+    [[nodiscard]] u64 length() const noexcept {
+        return entries.length();
+    }
+    [[nodiscard]] bool contains(Handle handle) const noexcept {
+        return handle < positions.length() && positions[handle] != FREE;
+    }
+
+    void clear() noexcept {
+        entries.clear();
+        positions.clear();
+        free.clear();
+    }
+
+    [[nodiscard]] Handle push(T&& value) noexcept
+        requires Move_Constructable<T>
+    {
+        Handle handle = 0;
+        if(free.empty()) {
+            handle = positions.length();
+            positions.push(entries.length());
+        } else {
+            handle = free.back();
+            free.pop();
+            positions[handle] = entries.length();
+        }
+        entries.push(Entry{rpp::move(value), handle});
+        reheap_up(entries.length() - 1);
+        return handle;
+    }
+
+    [[nodiscard]] const T& top() const noexcept {
+        return entries.front().value;
+    }
+    [[nodiscard]] Handle top_handle() const noexcept {
+        return entries.front().handle;
+    }
+    [[nodiscard]] const T& get(Handle handle) const noexcept {
+        assert(contains(handle));
+        return entries[positions[handle]].value;
+    }
+
+    void pop() noexcept {
+        assert(!entries.empty());
+        erase(entries.front().handle);
+    }
+
+    // Replaces the value of handle and restores the heap order in whichever direction it moved.
+    void update(Handle handle, T&& value) noexcept
+        requires Move_Constructable<T>
+    {
+        assert(contains(handle));
+        u64 idx = positions[handle];
+        bool up = value < entries[idx].value;
+        entries[idx].value = rpp::move(value);
+        if(up) {
+            reheap_up(idx);
+        } else {
+            reheap_down(idx);
+        }
+    }
+
+    void erase(Handle handle) noexcept {
+        assert(contains(handle));
+        u64 idx = positions[handle];
+        positions[handle] = FREE;
+        free.push(handle);
+
+        u64 last = entries.length() - 1;
+        if(idx == last) {
+            entries.pop();
+            return;
+        }
+
+        // The last entry fills the hole and may belong either above or below it.
+        move_entry(idx, last);
+        entries.pop();
+        if(idx > 0 && entries[idx].value < entries[(idx - 1) / D].value) {
+            reheap_up(idx);
+        } else {
+            reheap_down(idx);
+        }
+    }
+
+private:
+    constexpr static u64 FREE = RPP_UINT64_MAX;
+
+    struct Entry {
+        T value;
+        Handle handle;
+    };
+
+    void move_entry(u64 to, u64 from) noexcept {
+        Entry& dst = entries[to];
+        Entry& src = entries[from];
+        dst.value = rpp::move(src.value);
+        dst.handle = src.handle;
+        positions[dst.handle] = to;
+    }
+
+    void swap(u64 a, u64 b) noexcept {
+        rpp::swap(entries[a], entries[b]);
+        positions[entries[a].handle] = a;
+        positions[entries[b].handle] = b;
+    }
+
+    void reheap_up(u64 idx) noexcept {
+        while(idx) {
+            u64 parent_idx = (idx - 1) / D;
+            if(entries[idx].value < entries[parent_idx].value) {
+                swap(idx, parent_idx);
+                idx = parent_idx;
+            } else {
+                return;
+            }
+        }
+    }
+
+    void reheap_down(u64 idx) noexcept {
+        u64 length = entries.length();
+        while(true) {
+            u64 first = idx * D + 1;
+            if(first >= length) return;
+
+            u64 last = Math::min(first + D, length);
+            u64 min = first;
+            for(u64 child = first + 1; child < last; child++) {
+                if(entries[child].value < entries[min].value) min = child;
+            }
+
+            if(entries[min].value < entries[idx].value) {
+                swap(idx, min);
+                idx = min;
+            } else {
+                return;
+            }
+        }
+    }
+
+    Vec<Entry, A> entries;
+    Vec<u64, A> positions;
+    Vec<Handle, A> free;
+
+    friend struct Reflect::Refl<Handle_Heap>;
+};
+
+template<typename T, Allocator A, u64 D>
+RPP_TEMPLATE_RECORD(Heap, RPP_PACK(T, A, D), RPP_FIELD(data_), RPP_FIELD(length_),
                     RPP_FIELD(capacity_));
 
+template<typename T, Allocator A, u64 D>
+RPP_TEMPLATE_RECORD(Handle_Heap, RPP_PACK(T, A, D), RPP_FIELD(entries), RPP_FIELD(positions),
+                    RPP_FIELD(free));
+
 namespace Format {
 
-template<Reflectable T, Allocator A>
-struct Measure<Heap<T, A>> {
-    [[nodiscard]] static u64 measure(const Heap<T, A>& heap) noexcept {
+template<Reflectable T, Allocator A, u64 D>
+struct Measure<Heap<T, A, D>> {
+    [[nodiscard]] static u64 measure(const Heap<T, A, D>& heap) noexcept {
         u64 n = 0;
         u64 length = 6;
         for(const T& item : heap) {
@@ -268,9 +426,10 @@ struct Measure<Heap<T, A>> {
         return length;
     }
 };
-template<Allocator O, Reflectable T, Allocator A>
-struct Write<O, Heap<T, A>> {
-    [[nodiscard]] static u64 write(String<O>& output, u64 idx, const Heap<T, A>& heap) noexcept {
+template<Allocator O, Reflectable T, Allocator A, u64 D>
+struct Write<O, Heap<T, A, D>> {
+    [[nodiscard]] static u64 write(String<O>& output, u64 idx,
+                                   const Heap<T, A, D>& heap) noexcept {
         idx = output.write(idx, "Heap["_v);
         u64 n = 0;
         for(const T& item : heap) {
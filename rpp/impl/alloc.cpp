@@ -4,6 +4,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef RPP_OS_WINDOWS
+#include <malloc.h>
+#elif defined RPP_OS_LINUX
+#include <malloc.h>
+#elif defined RPP_OS_MACOS
+#include <malloc/malloc.h>
+#endif
+
 namespace rpp {
 
 static Thread::Atomic g_net_allocs;
@@ -29,6 +37,101 @@ static_assert(sizeof(First_Chunk) == FIRST_CHUNK_SIZE);
 thread_local u64 current_region = 0;
 thread_local u64 region_offsets[MAX_REGION_DEPTH] = {};
 thread_local Region region_brands[MAX_REGION_DEPTH] = {};
+
+static void assert_brand(Region brand) noexcept {
+    if(region_brands[current_region] != brand) {
+        die("Region brand mismatch!");
+    }
+}
+
+// A block ending at top belongs to the innermost region when that region holds at least as
+// many bytes as the block, since the region's bytes are the most recently allocated ones.
+[[nodiscard]] static bool region_top_block(const void* mem, u64 size, const u8* top) noexcept {
+    if(current_region == 0) return false;
+    if(reinterpret_cast<const u8*>(mem) + size != top) return false;
+    return region_offsets[current_region] - region_offsets[current_region - 1] >= size;
+}
+
+#ifdef RPP_REGION_VM
+
+// Each thread reserves one contiguous range, so the region offset is the bump pointer.
+// Pages are committed on demand and decommitted past the high water mark once all regions end.
+
+constexpr u64 REGION_RESERVE_SIZE = Math::GB(16);
+constexpr u64 REGION_COMMIT_SIZE = Math::KB(64);
+constexpr u64 REGION_HIGH_WATER = Math::MB(16);
+
+struct Region_Reserve {
+    Region_Reserve() noexcept = default;
+    ~Region_Reserve() noexcept {
+        if(base) sys_release(base, REGION_RESERVE_SIZE);
+    }
+
+    Region_Reserve(const Region_Reserve&) noexcept = delete;
+    Region_Reserve& operator=(const Region_Reserve&) noexcept = delete;
+
+    Region_Reserve(Region_Reserve&&) noexcept = delete;
+    Region_Reserve& operator=(Region_Reserve&&) noexcept = delete;
+
+    void commit(u64 size) noexcept {
+        if(!base) base = reinterpret_cast<u8*>(sys_reserve(REGION_RESERVE_SIZE));
+        if(size > REGION_RESERVE_SIZE) {
+            die("Region reserve exhausted: % bytes requested!", size);
+        }
+        u64 target =
+            Math::min(Math::max(Math::align(size, REGION_COMMIT_SIZE), 2 * committed),
+                      REGION_RESERVE_SIZE);
+        sys_commit(base + committed, target - committed);
+        committed = target;
+    }
+
+    void trim() noexcept {
+        if(committed <= REGION_HIGH_WATER) return;
+        sys_decommit(base + REGION_HIGH_WATER, committed - REGION_HIGH_WATER);
+        committed = REGION_HIGH_WATER;
+    }
+
+    u8* base = null;
+    u64 committed = 0;
+};
+
+thread_local Region_Reserve reserve;
+
+[[nodiscard]] void* Region_Allocator::alloc(Region brand, u64 size, u64 align) noexcept {
+    assert_brand(brand);
+    // The reserve is page aligned, so aligning the offset aligns the address.
+    u64 offset = Math::align_pow2(region_offsets[current_region], align);
+    if(offset + size > reserve.committed) {
+        reserve.commit(offset + size);
+    }
+    region_offsets[current_region] = offset + size;
+    return reserve.base + offset;
+}
+
+[[nodiscard]] bool Region_Allocator::try_expand(Region brand, void* mem, u64 size,
+                                               u64 new_size) noexcept {
+    assert_brand(brand);
+    assert(new_size >= size);
+    if(!region_top_block(mem, size, reserve.base + region_offsets[current_region])) {
+        return false;
+    }
+    u64 end = region_offsets[current_region] + new_size - size;
+    if(end > reserve.committed) {
+        reserve.commit(end);
+    }
+    region_offsets[current_region] = end;
+    return true;
+}
+
+void Region_Allocator::end(Region brand) noexcept {
+    assert(current_region > 0);
+    assert_brand(brand);
+    current_region--;
+    if(current_region == 0) reserve.trim();
+}
+
+#else
+
 thread_local First_Chunk first_chunk;
 thread_local Chunk* chunks = &first_chunk.chunk;
 
@@ -41,32 +144,35 @@ static void new_chunk(u64 request) noexcept {
     chunks = chunk;
 }
 
-static void assert_brand(Region brand) noexcept {
-    if(region_brands[current_region] != brand) {
-        die("Region brand mismatch!");
-    }
+[[nodiscard]] static u64 chunk_padding(u64 align) noexcept {
+    u64 top = reinterpret_cast<u64>(chunks) + sizeof(Chunk) + chunks->used;
+    return Math::align_pow2(top, align) - top;
 }
 
-[[nodiscard]] void* Region_Allocator::alloc(Region brand, u64 size) noexcept {
+[[nodiscard]] void* Region_Allocator::alloc(Region brand, u64 size, u64 align) noexcept {
     assert_brand(brand);
-    if(chunks->size - chunks->used < size) {
-        new_chunk(size);
+    u64 padding = chunk_padding(align);
+    if(chunks->size - chunks->used < size + padding) {
+        new_chunk(size + align);
+        padding = chunk_padding(align);
     }
-    u8* ret = reinterpret_cast<u8*>(chunks) + sizeof(Chunk) + chunks->used;
-    chunks->used += size;
-    region_offsets[current_region] += size;
+    u8* ret = reinterpret_cast<u8*>(chunks) + sizeof(Chunk) + chunks->used + padding;
+    chunks->used += size + padding;
+    region_offsets[current_region] += size + padding;
     return ret;
 }
 
-void Region_Allocator::free(Region brand, void*) noexcept {
+[[nodiscard]] bool Region_Allocator::try_expand(Region brand, void* mem, u64 size,
+                                               u64 new_size) noexcept {
     assert_brand(brand);
-}
-
-void Region_Allocator::begin(Region brand) noexcept {
-    current_region++;
-    assert(current_region < MAX_REGION_DEPTH);
-    region_offsets[current_region] = region_offsets[current_region - 1];
-    region_brands[current_region] = brand;
+    assert(new_size >= size);
+    u8* top = reinterpret_cast<u8*>(chunks) + sizeof(Chunk) + chunks->used;
+    if(!region_top_block(mem, size, top)) return false;
+    u64 grow = new_size - size;
+    if(chunks->size - chunks->used < grow) return false;
+    chunks->used += grow;
+    region_offsets[current_region] += grow;
+    return true;
 }
 
 void Region_Allocator::end(Region brand) noexcept {
@@ -90,6 +196,23 @@ void Region_Allocator::end(Region brand) noexcept {
     }
 }
 
+#endif
+
+[[nodiscard]] void* Region_Allocator::alloc(Region brand, u64 size) noexcept {
+    return alloc(brand, size, 1);
+}
+
+void Region_Allocator::free(Region brand, void*) noexcept {
+    assert_brand(brand);
+}
+
+void Region_Allocator::begin(Region brand) noexcept {
+    current_region++;
+    assert(current_region < MAX_REGION_DEPTH);
+    region_offsets[current_region] = region_offsets[current_region - 1];
+    region_brands[current_region] = brand;
+}
+
 [[nodiscard]] u64 Region_Allocator::depth() noexcept {
     return current_region;
 }
@@ -98,8 +221,260 @@ void Region_Allocator::end(Region brand) noexcept {
     return region_offsets[current_region];
 }
 
+#ifdef RPP_SIZE_CLASS_ALLOC
+
+// Small blocks are carved from per-class spans and cached per thread, refilling from and draining
+// to a locked central list in batches. Large blocks are mapped directly. Every block is preceded
+// by a header recording how to free it.
+
+constexpr u64 SMALL_CLASSES = 40;
+constexpr u64 MAX_SMALL_SIZE = Math::KB(32);
+constexpr u64 SPAN_SIZE = Math::KB(256);
+constexpr u64 LARGE_GRANULARITY = Math::KB(64);
+constexpr u32 LARGE_CLASS = 0xffffffff;
+constexpr u32 ALIGNED_CLASS = 0xfffffffe;
+
+struct Block_Header {
+    u32 size_class;
+    u32 offset;
+    u64 size;
+};
+static_assert(sizeof(Block_Header) == ALLOC_ALIGNMENT);
+
+struct Free_Block {
+    Free_Block* next;
+};
+
+// 16 byte steps up to 128, then four classes per power of two.
+[[nodiscard]] static u64 size_class(u64 size) noexcept {
+    if(size <= 128) return size == 0 ? 0 : (size - 1) / 16;
+    u64 l = Math::log2(size - 1);
+    u64 sub = ((size - 1) >> (l - 2)) & 3;
+    return 8 + (l - 7) * 4 + sub;
+}
+
+[[nodiscard]] constexpr u64 class_size(u64 cls) noexcept {
+    if(cls < 8) return (cls + 1) * 16;
+    u64 l = 7 + (cls - 8) / 4;
+    u64 sub = (cls - 8) % 4;
+    return (1ull << l) + (sub + 1) * (1ull << (l - 2));
+}
+static_assert(class_size(SMALL_CLASSES - 1) == MAX_SMALL_SIZE);
+
+[[nodiscard]] constexpr u64 cache_limit(u64 cls) noexcept {
+    return Math::clamp<u64>(Math::KB(64) / class_size(cls), 4, 256);
+}
+
+struct Size_Class_Central {
+    Thread::Mutex mutex;
+    Free_Block* list = null;
+};
+
+struct Size_Class_Centrals {
+    Size_Class_Central classes[SMALL_CLASSES];
+};
+
+[[nodiscard]] static Size_Class_Central& central(u64 cls) noexcept {
+    // Never destroyed, so frees from static destructors stay valid.
+    alignas(Size_Class_Centrals) static u8 storage[sizeof(Size_Class_Centrals)];
+    static Size_Class_Centrals* centrals = new(storage) Size_Class_Centrals{};
+    return centrals->classes[cls];
+}
+
+static void carve_span(Size_Class_Central& c, u64 cls) noexcept {
+    u64 stride = sizeof(Block_Header) + class_size(cls);
+    u8* span = reinterpret_cast<u8*>(sys_reserve(SPAN_SIZE));
+    sys_commit(span, SPAN_SIZE);
+    for(u64 offset = 0; offset + stride <= SPAN_SIZE; offset += stride) {
+        Block_Header* header = reinterpret_cast<Block_Header*>(span + offset);
+        header->size_class = static_cast<u32>(cls);
+        header->offset = 0;
+        header->size = class_size(cls);
+        Free_Block* block = reinterpret_cast<Free_Block*>(header + 1);
+        block->next = c.list;
+        c.list = block;
+    }
+}
+
+struct Size_Class_Cache {
+    Size_Class_Cache() noexcept = default;
+    ~Size_Class_Cache() noexcept {
+        for(u64 i = 0; i < SMALL_CLASSES; i++) {
+            release(i, counts[i]);
+        }
+        dead = true;
+    }
+
+    Size_Class_Cache(const Size_Class_Cache&) noexcept = delete;
+    Size_Class_Cache& operator=(const Size_Class_Cache&) noexcept = delete;
+
+    Size_Class_Cache(Size_Class_Cache&&) noexcept = delete;
+    Size_Class_Cache& operator=(Size_Class_Cache&&) noexcept = delete;
+
+    [[nodiscard]] void* alloc(u64 cls) noexcept {
+        if(!lists[cls]) refill(cls);
+        Free_Block* block = lists[cls];
+        lists[cls] = block->next;
+        counts[cls]--;
+        return block;
+    }
+
+    void free(u64 cls, Free_Block* block) noexcept {
+        block->next = lists[cls];
+        lists[cls] = block;
+        counts[cls]++;
+        // Frees from later thread-local destructors go straight back to the central list.
+        if(dead) {
+            release(cls, counts[cls]);
+        } else if(counts[cls] > cache_limit(cls)) {
+            release(cls, cache_limit(cls) / 2);
+        }
+    }
+
+private:
+    void refill(u64 cls) noexcept {
+        Size_Class_Central& c = central(cls);
+        Thread::Lock lock(c.mutex);
+        if(!c.list) carve_span(c, cls);
+        for(u64 i = 0; i < cache_limit(cls) / 2 && c.list; i++) {
+            Free_Block* block = c.list;
+            c.list = block->next;
+            block->next = lists[cls];
+            lists[cls] = block;
+            counts[cls]++;
+        }
+    }
+
+    void release(u64 cls, u64 n) noexcept {
+        if(n == 0) return;
+        Size_Class_Central& c = central(cls);
+        Thread::Lock lock(c.mutex);
+        for(u64 i = 0; i < n; i++) {
+            Free_Block* block = lists[cls];
+            lists[cls] = block->next;
+            block->next = c.list;
+            c.list = block;
+        }
+        counts[cls] -= n;
+    }
+
+    Free_Block* lists[SMALL_CLASSES] = {};
+    u64 counts[SMALL_CLASSES] = {};
+    bool dead = false;
+};
+
+thread_local Size_Class_Cache size_class_cache;
+
+[[nodiscard]] static void* os_alloc(u64 sz) noexcept {
+    if(sz > MAX_SMALL_SIZE) {
+        u64 total = Math::align(sz + sizeof(Block_Header), LARGE_GRANULARITY);
+        Block_Header* header = reinterpret_cast<Block_Header*>(sys_reserve(total));
+        sys_commit(header, total);
+        header->size_class = LARGE_CLASS;
+        header->offset = 0;
+        header->size = total;
+        return header + 1;
+    }
+    return size_class_cache.alloc(size_class(sz));
+}
+
+[[nodiscard]] static void* os_alloc(u64 sz, u64 align) noexcept {
+    if(align <= ALLOC_ALIGNMENT) return os_alloc(sz);
+    assert(align <= RPP_UINT32_MAX);
+    u8* mem = reinterpret_cast<u8*>(os_alloc(sz + align));
+    u8* ret = reinterpret_cast<u8*>(Math::align_pow2(reinterpret_cast<u64>(mem), align));
+    if(ret != mem) {
+        Block_Header* header = reinterpret_cast<Block_Header*>(ret) - 1;
+        header->size_class = ALIGNED_CLASS;
+        header->offset = static_cast<u32>(ret - mem);
+        header->size = sz;
+    }
+    return ret;
+}
+
+// Small blocks can use the rest of their size class; large ones the rest of their mapping, which
+// may itself be extended.
+[[nodiscard]] static bool os_expand(void* mem, u64 sz) noexcept {
+    Block_Header* header = reinterpret_cast<Block_Header*>(mem) - 1;
+    if(header->size_class == ALIGNED_CLASS) return false;
+    if(header->size_class != LARGE_CLASS) return sz <= header->size;
+    u64 total = sz + sizeof(Block_Header);
+    if(total <= header->size) return true;
+    total = Math::align(total, LARGE_GRANULARITY);
+    if(!sys_extend(header, header->size, total)) return false;
+    header->size = total;
+    return true;
+}
+
+static void os_free(void* mem) noexcept {
+    Block_Header* header = reinterpret_cast<Block_Header*>(mem) - 1;
+    if(header->size_class == ALIGNED_CLASS) {
+        mem = reinterpret_cast<u8*>(mem) - header->offset;
+        header = reinterpret_cast<Block_Header*>(mem) - 1;
+    }
+    if(header->size_class == LARGE_CLASS) {
+        sys_release(header, header->size);
+        return;
+    }
+    size_class_cache.free(header->size_class, reinterpret_cast<Free_Block*>(mem));
+}
+
+#else
+
+[[nodiscard]] static void* os_alloc(u64 sz) noexcept {
+#ifdef RPP_OS_WINDOWS
+    // Aligned and unaligned blocks must share sys_free.
+    return _aligned_malloc(sz, ALLOC_ALIGNMENT);
+#else
+    return malloc(sz);
+#endif
+}
+
+[[nodiscard]] static void* os_alloc(u64 sz, u64 align) noexcept {
+#ifdef RPP_OS_WINDOWS
+    return _aligned_malloc(sz, align);
+#else
+    void* ret = null;
+    if(posix_memalign(&ret, Math::max<u64>(align, sizeof(void*)), sz) != 0) ret = null;
+    return ret;
+#endif
+}
+
+[[nodiscard]] static bool os_expand(void* mem, u64 sz) noexcept {
+#ifdef RPP_OS_LINUX
+    return malloc_usable_size(mem) >= sz;
+#elif defined RPP_OS_MACOS
+    return malloc_size(mem) >= sz;
+#else
+    // _expand does not apply to _aligned_malloc blocks.
+    static_cast<void>(mem);
+    static_cast<void>(sz);
+    return false;
+#endif
+}
+
+static void os_free(void* mem) noexcept {
+#ifdef RPP_OS_WINDOWS
+    _aligned_free(mem);
+#else
+    free(mem);
+#endif
+}
+
+#endif
+
 [[nodiscard]] void* sys_alloc(u64 sz) noexcept {
-    void* ret = malloc(sz);
+    void* ret = os_alloc(sz);
+    assert(ret);
+#ifndef RPP_RELEASE_BUILD
+    g_net_allocs.incr();
+#endif
+    return ret;
+}
+
+[[nodiscard]] void* sys_alloc(u64 sz, u64 align) noexcept {
+    assert(align && (align & (align - 1)) == 0);
+    void* ret = os_alloc(sz, align);
     assert(ret);
 #ifndef RPP_RELEASE_BUILD
     g_net_allocs.incr();
@@ -107,12 +482,16 @@ void Region_Allocator::end(Region brand) noexcept {
     return ret;
 }
 
+[[nodiscard]] bool sys_expand(void* mem, u64 sz) noexcept {
+    return mem && os_expand(mem, sz);
+}
+
 void sys_free(void* mem) noexcept {
     if(!mem) return;
 #ifndef RPP_RELEASE_BUILD
     g_net_allocs.decr();
 #endif
-    free(mem);
+    os_free(mem);
 }
 
 [[nodiscard]] i64 sys_net_allocs() noexcept {
@@ -0,0 +1,282 @@
+
+#include "../base.h"
+
+namespace rpp::Format::detail {
+
+// Grisu2 (Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers"). The
+// digits always round-trip and are the shortest such digits for all but a tiny fraction of
+// inputs, where one extra digit may be emitted.
+
+struct Diy_Fp {
+    u64 f = 0;
+    i32 e = 0;
+
+    [[nodiscard]] Diy_Fp operator-(Diy_Fp other) const noexcept {
+        return Diy_Fp{f - other.f, e};
+    }
+    [[nodiscard]] Diy_Fp operator*(Diy_Fp other) const noexcept {
+        constexpr u64 M32 = 0xffffffff;
+        u64 a = f >> 32, b = f & M32, c = other.f >> 32, d = other.f & M32;
+        u64 ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+        u64 mid = (bd >> 32) + (ad & M32) + (bc & M32) + (u64{1} << 31);
+        return Diy_Fp{ac + (ad >> 32) + (bc >> 32) + (mid >> 32), e + other.e + 64};
+    }
+    [[nodiscard]] Diy_Fp normalize() const noexcept {
+        u64 shift = Math::ctlz(f);
+        return Diy_Fp{f << shift, e - static_cast<i32>(shift)};
+    }
+};
+
+// Normalized 64-bit significands of 10^k for k = -348, -340, ..., 340.
+constexpr Diy_Fp CACHED_POWERS[] = {
+    {0xfa8fd5a0081c0288ul, -1220}, {0xbaaee17fa23ebf76ul, -1193},
+    {0x8b16fb203055ac76ul, -1166}, {0xcf42894a5dce35eaul, -1140},
+    {0x9a6bb0aa55653b2dul, -1113}, {0xe61acf033d1a45dful, -1087},
+    {0xab70fe17c79ac6caul, -1060}, {0xff77b1fcbebcdc4ful, -1034},
+    {0xbe5691ef416bd60cul, -1007}, {0x8dd01fad907ffc3cul, -980},
+    {0xd3515c2831559a83ul, -954}, {0x9d71ac8fada6c9b5ul, -927},
+    {0xea9c227723ee8bcbul, -901}, {0xaecc49914078536dul, -874},
+    {0x823c12795db6ce57ul, -847}, {0xc21094364dfb5637ul, -821},
+    {0x9096ea6f3848984ful, -794}, {0xd77485cb25823ac7ul, -768},
+    {0xa086cfcd97bf97f4ul, -741}, {0xef340a98172aace5ul, -715},
+    {0xb23867fb2a35b28eul, -688}, {0x84c8d4dfd2c63f3bul, -661},
+    {0xc5dd44271ad3cdbaul, -635}, {0x936b9fcebb25c996ul, -608},
+    {0xdbac6c247d62a584ul, -582}, {0xa3ab66580d5fdaf6ul, -555},
+    {0xf3e2f893dec3f126ul, -529}, {0xb5b5ada8aaff80b8ul, -502},
+    {0x87625f056c7c4a8bul, -475}, {0xc9bcff6034c13053ul, -449},
+    {0x964e858c91ba2655ul, -422}, {0xdff9772470297ebdul, -396},
+    {0xa6dfbd9fb8e5b88ful, -369}, {0xf8a95fcf88747d94ul, -343},
+    {0xb94470938fa89bcful, -316}, {0x8a08f0f8bf0f156bul, -289},
+    {0xcdb02555653131b6ul, -263}, {0x993fe2c6d07b7facul, -236},
+    {0xe45c10c42a2b3b06ul, -210}, {0xaa242499697392d3ul, -183},
+    {0xfd87b5f28300ca0eul, -157}, {0xbce5086492111aebul, -130},
+    {0x8cbccc096f5088ccul, -103}, {0xd1b71758e219652cul, -77},
+    {0x9c40000000000000ul, -50}, {0xe8d4a51000000000ul, -24},
+    {0xad78ebc5ac620000ul, 3}, {0x813f3978f8940984ul, 30},
+    {0xc097ce7bc90715b3ul, 56}, {0x8f7e32ce7bea5c70ul, 83},
+    {0xd5d238a4abe98068ul, 109}, {0x9f4f2726179a2245ul, 136},
+    {0xed63a231d4c4fb27ul, 162}, {0xb0de65388cc8ada8ul, 189},
+    {0x83c7088e1aab65dbul, 216}, {0xc45d1df942711d9aul, 242},
+    {0x924d692ca61be758ul, 269}, {0xda01ee641a708deaul, 295},
+    {0xa26da3999aef774aul, 322}, {0xf209787bb47d6b85ul, 348},
+    {0xb454e4a179dd1877ul, 375}, {0x865b86925b9bc5c2ul, 402},
+    {0xc83553c5c8965d3dul, 428}, {0x952ab45cfa97a0b3ul, 455},
+    {0xde469fbd99a05fe3ul, 481}, {0xa59bc234db398c25ul, 508},
+    {0xf6c69a72a3989f5cul, 534}, {0xb7dcbf5354e9beceul, 561},
+    {0x88fcf317f22241e2ul, 588}, {0xcc20ce9bd35c78a5ul, 614},
+    {0x98165af37b2153dful, 641}, {0xe2a0b5dc971f303aul, 667},
+    {0xa8d9d1535ce3b396ul, 694}, {0xfb9b7cd9a4a7443cul, 720},
+    {0xbb764c4ca7a44410ul, 747}, {0x8bab8eefb6409c1aul, 774},
+    {0xd01fef10a657842cul, 800}, {0x9b10a4e5e9913129ul, 827},
+    {0xe7109bfba19c0c9dul, 853}, {0xac2820d9623bf429ul, 880},
+    {0x80444b5e7aa7cf85ul, 907}, {0xbf21e44003acdd2dul, 933},
+    {0x8e679c2f5e44ff8ful, 960}, {0xd433179d9c8cb841ul, 986},
+    {0x9e19db92b4e31ba9ul, 1013}, {0xeb96bf6ebadf77d9ul, 1039},
+    {0xaf87023b9bf0ee6bul, 1066},
+};
+constexpr i32 CACHED_POWER_MIN = -348;
+constexpr i32 CACHED_POWER_STEP = 8;
+
+constexpr u64 POW10[] = {1ul,
+                         10ul,
+                         100ul,
+                         1000ul,
+                         10000ul,
+                         100000ul,
+                         1000000ul,
+                         10000000ul,
+                         100000000ul,
+                         1000000000ul,
+                         10000000000ul,
+                         100000000000ul,
+                         1000000000000ul,
+                         10000000000000ul,
+                         100000000000000ul,
+                         1000000000000000ul,
+                         10000000000000000ul,
+                         100000000000000000ul,
+                         1000000000000000000ul,
+                         10000000000000000000ul};
+
+// Picks c = 10^-k such that the product with a significand of exponent e lands in [-60, -32].
+[[nodiscard]] static Diy_Fp cached_power(i32 e, i32& k) noexcept {
+    f64 dk = (-61 - e) * 0.30102999566398114 + 347;
+    i32 ik = static_cast<i32>(dk);
+    if(dk - ik > 0.0) ik++;
+    u64 index = static_cast<u64>((ik >> 3) + 1);
+    k = -(CACHED_POWER_MIN + static_cast<i32>(index) * CACHED_POWER_STEP);
+    return CACHED_POWERS[index];
+}
+
+[[nodiscard]] static u64 count_digits(u32 n) noexcept {
+    u64 digits = 1;
+    while(n >= 10) {
+        n /= 10;
+        digits++;
+    }
+    return digits;
+}
+
+static void grisu_round(u8* buffer, u64 length, u64 delta, u64 rest, u64 ten_kappa,
+                        u64 wp_w) noexcept {
+    while(rest < wp_w && delta - rest >= ten_kappa &&
+          (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buffer[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+[[nodiscard]] static u64 digit_gen(Diy_Fp w, Diy_Fp mp, u64 delta, u8* buffer, i32& k) noexcept {
+    Diy_Fp one{u64{1} << -mp.e, mp.e};
+    Diy_Fp wp_w = mp - w;
+    u32 p1 = static_cast<u32>(mp.f >> -one.e);
+    u64 p2 = mp.f & (one.f - 1);
+    u64 kappa = count_digits(p1);
+    u64 length = 0;
+
+    while(kappa > 0) {
+        u32 d = p1 / static_cast<u32>(POW10[kappa - 1]);
+        p1 %= static_cast<u32>(POW10[kappa - 1]);
+        if(d || length) buffer[length++] = static_cast<u8>('0' + d);
+        kappa--;
+        u64 rest = (static_cast<u64>(p1) << -one.e) + p2;
+        if(rest <= delta) {
+            k += static_cast<i32>(kappa);
+            grisu_round(buffer, length, delta, rest, POW10[kappa] << -one.e, wp_w.f);
+            return length;
+        }
+    }
+    for(;;) {
+        p2 *= 10;
+        delta *= 10;
+        u8 d = static_cast<u8>(p2 >> -one.e);
+        if(d || length) buffer[length++] = static_cast<u8>('0' + d);
+        p2 &= one.f - 1;
+        kappa++;
+        if(p2 < delta) {
+            k -= static_cast<i32>(kappa);
+            grisu_round(buffer, length, delta, p2, one.f, kappa < 20 ? wp_w.f * POW10[kappa] : 0);
+            return length;
+        }
+    }
+}
+
+// Writes the digits of the shortest decimal in (lower, upper) around value = f * 2^e, where the
+// lower boundary is closer when f is the smallest significand of its binade.
+[[nodiscard]] static u64 grisu2(u64 f, i32 e, bool lower_closer, u8* buffer, i32& k) noexcept {
+    Diy_Fp v{f, e};
+    Diy_Fp plus = Diy_Fp{(f << 1) + 1, e - 1}.normalize();
+    Diy_Fp minus = lower_closer ? Diy_Fp{(f << 2) - 1, e - 2} : Diy_Fp{(f << 1) - 1, e - 1};
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    Diy_Fp c_mk = cached_power(plus.e, k);
+    Diy_Fp w = v.normalize() * c_mk;
+    Diy_Fp wp = plus * c_mk;
+    Diy_Fp wm = minus * c_mk;
+    wm.f++;
+    wp.f--;
+    return digit_gen(w, wp, wp.f - wm.f, buffer, k);
+}
+
+[[nodiscard]] static u64 write_exponent(u8* out, i32 e) noexcept {
+    u64 length = 0;
+    if(e < 0) {
+        out[length++] = '-';
+        e = -e;
+    }
+    if(e >= 100) {
+        out[length++] = static_cast<u8>('0' + e / 100);
+        e %= 100;
+        out[length++] = static_cast<u8>('0' + e / 10);
+    } else if(e >= 10) {
+        out[length++] = static_cast<u8>('0' + e / 10);
+    }
+    out[length++] = static_cast<u8>('0' + e % 10);
+    return length;
+}
+
+// Lays out digits * 10^k: plain decimals between 1e-6 and 1e21, scientific notation otherwise.
+// Integral values keep a trailing ".0" so they still read as floats.
+[[nodiscard]] static u64 prettify(u8* buffer, u64 length, i32 k) noexcept {
+    i32 n = static_cast<i32>(length);
+    i32 kk = n + k;
+    if(k >= 0 && kk <= 21) {
+        for(i32 i = n; i < kk; i++) buffer[i] = '0';
+        buffer[kk] = '.';
+        buffer[kk + 1] = '0';
+        return static_cast<u64>(kk + 2);
+    }
+    if(kk > 0 && kk <= 21) {
+        Libc::memmove(buffer + kk + 1, buffer + kk, static_cast<u64>(n - kk));
+        buffer[kk] = '.';
+        return length + 1;
+    }
+    if(kk > -6 && kk <= 0) {
+        i32 offset = 2 - kk;
+        Libc::memmove(buffer + offset, buffer, length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        for(i32 i = 2; i < offset; i++) buffer[i] = '0';
+        return length + static_cast<u64>(offset);
+    }
+    if(n == 1) {
+        buffer[1] = 'e';
+        return 2 + write_exponent(buffer + 2, kk - 1);
+    }
+    Libc::memmove(buffer + 2, buffer + 1, length - 1);
+    buffer[1] = '.';
+    buffer[length + 1] = 'e';
+    return length + 2 + write_exponent(buffer + length + 2, kk - 1);
+}
+
+template<typename F, typename U, u64 SIGNIFICAND_BITS, i32 EXPONENT_BIAS>
+[[nodiscard]] static u64 write_float(u8* out, F value) noexcept {
+    constexpr U SIGN = static_cast<U>(1) << (sizeof(U) * 8 - 1);
+    constexpr U HIDDEN = static_cast<U>(1) << SIGNIFICAND_BITS;
+    constexpr U SIGNIFICAND_MASK = HIDDEN - 1;
+    constexpr u64 EXPONENT_BITS = (sizeof(U) * 8 - 1) - SIGNIFICAND_BITS;
+
+    U bits = 0;
+    Libc::memcpy(&bits, &value, sizeof(F));
+    U significand = bits & SIGNIFICAND_MASK;
+    u64 biased = static_cast<u64>((bits & ~SIGN) >> SIGNIFICAND_BITS);
+
+    u64 length = 0;
+    if(bits & SIGN) out[length++] = '-';
+
+    if(biased == (u64{1} << EXPONENT_BITS) - 1) {
+        if(significand) {
+            Libc::memcpy(out, "nan", 3);
+            return 3;
+        }
+        Libc::memcpy(out + length, "inf", 3);
+        return length + 3;
+    }
+    if(biased == 0 && significand == 0) {
+        Libc::memcpy(out + length, "0.0", 3);
+        return length + 3;
+    }
+
+    u64 f = significand;
+    i32 e = 1 - EXPONENT_BIAS - static_cast<i32>(SIGNIFICAND_BITS);
+    if(biased) {
+        f += HIDDEN;
+        e = static_cast<i32>(biased) - EXPONENT_BIAS - static_cast<i32>(SIGNIFICAND_BITS);
+    }
+
+    i32 k = 0;
+    u8* digits = out + length;
+    u64 n = grisu2(f, e, significand == 0 && biased > 1, digits, k);
+    return length + prettify(digits, n, k);
+}
+
+[[nodiscard]] u64 write_float(u8* out, f64 value) noexcept {
+    return write_float<f64, u64, 52, 1023>(out, value);
+}
+
+[[nodiscard]] u64 write_float(u8* out, f32 value) noexcept {
+    return write_float<f32, u32, 23, 127>(out, value);
+}
+
+} // namespace rpp::Format::detail
@@ -0,0 +1,12 @@
+
+#include "../base.h"
+
+#ifdef RPP_EXTERN_TEMPLATES
+
+namespace rpp {
+
+RPP_INSTANCES()
+
+} // namespace rpp
+
+#endif
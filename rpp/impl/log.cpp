@@ -1,6 +1,7 @@
 
 #include "../base.h"
 #include "../log_callback.h"
+#include "../thread.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -20,6 +21,98 @@ namespace rpp {
 
 namespace Log {
 
+constexpr u64 BATCH_SIZE = Math::KB(64);
+
+struct Async_Record {
+    // Bytes from this record to the next. Zero marks padding up to the end of the ring.
+    u64 size = 0;
+    u64 length = 0;
+    Location loc;
+    Thread::Id thread = 0;
+    Time time = 0;
+    u64 indent = 0;
+    Level level = Level::info;
+    // Set for deferred records, whose message is the raw arguments to fmt.
+    const detail::Deferred* deferred = null;
+    String_View fmt;
+};
+
+static_assert(sizeof(Async_Record) % 8 == 0);
+
+// Binary logs start with BINARY_MAGIC, followed by entries that each start with their kind.
+// A string entry is a u32 id, which counts up from zero, then a u32 length and the text. A record
+// entry is a Binary_Record naming previously written strings, then 'count' Arg tags and 'length'
+// bytes of arguments. All values are in native byte order.
+constexpr u8 BINARY_MAGIC[8] = {'r', 'p', 'p', 'l', 'o', 'g', '0', '1'};
+
+enum class Binary_Entry : u8 {
+    string,
+    record,
+};
+
+struct Binary_Record {
+    u32 fmt = 0;
+    u32 file = 0;
+    u32 function = 0;
+    u32 line = 0;
+    Time time = 0;
+    Thread::Id thread = 0;
+    u32 indent = 0;
+    u32 length = 0;
+    Level level = Level::info;
+    u8 count = 0;
+    u8 padding[6] = {};
+};
+
+static_assert(sizeof(Binary_Record) == 48);
+
+struct Async_Ring_Owner;
+
+// Single producer, single consumer ring of records, each followed by its message. Records never
+// wrap, so messages can be read in place. It is owned by the logging thread until that thread
+// exits and closes it, and the drain then frees it once empty, or until stop_async frees it.
+struct Async_Ring {
+    alignas(64) Thread::Atomic_Of<u64> head;
+    alignas(64) Thread::Atomic_Of<u64> tail;
+    Thread::Atomic_Of<u32> closed;
+    // Cleared under the ring list lock when the owning thread exits.
+    Async_Ring_Owner* owner = null;
+    u64 capacity = 0;
+    Async_Ring* next = null;
+
+    [[nodiscard]] u8* data() noexcept {
+        return reinterpret_cast<u8*>(this + 1);
+    }
+};
+
+// The writing flag lives with the thread rather than in its ring, so that stop_async can free
+// the ring while the thread is still running.
+struct Async_Ring_Owner {
+    Thread::Atomic_Of<Async_Ring*> ring;
+    Thread::Atomic_Of<u32> writing;
+
+    ~Async_Ring_Owner() noexcept;
+};
+
+struct Async_State {
+    // Serializes drains and guards the ring list.
+    Thread::Mutex mut;
+    Async_Ring* rings = null;
+    Async_Config config;
+
+    Thread::Atomic_Of<u32> running;
+    Thread::Atomic_Of<u32> exit;
+    Thread::Atomic dropped;
+    Thread::Thread<Alloc> thread;
+
+    FILE* binary = null;
+    Map<const u8*, u32, Alloc> binary_strings;
+
+    u64 last_flush = 0;
+    u64 batch_length = 0;
+    char batch[BATCH_SIZE];
+};
+
 struct Static_Data {
     Token next = 1;
     Map<Token, Function<Callback>, Mhidden> callbacks;
@@ -27,6 +120,8 @@ struct Static_Data {
     Thread::Mutex lock;
     FILE* file = null;
 
+    Async_State async;
+
     Static_Data() noexcept {
 #ifdef RPP_OS_WINDOWS
         if(fopen_s(&file, "debug.log", "w")) file = null;
@@ -35,6 +130,7 @@ struct Static_Data {
 #endif
     }
     ~Static_Data() noexcept {
+        stop_async();
         if(file) fclose(file);
         file = null;
     }
@@ -42,6 +138,16 @@ struct Static_Data {
 
 static Static_Data g_log_data;
 static thread_local u64 g_log_indent = 0;
+static thread_local Async_Ring_Owner g_log_ring;
+
+Async_Ring_Owner::~Async_Ring_Owner() noexcept {
+    Thread::Lock lock(g_log_data.async.mut);
+    if(Async_Ring* mine = ring.exchange(null, Thread::Order::relaxed)) {
+        mine->owner = null;
+        mine->closed.store(1, Thread::Order::release);
+    }
+}
+static thread_local bool g_log_draining = false;
 
 #ifdef RPP_OS_WINDOWS
 
@@ -123,12 +229,16 @@ static_assert(alignof(::time_t) <= alignof(Time));
     return String_View{reinterpret_cast<const u8*>(buffer), static_cast<u64>(written)};
 }
 
-void output(Level level, const Location& loc, String_View msg) noexcept {
-
-    const char* level_str;
-    const char* format_str;
-
+static void level_format(Level level, const char*& level_str, const char*& format_str) noexcept {
     switch(level) {
+    case Level::trace: {
+        level_str = "trace";
+        format_str = "%.*s [%s/%zu] [%.*s:%zu]: %*s%.*s\n";
+    } break;
+    case Level::debug: {
+        level_str = "debug";
+        format_str = "%.*s [%s/%zu] [%.*s:%zu]: %*s%.*s\n";
+    } break;
     case Level::info: {
         level_str = "info";
         format_str = "%.*s [%s/%zu] [%.*s:%zu]: %*s%.*s\n";
@@ -143,6 +253,522 @@ void output(Level level, const Location& loc, String_View msg) noexcept {
     } break;
     default: RPP_UNREACHABLE;
     }
+}
+
+[[nodiscard]] static i32 format_record(char* buffer, u64 size, const Async_Record& record,
+                                       String_View msg) noexcept {
+    const char* level_str;
+    const char* format_str;
+    level_format(record.level, level_str, format_str);
+
+    String_View time = sys_time_string(record.time);
+    return snprintf(buffer, size, format_str, time.length(), time.data(), level_str,
+                    record.thread, record.loc.file.length(), record.loc.file.data(),
+                    record.loc.line, record.indent * INDENT_SIZE, "", msg.length(), msg.data());
+}
+
+static void print_record(FILE* file, const Async_Record& record, String_View msg) noexcept {
+    const char* level_str;
+    const char* format_str;
+    level_format(record.level, level_str, format_str);
+
+    String_View time = sys_time_string(record.time);
+    fprintf(file, format_str, time.length(), time.data(), level_str, record.thread,
+            record.loc.file.length(), record.loc.file.data(), record.loc.line,
+            record.indent * INDENT_SIZE, "", msg.length(), msg.data());
+}
+
+static void write_batch(Async_State& async) noexcept {
+    if(!async.batch_length) return;
+    fwrite(async.batch, 1, async.batch_length, stdout);
+    if(g_log_data.file) fwrite(async.batch, 1, async.batch_length, g_log_data.file);
+    async.batch_length = 0;
+}
+
+static void flush_files() noexcept {
+    fflush(stdout);
+    if(g_log_data.file) fflush(g_log_data.file);
+    if(g_log_data.async.binary) fflush(g_log_data.async.binary);
+}
+
+static void batch_record(Async_State& async, const Async_Record& record,
+                         String_View msg) noexcept {
+    for(;;) {
+        u64 left = BATCH_SIZE - async.batch_length;
+        i32 written = format_record(async.batch + async.batch_length, left, record, msg);
+        assert(written >= 0);
+        if(static_cast<u64>(written) < left) {
+            async.batch_length += static_cast<u64>(written);
+            break;
+        }
+        if(async.batch_length) {
+            write_batch(async);
+            continue;
+        }
+        // Longer than the whole batch.
+        print_record(stdout, record, msg);
+        if(g_log_data.file) print_record(g_log_data.file, record, msg);
+        break;
+    }
+
+    for(auto& [_, callback] : g_log_data.callbacks) {
+        callback(record.level, record.thread, record.time, record.loc, msg);
+    }
+}
+
+[[nodiscard]] static u32 binary_string(Async_State& async, String_View text) noexcept {
+    if(async.binary_strings.contains(text.data())) return async.binary_strings.get(text.data());
+
+    u32 id = static_cast<u32>(async.binary_strings.length());
+    async.binary_strings.insert(text.data(), id);
+
+    u8 entry = static_cast<u8>(Binary_Entry::string);
+    u32 length = static_cast<u32>(text.length());
+    fwrite(&entry, 1, sizeof(entry), async.binary);
+    fwrite(&id, 1, sizeof(id), async.binary);
+    fwrite(&length, 1, sizeof(length), async.binary);
+    fwrite(text.data(), 1, length, async.binary);
+    return id;
+}
+
+static void write_binary(Async_State& async, const Async_Record& record,
+                         String_View args) noexcept {
+    Binary_Record binary;
+    binary.fmt = binary_string(async, record.fmt);
+    binary.file = binary_string(async, record.loc.file);
+    binary.function = binary_string(async, record.loc.function);
+    binary.line = static_cast<u32>(record.loc.line);
+    binary.time = record.time;
+    binary.thread = record.thread;
+    binary.indent = static_cast<u32>(record.indent);
+    binary.length = static_cast<u32>(args.length());
+    binary.level = record.level;
+    binary.count = static_cast<u8>(record.deferred->count);
+
+    u8 entry = static_cast<u8>(Binary_Entry::record);
+    fwrite(&entry, 1, sizeof(entry), async.binary);
+    fwrite(&binary, 1, sizeof(binary), async.binary);
+    fwrite(record.deferred->args, 1, record.deferred->count, async.binary);
+    fwrite(args.data(), 1, args.length(), async.binary);
+}
+
+static void drain_record(Async_State& async, const Async_Record& record, String_View msg) noexcept {
+    if(!record.deferred) {
+        batch_record(async, record, msg);
+    } else if(async.binary) {
+        write_binary(async, record, msg);
+    } else {
+        String<Alloc> text = record.deferred->decode(record.fmt, msg.data());
+        batch_record(async, record, text.view());
+    }
+}
+
+[[nodiscard]] static bool drain_ring(Async_State& async, Async_Ring& ring) noexcept {
+    u64 mask = ring.capacity - 1;
+    u64 head = ring.head.load(Thread::Order::relaxed);
+    u64 tail = ring.tail.load(Thread::Order::acquire);
+    if(head == tail) return false;
+
+    while(head != tail) {
+        u64 offset = head & mask;
+        u64 size = 0;
+        Libc::memcpy(&size, ring.data() + offset, sizeof(size));
+        if(!size) {
+            head += ring.capacity - offset;
+            continue;
+        }
+        Async_Record record;
+        Libc::memcpy(&record, ring.data() + offset, sizeof(record));
+        drain_record(async, record,
+                     String_View{ring.data() + offset + sizeof(record), record.length});
+        head += size;
+    }
+    ring.head.store(head, Thread::Order::release);
+    return true;
+}
+
+// Writes out every ring, frees the rings of exited threads, and flushes by the configured policy.
+static bool drain(Async_State& async) noexcept {
+    Thread::Lock lock(async.mut);
+    Thread::Lock callbacks_lock(g_log_data.lock);
+    g_log_draining = true;
+
+    bool drained = false;
+    Async_Ring** link = &async.rings;
+    while(Async_Ring* ring = *link) {
+        bool closed = ring->closed.load(Thread::Order::acquire);
+        drained = drain_ring(async, *ring) || drained;
+        if(closed) {
+            *link = ring->next;
+            Alloc::free(ring);
+        } else {
+            link = &ring->next;
+        }
+    }
+    write_batch(async);
+
+    u64 now = Thread::perf_counter();
+    u64 interval = async.config.interval_ms * Thread::perf_frequency() / 1000;
+    if(drained && (async.config.flush == Flush::batch || now - async.last_flush >= interval)) {
+        flush_files();
+        async.last_flush = now;
+    }
+
+    g_log_draining = false;
+    return drained;
+}
+
+[[nodiscard]] static Async_Ring* make_ring(Async_State& async, Async_Ring_Owner& owner) noexcept {
+    u64 capacity = async.config.ring_size;
+    Async_Ring* ring = reinterpret_cast<Async_Ring*>(
+        Alloc::alloc(sizeof(Async_Ring) + capacity, alignof(Async_Ring)));
+    new(ring) Async_Ring{};
+    ring->owner = &owner;
+    ring->capacity = capacity;
+
+    Thread::Lock lock(async.mut);
+    ring->next = async.rings;
+    async.rings = ring;
+    return ring;
+}
+
+static void push_record(Async_State& async, Async_Ring& ring, Async_Record& record,
+                        String_View msg) noexcept {
+    u64 size = sizeof(Async_Record) + Math::align_pow2(msg.length(), u64{8});
+    u64 mask = ring.capacity - 1;
+    u64 tail = ring.tail.load(Thread::Order::relaxed);
+    u64 head = ring.head.load(Thread::Order::acquire);
+
+    u64 offset = tail & mask;
+    u64 to_end = ring.capacity - offset;
+    u64 needed = size <= to_end ? size : to_end + size;
+    if(needed > ring.capacity - (tail - head)) {
+        async.dropped.incr(Thread::Order::relaxed);
+        return;
+    }
+    if(size > to_end) {
+        u64 padding = 0;
+        Libc::memcpy(ring.data() + offset, &padding, sizeof(padding));
+        tail += to_end;
+        offset = 0;
+    }
+
+    record.size = size;
+    record.length = msg.length();
+    Libc::memcpy(ring.data() + offset, &record, sizeof(record));
+    Libc::memcpy(ring.data() + offset + sizeof(record), msg.data(), msg.length());
+    ring.tail.store(tail + size, Thread::Order::release);
+}
+
+[[nodiscard]] static bool async_push(Async_State& async, Async_Record& record,
+                                     String_View msg) noexcept {
+    Async_Ring_Owner& owner = g_log_ring;
+
+    // Pairs with stop_async, which clears running and then waits for writing to clear. The ring
+    // must be listed before writing is set, so a ring that stop_async freed in between is
+    // replaced before trying again.
+    Async_Ring* ring = null;
+    for(;;) {
+        if(!owner.ring.load(Thread::Order::relaxed)) {
+            owner.ring.store(make_ring(async, owner), Thread::Order::relaxed);
+        }
+        owner.writing.store(1);
+        if(!async.running.load()) {
+            owner.writing.store(0, Thread::Order::release);
+            return false;
+        }
+        ring = owner.ring.load(Thread::Order::relaxed);
+        if(ring) break;
+        owner.writing.store(0, Thread::Order::release);
+    }
+
+    record.thread = Thread::this_id();
+    record.time = sys_time();
+    record.indent = g_log_indent;
+    push_record(async, *ring, record, msg);
+
+    owner.writing.store(0, Thread::Order::release);
+    return true;
+}
+
+[[nodiscard]] static bool async_output(Level level, const Location& loc, String_View msg) noexcept {
+    Async_State& async = g_log_data.async;
+    if(!async.running.load(Thread::Order::relaxed)) return false;
+
+    Async_Record record;
+    record.loc = loc;
+    record.level = level;
+    return async_push(async, record, msg);
+}
+
+[[nodiscard]] bool detail::defer(Level level, const Location& loc, String_View fmt,
+                                 const Deferred& deferred, const u8* args, u64 length) noexcept {
+    Async_State& async = g_log_data.async;
+    if(level == Level::fatal || !async.running.load(Thread::Order::acquire)) return false;
+    if(!async.config.deferred) return false;
+
+    Async_Record record;
+    record.loc = loc;
+    record.level = level;
+    record.deferred = &deferred;
+    record.fmt = fmt;
+    return async_push(async, record, String_View{args, length});
+}
+
+void start_async(Async_Config config) noexcept {
+    Async_State& async = g_log_data.async;
+    if(async.running.load()) return;
+
+    async.config = config;
+    async.config.ring_size = Math::next_pow2(Math::max(config.ring_size, u64{256}));
+    if(!config.binary.empty()) {
+        Region(R) {
+            auto path = config.binary.terminate<Mregion<R>>();
+#ifdef RPP_OS_WINDOWS
+            if(fopen_s(&async.binary, reinterpret_cast<const char*>(path.data()), "wb")) {
+                async.binary = null;
+            }
+#else
+            async.binary = fopen(reinterpret_cast<const char*>(path.data()), "wb");
+#endif
+        }
+        if(async.binary) {
+            fwrite(BINARY_MAGIC, 1, sizeof(BINARY_MAGIC), async.binary);
+        } else {
+            warn("Failed to open binary log %: %", config.binary, sys_error());
+        }
+    }
+    async.exit.store(0);
+    async.thread = Thread::Thread<Alloc>{[]() {
+        Async_State& async = g_log_data.async;
+        while(!async.exit.load()) {
+            if(!drain(async)) Thread::sleep(async.config.interval_ms);
+        }
+        static_cast<void>(drain(async));
+        flush_files();
+    }};
+    async.running.store(1);
+}
+
+void stop_async() noexcept {
+    Async_State& async = g_log_data.async;
+    if(!async.running.exchange(0)) return;
+    {
+        Thread::Lock lock(async.mut);
+        for(Async_Ring* ring = async.rings; ring; ring = ring->next) {
+            if(ring->owner) {
+                while(ring->owner->writing.load()) Thread::pause();
+            }
+        }
+    }
+    async.exit.store(1);
+    async.thread.join();
+
+    // Every ring has been drained, and threads that are still running make a new one on their
+    // next message after a restart.
+    {
+        Thread::Lock lock(async.mut);
+        while(Async_Ring* ring = async.rings) {
+            async.rings = ring->next;
+            if(ring->owner) ring->owner->ring.store(null, Thread::Order::relaxed);
+            Alloc::free(ring);
+        }
+    }
+
+    if(async.binary) {
+        fclose(async.binary);
+        async.binary = null;
+        async.binary_strings.clear();
+    }
+}
+
+void flush() noexcept {
+    if(g_log_draining) return;
+    static_cast<void>(drain(g_log_data.async));
+    flush_files();
+}
+
+[[nodiscard]] u64 dropped() noexcept {
+    return g_log_data.async.dropped.load<u64>();
+}
+
+constexpr u64 RATE_SITES = 1024;
+
+struct Rate_Site {
+    Thread::Atomic_Of<u64> window;
+    Thread::Atomic_Of<u64> count;
+};
+
+static Rate_Site g_rate_sites[RATE_SITES];
+
+[[nodiscard]] bool detail::rate_limited(u64 site, u64 limit) noexcept {
+    Rate_Site& entry = g_rate_sites[site & (RATE_SITES - 1)];
+    u64 now = Thread::perf_counter();
+    u64 window = entry.window.load(Thread::Order::relaxed);
+    if(now - window >= Thread::perf_frequency()) {
+        if(entry.window.compare_and_swap(window, now, Thread::Order::relaxed) == window) {
+            entry.count.store(0, Thread::Order::relaxed);
+        }
+    }
+    return entry.count.incr(Thread::Order::relaxed) > limit;
+}
+
+[[nodiscard]] static u64 arg_size(detail::Arg tag) noexcept {
+    switch(tag) {
+    case detail::Arg::i8_:
+    case detail::Arg::u8_:
+    case detail::Arg::bool_:
+    case detail::Arg::char_: return 1;
+    case detail::Arg::i16_:
+    case detail::Arg::u16_: return 2;
+    case detail::Arg::i32_:
+    case detail::Arg::u32_:
+    case detail::Arg::f32_: return 4;
+    case detail::Arg::i64_:
+    case detail::Arg::u64_:
+    case detail::Arg::f64_: return 8;
+    case detail::Arg::pointer_: return sizeof(void*);
+    }
+    return 0;
+}
+
+template<typename F>
+static void visit_arg(detail::Arg tag, const u8* arg, F&& f) noexcept {
+    switch(tag) {
+    case detail::Arg::i8_: f(detail::load_arg<i8>(arg)); break;
+    case detail::Arg::u8_: f(detail::load_arg<u8>(arg)); break;
+    case detail::Arg::i16_: f(detail::load_arg<i16>(arg)); break;
+    case detail::Arg::u16_: f(detail::load_arg<u16>(arg)); break;
+    case detail::Arg::i32_: f(detail::load_arg<i32>(arg)); break;
+    case detail::Arg::u32_: f(detail::load_arg<u32>(arg)); break;
+    case detail::Arg::i64_: f(detail::load_arg<i64>(arg)); break;
+    case detail::Arg::u64_: f(detail::load_arg<u64>(arg)); break;
+    case detail::Arg::f32_: f(detail::load_arg<f32>(arg)); break;
+    case detail::Arg::f64_: f(detail::load_arg<f64>(arg)); break;
+    case detail::Arg::bool_: f(detail::load_arg<u8>(arg) != 0); break;
+    case detail::Arg::char_: f(detail::load_arg<char>(arg)); break;
+    case detail::Arg::pointer_: f(detail::load_arg<void*>(arg)); break;
+    }
+}
+
+[[nodiscard]] static Opt<String<Alloc>> format_binary(String_View fmt, Slice<u8> tags,
+                                                      Slice<u8> args) noexcept {
+    u64 length = fmt.length();
+    u64 offset = 0;
+    for(u8 tag : tags) {
+        u64 size = arg_size(static_cast<detail::Arg>(tag));
+        if(!size || offset + size > args.length()) return {};
+        visit_arg(static_cast<detail::Arg>(tag), args.data() + offset, [&](auto value) {
+            length += Format::Measure<decltype(value)>::measure(value);
+        });
+        offset += size;
+    }
+
+    String<Alloc> output{length};
+    output.set_length(length);
+    u64 idx = 0;
+    u64 arg = 0;
+    offset = 0;
+    for(u64 i = 0; i < fmt.length(); i++) {
+        if(fmt[i] != '%') {
+            idx = output.write(idx, fmt[i]);
+        } else if(i + 1 < fmt.length() && fmt[i + 1] == '%') {
+            idx = output.write(idx, '%');
+            i++;
+        } else {
+            if(arg == tags.length()) return {};
+            detail::Arg tag = static_cast<detail::Arg>(tags[arg++]);
+            visit_arg(tag, args.data() + offset, [&](auto value) {
+                idx = Format::Write<Alloc, decltype(value)>::write(output, idx, value);
+            });
+            offset += arg_size(tag);
+        }
+    }
+    if(arg != tags.length()) return {};
+    output.set_length(idx);
+    return Opt<String<Alloc>>{rpp::move(output)};
+}
+
+template<typename F>
+[[nodiscard]] static bool each_binary(Slice<u8> binary, F&& f) noexcept {
+    const u8* data = binary.data();
+    u64 length = binary.length();
+    if(length < sizeof(BINARY_MAGIC)) return false;
+    if(Libc::memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC))) return false;
+
+    Vec<String_View, Alloc> strings;
+    for(u64 i = sizeof(BINARY_MAGIC); i < length;) {
+        Binary_Entry entry = static_cast<Binary_Entry>(data[i++]);
+        if(entry == Binary_Entry::string) {
+            u32 id = 0, size = 0;
+            if(length - i < sizeof(id) + sizeof(size)) return false;
+            Libc::memcpy(&id, data + i, sizeof(id));
+            Libc::memcpy(&size, data + i + sizeof(id), sizeof(size));
+            i += sizeof(id) + sizeof(size);
+            if(id != strings.length() || length - i < size) return false;
+            strings.push(String_View{data + i, size});
+            i += size;
+        } else if(entry == Binary_Entry::record) {
+            Binary_Record binary_record;
+            if(length - i < sizeof(binary_record)) return false;
+            Libc::memcpy(&binary_record, data + i, sizeof(binary_record));
+            i += sizeof(binary_record);
+
+            u64 count = binary_record.count;
+            if(length - i < count + binary_record.length) return false;
+            if(static_cast<u8>(binary_record.level) > static_cast<u8>(Level::fatal)) return false;
+            if(binary_record.fmt >= strings.length() || binary_record.file >= strings.length() ||
+               binary_record.function >= strings.length()) {
+                return false;
+            }
+
+            Slice<u8> tags{data + i, count};
+            Slice<u8> args{data + i + count, binary_record.length};
+            Opt<String<Alloc>> msg = format_binary(strings[binary_record.fmt], tags, args);
+            if(!msg.ok()) return false;
+            i += count + binary_record.length;
+
+            Async_Record record;
+            record.loc = Location{strings[binary_record.function], strings[binary_record.file],
+                                  binary_record.line};
+            record.thread = binary_record.thread;
+            record.time = binary_record.time;
+            record.indent = binary_record.indent;
+            record.level = binary_record.level;
+            f(record, msg->view());
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+[[nodiscard]] bool print_binary(Slice<u8> binary) noexcept {
+    bool ok = each_binary(binary, [](const Async_Record& record, String_View msg) {
+        print_record(stdout, record, msg);
+    });
+    fflush(stdout);
+    return ok;
+}
+
+[[nodiscard]] bool read_binary(Slice<u8> binary, Function<Callback> f) noexcept {
+    return each_binary(binary, [&](const Async_Record& record, String_View msg) {
+        f(record.level, record.thread, record.time, record.loc, msg);
+    });
+}
+
+void output(Level level, const Location& loc, String_View msg) noexcept {
+
+    // Fatal messages are followed by exit, so they drain everything before them and print here.
+    if(level == Level::fatal) {
+        flush();
+    } else if(async_output(level, loc, msg)) {
+        return;
+    }
+
+    const char* level_str;
+    const char* format_str;
+    level_format(level, level_str, format_str);
 
     Thread::Id thread = Thread::this_id();
     ::time_t timer = ::time(null);
@@ -1,5 +1,6 @@
 
 #include "../base.h"
+#include "../simd.h"
 
 #ifdef RPP_COMPILER_MSVC
 #include <intrin.h>
@@ -140,6 +141,24 @@ namespace rpp::Math {
 #endif
 }
 
+[[nodiscard]] u32 cttz(u32 val) noexcept {
+#ifdef RPP_COMPILER_MSVC
+    return _tzcnt_u32(val);
+#else
+    if(val == 0) return 32;
+    return __builtin_ctz(val);
+#endif
+}
+
+[[nodiscard]] u64 cttz(u64 val) noexcept {
+#ifdef RPP_COMPILER_MSVC
+    return _tzcnt_u64(val);
+#else
+    if(val == 0) return 64;
+    return __builtin_ctzll(val);
+#endif
+}
+
 [[nodiscard]] u32 log2(u32 val) noexcept {
     return 31u - ctlz(val);
 }
@@ -165,4 +184,29 @@ namespace rpp::Math {
     return x == prev ? x : prev << 1ull;
 }
 
+
+using SIMD::F32x4;
+
+[[nodiscard]] f32 fast_sin(f32 v) noexcept {
+    return F32x4::sin(F32x4::set1(v)).data[0];
+}
+[[nodiscard]] f32 fast_cos(f32 v) noexcept {
+    return F32x4::cos(F32x4::set1(v)).data[0];
+}
+[[nodiscard]] f32 fast_exp(f32 v) noexcept {
+    return F32x4::exp(F32x4::set1(v)).data[0];
+}
+[[nodiscard]] f32 fast_log(f32 v) noexcept {
+    return F32x4::log(F32x4::set1(v)).data[0];
+}
+[[nodiscard]] f32 fast_atan2(f32 y, f32 x) noexcept {
+    return F32x4::atan2(F32x4::set1(y), F32x4::set1(x)).data[0];
+}
+[[nodiscard]] f32 fast_rsqrt(f32 v) noexcept {
+    return F32x4::rsqrt(F32x4::set1(v)).data[0];
+}
+[[nodiscard]] f32 fast_pow(f32 x, f32 y) noexcept {
+    return F32x4::pow(F32x4::set1(x), F32x4::set1(y)).data[0];
+}
+
 } // namespace rpp::Math
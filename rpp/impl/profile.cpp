@@ -1,8 +1,37 @@
 
 #include "../base.h"
+#include "../files.h"
+#include "../string_builder.h"
 
 namespace rpp {
 
+constexpr u64 CAPTURE_CHUNK = 4096;
+
+struct Capture_Event {
+    String_View name;
+    u64 id = 0;
+    Profile::Time_Point time = 0;
+    Profile::Capture event = Profile::Capture::begin;
+};
+
+struct Capture_Chunk {
+    Thread::Atomic_Of<Capture_Chunk*> next;
+    Thread::Atomic_Of<u64> length;
+    Capture_Event events[CAPTURE_CHUNK];
+};
+
+// Written only by its thread, which publishes each event by bumping its chunk's length.
+struct Capture_Buffer {
+    Thread::Id thread = 0;
+    Capture_Chunk* head = null;
+    Capture_Chunk* tail = null;
+    Capture_Buffer* next = null;
+};
+
+static Thread::Mutex g_captures_lock;
+static Capture_Buffer* g_captures = null;
+static thread_local Capture_Buffer* g_this_capture = null;
+
 [[nodiscard]] Profile::Time_Point Profile::timestamp() noexcept {
     return Thread::perf_counter();
 }
@@ -16,7 +45,7 @@ namespace rpp {
 }
 
 void Profile::register_thread() noexcept {
-    Thread::Lock lock(threads_lock);
+    Thread::Exclusive_Lock lock(threads_lock);
 
     Thread::Id id = Thread::this_id();
     assert(!threads.contains(id));
@@ -27,7 +56,7 @@ void Profile::register_thread() noexcept {
 }
 
 void Profile::unregister_thread() noexcept {
-    Thread::Lock lock(threads_lock);
+    Thread::Exclusive_Lock lock(threads_lock);
 
     Thread::Id id = Thread::this_id();
     static_cast<void>(threads.try_erase(id));
@@ -36,27 +65,104 @@ void Profile::unregister_thread() noexcept {
 }
 
 [[nodiscard]] Profile::Time_Point Profile::Frame_Profile::begin() noexcept {
-    assert(current_node == 0 && nodes.empty());
-    Timing_Node& node = nodes.push(Timing_Node::make(Log::Location{"Frame"_v, {}, 0}, 0));
-    return node.begin;
+    assert(depth == 0 && events.empty());
+    begin_time = timestamp();
+    return begin_time;
 }
 
 void Profile::Frame_Profile::end() noexcept {
-    assert(current_node == 0);
+    assert(depth == 0);
+    end_time = timestamp();
+}
+
+void Profile::Frame_Profile::reset() noexcept {
+    begin_time = end_time = 0;
+    begin_counters = end_counters = Counters{};
+    depth = 0;
+    counting = built = false;
+    events.clear();
+    nodes.clear();
+    edges.clear();
+    shape.clear();
+    allocations.clear();
+}
+
+void Profile::Frame_Profile::build() noexcept {
+    if(built) return;
+    built = true;
+
+    nodes.push(Timing_Node::make(Log::Location{"Frame"_v, {}, 0}, 0, begin_time, begin_counters));
+
+    u64 current = 0;
+    for(Event& event : events) {
+        if(!event.enter) {
+            Timing_Node& node = nodes[current];
+            node.end = event.time;
+            node.heir_time += node.end - node.begin;
+            node.heir_counters = node.heir_counters + (event.counters - node.begin_counters);
+            current = node.parent;
+            continue;
+        }
+
+        u64 key = rpp::hash(current, event.loc);
+        Opt<Ref<u64>> child = shape.try_get(key);
+        u64 found = 0;
+        // The key mixes in the parent, so a collision can land on the same loc under another one.
+        if(child.ok() && nodes[**child].parent == current && nodes[**child].loc == event.loc) {
+            found = **child;
+        } else if(child.ok()) {
+            // A hash collision falls back to scanning the children.
+            for(u64 idx = nodes[current].first_child; idx; idx = nodes[idx].next_sibling) {
+                if(nodes[idx].loc == event.loc) found = idx;
+            }
+        }
+        if(found) {
+            current = found;
+            nodes[current].begin = event.time;
+            nodes[current].begin_counters = event.counters;
+            nodes[current].calls++;
+            continue;
+        }
+
+        u64 child_idx = nodes.length();
+        Timing_Node& parent = nodes[current];
+        if(parent.last_child) {
+            nodes[parent.last_child].next_sibling = child_idx;
+        } else {
+            parent.first_child = child_idx;
+        }
+        parent.last_child = child_idx;
+        nodes.push(Timing_Node::make(event.loc, current, event.time, event.counters));
+        if(!child.ok()) shape.insert(key, child_idx);
+        current = child_idx;
+    }
+
+    // Every node but the root is one edge, so the edge list never reallocates under the slices.
+    edges.reserve(nodes.length());
+    for(Timing_Node& node : nodes) {
+        u64 first = edges.length();
+        for(u64 idx = node.first_child; idx; idx = nodes[idx].next_sibling) edges.push(idx);
+        node.children = Slice<u64>{edges.data() + first, edges.length() - first};
+    }
+
     Timing_Node& root = nodes.front();
-    root.end = timestamp();
+    root.end = end_time;
     root.heir_time = root.end - root.begin;
+    root.heir_counters = end_counters - begin_counters;
     compute_self_times(0);
 }
 
 void Profile::Frame_Profile::compute_self_times(u64 idx) noexcept {
     Timing_Node& node = nodes[idx];
     u64 child_time = 0;
+    Counters child_counters;
     for(u64 child : node.children) {
         compute_self_times(child);
         child_time = child_time + nodes[child].heir_time;
+        child_counters = child_counters + nodes[child].heir_counters;
     }
     node.self_time = node.heir_time - child_time;
+    node.self_counters = node.heir_counters - child_counters;
 }
 
 f32 Profile::begin_frame() noexcept {
@@ -66,19 +172,31 @@ f32 Profile::begin_frame() noexcept {
     Thread_Profile& prof = this_thread;
     Thread::Lock lock(prof.frames_lock);
 
+    // Reuse the oldest frame and its buffers.
     if(!prof.frames.empty() && prof.frames.full()) {
+        Frame_Profile oldest = rpp::move(prof.frames.front());
         prof.frames.pop();
+        oldest.reset();
+        prof.frames.push(rpp::move(oldest));
+    } else {
+        prof.frames.emplace();
     }
+    Frame_Profile& new_frame = prof.frames.back();
 
-    Frame_Profile& new_frame = prof.frames.emplace();
+    bool counting = counters();
+    if(counting && !prof.counters_tried) {
+        prof.counters_open = open_counters();
+        prof.counters_tried = true;
+    }
+    new_frame.counting = counting && prof.counters_open;
 
     Time_Point t = new_frame.begin();
+    if(new_frame.counting) new_frame.begin_counters = read_counters();
 
     f32 ret = 0.0f;
     if(prof.frames.length() > 1) {
         Frame_Profile& prev_frame = prof.frames.penultimate();
-        assert(!prev_frame.nodes.empty());
-        ret = ms(t - prev_frame.nodes[0].begin) / 1000.0f;
+        ret = ms(t - prev_frame.begin_time) / 1000.0f;
     }
 
     prof.during_frame = true;
@@ -96,106 +214,400 @@ void Profile::end_frame() noexcept {
 
     Frame_Profile& this_frame = prof.frames.back();
     this_frame.end();
+    if(this_frame.counting) this_frame.end_counters = read_counters();
 
     prof.during_frame = false;
+
+    flush_allocs(prof.alloc_log);
 }
 
 void Profile::enter(String_View name) noexcept {
+    enter(Log::Location{rpp::move(name), ""_v, 0});
+}
+
+void Profile::enter(Log::Location loc) noexcept {
+    Scope_Stack& stack = scope_stack;
+    u64 depth = stack.depth.load(Thread::Order::relaxed);
+    if(depth < Sampler::DEPTH) stack.names[depth] = loc.function;
+    stack.depth.store(depth + 1, Thread::Order::release);
+    if(Sampler::running() && !stack.ring.load(Thread::Order::relaxed)) Sampler::attach();
+
+    if(capturing()) capture(Capture::begin, loc.function);
     if constexpr(DO_PROFILE) {
         if(!this_thread.ready()) return;
-        enter(Log::Location{rpp::move(name), ""_v, 0});
+        Frame_Profile& frame = this_thread.frames.back();
+        frame.depth++;
+        Counters counters = frame.counting ? read_counters() : Counters{};
+        frame.events.push(Event{rpp::move(loc), timestamp(), counters, true});
     }
 }
 
-void Profile::enter(Log::Location loc) noexcept {
+void Profile::exit() noexcept {
+    Scope_Stack& stack = scope_stack;
+    u64 depth = stack.depth.load(Thread::Order::relaxed);
+    if(depth) stack.depth.store(depth - 1, Thread::Order::release);
+
+    if(capturing()) capture(Capture::end, {});
     if constexpr(DO_PROFILE) {
         if(!this_thread.ready()) return;
-        Thread::Lock lock(this_thread.frames_lock);
-        this_thread.frames.back().enter(rpp::move(loc));
+        Frame_Profile& frame = this_thread.frames.back();
+        if(!frame.depth) return;
+        frame.depth--;
+        Counters counters = frame.counting ? read_counters() : Counters{};
+        frame.events.push(Event{{}, timestamp(), counters, false});
     }
 }
 
-void Profile::Frame_Profile::enter(Log::Location loc) noexcept {
+[[nodiscard]] bool Profile::Sampler::start(u64 hz) noexcept {
+    assert(hz > 0);
+    if(sampling_.exchange(1)) return false;
+    if(!start_timer(hz)) {
+        sampling_.store(0);
+        return false;
+    }
+    return true;
+}
 
-    bool repeat = false;
-    Timing_Node& node = nodes[current_node];
+void Profile::Sampler::stop() noexcept {
+    if(!sampling_.exchange(0)) return;
+    stop_timer();
+}
+
+[[nodiscard]] u64 Profile::Sampler::dropped() noexcept {
+    return samples_dropped.load(Thread::Order::relaxed);
+}
+
+void Profile::Sampler::attach() noexcept {
+    Sample_Ring* ring = reinterpret_cast<Sample_Ring*>(Mhidden::alloc(sizeof(Sample_Ring)));
+    new(ring) Sample_Ring{};
+    ring->thread = Thread::this_id();
+    ring->stack = &scope_stack;
+    {
+        Thread::Lock lock(rings_lock);
+        ring->next = rings;
+        rings = ring;
+    }
+    scope_stack.ring.store(ring, Thread::Order::release);
+}
 
-    for(u64 child_idx : node.children) {
-        Timing_Node& child = nodes[child_idx];
-        if(child.loc == loc) {
-            current_node = child_idx;
-            repeat = true;
+void Profile::Sampler::detach() noexcept {
+    Sample_Ring* ring = scope_stack.ring.load(Thread::Order::relaxed);
+    if(!ring) return;
+    scope_stack.ring.store(null, Thread::Order::release);
+    Thread::Lock lock(rings_lock);
+    ring->stack = null;
+}
+
+void Profile::Sampler::collect(Function_Ref<void(const Sample&)> f) noexcept {
+    Thread::Lock serialize(collect_lock);
+
+    Sample_Ring* first = null;
+    {
+        Thread::Lock lock(rings_lock);
+        first = rings;
+    }
+    for(Sample_Ring* ring = first; ring; ring = ring->next) {
+        u64 head = ring->head.load(Thread::Order::acquire);
+        for(u64 tail = ring->tail.load(Thread::Order::relaxed); tail != head; tail++) {
+            f(ring->samples[tail % SAMPLE_RING]);
+            ring->tail.store(tail + 1, Thread::Order::release);
         }
     }
 
-    if(!repeat) {
-        u64 child_idx = nodes.length();
-        node.children.push(child_idx);
-        nodes.push(Timing_Node::make(rpp::move(loc), current_node));
-        current_node = child_idx;
-    } else {
-        node.begin = timestamp();
-        node.calls++;
+    // Free the drained rings of exited threads.
+    Thread::Lock lock(rings_lock);
+    Sample_Ring** link = &rings;
+    while(Sample_Ring* ring = *link) {
+        if(!ring->stack && !ring->handle &&
+           ring->head.load(Thread::Order::acquire) == ring->tail.load(Thread::Order::relaxed)) {
+            *link = ring->next;
+            Mhidden::free(ring);
+        } else {
+            link = &ring->next;
+        }
     }
 }
 
-void Profile::exit() noexcept {
-    if constexpr(DO_PROFILE) {
-        if(!this_thread.ready()) return;
-        Thread::Lock lock(this_thread.frames_lock);
-        this_thread.frames.back().exit();
+void Profile::Sampler::free_rings() noexcept {
+    Thread::Lock lock(rings_lock);
+    while(rings) {
+        Sample_Ring* next = rings->next;
+        if(rings->stack) rings->stack->ring.store(null, Thread::Order::relaxed);
+        Mhidden::free(rings);
+        rings = next;
+    }
+}
+
+// Runs in a signal handler, or on the sampler thread while the sampled thread is suspended, so
+// it must not allocate or lock.
+void Profile::record_sample(Scope_Stack& stack, u64 pc) noexcept {
+    Sample_Ring* ring = stack.ring.load(Thread::Order::acquire);
+    if(!ring) {
+        samples_dropped.incr();
+        return;
     }
+    u64 head = ring->head.load(Thread::Order::relaxed);
+    if(head - ring->tail.load(Thread::Order::acquire) == SAMPLE_RING) {
+        samples_dropped.incr();
+        return;
+    }
+    Sampler::Sample& sample = ring->samples[head % SAMPLE_RING];
+    sample.thread = ring->thread;
+    sample.pc = pc;
+    sample.time = timestamp();
+    sample.depth = stack.depth.load(Thread::Order::acquire);
+    for(u64 i = 0; i < Math::min(sample.depth, Sampler::DEPTH); i++) {
+        sample.scopes[i] = stack.names[i];
+    }
+    ring->head.store(head + 1, Thread::Order::release);
 }
 
-void Profile::Frame_Profile::exit() noexcept {
+[[nodiscard]] static Capture_Chunk* make_capture_chunk() noexcept {
+    Capture_Chunk* chunk = reinterpret_cast<Capture_Chunk*>(Mhidden::alloc(sizeof(Capture_Chunk)));
+    new(chunk) Capture_Chunk{};
+    return chunk;
+}
 
-    Frame_Profile& frame = this_thread.frames.back();
-    Timing_Node& node = frame.nodes[frame.current_node];
+void Profile::set_counters(bool enable) noexcept {
+    counters_.store(enable ? 1 : 0);
+}
 
-    node.end = timestamp();
-    node.heir_time += node.end - node.begin;
-    frame.current_node = node.parent;
+void Profile::begin_capture() noexcept {
+    capturing_.store(1);
 }
 
-void Profile::alloc(Alloc a) noexcept {
-    if constexpr(DO_PROFILE) {
+void Profile::end_capture() noexcept {
+    capturing_.store(0);
+}
+
+void Profile::capture(Capture event, String_View name, u64 id) noexcept {
+    Capture_Buffer* buffer = g_this_capture;
+    if(!buffer) {
+        buffer = reinterpret_cast<Capture_Buffer*>(Mhidden::alloc(sizeof(Capture_Buffer)));
+        new(buffer) Capture_Buffer{};
+        buffer->thread = Thread::this_id();
+        buffer->head = buffer->tail = make_capture_chunk();
         {
-            Thread::Lock lock(allocs_lock);
-            Alloc_Profile& prof = allocs.get_or_insert(a.name);
+            Thread::Lock lock(g_captures_lock);
+            buffer->next = g_captures;
+            g_captures = buffer;
+        }
+        g_this_capture = buffer;
+    }
 
-            if(a.size) {
+    Capture_Chunk* chunk = buffer->tail;
+    u64 length = chunk->length.load(Thread::Order::relaxed);
+    if(length == CAPTURE_CHUNK) {
+        Capture_Chunk* next = make_capture_chunk();
+        chunk->next.store(next, Thread::Order::release);
+        buffer->tail = chunk = next;
+        length = 0;
+    }
+    chunk->events[length] = Capture_Event{name, id, timestamp(), event};
+    chunk->length.store(length + 1, Thread::Order::release);
+}
 
-                if(prof.current_set.contains(a.address)) {
-                    warn("Profile: % reallocated %!", a.name, a.address);
-                }
-                prof.current_set.insert(a.address, a.size);
-
-                prof.allocate_size += a.size;
-                prof.allocates++;
-                prof.current_set_size += a.size;
-                prof.high_water = Math::max(prof.high_water, prof.current_set_size);
-
-            } else {
-
-                Opt<Ref<u64>> sz = prof.current_set.try_get(a.address);
-                if(!sz.ok()) {
-                    warn("Profile: % freed % with no entry!", a.name, a.address);
-                } else {
-                    i64 size = **sz;
-                    prof.current_set.erase(a.address);
-                    prof.free_size += size;
-                    prof.frees++;
-                    prof.current_set_size -= size;
-                }
+static void append_json_string(String_Builder<Mhidden>& json, String_View text) noexcept {
+    json.append('"');
+    u64 start = 0;
+    for(u64 i = 0; i < text.length(); i++) {
+        u8 c = text[i];
+        if(c != '"' && c != '\\' && c >= 0x20) continue;
+        json.append(text.sub(start, i));
+        json.append(c < 0x20 ? " "_v : c == '"' ? "\\\""_v : "\\\\"_v);
+        start = i + 1;
+    }
+    json.append(text.sub(start, text.length()));
+    json.append('"');
+}
+
+static void append_capture_event(String_Builder<Mhidden>& json, const Capture_Event& event,
+                                 Thread::Id thread, f64 us) noexcept {
+    auto where = [&] { json.format(",\"ts\":%,\"pid\":0,\"tid\":%}", us, thread); };
+    auto flow = [&] { json.format("{\"name\":\"Hop\",\"cat\":\"coro\",\"id\":%,", event.id); };
+    switch(event.event) {
+    case Profile::Capture::begin:
+    case Profile::Capture::resume: {
+        json.append("{\"ph\":\"B\",\"name\":"_v);
+        append_json_string(json, event.name);
+        where();
+        if(event.event == Profile::Capture::resume) {
+            json.append(",\n"_v);
+            flow();
+            json.append("\"ph\":\"f\",\"bp\":\"e\""_v);
+            where();
+        }
+    } break;
+    case Profile::Capture::end:
+    case Profile::Capture::suspend: {
+        if(event.event == Profile::Capture::suspend) {
+            flow();
+            json.append("\"ph\":\"s\""_v);
+            where();
+            json.append(",\n"_v);
+        }
+        json.append("{\"ph\":\"E\""_v);
+        where();
+    } break;
+    }
+}
+
+[[nodiscard]] bool Profile::write_chrome_trace(String_View path) noexcept {
+    String_Builder<Mhidden> json;
+    json.append("{\"traceEvents\":[\n"_v);
+
+    Thread::Lock lock(g_captures_lock);
+
+    Time_Point base = Limits<Time_Point>::max();
+    for(Capture_Buffer* buffer = g_captures; buffer; buffer = buffer->next) {
+        if(buffer->head->length.load(Thread::Order::acquire)) {
+            base = Math::min(base, buffer->head->events[0].time);
+        }
+    }
+
+    f64 us_per_tick = 1000000.0 / static_cast<f64>(Thread::perf_frequency());
+    bool first = true;
+    for(Capture_Buffer* buffer = g_captures; buffer; buffer = buffer->next) {
+        for(Capture_Chunk* chunk = buffer->head; chunk;
+            chunk = chunk->next.load(Thread::Order::acquire)) {
+            u64 length = chunk->length.load(Thread::Order::acquire);
+            for(u64 i = 0; i < length; i++) {
+                const Capture_Event& event = chunk->events[i];
+                if(!first) json.append(",\n"_v);
+                first = false;
+                f64 us = static_cast<f64>(event.time - base) * us_per_tick;
+                append_capture_event(json, event, buffer->thread, us);
             }
         }
-        {
-            Thread::Lock lock(this_thread.frames_lock);
-            if(this_thread.during_frame) {
-                this_thread.frames.back().allocations.push(rpp::move(a));
+    }
+
+    json.append("\n]}\n"_v);
+    Vec<Slice<u8>, Mhidden> chunks = json.slices();
+    return Files::write(path, Slice<Slice<u8>>{chunks});
+}
+
+void Profile::alloc(Alloc a) noexcept {
+    if constexpr(DO_PROFILE) {
+        a.time = timestamp();
+        u64 depth = Math::min(scope_stack.depth.load(Thread::Order::relaxed), Sampler::DEPTH);
+        if(depth) a.site = scope_stack.names[depth - 1];
+
+        Vec<Alloc, Mhidden>& log = this_thread.alloc_log;
+        if(log.capacity() == 0) log.reserve(ALLOC_LOG_CAPACITY);
+        log.push(a);
+        if(log.full()) flush_allocs(log);
+        if(this_thread.during_frame) {
+            this_thread.frames.back().allocations.push(rpp::move(a));
+        }
+    }
+}
+
+void Profile::flush_allocs(Vec<Alloc, Mhidden>& log) noexcept {
+    if(log.empty()) return;
+    {
+        Thread::Lock lock(allocs_lock);
+        if(!allocs_finalized) {
+            for(const Alloc& a : log) {
+                allocs.get_or_insert(a.name).merge(a);
             }
         }
     }
+    log.clear();
+}
+
+[[nodiscard]] Vec<Profile::Alloc_Snapshot, Mhidden> Profile::snapshot_allocs() noexcept {
+    Vec<Alloc_Snapshot, Mhidden> ret;
+    if constexpr(DO_PROFILE) {
+        flush_allocs(this_thread.alloc_log);
+
+        Thread::Lock lock(allocs_lock);
+        if(allocs_finalized) return ret;
+        for(auto& entry : allocs) {
+            const Alloc_Profile& prof = entry.second;
+            Alloc_Snapshot snapshot;
+            snapshot.name = entry.first;
+            snapshot.allocates = prof.allocates;
+            snapshot.frees = prof.frees;
+            snapshot.allocate_size = prof.allocate_size;
+            snapshot.free_size = prof.free_size;
+            snapshot.high_water = prof.high_water;
+            snapshot.live = prof.allocates - prof.frees;
+            snapshot.live_size = prof.current_set_size;
+            Libc::memcpy(snapshot.sizes, prof.sizes, sizeof(prof.sizes));
+            Libc::memcpy(snapshot.lifetimes, prof.lifetimes, sizeof(prof.lifetimes));
+            for(auto& site : prof.sites) snapshot.sites.push(site.second);
+            ret.push(rpp::move(snapshot));
+        }
+    }
+    return ret;
+}
+
+void Profile::Alloc_Profile::record_lifetime(Time_Point begin, Time_Point end) noexcept {
+    f64 ticks = static_cast<f64>(end > begin ? end - begin : 0);
+    u64 ns = static_cast<u64>(ticks * 1000000000.0 / static_cast<f64>(Thread::perf_frequency()));
+    lifetimes[ns ? Math::log2(ns) : 0]++;
+}
+
+void Profile::Alloc_Profile::merge(const Alloc& a) noexcept {
+    Alloc_Entry& entry = current_set.get_or_insert(a.address);
+
+    if(a.size) {
+        i64 size = static_cast<i64>(a.size);
+        allocate_size += size;
+        allocates++;
+        sizes[Math::log2(a.size)]++;
+
+        Alloc_Site& site = sites.get_or_insert(a.site);
+        site.site = a.site;
+        site.allocates++;
+        site.allocate_size += size;
+        if(entry.count < 0) {
+            // Matches a free merged earlier
+            free_size += size;
+            frees++;
+            record_lifetime(a.time, entry.time);
+        } else {
+            entry.size = size;
+            entry.time = a.time;
+            entry.site = a.site;
+            current_set_size += size;
+            high_water = Math::max(high_water, current_set_size);
+            site.live++;
+            site.live_size += size;
+        }
+        entry.count++;
+    } else {
+        if(entry.count > 0) {
+            free_size += entry.size;
+            frees++;
+            current_set_size -= entry.size;
+            record_lifetime(entry.time, a.time);
+            Alloc_Site& site = sites.get_or_insert(entry.site);
+            site.live--;
+            site.live_size -= entry.size;
+        } else {
+            entry.time = a.time;
+        }
+        entry.count--;
+    }
+
+    if(entry.count == 0) current_set.erase(a.address);
+}
+
+static void free_captures() noexcept {
+    Thread::Lock lock(g_captures_lock);
+    while(g_captures) {
+        Capture_Buffer* next = g_captures->next;
+        Capture_Chunk* chunk = g_captures->head;
+        while(chunk) {
+            Capture_Chunk* after = chunk->next.load(Thread::Order::relaxed);
+            Mhidden::free(chunk);
+            chunk = after;
+        }
+        Mhidden::free(g_captures);
+        g_captures = next;
+    }
+    g_this_capture = null;
 }
 
 void Profile::finalizer(Function<void()> f) noexcept {
@@ -204,15 +616,20 @@ void Profile::finalizer(Function<void()> f) noexcept {
 }
 
 void Profile::finalize() noexcept {
-    // All threads must have exited before we can finalize.
+    // All threads must have exited before we can finalize. Finalizers run in reverse order of
+    // registration, so pools set up at startup outlive the worker threads that use them.
     {
         Thread::Lock lock(finalizers_lock);
-        for(auto& f : finalizers) {
-            f();
+        for(u64 i = finalizers.length(); i > 0; i--) {
+            finalizers[i - 1]();
         }
         finalizers.~Vec();
     }
+    Sampler::stop();
     this_thread.finalize();
+    Sampler::free_rings();
+    end_capture();
+    free_captures();
     {
         Thread::Lock lock(allocs_lock);
         for(auto& prof : allocs) {
@@ -225,11 +642,19 @@ void Profile::finalize() noexcept {
             if(prof.second.current_set_size != 0) {
                 warn("\tUnbalanced size: %", prof.second.current_set_size);
             }
+            for(auto& entry : prof.second.current_set) {
+                if(entry.second.count < 0) {
+                    warn("Profile: % freed % with no entry!", prof.first, entry.first);
+                } else if(entry.second.count > 1) {
+                    warn("Profile: % reallocated %!", prof.first, entry.first);
+                }
+            }
         }
         allocs.~Map();
+        allocs_finalized = true;
     }
     {
-        Thread::Lock lock(threads_lock);
+        Thread::Exclusive_Lock lock(threads_lock);
         threads.~Map();
     }
     i64 net = sys_net_allocs();
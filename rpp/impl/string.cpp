@@ -0,0 +1,160 @@
+
+#include "../base.h"
+#include "../simd.h"
+
+namespace rpp {
+
+using SIMD::U8x16;
+
+// Above this many bytes, find_any tests each byte against a bitset instead of comparing every
+// lane against every byte of the set.
+constexpr u64 FIND_ANY_LANES = 8;
+
+// Bit i is set when byte i of the 32 at p equals c.
+[[nodiscard]] static u32 byte_mask32(const u8* p, U8x16 c) noexcept {
+    u32 low = U8x16::high_mask(U8x16::cmpeq(U8x16::load(p), c));
+    u32 high = U8x16::high_mask(U8x16::cmpeq(U8x16::load(p + 16), c));
+    return low | (high << 16);
+}
+
+[[nodiscard]] static U8x16 lowercase16(U8x16 v) noexcept {
+    // Bytes below 'A' wrap around, so only A-Z land in [0, 25].
+    U8x16 t = U8x16::sub(v, U8x16::set1('A'));
+    U8x16 upper = U8x16::cmpeq(U8x16::min(t, U8x16::set1(25)), t);
+    return U8x16::bit_or(v, U8x16::bit_and(upper, U8x16::set1(0x20)));
+}
+
+[[nodiscard]] Opt<u64> String_View::find(u8 c) const noexcept {
+    U8x16 v = U8x16::set1(c);
+    u64 i = 0;
+    for(; i + 32 <= length_; i += 32) {
+        if(u32 mask = byte_mask32(data_ + i, v)) return Opt<u64>{i + Math::cttz(mask)};
+    }
+    if(i + 16 <= length_) {
+        if(u32 mask = U8x16::cmpeq_mask(U8x16::load(data_ + i), c)) {
+            return Opt<u64>{i + Math::cttz(mask)};
+        }
+        i += 16;
+    }
+    for(; i < length_; i++) {
+        if(data_[i] == c) return Opt<u64>{i};
+    }
+    return {};
+}
+
+// Candidates are positions matching both the first and the last byte of the needle, so only
+// those compare the bytes in between.
+[[nodiscard]] Opt<u64> String_View::find(String_View needle) const noexcept {
+    u64 n = needle.length();
+    if(n == 0) return Opt<u64>{0};
+    if(n > length_) return {};
+    if(n == 1) return find(needle[0]);
+
+    U8x16 first = U8x16::set1(needle[0]);
+    U8x16 last = U8x16::set1(needle[n - 1]);
+    u64 i = 0;
+    for(; i + n - 1 + 16 <= length_; i += 16) {
+        U8x16 a = U8x16::cmpeq(U8x16::load(data_ + i), first);
+        U8x16 b = U8x16::cmpeq(U8x16::load(data_ + i + n - 1), last);
+        for(u32 mask = U8x16::high_mask(U8x16::bit_and(a, b)); mask; mask &= mask - 1) {
+            u64 j = i + Math::cttz(mask);
+            if(Libc::memcmp(data_ + j + 1, needle.data() + 1, n - 2) == 0) return Opt<u64>{j};
+        }
+    }
+    for(; i + n <= length_; i++) {
+        if(Libc::memcmp(data_ + i, needle.data(), n) == 0) return Opt<u64>{i};
+    }
+    return {};
+}
+
+[[nodiscard]] Opt<u64> String_View::find_any(String_View set) const noexcept {
+    u64 table[4] = {};
+    for(u8 c : set) table[c >> 6] |= u64{1} << (c & 63);
+
+    u64 i = 0;
+    if(set.length() <= FIND_ANY_LANES) {
+        U8x16 bytes[FIND_ANY_LANES];
+        for(u64 j = 0; j < set.length(); j++) bytes[j] = U8x16::set1(set[j]);
+        for(; !set.empty() && i + 16 <= length_; i += 16) {
+            U8x16 v = U8x16::load(data_ + i);
+            U8x16 hits = U8x16::cmpeq(v, bytes[0]);
+            for(u64 j = 1; j < set.length(); j++) {
+                hits = U8x16::bit_or(hits, U8x16::cmpeq(v, bytes[j]));
+            }
+            if(u32 mask = U8x16::high_mask(hits)) return Opt<u64>{i + Math::cttz(mask)};
+        }
+    }
+    for(; i < length_; i++) {
+        u8 c = data_[i];
+        if(table[c >> 6] & (u64{1} << (c & 63))) return Opt<u64>{i};
+    }
+    return {};
+}
+
+[[nodiscard]] bool String_View::valid_utf8() const noexcept {
+    u64 i = 0;
+    while(i < length_) {
+        if(i + 32 <= length_) {
+            u32 low = U8x16::high_mask(U8x16::load(data_ + i));
+            u32 high = U8x16::high_mask(U8x16::load(data_ + i + 16));
+            u32 mask = low | (high << 16);
+            if(!mask) {
+                i += 32;
+                continue;
+            }
+            i += Math::cttz(mask);
+        }
+
+        u8 c = data_[i];
+        if(c < 0x80) {
+            i++;
+            continue;
+        }
+        u64 continuation = 0;
+        u32 point = 0;
+        if(c >= 0xc2 && c <= 0xdf) {
+            continuation = 1;
+            point = c & 0x1f;
+        } else if((c & 0xf0) == 0xe0) {
+            continuation = 2;
+            point = c & 0x0f;
+        } else if(c >= 0xf0 && c <= 0xf4) {
+            continuation = 3;
+            point = c & 0x07;
+        } else {
+            return false;
+        }
+        if(continuation >= length_ - i) return false;
+        for(u64 j = 1; j <= continuation; j++) {
+            u8 next = data_[i + j];
+            if((next & 0xc0) != 0x80) return false;
+            point = (point << 6) | (next & 0x3f);
+        }
+        if(continuation == 2 && (point < 0x800 || (point >= 0xd800 && point <= 0xdfff))) {
+            return false;
+        }
+        if(continuation == 3 && (point < 0x10000 || point > 0x10ffff)) return false;
+        i += continuation + 1;
+    }
+    return true;
+}
+
+namespace ascii {
+
+[[nodiscard]] bool equal_ignore_case(String_View l, String_View r) noexcept {
+    if(l.length() != r.length()) return false;
+    u64 i = 0;
+    for(; i + 16 <= l.length(); i += 16) {
+        U8x16 a = lowercase16(U8x16::load(l.data() + i));
+        U8x16 b = lowercase16(U8x16::load(r.data() + i));
+        if(U8x16::high_mask(U8x16::cmpeq(a, b)) != 0xffff) return false;
+    }
+    for(; i < l.length(); i++) {
+        if(to_lowercase(l[i]) != to_lowercase(r[i])) return false;
+    }
+    return true;
+}
+
+} // namespace ascii
+
+} // namespace rpp
@@ -0,0 +1,195 @@
+
+#include "../base.h"
+
+namespace rpp {
+
+using Symbols = Mallocator<"Symbols", false>;
+
+// Entries are stored in segments that double in size, so an id maps to its entry with a log2 and
+// entries never move once published. Id 0 is the empty string and has no entry.
+constexpr u64 FIRST_SEGMENT = 64;
+constexpr u64 SEGMENTS = 27;
+constexpr u64 ARENA_CHUNK = Math::KB(64);
+
+struct Symbol_Entry {
+    String_View text;
+    u64 hash = 0;
+};
+
+// Open-addressed set of ids, probed linearly from the text's hash. Slots only go from empty to
+// an id, so readers need no lock. Growing publishes a new index; old ones are kept, since
+// readers may still be probing them.
+struct Symbol_Index {
+    u64 capacity = 0;
+    Symbol_Index* retired = null;
+
+    [[nodiscard]] Thread::Atomic_Of<u32>* slots() noexcept {
+        return reinterpret_cast<Thread::Atomic_Of<u32>*>(this + 1);
+    }
+};
+
+struct Symbol_Table {
+    Thread::Mutex mut;
+    Thread::Atomic_Of<Symbol_Entry*> segments[SEGMENTS];
+    Thread::Atomic_Of<Symbol_Index*> index;
+    u64 length = 1;
+    u8* arena = null;
+    u64 arena_left = 0;
+    // Each arena chunk starts with a pointer to the previous one.
+    u8* arenas = null;
+    bool finalizer = false;
+};
+
+// Trivially destructible, so symbols stay valid in other static destructors.
+static Symbol_Table& symbol_table() noexcept {
+    static Symbol_Table table;
+    return table;
+}
+
+[[nodiscard]] static Symbol_Entry& symbol_entry(Symbol_Table& table, u64 id) noexcept {
+    u64 i = id - 1 + FIRST_SEGMENT;
+    u64 segment = Math::log2(i) - Math::log2(FIRST_SEGMENT);
+    Symbol_Entry* entries = table.segments[segment].load(Thread::Order::acquire);
+    return entries[i - (FIRST_SEGMENT << segment)];
+}
+
+[[nodiscard]] static Symbol_Index* make_symbol_index(u64 capacity) noexcept {
+    u64 size = sizeof(Symbol_Index) + capacity * sizeof(Thread::Atomic_Of<u32>);
+    Symbol_Index* index = reinterpret_cast<Symbol_Index*>(Symbols::alloc(size));
+    Libc::memset(index, 0, size);
+    index->capacity = capacity;
+    return index;
+}
+
+static void insert_symbol_index(Symbol_Index& index, u64 hash, u32 id) noexcept {
+    u64 mask = index.capacity - 1;
+    for(u64 i = hash & mask;; i = (i + 1) & mask) {
+        if(!index.slots()[i].load(Thread::Order::relaxed)) {
+            index.slots()[i].store(id, Thread::Order::release);
+            return;
+        }
+    }
+}
+
+[[nodiscard]] static u32 find_symbol(Symbol_Table& table, String_View text, u64 hash) noexcept {
+    Symbol_Index* index = table.index.load(Thread::Order::acquire);
+    if(!index) return 0;
+    u64 mask = index->capacity - 1;
+    for(u64 i = hash & mask;; i = (i + 1) & mask) {
+        u32 id = index->slots()[i].load(Thread::Order::acquire);
+        if(!id) return 0;
+        Symbol_Entry& entry = symbol_entry(table, id);
+        if(entry.hash == hash && entry.text == text) return id;
+    }
+}
+
+[[nodiscard]] static String_View copy_symbol_text(Symbol_Table& table, String_View text) noexcept {
+    if(text.length() > table.arena_left) {
+        u64 size = Math::max(ARENA_CHUNK, text.length() + sizeof(u8*));
+        u8* chunk = reinterpret_cast<u8*>(Symbols::alloc(size));
+        Libc::memcpy(chunk, &table.arenas, sizeof(u8*));
+        table.arenas = chunk;
+        table.arena = chunk + sizeof(u8*);
+        table.arena_left = size - sizeof(u8*);
+    }
+    u8* data = table.arena;
+    Libc::memcpy(data, text.data(), text.length());
+    table.arena += text.length();
+    table.arena_left -= text.length();
+    return String_View{data, text.length()};
+}
+
+static void grow_symbol_index(Symbol_Table& table) noexcept {
+    Symbol_Index* old = table.index.load(Thread::Order::relaxed);
+    Symbol_Index* index = make_symbol_index(old ? 2 * old->capacity : 256);
+    for(u64 id = 1; id < table.length; id++) {
+        insert_symbol_index(*index, symbol_entry(table, id).hash, static_cast<u32>(id));
+    }
+    if(old) index->retired = old;
+    table.index.store(index, Thread::Order::release);
+}
+
+// Runs from Profile::finalize, once no other thread can be using symbols.
+static void free_symbol_table() noexcept {
+    Symbol_Table& table = symbol_table();
+    Thread::Lock lock(table.mut);
+
+    for(auto& segment : table.segments) {
+        Symbols::free(segment.load(Thread::Order::relaxed));
+        segment.store(null, Thread::Order::relaxed);
+    }
+    Symbol_Index* index = table.index.load(Thread::Order::relaxed);
+    while(index) {
+        Symbol_Index* retired = index->retired;
+        Symbols::free(index);
+        index = retired;
+    }
+    table.index.store(null, Thread::Order::relaxed);
+    while(table.arenas) {
+        u8* previous = null;
+        Libc::memcpy(&previous, table.arenas, sizeof(u8*));
+        Symbols::free(table.arenas);
+        table.arenas = previous;
+    }
+    table.length = 1;
+    table.arena = null;
+    table.arena_left = 0;
+    table.finalizer = false;
+}
+
+[[nodiscard]] Symbol Symbol::intern(String_View text) noexcept {
+    if(text.empty()) return Symbol{};
+
+    Symbol_Table& table = symbol_table();
+    u64 hash = rpp::hash(text);
+    if(u32 id = find_symbol(table, text, hash)) return Symbol{id};
+
+    Thread::Lock lock(table.mut);
+    if(u32 id = find_symbol(table, text, hash)) return Symbol{id};
+
+    u64 id = table.length;
+    if(id > Limits<u32>::max()) die("Symbol table is full!");
+    if(!table.finalizer) {
+        table.finalizer = true;
+        Profile::finalizer([]() { free_symbol_table(); });
+    }
+
+    u64 i = id - 1 + FIRST_SEGMENT;
+    u64 segment = Math::log2(i) - Math::log2(FIRST_SEGMENT);
+    if(!table.segments[segment].load(Thread::Order::relaxed)) {
+        u64 size = (FIRST_SEGMENT << segment) * sizeof(Symbol_Entry);
+        table.segments[segment].store(reinterpret_cast<Symbol_Entry*>(Symbols::alloc(size)),
+                                      Thread::Order::release);
+    }
+    Symbol_Entry& entry = symbol_entry(table, id);
+    entry.text = copy_symbol_text(table, text);
+    entry.hash = hash;
+    table.length++;
+
+    Symbol_Index* index = table.index.load(Thread::Order::relaxed);
+    if(!index || table.length > (index->capacity / 4) * 3) {
+        grow_symbol_index(table);
+    } else {
+        insert_symbol_index(*index, hash, static_cast<u32>(id));
+    }
+    return Symbol{static_cast<u32>(id)};
+}
+
+[[nodiscard]] Opt<Symbol> Symbol::find(String_View text) noexcept {
+    if(text.empty()) return Opt<Symbol>{Symbol{}};
+    u64 hash = rpp::hash(text);
+    if(u32 id = find_symbol(symbol_table(), text, hash)) return Opt<Symbol>{Symbol{id}};
+    return {};
+}
+
+[[nodiscard]] String_View Symbol::view() const noexcept {
+    if(!id_) return String_View{};
+    return symbol_entry(symbol_table(), id_).text;
+}
+
+[[nodiscard]] u64 Symbol::hash() const noexcept {
+    if(!id_) return rpp::hash(String_View{});
+    return symbol_entry(symbol_table(), id_).hash;
+}
+
+} // namespace rpp
@@ -1,8 +1,12 @@
 
 #include "alloc.cpp"
 #include "base.cpp"
+#include "format.cpp"
+#include "instances.cpp"
 #include "log.cpp"
 #include "math.cpp"
 #include "profile.cpp"
 #include "simd.cpp"
+#include "string.cpp"
+#include "symbol.cpp"
 #include "vmath.cpp"
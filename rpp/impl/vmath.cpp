@@ -416,4 +416,242 @@ Vec3 Mat4::to_euler() const noexcept {
         return Math::degrees(eul1);
 }
 
+using SIMD::F32x8;
+
+namespace detail {
+
+constexpr u64 BATCH = 8;
+
+// Transposes BATCH rows of N floats, stride floats apart, into one vector per component.
+template<u64 N>
+static void load_lanes(const f32* src, u64 stride, F32x8 (&lanes)[N]) noexcept {
+    alignas(32) f32 columns[N][BATCH];
+    for(u64 i = 0; i < BATCH; i++) {
+        for(u64 j = 0; j < N; j++) columns[j][i] = src[i * stride + j];
+    }
+    for(u64 j = 0; j < N; j++) lanes[j] = F32x8::load(columns[j]);
+}
+
+template<u64 N>
+static void store_lanes(f32* dst, u64 stride, const F32x8 (&lanes)[N]) noexcept {
+    alignas(32) f32 columns[N][BATCH];
+    for(u64 j = 0; j < N; j++) F32x8::store(lanes[j], columns[j]);
+    for(u64 i = 0; i < BATCH; i++) {
+        for(u64 j = 0; j < N; j++) dst[i * stride + j] = columns[j][i];
+    }
+}
+
+// Sums are grouped like Mat4::operator*, so batches round the same as single elements.
+template<u64 N, bool translate>
+static void transform_lanes(const Mat4& T, const F32x8 (&in)[N], F32x8 (&out)[N]) noexcept {
+    for(u64 i = 0; i < N; i++) {
+        F32x8 xy = F32x8::add(F32x8::mul(F32x8::set1(T[0][i]), in[0]),
+                              F32x8::mul(F32x8::set1(T[1][i]), in[1]));
+        F32x8 zw = F32x8::mul(F32x8::set1(T[2][i]), in[2]);
+        if constexpr(N == 4) {
+            zw = F32x8::add(zw, F32x8::mul(F32x8::set1(T[3][i]), in[3]));
+        } else if constexpr(translate) {
+            zw = F32x8::add(zw, F32x8::set1(T[3][i]));
+        }
+        out[i] = F32x8::add(xy, zw);
+    }
+}
+
+} // namespace detail
+
+void transform_points(const Mat4& T, Slice<Vec3> in, Vec3* out) noexcept {
+    static_assert(sizeof(Vec3) == 3 * sizeof(f32));
+    u64 i = 0;
+    for(; i + detail::BATCH <= in.length(); i += detail::BATCH) {
+        F32x8 src[3], dst[3];
+        detail::load_lanes(in[i].data, 3, src);
+        detail::transform_lanes<3, true>(T, src, dst);
+        detail::store_lanes(out[i].data, 3, dst);
+    }
+    for(; i < in.length(); i++) out[i] = T * in[i];
+}
+
+void transform_points(const Mat4& T, Slice<Vec4> in, Vec4* out) noexcept {
+    static_assert(sizeof(Vec4) == 4 * sizeof(f32));
+    u64 i = 0;
+    for(; i + detail::BATCH <= in.length(); i += detail::BATCH) {
+        F32x8 src[4], dst[4];
+        detail::load_lanes(in[i].data, 4, src);
+        detail::transform_lanes<4, true>(T, src, dst);
+        detail::store_lanes(out[i].data, 4, dst);
+    }
+    for(; i < in.length(); i++) out[i] = T * in[i];
+}
+
+void transform_vectors(const Mat4& T, Slice<Vec3> in, Vec3* out) noexcept {
+    u64 i = 0;
+    for(; i + detail::BATCH <= in.length(); i += detail::BATCH) {
+        F32x8 src[3], dst[3];
+        detail::load_lanes(in[i].data, 3, src);
+        detail::transform_lanes<3, false>(T, src, dst);
+        detail::store_lanes(out[i].data, 3, dst);
+    }
+    for(; i < in.length(); i++) out[i] = T.rotate(in[i]);
+}
+
+// Same as BBox::transform: each output extent starts from the translation and takes the smaller
+// and larger of each column's products with the input extents.
+void transform_bboxes(const Mat4& T, Slice<BBox> in, BBox* out) noexcept {
+    static_assert(sizeof(BBox) == 6 * sizeof(f32));
+    u64 i = 0;
+    for(; i + detail::BATCH <= in.length(); i += detail::BATCH) {
+        F32x8 src[6], dst[6];
+        detail::load_lanes(in[i].min.data, 6, src);
+        for(u64 c = 0; c < 3; c++) {
+            F32x8 min = F32x8::set1(T[3][c]);
+            F32x8 max = min;
+            for(u64 r = 0; r < 3; r++) {
+                F32x8 t = F32x8::set1(T[r][c]);
+                F32x8 a = F32x8::mul(t, src[r]);
+                F32x8 b = F32x8::mul(t, src[3 + r]);
+                SIMD::I32x8 lt = F32x8::cmplt(a, b);
+                min = F32x8::add(min, F32x8::select(lt, a, b));
+                max = F32x8::add(max, F32x8::select(lt, b, a));
+            }
+            dst[c] = min;
+            dst[3 + c] = max;
+        }
+        detail::store_lanes(out[i].min.data, 6, dst);
+    }
+    for(; i < in.length(); i++) {
+        BBox box = in[i];
+        box.transform(T);
+        out[i] = box;
+    }
+}
+
+namespace detail {
+
+// Above this cosine the arc is too short for sin(theta) to divide by accurately.
+constexpr f32 SLERP_LINEAR = 0.9995f;
+
+[[nodiscard]] static F32x8 dot_lanes(const F32x8 (&a)[4], const F32x8 (&b)[4]) noexcept {
+    F32x8 xy = F32x8::add(F32x8::mul(a[0], b[0]), F32x8::mul(a[1], b[1]));
+    return F32x8::add(F32x8::add(xy, F32x8::mul(a[2], b[2])), F32x8::mul(a[3], b[3]));
+}
+
+} // namespace detail
+
+Quat slerp(Quat from, Quat to, f32 t) noexcept {
+    f32 d = from.x * to.x + from.y * to.y + from.z * to.z + from.w * to.w;
+    f32 sign = d < 0.0f ? -1.0f : 1.0f;
+    to = to * sign;
+    d *= sign;
+    if(d > detail::SLERP_LINEAR) return (from * (1.0f - t) + to * t).unit();
+
+    f32 s = Math::sqrt(1.0f - d * d);
+    f32 theta = Math::fast_atan2(s, d);
+    f32 a = Math::fast_sin((1.0f - t) * theta) / s;
+    f32 b = Math::fast_sin(t * theta) / s;
+    return from * a + to * b;
+}
+
+// Evaluates both the slerp and the lerp weights in every lane and selects per lane, so the
+// order of operations matches slerp(Quat, Quat, f32).
+void slerp(Slice<Quat> from, Slice<Quat> to, f32 t, Quat* out) noexcept {
+    static_assert(sizeof(Quat) == 4 * sizeof(f32));
+    assert(from.length() == to.length());
+    F32x8 zero = F32x8::zero();
+    F32x8 one = F32x8::set1(1.0f);
+    F32x8 t_from = F32x8::set1(1.0f - t);
+    F32x8 t_to = F32x8::set1(t);
+    u64 i = 0;
+    for(; i + detail::BATCH <= from.length(); i += detail::BATCH) {
+        F32x8 a[4], b[4], lerp[4], dst[4];
+        detail::load_lanes(from[i].data, 4, a);
+        detail::load_lanes(to[i].data, 4, b);
+
+        F32x8 d = detail::dot_lanes(a, b);
+        F32x8 sign = F32x8::select(F32x8::cmplt(d, zero), F32x8::set1(-1.0f), one);
+        for(u64 j = 0; j < 4; j++) b[j] = F32x8::mul(sign, b[j]);
+        d = F32x8::mul(d, sign);
+
+        for(u64 j = 0; j < 4; j++) {
+            lerp[j] = F32x8::add(F32x8::mul(t_from, a[j]), F32x8::mul(t_to, b[j]));
+        }
+        F32x8 norm = F32x8::sqrt(detail::dot_lanes(lerp, lerp));
+
+        F32x8 s = F32x8::sqrt(F32x8::sub(one, F32x8::mul(d, d)));
+        F32x8 theta = F32x8::atan2(s, d);
+        F32x8 w_from = F32x8::div(F32x8::sin(F32x8::mul(t_from, theta)), s);
+        F32x8 w_to = F32x8::div(F32x8::sin(F32x8::mul(t_to, theta)), s);
+
+        SIMD::I32x8 linear = F32x8::cmplt(F32x8::set1(detail::SLERP_LINEAR), d);
+        for(u64 j = 0; j < 4; j++) {
+            F32x8 arc = F32x8::add(F32x8::mul(w_from, a[j]), F32x8::mul(w_to, b[j]));
+            dst[j] = F32x8::select(linear, F32x8::div(lerp[j], norm), arc);
+        }
+        detail::store_lanes(out[i].data, 4, dst);
+    }
+    for(; i < from.length(); i++) out[i] = slerp(from[i], to[i], t);
+}
+
+void normalize(Slice<Quat> in, Quat* out) noexcept {
+    u64 i = 0;
+    for(; i + detail::BATCH <= in.length(); i += detail::BATCH) {
+        F32x8 src[4], dst[4];
+        detail::load_lanes(in[i].data, 4, src);
+        F32x8 norm = F32x8::sqrt(detail::dot_lanes(src, src));
+        for(u64 j = 0; j < 4; j++) dst[j] = F32x8::div(src[j], norm);
+        detail::store_lanes(out[i].data, 4, dst);
+    }
+    for(; i < in.length(); i++) out[i] = in[i].unit();
+}
+
+Opt<f32> BBox::hit(const Ray& ray, f32 t_min, f32 t_max) const noexcept {
+    // Inverted extents would swap into a box covering everything.
+    if(empty()) return {};
+    F32x4 t0 = F32x4::mul(F32x4::sub(Vec3A{min}.pack, ray.origin.pack), ray.inv_direction.pack);
+    F32x4 t1 = F32x4::mul(F32x4::sub(Vec3A{max}.pack, ray.origin.pack), ray.inv_direction.pack);
+    Vec3A near{F32x4::min(t0, t1)};
+    Vec3A far{F32x4::max(t0, t1)};
+    f32 enter = Math::max(Math::max(t_min, near.x), Math::max(near.y, near.z));
+    f32 exit = Math::min(Math::min(t_max, far.x), Math::min(far.y, far.z));
+    if(enter > exit) return {};
+    return Opt<f32>{enter};
+}
+
+BBox8::BBox8() noexcept {
+    for(u64 a = 0; a < 3; a++) {
+        min[a] = F32x8::set1(Limits<f32>::max());
+        max[a] = F32x8::set1(Limits<f32>::min());
+    }
+}
+
+void BBox8::set(u64 i, const BBox& box) noexcept {
+    assert(i < 8);
+    for(u64 a = 0; a < 3; a++) {
+        min[a].data[i] = box.min[a];
+        max[a].data[i] = box.max[a];
+    }
+}
+
+BBox BBox8::get(u64 i) const noexcept {
+    assert(i < 8);
+    return BBox{Vec3{min[0].data[i], min[1].data[i], min[2].data[i]},
+                Vec3{max[0].data[i], max[1].data[i], max[2].data[i]}};
+}
+
+u32 BBox8::hit(const Ray& ray, f32 t_min, f32 t_max, F32x8* t) const noexcept {
+    F32x8 enter = F32x8::set1(t_min);
+    F32x8 exit = F32x8::set1(t_max);
+    SIMD::I32x8 valid = SIMD::I32x8::set1(-1);
+    for(u64 a = 0; a < 3; a++) {
+        valid = SIMD::I32x8::bit_and(valid, F32x8::cmple(min[a], max[a]));
+        F32x8 origin = F32x8::set1(ray.origin[a]);
+        F32x8 inv = F32x8::set1(ray.inv_direction[a]);
+        F32x8 t0 = F32x8::mul(F32x8::sub(min[a], origin), inv);
+        F32x8 t1 = F32x8::mul(F32x8::sub(max[a], origin), inv);
+        enter = F32x8::max(enter, F32x8::min(t0, t1));
+        exit = F32x8::min(exit, F32x8::max(t0, t1));
+    }
+    if(t) *t = enter;
+    return SIMD::I32x8::movemask(SIMD::I32x8::bit_and(valid, F32x8::cmple(enter, exit)));
+}
+
 } // namespace rpp::Math
@@ -0,0 +1,41 @@
+
+#pragma once
+
+#include "base.h"
+
+namespace rpp {
+
+// Specializations nearly every translation unit uses. With RPP_EXTERN_TEMPLATES, base.h declares
+// them extern here and impl/instances.cpp instantiates them once for the whole program.
+#define RPP_INSTANCES(EXTERN)                                                                      \
+    EXTERN template struct Vec<u8, Mdefault>;                                                      \
+    EXTERN template struct Vec<u8, Log::Alloc>;                                                    \
+    EXTERN template struct Vec<u64, Mdefault>;                                                     \
+    EXTERN template struct Vec<String_View, Mdefault>;                                             \
+    EXTERN template struct String<Mdefault>;                                                       \
+    EXTERN template struct String<Log::Alloc>;                                                     \
+    EXTERN template struct Map<String_View, u64, Mdefault>;                                        \
+    EXTERN template struct Map<String_View, String_View, Mdefault>;                                \
+    RPP_FORMAT_INSTANCES(EXTERN, Mdefault)                                                         \
+    RPP_FORMAT_INSTANCES(EXTERN, Log::Alloc)
+
+#define RPP_FORMAT_INSTANCES(EXTERN, A)                                                            \
+    RPP_FORMAT_INT(EXTERN, A, i32)                                                                 \
+    RPP_FORMAT_INT(EXTERN, A, i64)                                                                 \
+    RPP_FORMAT_INT(EXTERN, A, u32)                                                                 \
+    RPP_FORMAT_INT(EXTERN, A, u64)                                                                 \
+    RPP_FORMAT_FLOAT(EXTERN, A, f32)                                                               \
+    RPP_FORMAT_FLOAT(EXTERN, A, f64)                                                               \
+    EXTERN template u64 Format::detail::write_hex<A>(String<A>&, u64, u64) noexcept;
+
+#define RPP_FORMAT_INT(EXTERN, A, I)                                                               \
+    EXTERN template u64 Format::detail::write_int<A, I>(String<A>&, u64, I) noexcept;              \
+    EXTERN template struct Format::Write<A, I>;
+
+#define RPP_FORMAT_FLOAT(EXTERN, A, F)                                                             \
+    EXTERN template u64 Format::detail::write_float<A, F>(String<A>&, u64, F) noexcept;            \
+    EXTERN template struct Format::Write<A, F>;
+
+RPP_INSTANCES(extern)
+
+} // namespace rpp
@@ -13,14 +13,46 @@
 
 #define RPP_HERE ::rpp::Log::Location::make(__FILE__, __LINE__, RPP_PRETTY_FUNCTION)
 
-#define info(fmt, ...)                                                                             \
-    (void)(::rpp::Log::log(::rpp::Log::Level::info, RPP_HERE, fmt##_v, ##__VA_ARGS__), 0)
+// Calls below this level compile to nothing and don't evaluate their arguments: 0 keeps trace
+// and up, 1 debug, 2 info, 3 warn. Fatal calls are always kept.
+#ifndef RPP_LOG_LEVEL
+#ifdef RPP_DEBUG_BUILD
+#define RPP_LOG_LEVEL 1
+#else
+#define RPP_LOG_LEVEL 2
+#endif
+#endif
+
+#define RPP_LOG(LEVEL, fmt, ...)                                                                   \
+    (void)(::rpp::Log::enabled(::rpp::Log::Level::LEVEL, RPP_LOCATION_HASH) &&                     \
+           (::rpp::Log::log(::rpp::Log::Level::LEVEL, RPP_HERE, fmt, ##__VA_ARGS__), true))
+
+#if RPP_LOG_LEVEL <= 0
+#define trace(fmt, ...) RPP_LOG(trace, fmt, ##__VA_ARGS__)
+#else
+#define trace(fmt, ...) (void)0
+#endif
+
+#if RPP_LOG_LEVEL <= 1
+#define debug(fmt, ...) RPP_LOG(debug, fmt, ##__VA_ARGS__)
+#else
+#define debug(fmt, ...) (void)0
+#endif
+
+#if RPP_LOG_LEVEL <= 2
+#define info(fmt, ...) RPP_LOG(info, fmt, ##__VA_ARGS__)
+#else
+#define info(fmt, ...) (void)0
+#endif
 
-#define warn(fmt, ...)                                                                             \
-    (void)(::rpp::Log::log(::rpp::Log::Level::warn, RPP_HERE, fmt##_v, ##__VA_ARGS__), 0)
+#if RPP_LOG_LEVEL <= 3
+#define warn(fmt, ...) RPP_LOG(warn, fmt, ##__VA_ARGS__)
+#else
+#define warn(fmt, ...) (void)0
+#endif
 
 #define die(fmt, ...)                                                                              \
-    (void)(::rpp::Log::log(::rpp::Log::Level::fatal, RPP_HERE, fmt##_v, ##__VA_ARGS__),            \
+    (void)(::rpp::Log::log(::rpp::Log::Level::fatal, RPP_HERE, fmt, ##__VA_ARGS__),                \
            RPP_DEBUG_BREAK, ::rpp::Libc::exit(1), 0)
 
 #undef assert
@@ -42,11 +74,19 @@
 #define Log_Indent RPP_INDENT1(__COUNTER__)
 
 namespace rpp {
+
+template<typename... Ts>
+struct Format_String;
+template<typename T>
+struct Slice;
+
 namespace Log {
 
 constexpr u64 INDENT_SIZE = 4;
 
 enum class Level : u8 {
+    trace,
+    debug,
     info,
     warn,
     fatal,
@@ -87,14 +127,183 @@ using Time = u64;
 void debug_break() noexcept;
 void output(Level level, const Location& loc, String_View msg) noexcept;
 
+namespace detail {
+
+struct Filter {
+    static inline Thread::Atomic_Of<u8> min_level;
+    // Messages per second allowed from each call site, or zero for no limit.
+    static inline Thread::Atomic_Of<u64> rate_limit;
+};
+
+// Counts a message against its call site's budget for the current second. Sites are hashed into
+// a fixed table, so colliding sites share a budget.
+[[nodiscard]] bool rate_limited(u64 site, u64 limit) noexcept;
+
+} // namespace detail
+
+// Checked by the logging macros before the arguments are evaluated.
+[[nodiscard]] RPP_FORCE_INLINE bool enabled(Level level, u64 site) noexcept {
+    if(static_cast<u8>(level) < detail::Filter::min_level.load(Thread::Order::relaxed)) {
+        return false;
+    }
+    u64 limit = detail::Filter::rate_limit.load(Thread::Order::relaxed);
+    return !limit || !detail::rate_limited(site, limit);
+}
+
+inline void set_min_level(Level level) noexcept {
+    detail::Filter::min_level.store(static_cast<u8>(level), Thread::Order::relaxed);
+}
+[[nodiscard]] inline Level min_level() noexcept {
+    return static_cast<Level>(detail::Filter::min_level.load(Thread::Order::relaxed));
+}
+inline void set_rate_limit(u64 per_second) noexcept {
+    detail::Filter::rate_limit.store(per_second, Thread::Order::relaxed);
+}
+
+enum class Flush : u8 {
+    batch,
+    interval,
+};
+
+using Alloc = Mallocator<"Log", false>;
+
+struct Async_Config {
+    // Per-thread ring capacity in bytes, rounded up to a power of two. Messages that don't fit
+    // are dropped and counted.
+    u64 ring_size = Math::KB(64);
+    // How long the drain thread sleeps when every ring is empty.
+    u64 interval_ms = 1;
+    // Flush the outputs after every drained batch, or at most once per interval.
+    Flush flush = Flush::batch;
+    // Log calls whose arguments are all scalars copy the raw arguments instead of formatting,
+    // leaving the formatting to the drain thread.
+    bool deferred = true;
+    // If set, deferred records are appended unformatted to this binary log instead, and skip
+    // the text outputs and subscribers. Read it back with print_binary or read_binary.
+    String_View binary;
+};
+
+// Moves output off the logging threads: each thread copies its formatted messages into its own
+// lock-free ring, and a background thread drains the rings in batches, running subscribers on
+// that thread. Fatal messages still print synchronously, after draining the rings.
+void start_async(Async_Config config = {}) noexcept;
+void stop_async() noexcept;
+// Writes out everything logged so far.
+void flush() noexcept;
+[[nodiscard]] u64 dropped() noexcept;
+
+// Prints the records of a binary log in the text format. Enums print as their values. Returns
+// false if the log is malformed.
+[[nodiscard]] bool print_binary(Slice<u8> binary) noexcept;
+
+namespace detail {
+
+// Argument types of deferred records, as tagged in binary logs.
+enum class Arg : u8 {
+    i8_,
+    u8_,
+    i16_,
+    u16_,
+    i32_,
+    u32_,
+    i64_,
+    u64_,
+    f32_,
+    f64_,
+    bool_,
+    char_,
+    pointer_,
+};
+
+template<typename T>
+concept Deferrable =
+    Int<T> || Float<T> || Same<T, bool> || Same<T, char> || Pointer<T> || Reflect::Enum<T>;
+
+using Decode = String<Alloc> (*)(String_View fmt, const u8* args) noexcept;
+
+struct Deferred {
+    Decode decode = null;
+    const Arg* args = null;
+    u64 count = 0;
+};
+
+template<Deferrable T>
+[[nodiscard]] consteval Arg arg_tag() noexcept {
+    if constexpr(Reflect::Enum<T>) return arg_tag<Underlying<T>>();
+    else if constexpr(Pointer<T>) return Arg::pointer_;
+    else if constexpr(Same<T, bool>) return Arg::bool_;
+    else if constexpr(Same<T, char>) return Arg::char_;
+    else if constexpr(Same<T, i8>) return Arg::i8_;
+    else if constexpr(Same<T, u8>) return Arg::u8_;
+    else if constexpr(Same<T, i16>) return Arg::i16_;
+    else if constexpr(Same<T, u16>) return Arg::u16_;
+    else if constexpr(Same<T, i32>) return Arg::i32_;
+    else if constexpr(Same<T, u32>) return Arg::u32_;
+    else if constexpr(Same<T, i64>) return Arg::i64_;
+    else if constexpr(Same<T, u64>) return Arg::u64_;
+    else if constexpr(Same<T, f32>) return Arg::f32_;
+    else return Arg::f64_;
+}
+
+template<typename... Ts>
+[[nodiscard]] consteval u64 arg_offset(u64 i) noexcept {
+    u64 sizes[] = {sizeof(Ts)..., 0};
+    u64 offset = 0;
+    for(u64 j = 0; j < i; j++) offset += sizes[j];
+    return offset;
+}
+
+template<typename T>
+[[nodiscard]] T load_arg(const u8* args) noexcept {
+    T value;
+    Libc::memcpy(&value, args, sizeof(T));
+    return value;
+}
+
+template<typename... Ts, u64... Is>
+[[nodiscard]] String<Alloc> decode_args(String_View fmt, const u8* args,
+                                        Index_Sequence<Is...>) noexcept {
+    return format<Alloc>(fmt, load_arg<Choose<Is, Ts...>>(args + arg_offset<Ts...>(Is))...);
+}
+
+template<typename... Ts>
+[[nodiscard]] String<Alloc> decode(String_View fmt, const u8* args) noexcept {
+    return decode_args<Ts...>(fmt, args, Index_Sequence_For<Ts...>{});
+}
+
+template<typename... Ts>
+constexpr Arg DEFERRED_ARGS[sizeof...(Ts) + 1] = {arg_tag<Ts>()...};
+
+template<typename... Ts>
+constexpr Deferred DEFERRED{&decode<Ts...>, DEFERRED_ARGS<Ts...>, sizeof...(Ts)};
+
+// Queues a deferred record if the async backend is running in deferred mode.
+[[nodiscard]] bool defer(Level level, const Location& loc, String_View fmt,
+                         const Deferred& deferred, const u8* args, u64 length) noexcept;
+
+} // namespace detail
+
 template<typename... Ts>
 void log(Level level, const Location& loc, String_View fmt, const Ts&... args) noexcept {
     Region(R) output(level, loc, format<Mregion<R>>(fmt, args...).view());
 }
 
+template<typename... Ts>
+void log(Level level, const Location& loc, Format_String<Identity<Ts>...> fmt,
+         const Ts&... args) noexcept {
+    if constexpr((detail::Deferrable<Ts> && ...)) {
+        u8 bytes[detail::arg_offset<Ts...>(sizeof...(Ts)) + 1];
+        u64 length = 0;
+        ((Libc::memcpy(bytes + length, &args, sizeof(Ts)), length += sizeof(Ts)), ...);
+        if(detail::defer(level, loc, fmt.view(), detail::DEFERRED<Ts...>, bytes, length)) return;
+    }
+    Region(R) output(level, loc, format<Mregion<R>>(fmt, args...).view());
+}
+
 } // namespace Log
 
-RPP_NAMED_ENUM(Log::Level, "Level", info, RPP_CASE(info), RPP_CASE(warn), RPP_CASE(fatal));
+RPP_NAMED_ENUM(Log::Level, "Level", info, RPP_CASE(trace), RPP_CASE(debug), RPP_CASE(info),
+               RPP_CASE(warn), RPP_CASE(fatal));
 RPP_NAMED_RECORD(Log::Location, "Location", RPP_FIELD(function), RPP_FIELD(file), RPP_FIELD(line));
 
 namespace Hash {
@@ -18,5 +18,14 @@ template<Invocable<Level, Thread::Id, Time, Location, String_View> F>
     return subscribe(Function<Callback>{rpp::forward<F>(f)});
 }
 
+// Calls f with each record of a binary log, in the order they were written. Returns false if
+// the log is malformed.
+[[nodiscard]] bool read_binary(Slice<u8> binary, Function<Callback> f) noexcept;
+
+template<Invocable<Level, Thread::Id, Time, Location, String_View> F>
+[[nodiscard]] bool read_binary(Slice<u8> binary, F&& f) noexcept {
+    return read_binary(binary, Function<Callback>{rpp::forward<F>(f)});
+}
+
 } // namespace Log
 } // namespace rpp
@@ -76,7 +76,7 @@ struct Map {
         shift_ = Math::ctlz(capacity_) + 1;
         usable_ = (capacity_ / 4) * 3;
         length_ = 0;
-        data_ = reinterpret_cast<Slot*>(A::alloc(capacity_ * sizeof(Slot)));
+        data_ = reinterpret_cast<Slot*>(alloc_aligned<A, alignof(Slot)>(capacity_ * sizeof(Slot)));
         Libc::memset(data_, 0, capacity_ * sizeof(Slot));
     }
 
@@ -95,11 +95,20 @@ struct Map {
         length_ = src.length_;
         usable_ = src.usable_;
         shift_ = src.shift_;
+        old_data_ = src.old_data_;
+        old_capacity_ = src.old_capacity_;
+        old_shift_ = src.old_shift_;
+        migrated_ = src.migrated_;
+        incremental_ = src.incremental_;
         src.data_ = null;
         src.capacity_ = 0;
         src.length_ = 0;
         src.usable_ = 0;
         src.shift_ = 0;
+        src.old_data_ = null;
+        src.old_capacity_ = 0;
+        src.old_shift_ = 0;
+        src.migrated_ = 0;
     }
     Map& operator=(Map&& src) noexcept {
         this->~Map();
@@ -108,11 +117,20 @@ struct Map {
         length_ = src.length_;
         usable_ = src.usable_;
         shift_ = src.shift_;
+        old_data_ = src.old_data_;
+        old_capacity_ = src.old_capacity_;
+        old_shift_ = src.old_shift_;
+        migrated_ = src.migrated_;
+        incremental_ = src.incremental_;
         src.data_ = null;
         src.capacity_ = 0;
         src.length_ = 0;
         src.usable_ = 0;
         src.shift_ = 0;
+        src.old_data_ = null;
+        src.old_capacity_ = 0;
+        src.old_shift_ = 0;
+        src.migrated_ = 0;
         return *this;
     }
 
@@ -123,6 +141,7 @@ struct Map {
             }
         }
         A::free(data_);
+        drop_old();
         data_ = null;
         capacity_ = 0;
         length_ = 0;
@@ -143,17 +162,32 @@ struct Map {
                 if(data_[i].hash != Slot::EMPTY) new(&ret.data_[i]) Slot{data_[i].clone()};
             }
         }
+        for(u64 i = migrated_; i < old_capacity_; i++) {
+            if(old_data_[i].hash != Slot::EMPTY)
+                static_cast<void>(ret.insert_slot(old_data_[i].clone()));
+        }
         return ret;
     }
 
     void reserve(u64 new_capacity) noexcept {
         if(new_capacity <= capacity_) return;
 
+        finish_migration();
+
         Slot* old_data = data_;
         u64 old_capacity = capacity_;
 
+        if(incremental_ && length_ > 0) {
+            old_data_ = data_;
+            old_capacity_ = capacity_;
+            old_shift_ = shift_;
+            migrated_ = 0;
+            old_data = null;
+            old_capacity = 0;
+        }
+
         capacity_ = new_capacity;
-        data_ = reinterpret_cast<Slot*>(A::alloc(capacity_ * sizeof(Slot)));
+        data_ = reinterpret_cast<Slot*>(alloc_aligned<A, alignof(Slot)>(capacity_ * sizeof(Slot)));
         Libc::memset(data_, 0, capacity_ * sizeof(Slot));
         usable_ = (capacity_ / 4) * 3;
         shift_ = Math::ctlz(capacity_) + 1;
@@ -178,9 +212,25 @@ struct Map {
         } else {
             Libc::memset(data_, Slot::EMPTY, capacity_ * sizeof(Slot));
         }
+        drop_old();
         length_ = 0;
     }
 
+    // In incremental mode, growing keeps the old table alongside the new one, and each insert,
+    // erase, or mutable lookup migrates a bounded number of old slots until it is drained.
+    void set_incremental(bool incremental) noexcept {
+        incremental_ = incremental;
+        if(!incremental_) finish_migration();
+    }
+
+    [[nodiscard]] bool migrating() const noexcept {
+        return old_data_ != null;
+    }
+
+    void finish_migration() noexcept {
+        while(old_data_) migrate();
+    }
+
     [[nodiscard]] bool empty() const noexcept {
         return length_ == 0;
     }
@@ -210,27 +260,75 @@ struct Map {
     }
 
     V& insert(K&& key, V&& value) noexcept {
+        if(old_data_) migrate_for(key);
         if(full()) grow();
         Slot slot{rpp::move(key), rpp::move(value)};
-        Slot& placed = insert_slot(rpp::move(slot));
-        length_ += 1;
+        Slot& placed = insert_counted(rpp::move(slot));
         return placed.data->second;
     }
 
     template<typename... Args>
         requires Constructable<V, Args...>
     V& emplace(K&& key, Args&&... args) noexcept {
+        if(old_data_) migrate_for(key);
         if(full()) grow();
         Slot slot{rpp::move(key), V{rpp::forward<Args>(args)...}};
-        Slot& placed = insert_slot(rpp::move(slot));
-        length_ += 1;
+        Slot& placed = insert_counted(rpp::move(slot));
         return placed.data->second;
     }
 
+    // Inserts every pair, growing the table at most once. A pending migration is finished first.
+    void insert_batch(Slice<Pair<K, V>> pairs) noexcept
+        requires Copy_Constructable<K> && Copy_Constructable<V>
+    {
+        reserve_for(pairs.length());
+        for(const Pair<K, V>& pair : pairs) {
+            static_cast<void>(insert_counted(Slot{K{pair.first}, V{pair.second}}));
+        }
+    }
+    template<Allocator B>
+    void insert_batch(Vec<Pair<K, V>, B>&& pairs) noexcept {
+        reserve_for(pairs.length());
+        for(Pair<K, V>& pair : pairs) {
+            static_cast<void>(
+                insert_counted(Slot{rpp::move(pair.first), rpp::move(pair.second)}));
+        }
+        pairs.clear();
+    }
+
+    // Pushes the result of try_get for each key onto out. Lookups are pipelined, so the cache
+    // misses of nearby keys overlap instead of being taken one after another.
+    template<Allocator B>
+    void get_batch(Slice<K> keys, Vec<Opt<Ref<V>>, B>& out) noexcept {
+        out.reserve(out.length() + keys.length());
+        if(empty()) {
+            for(u64 i = 0; i < keys.length(); i++) out.push(Opt<Ref<V>>{});
+            return;
+        }
+        if(old_data_) migrate();
+        get_batch_(keys, [&](u64, Opt<u64> idx) {
+            if(idx.ok()) out.push(Opt{Ref{slot_at(*idx).data->second}});
+            else out.push(Opt<Ref<V>>{});
+        });
+    }
+    template<Allocator B>
+    void get_batch(Slice<K> keys, Vec<Opt<Ref<const V>>, B>& out) const noexcept {
+        out.reserve(out.length() + keys.length());
+        if(empty()) {
+            for(u64 i = 0; i < keys.length(); i++) out.push(Opt<Ref<const V>>{});
+            return;
+        }
+        get_batch_(keys, [&](u64, Opt<u64> idx) {
+            if(idx.ok()) out.push(Opt{Ref<const V>{slot_at(*idx).data->second}});
+            else out.push(Opt<Ref<const V>>{});
+        });
+    }
+
     [[nodiscard]] Opt<Ref<V>> try_get(const K& key) noexcept {
         if(empty()) return {};
+        if(old_data_) migrate();
         if(auto idx = try_get_<K>(key); idx.ok()) {
-            return Opt{Ref{data_[*idx].data->second}};
+            return Opt{Ref{slot_at(*idx).data->second}};
         }
         return {};
     }
@@ -238,13 +336,17 @@ struct Map {
     [[nodiscard]] Opt<Ref<const V>> try_get(const K& key) const noexcept {
         if(empty()) return {};
         if(auto idx = try_get_<K>(key); idx.ok()) {
-            return Opt{Ref<const V>{data_[*idx].data->second}};
+            return Opt{Ref<const V>{slot_at(*idx).data->second}};
         }
         return {};
     }
 
     [[nodiscard]] bool try_erase(const K& key) noexcept {
         if(empty()) return false;
+        if(old_data_) {
+            migrate();
+            if(try_erase_old(key)) return true;
+        }
         u64 hash = hash_nonzero(key);
         u64 idx = hash >> shift_;
         u64 dist = 0;
@@ -276,7 +378,7 @@ struct Map {
     {
         if(empty()) return {};
         if(auto idx = try_get_<String_View>(key); idx.ok()) {
-            return Opt<Ref<V>>{data_[*idx].data->second};
+            return Opt<Ref<V>>{slot_at(*idx).data->second};
         }
         return {};
     }
@@ -285,7 +387,7 @@ struct Map {
         requires(Any_String<K>)
     {
         if(auto idx = try_get_<String_View>(key); idx.ok()) {
-            return data_[*idx].data->second;
+            return slot_at(*idx).data->second;
         }
         die("Failed to find key %!", key);
     }
@@ -349,19 +451,19 @@ struct Map {
         [[nodiscard]] Pair<const K, V>& operator*() const noexcept
             requires(!is_const)
         {
-            return reinterpret_cast<Pair<const K, V>&>(*map_.data_[count_].data);
+            return reinterpret_cast<Pair<const K, V>&>(*map_.slot_at(count_).data);
         }
         [[nodiscard]] const Pair<K, V>& operator*() const noexcept {
-            return *map_.data_[count_].data;
+            return *map_.slot_at(count_).data;
         }
 
         [[nodiscard]] Pair<const K, V>* operator->() const noexcept
             requires(!is_const)
         {
-            return reinterpret_cast<Pair<const K, V>*>(&*map_.data_[count_].data);
+            return reinterpret_cast<Pair<const K, V>*>(&*map_.slot_at(count_).data);
         }
         [[nodiscard]] const Pair<K, V>* operator->() const noexcept {
-            return &*map_.data_[count_].data;
+            return &*map_.slot_at(count_).data;
         }
 
         [[nodiscard]] bool operator==(const Iterator& rhs) const noexcept {
@@ -370,7 +472,8 @@ struct Map {
 
     private:
         void skip() noexcept {
-            while(count_ < map_.capacity_ && map_.data_[count_].hash == Slot::EMPTY) count_++;
+            u64 end = map_.capacity_ + map_.old_capacity_;
+            while(count_ < end && map_.slot_at(count_).hash == Slot::EMPTY) count_++;
         }
         Iterator(M& map, u64 count) noexcept : map_(map), count_(count) {
             skip();
@@ -388,17 +491,25 @@ struct Map {
         return const_iterator(*this, 0);
     }
     [[nodiscard]] const_iterator end() const noexcept {
-        return const_iterator(*this, capacity_);
+        return const_iterator(*this, capacity_ + old_capacity_);
     }
     [[nodiscard]] iterator begin() noexcept {
         return iterator(*this, 0);
     }
     [[nodiscard]] iterator end() noexcept {
-        return iterator(*this, capacity_);
+        return iterator(*this, capacity_ + old_capacity_);
     }
 
 private:
-    [[nodiscard]] Slot& insert_slot(Slot&& slot) noexcept {
+    // Inserts a slot and adds one to length_ unless it replaced an equal key.
+    [[nodiscard]] Slot& insert_counted(Slot&& slot) noexcept {
+        bool replaced = false;
+        Slot& placed = insert_slot(rpp::move(slot), &replaced);
+        if(!replaced) length_ += 1;
+        return placed;
+    }
+
+    [[nodiscard]] Slot& insert_slot(Slot&& slot, bool* replaced = null) noexcept {
         u64 idx = slot.hash >> shift_;
         Slot* placement = null;
         u64 dist = 0;
@@ -410,6 +521,7 @@ private:
             }
             if(hash == slot.hash && data_[idx].data->first == slot.data->first) {
                 data_[idx] = rpp::move(slot);
+                if(replaced) *replaced = true;
                 return data_[idx];
             }
             u64 hashidx = hash >> shift_;
@@ -436,9 +548,125 @@ private:
         }
     }
 
+    // Grows once so that additional inserts fit without checking full() on each of them.
+    void reserve_for(u64 additional) noexcept {
+        u64 capacity = capacity_ ? capacity_ : 32;
+        while((capacity / 4) * 3 < length_ + additional) capacity *= 2;
+        reserve(capacity);
+        finish_migration();
+    }
+
+    constexpr static u64 BATCH = 64;
+    constexpr static u64 PREFETCH_DISTANCE = 8;
+
+    // Calls found(i, idx) for each key, where idx is an Opt<u64> in the form of try_get_. Keys are
+    // hashed a block at a time, and each home slot is prefetched PREFETCH_DISTANCE keys before
+    // it is probed.
+    template<typename F>
+    void get_batch_(Slice<K> keys, F&& found) const noexcept {
+        u64 hashes[BATCH];
+        for(u64 base = 0; base < keys.length(); base += BATCH) {
+            u64 n = Math::min(BATCH, keys.length() - base);
+            for(u64 i = 0; i < n; i++) hashes[i] = hash_nonzero(keys[base + i]);
+            for(u64 i = 0; i < Math::min(PREFETCH_DISTANCE, n); i++) {
+                prefetch(&data_[hashes[i] >> shift_]);
+            }
+            for(u64 i = 0; i < n; i++) {
+                if(i + PREFETCH_DISTANCE < n) {
+                    prefetch(&data_[hashes[i + PREFETCH_DISTANCE] >> shift_]);
+                }
+                found(base + i, try_get_(keys[base + i], hashes[i]));
+            }
+        }
+    }
+
+    // Indices at or past capacity_ refer to the old table during a migration.
+    [[nodiscard]] Slot& slot_at(u64 idx) noexcept {
+        return idx < capacity_ ? data_[idx] : old_data_[idx - capacity_];
+    }
+    [[nodiscard]] const Slot& slot_at(u64 idx) const noexcept {
+        return idx < capacity_ ? data_[idx] : old_data_[idx - capacity_];
+    }
+
+    constexpr static u64 MIGRATE_STEP = 64;
+
+    void migrate() noexcept {
+        u64 end = Math::min(migrated_ + MIGRATE_STEP, old_capacity_);
+        for(; migrated_ < end; migrated_++) {
+            if(old_data_[migrated_].hash != Slot::EMPTY)
+                static_cast<void>(insert_slot(rpp::move(old_data_[migrated_])));
+        }
+        if(migrated_ == old_capacity_) drop_old();
+    }
+
+    // The key is about to be inserted into the new table, so it must not survive in the old one.
+    void migrate_for(const K& key) noexcept {
+        migrate();
+        static_cast<void>(try_erase_old(key));
+    }
+
+    void drop_old() noexcept {
+        if(!old_data_) return;
+        if constexpr(Must_Destruct<Pair<K, V>>) {
+            for(u64 i = migrated_; i < old_capacity_; i++) {
+                old_data_[i].~Slot();
+            }
+        }
+        A::free(old_data_);
+        old_data_ = null;
+        old_capacity_ = 0;
+        old_shift_ = 0;
+        migrated_ = 0;
+    }
+
+    // Slots before migrated_ have been emptied, so probes skip over them instead of stopping.
+    // Every key still in the old table sits in the unmigrated part of its original probe run.
+    template<Hashable K2>
+    [[nodiscard]] Opt<u64> try_get_old(const K2& key, u64 hash) const noexcept {
+        if(!old_data_) return {};
+        u64 idx = Math::max(hash >> old_shift_, migrated_);
+        for(u64 n = migrated_; n < old_capacity_; n++) {
+            if(idx == old_capacity_) idx = migrated_;
+            u64 k = old_data_[idx].hash;
+            if(k == Slot::EMPTY) return {};
+            if(k == hash && old_data_[idx].data->first == key) return Opt<u64>{idx};
+            idx++;
+        }
+        return {};
+    }
+
+    [[nodiscard]] bool try_erase_old(const K& key) noexcept {
+        Opt<u64> found = try_get_old(key, hash_nonzero(key));
+        if(!found.ok()) return false;
+        u64 idx = *found;
+        old_data_[idx].~Slot();
+        for(;;) {
+            u64 next = idx == old_capacity_ - 1 ? 0 : idx + 1;
+            u64 nexthash_ = old_data_[next].hash;
+            if(nexthash_ == Slot::EMPTY) break;
+            u64 next_ideal = nexthash_ >> old_shift_;
+            if(next == next_ideal) break;
+            old_data_[idx] = rpp::move(old_data_[next]);
+            idx = next;
+        }
+        length_ -= 1;
+        return true;
+    }
+
     template<Hashable K2>
     [[nodiscard]] Opt<u64> try_get_(const K2& key) const noexcept {
-        u64 hash = hash_nonzero(key);
+        return try_get_(key, hash_nonzero(key));
+    }
+
+    template<Hashable K2>
+    [[nodiscard]] Opt<u64> try_get_(const K2& key, u64 hash) const noexcept {
+        if(Opt<u64> idx = try_get_new_(key, hash); idx.ok()) return idx;
+        if(Opt<u64> idx = try_get_old(key, hash); idx.ok()) return Opt<u64>{capacity_ + *idx};
+        return {};
+    }
+
+    template<Hashable K2>
+    [[nodiscard]] Opt<u64> try_get_new_(const K2& key, u64 hash) const noexcept {
         u64 idx = hash >> shift_;
         u64 dist = 0;
         for(;;) {
@@ -461,6 +689,12 @@ private:
     u64 usable_ = 0;
     u64 shift_ = 0;
 
+    Slot* old_data_ = null;
+    u64 old_capacity_ = 0;
+    u64 old_shift_ = 0;
+    u64 migrated_ = 0;
+    bool incremental_ = false;
+
     friend struct Reflect::Refl<Map>;
     template<bool>
     friend struct Iterator;
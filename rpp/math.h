@@ -106,10 +106,21 @@ template<Int I>
 [[nodiscard]] i32 abs(i32 v) noexcept;
 [[nodiscard]] i64 abs(i64 v) noexcept;
 
+// Approximations evaluated on one lane of SIMD::F32x4, with the error bounds documented there.
+[[nodiscard]] f32 fast_sin(f32 v) noexcept;
+[[nodiscard]] f32 fast_cos(f32 v) noexcept;
+[[nodiscard]] f32 fast_exp(f32 v) noexcept;
+[[nodiscard]] f32 fast_log(f32 v) noexcept;
+[[nodiscard]] f32 fast_atan2(f32 y, f32 x) noexcept;
+[[nodiscard]] f32 fast_rsqrt(f32 v) noexcept;
+[[nodiscard]] f32 fast_pow(f32 x, f32 y) noexcept;
+
 [[nodiscard]] u32 popcount(u32 val) noexcept;
 [[nodiscard]] u64 popcount(u64 val) noexcept;
 [[nodiscard]] u32 ctlz(u32 val) noexcept;
 [[nodiscard]] u64 ctlz(u64 val) noexcept;
+[[nodiscard]] u32 cttz(u32 val) noexcept;
+[[nodiscard]] u64 cttz(u64 val) noexcept;
 [[nodiscard]] u32 log2(u32 val) noexcept;
 [[nodiscard]] u64 log2(u64 val) noexcept;
 [[nodiscard]] u32 prev_pow2(u32 val) noexcept;
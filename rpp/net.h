@@ -2,12 +2,17 @@
 #pragma once
 
 #include "base.h"
+#include "rc.h"
 
 #if defined RPP_OS_LINUX || defined RPP_OS_MACOS 
 #include <netinet/in.h>
 #include <sys/socket.h>
 #endif
 
+namespace rpp::Async {
+struct Event;
+}
+
 namespace rpp::Net {
 
 constexpr u16 default_port = 6969;
@@ -15,21 +20,60 @@ constexpr u64 min_transmissible_unit = 1472;
 
 using Packet = Array<u8, min_transmissible_unit>;
 
+using Alloc = Mallocator<"Net">;
+
+enum class Family : u8 { ipv4, ipv6 };
+
 struct Address {
 
     Address() = default;
 
-    explicit Address(u16 port) noexcept;
+    // The wildcard address of family. Sockets bound to the IPv6 one also accept IPv4 traffic.
+    explicit Address(u16 port, Family family = Family::ipv4) noexcept;
+    // A numeric IPv4 or IPv6 address, depending on whether it contains a colon.
     explicit Address(String_View address, u16 port) noexcept;
 
+    [[nodiscard]] Family family() const noexcept;
+    [[nodiscard]] u16 port() const noexcept;
+
+    [[nodiscard]] bool operator==(const Address& other) const noexcept;
+
 private:
+    // Size of the socket address for its family.
+    [[nodiscard]] u32 length() const noexcept;
+    // IPv4 addresses in IPv4-mapped IPv6 form, for use with IPv6 sockets.
+    [[nodiscard]] Address to_ipv6() const noexcept;
+
 #ifdef RPP_OS_WINDOWS
-    alignas(4) u8 sockaddr_storage[16];
+    alignas(4) u8 sockaddr_storage[28];
 #else
-    sockaddr_in sockaddr_;
+    union {
+        sockaddr_in v4;
+        sockaddr_in6 v6;
+    } sockaddr_;
 #endif
 
     friend struct Udp;
+    friend struct Udp_Group;
+    friend struct Tcp_Stream;
+    friend struct Tcp_Listener;
+};
+
+// A received packet that lives in a pooled, reference counted block. Releasing the last
+// reference returns the block to the size class pool, so it may be handed between coroutines
+// without copying and steady-state receives do not touch the heap.
+struct Pooled_Packet {
+    Packet data;
+    u64 length = 0;
+    Address from;
+};
+
+using Packet_Ref = Arc<Pooled_Packet, Mpool>;
+
+struct Packet_Pool {
+    [[nodiscard]] static Packet_Ref acquire() noexcept {
+        return Packet_Ref::make();
+    }
 };
 
 struct Udp {
@@ -37,8 +81,15 @@ struct Udp {
         u64 length;
         Address from;
     };
+    struct Message {
+        Address to;
+        u64 length;
+    };
 
-    Udp() noexcept;
+    Udp() noexcept : Udp{Family::ipv4} {
+    }
+    // IPv6 sockets are dual-stack: they also exchange datagrams with IPv4 addresses.
+    explicit Udp(Family family) noexcept;
     ~Udp() noexcept;
 
     Udp(const Udp& src) noexcept = delete;
@@ -51,6 +102,152 @@ struct Udp {
     [[nodiscard]] u64 send(Address address, const Packet& out, u64 length) noexcept;
     [[nodiscard]] Opt<Data> recv(Packet& in) noexcept;
 
+    // Receives directly into a buffer from the packet pool.
+    [[nodiscard]] Opt<Packet_Ref> recv() noexcept {
+        Packet_Ref packet = Packet_Pool::acquire();
+        Opt<Data> data = recv(packet->data);
+        if(!data.ok()) return {};
+        packet->length = data->length;
+        packet->from = data->from;
+        return Opt{rpp::move(packet)};
+    }
+    [[nodiscard]] u64 send(Address address, const Packet_Ref& out) noexcept {
+        return send(address, out->data, out->length);
+    }
+
+    // Like send, but returns nothing instead of blocking when the socket buffer is full.
+    [[nodiscard]] Opt<u64> try_send(Address address, const Packet& out, u64 length) noexcept;
+
+    // New events signaled when the socket may be read or written without blocking, to be
+    // passed to Pool::event. On Windows, only one readiness event per socket is live at a time.
+    [[nodiscard]] Async::Event readable() const noexcept;
+    [[nodiscard]] Async::Event writable() const noexcept;
+
+    // Sends out[i] as described by messages[i], returning the number of packets sent. On Linux
+    // this uses sendmmsg, and coalesces runs of equally sized packets to one address with UDP
+    // segmentation offload where the kernel supports it.
+    [[nodiscard]] u64 send(Slice<Packet> out, Slice<Message> messages) noexcept;
+
+    // Receives up to count waiting packets without blocking, returning how many arrived.
+    [[nodiscard]] u64 recv(Packet* in, Data* data, u64 count) noexcept;
+
+    template<u64 N>
+    [[nodiscard]] u64 recv(Array<Packet, N>& in, Array<Data, N>& data) noexcept {
+        return recv(in.data(), data.data(), N);
+    }
+
+private:
+    [[nodiscard]] Address target(const Address& address) const noexcept {
+        return family == Family::ipv6 ? address.to_ipv6() : address;
+    }
+
+#ifdef RPP_OS_WINDOWS
+    u64 socket;
+#else
+    i32 fd;
+#endif
+    Family family = Family::ipv4;
+#ifdef RPP_OS_LINUX
+    bool gso = true;
+#endif
+
+    friend struct Udp_Group;
+};
+
+// Several UDP sockets bound to one address with SO_REUSEPORT, among which the kernel spreads
+// incoming datagrams by flow, so one receive loop per socket (say, one per pool worker) handles
+// the port's traffic on as many threads. Only Linux balances reused ports this way; elsewhere the
+// group holds a single socket.
+struct Udp_Group {
+
+    // With steer, datagrams instead go to the socket whose index is the receiving CPU modulo
+    // count, which keeps each flow on the CPU that took its interrupt when the workers reading the
+    // sockets are pinned in the same order.
+    explicit Udp_Group(Address address, u64 count, bool steer = false) noexcept;
+    ~Udp_Group() noexcept = default;
+
+    Udp_Group(const Udp_Group& src) noexcept = delete;
+    Udp_Group& operator=(const Udp_Group& src) noexcept = delete;
+
+    Udp_Group(Udp_Group&& src) noexcept = default;
+    Udp_Group& operator=(Udp_Group&& src) noexcept = default;
+
+    [[nodiscard]] u64 length() const noexcept {
+        return sockets.length();
+    }
+    [[nodiscard]] Udp& operator[](u64 i) noexcept {
+        return sockets[i];
+    }
+
+private:
+    Vec<Udp, Alloc> sockets;
+};
+
+// A non-blocking TCP connection. Reads and writes return nothing instead of blocking; await
+// readable() or writable() on a pool to sleep until they may make progress.
+struct Tcp_Stream {
+
+    ~Tcp_Stream() noexcept;
+
+    Tcp_Stream(const Tcp_Stream& src) noexcept = delete;
+    Tcp_Stream& operator=(const Tcp_Stream& src) noexcept = delete;
+
+    Tcp_Stream(Tcp_Stream&& src) noexcept;
+    Tcp_Stream& operator=(Tcp_Stream&& src) noexcept;
+
+    // Starts connecting to address. The connection is established once writable() fires and
+    // finish_connect() succeeds.
+    [[nodiscard]] static Opt<Tcp_Stream> connect(Address address) noexcept;
+    [[nodiscard]] bool finish_connect() noexcept;
+
+    void set_nodelay(bool enable) noexcept;
+
+    // Returns the number of bytes read, zero once the peer has closed the connection or it
+    // failed, or nothing if no data is waiting.
+    [[nodiscard]] Opt<u64> read(u8* data, u64 length) noexcept;
+
+    // Writes the concatenation of buffers, skipping its first offset bytes, with one gathering
+    // send. Returns the number of bytes written, zero if the connection failed, or nothing if
+    // the socket buffer is full.
+    [[nodiscard]] Opt<u64> write(Slice<Slice<u8>> buffers, u64 offset = 0) noexcept;
+    [[nodiscard]] Opt<u64> write(Slice<u8> data) noexcept {
+        return write(Slice<Slice<u8>>{&data, 1});
+    }
+
+    // As for Udp, on Windows only one readiness event per socket is live at a time.
+    [[nodiscard]] Async::Event readable() const noexcept;
+    [[nodiscard]] Async::Event writable() const noexcept;
+
+private:
+    Tcp_Stream() noexcept = default;
+
+#ifdef RPP_OS_WINDOWS
+    u64 socket;
+#else
+    i32 fd;
+#endif
+
+    friend struct Tcp_Listener;
+};
+
+struct Tcp_Listener {
+
+    // Binds to address and starts listening for connections.
+    explicit Tcp_Listener(Address address) noexcept;
+    ~Tcp_Listener() noexcept;
+
+    Tcp_Listener(const Tcp_Listener& src) noexcept = delete;
+    Tcp_Listener& operator=(const Tcp_Listener& src) noexcept = delete;
+
+    Tcp_Listener(Tcp_Listener&& src) noexcept;
+    Tcp_Listener& operator=(Tcp_Listener&& src) noexcept;
+
+    // Returns the next pending connection, or nothing if none are waiting.
+    [[nodiscard]] Opt<Tcp_Stream> accept() noexcept;
+
+    // Signaled when a connection is waiting to be accepted.
+    [[nodiscard]] Async::Event readable() const noexcept;
+
 private:
 #ifdef RPP_OS_WINDOWS
     u64 socket;
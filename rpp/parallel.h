@@ -0,0 +1,210 @@
+#pragma once
+
+#include "async.h"
+#include "base.h"
+#include "pool.h"
+#include "sort.h"
+#include "vmath.h"
+
+namespace rpp::Async {
+
+// Data-parallel algorithms over the pool. Ranges are split in half recursively: the right half is
+// pushed onto the current worker's deque, where idle workers steal the largest outstanding pieces,
+// while the left half runs inline. Joining awaits the right half, so a worker whose half is still
+// queued simply pops and runs it instead of blocking.
+//
+// A grain of zero picks one based on the number of workers.
+
+namespace detail {
+
+[[nodiscard]] inline u64 grain_for(u64 length, u64 grain, u64 n_threads) noexcept {
+    if(grain) return grain;
+    return Math::max<u64>(length / (8 * Math::max<u64>(n_threads, 1)), 1);
+}
+
+template<typename T, typename F, Allocator A>
+[[nodiscard]] Task<void> for_range(Pool<A>& pool, Slice<T> slice, u64 offset, u64 grain,
+                                   F& f) noexcept;
+
+template<typename T, typename F, Allocator A>
+[[nodiscard]] Task<void> fork_for_range(Pool<A>& pool, Slice<T> slice, u64 offset, u64 grain,
+                                        F& f) noexcept {
+    co_await pool.suspend();
+    co_await for_range(pool, slice, offset, grain, f);
+}
+
+template<typename T, typename F, Allocator A>
+[[nodiscard]] Task<void> for_range(Pool<A>& pool, Slice<T> slice, u64 offset, u64 grain,
+                                   F& f) noexcept {
+    if(slice.length() <= grain) {
+        for(u64 i = 0; i < slice.length(); i++) f(offset + i, slice[i]);
+        co_return;
+    }
+    u64 half = slice.length() / 2;
+    Task<void> right =
+        fork_for_range(pool, slice.sub(half, slice.length() - half), offset + half, grain, f);
+    co_await for_range(pool, slice.sub(0, half), offset, grain, f);
+    co_await right;
+}
+
+template<typename R, typename T, typename M, typename J, Allocator A>
+[[nodiscard]] Task<R> reduce_range(Pool<A>& pool, Slice<T> slice, u64 grain, const R& identity,
+                                   M& map, J& join) noexcept;
+
+template<typename R, typename T, typename M, typename J, Allocator A>
+[[nodiscard]] Task<R> fork_reduce_range(Pool<A>& pool, Slice<T> slice, u64 grain,
+                                        const R& identity, M& map, J& join) noexcept {
+    co_await pool.suspend();
+    co_return co_await reduce_range(pool, slice, grain, identity, map, join);
+}
+
+template<typename R, typename T, typename M, typename J, Allocator A>
+[[nodiscard]] Task<R> reduce_range(Pool<A>& pool, Slice<T> slice, u64 grain, const R& identity,
+                                   M& map, J& join) noexcept {
+    if(slice.length() <= grain) {
+        R result = identity;
+        for(const T& value : slice) result = join(rpp::move(result), map(value));
+        co_return result;
+    }
+    u64 half = slice.length() / 2;
+    Task<R> right = fork_reduce_range(pool, slice.sub(half, slice.length() - half), grain,
+                                      identity, map, join);
+    R left = co_await reduce_range(pool, slice.sub(0, half), grain, identity, map, join);
+    co_return join(rpp::move(left), co_await right);
+}
+
+// Like for_range, but hands f(offset, length) whole chunks, so it can run batch kernels.
+template<typename F, Allocator A>
+[[nodiscard]] Task<void> chunk_range(Pool<A>& pool, u64 offset, u64 length, u64 grain,
+                                     F& f) noexcept;
+
+template<typename F, Allocator A>
+[[nodiscard]] Task<void> fork_chunk_range(Pool<A>& pool, u64 offset, u64 length, u64 grain,
+                                          F& f) noexcept {
+    co_await pool.suspend();
+    co_await chunk_range(pool, offset, length, grain, f);
+}
+
+template<typename F, Allocator A>
+[[nodiscard]] Task<void> chunk_range(Pool<A>& pool, u64 offset, u64 length, u64 grain,
+                                     F& f) noexcept {
+    if(length <= grain) {
+        f(offset, length);
+        co_return;
+    }
+    u64 half = length / 2;
+    Task<void> right = fork_chunk_range(pool, offset + half, length - half, grain, f);
+    co_await chunk_range(pool, offset, half, grain, f);
+    co_await right;
+}
+
+// Batch kernels are cheap per element, so chunks smaller than this are not worth a steal.
+constexpr u64 TRANSFORM_GRAIN = 4096;
+
+template<typename T, typename F, Allocator A>
+[[nodiscard]] Task<void> transform_range(Pool<A>& pool, Slice<T> in, u64 grain, F f) noexcept {
+    grain = Math::max(grain_for(in.length(), grain, pool.n_threads()), TRANSFORM_GRAIN);
+    if(in.length() <= grain) {
+        f(0, in.length());
+        co_return;
+    }
+    co_await pool.suspend();
+    co_await chunk_range(pool, 0, in.length(), grain, f);
+}
+
+template<typename T, Allocator A>
+[[nodiscard]] Task<void> sort_range(Pool<A>& pool, T* data, u64 length, u64 grain,
+                                    u64 depth) noexcept;
+
+template<typename T, Allocator A>
+[[nodiscard]] Task<void> fork_sort_range(Pool<A>& pool, T* data, u64 length, u64 grain,
+                                         u64 depth) noexcept {
+    co_await pool.suspend();
+    co_await sort_range(pool, data, length, grain, depth);
+}
+
+template<typename T, Allocator A>
+[[nodiscard]] Task<void> sort_range(Pool<A>& pool, T* data, u64 length, u64 grain,
+                                    u64 depth) noexcept {
+    if(length <= Math::max(grain, Sort::detail::INSERTION_SORT_LENGTH) || depth == 0) {
+        Sort::detail::sort(data, length, depth);
+        co_return;
+    }
+    u64 left = Sort::detail::partition(data, length);
+    Task<void> right = fork_sort_range(pool, data + left, length - left, grain, depth - 1);
+    co_await sort_range(pool, data, left, grain, depth - 1);
+    co_await right;
+}
+
+} // namespace detail
+
+// Calls f(index, value) for every element of slice.
+template<typename T, typename F, Allocator A>
+    requires Invocable<F&, u64, const T&>
+[[nodiscard]] Task<void> parallel_for(Pool<A>& pool, Slice<T> slice, u64 grain, F f) noexcept {
+    co_await pool.suspend();
+    grain = detail::grain_for(slice.length(), grain, pool.n_threads());
+    co_await detail::for_range(pool, slice, 0, grain, f);
+}
+
+// Combines map(value) for every element of slice with join, starting each chunk from identity.
+// join must be associative, but chunks are combined in order, so it need not be commutative.
+template<typename R, typename T, typename M, typename J, Allocator A>
+    requires Default_Constructable<R> && Invocable<M&, const T&> && Invocable<J&, R, R>
+[[nodiscard]] Task<R> parallel_reduce(Pool<A>& pool, Slice<T> slice, u64 grain, R identity, M map,
+                                      J join) noexcept {
+    co_await pool.suspend();
+    grain = detail::grain_for(slice.length(), grain, pool.n_threads());
+    co_return co_await detail::reduce_range(pool, slice, grain, identity, map, join);
+}
+
+// Math::transform_points and friends split over the pool. Inputs that fit in one chunk are
+// transformed inline, without leaving the calling thread. A grain of zero uses at least
+// detail::TRANSFORM_GRAIN elements per chunk.
+template<Allocator A>
+[[nodiscard]] Task<void> parallel_transform_points(Pool<A>& pool, Math::Mat4 T,
+                                                   Slice<Math::Vec3> in, Math::Vec3* out,
+                                                   u64 grain = 0) noexcept {
+    co_await detail::transform_range(pool, in, grain, [&](u64 offset, u64 length) {
+        Math::transform_points(T, in.sub(offset, length), out + offset);
+    });
+}
+
+template<Allocator A>
+[[nodiscard]] Task<void> parallel_transform_points(Pool<A>& pool, Math::Mat4 T,
+                                                   Slice<Math::Vec4> in, Math::Vec4* out,
+                                                   u64 grain = 0) noexcept {
+    co_await detail::transform_range(pool, in, grain, [&](u64 offset, u64 length) {
+        Math::transform_points(T, in.sub(offset, length), out + offset);
+    });
+}
+
+template<Allocator A>
+[[nodiscard]] Task<void> parallel_transform_vectors(Pool<A>& pool, Math::Mat4 T,
+                                                    Slice<Math::Vec3> in, Math::Vec3* out,
+                                                    u64 grain = 0) noexcept {
+    co_await detail::transform_range(pool, in, grain, [&](u64 offset, u64 length) {
+        Math::transform_vectors(T, in.sub(offset, length), out + offset);
+    });
+}
+
+template<Allocator A>
+[[nodiscard]] Task<void> parallel_transform_bboxes(Pool<A>& pool, Math::Mat4 T,
+                                                   Slice<Math::BBox> in, Math::BBox* out,
+                                                   u64 grain = 0) noexcept {
+    co_await detail::transform_range(pool, in, grain, [&](u64 offset, u64 length) {
+        Math::transform_bboxes(T, in.sub(offset, length), out + offset);
+    });
+}
+
+// Sorts vec in place by operator<. The sort is not stable.
+template<Ordered T, Allocator VA, Allocator A>
+    requires Movable<T>
+[[nodiscard]] Task<void> parallel_sort(Pool<A>& pool, Vec<T, VA>& vec, u64 grain = 0) noexcept {
+    co_await pool.suspend();
+    grain = detail::grain_for(vec.length(), grain, pool.n_threads());
+    co_await detail::sort_range(pool, vec.data(), vec.length(), grain,
+                                Sort::detail::depth(vec.length()));
+}
+
+} // namespace rpp::Async
@@ -3,20 +3,150 @@
 
 #include "async.h"
 #include "base.h"
+#include "deque.h"
+#include "heap.h"
 #include "thread.h"
+#include "timer.h"
 
 namespace rpp::Async {
 
 template<Allocator A>
 struct Pool;
 
+template<Movable T, u64 N, Allocator A>
+struct Channel;
+
+template<Allocator A = Alloc>
+struct Cancel_Event;
+
+template<Allocator A = Alloc>
+struct Cancel_Timer;
+
+namespace detail {
+
+[[nodiscard]] inline u64 now_ms() noexcept {
+    u64 counter = Thread::perf_counter();
+    u64 freq = Thread::perf_frequency();
+    return counter / freq * 1000 + counter % freq * 1000 / freq;
+}
+
+// A task suspended on a cancellable wait. The node lives in the awaiter and is linked into the
+// token while the task waits, so cancelling the token can find the event loop holding the wait.
+struct Cancel_Wait {
+    Cancel_Wait* next = null;
+    Cancel_Wait* prev = null;
+    void (*cancel)(void* loop, u64 id) noexcept = null;
+    void* loop = null;
+    u64 id = 0;
+    bool linked = false;
+    bool cancelled = false;
+};
+
+} // namespace detail
+
+// Cancels the waits of the tasks it is passed to. A wait that is pending when the token is
+// cancelled, or when its deadline passes, is taken off its event loop and resumes at once,
+// reporting that it gave up. Child tokens are cancelled along with their parent and inherit its
+// deadline if it is earlier.
+//
+// Tokens must outlive the waits that use them, and parents must outlive their children.
+struct Cancel_Token {
+
+    Cancel_Token() noexcept = default;
+    // Deadlines are in milliseconds on the Pool::now() clock, or zero for none.
+    explicit Cancel_Token(u64 deadline) noexcept : deadline_{deadline} {
+    }
+    explicit Cancel_Token(Cancel_Token& parent, u64 deadline = 0) noexcept : parent_{&parent} {
+        Thread::Lock lock(parent.mutex_);
+        deadline_ = deadline && parent.deadline_ ? Math::min(deadline, parent.deadline_)
+                                                 : Math::max(deadline, parent.deadline_);
+        if(parent.flag_.load()) flag_.store(1);
+        next_ = parent.children_;
+        if(next_) next_->prev_ = this;
+        parent.children_ = this;
+    }
+    ~Cancel_Token() noexcept {
+        if(waits_) die("Cancel token destroyed while tasks wait on it.");
+        if(children_) die("Cancel token destroyed before its children.");
+        if(parent_) {
+            Thread::Lock lock(parent_->mutex_);
+            if(prev_) prev_->next_ = next_;
+            else parent_->children_ = next_;
+            if(next_) next_->prev_ = prev_;
+        }
+    }
+
+    Cancel_Token(const Cancel_Token&) noexcept = delete;
+    Cancel_Token& operator=(const Cancel_Token&) noexcept = delete;
+
+    Cancel_Token(Cancel_Token&&) noexcept = delete;
+    Cancel_Token& operator=(Cancel_Token&&) noexcept = delete;
+
+    void cancel() noexcept {
+        Thread::Lock lock(mutex_);
+        if(flag_.exchange(1)) return;
+        for(detail::Cancel_Wait* wait = waits_; wait; wait = wait->next) {
+            wait->cancel(wait->loop, wait->id);
+        }
+        for(Cancel_Token* child = children_; child; child = child->next_) child->cancel();
+    }
+
+    // Work that has been cancelled or is past its deadline should be shed rather than finished.
+    [[nodiscard]] bool cancelled() const noexcept {
+        return flag_.load() || (deadline_ && detail::now_ms() >= deadline_);
+    }
+    [[nodiscard]] u64 deadline() const noexcept {
+        return deadline_;
+    }
+
+private:
+    // Called with the mutex held.
+    void link(detail::Cancel_Wait& wait) noexcept {
+        wait.prev = null;
+        wait.next = waits_;
+        if(waits_) waits_->prev = &wait;
+        waits_ = &wait;
+        wait.linked = true;
+    }
+    void unlink(detail::Cancel_Wait& wait) noexcept {
+        Thread::Lock lock(mutex_);
+        if(!wait.linked) return;
+        if(wait.prev) wait.prev->next = wait.next;
+        else waits_ = wait.next;
+        if(wait.next) wait.next->prev = wait.prev;
+        wait.linked = false;
+    }
+
+    Thread::Mutex mutex_;
+    Thread::Atomic flag_;
+    u64 deadline_ = 0;
+    detail::Cancel_Wait* waits_ = null;
+    Cancel_Token* parent_ = null;
+    Cancel_Token* children_ = null;
+    Cancel_Token* next_ = null;
+    Cancel_Token* prev_ = null;
+
+    template<Allocator>
+    friend struct Pool;
+    template<Allocator>
+    friend struct Cancel_Event;
+    template<Allocator>
+    friend struct Cancel_Timer;
+};
+
 template<Allocator A = Alloc>
 struct Schedule {
 
-    explicit Schedule(Pool<A>& pool) noexcept : pool{pool} {
+    explicit Schedule(Pool<A>& pool, Thread::Priority priority = Thread::Priority::normal,
+                      u64 deadline = 0) noexcept
+        : pool{pool}, priority{priority}, deadline{deadline} {
     }
     void await_suspend(std::coroutine_handle<> task) noexcept {
-        pool.enqueue(Handle{task});
+        if(priority == Thread::Priority::normal && !deadline) {
+            pool.enqueue(Handle{task});
+        } else {
+            pool.enqueue_lane(Handle{task}, priority, deadline);
+        }
     }
     void await_resume() noexcept {
     }
@@ -26,6 +156,8 @@ struct Schedule {
 
 private:
     Pool<A>& pool;
+    Thread::Priority priority;
+    u64 deadline;
 };
 
 template<Allocator A = Alloc>
@@ -48,49 +180,252 @@ private:
     Pool<A>& pool;
 };
 
+template<Allocator A = Alloc>
+struct Schedule_Timer {
+
+    explicit Schedule_Timer(u64 ms, Pool<A>& pool) noexcept : ms{ms}, pool{pool} {
+    }
+    void await_suspend(std::coroutine_handle<> task) noexcept {
+        pool.enqueue_timer(ms, Handle{task});
+    }
+    void await_resume() noexcept {
+    }
+    [[nodiscard]] bool await_ready() noexcept {
+        return ms == 0;
+    }
+
+private:
+    u64 ms;
+    Pool<A>& pool;
+};
+
+// Like Schedule_Event, but resumes early if the token is cancelled or reaches its deadline.
+// Resolves to whether the event fired.
+template<Allocator A>
+struct Cancel_Event {
+
+    explicit Cancel_Event(Event event, Pool<A>& pool, Cancel_Token& token) noexcept
+        : event{rpp::move(event)}, pool{pool}, token{token} {
+    }
+    [[nodiscard]] bool await_suspend(std::coroutine_handle<> task) noexcept {
+        return pool.enqueue_event(rpp::move(event), Handle{task}, token, wait);
+    }
+    [[nodiscard]] bool await_resume() noexcept {
+        token.unlink(wait);
+        return !wait.cancelled;
+    }
+    [[nodiscard]] bool await_ready() noexcept {
+        wait.cancelled = token.cancelled();
+        return wait.cancelled || event.try_wait();
+    }
+
+private:
+    Event event;
+    Pool<A>& pool;
+    Cancel_Token& token;
+    detail::Cancel_Wait wait;
+};
+
+// Like Schedule_Timer, but resumes early if the token is cancelled or reaches its deadline.
+// Resolves to whether the full time elapsed.
+template<Allocator A>
+struct Cancel_Timer {
+
+    explicit Cancel_Timer(u64 ms, Pool<A>& pool, Cancel_Token& token) noexcept
+        : ms{ms}, pool{pool}, token{token} {
+    }
+    [[nodiscard]] bool await_suspend(std::coroutine_handle<> task) noexcept {
+        return pool.enqueue_timer(ms, Handle{task}, token, wait);
+    }
+    [[nodiscard]] bool await_resume() noexcept {
+        token.unlink(wait);
+        return !wait.cancelled && !token.cancelled();
+    }
+    [[nodiscard]] bool await_ready() noexcept {
+        wait.cancelled = token.cancelled();
+        return wait.cancelled || ms == 0;
+    }
+
+private:
+    u64 ms;
+    Pool<A>& pool;
+    Cancel_Token& token;
+    detail::Cancel_Wait wait;
+};
+
+// Bounded Chase-Lev deque: the owning worker pushes and pops at the bottom (LIFO), while other
+// workers steal from the top (FIFO). If the deque is full, the job goes to the worker's locked
+// injection queue instead.
+template<u64 N>
+    requires(N > 0 && (N & (N - 1)) == 0)
+struct Steal_Deque {
+
+    Steal_Deque() noexcept = default;
+    ~Steal_Deque() noexcept = default;
+
+    Steal_Deque(const Steal_Deque&) noexcept = delete;
+    Steal_Deque& operator=(const Steal_Deque&) noexcept = delete;
+
+    Steal_Deque(Steal_Deque&&) noexcept = delete;
+    Steal_Deque& operator=(Steal_Deque&&) noexcept = delete;
+
+    [[nodiscard]] bool push(Handle<> job) noexcept {
+        // Only the owner writes bottom. Publishing it would only need release for thieves, but
+        // the pool's parking check relies on it being ordered before the sleeper count is read.
+        i64 b = bottom.load(Thread::Order::relaxed);
+        i64 t = top.load(Thread::Order::acquire);
+        if(b - t >= static_cast<i64>(N)) return false;
+        slots[b & (N - 1)].store(to_i64(job), Thread::Order::relaxed);
+        bottom.store(b + 1);
+        return true;
+    }
+
+    [[nodiscard]] Opt<Handle<>> pop() noexcept {
+        // Claiming the bottom slot must be ordered before reading top, which takes seq_cst.
+        i64 b = bottom.load(Thread::Order::relaxed) - 1;
+        bottom.store(b);
+        i64 t = top.load();
+        if(t > b) {
+            bottom.store(b + 1, Thread::Order::relaxed);
+            return {};
+        }
+        i64 job = slots[b & (N - 1)].load(Thread::Order::relaxed);
+        if(t == b) {
+            bool won = top.compare_and_swap(t, t + 1) == t;
+            bottom.store(b + 1, Thread::Order::relaxed);
+            if(!won) return {};
+        }
+        return Opt{of_i64(job)};
+    }
+
+    [[nodiscard]] Opt<Handle<>> steal() noexcept {
+        i64 t = top.load();
+        i64 b = bottom.load();
+        if(t >= b) return {};
+        i64 job = slots[t & (N - 1)].load(Thread::Order::relaxed);
+        if(top.compare_and_swap(t, t + 1) != t) return {};
+        return Opt{of_i64(job)};
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return top.load() >= bottom.load();
+    }
+
+private:
+    [[nodiscard]] static i64 to_i64(Handle<> job) noexcept {
+        return reinterpret_cast<i64>(job.handle.address());
+    }
+    [[nodiscard]] static Handle<> of_i64(i64 job) noexcept {
+        return Handle<>{std::coroutine_handle<>::from_address(reinterpret_cast<void*>(job))};
+    }
+
+    // Padded rather than over-aligned, since worker states live in allocator memory.
+    constexpr static u64 PAD = 64 - sizeof(Thread::Atomic);
+
+    Thread::Atomic top;
+    u8 pad0[PAD] = {};
+    Thread::Atomic bottom;
+    u8 pad1[PAD] = {};
+    Thread::Atomic slots[N];
+};
+
+enum class Placement : u8 {
+    // Workers are not pinned.
+    none,
+    // One worker per physical core.
+    cores,
+    // One worker per logical processor.
+    threads,
+};
+
+struct Pool_Config {
+    // Zero picks one worker per processor used by the placement, less one for the calling thread.
+    u64 threads = 0;
+    u64 event_threads = 1;
+    Placement placement = Placement::threads;
+    // If not empty, overrides the placement: worker i is pinned to processor cores[i % length].
+    Slice<u64> cores;
+};
+
 template<Allocator A = Alloc>
 struct Pool {
 
-    explicit Pool() noexcept
-        : thread_states{Vec<Thread_State, A>::make(Thread::hardware_threads() - 1)} {
+    explicit Pool(u64 event_threads = 1) noexcept
+        : Pool{Pool_Config{.event_threads = event_threads}} {
+    }
 
-        u64 h_threads = Thread::hardware_threads();
-        u64 n_threads = thread_states.length();
-        assert(n_threads <= h_threads && n_threads <= 64);
+    explicit Pool(Pool_Config config) noexcept
+        : event_loops{Vec<Event_Loop, A>::make(Math::max<u64>(config.event_threads, 1))} {
+
+        Vec<Thread::Processor, Thread::Alloc> places = placement(config);
+        u64 n_threads = config.threads;
+        if(!n_threads) n_threads = Math::max<u64>(places.length(), 2) - 1;
+        u64 n_loops = event_loops.length();
+
+        thread_states = Vec<Thread_State, A>::make(n_threads);
+        for(u64 i = 0; i < n_threads; i++) {
+            Thread_State& state = thread_states[i];
+            if(config.placement == Placement::none) continue;
+            state.pinned = true;
+            state.processor = places[i % places.length()].index;
+            state.node = places[i % places.length()].node;
+        }
 
         for(u64 i = 0; i < n_threads; i++) {
-            threads.push(Thread::Thread([this, i, h_threads] {
-                u64 j = i < h_threads / 2 ? i * 2 : (i - h_threads / 2) * 2 + 1;
-                Thread::set_affinity(j);
+            threads.push(Thread::Thread([this, i] {
+                Thread_State& state = thread_states[i];
+                if(state.pinned) Thread::set_affinity(state.processor);
                 do_work(i);
             }));
         }
-        pending_events.push(Event{});
-        event_thread = Thread::Thread([this] { do_events(); });
+
+        // Each event loop shares a core with the worker that runs its continuations.
+        for(u64 i = 0; i < n_loops; i++) {
+            Event_Loop& loop = event_loops[i];
+            loop.worker = i * n_threads / n_loops;
+            loop.thread = Thread::Thread([this, &loop] {
+                Thread_State& state = thread_states[loop.worker];
+                if(state.pinned) Thread::set_affinity(state.processor);
+                do_events(loop);
+            });
+        }
     }
     ~Pool() noexcept {
         shutdown.exchange(true);
 
         for(auto& state : thread_states) {
-            Thread::Lock lock(state.mut);
-            state.cond.signal();
+            state.parking.incr_and_wake(1);
         }
         threads.clear();
 
-        {
-            Thread::Lock lock(events_mut);
-            pending_events[0].signal();
+        for(auto& loop : event_loops) {
+            Thread::Lock lock(loop.mut);
+            loop.reactor.wake();
+        }
+        for(auto& loop : event_loops) {
+            loop.thread.join();
+            for(auto& [id, pending] : loop.pending) {
+                loop.reactor.remove(pending.event);
+            }
+            loop.pending.clear();
+            loop.sleeping.clear();
+            loop.to_enqueue.clear();
+            loop.to_schedule.clear();
+            loop.to_cancel.clear();
         }
-        event_thread.join();
-
-        pending_events.clear();
 
         for(auto& state : thread_states) {
+            // This still leaks pending continuations, as we can't control their destruction
+            // order wrt their waiting tasks.
             for(auto& job : state.jobs) {
-                // This still leaks pending continuations, as we can't control their destruction
-                // order wrt their waiting tasks.
                 job.handle.destroy();
             }
+            for(Opt<Handle<>> job = pop_lane(state, true); job.ok(); job = pop_lane(state, true)) {
+                job->handle.destroy();
+            }
+            for(Opt<Handle<>> job = state.deque.pop(); job.ok(); job = state.deque.pop()) {
+                job->handle.destroy();
+            }
         }
     }
 
@@ -103,23 +438,74 @@ struct Pool {
     [[nodiscard]] Schedule<A> suspend() noexcept {
         return Schedule<A>{*this};
     }
+    // Workers take critical, then high priority jobs, then jobs with deadlines, before normal work,
+    // and only run low priority jobs when nothing else is left anywhere.
+    [[nodiscard]] Schedule<A> suspend(Thread::Priority priority) noexcept {
+        return Schedule<A>{*this, priority};
+    }
+    // Jobs with deadlines, in milliseconds on the now() clock, run earliest deadline first after
+    // any critical or high priority jobs.
+    [[nodiscard]] Schedule<A> suspend_until(u64 deadline) noexcept {
+        return Schedule<A>{*this, Thread::Priority::normal, Math::max<u64>(deadline, 1)};
+    }
     [[nodiscard]] Schedule_Event<A> event(Event event) noexcept {
         return Schedule_Event<A>{rpp::move(event), *this};
     }
+    // Resumes the awaiting task on a worker after at least ms milliseconds.
+    [[nodiscard]] Schedule_Timer<A> timer(u64 ms) noexcept {
+        return Schedule_Timer<A>{ms, *this};
+    }
+    [[nodiscard]] Cancel_Event<A> event(Event event, Cancel_Token& token) noexcept {
+        return Cancel_Event<A>{rpp::move(event), *this, token};
+    }
+    [[nodiscard]] Cancel_Timer<A> timer(u64 ms, Cancel_Token& token) noexcept {
+        return Cancel_Timer<A>{ms, *this, token};
+    }
+
+    // Starts a lazy task on a worker. From one of our workers it goes to the local deque, so a
+    // coroutine launching many children keeps running while idle peers steal them.
+    template<typename R, Allocator B>
+    void launch(Lazy<R, B>& task) noexcept {
+        enqueue(Handle{task.launch()});
+    }
 
     [[nodiscard]] u64 n_threads() const noexcept {
         return thread_states.length();
     }
 
+    [[nodiscard]] static u64 now() noexcept {
+        return detail::now_ms();
+    }
+    [[nodiscard]] u64 n_event_threads() const noexcept {
+        return event_loops.length();
+    }
+
 private:
+    struct Event_Loop;
+    struct Timer_Job;
+
     void enqueue(Handle<> job) noexcept {
+        // Jobs scheduled from one of our workers stay local, so fan-out runs depth-first on the
+        // scheduling worker while idle peers steal the oldest jobs.
+        if(this_pool == this) {
+            Thread_State& state = thread_states[this_worker];
+            if(!state.deque.push(job)) {
+                Thread::Lock lock(state.mut);
+                state.jobs.push(rpp::move(job));
+            }
+            wake_one();
+            return;
+        }
+
         for(u64 i = 0; i < thread_states.length(); i++) {
             Thread_State& state = thread_states[i];
             // Race on empty
-            if(state.jobs.empty()) {
-                Thread::Lock lock(state.mut);
-                state.jobs.push(rpp::move(job));
-                state.cond.signal();
+            if(state.jobs.empty() && state.deque.empty()) {
+                {
+                    Thread::Lock lock(state.mut);
+                    state.jobs.push(rpp::move(job));
+                }
+                static_cast<void>(notify(state));
                 return;
             }
         }
@@ -127,87 +513,498 @@ private:
         // All queues more or less busy, choose next from low discrepancy sequence
         u64 i = static_cast<u64>(sequence.incr() * Math::PHI32) % thread_states.length();
         Thread_State& state = thread_states[i];
+        {
+            Thread::Lock lock(state.mut);
+            state.jobs.push(rpp::move(job));
+        }
+        if(!notify(state)) wake_one();
+    }
 
-        Thread::Lock lock(state.mut);
-        state.jobs.push(rpp::move(job));
-        state.cond.signal();
+    // Jobs with a priority or deadline go to the lanes of the scheduling worker, or any worker from
+    // outside the pool, and an idle peer is woken to take them if that worker is busy.
+    void enqueue_lane(Handle<> job, Thread::Priority priority, u64 deadline) noexcept {
+        u64 i = this_pool == this
+                    ? this_worker
+                    : static_cast<u64>(sequence.incr() * Math::PHI32) % thread_states.length();
+        Thread_State& state = thread_states[i];
+        {
+            Thread::Lock lock(state.mut);
+            if(deadline) {
+                state.deadlines.push(Deadline_Job{deadline, sequence.incr(), rpp::move(job)});
+            } else if(priority == Thread::Priority::critical) {
+                state.critical.push(rpp::move(job));
+            } else if(priority == Thread::Priority::high) {
+                state.high.push(rpp::move(job));
+            } else {
+                state.low.push(rpp::move(job));
+            }
+            state.lanes.incr(Thread::Order::relaxed);
+        }
+        if(!notify(state)) wake_one();
     }
 
-    void enqueue_event(Event event, Handle<> job) noexcept {
-        Thread::Lock lock(events_mut);
-        events_to_enqueue.emplace(rpp::move(event), rpp::move(job));
-        pending_events[0].signal();
+    // Pops from the priority lanes with state's mutex held. Low priority jobs are only taken if
+    // low is set.
+    [[nodiscard]] static Opt<Handle<>> pop_lane(Thread_State& state, bool low) noexcept {
+        Opt<Handle<>> job;
+        if(!state.critical.empty()) {
+            job = rpp::move(state.critical.front());
+            state.critical.pop();
+        } else if(!state.high.empty()) {
+            job = rpp::move(state.high.front());
+            state.high.pop();
+        } else if(!state.deadlines.empty()) {
+            job = rpp::move(state.deadlines.top().job);
+            state.deadlines.pop();
+        } else if(low && !state.low.empty()) {
+            job = rpp::move(state.low.front());
+            state.low.pop();
+        }
+        if(job.ok()) state.lanes.decr(Thread::Order::relaxed);
+        return job;
     }
 
-    void do_work(u64 thread_idx) noexcept {
+    // Takes from worker i's lanes, skipping it if the lanes look empty or the lock is contended.
+    [[nodiscard]] Opt<Handle<>> try_pop_lane(u64 i, bool low) noexcept {
+        Thread_State& victim = thread_states[i];
+        // Race on empty
+        if(victim.lanes.load(Thread::Order::relaxed) == 0 || !victim.mut.try_lock()) return {};
+        Opt<Handle<>> job = pop_lane(victim, low);
+        victim.mut.unlock();
+        return job;
+    }
+
+    // Wakes the worker if it is parked, returning whether it was. Busy or spinning workers will
+    // find the job without being told, so only parked ones cost a syscall.
+    [[nodiscard]] bool notify(Thread_State& state) noexcept {
+        if(state.sleeping.load() == 0 || state.sleeping.exchange(0) == 0) return false;
+        state.parking.incr_and_wake(1);
+        return true;
+    }
+
+    void wake_one() noexcept {
+        if(sleepers.load() == 0) return;
+        for(auto& state : thread_states) {
+            if(notify(state)) return;
+        }
+    }
+
+    [[nodiscard]] bool can_steal(u64 thread_idx) const noexcept {
+        for(u64 i = 0; i < thread_states.length(); i++) {
+            if(i != thread_idx && !thread_states[i].deque.empty()) return true;
+        }
+        return false;
+    }
+
+    [[nodiscard]] Opt<Handle<>> find_work(u64 thread_idx) noexcept {
         Thread_State& state = thread_states[thread_idx];
-        for(;;) {
-            Handle<> job;
-            {
-                Thread::Lock lock(state.mut);
+        u64 n = thread_states.length();
 
-                while(state.jobs.empty() && !shutdown.load()) {
-                    state.cond.wait(state.mut);
-                }
-                if(shutdown.load()) return;
+        if(state.lanes.load(Thread::Order::relaxed)) {
+            Thread::Lock lock(state.mut);
+            if(Opt<Handle<>> job = pop_lane(state, false); job.ok()) return job;
+        }
+        for(u64 i = 1; i < n; i++) {
+            if(Opt<Handle<>> job = try_pop_lane((thread_idx + i) % n, false); job.ok()) return job;
+        }
 
-                job = rpp::move(state.jobs.front());
+        if(Opt<Handle<>> job = state.deque.pop(); job.ok()) return job;
+        {
+            Thread::Lock lock(state.mut);
+            if(!state.jobs.empty()) {
+                Handle<> job = rpp::move(state.jobs.front());
                 state.jobs.pop();
+                return Opt{rpp::move(job)};
+            }
+        }
+
+        // Steal from workers on our own node first, so the job's data likely stays local.
+        for(u64 pass = 0; pass < 2; pass++) {
+            for(u64 i = 1; i < n; i++) {
+                Thread_State& victim = thread_states[(thread_idx + i) % n];
+                if((victim.node == state.node) != (pass == 0)) continue;
+                if(Opt<Handle<>> job = victim.deque.steal(); job.ok()) {
+                    if(can_steal(thread_idx)) wake_one();
+                    return job;
+                }
+            }
+        }
+        for(u64 i = 1; i < n; i++) {
+            Thread_State& victim = thread_states[(thread_idx + i) % n];
+            // Race on empty
+            if(victim.jobs.empty() || !victim.mut.try_lock()) continue;
+            Opt<Handle<>> job;
+            if(!victim.jobs.empty()) {
+                job = rpp::move(victim.jobs.front());
+                victim.jobs.pop();
             }
-            job.handle.resume();
+            victim.mut.unlock();
+            if(job.ok()) return job;
+        }
+
+        for(u64 i = 0; i < n; i++) {
+            if(Opt<Handle<>> job = try_pop_lane((thread_idx + i) % n, true); job.ok()) return job;
         }
+        return {};
+    }
+
+    // Hands ready continuations to a specific worker, waking a peer to steal them if that worker
+    // is busy.
+    void enqueue_on(u64 thread_idx, Handle<>* jobs, u64 n_jobs) noexcept {
+        Thread_State& state = thread_states[thread_idx];
+        {
+            Thread::Lock lock(state.mut);
+            for(u64 i = 0; i < n_jobs; i++) {
+                state.jobs.push(rpp::move(jobs[i]));
+            }
+        }
+        if(!notify(state) || n_jobs > 1) wake_one();
+    }
+
+    void enqueue_event(Event event, Handle<> job) noexcept {
+        Event_Loop& loop = event_loops[rpp::hash(event.key()) % event_loops.length()];
+        Thread::Lock lock(loop.mut);
+        loop.to_enqueue.emplace(loop.next_id++, Waiting{rpp::move(event), rpp::move(job)});
+        loop.reactor.wake();
+    }
+
+    // Cancellable waits are registered with their token under its lock, so a concurrent cancel
+    // either finds the wait or has already been seen here. Events with a deadline also get a
+    // timer that cancels them unless they fire first.
+    [[nodiscard]] bool enqueue_event(Event event, Handle<> job, Cancel_Token& token,
+                                     detail::Cancel_Wait& wait) noexcept {
+        Thread::Lock guard(token.mutex_);
+        if(token.cancelled()) {
+            wait.cancelled = true;
+            return false;
+        }
+        Event_Loop& loop = event_loops[rpp::hash(event.key()) % event_loops.length()];
+        Thread::Lock lock(loop.mut);
+        watch(loop, token, wait);
+        loop.to_enqueue.emplace(wait.id, Waiting{rpp::move(event), rpp::move(job), &wait});
+        if(token.deadline_) schedule(loop, token.deadline_, Timer_Job{Handle<>{}, wait.id});
+        loop.reactor.wake();
+        return true;
+    }
+
+    // Timers are spread over loops like events, but a loop is only woken if the new deadline is
+    // earlier than the one its reactor wait is already bounded by.
+    void enqueue_timer(u64 ms, Handle<> job) noexcept {
+        u64 i = static_cast<u64>(sequence.incr() * Math::PHI32) % event_loops.length();
+        Event_Loop& loop = event_loops[i];
+        u64 deadline = now() + ms;
+        Thread::Lock lock(loop.mut);
+        schedule(loop, deadline, Timer_Job{rpp::move(job)});
     }
 
-    void do_events() noexcept {
+    // The continuation of a cancellable timer waits in the loop's sleeping map, while the wheel
+    // only holds its id, so whichever of the timer and the cancel comes first resumes it.
+    [[nodiscard]] bool enqueue_timer(u64 ms, Handle<> job, Cancel_Token& token,
+                                     detail::Cancel_Wait& wait) noexcept {
+        Thread::Lock guard(token.mutex_);
+        if(token.cancelled()) {
+            wait.cancelled = true;
+            return false;
+        }
+        u64 i = static_cast<u64>(sequence.incr() * Math::PHI32) % event_loops.length();
+        Event_Loop& loop = event_loops[i];
+        u64 deadline = now() + ms;
+        if(token.deadline_) deadline = Math::min(deadline, token.deadline_);
+        Thread::Lock lock(loop.mut);
+        watch(loop, token, wait);
+        loop.sleeping.insert(wait.id, Pair<Handle<>, detail::Cancel_Wait*>{rpp::move(job), &wait});
+        schedule(loop, deadline, Timer_Job{Handle<>{}, wait.id});
+        return true;
+    }
+
+    // Called with the locks of the token and the loop held.
+    void watch(Event_Loop& loop, Cancel_Token& token, detail::Cancel_Wait& wait) noexcept {
+        wait.cancel = &cancel_wait;
+        wait.loop = &loop;
+        wait.id = loop.next_id++;
+        wait.cancelled = false;
+        token.link(wait);
+    }
+
+    // Called with the loop's lock held.
+    void schedule(Event_Loop& loop, u64 deadline, Timer_Job&& job) noexcept {
+        loop.to_schedule.emplace(deadline, rpp::move(job));
+        if(deadline < loop.armed) {
+            loop.armed = deadline;
+            loop.reactor.wake();
+        }
+    }
+
+    static void cancel_wait(void* ptr, u64 id) noexcept {
+        Event_Loop& loop = *static_cast<Event_Loop*>(ptr);
+        Thread::Lock lock(loop.mut);
+        loop.to_cancel.push(id);
+        loop.reactor.wake();
+    }
+
+    void do_work(u64 thread_idx) noexcept {
+        this_pool = this;
+        this_worker = thread_idx;
+
         for(;;) {
-            u64 idx = Event::wait_any(Slice<Event>{pending_events});
-            Thread::Lock lock(events_mut);
-            if(idx == 0) {
-                if(shutdown.load()) return;
-
-                for(auto& [event, state] : events_to_enqueue) {
-                    pending_events.push(rpp::move(event));
-                    pending_event_jobs.push(rpp::move(state));
-                }
-                events_to_enqueue.clear();
+            Opt<Handle<>> job = find_work(thread_idx);
+            // Spin briefly before parking, so jobs that follow each other closely are picked up
+            // without a syscall and a context switch on either side.
+            for(u64 spin = 0; !job.ok() && spin < IDLE_SPINS; spin++) {
+                for(u64 i = 0; i < IDLE_PAUSES; i++) Thread::pause();
+                job = find_work(thread_idx);
+            }
+            if(job.ok()) {
+                // Keyed by the coroutine, so the trace links each hop between threads.
+                u64 id = reinterpret_cast<u64>(job->handle.address());
+                if(Profile::capturing()) Profile::capture(Profile::Capture::resume, "Job"_v, id);
+                job->handle.resume();
+                if(Profile::capturing()) Profile::capture(Profile::Capture::suspend, "Job"_v, id);
+                continue;
+            }
 
-                pending_events[0].reset();
+            park(thread_idx);
+            if(shutdown.load()) return;
+        }
+    }
+
+    // Parks on the worker's eventcount. The epoch is read before announcing the park, so a notify
+    // that lands after the final check bumps it and the wait returns immediately.
+    void park(u64 thread_idx) noexcept {
+        Thread_State& state = thread_states[thread_idx];
+        u32 epoch = state.parking.load();
+        state.sleeping.store(1);
+        sleepers.incr();
+        if(!shutdown.load() && !has_work(thread_idx)) state.parking.wait(epoch);
+        state.sleeping.store(0);
+        sleepers.decr();
+    }
+
+    [[nodiscard]] bool has_work(u64 thread_idx) noexcept {
+        Thread_State& state = thread_states[thread_idx];
+        {
+            Thread::Lock lock(state.mut);
+            if(!state.jobs.empty()) return true;
+        }
+        for(auto& peer : thread_states) {
+            if(peer.lanes.load()) return true;
+        }
+        return can_steal(thread_idx);
+    }
+
+    // The reactor wait doubles as the loop's only kernel timer: it is bounded by the wheel's next
+    // deadline, and expired timers are handed to the worker in the same batches as events.
+    void do_events(Event_Loop& loop) noexcept {
+        u64 ready[EVENT_BATCH];
+        Handle<> jobs[EVENT_BATCH];
+        u64 n_jobs = 0;
+
+        auto flush = [&]() {
+            if(n_jobs) enqueue_on(loop.worker, jobs, n_jobs);
+            n_jobs = 0;
+        };
+        auto resume = [&](Handle<>&& job) {
+            jobs[n_jobs++] = rpp::move(job);
+            if(n_jobs == EVENT_BATCH) flush();
+        };
+        // Resumes a wait early, reporting it cancelled, unless it has already finished.
+        auto cancel = [&](u64 id) {
+            if(Opt<Ref<Waiting>> found = loop.pending.try_get(id); found.ok()) {
+                Waiting& waiting = **found;
+                waiting.wait->cancelled = true;
+                loop.reactor.remove(waiting.event);
+                resume(rpp::move(waiting.job));
+                loop.pending.erase(id);
+            } else if(auto sleeper = loop.sleeping.try_get(id); sleeper.ok()) {
+                (**sleeper).second->cancelled = true;
+                resume(rpp::move((**sleeper).first));
+                loop.sleeping.erase(id);
+            }
+        };
+        auto expire = [&](Timer_Job&& timer) {
+            if(!timer.id) return resume(rpp::move(timer.job));
+            if(auto sleeper = loop.sleeping.try_get(timer.id); sleeper.ok()) {
+                resume(rpp::move((**sleeper).first));
+                loop.sleeping.erase(timer.id);
             } else {
-                auto job = rpp::move(pending_event_jobs[idx - 1]);
+                // The deadline of a pending event.
+                cancel(timer.id);
+            }
+        };
 
-                if(pending_events.length() > 2) {
-                    swap(pending_events[idx], pending_events.back());
-                    swap(pending_event_jobs[idx - 1], pending_event_jobs.back());
+        u64 timeout = Reactor::FOREVER;
+        for(;;) {
+            u64 n = loop.reactor.wait(ready, EVENT_BATCH, timeout);
+            {
+                Thread::Lock lock(loop.mut);
+                if(shutdown.load()) {
+                    for(u64 i = 0; i < n; i++) {
+                        if(ready[i] == Reactor::WAKE) return;
+                    }
+                }
+
+                // Registered first, so that any timer or cancel for the event below finds it.
+                for(auto& [id, waiting] : loop.to_enqueue) {
+                    loop.reactor.add(waiting.event, id);
+                    loop.pending.insert(id, rpp::move(waiting));
+                }
+                loop.to_enqueue.clear();
+
+                loop.timers.advance(now(), expire);
+                for(auto& [deadline, job] : loop.to_schedule) {
+                    loop.timers.insert(deadline, rpp::move(job));
+                }
+                loop.to_schedule.clear();
+
+                for(u64 id : loop.to_cancel) cancel(id);
+                loop.to_cancel.clear();
+
+                for(u64 i = 0; i < n; i++) {
+                    if(ready[i] == Reactor::WAKE) continue;
+                    // The wait may have been cancelled since the reactor reported it.
+                    Opt<Ref<Waiting>> found = loop.pending.try_get(ready[i]);
+                    if(!found.ok()) continue;
+                    Waiting& waiting = **found;
+                    loop.reactor.remove(waiting.event);
+                    resume(rpp::move(waiting.job));
+                    loop.pending.erase(ready[i]);
                 }
-                pending_events.pop();
-                pending_event_jobs.pop();
 
-                enqueue(job);
+                u64 next = loop.timers.next_deadline();
+                u64 now = loop.timers.now();
+                loop.armed = next;
+                timeout = next == Timer_Wheel<Timer_Job, A>::NEVER ? Reactor::FOREVER
+                          : next > now                              ? next - now
+                                                                    : 0;
+            }
+            flush();
+        }
+    }
+
+    // Processors in the order workers are assigned to them. Placement spreads workers over physical
+    // cores node by node, and only then doubles up on SMT siblings.
+    [[nodiscard]] static Vec<Thread::Processor, Thread::Alloc>
+    placement(const Pool_Config& config) noexcept {
+        Vec<Thread::Processor, Thread::Alloc> topology = Thread::topology();
+
+        if(config.cores.length()) {
+            Vec<Thread::Processor, Thread::Alloc> ret;
+            for(u64 index : config.cores) {
+                assert(index < topology.length());
+                ret.push(topology[index]);
+            }
+            return ret;
+        }
+
+        // Rank processors by how many siblings of the same core precede them.
+        u64 n = topology.length();
+        Vec<Pair<u64, Thread::Processor>, Thread::Alloc> ranked;
+        for(u64 i = 0; i < n; i++) {
+            u64 rank = 0;
+            for(u64 j = 0; j < i; j++) rank += topology[j].core == topology[i].core;
+            if(config.placement == Placement::cores && rank > 0) continue;
+            ranked.push(Pair<u64, Thread::Processor>{rank, topology[i]});
+        }
+
+        auto before = [](const Pair<u64, Thread::Processor>& a,
+                         const Pair<u64, Thread::Processor>& b) {
+            if(a.first != b.first) return a.first < b.first;
+            if(a.second.node != b.second.node) return a.second.node < b.second.node;
+            return a.second.index < b.second.index;
+        };
+        for(u64 i = 1; i < ranked.length(); i++) {
+            for(u64 j = i; j > 0 && before(ranked[j], ranked[j - 1]); j--) {
+                rpp::swap(ranked[j], ranked[j - 1]);
             }
         }
+
+        Vec<Thread::Processor, Thread::Alloc> ret;
+        for(auto& [rank, processor] : ranked) ret.push(processor);
+        return ret;
     }
 
-    Thread::Atomic shutdown, sequence;
+    constexpr static u64 DEQUE_CAPACITY = 256;
+    constexpr static u64 IDLE_SPINS = 32;
+    constexpr static u64 IDLE_PAUSES = 8;
+    constexpr static u64 EVENT_BATCH = 64;
+
+    Thread::Atomic shutdown, sequence, sleepers;
+
+    struct Waiting {
+        Event event;
+        Handle<> job;
+        detail::Cancel_Wait* wait = null;
+    };
+
+    // Cancellable timers leave their continuation in the loop's sleeping map and only set the id.
+    struct Timer_Job {
+        Handle<> job;
+        u64 id = 0;
+    };
+
+    struct Deadline_Job {
+        u64 deadline = 0;
+        i64 sequence = 0;
+        Handle<> job;
+
+        // Earliest deadline first, and FIFO among equal deadlines.
+        [[nodiscard]] bool operator<(const Deadline_Job& other) const noexcept {
+            return deadline < other.deadline ||
+                   (deadline == other.deadline && sequence < other.sequence);
+        }
+    };
 
     struct Thread_State {
+        Steal_Deque<DEQUE_CAPACITY> deque;
+        bool pinned = false;
+        u64 processor = 0;
+        u64 node = 0;
+        Thread::Atomic sleeping;
+        Thread::Futex parking;
         Thread::Mutex mut;
-        Thread::Cond cond;
-        Queue<Handle<>, A> jobs;
+        // Segmented, so a burst of injected jobs never stalls on copying the whole queue.
+        Deque<Handle<>, A> jobs;
+        // Priority lanes, guarded by mut. The count lets peers skip empty lanes without locking.
+        Deque<Handle<>, A> critical, high, low;
+        Heap<Deadline_Job, A> deadlines;
+        Thread::Atomic lanes;
     };
     Vec<Thread_State, A> thread_states;
     Vec<Thread::Thread<A>, A> threads;
 
-    Vec<Event, A> pending_events;
-    Vec<Handle<>, A> pending_event_jobs;
-    Vec<Pair<Event, Handle<>>, A> events_to_enqueue;
+    // Events are sharded between loops by descriptor, each loop owning its own reactor.
+    struct Event_Loop {
+        Reactor reactor;
+        Thread::Mutex mut;
+        Map<u64, Waiting, A> pending;
+        Map<u64, Pair<Handle<>, detail::Cancel_Wait*>, A> sleeping;
+        Vec<Pair<u64, Waiting>, A> to_enqueue;
+        Vec<Pair<u64, Timer_Job>, A> to_schedule;
+        Vec<u64, A> to_cancel;
+        Timer_Wheel<Timer_Job, A> timers;
+        u64 armed = Timer_Wheel<Timer_Job, A>::NEVER;
+        // Zero marks timers that resume their job directly.
+        u64 next_id = 1;
+        u64 worker = 0;
+        Thread::Thread<A> thread;
+    };
+    Vec<Event_Loop, A> event_loops;
 
-    Thread::Thread<A> event_thread;
-    Thread::Mutex events_mut;
+    static inline thread_local Pool* this_pool = null;
+    static inline thread_local u64 this_worker = 0;
 
     template<Allocator>
     friend struct Schedule;
     template<Allocator>
     friend struct Schedule_Event;
+    template<Allocator>
+    friend struct Schedule_Timer;
+    template<Allocator>
+    friend struct Cancel_Event;
+    template<Allocator>
+    friend struct Cancel_Timer;
+    template<Movable, u64, Allocator>
+    friend struct Channel;
 };
 
 } // namespace rpp::Async
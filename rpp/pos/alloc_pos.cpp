@@ -0,0 +1,45 @@
+#include "../base.h"
+
+#include <sys/mman.h>
+
+namespace rpp {
+
+[[nodiscard]] void* sys_reserve(u64 size) noexcept {
+    void* ret = mmap(null, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(ret == MAP_FAILED) {
+        die("Failed to reserve % bytes: %", size, Log::sys_error());
+    }
+    return ret;
+}
+
+void sys_commit(void* mem, u64 size) noexcept {
+    if(mprotect(mem, size, PROT_READ | PROT_WRITE) != 0) {
+        die("Failed to commit % bytes: %", size, Log::sys_error());
+    }
+}
+
+void sys_decommit(void* mem, u64 size) noexcept {
+    if(madvise(mem, size, MADV_DONTNEED) != 0 || mprotect(mem, size, PROT_NONE) != 0) {
+        die("Failed to decommit % bytes: %", size, Log::sys_error());
+    }
+}
+
+void sys_release(void* mem, u64 size) noexcept {
+    if(munmap(mem, size) != 0) {
+        die("Failed to release % bytes: %", size, Log::sys_error());
+    }
+}
+
+[[nodiscard]] bool sys_extend(void* mem, u64 size, u64 new_size) noexcept {
+#ifdef RPP_OS_LINUX
+    // Without MREMAP_MAYMOVE the mapping only grows if the following pages are free.
+    return mremap(mem, size, new_size, 0) != MAP_FAILED;
+#else
+    static_cast<void>(mem);
+    static_cast<void>(size);
+    static_cast<void>(new_size);
+    return false;
+#endif
+}
+
+} // namespace rpp
@@ -1,6 +1,7 @@
 
 #include "../async.h"
 
+#include <errno.h>
 #include <sys/event.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -64,6 +65,10 @@ void Event::reset() const noexcept {
     return false;
 }
 
+[[nodiscard]] u64 Event::key() const noexcept {
+    return static_cast<u64>(fd);
+}
+
 [[nodiscard]] u64 Event::wait_any(Slice<Event> events) noexcept {
 
     int kq = kqueue();
@@ -95,4 +100,74 @@ void Event::reset() const noexcept {
     RPP_UNREACHABLE;
 }
 
+Reactor::Reactor() noexcept {
+    fd = kqueue();
+    if(fd == -1) {
+        die("Failed to create kqueue: %", Log::sys_error());
+    }
+
+    struct kevent change;
+    EV_SET(&change, wake_.fd, wake_.mask, EV_ADD | EV_ENABLE, 0, 0,
+           reinterpret_cast<void*>(WAKE));
+    if(kevent(fd, &change, 1, null, 0, null) == -1) {
+        die("Failed to add kevent: %", Log::sys_error());
+    }
+}
+
+Reactor::~Reactor() noexcept {
+    if(fd != -1) close(fd);
+    fd = -1;
+}
+
+void Reactor::add(const Event& event, u64 id) noexcept {
+    struct kevent change;
+    EV_SET(&change, event.fd, event.mask, EV_ADD | EV_ENABLE | EV_ONESHOT, 0, 0,
+           reinterpret_cast<void*>(id));
+    if(kevent(fd, &change, 1, null, 0, null) == -1) {
+        die("Failed to add kevent: %", Log::sys_error());
+    }
+}
+
+void Reactor::remove(const Event& event) noexcept {
+    // One-shot kevents are deleted once delivered, so this only matters for events that never
+    // fired and may fail with ENOENT otherwise.
+    struct kevent change;
+    EV_SET(&change, event.fd, event.mask, EV_DELETE, 0, 0, null);
+    static_cast<void>(kevent(fd, &change, 1, null, 0, null));
+}
+
+void Reactor::wake() noexcept {
+    wake_.signal();
+}
+
+[[nodiscard]] u64 Reactor::wait(u64* ready, u64 capacity, u64 timeout_ms) noexcept {
+    assert(capacity > 0);
+
+    struct kevent events[MAX_BATCH];
+    int max = static_cast<int>(Math::min(capacity, MAX_BATCH));
+
+    struct timespec timeout = {};
+    timeout.tv_sec = static_cast<time_t>(timeout_ms / 1000);
+    timeout.tv_nsec = static_cast<long>((timeout_ms % 1000) * 1000000);
+
+    int count = -1;
+    do {
+        count = kevent(fd, null, 0, events, max, timeout_ms == FOREVER ? null : &timeout);
+    } while(count == -1 && errno == EINTR);
+
+    if(count == -1) {
+        die("Failed to wait on kevents: %", Log::sys_error());
+    }
+
+    for(int i = 0; i < count; i++) {
+        if(events[i].flags & EV_ERROR) {
+            die("Failed to wait on kevents: %", Log::sys_error());
+        }
+        u64 id = reinterpret_cast<u64>(events[i].udata);
+        if(id == WAKE) wake_.reset();
+        ready[i] = id;
+    }
+    return static_cast<u64>(count);
+}
+
 } // namespace rpp::Async
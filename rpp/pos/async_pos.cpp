@@ -1,6 +1,7 @@
 
 #include "../async.h"
 
+#include <errno.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <unistd.h>
@@ -65,6 +66,10 @@ void Event::reset() const noexcept {
     return false;
 }
 
+[[nodiscard]] u64 Event::key() const noexcept {
+    return static_cast<u64>(fd);
+}
+
 [[nodiscard]] u64 Event::wait_any(Slice<Event> events) noexcept {
 
     int epfd = epoll_create1(EPOLL_CLOEXEC);
@@ -100,4 +105,75 @@ void Event::reset() const noexcept {
     RPP_UNREACHABLE;
 }
 
+Reactor::Reactor() noexcept {
+    fd = epoll_create1(EPOLL_CLOEXEC);
+    if(fd == -1) {
+        die("Failed to create epoll: %", Log::sys_error());
+    }
+
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = WAKE;
+    int ret = epoll_ctl(fd, EPOLL_CTL_ADD, wake_.fd, &ev);
+    if(ret == -1) {
+        die("Failed to add event to epoll: %", Log::sys_error());
+    }
+}
+
+Reactor::~Reactor() noexcept {
+    if(fd != -1) {
+        int ret = close(fd);
+        assert(ret == 0);
+    }
+    fd = -1;
+}
+
+void Reactor::add(const Event& event, u64 id) noexcept {
+    epoll_event ev = {};
+    ev.events = static_cast<u32>(event.mask) | EPOLLONESHOT;
+    ev.data.u64 = id;
+    int ret = epoll_ctl(fd, EPOLL_CTL_ADD, event.fd, &ev);
+    if(ret == -1) {
+        die("Failed to add event to epoll: %", Log::sys_error());
+    }
+}
+
+void Reactor::remove(const Event& event) noexcept {
+    // One-shot events stay registered, just disarmed, until removed here.
+    int ret = epoll_ctl(fd, EPOLL_CTL_DEL, event.fd, null);
+    if(ret == -1) {
+        die("Failed to remove event from epoll: %", Log::sys_error());
+    }
+}
+
+void Reactor::wake() noexcept {
+    wake_.signal();
+}
+
+[[nodiscard]] u64 Reactor::wait(u64* ready, u64 capacity, u64 timeout_ms) noexcept {
+    assert(capacity > 0);
+
+    epoll_event events[MAX_BATCH];
+    int max = static_cast<int>(Math::min(capacity, MAX_BATCH));
+    int timeout =
+        timeout_ms == FOREVER ? -1 : static_cast<int>(Math::min<u64>(timeout_ms, RPP_INT32_MAX));
+
+    int ret = -1;
+    do {
+        ret = epoll_wait(fd, events, max, timeout);
+    } while(ret == -1 && errno == EINTR);
+
+    if(ret == -1) {
+        die("Failed to wait on events: %", Log::sys_error());
+    }
+
+    for(int i = 0; i < ret; i++) {
+        u64 id = events[i].data.u64;
+        // Reset before the caller handles the wake-up, so a signal sent in the meantime is kept.
+        if(id == WAKE) wake_.reset();
+        ready[i] = id;
+    }
+    return static_cast<u64>(ret);
+}
+
 } // namespace rpp::Async
@@ -2,6 +2,7 @@
 #include "../asyncio.h"
 #include "../files.h"
 
+#include <errno.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -40,6 +41,37 @@ namespace rpp::Async {
     co_return Opt{rpp::move(data)};
 }
 
+[[nodiscard]] Task<Opt<u64>> read(Pool<>& pool, String_View path_, u64 offset, u8* data,
+                                  u64 length) noexcept {
+
+    int fd = -1;
+    Region(R) {
+        auto path = path_.terminate<Mregion<R>>();
+        fd = open(reinterpret_cast<const char*>(path.data()), O_RDONLY);
+    }
+
+    if(fd == -1) {
+        warn("Failed to open file %: %", path_, Log::sys_error());
+        co_return {};
+    }
+
+    u64 done = 0;
+    while(done < length) {
+        ssize_t ret = pread(fd, data + done, length - done, static_cast<off_t>(offset + done));
+        if(ret == -1) {
+            if(errno == EINTR) continue;
+            warn("Failed to read file %: %", path_, Log::sys_error());
+            close(fd);
+            co_return {};
+        }
+        if(ret == 0) break;
+        done += static_cast<u64>(ret);
+    }
+
+    close(fd);
+    co_return Opt{done};
+}
+
 [[nodiscard]] Task<bool> write(Pool<>& pool, String_View path_, Slice<u8> data) noexcept {
 
     int fd = -1;
@@ -62,9 +94,4 @@ namespace rpp::Async {
     co_return true;
 }
 
-[[nodiscard]] Task<void> wait(Pool<>&, u64 ms) noexcept {
-    Thread::sleep(ms);
-    co_return;
-}
-
 } // namespace rpp::Async
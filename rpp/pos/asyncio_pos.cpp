@@ -1,23 +1,255 @@
-
 #include "../asyncio.h"
 #include "../files.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <linux/io_uring.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
-#include <sys/timerfd.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
-// The file IO operations are not actually async.
+// File reads and writes are submitted to io_uring when the kernel supports it, otherwise they
+// block the calling worker. Opening and sizing files is always synchronous.
 
 namespace rpp::Async {
 
+struct Uring_Op {
+    i32 result = 0;
+    bool done = false;
+};
+
+// A single ring shared by all pools. Each operation is submitted together with a hard-linked
+// write to an eventfd, which the pool's reactor waits on. The kernel posts the operation's
+// completion before starting the linked write, so when the waiting coroutine resumes it can
+// reap the completion queue and find its result.
+struct Uring {
+
+    Uring() noexcept {
+        io_uring_params params = {};
+        fd = static_cast<i32>(syscall(__NR_io_uring_setup, ENTRIES, &params));
+        if(fd < 0) {
+            fd = -1;
+            return;
+        }
+        // IORING_OP_READ and IORING_OP_WRITE arrived alongside fast poll.
+        if(!(params.features & IORING_FEAT_FAST_POLL) || !(params.features & IORING_FEAT_NODROP)) {
+            close(fd);
+            fd = -1;
+            return;
+        }
+
+        sq_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+        cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if(single) sq_size = cq_size = Math::max(sq_size, cq_size);
+
+        sq_ring = mmap(null, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                       IORING_OFF_SQ_RING);
+        if(sq_ring == MAP_FAILED) {
+            die("Failed to map io_uring submission queue: %", Log::sys_error());
+        }
+        if(single) {
+            cq_ring = sq_ring;
+        } else {
+            cq_ring = mmap(null, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                           IORING_OFF_CQ_RING);
+            if(cq_ring == MAP_FAILED) {
+                die("Failed to map io_uring completion queue: %", Log::sys_error());
+            }
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = reinterpret_cast<io_uring_sqe*>(mmap(null, sqes_size, PROT_READ | PROT_WRITE,
+                                                    MAP_SHARED | MAP_POPULATE, fd,
+                                                    IORING_OFF_SQES));
+        if(sqes == MAP_FAILED) {
+            die("Failed to map io_uring submission entries: %", Log::sys_error());
+        }
+
+        u8* sq = reinterpret_cast<u8*>(sq_ring);
+        sq_head = reinterpret_cast<u32*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<u32*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<u32*>(sq + params.sq_off.ring_mask);
+        sq_entries = params.sq_entries;
+        sq_array = reinterpret_cast<u32*>(sq + params.sq_off.array);
+
+        u8* cq = reinterpret_cast<u8*>(cq_ring);
+        cq_head = reinterpret_cast<u32*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<u32*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<u32*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    ~Uring() noexcept {
+        if(fd == -1) return;
+        munmap(sqes, sqes_size);
+        if(cq_ring != sq_ring) munmap(cq_ring, cq_size);
+        munmap(sq_ring, sq_size);
+        close(fd);
+        fd = -1;
+    }
+
+    Uring(const Uring&) noexcept = delete;
+    Uring& operator=(const Uring&) noexcept = delete;
+
+    Uring(Uring&&) noexcept = delete;
+    Uring& operator=(Uring&&) noexcept = delete;
+
+    [[nodiscard]] bool ok() const noexcept {
+        return fd != -1;
+    }
+
+    // Queues op followed by the eventfd signal and submits both with one system call.
+    void submit(u8 opcode, i32 file, u64 addr, u32 length, u64 offset, Uring_Op& op,
+                i32 signal) noexcept {
+        Thread::Lock lock(mut);
+
+        u32 tail = *sq_tail;
+        u32 head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        if(tail - head + 2 > sq_entries) {
+            die("io_uring submission queue is full.");
+        }
+
+        io_uring_sqe* sqe = sqe_at(tail++);
+        sqe->opcode = opcode;
+        sqe->flags = IOSQE_IO_HARDLINK;
+        sqe->fd = file;
+        sqe->addr = addr;
+        sqe->len = length;
+        sqe->off = offset;
+        sqe->user_data = reinterpret_cast<u64>(&op);
+
+        sqe = sqe_at(tail++);
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = signal;
+        sqe->addr = reinterpret_cast<u64>(&SIGNAL);
+        sqe->len = sizeof(SIGNAL);
+        sqe->off = 0;
+        sqe->user_data = 0;
+
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+        i64 ret = -1;
+        do {
+            ret = syscall(__NR_io_uring_enter, fd, 2, 0, 0, null, 0);
+        } while(ret == -1 && errno == EINTR);
+        if(ret != 2) {
+            die("Failed to submit to io_uring: %", Log::sys_error());
+        }
+    }
+
+    // Hands every posted completion to its operation.
+    void reap() noexcept {
+        Thread::Lock lock(mut);
+        u32 head = *cq_head;
+        u32 tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        for(; head != tail; head++) {
+            io_uring_cqe& cqe = cqes[head & cq_mask];
+            if(cqe.user_data) {
+                Uring_Op& op = *reinterpret_cast<Uring_Op*>(cqe.user_data);
+                op.result = cqe.res;
+                op.done = true;
+            }
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    [[nodiscard]] bool done(const Uring_Op& op) noexcept {
+        Thread::Lock lock(mut);
+        return op.done;
+    }
+
+private:
+    [[nodiscard]] io_uring_sqe* sqe_at(u32 tail) noexcept {
+        u32 idx = tail & sq_mask;
+        io_uring_sqe* sqe = &sqes[idx];
+        Libc::memset(sqe, 0, sizeof(io_uring_sqe));
+        sq_array[idx] = idx;
+        return sqe;
+    }
+
+    constexpr static u32 ENTRIES = 256;
+    constexpr static u64 SIGNAL = 1;
+
+    i32 fd = -1;
+    Thread::Mutex mut;
+
+    void* sq_ring = null;
+    void* cq_ring = null;
+    u64 sq_size = 0;
+    u64 cq_size = 0;
+    u64 sqes_size = 0;
+
+    u32* sq_head = null;
+    u32* sq_tail = null;
+    u32* sq_array = null;
+    u32 sq_mask = 0;
+    u32 sq_entries = 0;
+    io_uring_sqe* sqes = null;
+
+    u32* cq_head = null;
+    u32* cq_tail = null;
+    u32 cq_mask = 0;
+    io_uring_cqe* cqes = null;
+};
+
+[[nodiscard]] static Uring& uring() noexcept {
+    static Uring ring;
+    return ring;
+}
+
+// Runs one read or write at offset through the ring, returning the byte count or -errno.
+[[nodiscard]] static Task<i64> uring_io(Pool<>& pool, u8 opcode, i32 fd, u64 addr, u64 length,
+                                        u64 offset) noexcept {
+    i32 signal = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if(signal == -1) {
+        die("Failed to create event: %", Log::sys_error());
+    }
+
+    Uring_Op op;
+    u32 chunk = static_cast<u32>(Math::min<u64>(length, RPP_INT32_MAX));
+    uring().submit(opcode, fd, addr, chunk, offset, op, signal);
+
+    co_await pool.event(Event::of_sys(signal, EPOLLIN));
+
+    uring().reap();
+    assert(uring().done(op));
+    co_return static_cast<i64>(op.result);
+}
+
+// Loops over short transfers until length bytes are moved or the file ends.
+[[nodiscard]] static Task<Opt<u64>> transfer(Pool<>& pool, u8 opcode, i32 fd, u8* data,
+                                             u64 length, u64 offset) noexcept {
+    u64 done = 0;
+    while(done < length) {
+        i64 ret = 0;
+        if(uring().ok()) {
+            ret = co_await uring_io(pool, opcode, fd, reinterpret_cast<u64>(data + done),
+                                    length - done, offset + done);
+            if(ret < 0) errno = static_cast<int>(-ret);
+        } else if(opcode == IORING_OP_READ) {
+            ret = pread(fd, data + done, length - done, static_cast<off_t>(offset + done));
+        } else {
+            ret = pwrite(fd, data + done, length - done, static_cast<off_t>(offset + done));
+        }
+        if(ret < 0) {
+            if(errno == EINTR) continue;
+            co_return {};
+        }
+        if(ret == 0) break;
+        done += static_cast<u64>(ret);
+    }
+    co_return Opt{done};
+}
+
 [[nodiscard]] Task<Opt<Vec<u8, Files::Alloc>>> read(Pool<>& pool, String_View path_) noexcept {
 
     int fd = -1;
     Region(R) {
         auto path = path_.terminate<Mregion<R>>();
-        fd = open(reinterpret_cast<const char*>(path.data()), O_RDONLY);
+        fd = open(reinterpret_cast<const char*>(path.data()), O_RDONLY | O_CLOEXEC);
     }
 
     if(fd == -1) {
@@ -25,61 +257,76 @@ namespace rpp::Async {
         co_return {};
     }
 
-    off_t full_size = lseek(fd, 0, SEEK_END);
-    lseek(fd, 0, SEEK_SET);
+    struct stat info;
+    if(fstat(fd, &info) == -1) {
+        warn("Failed to stat file %: %", path_, Log::sys_error());
+        close(fd);
+        co_return {};
+    }
 
-    assert(full_size <= UINT32_MAX);
+    u64 full_size = static_cast<u64>(info.st_size);
+    Vec<u8, Files::Alloc> data(full_size);
+    data.resize(full_size);
 
-    Vec<u8, Files::Alloc> data(static_cast<u64>(full_size));
-    data.resize(static_cast<u64>(full_size));
+    Opt<u64> size = co_await transfer(pool, IORING_OP_READ, fd, data.data(), full_size, 0);
+    close(fd);
 
-    if(::read(fd, data.data(), full_size) == -1) {
+    if(!size.ok()) {
         warn("Failed to read file %: %", path_, Log::sys_error());
         co_return {};
     }
 
-    close(fd);
+    data.resize(*size);
     co_return Opt{rpp::move(data)};
 }
 
-[[nodiscard]] Task<bool> write(Pool<>& pool, String_View path_, Slice<u8> data) noexcept {
+[[nodiscard]] Task<Opt<u64>> read(Pool<>& pool, String_View path_, u64 offset, u8* data,
+                                  u64 length) noexcept {
 
     int fd = -1;
     Region(R) {
         auto path = path_.terminate<Mregion<R>>();
-        fd = open(reinterpret_cast<const char*>(path.data()), O_WRONLY | O_CREAT | O_TRUNC);
+        fd = open(reinterpret_cast<const char*>(path.data()), O_RDONLY | O_CLOEXEC);
     }
 
     if(fd == -1) {
-        warn("Failed to create file %: %", path_, Log::sys_error());
-        co_return false;
-    }
-
-    if(::write(fd, data.data(), data.length()) == -1) {
-        warn("Failed to write file %: %", path_, Log::sys_error());
-        co_return false;
+        warn("Failed to open file %: %", path_, Log::sys_error());
+        co_return {};
     }
 
+    Opt<u64> size = co_await transfer(pool, IORING_OP_READ, fd, data, length, offset);
     close(fd);
-    co_return true;
+
+    if(!size.ok()) {
+        warn("Failed to read file %: %", path_, Log::sys_error());
+    }
+    co_return size;
 }
 
-[[nodiscard]] Task<void> wait(Pool<>& pool, u64 ms) noexcept {
+[[nodiscard]] Task<bool> write(Pool<>& pool, String_View path_, Slice<u8> data) noexcept {
+
+    int fd = -1;
+    Region(R) {
+        auto path = path_.terminate<Mregion<R>>();
+        fd = open(reinterpret_cast<const char*>(path.data()),
+                  O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    }
 
-    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
     if(fd == -1) {
-        die("Failed to create timerfd: %", Log::sys_error());
+        warn("Failed to create file %: %", path_, Log::sys_error());
+        co_return false;
     }
 
-    itimerspec spec = {};
-    spec.it_value.tv_sec = ms / 1000;
-    spec.it_value.tv_nsec = (ms % 1000) * 1000000;
+    // The ring only reads from the buffer.
+    u8* bytes = const_cast<u8*>(data.data());
+    Opt<u64> size = co_await transfer(pool, IORING_OP_WRITE, fd, bytes, data.length(), 0);
+    close(fd);
 
-    if(timerfd_settime(fd, 0, &spec, null) == -1) {
-        die("Failed to set timerfd: %", Log::sys_error());
+    if(!size.ok() || *size != data.length()) {
+        warn("Failed to write file %: %", path_, Log::sys_error());
+        co_return false;
     }
-
-    co_await pool.event(Async::Event::of_sys(fd, EPOLLIN));
+    co_return true;
 }
 
 } // namespace rpp::Async
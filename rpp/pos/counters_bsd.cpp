@@ -0,0 +1,67 @@
+
+#include <dlfcn.h>
+
+namespace rpp {
+
+// kperf is a private framework, so it is loaded at runtime. Only the fixed counters are read:
+// the configurable ones need the CPU's event database, and cache and branch misses stay zero.
+constexpr u32 KPC_CLASS_FIXED_MASK = 1;
+constexpr u32 KPC_MAX_COUNTERS = 32;
+
+struct Kperf {
+    i32 (*force_all_ctrs_set)(i32) = null;
+    i32 (*set_counting)(u32) = null;
+    i32 (*set_thread_counting)(u32) = null;
+    u32 (*get_counter_count)(u32) = null;
+    i32 (*get_thread_counters)(u32, u32, u64*) = null;
+    u32 fixed = 0;
+};
+
+[[nodiscard]] static Kperf load_kperf() noexcept {
+    Kperf k;
+    void* lib = dlopen("/System/Library/PrivateFrameworks/kperf.framework/kperf", RTLD_LAZY);
+    if(!lib) return k;
+    k.force_all_ctrs_set = reinterpret_cast<i32 (*)(i32)>(dlsym(lib, "kpc_force_all_ctrs_set"));
+    k.set_counting = reinterpret_cast<i32 (*)(u32)>(dlsym(lib, "kpc_set_counting"));
+    k.set_thread_counting = reinterpret_cast<i32 (*)(u32)>(dlsym(lib, "kpc_set_thread_counting"));
+    k.get_counter_count = reinterpret_cast<u32 (*)(u32)>(dlsym(lib, "kpc_get_counter_count"));
+    k.get_thread_counters =
+        reinterpret_cast<i32 (*)(u32, u32, u64*)>(dlsym(lib, "kpc_get_thread_counters"));
+    if(k.get_counter_count) {
+        k.fixed = Math::min(k.get_counter_count(KPC_CLASS_FIXED_MASK), KPC_MAX_COUNTERS);
+    }
+    return k;
+}
+
+[[nodiscard]] static const Kperf& kperf() noexcept {
+    static const Kperf k = load_kperf();
+    return k;
+}
+
+[[nodiscard]] bool Profile::open_counters() noexcept {
+    // Without kperf, or without root, counters quietly stay zero.
+    const Kperf& k = kperf();
+    if(!k.force_all_ctrs_set || !k.set_counting || !k.set_thread_counting ||
+       !k.get_thread_counters || k.fixed < 2) {
+        return false;
+    }
+    return !k.force_all_ctrs_set(1) && !k.set_counting(KPC_CLASS_FIXED_MASK) &&
+           !k.set_thread_counting(KPC_CLASS_FIXED_MASK);
+}
+
+void Profile::close_counters() noexcept {
+}
+
+[[nodiscard]] Profile::Counters Profile::read_counters() noexcept {
+    const Kperf& k = kperf();
+    u64 values[KPC_MAX_COUNTERS] = {};
+    if(k.get_thread_counters(0, k.fixed, values)) return Counters{};
+    // Apple cores count cycles first, while x64 counts instructions retired first.
+#ifdef RPP_ARCH_ARM64
+    return Counters{values[0], values[1], 0, 0};
+#else
+    return Counters{values[1], values[0], 0, 0};
+#endif
+}
+
+} // namespace rpp
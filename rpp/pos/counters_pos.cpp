@@ -0,0 +1,62 @@
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace rpp {
+
+constexpr u64 COUNTERS = 4;
+
+// The first counter leads the group, so one read returns every counter that could be opened.
+static thread_local i32 g_counter_fds[COUNTERS] = {-1, -1, -1, -1};
+
+[[nodiscard]] static i32 open_counter(u64 config, i32 leader) noexcept {
+    struct perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = leader == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<i32>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+}
+
+[[nodiscard]] bool Profile::open_counters() noexcept {
+    constexpr u64 configs[COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                       PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    // Without a PMU, or when perf_event_paranoid forbids it, counters quietly stay zero.
+    i32 leader = open_counter(configs[0], -1);
+    if(leader == -1) return false;
+    g_counter_fds[0] = leader;
+    for(u64 i = 1; i < COUNTERS; i++) g_counter_fds[i] = open_counter(configs[i], leader);
+
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void Profile::close_counters() noexcept {
+    // Followers first, so the group is never left without its leader.
+    for(u64 i = COUNTERS; i > 0; i--) {
+        if(g_counter_fds[i - 1] != -1) close(g_counter_fds[i - 1]);
+        g_counter_fds[i - 1] = -1;
+    }
+}
+
+[[nodiscard]] Profile::Counters Profile::read_counters() noexcept {
+    struct {
+        u64 count;
+        u64 values[COUNTERS];
+    } group = {};
+    if(read(g_counter_fds[0], &group, sizeof(group)) <= 0) return Counters{};
+
+    u64 values[COUNTERS] = {};
+    for(u64 i = 0, next = 0; i < COUNTERS && next < group.count; i++) {
+        if(g_counter_fds[i] != -1) values[i] = group.values[next++];
+    }
+    return Counters{values[0], values[1], values[2], values[3]};
+}
+
+} // namespace rpp
@@ -1,48 +1,248 @@
 
 #include "../files.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace rpp::Files {
 
-[[nodiscard]] Opt<Vec<u8, Alloc>> read(String_View path_) noexcept {
-
+[[nodiscard]] static int open_read(String_View path_) noexcept {
     int fd = -1;
     Region(R) {
         auto path = path_.terminate<Mregion<R>>();
-        fd = open(reinterpret_cast<const char*>(path.data()), O_RDONLY);
+        fd = open(reinterpret_cast<const char*>(path.data()), O_RDONLY | O_CLOEXEC);
     }
-
     if(fd == -1) {
         warn("Failed to open file %: %", path_, Log::sys_error());
-        return {};
     }
+    return fd;
+}
 
-    off_t full_size = lseek(fd, 0, SEEK_END);
-    lseek(fd, 0, SEEK_SET);
+// A single read may return fewer bytes than asked for, so keep going until EOF.
+[[nodiscard]] static Opt<u64> read_at(int fd, u64 offset, u8* data, u64 length) noexcept {
+    u64 done = 0;
+    while(done < length) {
+        ssize_t ret = pread(fd, data + done, length - done, static_cast<off_t>(offset + done));
+        if(ret == -1) {
+            if(errno == EINTR) continue;
+            return {};
+        }
+        if(ret == 0) break;
+        done += static_cast<u64>(ret);
+    }
+    return Opt{done};
+}
 
-    assert(full_size <= RPP_UINT32_MAX);
+[[nodiscard]] Opt<Vec<u8, Alloc>> read(String_View path_) noexcept {
 
-    Vec<u8, Alloc> data(static_cast<u64>(full_size));
-    data.resize(static_cast<u64>(full_size));
+    int fd = open_read(path_);
+    if(fd == -1) return {};
 
-    if(::read(fd, data.data(), full_size) == -1) {
+    struct stat info;
+    if(fstat(fd, &info) == -1) {
+        warn("Failed to stat file %: %", path_, Log::sys_error());
+        close(fd);
+        return {};
+    }
+
+    u64 full_size = static_cast<u64>(info.st_size);
+    Vec<u8, Alloc> data(full_size);
+    data.resize(full_size);
+
+    Opt<u64> size = read_at(fd, 0, data.data(), full_size);
+    if(!size.ok()) {
         warn("Failed to read file %: %", path_, Log::sys_error());
+        close(fd);
         return {};
     }
 
     close(fd);
+    data.resize(*size);
     return Opt{rpp::move(data)};
 }
 
+[[nodiscard]] Opt<u64> read(String_View path_, u64 offset, u8* data, u64 length) noexcept {
+
+    int fd = open_read(path_);
+    if(fd == -1) return {};
+
+    Opt<u64> size = read_at(fd, offset, data, length);
+    if(!size.ok()) {
+        warn("Failed to read file %: %", path_, Log::sys_error());
+    }
+
+    close(fd);
+    return size;
+}
+
+[[nodiscard]] Opt<Reader> Reader::open(String_View path_) noexcept {
+
+    int fd = open_read(path_);
+    if(fd == -1) return {};
+
+    struct stat info;
+    if(fstat(fd, &info) == -1) {
+        warn("Failed to stat file %: %", path_, Log::sys_error());
+        close(fd);
+        return {};
+    }
+
+    Reader reader;
+    reader.fd = fd;
+    reader.size_ = static_cast<u64>(info.st_size);
+    return Opt{rpp::move(reader)};
+}
+
+Reader::~Reader() noexcept {
+    if(fd != -1) close(fd);
+    fd = -1;
+    size_ = 0;
+    offset_ = 0;
+}
+
+Reader::Reader(Reader&& src) noexcept : fd{src.fd}, size_{src.size_}, offset_{src.offset_} {
+    src.fd = -1;
+    src.size_ = 0;
+    src.offset_ = 0;
+}
+
+Reader& Reader::operator=(Reader&& src) noexcept {
+    this->~Reader();
+    fd = src.fd;
+    size_ = src.size_;
+    offset_ = src.offset_;
+    src.fd = -1;
+    src.size_ = 0;
+    src.offset_ = 0;
+    return *this;
+}
+
+[[nodiscard]] Opt<Slice<u8>> Reader::next(u8* data, u64 length) noexcept {
+    assert(fd != -1);
+    Opt<u64> size = read_at(fd, offset_, data, length);
+    if(!size.ok()) {
+        warn("Failed to read file: %", Log::sys_error());
+        return {};
+    }
+    offset_ += *size;
+    return Opt{Slice<u8>{data, *size}};
+}
+
+[[nodiscard]] Opt<Mapping> Mapping::open(String_View path_, Access access) noexcept {
+
+    int fd = open_read(path_);
+    if(fd == -1) return {};
+
+    struct stat info;
+    if(fstat(fd, &info) == -1) {
+        warn("Failed to stat file %: %", path_, Log::sys_error());
+        close(fd);
+        return {};
+    }
+
+    Mapping mapping;
+    mapping.access_ = access;
+    mapping.length_ = static_cast<u64>(info.st_size);
+
+    // Empty files can't be mapped.
+    if(mapping.length_ == 0) {
+        close(fd);
+        return Opt{rpp::move(mapping)};
+    }
+
+    int prot = access == Access::read ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* data = mmap(null, mapping.length_, prot, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(data == MAP_FAILED) {
+        warn("Failed to map file %: %", path_, Log::sys_error());
+        return {};
+    }
+
+    mapping.data_ = reinterpret_cast<u8*>(data);
+    return Opt{rpp::move(mapping)};
+}
+
+Mapping::~Mapping() noexcept {
+    if(data_) {
+        int ret = munmap(data_, length_);
+        assert(ret == 0);
+    }
+    data_ = null;
+    length_ = 0;
+}
+
+Mapping::Mapping(Mapping&& src) noexcept
+    : data_{src.data_}, length_{src.length_}, access_{src.access_} {
+    src.data_ = null;
+    src.length_ = 0;
+}
+
+Mapping& Mapping::operator=(Mapping&& src) noexcept {
+    this->~Mapping();
+    data_ = src.data_;
+    length_ = src.length_;
+    access_ = src.access_;
+    src.data_ = null;
+    src.length_ = 0;
+    return *this;
+}
+
+void Mapping::advise(Advice advice) noexcept {
+    if(!data_) return;
+    int flag = MADV_NORMAL;
+    switch(advice) {
+    case Advice::normal: {
+        flag = MADV_NORMAL;
+    } break;
+    case Advice::sequential: {
+        flag = MADV_SEQUENTIAL;
+    } break;
+    case Advice::random: {
+        flag = MADV_RANDOM;
+    } break;
+    case Advice::will_need: {
+        flag = MADV_WILLNEED;
+    } break;
+    case Advice::dont_need: {
+        flag = MADV_DONTNEED;
+    } break;
+    }
+    if(madvise(data_, length_, flag) == -1) {
+        warn("Failed to advise mapping: %", Log::sys_error());
+    }
+}
+
+void Mapping::prefetch(u64 offset, u64 length) noexcept {
+    if(!data_ || offset >= length_) return;
+    length = Math::min(length, length_ - offset);
+
+    // madvise wants a page aligned start.
+    u64 page = static_cast<u64>(sysconf(_SC_PAGESIZE));
+    u64 start = offset & ~(page - 1);
+    if(madvise(data_ + start, length + (offset - start), MADV_WILLNEED) == -1) {
+        warn("Failed to prefetch mapping: %", Log::sys_error());
+    }
+}
+
+// Buffers passed to one writev call, well below any IOV_MAX.
+constexpr u64 WRITE_BATCH = 64;
+
 [[nodiscard]] bool write(String_View path_, Slice<u8> data) noexcept {
+    return write(path_, Slice<Slice<u8>>{&data, 1});
+}
+
+[[nodiscard]] bool write(String_View path_, Slice<Slice<u8>> buffers) noexcept {
 
     int fd = -1;
     Region(R) {
         auto path = path_.terminate<Mregion<R>>();
-        fd = open(reinterpret_cast<const char*>(path.data()), O_RDONLY);
+        fd = open(reinterpret_cast<const char*>(path.data()),
+                  O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
     }
 
     if(fd == -1) {
@@ -50,9 +250,29 @@ namespace rpp::Files {
         return false;
     }
 
-    if(::write(fd, data.data(), data.length()) == -1) {
-        warn("Failed to write file %: %", path_, Log::sys_error());
-        return false;
+    // A write may stop anywhere, so offset is how much of buffers[i] is already written.
+    u64 i = 0;
+    u64 offset = 0;
+    while(i < buffers.length()) {
+        iovec iovs[WRITE_BATCH];
+        u64 n = 0;
+        for(u64 j = i; j < buffers.length() && n < WRITE_BATCH; j++, n++) {
+            u64 skip = j == i ? offset : 0;
+            iovs[n].iov_base = const_cast<u8*>(buffers[j].data() + skip);
+            iovs[n].iov_len = buffers[j].length() - skip;
+        }
+        ssize_t ret = writev(fd, iovs, static_cast<int>(n));
+        if(ret == -1) {
+            if(errno == EINTR) continue;
+            warn("Failed to write file %: %", path_, Log::sys_error());
+            close(fd);
+            return false;
+        }
+        offset += static_cast<u64>(ret);
+        while(i < buffers.length() && offset >= buffers[i].length()) {
+            offset -= buffers[i].length();
+            i++;
+        }
     }
 
     close(fd);
@@ -72,6 +292,17 @@ namespace rpp::Files {
     }
 }
 
+[[nodiscard]] bool remove(String_View path_) noexcept {
+    Region(R) {
+        auto path = path_.terminate<Mregion<R>>();
+        if(unlink(reinterpret_cast<const char*>(path.data()))) {
+            warn("Failed to remove file %: %", path_, Log::sys_error());
+            return false;
+        }
+        return true;
+    }
+}
+
 [[nodiscard]] bool before(const File_Time& first, const File_Time& second) noexcept {
     return first < second;
 }
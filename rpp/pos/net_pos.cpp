@@ -1,35 +1,122 @@
 
+#include "../async.h"
 #include "../net.h"
 
 #include <arpa/inet.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <netinet/udp.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#ifdef RPP_OS_LINUX
+#include <linux/filter.h>
+#include <sys/epoll.h>
+#else
+#include <sys/event.h>
+#endif
+
+#if defined RPP_OS_LINUX && !defined UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+#if defined RPP_OS_LINUX && !defined SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+
 namespace rpp::Net {
 
 Address::Address(String_View address, u16 port) noexcept {
-    sockaddr_ = {};
-    sockaddr_.sin_family = AF_INET;
-    sockaddr_.sin_port = htons(port);
+    Libc::memset(&sockaddr_, 0, sizeof(sockaddr_));
+
+    char text[INET6_ADDRSTRLEN] = {};
+    if(address.length() >= sizeof(text)) {
+        die("Failed to create address: % is too long.", address);
+    }
+    Libc::memcpy(text, address.data(), address.length());
+
+    bool ipv6 = false;
+    for(u8 c : address) ipv6 = ipv6 || c == ':';
 
-    if(inet_pton(AF_INET, reinterpret_cast<const char*>(address.data()),
-                 &sockaddr_.sin_addr.s_addr) != 1) {
+    i32 ret = 0;
+    if(ipv6) {
+        sockaddr_.v6.sin6_family = AF_INET6;
+        sockaddr_.v6.sin6_port = htons(port);
+        ret = inet_pton(AF_INET6, text, &sockaddr_.v6.sin6_addr);
+    } else {
+        sockaddr_.v4.sin_family = AF_INET;
+        sockaddr_.v4.sin_port = htons(port);
+        ret = inet_pton(AF_INET, text, &sockaddr_.v4.sin_addr.s_addr);
+    }
+    if(ret != 1) {
         die("Failed to create address: %", Log::sys_error());
     }
 }
 
-Address::Address(u16 port) noexcept {
-    sockaddr_ = {};
-    sockaddr_.sin_family = AF_INET;
-    sockaddr_.sin_port = htons(port);
-    sockaddr_.sin_addr.s_addr = INADDR_ANY;
+Address::Address(u16 port, Family family) noexcept {
+    Libc::memset(&sockaddr_, 0, sizeof(sockaddr_));
+    if(family == Family::ipv6) {
+        sockaddr_.v6.sin6_family = AF_INET6;
+        sockaddr_.v6.sin6_port = htons(port);
+        sockaddr_.v6.sin6_addr = in6addr_any;
+    } else {
+        sockaddr_.v4.sin_family = AF_INET;
+        sockaddr_.v4.sin_port = htons(port);
+        sockaddr_.v4.sin_addr.s_addr = INADDR_ANY;
+    }
 }
 
-Udp::Udp() noexcept {
-    fd = socket(AF_INET, SOCK_DGRAM, 0);
+[[nodiscard]] Family Address::family() const noexcept {
+    return sockaddr_.v4.sin_family == AF_INET6 ? Family::ipv6 : Family::ipv4;
+}
+
+[[nodiscard]] u16 Address::port() const noexcept {
+    return ntohs(family() == Family::ipv6 ? sockaddr_.v6.sin6_port : sockaddr_.v4.sin_port);
+}
+
+[[nodiscard]] bool Address::operator==(const Address& other) const noexcept {
+    if(family() != other.family() || port() != other.port()) return false;
+    if(family() == Family::ipv6) {
+        return sockaddr_.v6.sin6_scope_id == other.sockaddr_.v6.sin6_scope_id &&
+               Libc::memcmp(&sockaddr_.v6.sin6_addr, &other.sockaddr_.v6.sin6_addr,
+                            sizeof(in6_addr)) == 0;
+    }
+    return sockaddr_.v4.sin_addr.s_addr == other.sockaddr_.v4.sin_addr.s_addr;
+}
+
+[[nodiscard]] u32 Address::length() const noexcept {
+    return family() == Family::ipv6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+}
+
+[[nodiscard]] Address Address::to_ipv6() const noexcept {
+    if(family() == Family::ipv6) return *this;
+    Address mapped;
+    Libc::memset(&mapped.sockaddr_, 0, sizeof(mapped.sockaddr_));
+    mapped.sockaddr_.v6.sin6_family = AF_INET6;
+    mapped.sockaddr_.v6.sin6_port = sockaddr_.v4.sin_port;
+    u8* bytes = mapped.sockaddr_.v6.sin6_addr.s6_addr;
+    bytes[10] = 0xff;
+    bytes[11] = 0xff;
+    Libc::memcpy(bytes + 12, &sockaddr_.v4.sin_addr.s_addr, 4);
+    return mapped;
+}
+
+[[nodiscard]] static i32 open_udp(Family family) noexcept {
+    i32 fd = socket(family == Family::ipv6 ? AF_INET6 : AF_INET, SOCK_DGRAM, 0);
     if(fd < 0) {
         die("Failed to open socket: %", Log::sys_error());
     }
+    if(family == Family::ipv6) {
+        i32 zero = 0;
+        if(setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero)) == -1) {
+            warn("Failed to clear IPV6_V6ONLY: %", Log::sys_error());
+        }
+    }
+    return fd;
+}
+
+Udp::Udp(Family family) noexcept : fd{open_udp(family)}, family{family} {
 }
 
 Udp::~Udp() noexcept {
@@ -41,16 +128,25 @@ Udp::~Udp() noexcept {
 Udp::Udp(Udp&& src) noexcept {
     fd = src.fd;
     src.fd = -1;
+    family = src.family;
+#ifdef RPP_OS_LINUX
+    gso = src.gso;
+#endif
 }
 
 Udp& Udp::operator=(Udp&& src) noexcept {
     fd = src.fd;
     src.fd = -1;
+    family = src.family;
+#ifdef RPP_OS_LINUX
+    gso = src.gso;
+#endif
     return *this;
 }
 
 void Udp::bind(Address address) noexcept {
-    if(::bind(fd, reinterpret_cast<const sockaddr*>(&address.sockaddr_), sizeof(sockaddr_in)) < 0) {
+    address = target(address);
+    if(::bind(fd, reinterpret_cast<const sockaddr*>(&address.sockaddr_), address.length()) < 0) {
         die("Failed to bind socket: %", Log::sys_error());
     }
 }
@@ -72,12 +168,483 @@ void Udp::bind(Address address) noexcept {
 
 [[nodiscard]] u64 Udp::send(Address address, const Packet& out, u64 length) noexcept {
 
+    address = target(address);
     i64 ret = ::sendto(fd, out.data(), length, 0,
-                       reinterpret_cast<const sockaddr*>(&address.sockaddr_), sizeof(sockaddr_in));
+                       reinterpret_cast<const sockaddr*>(&address.sockaddr_), address.length());
     if(ret == -1) {
         die("Failed send packet: %", Log::sys_error());
     }
     return ret;
 }
 
+[[nodiscard]] Opt<u64> Udp::try_send(Address address, const Packet& out, u64 length) noexcept {
+    address = target(address);
+    for(;;) {
+        i64 ret = ::sendto(fd, out.data(), length, MSG_DONTWAIT,
+                           reinterpret_cast<const sockaddr*>(&address.sockaddr_),
+                           address.length());
+        if(ret != -1) return Opt{static_cast<u64>(ret)};
+        if(errno == EINTR) continue;
+        if(errno == EAGAIN || errno == EWOULDBLOCK) return {};
+        die("Failed send packet: %", Log::sys_error());
+    }
+}
+
+// The pool closes events once they fire, so each one gets a duplicate of the socket.
+[[nodiscard]] static i32 dup_socket(i32 fd) noexcept {
+    i32 event = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if(event == -1) {
+        die("Failed to duplicate socket: %", Log::sys_error());
+    }
+    return event;
+}
+
+#ifdef RPP_OS_LINUX
+
+[[nodiscard]] Async::Event Udp::readable() const noexcept {
+    return Async::Event::of_sys(dup_socket(fd), EPOLLIN);
+}
+
+[[nodiscard]] Async::Event Udp::writable() const noexcept {
+    return Async::Event::of_sys(dup_socket(fd), EPOLLOUT);
+}
+
+#else
+
+[[nodiscard]] Async::Event Udp::readable() const noexcept {
+    return Async::Event::of_sys(dup_socket(fd), EVFILT_READ);
+}
+
+[[nodiscard]] Async::Event Udp::writable() const noexcept {
+    return Async::Event::of_sys(dup_socket(fd), EVFILT_WRITE);
+}
+
+#endif
+
+#ifdef RPP_OS_LINUX
+
+constexpr u64 MMSG_BATCH = 64;
+constexpr u64 GSO_SEGMENTS = 64;
+constexpr u64 GSO_BYTES = 65000;
+
+[[nodiscard]] u64 Udp::send(Slice<Packet> out, Slice<Message> messages) noexcept {
+    assert(out.length() == messages.length());
+
+    u64 count = out.length();
+    u64 sent = 0;
+
+    while(sent < count) {
+        // Equally sized packets to one address go out as a single segmented datagram.
+        u64 length = messages[sent].length;
+        u64 run = 1;
+        if(gso && length > 0) {
+            u64 max_run = Math::min(GSO_SEGMENTS, GSO_BYTES / length);
+            while(sent + run < count && run < max_run && messages[sent + run].length == length &&
+                  messages[sent + run].to == messages[sent].to) {
+                run++;
+            }
+        }
+
+        if(run > 1) {
+            iovec iovs[GSO_SEGMENTS];
+            for(u64 i = 0; i < run; i++) {
+                iovs[i].iov_base = const_cast<u8*>(out[sent + i].data());
+                iovs[i].iov_len = length;
+            }
+
+            Address to = target(messages[sent].to);
+            alignas(cmsghdr) u8 control[CMSG_SPACE(sizeof(u16))] = {};
+            msghdr msg = {};
+            msg.msg_name = &to.sockaddr_;
+            msg.msg_namelen = to.length();
+            msg.msg_iov = iovs;
+            msg.msg_iovlen = run;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = IPPROTO_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(u16));
+            u16 segment = static_cast<u16>(length);
+            Libc::memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+
+            if(sendmsg(fd, &msg, 0) != -1) {
+                sent += run;
+                continue;
+            }
+            if(errno == EINTR) continue;
+            if(errno != EIO && errno != EINVAL && errno != ENOPROTOOPT && errno != EOPNOTSUPP) {
+                die("Failed send packets: %", Log::sys_error());
+            }
+            // No offload on this kernel or device, fall back to one datagram per packet.
+            gso = false;
+        }
+
+        // Send singles up to the start of the next run that could be coalesced.
+        u64 n = 0;
+        while(sent + n < count && n < MMSG_BATCH) {
+            u64 i = sent + n;
+            n++;
+            if(gso && i + 1 < count && messages[i].length > 0 &&
+               messages[i + 1].length == messages[i].length &&
+               messages[i + 1].to == messages[i].to) {
+                if(n > 1) n--;
+                break;
+            }
+        }
+
+        mmsghdr msgs[MMSG_BATCH] = {};
+        iovec iovs[MMSG_BATCH];
+        Address to[MMSG_BATCH];
+        for(u64 i = 0; i < n; i++) {
+            iovs[i].iov_base = const_cast<u8*>(out[sent + i].data());
+            iovs[i].iov_len = messages[sent + i].length;
+            to[i] = target(messages[sent + i].to);
+            msgs[i].msg_hdr.msg_name = &to[i].sockaddr_;
+            msgs[i].msg_hdr.msg_namelen = to[i].length();
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int ret = sendmmsg(fd, msgs, static_cast<u32>(n), 0);
+        if(ret == -1) {
+            if(errno == EINTR) continue;
+            die("Failed send packets: %", Log::sys_error());
+        }
+        sent += static_cast<u64>(ret);
+    }
+    return sent;
+}
+
+[[nodiscard]] u64 Udp::recv(Packet* in, Data* data, u64 count) noexcept {
+    u64 received = 0;
+
+    while(received < count) {
+        u64 n = Math::min(count - received, MMSG_BATCH);
+
+        mmsghdr msgs[MMSG_BATCH] = {};
+        iovec iovs[MMSG_BATCH];
+        for(u64 i = 0; i < n; i++) {
+            iovs[i].iov_base = in[received + i].data();
+            iovs[i].iov_len = Packet::capacity;
+            msgs[i].msg_hdr.msg_name = &data[received + i].from.sockaddr_;
+            msgs[i].msg_hdr.msg_namelen = sizeof(data[received + i].from.sockaddr_);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int ret = recvmmsg(fd, msgs, static_cast<u32>(n), MSG_DONTWAIT, null);
+        if(ret == -1) {
+            if(errno == EINTR) continue;
+            if(errno == EAGAIN || errno == EWOULDBLOCK) break;
+            die("Failed to receive packets: %", Log::sys_error());
+        }
+
+        for(i32 i = 0; i < ret; i++) {
+            data[received + i].length = msgs[i].msg_len;
+        }
+        received += static_cast<u64>(ret);
+        if(static_cast<u64>(ret) < n) break;
+    }
+    return received;
+}
+
+#else
+
+[[nodiscard]] u64 Udp::send(Slice<Packet> out, Slice<Message> messages) noexcept {
+    assert(out.length() == messages.length());
+    for(u64 i = 0; i < out.length(); i++) {
+        static_cast<void>(send(messages[i].to, out[i], messages[i].length));
+    }
+    return out.length();
+}
+
+[[nodiscard]] u64 Udp::recv(Packet* in, Data* data, u64 count) noexcept {
+    u64 received = 0;
+    for(; received < count; received++) {
+        Opt<Data> next = recv(in[received]);
+        if(!next.ok()) break;
+        data[received] = rpp::move(*next);
+    }
+    return received;
+}
+
+#endif
+
+#ifdef RPP_OS_LINUX
+
+// Sends each datagram to the socket at index CPU % count: load the CPU, take the remainder and
+// return it.
+static void steer_by_cpu(i32 fd, u64 count) noexcept {
+    sock_filter code[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<u32>(SKF_AD_OFF + SKF_AD_CPU)},
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<u32>(count)},
+        {BPF_RET | BPF_A, 0, 0, 0},
+    };
+    sock_fprog program = {3, code};
+    if(setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) == -1) {
+        warn("Failed to attach reuseport program: %", Log::sys_error());
+    }
+}
+
+Udp_Group::Udp_Group(Address address, u64 count, bool steer) noexcept {
+    assert(count > 0);
+    sockets.reserve(count);
+    for(u64 i = 0; i < count; i++) {
+        Udp& udp = sockets.push(Udp{address.family()});
+        i32 one = 1;
+        if(setsockopt(udp.fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == -1) {
+            die("Failed to set SO_REUSEPORT: %", Log::sys_error());
+        }
+        udp.bind(address);
+        if(i == 0 && address.port() == 0) {
+            // The rest of the group joins the port the kernel picked.
+            socklen_t length = sizeof(address.sockaddr_);
+            if(getsockname(udp.fd, reinterpret_cast<sockaddr*>(&address.sockaddr_), &length) ==
+               -1) {
+                die("Failed to query socket address: %", Log::sys_error());
+            }
+        }
+    }
+    if(steer && count > 1) steer_by_cpu(sockets[0].fd, count);
+}
+
+#else
+
+Udp_Group::Udp_Group(Address address, u64 count, bool) noexcept {
+    assert(count > 0);
+    sockets.push(Udp{address.family()}).bind(address);
+}
+
+#endif
+
+constexpr u64 IOV_BATCH = 64;
+
+#ifdef RPP_OS_LINUX
+constexpr i32 SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr i32 SEND_FLAGS = 0;
+#endif
+
+[[nodiscard]] static bool set_nonblocking(i32 fd) noexcept {
+    i32 flags = fcntl(fd, F_GETFL, 0);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+[[nodiscard]] static i32 open_tcp(Family family) noexcept {
+    i32 fd = socket(family == Family::ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM, 0);
+    if(fd < 0) return -1;
+    if(!set_nonblocking(fd) || fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+        close(fd);
+        return -1;
+    }
+#ifdef RPP_OS_MACOS
+    // There is no MSG_NOSIGNAL, so suppress SIGPIPE on the socket itself.
+    i32 one = 1;
+    static_cast<void>(setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one)));
+#endif
+    return fd;
+}
+
+Tcp_Stream::~Tcp_Stream() noexcept {
+    if(fd != -1) {
+        close(fd);
+    }
+    fd = -1;
+}
+
+Tcp_Stream::Tcp_Stream(Tcp_Stream&& src) noexcept {
+    fd = src.fd;
+    src.fd = -1;
+}
+
+Tcp_Stream& Tcp_Stream::operator=(Tcp_Stream&& src) noexcept {
+    if(fd != -1) close(fd);
+    fd = src.fd;
+    src.fd = -1;
+    return *this;
+}
+
+[[nodiscard]] Opt<Tcp_Stream> Tcp_Stream::connect(Address address) noexcept {
+    Tcp_Stream stream;
+    stream.fd = open_tcp(address.family());
+    if(stream.fd == -1) {
+        warn("Failed to open socket: %", Log::sys_error());
+        return {};
+    }
+
+    for(;;) {
+        if(::connect(stream.fd, reinterpret_cast<const sockaddr*>(&address.sockaddr_),
+                     address.length()) == 0) {
+            break;
+        }
+        if(errno == EINTR) continue;
+        if(errno == EINPROGRESS) break;
+        warn("Failed to connect socket: %", Log::sys_error());
+        return {};
+    }
+    return Opt{rpp::move(stream)};
+}
+
+[[nodiscard]] bool Tcp_Stream::finish_connect() noexcept {
+    i32 error = 0;
+    socklen_t length = sizeof(error);
+    if(getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == -1) {
+        warn("Failed to query socket: %", Log::sys_error());
+        return false;
+    }
+    if(error != 0) {
+        errno = error;
+        warn("Failed to connect socket: %", Log::sys_error());
+        return false;
+    }
+    return true;
+}
+
+void Tcp_Stream::set_nodelay(bool enable) noexcept {
+    i32 value = enable ? 1 : 0;
+    if(setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value)) == -1) {
+        warn("Failed to set TCP_NODELAY: %", Log::sys_error());
+    }
+}
+
+[[nodiscard]] Opt<u64> Tcp_Stream::read(u8* data, u64 length) noexcept {
+    for(;;) {
+        i64 ret = ::recv(fd, data, length, 0);
+        if(ret != -1) return Opt{static_cast<u64>(ret)};
+        if(errno == EINTR) continue;
+        if(errno == EAGAIN || errno == EWOULDBLOCK) return {};
+        warn("Failed to read socket: %", Log::sys_error());
+        return Opt<u64>{0};
+    }
+}
+
+[[nodiscard]] Opt<u64> Tcp_Stream::write(Slice<Slice<u8>> buffers, u64 offset) noexcept {
+    iovec iovs[IOV_BATCH];
+    u64 n = 0;
+    for(u64 i = 0; i < buffers.length() && n < IOV_BATCH; i++) {
+        Slice<u8> buffer = buffers[i];
+        if(offset >= buffer.length()) {
+            offset -= buffer.length();
+            continue;
+        }
+        iovs[n].iov_base = const_cast<u8*>(buffer.data() + offset);
+        iovs[n].iov_len = buffer.length() - offset;
+        offset = 0;
+        n++;
+    }
+    if(n == 0) return Opt<u64>{0};
+
+    msghdr msg = {};
+    msg.msg_iov = iovs;
+    msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(n);
+
+    for(;;) {
+        i64 ret = sendmsg(fd, &msg, SEND_FLAGS);
+        if(ret != -1) return Opt{static_cast<u64>(ret)};
+        if(errno == EINTR) continue;
+        if(errno == EAGAIN || errno == EWOULDBLOCK) return {};
+        warn("Failed to write socket: %", Log::sys_error());
+        return Opt<u64>{0};
+    }
+}
+
+Tcp_Listener::Tcp_Listener(Address address) noexcept {
+    fd = open_tcp(address.family());
+    if(fd == -1) {
+        die("Failed to open socket: %", Log::sys_error());
+    }
+
+    i32 one = 1;
+    if(setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == -1) {
+        warn("Failed to set SO_REUSEADDR: %", Log::sys_error());
+    }
+    if(address.family() == Family::ipv6) {
+        i32 zero = 0;
+        if(setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero)) == -1) {
+            warn("Failed to clear IPV6_V6ONLY: %", Log::sys_error());
+        }
+    }
+    if(::bind(fd, reinterpret_cast<const sockaddr*>(&address.sockaddr_), address.length()) < 0) {
+        die("Failed to bind socket: %", Log::sys_error());
+    }
+    if(listen(fd, SOMAXCONN) < 0) {
+        die("Failed to listen on socket: %", Log::sys_error());
+    }
+}
+
+Tcp_Listener::~Tcp_Listener() noexcept {
+    if(fd != -1) {
+        close(fd);
+    }
+    fd = -1;
+}
+
+Tcp_Listener::Tcp_Listener(Tcp_Listener&& src) noexcept {
+    fd = src.fd;
+    src.fd = -1;
+}
+
+Tcp_Listener& Tcp_Listener::operator=(Tcp_Listener&& src) noexcept {
+    if(fd != -1) close(fd);
+    fd = src.fd;
+    src.fd = -1;
+    return *this;
+}
+
+[[nodiscard]] Opt<Tcp_Stream> Tcp_Listener::accept() noexcept {
+    for(;;) {
+        i32 client = ::accept(fd, null, null);
+        if(client != -1) {
+            Tcp_Stream stream;
+            stream.fd = client;
+            if(!set_nonblocking(client) || fcntl(client, F_SETFD, FD_CLOEXEC) == -1) {
+                warn("Failed to configure socket: %", Log::sys_error());
+                return {};
+            }
+#ifdef RPP_OS_MACOS
+            i32 one = 1;
+            static_cast<void>(setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one)));
+#endif
+            return Opt{rpp::move(stream)};
+        }
+        if(errno == EINTR || errno == ECONNABORTED) continue;
+        if(errno != EAGAIN && errno != EWOULDBLOCK) {
+            warn("Failed to accept connection: %", Log::sys_error());
+        }
+        return {};
+    }
+}
+
+#ifdef RPP_OS_LINUX
+
+[[nodiscard]] Async::Event Tcp_Stream::readable() const noexcept {
+    return Async::Event::of_sys(dup_socket(fd), EPOLLIN | EPOLLRDHUP);
+}
+
+[[nodiscard]] Async::Event Tcp_Stream::writable() const noexcept {
+    return Async::Event::of_sys(dup_socket(fd), EPOLLOUT);
+}
+
+[[nodiscard]] Async::Event Tcp_Listener::readable() const noexcept {
+    return Async::Event::of_sys(dup_socket(fd), EPOLLIN);
+}
+
+#else
+
+[[nodiscard]] Async::Event Tcp_Stream::readable() const noexcept {
+    return Async::Event::of_sys(dup_socket(fd), EVFILT_READ);
+}
+
+[[nodiscard]] Async::Event Tcp_Stream::writable() const noexcept {
+    return Async::Event::of_sys(dup_socket(fd), EVFILT_WRITE);
+}
+
+[[nodiscard]] Async::Event Tcp_Listener::readable() const noexcept {
+    return Async::Event::of_sys(dup_socket(fd), EVFILT_READ);
+}
+
+#endif
+
 } // namespace rpp::Net
@@ -0,0 +1,59 @@
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/ucontext.h>
+
+namespace rpp {
+
+[[nodiscard]] static u64 interrupted_pc(void* context) noexcept {
+    ucontext_t* uc = static_cast<ucontext_t*>(context);
+#if defined RPP_OS_MACOS && defined RPP_ARCH_X64
+    return static_cast<u64>(uc->uc_mcontext->__ss.__rip);
+#elif defined RPP_OS_MACOS && defined RPP_ARCH_ARM64
+    return static_cast<u64>(uc->uc_mcontext->__ss.__pc);
+#elif defined RPP_ARCH_X64
+    return static_cast<u64>(uc->uc_mcontext.gregs[REG_RIP]);
+#elif defined RPP_ARCH_ARM64
+    return static_cast<u64>(uc->uc_mcontext.pc);
+#else
+    static_cast<void>(uc);
+    return 0;
+#endif
+}
+
+[[nodiscard]] bool Profile::Sampler::start_timer(u64 hz) noexcept {
+    // The handler stays installed after stop, so a SIGPROF still in flight can't kill the process.
+    struct sigaction action = {};
+    action.sa_sigaction = [](int, siginfo_t*, void* context) {
+        int saved = errno;
+        if(running()) record_sample(scope_stack, interrupted_pc(context));
+        errno = saved;
+    };
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if(sigaction(SIGPROF, &action, null) == -1) {
+        warn("Failed to install SIGPROF handler: %", Log::sys_error());
+        return false;
+    }
+
+    u64 us = Math::max(u64{1}, 1000000 / hz);
+    struct itimerval timer = {};
+    timer.it_interval.tv_sec = static_cast<time_t>(us / 1000000);
+    timer.it_interval.tv_usec = static_cast<suseconds_t>(us % 1000000);
+    timer.it_value = timer.it_interval;
+    if(setitimer(ITIMER_PROF, &timer, null) == -1) {
+        warn("Failed to start profiling timer: %", Log::sys_error());
+        return false;
+    }
+    return true;
+}
+
+void Profile::Sampler::stop_timer() noexcept {
+    struct itimerval timer = {};
+    if(setitimer(ITIMER_PROF, &timer, null) == -1) {
+        warn("Failed to stop profiling timer: %", Log::sys_error());
+    }
+}
+
+} // namespace rpp
@@ -6,12 +6,22 @@
 #endif
 
 #ifdef RPP_OS_LINUX
+#include <dirent.h>
+#include <fcntl.h>
 #include <linux/futex.h>
 #endif
 
 #ifdef RPP_OS_MACOS
 #include <mach/thread_act.h>
 #include <mach/thread_policy.h>
+#include <sys/sysctl.h>
+
+// The ulock interface behind libc++'s atomic wait. It is not in the public SDK headers.
+extern "C" int __ulock_wait(uint32_t operation, void* address, uint64_t value, uint32_t timeout);
+extern "C" int __ulock_wake(uint32_t operation, void* address, uint64_t wake_value);
+#define UL_COMPARE_AND_WAIT 1
+#define ULF_WAKE_ALL 0x00000100
+#define ULF_NO_ERRNO 0x01000000
 #endif
 
 #include <errno.h>
@@ -157,6 +167,69 @@ void set_affinity(u64 core) noexcept {
 #endif
 }
 
+#ifdef RPP_OS_LINUX
+[[nodiscard]] static Opt<u64> read_cpu_info(u64 cpu, const char* file) noexcept {
+    u8 path[128];
+    (void)Libc::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/%s",
+                         static_cast<u32>(cpu), file);
+    int fd = open(reinterpret_cast<const char*>(path), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return {};
+    char buffer[32];
+    ssize_t n = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if(n <= 0) return {};
+    buffer[n] = '\0';
+    return Opt{static_cast<u64>(Libc::strtoll(buffer, null, 10))};
+}
+
+// The cpu directory links to its NUMA node as nodeN.
+[[nodiscard]] static u64 cpu_node(u64 cpu) noexcept {
+    u8 path[64];
+    (void)Libc::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u",
+                         static_cast<u32>(cpu));
+    DIR* dir = opendir(reinterpret_cast<const char*>(path));
+    if(!dir) return 0;
+    u64 node = 0;
+    while(dirent* entry = readdir(dir)) {
+        if(Libc::strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' &&
+           entry->d_name[4] <= '9') {
+            node = static_cast<u64>(Libc::strtoll(entry->d_name + 4, null, 10));
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+#endif
+
+[[nodiscard]] Vec<Processor, Alloc> topology() noexcept {
+    u64 n = hardware_threads();
+    auto ret = Vec<Processor, Alloc>::make(n);
+#ifdef RPP_OS_MACOS
+    int physical = 0;
+    size_t size = sizeof(physical);
+    if(sysctlbyname("hw.physicalcpu", &physical, &size, null, 0) || physical <= 0) {
+        physical = static_cast<int>(n);
+    }
+#endif
+    for(u64 i = 0; i < n; i++) {
+        Processor& processor = ret[i];
+        processor.index = i;
+        processor.core = i;
+#ifdef RPP_OS_LINUX
+        Opt<u64> core = read_cpu_info(i, "core_id");
+        Opt<u64> package = read_cpu_info(i, "physical_package_id");
+        // Core ids are only unique within a package.
+        if(core.ok() && package.ok()) processor.core = (*package << 32) | *core;
+        processor.node = cpu_node(i);
+#elif defined RPP_OS_MACOS
+        // Siblings are not reported, but are numbered next to each other.
+        processor.core = i * static_cast<u64>(physical) / n;
+#endif
+    }
+    return ret;
+}
+
 void Flag::block() noexcept {
 #ifdef RPP_OS_LINUX
     while(__atomic_load_n(&value_, __ATOMIC_SEQ_CST) == 0) {
@@ -194,98 +267,197 @@ void Flag::signal() noexcept {
 #endif
 }
 
-Mutex::Mutex() noexcept {
-    int ret = pthread_mutex_init(&lock_, null);
-    if(ret) {
-        die("Failed to create mutex: %", error(ret));
+void sys_wait(u32* address, u32 expected) noexcept {
+#ifdef RPP_OS_LINUX
+    int ret = syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+    if(ret == -1 && errno != EAGAIN && errno != EINTR) {
+        die("Failed to wait on futex: %", error(errno));
     }
+#else
+    int ret = __ulock_wait(UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, address, expected, 0);
+    if(ret < 0 && ret != -EINTR && ret != -EFAULT) {
+        die("Failed to wait on ulock: %", error(-ret));
+    }
+#endif
 }
 
-Mutex::~Mutex() noexcept {
-    int ret = pthread_mutex_destroy(&lock_);
-    if(ret) {
-        die("Failed to destroy mutex: %", error(ret));
+void sys_wake(u32* address, u32 count) noexcept {
+#ifdef RPP_OS_LINUX
+    int ret = syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE,
+                      static_cast<int>(Math::min<u32>(count, RPP_INT32_MAX)), NULL, NULL, 0);
+    if(ret == -1) {
+        die("Failed to wake futex: %", error(errno));
+    }
+#else
+    u32 operation = UL_COMPARE_AND_WAIT | ULF_NO_ERRNO | (count == 1 ? 0 : ULF_WAKE_ALL);
+    int ret = __ulock_wake(operation, address, 0);
+    if(ret < 0 && ret != -ENOENT && ret != -EINTR) {
+        die("Failed to wake ulock: %", error(-ret));
     }
+#endif
+}
+
+[[nodiscard]] u32 Futex::load() const noexcept {
+    return __atomic_load_n(&value_, __ATOMIC_SEQ_CST);
+}
+
+void Futex::wait(u32 expected) noexcept {
+    sys_wait(&value_, expected);
+}
+
+void Futex::incr_and_wake(u32 count) noexcept {
+    __atomic_fetch_add(&value_, 1, __ATOMIC_SEQ_CST);
+    sys_wake(&value_, count);
 }
 
+// Spinning only pays off while the owner is running, so give up once others have gone to sleep.
+constexpr u32 MUTEX_SPIN = 128;
+
 void Mutex::lock() noexcept {
-    int ret = pthread_mutex_lock(&lock_);
-    if(ret) {
-        die("Failed to lock mutex: %", error(ret));
+    u32 unlocked = 0;
+    if(__atomic_compare_exchange_n(&state_, &unlocked, 1, false, __ATOMIC_ACQUIRE,
+                                   __ATOMIC_RELAXED)) {
+        return;
+    }
+    for(u32 i = 0; i < MUTEX_SPIN; i++) {
+        u32 state = __atomic_load_n(&state_, __ATOMIC_RELAXED);
+        if(state == 2) break;
+        if(state == 0) {
+            unlocked = 0;
+            if(__atomic_compare_exchange_n(&state_, &unlocked, 1, false, __ATOMIC_ACQUIRE,
+                                           __ATOMIC_RELAXED)) {
+                return;
+            }
+        }
+        pause();
     }
+    lock_contended();
+}
+
+void Mutex::lock_contended() noexcept {
+    while(__atomic_exchange_n(&state_, 2, __ATOMIC_ACQUIRE) != 0) sys_wait(&state_, 2);
 }
 
 void Mutex::unlock() noexcept {
-    int ret = pthread_mutex_unlock(&lock_);
-    if(ret) {
-        die("Failed to unlock mutex: %", error(ret));
-    }
+    if(__atomic_exchange_n(&state_, 0, __ATOMIC_RELEASE) == 2) sys_wake(&state_, 1);
 }
 
 [[nodiscard]] bool Mutex::try_lock() noexcept {
-    int ret = pthread_mutex_trylock(&lock_);
-    if(ret == EBUSY)
-        return false;
-    else if(ret)
-        die("Failed to try lock mutex: %", error(ret));
-    return true;
+    u32 unlocked = 0;
+    return __atomic_compare_exchange_n(&state_, &unlocked, 1, false, __ATOMIC_ACQUIRE,
+                                       __ATOMIC_RELAXED);
+}
+
+void RwLock::lock_shared() noexcept {
+    for(u32 spins = 0;;) {
+        u32 state = __atomic_load_n(&state_, __ATOMIC_RELAXED);
+        if(!(state & WRITER)) {
+            if(__atomic_compare_exchange_n(&state_, &state, state + 1, true, __ATOMIC_ACQUIRE,
+                                           __ATOMIC_RELAXED)) {
+                return;
+            }
+            continue;
+        }
+        if(spins++ < MUTEX_SPIN) {
+            pause();
+            continue;
+        }
+        if(!(state & SLEEPERS) &&
+           !__atomic_compare_exchange_n(&state_, &state, state | SLEEPERS, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            continue;
+        }
+        sys_wait(&state_, state | SLEEPERS);
+    }
 }
 
-[[nodiscard]] i64 Atomic::load() const noexcept {
-    return __atomic_load_n(&value_, __ATOMIC_SEQ_CST);
+void RwLock::unlock_shared() noexcept {
+    u32 state = __atomic_sub_fetch(&state_, 1, __ATOMIC_RELEASE);
+    // The last reader out lets a draining writer in.
+    if((state & ~SLEEPERS) == WRITER) sys_wake(&state_, RPP_UINT32_MAX);
 }
 
-i64 Atomic::incr() noexcept {
-    return __atomic_fetch_add(&value_, 1, __ATOMIC_SEQ_CST) + 1;
+[[nodiscard]] bool RwLock::try_lock_shared() noexcept {
+    u32 state = __atomic_load_n(&state_, __ATOMIC_RELAXED);
+    while(!(state & WRITER)) {
+        if(__atomic_compare_exchange_n(&state_, &state, state + 1, true, __ATOMIC_ACQUIRE,
+                                       __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+    return false;
 }
 
-i64 Atomic::decr() noexcept {
-    return __atomic_fetch_sub(&value_, 1, __ATOMIC_SEQ_CST) - 1;
+void RwLock::lock() noexcept {
+    writers.lock();
+    u32 state = __atomic_or_fetch(&state_, WRITER, __ATOMIC_ACQUIRE);
+    for(u32 spins = 0; state & READERS; spins++) {
+        if(spins < MUTEX_SPIN) {
+            pause();
+        } else {
+            sys_wait(&state_, state);
+        }
+        state = __atomic_load_n(&state_, __ATOMIC_ACQUIRE);
+    }
 }
 
-i64 Atomic::exchange(i64 value) noexcept {
-    return __atomic_exchange_n(&value_, value, __ATOMIC_SEQ_CST);
+void RwLock::unlock() noexcept {
+    u32 state = __atomic_exchange_n(&state_, 0, __ATOMIC_RELEASE);
+    if(state & SLEEPERS) sys_wake(&state_, RPP_UINT32_MAX);
+    writers.unlock();
 }
 
-[[nodiscard]] i64 Atomic::compare_and_swap(i64 compare_with, i64 set_to) noexcept {
-    __atomic_compare_exchange_n(&value_, &compare_with, set_to, false, __ATOMIC_SEQ_CST,
-                                __ATOMIC_SEQ_CST);
-    return compare_with;
+[[nodiscard]] bool RwLock::try_lock() noexcept {
+    if(!writers.try_lock()) return false;
+    u32 unlocked = 0;
+    if(__atomic_compare_exchange_n(&state_, &unlocked, WRITER, false, __ATOMIC_ACQUIRE,
+                                   __ATOMIC_RELAXED)) {
+        return true;
+    }
+    writers.unlock();
+    return false;
 }
 
-Cond::Cond() noexcept {
-    int ret = pthread_cond_init(&cond_, null);
-    if(ret) {
-        die("Failed to create condvar: %", error(ret));
+[[nodiscard]] u32 Sequence::read_begin() const noexcept {
+    for(;;) {
+        u32 value = __atomic_load_n(&value_, __ATOMIC_ACQUIRE);
+        if(!(value & 1)) return value;
+        pause();
     }
 }
 
-Cond::~Cond() noexcept {
-    int ret = pthread_cond_destroy(&cond_);
-    if(ret) {
-        die("Failed to destroy condvar: %", error(ret));
-    }
+[[nodiscard]] bool Sequence::read_retry(u32 begin) const noexcept {
+    // Keeps the reads of the protected data before the second load of the counter.
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&value_, __ATOMIC_RELAXED) != begin;
+}
+
+void Sequence::write_begin() noexcept {
+    __atomic_store_n(&value_, value_ + 1, __ATOMIC_RELAXED);
+    // Keeps the writes to the protected data after the counter turns odd.
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void Sequence::write_end() noexcept {
+    __atomic_store_n(&value_, value_ + 1, __ATOMIC_RELEASE);
 }
 
 void Cond::wait(Mutex& mut) noexcept {
-    int ret = pthread_cond_wait(&cond_, &mut.lock_);
-    if(ret) {
-        die("Failed to wait on cond: %", error(ret));
-    }
+    u32 sequence = __atomic_load_n(&sequence_, __ATOMIC_SEQ_CST);
+    mut.unlock();
+    sys_wait(&sequence_, sequence);
+    // Other waiters may have been woken along with us, so relock as contended.
+    mut.lock_contended();
 }
 
 void Cond::signal() noexcept {
-    int ret = pthread_cond_signal(&cond_);
-    if(ret) {
-        die("Failed to signal cond: %", error(ret));
-    }
+    __atomic_fetch_add(&sequence_, 1, __ATOMIC_SEQ_CST);
+    sys_wake(&sequence_, 1);
 }
 
 void Cond::broadcast() noexcept {
-    int ret = pthread_cond_broadcast(&cond_);
-    if(ret) {
-        die("Failed to broadcast cond: %", error(ret));
-    }
+    __atomic_fetch_add(&sequence_, 1, __ATOMIC_SEQ_CST);
+    sys_wake(&sequence_, RPP_UINT32_MAX);
 }
 
 [[nodiscard]] Id sys_id(OS_Thread thread) noexcept {
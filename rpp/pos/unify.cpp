@@ -1,13 +1,19 @@
 
 #include "../base.h"
 
+#include "alloc_pos.cpp"
 #ifdef RPP_OS_MACOS
 #include "async_bsd.cpp"
 #include "asyncio_bsd.cpp"
+#include "counters_bsd.cpp"
+#include "watch_bsd.cpp"
 #else
 #include "async_pos.cpp"
 #include "asyncio_pos.cpp"
+#include "counters_pos.cpp"
+#include "watch_pos.cpp"
 #endif
 #include "files_pos.cpp"
 #include "net_pos.cpp"
+#include "sampler_pos.cpp"
 #include "thread_pos.cpp"
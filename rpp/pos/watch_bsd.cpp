@@ -0,0 +1,102 @@
+
+#include "../watch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/event.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace rpp::Files {
+
+constexpr u32 WATCH_FFLAGS = NOTE_WRITE | NOTE_EXTEND | NOTE_ATTRIB | NOTE_DELETE | NOTE_RENAME;
+
+Watch_Set::Watch_Set() noexcept {
+    fd = kqueue();
+    if(fd == -1) {
+        die("Failed to create kqueue: %", Log::sys_error());
+    }
+}
+
+Watch_Set::~Watch_Set() noexcept {
+    for(i32 file : files) {
+        if(file != -1) close(file);
+    }
+    if(fd != -1) close(fd);
+    fd = -1;
+}
+
+[[nodiscard]] static i32 add_watch(i32 kq, String_View path_, u64 id) noexcept {
+    i32 file = -1;
+    Region(R) {
+        auto path = path_.terminate<Mregion<R>>();
+        file = open(reinterpret_cast<const char*>(path.data()), O_EVTONLY | O_CLOEXEC);
+    }
+    if(file == -1) return -1;
+
+    struct kevent change;
+    EV_SET(&change, file, EVFILT_VNODE, EV_ADD | EV_ENABLE | EV_CLEAR, WATCH_FFLAGS, 0,
+           reinterpret_cast<void*>(id));
+    if(kevent(kq, &change, 1, null, 0, null) == -1) {
+        close(file);
+        return -1;
+    }
+    return file;
+}
+
+[[nodiscard]] Opt<u64> Watch_Set::add(String_View path) noexcept {
+    u64 id = paths.length();
+    i32 file = add_watch(fd, path, id);
+    if(file == -1) {
+        warn("Failed to watch file %: %", path, Log::sys_error());
+        return {};
+    }
+
+    paths.push(path.string<Alloc>());
+    marked.push(false);
+    files.push(rpp::move(file));
+    return Opt{id};
+}
+
+[[nodiscard]] Async::Event Watch_Set::event() const noexcept {
+    // The pool closes the event once it fires, so hand out a duplicate descriptor.
+    i32 event = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if(event == -1) {
+        die("Failed to duplicate kqueue descriptor: %", Log::sys_error());
+    }
+    return Async::Event::of_sys(event, EVFILT_READ);
+}
+
+[[nodiscard]] Slice<u64> Watch_Set::poll() noexcept {
+    changed.clear();
+
+    constexpr i32 batch = 64;
+    struct kevent events[batch];
+    struct timespec zero = {};
+
+    for(;;) {
+        i32 n = kevent(fd, null, 0, events, batch, &zero);
+        if(n == -1) {
+            if(errno == EINTR) continue;
+            warn("Failed to read kevents: %", Log::sys_error());
+            break;
+        }
+
+        for(i32 i = 0; i < n; i++) {
+            u64 id = reinterpret_cast<u64>(events[i].udata);
+            mark(id);
+
+            // Files replaced by a rename keep the old vnode, so follow the path to the new file.
+            if(events[i].fflags & (NOTE_DELETE | NOTE_RENAME)) {
+                close(files[id]);
+                files[id] = add_watch(fd, paths[id].view(), id);
+            }
+        }
+        if(n < batch) break;
+    }
+
+    for(u64 id : changed) marked[id] = false;
+    return Slice<u64>{changed};
+}
+
+} // namespace rpp::Files
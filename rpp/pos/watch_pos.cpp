@@ -0,0 +1,101 @@
+
+#include "../watch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace rpp::Files {
+
+constexpr u32 WATCH_MASK =
+    IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF;
+
+Watch_Set::Watch_Set() noexcept {
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd == -1) {
+        die("Failed to create inotify instance: %", Log::sys_error());
+    }
+}
+
+Watch_Set::~Watch_Set() noexcept {
+    if(fd != -1) {
+        int ret = close(fd);
+        assert(ret == 0);
+    }
+    fd = -1;
+}
+
+[[nodiscard]] static i32 add_watch(i32 fd, String_View path_) noexcept {
+    i32 wd = -1;
+    Region(R) {
+        auto path = path_.terminate<Mregion<R>>();
+        wd = inotify_add_watch(fd, reinterpret_cast<const char*>(path.data()), WATCH_MASK);
+    }
+    return wd;
+}
+
+[[nodiscard]] Opt<u64> Watch_Set::add(String_View path) noexcept {
+    i32 wd = add_watch(fd, path);
+    if(wd == -1) {
+        warn("Failed to watch file %: %", path, Log::sys_error());
+        return {};
+    }
+
+    // Watching the same inode twice returns the existing descriptor.
+    if(Opt<Ref<u64>> id = watches.try_get(wd); id.ok()) {
+        return Opt{**id};
+    }
+
+    u64 id = paths.length();
+    paths.push(path.string<Alloc>());
+    marked.push(false);
+    watches.insert(wd, id);
+    return Opt{id};
+}
+
+[[nodiscard]] Async::Event Watch_Set::event() const noexcept {
+    // The pool closes the event once it fires, so hand out a duplicate descriptor.
+    i32 event = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if(event == -1) {
+        die("Failed to duplicate inotify descriptor: %", Log::sys_error());
+    }
+    return Async::Event::of_sys(event, EPOLLIN);
+}
+
+[[nodiscard]] Slice<u64> Watch_Set::poll() noexcept {
+    changed.clear();
+
+    alignas(inotify_event) u8 buffer[4096];
+    for(;;) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if(n == -1) {
+            if(errno == EINTR) continue;
+            if(errno != EAGAIN) warn("Failed to read inotify events: %", Log::sys_error());
+            break;
+        }
+
+        for(ssize_t i = 0; i < n;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + i);
+            i += sizeof(inotify_event) + event->len;
+
+            Opt<Ref<u64>> found = watches.try_get(event->wd);
+            if(!found.ok()) continue;
+            u64 id = **found;
+            mark(id);
+
+            // Files replaced by a rename lose their watch, so follow the path to the new file.
+            if(event->mask & IN_IGNORED) {
+                watches.erase(event->wd);
+                i32 wd = add_watch(fd, paths[id].view());
+                if(wd != -1) watches.insert(wd, id);
+            }
+        }
+    }
+
+    for(u64 id : changed) marked[id] = false;
+    return Slice<u64>{changed};
+}
+
+} // namespace rpp::Files
@@ -37,9 +37,38 @@ struct Profile {
         String_View name;
         void* address = null;
         u64 size = 0; // 0 means free
+        // Filled in by alloc: when it happened, and the innermost Trace scope open at the time.
+        Time_Point time = 0;
+        String_View site;
     };
     static void alloc(Alloc a) noexcept;
 
+    constexpr static u64 HISTOGRAM = 64;
+
+    struct Alloc_Site {
+        String_View site;
+        i64 allocates = 0, allocate_size = 0;
+        i64 live = 0, live_size = 0;
+    };
+
+    // Statistics for one allocator, as of each thread's last flush of its allocation log. Sizes
+    // counts allocations by log2 of their size, and lifetimes counts frees by log2 of the
+    // nanoseconds since the matching allocation.
+    struct Alloc_Snapshot {
+        String_View name;
+        i64 allocates = 0, frees = 0;
+        i64 allocate_size = 0, free_size = 0;
+        i64 high_water = 0;
+        i64 live = 0, live_size = 0;
+        u64 sizes[HISTOGRAM] = {};
+        u64 lifetimes[HISTOGRAM] = {};
+        Vec<Alloc_Site, Mhidden> sites;
+    };
+
+    // Copies the statistics of every logging allocator. Only the caller's log is flushed first,
+    // so other threads keep allocating while the copy is taken.
+    [[nodiscard]] static Vec<Alloc_Snapshot, Mhidden> snapshot_allocs() noexcept;
+
     [[nodiscard]] static Time_Point timestamp() noexcept;
     [[nodiscard]] static f32 ms(Time_Point duration) noexcept;
     [[nodiscard]] static f32 s(Time_Point duration) noexcept;
@@ -60,19 +89,54 @@ struct Profile {
         }
     };
 
+    // Hardware counters for the calling thread, in user mode. They are read on every enter and
+    // exit of frames that begin while counters are enabled, and accumulate in each Timing_Node
+    // like its times. Counters the platform can't provide stay zero: Linux reads all four through
+    // perf_event_open, macOS reads cycles and instructions through kperf, which requires root,
+    // and Windows reads only cycles.
+    struct Counters {
+        u64 cycles = 0, instructions = 0;
+        u64 cache_misses = 0, branch_misses = 0;
+
+        [[nodiscard]] Counters operator+(const Counters& o) const noexcept {
+            return Counters{cycles + o.cycles, instructions + o.instructions,
+                            cache_misses + o.cache_misses, branch_misses + o.branch_misses};
+        }
+        [[nodiscard]] Counters operator-(const Counters& o) const noexcept {
+            return Counters{cycles - o.cycles, instructions - o.instructions,
+                            cache_misses - o.cache_misses, branch_misses - o.branch_misses};
+        }
+    };
+
+    static void set_counters(bool enable) noexcept;
+    [[nodiscard]] static bool counters() noexcept {
+        return counters_.load(Thread::Order::relaxed) != 0;
+    }
+    // Whether the calling thread opened its counters. They are opened, once, by the first frame
+    // that begins while counters are enabled.
+    [[nodiscard]] static bool counters_open() noexcept {
+        return this_thread.counters_open;
+    }
+
     struct Timing_Node {
         Log::Location loc;
         Time_Point begin = 0, end = 0;
         Time_Point self_time = 0, heir_time = 0;
+        Counters begin_counters, self_counters, heir_counters;
         u64 calls = 0;
         u64 parent = 0;
-        Vec<u64, Mhidden> children;
+        // Points into the frame's edge list, which holds the children of each node in order.
+        Slice<u64> children;
+        // Sibling links used while the tree is built. Zero is none, as the root is never a child.
+        u64 first_child = 0, last_child = 0, next_sibling = 0;
 
-        [[nodiscard]] static Timing_Node make(Log::Location loc, u64 parent) noexcept {
+        [[nodiscard]] static Timing_Node make(Log::Location loc, u64 parent, Time_Point begin,
+                                              Counters begin_counters = {}) noexcept {
             Timing_Node ret;
             ret.loc = rpp::move(loc);
             ret.parent = parent;
-            ret.begin = timestamp();
+            ret.begin = begin;
+            ret.begin_counters = begin_counters;
             ret.calls = 1;
             return ret;
         }
@@ -80,7 +144,7 @@ struct Profile {
 
     template<typename F>
     static void iterate_timings(F&& f) noexcept {
-        Thread::Lock lock(threads_lock);
+        Thread::Shared_Lock lock(threads_lock);
 
         for(auto& entry : threads) {
 
@@ -97,39 +161,162 @@ struct Profile {
                 continue;
             }
 
+            frame->build();
             for(auto& node : frame->nodes) {
                 f(id, node);
             }
         }
     }
 
+    enum class Capture : u8 { begin, end, resume, suspend };
+
+    // Records timestamped events from every thread: scope enters and exits, and the resumes and
+    // suspends of Pool jobs, which are linked by coroutine across threads. Each thread appends to
+    // its own buffer, so capturing costs a relaxed load when off and a few stores when on. Events
+    // are kept until finalize.
+    static void begin_capture() noexcept;
+    static void end_capture() noexcept;
+    [[nodiscard]] static bool capturing() noexcept {
+        return capturing_.load(Thread::Order::relaxed) != 0;
+    }
+    static void capture(Capture event, String_View name, u64 id = 0) noexcept;
+    // Writes the captured events as Chrome Trace Event JSON, as opened by Perfetto.
+    [[nodiscard]] static bool write_chrome_trace(String_View path) noexcept;
+
+    // Statistical profiler. While running, threads are interrupted about hz times per second and
+    // each sample records the interrupted instruction and the Trace scopes open at the time, so
+    // time spent in unannotated code is still charged to its enclosing scope. On Linux and macOS
+    // SIGPROF delivers samples in proportion to CPU time; on Windows a sampler thread suspends
+    // each thread in turn, so samples follow wall time at the scheduler's resolution.
+    //
+    // A thread is sampled once it opens a scope while the sampler runs. Samples are buffered per
+    // thread in a fixed ring, so collect regularly: samples that don't fit are dropped.
+    struct Sampler {
+        constexpr static u64 DEPTH = 16;
+
+        struct Sample {
+            Thread::Id thread = 0;
+            u64 pc = 0;
+            Time_Point time = 0;
+            // Number of open scopes, of which the outermost DEPTH are recorded.
+            u64 depth = 0;
+            String_View scopes[DEPTH];
+        };
+
+        [[nodiscard]] static bool start(u64 hz = 1000) noexcept;
+        static void stop() noexcept;
+        [[nodiscard]] static bool running() noexcept {
+            return sampling_.load(Thread::Order::relaxed) != 0;
+        }
+        // Passes each buffered sample to f, oldest first per thread.
+        static void collect(Function_Ref<void(const Sample&)> f) noexcept;
+        [[nodiscard]] static u64 dropped() noexcept;
+
+    private:
+        [[nodiscard]] static bool start_timer(u64 hz) noexcept;
+        static void stop_timer() noexcept;
+        static void attach() noexcept;
+        static void detach() noexcept;
+        static void free_rings() noexcept;
+
+        friend struct Profile;
+    };
+
     static void finalizer(Function<void()> f) noexcept;
     static void finalize() noexcept;
 
 private:
+    struct Sample_Ring;
+
+    // Trace scopes open on this thread. The sampler reads it from a signal handler on the same
+    // thread, or while the thread is suspended, so entries are written before depth is published.
+    struct Scope_Stack {
+        Thread::Atomic_Of<u64> depth;
+        String_View names[Sampler::DEPTH];
+        Thread::Atomic_Of<Sample_Ring*> ring;
+    };
+
+    constexpr static u64 SAMPLE_RING = 256;
+
+    // Filled by the sampler and drained by collect. A ring outlives its thread until drained.
+    struct Sample_Ring {
+        Thread::Id thread = 0;
+        Scope_Stack* stack = null;
+        // The sampler thread's handle to this thread, on Windows.
+        void* handle = null;
+        Thread::Atomic_Of<u64> head, tail;
+        Sampler::Sample samples[SAMPLE_RING];
+        Sample_Ring* next = null;
+    };
+
+    static void record_sample(Scope_Stack& stack, u64 pc) noexcept;
+
     static void register_thread() noexcept;
     static void unregister_thread() noexcept;
 
+    // Threads log allocations locally and merge them in batches, so a free may be merged before
+    // the allocation it matches. Entries therefore count live allocations, going negative for
+    // frees that are still waiting on their allocation.
+    struct Alloc_Entry {
+        i64 size = 0;
+        i64 count = 0;
+        // Of the allocation, or of the free while it waits on its allocation.
+        Time_Point time = 0;
+        String_View site;
+    };
+
     struct Alloc_Profile {
         Alloc_Profile() noexcept {
         }
 
+        void merge(const Alloc& a) noexcept;
+
         i64 allocates = 0, frees = 0;
         i64 allocate_size = 0, free_size = 0;
         i64 high_water = 0;
         i64 current_set_size = 0;
-        Map<void*, u64, Mhidden> current_set;
+        u64 sizes[HISTOGRAM] = {};
+        u64 lifetimes[HISTOGRAM] = {};
+        Map<void*, Alloc_Entry, Mhidden> current_set;
+        Map<String_View, Alloc_Site, Mhidden> sites;
+
+    private:
+        void record_lifetime(Time_Point begin, Time_Point end) noexcept;
+    };
+
+    constexpr static u64 ALLOC_LOG_CAPACITY = 1024;
+
+    static void flush_allocs(Vec<Alloc, Mhidden>& log) noexcept;
+
+    struct Event {
+        // Unused for exits.
+        Log::Location loc;
+        Time_Point time = 0;
+        Counters counters;
+        bool enter = false;
     };
 
+    // Only the owning thread writes the frame in progress, appending enter and exit events
+    // without locking. Readers only see completed frames, whose call tree is built from the events
+    // on first read. The oldest frame is recycled for the next one with all of its buffers, so
+    // once the history has seen a frame of each shape, profiling allocates nothing.
     struct Frame_Profile {
         [[nodiscard]] Time_Point begin() noexcept;
         void end() noexcept;
-        void enter(Log::Location loc) noexcept;
-        void exit() noexcept;
+        void reset() noexcept;
+        void build() noexcept;
         void compute_self_times(u64 idx) noexcept;
 
-        u64 current_node = 0;
+        Time_Point begin_time = 0, end_time = 0;
+        Counters begin_counters, end_counters;
+        u64 depth = 0;
+        bool counting = false;
+        bool built = false;
+        Vec<Event, Mhidden> events;
         Vec<Timing_Node, Mhidden> nodes;
+        Vec<u64, Mhidden> edges;
+        // Children by the hash of their parent and location.
+        Map<u64, u64, Mhidden> shape;
         Vec<Alloc, Mhidden> allocations;
     };
 
@@ -144,6 +331,12 @@ private:
             frames = {};
             if(during_frame) Profile::end_frame();
             if(registered) Profile::unregister_thread();
+            if(counters_open) Profile::close_counters();
+            counters_open = false;
+            counters_tried = false;
+            Sampler::detach();
+            Profile::flush_allocs(alloc_log);
+            alloc_log = {};
         }
 
         bool ready() noexcept {
@@ -153,19 +346,43 @@ private:
 
         bool registered = false;
         bool during_frame = false;
+        bool counters_open = false;
+        bool counters_tried = false;
         Thread::Mutex frames_lock;
         Queue<Frame_Profile, Mhidden> frames;
+        Vec<Alloc, Mhidden> alloc_log;
     };
 
-    static inline Thread::Mutex threads_lock;
+    // Implemented per platform, for the calling thread.
+    [[nodiscard]] static bool open_counters() noexcept;
+    static void close_counters() noexcept;
+    [[nodiscard]] static Counters read_counters() noexcept;
+
+    static inline Thread::Atomic_Of<u32> capturing_;
+    static inline Thread::Atomic_Of<u32> counters_;
+    static inline Thread::Atomic_Of<u32> sampling_;
+    static inline thread_local Scope_Stack scope_stack;
+    // Rings are added under rings_lock. Only collect, serialized by collect_lock, removes them,
+    // so it can walk the list without holding rings_lock while it calls back.
+    static inline Thread::Mutex rings_lock;
+    static inline Thread::Mutex collect_lock;
+    static inline Sample_Ring* rings = null;
+    static inline Thread::Atomic_Of<u64> samples_dropped;
+    static inline Thread::RwLock threads_lock;
     static inline Thread::Mutex allocs_lock;
     static inline Thread::Mutex finalizers_lock;
     static inline thread_local Thread_Profile this_thread;
     static inline Map<Thread::Id, Ref<Thread_Profile>, Mhidden> threads;
     static inline Map<String_View, Alloc_Profile, Mhidden> allocs;
+    static inline bool allocs_finalized = false;
     static inline Vec<Function<void()>, Mhidden> finalizers;
 };
 
-RPP_RECORD(Profile::Alloc, RPP_FIELD(name), RPP_FIELD(address), RPP_FIELD(size));
+RPP_RECORD(Profile::Alloc, RPP_FIELD(name), RPP_FIELD(address), RPP_FIELD(size), RPP_FIELD(time),
+           RPP_FIELD(site));
+RPP_RECORD(Profile::Alloc_Site, RPP_FIELD(site), RPP_FIELD(allocates), RPP_FIELD(allocate_size),
+           RPP_FIELD(live), RPP_FIELD(live_size));
+RPP_RECORD(Profile::Counters, RPP_FIELD(cycles), RPP_FIELD(instructions), RPP_FIELD(cache_misses),
+           RPP_FIELD(branch_misses));
 
 } // namespace rpp
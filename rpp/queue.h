@@ -12,7 +12,7 @@ struct Queue {
 
     Queue() noexcept = default;
     explicit Queue(u64 capacity) noexcept {
-        data_ = reinterpret_cast<T*>(A::alloc(capacity * sizeof(T)));
+        data_ = reinterpret_cast<T*>(alloc_aligned<A, alignof(T)>(capacity * sizeof(T)));
         length_ = 0;
         last_ = 0;
         capacity_ = capacity;
@@ -63,7 +63,7 @@ struct Queue {
         requires Clone<T> || Copy_Constructable<T>
     {
         Queue<T, B> ret;
-        ret.data_ = reinterpret_cast<T*>(B::alloc(capacity_ * sizeof(T)));
+        ret.data_ = reinterpret_cast<T*>(alloc_aligned<B, alignof(T)>(capacity_ * sizeof(T)));
         ret.length_ = length_;
         ret.last_ = last_;
         ret.capacity_ = capacity_;
@@ -95,7 +95,14 @@ struct Queue {
     void reserve(u64 new_capacity) noexcept {
         if(new_capacity <= capacity_) return;
 
-        T* new_data = reinterpret_cast<T*>(A::alloc(new_capacity * sizeof(T)));
+        // Growing in place only keeps the ring valid while the elements do not wrap around.
+        if(length_ <= last_ &&
+           alloc_expand<A>(data_, capacity_ * sizeof(T), new_capacity * sizeof(T))) {
+            capacity_ = new_capacity;
+            return;
+        }
+
+        T* new_data = reinterpret_cast<T*>(alloc_aligned<A, alignof(T)>(new_capacity * sizeof(T)));
         T* start = data_ + last_ - length_;
 
         if constexpr(Trivially_Movable<T>) {
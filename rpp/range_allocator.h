@@ -6,13 +6,34 @@
 
 namespace rpp {
 
-template<Allocator A = Mdefault, u64 Buckets = 24, u64 Bias = 8>
+// First fit walks the free lists from the request's size class until a block fits. TLSF splits
+// each size class into eight, and only takes blocks from classes whose every block fits the
+// request including worst-case alignment padding, so allocation is constant time. TLSF wastes
+// more space when alignments are large.
+enum class Range_Mode : u8 { first_fit, tlsf };
+
+template<Allocator A, u64 Shards, u64 Buckets, u64 Bias, Range_Mode M>
+struct Sharded_Range_Allocator;
+
+template<Allocator A = Mdefault, u64 Buckets = 24, u64 Bias = 8,
+         Range_Mode M = Range_Mode::first_fit>
 struct Range_Allocator {
 
+    // Bucket i holds sizes [2^(i + Bias), 2^(i + Bias + 1)), except the first holds all sizes
+    // below 2^(Bias + 1) and the last all sizes above. Each bucket is split into SL classes of
+    // equal width.
+    constexpr static u64 SL_LOG2 = M == Range_Mode::tlsf ? 3 : 0;
+    constexpr static u64 SL = u64{1} << SL_LOG2;
+    constexpr static u64 CLASSES = Buckets * SL;
+
+    static_assert(Buckets > 0 && Buckets <= 64);
+    static_assert(Bias + 1 >= SL_LOG2);
+
     Range_Allocator() noexcept = default;
-    explicit Range_Allocator(u64 heap_size) noexcept {
+    // Manages offsets [base, base + heap_size).
+    explicit Range_Allocator(u64 heap_size, u64 base = 0) noexcept {
         assert(heap_size);
-        Block* primary = blocks.make(Block{0, 0, heap_size, null, null});
+        Block* primary = blocks.make(Block{base, base, heap_size, null, null});
         insert_free_block(primary);
         stats.free_blocks = 1;
         stats.free_size = heap_size;
@@ -37,7 +58,11 @@ struct Range_Allocator {
         stats = src.stats;
         src.stats = {};
         free_blocks = src.free_blocks;
-        for(u64 i = 0; i < Buckets; i++) src.free_blocks[i] = null;
+        for(u64 i = 0; i < CLASSES; i++) src.free_blocks[i] = null;
+        first_level = src.first_level;
+        second_level = src.second_level;
+        src.first_level = 0;
+        for(u64 i = 0; i < Buckets; i++) src.second_level[i] = 0;
         blocks = rpp::move(src.blocks);
 
         return *this;
@@ -66,37 +91,171 @@ struct Range_Allocator {
         Block* prev_free;
         bool free;
 
-        friend struct Range_Allocator<A, Buckets, Bias>;
+        friend struct Range_Allocator<A, Buckets, Bias, M>;
+        template<Allocator, u64, u64, u64, Range_Mode>
+        friend struct Sharded_Range_Allocator;
     };
     using Range = Block*;
 
     [[nodiscard]] Opt<Range> allocate(u64 size, u64 alignment) noexcept {
+        Thread::Lock lock(mutex);
+        return allocate_locked(size, alignment);
+    }
 
-        assert(size && alignment);
+    // Allocates a range for each size under one lock. Either all allocations succeed, or none
+    // are made and this returns false.
+    [[nodiscard]] bool allocate(Slice<u64> sizes, u64 alignment, Range* out) noexcept {
+        Thread::Lock lock(mutex);
+        return allocate_batch_locked(sizes, alignment, out);
+    }
 
+    void free(Range allocation) noexcept {
         Thread::Lock lock(mutex);
+        free_locked(allocation);
+    }
+
+    void free(Slice<Range> allocations) noexcept {
+        Thread::Lock lock(mutex);
+        for(Range allocation : allocations) free_locked(allocation);
+    }
+
+    struct Stats {
+        u64 free_size = 0;
+        u64 allocated_size = 0;
+        u64 free_blocks = 0;
+        u64 allocated_blocks = 0;
+        u64 bucket_sizes[CLASSES] = {};
+        u64 high_water = 0;
+        u64 largest_free = 0;
+
+        u64 total_frees = 0;
+        u64 total_allocs = 0;
+        u64 total_free_size = 0;
+        u64 total_alloc_size = 0;
+        u64 total_capacity = 0;
 
-        // Find list that contains blocks of size 2^log2(size) to 2*2^log2(size)
-        u8 idx = size_to_idx(size);
-        while(idx < Buckets && !free_blocks[idx]) {
-            idx++;
+        void assert_clear() noexcept {
+            assert(total_allocs == total_frees);
+            assert(total_alloc_size == total_free_size);
+            assert(free_blocks == 1 || (free_blocks == 0 && total_capacity == 0));
+            assert(free_size == total_capacity);
+            assert(allocated_blocks == 0);
+            assert(allocated_size == 0);
+            u64 sum = 0;
+            for(u64 i = 0; i < CLASSES; i++) sum += bucket_sizes[i];
+            assert(sum == free_blocks);
         }
-        if(idx == Buckets) {
-            return {};
+
+        // External fragmentation: the share of free space outside the largest free block.
+        [[nodiscard]] f64 fragmentation() const noexcept {
+            if(!free_size) return 0.0;
+            return 1.0 - static_cast<f64>(largest_free) / static_cast<f64>(free_size);
         }
+    };
+
+    [[nodiscard]] Stats statistics() noexcept {
+        Thread::Lock lock(mutex);
+        Stats result = stats;
+        result.largest_free = largest_free_locked();
+        return result;
+    }
+
+    // The caller copies length bytes from offset from to offset to.
+    struct Move {
+        Range range;
+        u64 from;
+        u64 to;
+        u64 length;
+    };
+
+    // Slides allocated ranges toward the start of the heap, aligning each new offset to
+    // alignment, and moves at most budget bytes in total. A range longer than what is left of
+    // the budget stays in place, but later, shorter ranges may still move up to it. Ranges keep
+    // their identity and are updated to their new offsets before this returns. Moves are in
+    // address order and may overlap the sources of earlier moves, so they must be applied in
+    // order, each as a memmove.
+    [[nodiscard]] Vec<Move, A> compact(u64 alignment, u64 budget = Limits<u64>::max()) noexcept {
+        assert(alignment);
+        Thread::Lock lock(mutex);
+        Vec<Move, A> moves;
+
+        Block* block = first_block_locked();
+        if(!block) return moves;
+
+        u64 cursor = block->start;
+        u64 end = cursor;
+        Block* prev = null;
+        auto link = [&](Block* next) {
+            next->prev_block = prev;
+            next->next_block = null;
+            if(prev) prev->next_block = next;
+            prev = next;
+            cursor = next->start + next->size;
+        };
+        auto gap = [&](u64 until) {
+            if(cursor == until) return;
+            Block* hole = blocks.make(Block{cursor, 0, until - cursor, null, null});
+            insert_free_block(hole);
+            stats.free_blocks += 1;
+            link(hole);
+        };
 
-        // Find block of size that can fit this allocation
-        Block* block = free_blocks[idx];
-        u64 padding = 0;
         while(block) {
-            padding = Math::align(block->start, alignment) - block->start;
-            if(block->size >= size + padding) {
-                break;
+            Block* next = block->next_block;
+            end = block->start + block->size;
+            if(block->free) {
+                remove_free_block(block);
+                blocks.destroy(block);
+                stats.free_blocks -= 1;
+                block = next;
+                continue;
             }
-            block = block->next_free;
-            while(!block && idx < Buckets - 1) {
-                block = free_blocks[++idx];
+            u64 length = block->length();
+            u64 to = Math::align(cursor, alignment);
+            if(to < block->offset && length <= budget) {
+                budget -= length;
+                moves.push(Move{block, block->offset, to, length});
+                u64 size = to + length - cursor;
+                stats.free_size += block->size - size;
+                stats.allocated_size -= block->size - size;
+                block->start = cursor;
+                block->offset = to;
+                block->size = size;
+            } else {
+                gap(block->start);
             }
+            link(block);
+            block = next;
+        }
+        gap(end);
+        return moves;
+    }
+
+private:
+    Thread::Mutex mutex;
+    Free_List<Block, A, Math::KB(4)> blocks;
+    Array<Block*, CLASSES> free_blocks;
+    // Bit i of first_level is set when any class of bucket i has free blocks, and bit j of
+    // second_level[i] when class j of bucket i does.
+    u64 first_level = 0;
+    Array<u64, Buckets> second_level;
+    Stats stats;
+
+    [[nodiscard]] Opt<Range> allocate_locked(u64 size, u64 alignment) noexcept {
+
+        assert(size && alignment);
+
+        // Find block of size that can fit this allocation. In TLSF mode, the first block found
+        // fits unless it is in the last class.
+        u64 idx = M == Range_Mode::tlsf ? fit_idx(size + alignment - 1) : size_to_idx(size);
+        Block* block = null;
+        u64 padding = 0;
+        for(idx = next_class(idx); idx < CLASSES; idx = next_class(idx + 1)) {
+            for(block = free_blocks[idx]; block; block = block->next_free) {
+                padding = Math::align(block->start, alignment) - block->start;
+                if(block->size >= size + padding) break;
+            }
+            if(block) break;
         }
 
         if(!block) {
@@ -136,10 +295,20 @@ struct Range_Allocator {
         return Opt<Range>{block};
     }
 
-    void free(Range allocation) noexcept {
-
-        Thread::Lock lock(mutex);
+    [[nodiscard]] bool allocate_batch_locked(Slice<u64> sizes, u64 alignment,
+                                             Range* out) noexcept {
+        for(u64 i = 0; i < sizes.length(); i++) {
+            if(Opt<Range> range = allocate_locked(sizes[i], alignment); range.ok()) {
+                out[i] = *range;
+                continue;
+            }
+            while(i) free_locked(out[--i]);
+            return false;
+        }
+        return true;
+    }
 
+    void free_locked(Range allocation) noexcept {
         Block* block = allocation;
         Block* prev = block->prev_block;
         Block* next = block->next_block;
@@ -185,72 +354,83 @@ struct Range_Allocator {
         stats.total_free_size += free_size;
     }
 
-    struct Stats {
-        u64 free_size = 0;
-        u64 allocated_size = 0;
-        u64 free_blocks = 0;
-        u64 allocated_blocks = 0;
-        u64 bucket_sizes[Buckets] = {};
-        u64 high_water = 0;
-
-        u64 total_frees = 0;
-        u64 total_allocs = 0;
-        u64 total_free_size = 0;
-        u64 total_alloc_size = 0;
-        u64 total_capacity = 0;
+    // Blocks form one list in address order, so any free block leads back to the first.
+    [[nodiscard]] Block* first_block_locked() noexcept {
+        Block* block = null;
+        u64 idx = next_class(0);
+        if(idx < CLASSES) block = free_blocks[idx];
+        while(block && block->prev_block) block = block->prev_block;
+        return block;
+    }
 
-        void assert_clear() noexcept {
-            assert(total_allocs == total_frees);
-            assert(total_alloc_size == total_free_size);
-            assert(free_blocks == 1 || (free_blocks == 0 && total_capacity == 0));
-            assert(free_size == total_capacity);
-            assert(allocated_blocks == 0);
-            assert(allocated_size == 0);
-            u64 sum = 0;
-            for(u64 i = 0; i < Buckets; i++) sum += bucket_sizes[i];
-            assert(sum == free_blocks);
+    // Only the highest non-empty bucket can hold the largest block.
+    [[nodiscard]] u64 largest_free_locked() noexcept {
+        for(u64 i = CLASSES; i > 0; i--) {
+            u64 largest = 0;
+            for(Block* block = free_blocks[i - 1]; block; block = block->next_free) {
+                largest = Math::max(largest, block->size);
+            }
+            if(largest) return largest;
         }
-    };
+        return 0;
+    }
 
-    [[nodiscard]] Stats statistics() noexcept {
-        return stats;
+    [[nodiscard]] static u64 size_to_idx(u64 size) noexcept {
+        u64 log = Math::log2(size);
+        if(log <= Bias) return size >> (Bias + 1 - SL_LOG2);
+        u64 idx = (log - Bias) * SL + ((size >> (log - SL_LOG2)) & (SL - 1));
+        return Math::min(idx, CLASSES - 1);
     }
 
-private:
-    Thread::Mutex mutex;
-    Free_List<Block, A> blocks;
-    Array<Block*, Buckets> free_blocks;
-    Stats stats;
+    // The first class whose blocks are all at least size, except for the last class.
+    [[nodiscard]] static u64 fit_idx(u64 size) noexcept {
+        u64 log = Math::log2(size);
+        u64 step = log <= Bias ? u64{1} << (Bias + 1 - SL_LOG2) : u64{1} << (log - SL_LOG2);
+        if(size > Limits<u64>::max() - step) return CLASSES - 1;
+        return size_to_idx(size + step - 1);
+    }
 
-    [[nodiscard]] u8 size_to_idx(u64 size) noexcept {
-        u64 idx = Math::log2(size);
-        idx = idx >= Bias ? idx - Bias : 0;
-        return static_cast<u8>(Math::min(idx, Buckets - 1ul));
+    // The first class at or after idx with free blocks, or CLASSES.
+    [[nodiscard]] u64 next_class(u64 idx) const noexcept {
+        if(idx >= CLASSES) return CLASSES;
+        u64 bucket = idx / SL;
+        u64 classes = second_level[bucket] & (Limits<u64>::max() << (idx % SL));
+        if(classes) return bucket * SL + Math::cttz(classes);
+        u64 buckets = bucket + 1 < 64 ? first_level & (Limits<u64>::max() << (bucket + 1)) : 0;
+        if(!buckets) return CLASSES;
+        bucket = Math::cttz(buckets);
+        return bucket * SL + Math::cttz(second_level[bucket]);
     }
 
     void insert_free_block(Block* block) noexcept {
         block->free = true;
-        u8 idx = size_to_idx(block->size);
+        u64 idx = size_to_idx(block->size);
         block->prev_free = null;
         block->next_free = free_blocks[idx];
         if(free_blocks[idx]) free_blocks[idx]->prev_free = block;
         free_blocks[idx] = block;
+        second_level[idx / SL] |= u64{1} << (idx % SL);
+        first_level |= u64{1} << (idx / SL);
         stats.bucket_sizes[idx] += 1;
     }
 
     void remove_free_block(Block* block) noexcept {
         block->free = false;
-        u8 idx = size_to_idx(block->size);
+        u64 idx = size_to_idx(block->size);
         if(block->prev_free) block->prev_free->next_free = block->next_free;
         if(block->next_free) block->next_free->prev_free = block->prev_free;
         if(free_blocks[idx] == block) free_blocks[idx] = block->next_free;
+        if(!free_blocks[idx]) {
+            second_level[idx / SL] &= ~(u64{1} << (idx % SL));
+            if(!second_level[idx / SL]) first_level &= ~(u64{1} << (idx / SL));
+        }
         block->next_free = null;
         block->prev_free = null;
         stats.bucket_sizes[idx] -= 1;
     }
 
     void reset() noexcept {
-        for(u64 i = 0; i < Buckets; i++) {
+        for(u64 i = 0; i < CLASSES; i++) {
             Block* block = free_blocks[i];
             while(block) {
                 Block* next = block->next_free;
@@ -259,8 +439,171 @@ private:
             }
             free_blocks[i] = null;
         }
+        first_level = 0;
+        for(u64 i = 0; i < Buckets; i++) second_level[i] = 0;
         blocks.clear();
     }
+
+    template<Allocator, u64, u64, u64, Range_Mode>
+    friend struct Sharded_Range_Allocator;
+};
+
+// Splits one heap into Shards equal sub-heaps with their own locks, so concurrent threads rarely
+// contend. Each thread starts at a home shard picked from its id. When that shard is locked by
+// another thread or can't fit the range, the allocation moves on to the next shards, so a full or
+// busy shard spills into its neighbors. Ranges never cross shards, so none can be larger than
+// heap_size / Shards.
+template<Allocator A = Mdefault, u64 Shards = 8, u64 Buckets = 24, u64 Bias = 8,
+         Range_Mode M = Range_Mode::first_fit>
+struct Sharded_Range_Allocator {
+
+    using Heap = Range_Allocator<A, Buckets, Bias, M>;
+    using Range = typename Heap::Range;
+
+    static_assert(Shards > 0);
+
+    // Recently freed ranges owned by one thread, handed back to allocations of the same size
+    // class without taking any lock. Not thread-safe: each thread needs its own. The cached
+    // ranges stay allocated in their shards until flushed or evicted, which the destructor does.
+    struct Cache {
+        constexpr static u64 CAPACITY = 16;
+
+        explicit Cache(Sharded_Range_Allocator& allocator) noexcept : allocator{&allocator} {
+        }
+        ~Cache() noexcept {
+            flush();
+        }
+
+        Cache(const Cache&) noexcept = delete;
+        Cache& operator=(const Cache&) noexcept = delete;
+        Cache(Cache&&) noexcept = delete;
+        Cache& operator=(Cache&&) noexcept = delete;
+
+        void flush() noexcept {
+            for(u64 i = 0; i < length; i++) allocator->free(ranges[i]);
+            length = 0;
+        }
+
+    private:
+        Sharded_Range_Allocator* allocator;
+        Range ranges[CAPACITY] = {};
+        u64 length = 0;
+
+        friend struct Sharded_Range_Allocator;
+    };
+
+    Sharded_Range_Allocator() noexcept = default;
+    explicit Sharded_Range_Allocator(u64 heap_size) noexcept
+        : shard_size{heap_size / Shards} {
+        assert(shard_size);
+        for(u64 i = 0; i < Shards; i++) {
+            u64 size = i + 1 == Shards ? heap_size - i * shard_size : shard_size;
+            shards[i] = Heap{size, i * shard_size};
+        }
+    }
+    ~Sharded_Range_Allocator() noexcept = default;
+
+    Sharded_Range_Allocator(const Sharded_Range_Allocator&) noexcept = delete;
+    Sharded_Range_Allocator& operator=(const Sharded_Range_Allocator&) noexcept = delete;
+    Sharded_Range_Allocator(Sharded_Range_Allocator&&) noexcept = delete;
+    Sharded_Range_Allocator& operator=(Sharded_Range_Allocator&&) noexcept = delete;
+
+    [[nodiscard]] Opt<Range> allocate(u64 size, u64 alignment) noexcept {
+        return visit([&](Heap& heap) { return heap.allocate_locked(size, alignment); });
+    }
+
+    // Allocates all the ranges from one shard under a single lock when any shard can fit them,
+    // and from several shards otherwise. Either all allocations succeed, or none are made and
+    // this returns false.
+    [[nodiscard]] bool allocate(Slice<u64> sizes, u64 alignment, Range* out) noexcept {
+        Opt<bool> done = visit([&](Heap& heap) {
+            return heap.allocate_batch_locked(sizes, alignment, out) ? Opt<bool>{true}
+                                                                     : Opt<bool>{};
+        });
+        if(done.ok()) return true;
+        for(u64 i = 0; i < sizes.length(); i++) {
+            if(Opt<Range> range = allocate(sizes[i], alignment); range.ok()) {
+                out[i] = *range;
+                continue;
+            }
+            while(i) free(out[--i]);
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] Opt<Range> allocate(Cache& cache, u64 size, u64 alignment) noexcept {
+        assert(cache.allocator == this);
+        u64 idx = Heap::size_to_idx(size);
+        for(u64 i = cache.length; i > 0; i--) {
+            Range range = cache.ranges[i - 1];
+            u64 padding = Math::align(range->start, alignment) - range->start;
+            if(range->size < size + padding || Heap::size_to_idx(range->size) != idx) {
+                continue;
+            }
+            range->offset = range->start + padding;
+            cache.length--;
+            for(u64 j = i - 1; j < cache.length; j++) cache.ranges[j] = cache.ranges[j + 1];
+            return Opt<Range>{range};
+        }
+        return allocate(size, alignment);
+    }
+
+    void free(Range range) noexcept {
+        shards[shard_of(range)].free(range);
+    }
+
+    void free(Slice<Range> ranges) noexcept {
+        for(Range range : ranges) free(range);
+    }
+
+    // Keeps range in the cache, evicting the least recently freed range when it is full.
+    void free(Cache& cache, Range range) noexcept {
+        assert(cache.allocator == this);
+        if(cache.length == Cache::CAPACITY) {
+            free(cache.ranges[0]);
+            cache.length--;
+            for(u64 j = 0; j < cache.length; j++) cache.ranges[j] = cache.ranges[j + 1];
+        }
+        cache.ranges[cache.length++] = range;
+    }
+
+    [[nodiscard]] Heap& shard(u64 i) noexcept {
+        assert(i < Shards);
+        return shards[i];
+    }
+
+private:
+    [[nodiscard]] u64 shard_of(Range range) const noexcept {
+        return Math::min(range->offset / shard_size, Shards - 1);
+    }
+
+    [[nodiscard]] static u64 home_shard() noexcept {
+        return hash(Thread::this_id()) % Shards;
+    }
+
+    // Tries f on each shard from the home shard on, first skipping shards that are locked, then
+    // waiting for them.
+    template<typename F>
+    [[nodiscard]] auto visit(F f) noexcept -> Invoke_Result<F, Heap&> {
+        u64 home = home_shard();
+        for(u64 i = 0; i < Shards; i++) {
+            Heap& heap = shards[(home + i) % Shards];
+            if(!heap.mutex.try_lock()) continue;
+            auto result = f(heap);
+            heap.mutex.unlock();
+            if(result.ok()) return result;
+        }
+        for(u64 i = 0; i < Shards; i++) {
+            Heap& heap = shards[(home + i) % Shards];
+            Thread::Lock lock(heap.mutex);
+            if(auto result = f(heap); result.ok()) return result;
+        }
+        return {};
+    }
+
+    u64 shard_size = 0;
+    Heap shards[Shards];
 };
 
 } // namespace rpp
@@ -25,12 +25,85 @@ struct Arc_Data {
     Storage<T> value;
 };
 
+template<typename T>
+struct Biased_Data {
+    explicit Biased_Data(Thread::Id owner) noexcept : owner(owner) {
+    }
+
+    // Only the owning thread writes biased, with plain loads and stores; other threads read it
+    // after a drop. The live count is biased + shared, so shared goes negative when references
+    // the owner made are dropped.
+    Thread::Id owner;
+    Thread::Atomic biased{1};
+    Thread::Atomic shared;
+    Storage<T> value;
+};
+
 } // namespace detail
 
-template<typename T, Scalar_Allocator P = Mdefault>
+// A member of one of these types named references makes Rc or Arc intrusive: the count lives in
+// T itself, so the value is allocated on its own and from_this works on any pointer to it.
+struct Rc_Count {
+    u64 value = 0;
+};
+struct Arc_Count {
+    Thread::Atomic value;
+};
+
+template<typename T>
+concept Rc_Intrusive = requires(T& t) {
+    { t.references } -> Same<Rc_Count&>;
+};
+template<typename T>
+concept Arc_Intrusive = requires(T& t) {
+    { t.references } -> Same<Arc_Count&>;
+};
+
+// Non-owning handle to the value of an Rc, Arc, or Biased_Arc that never touches the reference
+// count, so it is free to pass around. It must not outlive the pointer it was borrowed from; dup
+// takes a real reference when the value has to outlive the scope.
+template<typename T, typename P>
+struct Borrow {
+    using Data = typename P::Data;
+
+    Borrow() noexcept = default;
+    ~Borrow() noexcept = default;
+
+    Borrow(const Borrow&) noexcept = default;
+    Borrow& operator=(const Borrow&) noexcept = default;
+    Borrow(Borrow&&) noexcept = default;
+    Borrow& operator=(Borrow&&) noexcept = default;
+
+    [[nodiscard]] T* operator->() const noexcept {
+        assert(data_);
+        return P::value_of(data_);
+    }
+    [[nodiscard]] T& operator*() const noexcept {
+        assert(data_);
+        return *P::value_of(data_);
+    }
+
+    [[nodiscard]] bool ok() const noexcept {
+        return data_ != null;
+    }
+    [[nodiscard]] P dup() const noexcept {
+        return P::share(data_);
+    }
+
+private:
+    explicit Borrow(Data* data) noexcept : data_(data) {
+    }
+
+    Data* data_ = null;
+
+    friend P;
+};
+
+template<typename T, Scalar_Allocator P = Mpool_Classes<>>
 struct Rc {
     using A = Pool_Adaptor<P>;
-    using Data = detail::Rc_Data<T>;
+    constexpr static bool intrusive = Rc_Intrusive<T>;
+    using Data = If<intrusive, T, detail::Rc_Data<T>>;
 
     Rc() noexcept = default;
     ~Rc() noexcept {
@@ -40,34 +113,33 @@ struct Rc {
     template<typename... Args>
         requires Constructable<T, Args...>
     explicit Rc(Args&&... args) noexcept {
-        data_ = A::template make<Data>(static_cast<u64>(1));
-        data_->value.construct(rpp::forward<Args>(args)...);
+        data_ = create(rpp::forward<Args>(args)...);
     }
 
     template<typename... Args>
     [[nodiscard]] static Rc make(Args&&... args) noexcept {
         Rc ret;
-        ret.data_ = A::template make<Data>(static_cast<u64>(1));
-        new(ret.data_->value.data()) T{rpp::forward<Args>(args)...};
+        ret.data_ = create(rpp::forward<Args>(args)...);
         return ret;
     }
 
     static Rc from_this(T* value) noexcept {
-        Rc ret;
-        ret.data_ =
-            reinterpret_cast<Data*>(reinterpret_cast<u8*>(value) - RPP_OFFSETOF(Data, value));
-        ret.data_->references++;
-        return ret;
+        if constexpr(intrusive) {
+            return share(value);
+        } else {
+            return share(
+                reinterpret_cast<Data*>(reinterpret_cast<u8*>(value) - RPP_OFFSETOF(Data, value)));
+        }
     }
 
     Rc(const Rc& src) noexcept = delete;
     Rc& operator=(const Rc& src) noexcept = delete;
 
     [[nodiscard]] Rc dup() const noexcept {
-        Rc ret;
-        ret.data_ = data_;
-        if(data_) data_->references++;
-        return ret;
+        return share(data_);
+    }
+    [[nodiscard]] Borrow<T, Rc> borrow() const noexcept {
+        return Borrow<T, Rc>{data_};
     }
 
     Rc(Rc&& src) noexcept {
@@ -83,23 +155,23 @@ struct Rc {
 
     [[nodiscard]] T* operator->() noexcept {
         assert(data_);
-        return &*data_->value;
+        return value_of(data_);
     }
     [[nodiscard]] const T* operator->() const noexcept {
         assert(data_);
-        return &*data_->value;
+        return value_of(data_);
     }
     [[nodiscard]] T& operator*() noexcept {
         assert(data_);
-        return *data_->value;
+        return *value_of(data_);
     }
     [[nodiscard]] const T& operator*() const noexcept {
         assert(data_);
-        return *data_->value;
+        return *value_of(data_);
     }
 
     [[nodiscard]] u64 references() const noexcept {
-        return data_ ? data_->references : 0;
+        return data_ ? count_of(data_) : 0;
     }
     [[nodiscard]] bool ok() const noexcept {
         return data_ != null;
@@ -109,11 +181,47 @@ struct Rc {
     }
 
 private:
+    [[nodiscard]] static T* value_of(Data* data) noexcept {
+        if constexpr(intrusive) {
+            return data;
+        } else {
+            return &*data->value;
+        }
+    }
+    [[nodiscard]] static u64& count_of(Data* data) noexcept {
+        if constexpr(intrusive) {
+            return data->references.value;
+        } else {
+            return data->references;
+        }
+    }
+
+    template<typename... Args>
+    [[nodiscard]] static Data* create(Args&&... args) noexcept {
+        if constexpr(intrusive) {
+            Data* data = A::template make<T>(rpp::forward<Args>(args)...);
+            count_of(data) = 1;
+            return data;
+        } else {
+            Data* data = A::template make<Data>(static_cast<u64>(1));
+            data->value.construct(rpp::forward<Args>(args)...);
+            return data;
+        }
+    }
+
+    [[nodiscard]] static Rc share(Data* data) noexcept {
+        Rc ret;
+        ret.data_ = data;
+        if(data) count_of(data)++;
+        return ret;
+    }
+
     void drop() noexcept {
         if(!data_) return;
-        data_->references--;
-        if(data_->references == 0) {
-            data_->value.destruct();
+        if(--count_of(data_) == 0) {
+            if constexpr(!intrusive) {
+                data_->value.destruct();
+            }
             A::template destroy<Data>(data_);
         }
         data_ = null;
@@ -121,13 +229,15 @@ private:
 
     Data* data_ = null;
 
+    friend struct Borrow<T, Rc>;
     friend struct Reflect::Refl<Rc<T>>;
 };
 
-template<typename T, Scalar_Allocator P = Mdefault>
+template<typename T, Scalar_Allocator P = Mpool_Classes<>>
 struct Arc {
     using A = Pool_Adaptor<P>;
-    using Data = detail::Arc_Data<T>;
+    constexpr static bool intrusive = Arc_Intrusive<T>;
+    using Data = If<intrusive, T, detail::Arc_Data<T>>;
 
     Arc() noexcept = default;
     ~Arc() noexcept {
@@ -137,34 +247,33 @@ struct Arc {
     template<typename... Args>
         requires Constructable<T, Args...>
     explicit Arc(Args&&... args) noexcept {
-        data_ = A::template make<Data>(Thread::Atomic{1});
-        data_->value.construct(rpp::forward<Args>(args)...);
+        data_ = create(rpp::forward<Args>(args)...);
     }
 
     template<typename... Args>
     [[nodiscard]] static Arc make(Args&&... args) noexcept {
         Arc ret;
-        ret.data_ = A::template make<Data>(Thread::Atomic{1});
-        new(ret.data_->value.data()) T{rpp::forward<Args>(args)...};
+        ret.data_ = create(rpp::forward<Args>(args)...);
         return ret;
     }
 
     static Arc from_this(T* value) noexcept {
-        Arc ret;
-        ret.data_ =
-            reinterpret_cast<Data*>(reinterpret_cast<u8*>(value) - RPP_OFFSETOF(Data, value));
-        ret.data_->references.incr();
-        return ret;
+        if constexpr(intrusive) {
+            return share(value);
+        } else {
+            return share(
+                reinterpret_cast<Data*>(reinterpret_cast<u8*>(value) - RPP_OFFSETOF(Data, value)));
+        }
     }
 
     Arc(const Arc& src) noexcept = delete;
     Arc& operator=(const Arc& src) noexcept = delete;
 
     [[nodiscard]] Arc dup() const noexcept {
-        Arc ret;
-        ret.data_ = data_;
-        if(data_) data_->references.incr();
-        return ret;
+        return share(data_);
+    }
+    [[nodiscard]] Borrow<T, Arc> borrow() const noexcept {
+        return Borrow<T, Arc>{data_};
     }
 
     Arc(Arc&& src) noexcept {
@@ -178,6 +287,145 @@ struct Arc {
         return *this;
     }
 
+    [[nodiscard]] T* operator->() noexcept {
+        assert(data_);
+        return value_of(data_);
+    }
+    [[nodiscard]] const T* operator->() const noexcept {
+        assert(data_);
+        return value_of(data_);
+    }
+    [[nodiscard]] T& operator*() noexcept {
+        assert(data_);
+        return *value_of(data_);
+    }
+    [[nodiscard]] const T& operator*() const noexcept {
+        assert(data_);
+        return *value_of(data_);
+    }
+
+    [[nodiscard]] u64 references() const noexcept {
+        return data_ ? static_cast<u64>(count_of(data_).load(Thread::Order::relaxed)) : 0;
+    }
+    [[nodiscard]] bool ok() const noexcept {
+        return data_ != null;
+    }
+    void clear() {
+        drop();
+    }
+
+private:
+    [[nodiscard]] static T* value_of(Data* data) noexcept {
+        if constexpr(intrusive) {
+            return data;
+        } else {
+            return &*data->value;
+        }
+    }
+    [[nodiscard]] static Thread::Atomic& count_of(Data* data) noexcept {
+        if constexpr(intrusive) {
+            return data->references.value;
+        } else {
+            return data->references;
+        }
+    }
+
+    template<typename... Args>
+    [[nodiscard]] static Data* create(Args&&... args) noexcept {
+        if constexpr(intrusive) {
+            Data* data = A::template make<T>(rpp::forward<Args>(args)...);
+            count_of(data) = Thread::Atomic{1};
+            return data;
+        } else {
+            Data* data = A::template make<Data>(Thread::Atomic{1});
+            data->value.construct(rpp::forward<Args>(args)...);
+            return data;
+        }
+    }
+
+    [[nodiscard]] static Arc share(Data* data) noexcept {
+        Arc ret;
+        ret.data_ = data;
+        if(data) count_of(data).incr(Thread::Order::relaxed);
+        return ret;
+    }
+
+    void drop() noexcept {
+        if(!data_) return;
+        // New references are only made from existing ones, so taking one can be relaxed, but the
+        // last drop must see every other owner's writes before destroying the value.
+        if(count_of(data_).decr(Thread::Order::acq_rel) == 0) {
+            if constexpr(!intrusive) {
+                data_->value.destruct();
+            }
+            A::template destroy<Data>(data_);
+        }
+        data_ = null;
+    }
+
+    Data* data_ = null;
+
+    friend struct Borrow<T, Arc>;
+    friend struct Reflect::Refl<Arc<T>>;
+};
+
+// Arc with a biased reference count: the thread that made the value counts the references it
+// makes with plain arithmetic, and only other threads touch the shared atomic count when they
+// duplicate. Values that are mostly duplicated by one thread then stay in that core's cache.
+//
+// Drops may happen on any thread, so they all go through the shared count. The drop that brings
+// biased + shared to zero destroys the value.
+template<typename T, Scalar_Allocator P = Mpool_Classes<>>
+struct Biased_Arc {
+    using A = Pool_Adaptor<P>;
+    using Data = detail::Biased_Data<T>;
+
+    Biased_Arc() noexcept = default;
+    ~Biased_Arc() noexcept {
+        drop();
+    }
+
+    template<typename... Args>
+        requires Constructable<T, Args...>
+    explicit Biased_Arc(Args&&... args) noexcept {
+        data_ = A::template make<Data>(Thread::this_id());
+        data_->value.construct(rpp::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    [[nodiscard]] static Biased_Arc make(Args&&... args) noexcept {
+        Biased_Arc ret;
+        ret.data_ = A::template make<Data>(Thread::this_id());
+        new(ret.data_->value.data()) T{rpp::forward<Args>(args)...};
+        return ret;
+    }
+
+    static Biased_Arc from_this(T* value) noexcept {
+        return share(
+            reinterpret_cast<Data*>(reinterpret_cast<u8*>(value) - RPP_OFFSETOF(Data, value)));
+    }
+
+    Biased_Arc(const Biased_Arc& src) noexcept = delete;
+    Biased_Arc& operator=(const Biased_Arc& src) noexcept = delete;
+
+    [[nodiscard]] Biased_Arc dup() const noexcept {
+        return share(data_);
+    }
+    [[nodiscard]] Borrow<T, Biased_Arc> borrow() const noexcept {
+        return Borrow<T, Biased_Arc>{data_};
+    }
+
+    Biased_Arc(Biased_Arc&& src) noexcept {
+        data_ = src.data_;
+        src.data_ = null;
+    }
+    Biased_Arc& operator=(Biased_Arc&& src) noexcept {
+        drop();
+        data_ = src.data_;
+        src.data_ = null;
+        return *this;
+    }
+
     [[nodiscard]] T* operator->() noexcept {
         assert(data_);
         return &*data_->value;
@@ -195,8 +443,12 @@ struct Arc {
         return *data_->value;
     }
 
+    // Exact on the owning thread. Elsewhere the owner's latest references may not be visible yet.
     [[nodiscard]] u64 references() const noexcept {
-        return data_ ? data_->references.load() : 0;
+        if(!data_) return 0;
+        i64 count = data_->biased.load(Thread::Order::relaxed) +
+                    data_->shared.load(Thread::Order::relaxed);
+        return static_cast<u64>(Math::max<i64>(count, 1));
     }
     [[nodiscard]] bool ok() const noexcept {
         return data_ != null;
@@ -206,9 +458,35 @@ struct Arc {
     }
 
 private:
+    [[nodiscard]] static T* value_of(Data* data) noexcept {
+        return &*data->value;
+    }
+
+    [[nodiscard]] static bool biased(Data* data) noexcept {
+        return data->owner == Thread::this_id();
+    }
+
+    [[nodiscard]] static Biased_Arc share(Data* data) noexcept {
+        Biased_Arc ret;
+        ret.data_ = data;
+        if(!data) return ret;
+        if(biased(data)) {
+            data->biased.store(data->biased.load(Thread::Order::relaxed) + 1,
+                               Thread::Order::relaxed);
+        } else {
+            data->shared.fetch_add(1, Thread::Order::relaxed);
+        }
+        return ret;
+    }
+
     void drop() noexcept {
         if(!data_) return;
-        if(data_->references.decr() == 0) {
+        // Every drop is ordered by the shared count, so only the last one can see a zero total.
+        // The biased count only grows; a stale read here misses only references made from one
+        // that is still alive, which keeps the total above zero.
+        i64 prev = data_->shared.fetch_sub(1, Thread::Order::acq_rel);
+        bool last = data_->biased.load(Thread::Order::relaxed) + prev == 1;
+        if(last) {
             data_->value.destruct();
             A::template destroy<Data>(data_);
         }
@@ -217,7 +495,7 @@ private:
 
     Data* data_ = null;
 
-    friend struct Reflect::Refl<Arc<T>>;
+    friend struct Borrow<T, Biased_Arc>;
 };
 
 template<typename T>
@@ -236,7 +514,7 @@ RPP_TEMPLATE_RECORD(Arc, T, RPP_FIELD(data_));
 
 namespace Format {
 
-template<Reflectable T, Allocator A>
+template<Reflectable T, Scalar_Allocator A>
 struct Measure<Rc<T, A>> {
     [[nodiscard]] static u64 measure(const Rc<T, A>& rc) noexcept {
         if(rc.ok())
@@ -245,7 +523,7 @@ struct Measure<Rc<T, A>> {
         return 8;
     }
 };
-template<Reflectable T, Allocator A>
+template<Reflectable T, Scalar_Allocator A>
 struct Measure<Arc<T, A>> {
     [[nodiscard]] static u64 measure(const Arc<T, A>& arc) noexcept {
         if(arc.ok())
@@ -255,7 +533,17 @@ struct Measure<Arc<T, A>> {
     }
 };
 
-template<Allocator O, Reflectable T, Allocator A>
+template<Reflectable T, Scalar_Allocator A>
+struct Measure<Biased_Arc<T, A>> {
+    [[nodiscard]] static u64 measure(const Biased_Arc<T, A>& arc) noexcept {
+        if(arc.ok())
+            return 14 + Measure<T>::measure(*arc) +
+                   Measure<decltype(arc.references())>::measure(arc.references());
+        return 16;
+    }
+};
+
+template<Allocator O, Reflectable T, Scalar_Allocator A>
 struct Write<O, Rc<T, A>> {
     [[nodiscard]] static u64 write(String<O>& output, u64 idx, const Rc<T, A>& rc) noexcept {
         if(!rc.ok()) return output.write(idx, "Rc{null}"_v);
@@ -266,7 +554,7 @@ struct Write<O, Rc<T, A>> {
         return output.write(idx, '}');
     }
 };
-template<Allocator O, Reflectable T, Allocator A>
+template<Allocator O, Reflectable T, Scalar_Allocator A>
 struct Write<O, Arc<T, A>> {
     [[nodiscard]] static u64 write(String<O>& output, u64 idx, const Arc<T, A>& arc) noexcept {
         if(!arc.ok()) return output.write(idx, "Arc{null}"_v);
@@ -278,6 +566,19 @@ struct Write<O, Arc<T, A>> {
     }
 };
 
+template<Allocator O, Reflectable T, Scalar_Allocator A>
+struct Write<O, Biased_Arc<T, A>> {
+    [[nodiscard]] static u64 write(String<O>& output, u64 idx,
+                                   const Biased_Arc<T, A>& arc) noexcept {
+        if(!arc.ok()) return output.write(idx, "Biased_Arc{null}"_v);
+        idx = output.write(idx, "Biased_Arc["_v);
+        idx = Write<O, decltype(arc.references())>::write(output, idx, arc.references());
+        idx = output.write(idx, "]{"_v);
+        idx = Write<O, T>::write(output, idx, *arc);
+        return output.write(idx, '}');
+    }
+};
+
 } // namespace Format
 
 } // namespace rpp
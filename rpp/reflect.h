@@ -199,6 +199,32 @@ struct Rerverse<Cons<Head, Tail>, Acc> {
     using type = typename Rerverse<Tail, Cons<Head, Acc>>::type;
 };
 
+template<typename L, u64 I>
+struct Nth;
+
+template<typename H, typename T>
+struct Nth<Cons<H, T>, 0> {
+    using type = H;
+};
+
+template<typename H, typename T, u64 I>
+struct Nth<Cons<H, T>, I> {
+    using type = typename Nth<T, I - 1>::type;
+};
+
+template<typename L, Literal N, u64 I = 0>
+struct Index_Of;
+
+template<Literal N, u64 I>
+struct Index_Of<Nil, N, I> {
+    constexpr static u64 value = I;
+};
+
+template<typename H, typename T, Literal N, u64 I>
+struct Index_Of<Cons<H, T>, N, I> {
+    constexpr static u64 value = H::name == N ? I : Index_Of<T, N, I + 1>::value;
+};
+
 template<u64 N, typename... Ts>
 struct Enumerated;
 
@@ -229,6 +255,13 @@ using Enumerate = typename detail::Enumerated<0, Ts...>::type;
 template<Type_List L>
 constexpr u64 List_Length = detail::Length<L>::value;
 
+template<Type_List L, u64 I>
+using Nth = typename detail::Nth<L, I>::type;
+
+// The index of the field or case named N, or the length of the list if there is none.
+template<Type_List L, Literal N>
+constexpr u64 Index_Of = detail::Index_Of<L, N>::value;
+
 template<typename P, typename L>
 concept All = Type_List<L> && detail::All<P, L>::value;
 
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "base.h"
+#include "simd.h"
 
 namespace rpp::RNG {
 
@@ -65,4 +66,131 @@ private:
     u64 state = 0;
 };
 
+namespace detail {
+
+constexpr u32 BIT_NOISE1 = 0xd2a80a3fu;
+constexpr u32 BIT_NOISE2 = 0xa884f197u;
+constexpr u32 BIT_NOISE3 = 0x6c736f4bu;
+constexpr u32 BIT_NOISE4 = 0xb79f3abbu;
+constexpr u32 BIT_NOISE5 = 0x1b56c4f5u;
+
+} // namespace detail
+
+// SquirrelNoise5: the 32-bit noise function Hash::squirrel5 widens, seeded. Lanes evaluates it
+// eight positions at a time.
+[[nodiscard]] constexpr u32 noise(u32 position, u32 seed) noexcept {
+    using namespace detail;
+    u32 bits = position * BIT_NOISE1;
+    bits += seed;
+    bits ^= bits >> 9;
+    bits += BIT_NOISE2;
+    bits ^= bits >> 11;
+    bits *= BIT_NOISE3;
+    bits ^= bits >> 13;
+    bits += BIT_NOISE4;
+    bits ^= bits >> 15;
+    bits *= BIT_NOISE5;
+    bits ^= bits >> 17;
+    return bits;
+}
+
+// Counter-based generator with eight independent lanes, for filling buffers eight samples at a
+// time. Sample n of lane i is noise(n, seed_i), where the lane seeds hash the stream's seed, its
+// substream id and the upper half of n. Jumping ahead is constant time, and substreams with
+// different ids share no state, so each worker of a pool can draw from its own reproducible
+// substream of one seed.
+struct Lanes {
+
+    constexpr static u64 WIDTH = 8;
+
+    explicit Lanes(u64 seed, u64 substream = 0) noexcept : key{hash(seed, substream)} {
+        rekey();
+    }
+
+    // Position of the next sample in each lane.
+    [[nodiscard]] u64 position() const noexcept {
+        return at;
+    }
+    // Skips n samples in every lane.
+    void jump(u64 n) noexcept {
+        at += n;
+        spare = false;
+    }
+
+    [[nodiscard]] SIMD::I32x8 bits() noexcept {
+        using namespace detail;
+        using SIMD::I32x8;
+        auto set1 = [](u32 v) { return I32x8::set1(static_cast<i32>(v)); };
+        if(static_cast<u32>(at >> 32) != high) rekey();
+        // All lanes share the position, so the first product is the same in each.
+        I32x8 v = set1(static_cast<u32>(at) * BIT_NOISE1);
+        v = I32x8::add(v, I32x8::load(seeds));
+        v = I32x8::bit_xor(v, I32x8::shr(v, 9));
+        v = I32x8::add(v, set1(BIT_NOISE2));
+        v = I32x8::bit_xor(v, I32x8::shr(v, 11));
+        v = I32x8::mul(v, set1(BIT_NOISE3));
+        v = I32x8::bit_xor(v, I32x8::shr(v, 13));
+        v = I32x8::add(v, set1(BIT_NOISE4));
+        v = I32x8::bit_xor(v, I32x8::shr(v, 15));
+        v = I32x8::mul(v, set1(BIT_NOISE5));
+        v = I32x8::bit_xor(v, I32x8::shr(v, 17));
+        at++;
+        return v;
+    }
+
+    // Uniform in [0, 1), from the top 24 bits of each lane.
+    [[nodiscard]] SIMD::F32x8 uniform() noexcept {
+        using SIMD::F32x8;
+        F32x8 top = F32x8::from_i32(SIMD::I32x8::shr(bits(), 8));
+        return F32x8::mul(top, F32x8::set1(1.0f / 16777216.0f));
+    }
+
+    // Standard normal, by the Box-Muller transform on two uniform samples. Each transform yields
+    // two normals, so every other call returns the one kept from the call before.
+    [[nodiscard]] SIMD::F32x8 normal() noexcept {
+        using SIMD::F32x8;
+        if(spare) {
+            spare = false;
+            return F32x8::load(spare_normal);
+        }
+        F32x8 u = F32x8::sub(F32x8::set1(1.0f), uniform());
+        F32x8 r = F32x8::sqrt(F32x8::mul(F32x8::set1(-2.0f), F32x8::log(u)));
+        F32x8 theta = F32x8::mul(uniform(), F32x8::set1(2.0f * Math::PI32));
+        F32x8::store(F32x8::mul(r, F32x8::sin(theta)), spare_normal);
+        spare = true;
+        return F32x8::mul(r, F32x8::cos(theta));
+    }
+
+    void uniform(f32* out, u64 length) noexcept {
+        fill(out, length, [this]() { return uniform(); });
+    }
+    void normal(f32* out, u64 length) noexcept {
+        fill(out, length, [this]() { return normal(); });
+    }
+
+private:
+    template<typename F>
+    void fill(f32* out, u64 length, F next) noexcept {
+        u64 i = 0;
+        for(; i + WIDTH <= length; i += WIDTH) SIMD::F32x8::store(next(), out + i);
+        if(i < length) {
+            f32 tail[WIDTH];
+            SIMD::F32x8::store(next(), tail);
+            for(u64 j = 0; i + j < length; j++) out[i + j] = tail[j];
+        }
+    }
+
+    void rekey() noexcept {
+        high = static_cast<u32>(at >> 32);
+        for(u64 i = 0; i < WIDTH; i++) seeds[i] = static_cast<i32>(hash(key, high, i));
+    }
+
+    u64 key = 0;
+    u64 at = 0;
+    u32 high = 0;
+    bool spare = false;
+    i32 seeds[WIDTH] = {};
+    f32 spare_normal[WIDTH] = {};
+};
+
 } // namespace rpp::RNG
@@ -0,0 +1,424 @@
+#pragma once
+
+#include "base.h"
+
+namespace rpp::Serialize {
+
+using namespace Reflect;
+
+// Fixed integers are written as their native little-endian bytes. Varint integers use LEB128,
+// zigzag encoded when signed, which is smaller for typical counts and ids but disables the
+// memcpy paths, since in-memory integers no longer match the encoding.
+enum class Integers : u8 { fixed, varint };
+
+template<Reflectable T>
+struct Encode;
+
+namespace detail {
+
+template<Int T>
+using Unsigned = If<sizeof(T) == 1, u8, If<sizeof(T) == 2, u16, If<sizeof(T) == 4, u32, u64>>>;
+
+} // namespace detail
+
+template<Allocator A, Integers I = Integers::fixed>
+struct Writer {
+
+    explicit Writer(Vec<u8, A>& output) noexcept : output{output} {
+    }
+
+    void bytes(const void* data, u64 length) noexcept {
+        if(!length) return;
+        u64 at = output.length();
+        output.extend(length);
+        Libc::memcpy(output.data() + at, data, length);
+    }
+
+    template<Int T>
+    void integer(T value) noexcept {
+        if constexpr(I == Integers::fixed) {
+            bytes(&value, sizeof(T));
+        } else if constexpr(Signed_Int<T>) {
+            using U = detail::Unsigned<T>;
+            U bits = static_cast<U>(value);
+            varint(static_cast<U>((bits << 1) ^ static_cast<U>(value >> (sizeof(T) * 8 - 1))));
+        } else {
+            varint(value);
+        }
+    }
+
+    void length(u64 value) noexcept {
+        integer(value);
+    }
+
+    template<Reflectable T>
+    void write(const T& value) noexcept {
+        Encode<T>::write(*this, value);
+    }
+
+private:
+    void varint(u64 value) noexcept {
+        u8 buffer[10];
+        u64 n = 0;
+        while(value >= 0x80) {
+            buffer[n++] = static_cast<u8>(value | 0x80);
+            value >>= 7;
+        }
+        buffer[n++] = static_cast<u8>(value);
+        bytes(buffer, n);
+    }
+
+    Vec<u8, A>& output;
+};
+
+// Reads values back from a slice of bytes. Every read checks the remaining input, so truncated
+// or corrupt input makes reads fail instead of overrunning. Once a read fails, the reader is
+// left in an unspecified position.
+template<Integers I = Integers::fixed>
+struct Reader {
+
+    explicit Reader(Slice<u8> input) noexcept : input{input} {
+    }
+
+    [[nodiscard]] u64 remaining() const noexcept {
+        return input.length() - cursor;
+    }
+    [[nodiscard]] bool done() const noexcept {
+        return cursor == input.length();
+    }
+
+    [[nodiscard]] bool bytes(void* data, u64 length) noexcept {
+        if(length > remaining()) return false;
+        if(length) Libc::memcpy(data, input.data() + cursor, length);
+        cursor += length;
+        return true;
+    }
+
+    // Points into the input instead of copying.
+    [[nodiscard]] Opt<Slice<u8>> view(u64 length) noexcept {
+        if(length > remaining()) return {};
+        Slice<u8> result = input.sub(cursor, length);
+        cursor += length;
+        return Opt<Slice<u8>>{result};
+    }
+
+    template<Int T>
+    [[nodiscard]] bool integer(T& value) noexcept {
+        if constexpr(I == Integers::fixed) {
+            return bytes(&value, sizeof(T));
+        } else {
+            using U = detail::Unsigned<T>;
+            u64 bits = 0;
+            if(!varint(bits) || bits > Limits<U>::max()) return false;
+            U result = static_cast<U>(bits);
+            if constexpr(Signed_Int<T>) {
+                value = static_cast<T>(static_cast<U>(result >> 1) ^ static_cast<U>(-(result & 1)));
+            } else {
+                value = result;
+            }
+            return true;
+        }
+    }
+
+    // Lengths are bounded by the remaining input, so corrupt lengths can't cause huge
+    // allocations. Every element takes at least min_size bytes.
+    [[nodiscard]] bool length(u64& value, u64 min_size = 1) noexcept {
+        if(!integer(value)) return false;
+        return !min_size || value <= remaining() / min_size;
+    }
+
+    template<Reflectable T>
+    [[nodiscard]] bool read(T& value) noexcept {
+        return Encode<T>::read(*this, value);
+    }
+
+private:
+    [[nodiscard]] bool varint(u64& value) noexcept {
+        value = 0;
+        for(u64 shift = 0; shift < 64; shift += 7) {
+            if(done()) return false;
+            u8 byte = input[cursor++];
+            value |= static_cast<u64>(byte & 0x7f) << shift;
+            if(!(byte & 0x80)) return shift < 63 || byte <= 1;
+        }
+        return false;
+    }
+
+    Slice<u8> input;
+    u64 cursor = 0;
+};
+
+namespace detail {
+
+template<typename T>
+[[nodiscard]] consteval bool is_raw() noexcept;
+
+struct Raw_Fields {
+    template<typename F>
+    constexpr void apply() noexcept {
+        raw = raw && is_raw<Decay<typename F::type>>();
+        size += sizeof(typename F::type);
+    }
+    bool raw = true;
+    u64 size = 0;
+};
+
+// Raw types encode as their exact in-memory bytes under fixed integers: numbers, and arrays and
+// records of raw types without padding. Bools and enums are excluded so reads can validate them.
+template<typename T>
+[[nodiscard]] consteval bool is_raw() noexcept {
+    if constexpr(Int<T> || Float<T> || Same<T, char>) {
+        return true;
+    } else if constexpr(!Reflectable<T>) {
+        return false;
+    } else if constexpr(Refl<T>::kind == Kind::array_) {
+        using U = typename Refl<T>::underlying;
+        return is_raw<U>() && sizeof(T) == Refl<T>::length * sizeof(U);
+    } else if constexpr(Refl<T>::kind == Kind::record_) {
+        if constexpr(!Trivially_Copyable<T>) {
+            return false;
+        } else {
+            Raw_Fields fields;
+            Iter<Raw_Fields, typename Refl<T>::members>::apply(fields);
+            return fields.raw && fields.size == sizeof(T);
+        }
+    } else {
+        return false;
+    }
+}
+
+template<typename T, Integers I>
+concept Raw = I == Integers::fixed && is_raw<T>();
+
+template<typename W>
+struct Write_Field {
+    template<typename T>
+    void apply(const Literal&, const T& value) noexcept {
+        writer.write(value);
+    }
+    W& writer;
+};
+
+template<typename R>
+struct Read_Field {
+    template<typename T>
+    void apply(const Literal&, T& value) noexcept {
+        ok = ok && reader.read(value);
+    }
+    R& reader;
+    bool ok = true;
+};
+
+} // namespace detail
+
+template<Reflectable T>
+struct Encode {
+    template<Allocator A, Integers I>
+    static void write(Writer<A, I>& writer, const T& value) noexcept {
+        using R = Refl<T>;
+        if constexpr(detail::Raw<T, I>) {
+            writer.bytes(&value, sizeof(T));
+        } else if constexpr(R::kind == Kind::char_ || R::kind == Kind::bool_) {
+            writer.integer(static_cast<u8>(value));
+        } else if constexpr(Int<T>) {
+            writer.integer(value);
+        } else if constexpr(R::kind == Kind::f32_ || R::kind == Kind::f64_) {
+            writer.bytes(&value, sizeof(T));
+        } else if constexpr(R::kind == Kind::enum_) {
+            writer.integer(static_cast<typename R::underlying>(value));
+        } else if constexpr(R::kind == Kind::array_) {
+            for(u64 i = 0; i < R::length; i++) writer.write(value[i]);
+        } else if constexpr(R::kind == Kind::record_) {
+            detail::Write_Field<Writer<A, I>> fields{writer};
+            iterate_record(fields, value);
+        } else {
+            static_assert(R::kind != Kind::pointer_, "Pointers can't be serialized.");
+            static_assert(R::kind != Kind::void_);
+        }
+    }
+
+    template<Integers I>
+    [[nodiscard]] static bool read(Reader<I>& reader, T& value) noexcept {
+        using R = Refl<T>;
+        if constexpr(detail::Raw<T, I>) {
+            return reader.bytes(&value, sizeof(T));
+        } else if constexpr(R::kind == Kind::char_) {
+            u8 c = 0;
+            if(!reader.integer(c)) return false;
+            value = static_cast<char>(c);
+            return true;
+        } else if constexpr(R::kind == Kind::bool_) {
+            u8 b = 0;
+            if(!reader.integer(b) || b > 1) return false;
+            value = b == 1;
+            return true;
+        } else if constexpr(Int<T>) {
+            return reader.integer(value);
+        } else if constexpr(R::kind == Kind::f32_ || R::kind == Kind::f64_) {
+            return reader.bytes(&value, sizeof(T));
+        } else if constexpr(R::kind == Kind::enum_) {
+            typename R::underlying bits{};
+            if(!reader.integer(bits)) return false;
+            bool known = false;
+            iterate_enum<T>([&](const Literal&, T check) {
+                if(static_cast<typename R::underlying>(check) == bits) known = true;
+            });
+            if(known) value = static_cast<T>(bits);
+            return known;
+        } else if constexpr(R::kind == Kind::array_) {
+            for(u64 i = 0; i < R::length; i++) {
+                if(!reader.read(value[i])) return false;
+            }
+            return true;
+        } else if constexpr(R::kind == Kind::record_) {
+            detail::Read_Field<Reader<I>> fields{reader};
+            iterate_record(fields, value);
+            return fields.ok;
+        } else {
+            static_assert(R::kind != Kind::pointer_, "Pointers can't be serialized.");
+            static_assert(R::kind != Kind::void_);
+            return false;
+        }
+    }
+};
+
+template<Reflectable T, Allocator VA>
+struct Encode<Vec<T, VA>> {
+    template<Allocator A, Integers I>
+    static void write(Writer<A, I>& writer, const Vec<T, VA>& vec) noexcept {
+        writer.length(vec.length());
+        if constexpr(detail::Raw<T, I>) {
+            writer.bytes(vec.data(), vec.length() * sizeof(T));
+        } else {
+            for(const T& value : vec) writer.write(value);
+        }
+    }
+
+    template<Integers I>
+    [[nodiscard]] static bool read(Reader<I>& reader, Vec<T, VA>& vec) noexcept
+        requires Default_Constructable<T>
+    {
+        u64 length = 0;
+        if constexpr(detail::Raw<T, I>) {
+            if(!reader.length(length, sizeof(T))) return false;
+            vec = Vec<T, VA>::make(length);
+            return reader.bytes(vec.data(), length * sizeof(T));
+        } else {
+            if(!reader.length(length)) return false;
+            vec = Vec<T, VA>(length);
+            for(u64 i = 0; i < length; i++) {
+                T value{};
+                if(!reader.read(value)) return false;
+                vec.push(rpp::move(value));
+            }
+            return true;
+        }
+    }
+};
+
+template<Allocator SA>
+struct Encode<String<SA>> {
+    template<Allocator A, Integers I>
+    static void write(Writer<A, I>& writer, const String<SA>& string) noexcept {
+        writer.length(string.length());
+        writer.bytes(string.data(), string.length());
+    }
+
+    template<Integers I>
+    [[nodiscard]] static bool read(Reader<I>& reader, String<SA>& string) noexcept {
+        u64 length = 0;
+        if(!reader.length(length)) return false;
+        string = String<SA>(length);
+        string.set_length(length);
+        return reader.bytes(string.data(), length);
+    }
+};
+
+// Views read back point into the reader's input.
+template<>
+struct Encode<String_View> {
+    template<Allocator A, Integers I>
+    static void write(Writer<A, I>& writer, String_View string) noexcept {
+        writer.length(string.length());
+        writer.bytes(string.data(), string.length());
+    }
+
+    template<Integers I>
+    [[nodiscard]] static bool read(Reader<I>& reader, String_View& string) noexcept {
+        u64 length = 0;
+        if(!reader.length(length)) return false;
+        Opt<Slice<u8>> bytes = reader.view(length);
+        if(!bytes.ok()) return false;
+        string = String_View{bytes->data(), length};
+        return true;
+    }
+};
+
+template<Reflectable T>
+struct Encode<Opt<T>> {
+    template<Allocator A, Integers I>
+    static void write(Writer<A, I>& writer, const Opt<T>& opt) noexcept {
+        writer.write(opt.ok());
+        if(opt.ok()) writer.write(*opt);
+    }
+
+    template<Integers I>
+    [[nodiscard]] static bool read(Reader<I>& reader, Opt<T>& opt) noexcept
+        requires Default_Constructable<T>
+    {
+        bool ok = false;
+        if(!reader.read(ok)) return false;
+        if(!ok) {
+            opt = Opt<T>{};
+            return true;
+        }
+        T value{};
+        if(!reader.read(value)) return false;
+        opt = Opt<T>{rpp::move(value)};
+        return true;
+    }
+};
+
+template<Reflectable K, Reflectable V, Allocator MA>
+struct Encode<Map<K, V, MA>> {
+    template<Allocator A, Integers I>
+    static void write(Writer<A, I>& writer, const Map<K, V, MA>& map) noexcept {
+        writer.length(map.length());
+        for(const auto& pair : map) {
+            writer.write(pair.first);
+            writer.write(pair.second);
+        }
+    }
+
+    template<Integers I>
+    [[nodiscard]] static bool read(Reader<I>& reader, Map<K, V, MA>& map) noexcept
+        requires Default_Constructable<K> && Default_Constructable<V>
+    {
+        u64 length = 0;
+        if(!reader.length(length)) return false;
+        map = length ? Map<K, V, MA>(length + length / 3 + 1) : Map<K, V, MA>{};
+        for(u64 i = 0; i < length; i++) {
+            K key{};
+            V value{};
+            if(!reader.read(key) || !reader.read(value)) return false;
+            map.insert(rpp::move(key), rpp::move(value));
+        }
+        return true;
+    }
+};
+
+// Appends the encoding of value to output.
+template<Integers I = Integers::fixed, Allocator A, Reflectable T>
+void write(Vec<u8, A>& output, const T& value) noexcept {
+    Writer<A, I> writer{output};
+    writer.write(value);
+}
+
+// Decodes value from all of input. Fails if input is malformed or has bytes left over.
+template<Integers I = Integers::fixed, Reflectable T>
+[[nodiscard]] bool read(Slice<u8> input, T& value) noexcept {
+    Reader<I> reader{input};
+    return reader.read(value) && reader.done();
+}
+
+} // namespace rpp::Serialize
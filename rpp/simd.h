@@ -3,11 +3,41 @@
 
 #include "base.h"
 
+#define RPP_SIMD
+
 // The implementation of these functions are compiled with SSE on MSVC x86-64 and gcc/clang vector
 // intrinsics on everything else.
+//
+// They are defined out of line in impl/simd.cpp by default. With RPP_SIMD_INLINE they are instead
+// defined in simd1.h and force-inlined into every caller, so vector math compiles to registers
+// without LTO, at the cost of compile time.
+
+#ifdef RPP_SIMD_INLINE
+#define RPP_SIMD_API RPP_FORCE_INLINE
+#else
+#define RPP_SIMD_API
+#endif
 
 namespace rpp::SIMD {
 
+// Vector widths are fixed when compiling: clang lowers its vector extensions to the widest
+// instructions the target enables, such as AVX2 or NEON, and MSVC uses AVX2 for 8-wide types
+// under /arch:AVX2 and pairs of SSE4 registers otherwise. Binaries that ship for a baseline can
+// check features() to pick between kernels compiled for different targets.
+struct Features {
+    bool sse4 = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool neon = false;
+};
+[[nodiscard]] const Features& features() noexcept;
+
+struct I32x4;
+struct I32x8;
+
+// Comparisons return masks: integer vectors with all bits set in the lanes where they hold.
+// Select takes lanes of a where the mask is set and lanes of b elsewhere.
+
 struct F32x4 {
 #ifdef RPP_COMPILER_MSVC
     alignas(16) f32 data[4];
@@ -20,17 +50,213 @@ struct F32x4 {
     [[nodiscard]] static F32x4 set(f32 x, f32 y, f32 z, f32 w) noexcept;
     [[nodiscard]] static F32x4 zero() noexcept;
     [[nodiscard]] static F32x4 one() noexcept;
+    [[nodiscard]] static F32x4 load(const f32* src) noexcept;
+    [[nodiscard]] static F32x4 load(Slice<f32> src, u64 offset = 0) noexcept;
+    static void store(F32x4 a, f32* dst) noexcept;
+    [[nodiscard]] static F32x4 gather(const f32* base, I32x4 idx) noexcept;
     [[nodiscard]] static F32x4 add(F32x4 a, F32x4 b) noexcept;
     [[nodiscard]] static F32x4 sub(F32x4 a, F32x4 b) noexcept;
     [[nodiscard]] static F32x4 mul(F32x4 a, F32x4 b) noexcept;
     [[nodiscard]] static F32x4 div(F32x4 a, F32x4 b) noexcept;
+    // a * b + c, fused where the target supports it.
+    [[nodiscard]] static F32x4 fma(F32x4 a, F32x4 b, F32x4 c) noexcept;
     [[nodiscard]] static F32x4 min(F32x4 a, F32x4 b) noexcept;
     [[nodiscard]] static F32x4 max(F32x4 a, F32x4 b) noexcept;
     [[nodiscard]] static F32x4 floor(F32x4 a) noexcept;
     [[nodiscard]] static F32x4 ceil(F32x4 a) noexcept;
     [[nodiscard]] static F32x4 abs(F32x4 a) noexcept;
+    [[nodiscard]] static F32x4 sqrt(F32x4 a) noexcept;
     [[nodiscard]] static f32 dp(F32x4 a, F32x4 b) noexcept;
+    [[nodiscard]] static f32 hsum(F32x4 a) noexcept;
+    [[nodiscard]] static f32 hmin(F32x4 a) noexcept;
+    [[nodiscard]] static f32 hmax(F32x4 a) noexcept;
     [[nodiscard]] static bool cmpeq_all(F32x4 a, F32x4 b) noexcept;
+    [[nodiscard]] static I32x4 cmpeq(F32x4 a, F32x4 b) noexcept;
+    [[nodiscard]] static I32x4 cmplt(F32x4 a, F32x4 b) noexcept;
+    [[nodiscard]] static I32x4 cmple(F32x4 a, F32x4 b) noexcept;
+    [[nodiscard]] static F32x4 select(I32x4 mask, F32x4 a, F32x4 b) noexcept;
+    // Truncates toward zero.
+    [[nodiscard]] static I32x4 to_i32(F32x4 a) noexcept;
+    [[nodiscard]] static F32x4 from_i32(I32x4 a) noexcept;
+    // Reinterprets the bits of each lane.
+    [[nodiscard]] static I32x4 to_bits(F32x4 a) noexcept;
+    [[nodiscard]] static F32x4 from_bits(I32x4 a) noexcept;
+
+    // Polynomial approximations, with maximum errors measured against f64 libm. F32x8 computes
+    // the same lanes. Results for NaN and infinite inputs are unspecified unless noted.
+    //   sin, cos: 2 ulp for |a| <= 100, and absolute error below 1e-6 for |a| <= 1e5.
+    //   exp: 1 ulp. Infinity above 88.72, zero below -87.33, so results never go subnormal.
+    //   log: 1 ulp, including subnormal inputs. log(0) is -inf and log(a < 0) is NaN.
+    //   atan2: 4 ulp. atan2(0, 0) is 0.
+    //   rsqrt: 5 ulp for positive normal inputs, from the hardware estimate and a Newton step.
+    //   pow: exp(b * log(a)) for a >= 0, so its error grows with |b * log(a)|: 32 ulp for a in
+    //   [0.01, 100] and b in [-4, 4]. pow(a, 0) is 1.
+    [[nodiscard]] static F32x4 sin(F32x4 a) noexcept;
+    [[nodiscard]] static F32x4 cos(F32x4 a) noexcept;
+    [[nodiscard]] static F32x4 exp(F32x4 a) noexcept;
+    [[nodiscard]] static F32x4 log(F32x4 a) noexcept;
+    [[nodiscard]] static F32x4 atan2(F32x4 y, F32x4 x) noexcept;
+    [[nodiscard]] static F32x4 rsqrt(F32x4 a) noexcept;
+    [[nodiscard]] static F32x4 pow(F32x4 a, F32x4 b) noexcept;
+
+    template<u32 X, u32 Y, u32 Z, u32 W>
+        requires(X < 4 && Y < 4 && Z < 4 && W < 4)
+    [[nodiscard]] static F32x4 shuffle(F32x4 a) noexcept {
+#ifdef RPP_COMPILER_MSVC
+        return set(a.data[X], a.data[Y], a.data[Z], a.data[W]);
+#else
+        return {__builtin_shufflevector(a.data, a.data, X, Y, Z, W)};
+#endif
+    }
+};
+
+struct F32x8 {
+#ifdef RPP_COMPILER_MSVC
+    alignas(32) f32 data[8];
+#else
+    using f32x8 = f32 __attribute__((ext_vector_type(8)));
+    f32x8 data;
+#endif
+
+    [[nodiscard]] static F32x8 set1(f32 v) noexcept;
+    [[nodiscard]] static F32x8 zero() noexcept;
+    [[nodiscard]] static F32x8 load(const f32* src) noexcept;
+    [[nodiscard]] static F32x8 load(Slice<f32> src, u64 offset = 0) noexcept;
+    static void store(F32x8 a, f32* dst) noexcept;
+    [[nodiscard]] static F32x8 gather(const f32* base, I32x8 idx) noexcept;
+    [[nodiscard]] static F32x8 combine(F32x4 low, F32x4 high) noexcept;
+    [[nodiscard]] static F32x4 low(F32x8 a) noexcept;
+    [[nodiscard]] static F32x4 high(F32x8 a) noexcept;
+    [[nodiscard]] static F32x8 add(F32x8 a, F32x8 b) noexcept;
+    [[nodiscard]] static F32x8 sub(F32x8 a, F32x8 b) noexcept;
+    [[nodiscard]] static F32x8 mul(F32x8 a, F32x8 b) noexcept;
+    [[nodiscard]] static F32x8 div(F32x8 a, F32x8 b) noexcept;
+    [[nodiscard]] static F32x8 fma(F32x8 a, F32x8 b, F32x8 c) noexcept;
+    [[nodiscard]] static F32x8 min(F32x8 a, F32x8 b) noexcept;
+    [[nodiscard]] static F32x8 max(F32x8 a, F32x8 b) noexcept;
+    [[nodiscard]] static F32x8 abs(F32x8 a) noexcept;
+    [[nodiscard]] static F32x8 sqrt(F32x8 a) noexcept;
+    [[nodiscard]] static f32 hsum(F32x8 a) noexcept;
+    [[nodiscard]] static f32 hmin(F32x8 a) noexcept;
+    [[nodiscard]] static f32 hmax(F32x8 a) noexcept;
+    [[nodiscard]] static I32x8 cmpeq(F32x8 a, F32x8 b) noexcept;
+    [[nodiscard]] static I32x8 cmplt(F32x8 a, F32x8 b) noexcept;
+    [[nodiscard]] static I32x8 cmple(F32x8 a, F32x8 b) noexcept;
+    [[nodiscard]] static F32x8 select(I32x8 mask, F32x8 a, F32x8 b) noexcept;
+    [[nodiscard]] static F32x8 floor(F32x8 a) noexcept;
+    [[nodiscard]] static I32x8 to_i32(F32x8 a) noexcept;
+    [[nodiscard]] static F32x8 from_i32(I32x8 a) noexcept;
+    [[nodiscard]] static I32x8 to_bits(F32x8 a) noexcept;
+    [[nodiscard]] static F32x8 from_bits(I32x8 a) noexcept;
+
+    [[nodiscard]] static F32x8 sin(F32x8 a) noexcept;
+    [[nodiscard]] static F32x8 cos(F32x8 a) noexcept;
+    [[nodiscard]] static F32x8 exp(F32x8 a) noexcept;
+    [[nodiscard]] static F32x8 log(F32x8 a) noexcept;
+    [[nodiscard]] static F32x8 atan2(F32x8 y, F32x8 x) noexcept;
+    [[nodiscard]] static F32x8 rsqrt(F32x8 a) noexcept;
+    [[nodiscard]] static F32x8 pow(F32x8 a, F32x8 b) noexcept;
+};
+
+struct I32x4 {
+#ifdef RPP_COMPILER_MSVC
+    alignas(16) i32 data[4];
+#else
+    using i32x4 = i32 __attribute__((ext_vector_type(4)));
+    i32x4 data;
+#endif
+
+    [[nodiscard]] static I32x4 set1(i32 v) noexcept;
+    [[nodiscard]] static I32x4 set(i32 x, i32 y, i32 z, i32 w) noexcept;
+    [[nodiscard]] static I32x4 zero() noexcept;
+    [[nodiscard]] static I32x4 load(const i32* src) noexcept;
+    [[nodiscard]] static I32x4 load(Slice<i32> src, u64 offset = 0) noexcept;
+    static void store(I32x4 a, i32* dst) noexcept;
+    [[nodiscard]] static I32x4 gather(const i32* base, I32x4 idx) noexcept;
+    [[nodiscard]] static I32x4 add(I32x4 a, I32x4 b) noexcept;
+    [[nodiscard]] static I32x4 sub(I32x4 a, I32x4 b) noexcept;
+    // Keeps the low 32 bits of each product.
+    [[nodiscard]] static I32x4 mul(I32x4 a, I32x4 b) noexcept;
+    [[nodiscard]] static I32x4 min(I32x4 a, I32x4 b) noexcept;
+    [[nodiscard]] static I32x4 max(I32x4 a, I32x4 b) noexcept;
+    [[nodiscard]] static I32x4 bit_and(I32x4 a, I32x4 b) noexcept;
+    [[nodiscard]] static I32x4 bit_or(I32x4 a, I32x4 b) noexcept;
+    [[nodiscard]] static I32x4 bit_xor(I32x4 a, I32x4 b) noexcept;
+    [[nodiscard]] static I32x4 shl(I32x4 a, u32 bits) noexcept;
+    // Logical shift, filling with zeros.
+    [[nodiscard]] static I32x4 shr(I32x4 a, u32 bits) noexcept;
+    [[nodiscard]] static i32 hsum(I32x4 a) noexcept;
+    [[nodiscard]] static I32x4 cmpeq(I32x4 a, I32x4 b) noexcept;
+    [[nodiscard]] static I32x4 cmpgt(I32x4 a, I32x4 b) noexcept;
+    [[nodiscard]] static I32x4 select(I32x4 mask, I32x4 a, I32x4 b) noexcept;
+    // Bit i of the result is set when the high bit of lane i is set.
+    [[nodiscard]] static u32 movemask(I32x4 a) noexcept;
+};
+
+struct I32x8 {
+#ifdef RPP_COMPILER_MSVC
+    alignas(32) i32 data[8];
+#else
+    using i32x8 = i32 __attribute__((ext_vector_type(8)));
+    i32x8 data;
+#endif
+
+    [[nodiscard]] static I32x8 set1(i32 v) noexcept;
+    [[nodiscard]] static I32x8 zero() noexcept;
+    [[nodiscard]] static I32x8 load(const i32* src) noexcept;
+    [[nodiscard]] static I32x8 load(Slice<i32> src, u64 offset = 0) noexcept;
+    static void store(I32x8 a, i32* dst) noexcept;
+    [[nodiscard]] static I32x8 gather(const i32* base, I32x8 idx) noexcept;
+    [[nodiscard]] static I32x8 combine(I32x4 low, I32x4 high) noexcept;
+    [[nodiscard]] static I32x4 low(I32x8 a) noexcept;
+    [[nodiscard]] static I32x4 high(I32x8 a) noexcept;
+    [[nodiscard]] static I32x8 add(I32x8 a, I32x8 b) noexcept;
+    [[nodiscard]] static I32x8 sub(I32x8 a, I32x8 b) noexcept;
+    [[nodiscard]] static I32x8 mul(I32x8 a, I32x8 b) noexcept;
+    [[nodiscard]] static I32x8 min(I32x8 a, I32x8 b) noexcept;
+    [[nodiscard]] static I32x8 max(I32x8 a, I32x8 b) noexcept;
+    [[nodiscard]] static I32x8 bit_and(I32x8 a, I32x8 b) noexcept;
+    [[nodiscard]] static I32x8 bit_or(I32x8 a, I32x8 b) noexcept;
+    [[nodiscard]] static I32x8 bit_xor(I32x8 a, I32x8 b) noexcept;
+    [[nodiscard]] static I32x8 shl(I32x8 a, u32 bits) noexcept;
+    [[nodiscard]] static I32x8 shr(I32x8 a, u32 bits) noexcept;
+    [[nodiscard]] static i32 hsum(I32x8 a) noexcept;
+    [[nodiscard]] static I32x8 cmpeq(I32x8 a, I32x8 b) noexcept;
+    [[nodiscard]] static I32x8 cmpgt(I32x8 a, I32x8 b) noexcept;
+    [[nodiscard]] static I32x8 select(I32x8 mask, I32x8 a, I32x8 b) noexcept;
+    [[nodiscard]] static u32 movemask(I32x8 a) noexcept;
+};
+
+struct U8x16 {
+#ifdef RPP_COMPILER_MSVC
+    alignas(16) u8 data[16];
+#else
+    using u8x16 = u8 __attribute__((ext_vector_type(16)));
+    u8x16 data;
+#endif
+
+    [[nodiscard]] static U8x16 set1(u8 v) noexcept;
+    [[nodiscard]] static U8x16 load(const u8* src) noexcept;
+    [[nodiscard]] static U8x16 load(Slice<u8> src, u64 offset = 0) noexcept;
+    static void store(U8x16 a, u8* dst) noexcept;
+    [[nodiscard]] static U8x16 bit_and(U8x16 a, U8x16 b) noexcept;
+    [[nodiscard]] static U8x16 bit_or(U8x16 a, U8x16 b) noexcept;
+    // a & ~b.
+    [[nodiscard]] static U8x16 bit_andnot(U8x16 a, U8x16 b) noexcept;
+    // Wraps around.
+    [[nodiscard]] static U8x16 sub(U8x16 a, U8x16 b) noexcept;
+    [[nodiscard]] static U8x16 min(U8x16 a, U8x16 b) noexcept;
+    [[nodiscard]] static U8x16 cmpeq(U8x16 a, U8x16 b) noexcept;
+    // Lane i of the result is a[idx[i]], or zero where idx[i] is 16 or more.
+    [[nodiscard]] static U8x16 shuffle(U8x16 a, U8x16 idx) noexcept;
+    // Bit i of the result is set when lane i equals v.
+    [[nodiscard]] static u32 cmpeq_mask(U8x16 a, u8 v) noexcept;
+    // Bit i of the result is set when the high bit of lane i is set.
+    [[nodiscard]] static u32 high_mask(U8x16 a) noexcept;
 };
 
 } // namespace rpp::SIMD
+
+#ifdef RPP_SIMD_INLINE
+#include "simd1.h"
+#endif
@@ -0,0 +1,1583 @@
+#pragma once
+
+#ifndef RPP_SIMD
+#error "Include simd.h instead."
+#endif
+
+#ifdef RPP_COMPILER_MSVC
+#include <immintrin.h>
+#elif defined __SSSE3__
+#include <tmmintrin.h>
+#elif defined __SSE2__
+#include <emmintrin.h>
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace rpp::SIMD {
+
+static_assert(sizeof(F32x4) == 16);
+static_assert(alignof(F32x4) == 16);
+static_assert(sizeof(F32x8) == 32);
+static_assert(alignof(F32x8) == 32);
+static_assert(sizeof(I32x4) == 16);
+static_assert(sizeof(I32x8) == 32);
+static_assert(sizeof(U8x16) == 16);
+
+#ifdef RPP_COMPILER_MSVC
+
+[[nodiscard]] RPP_FORCE_INLINE __m128 of(F32x4 a) noexcept {
+    return *reinterpret_cast<__m128*>(a.data);
+}
+
+[[nodiscard]] RPP_FORCE_INLINE F32x4 to(__m128 a) noexcept {
+    return *reinterpret_cast<F32x4*>(&a);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::set1(f32 v) noexcept {
+    return to(_mm_set1_ps(v));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::set(f32 x, f32 y, f32 z, f32 w) noexcept {
+    // Reversed to preserve big-endianness
+    return to(_mm_set_ps(w, z, y, x));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::zero() noexcept {
+    return to(_mm_setzero_ps());
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::one() noexcept {
+    return set1(1.0f);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::add(F32x4 a, F32x4 b) noexcept {
+    return to(_mm_add_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::sub(F32x4 a, F32x4 b) noexcept {
+    return to(_mm_sub_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::mul(F32x4 a, F32x4 b) noexcept {
+    return to(_mm_mul_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::div(F32x4 a, F32x4 b) noexcept {
+    return to(_mm_div_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::min(F32x4 a, F32x4 b) noexcept {
+    return to(_mm_min_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::max(F32x4 a, F32x4 b) noexcept {
+    return to(_mm_max_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::floor(F32x4 a) noexcept {
+    return to(_mm_floor_ps(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::ceil(F32x4 a) noexcept {
+    return to(_mm_ceil_ps(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::abs(F32x4 a) noexcept {
+    return to(_mm_andnot_ps(_mm_set1_ps(-0.0f), of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x4::dp(F32x4 a, F32x4 b) noexcept {
+    return _mm_cvtss_f32(_mm_dp_ps(of(a), of(b), 0xff));
+}
+
+[[nodiscard]] RPP_SIMD_API bool F32x4::cmpeq_all(F32x4 a, F32x4 b) noexcept {
+    return _mm_movemask_ps(_mm_cmpeq_ps(of(a), of(b))) == 0xf;
+}
+
+[[nodiscard]] RPP_FORCE_INLINE __m128i of(U8x16 a) noexcept {
+    return *reinterpret_cast<__m128i*>(a.data);
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::load(const u8* src) noexcept {
+    U8x16 ret;
+    _mm_store_si128(reinterpret_cast<__m128i*>(ret.data),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+    return ret;
+}
+
+[[nodiscard]] RPP_SIMD_API u32 U8x16::cmpeq_mask(U8x16 a, u8 v) noexcept {
+    return static_cast<u32>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(of(a), _mm_set1_epi8(static_cast<char>(v)))));
+}
+
+[[nodiscard]] RPP_SIMD_API u32 U8x16::high_mask(U8x16 a) noexcept {
+    return static_cast<u32>(_mm_movemask_epi8(of(a)));
+}
+
+[[nodiscard]] RPP_FORCE_INLINE __m128i of(I32x4 a) noexcept {
+    return *reinterpret_cast<__m128i*>(a.data);
+}
+
+[[nodiscard]] RPP_FORCE_INLINE I32x4 to_i(__m128i a) noexcept {
+    return *reinterpret_cast<I32x4*>(&a);
+}
+
+[[nodiscard]] RPP_FORCE_INLINE U8x16 to_u8(__m128i a) noexcept {
+    return *reinterpret_cast<U8x16*>(&a);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::load(const f32* src) noexcept {
+    return to(_mm_loadu_ps(src));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::load(Slice<f32> src, u64 offset) noexcept {
+    assert(offset + 4 <= src.length());
+    return load(src.data() + offset);
+}
+
+RPP_SIMD_API void F32x4::store(F32x4 a, f32* dst) noexcept {
+    _mm_storeu_ps(dst, of(a));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::gather(const f32* base, I32x4 idx) noexcept {
+#ifdef __AVX2__
+    return to(_mm_i32gather_ps(base, of(idx), 4));
+#else
+    return set(base[idx.data[0]], base[idx.data[1]], base[idx.data[2]], base[idx.data[3]]);
+#endif
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::fma(F32x4 a, F32x4 b, F32x4 c) noexcept {
+#ifdef __AVX2__
+    return to(_mm_fmadd_ps(of(a), of(b), of(c)));
+#else
+    return add(mul(a, b), c);
+#endif
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::sqrt(F32x4 a) noexcept {
+    return to(_mm_sqrt_ps(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x4::hsum(F32x4 a) noexcept {
+    __m128 v = of(a);
+    __m128 pairs = _mm_add_ps(v, _mm_movehdup_ps(v));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehl_ps(pairs, pairs)));
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x4::hmin(F32x4 a) noexcept {
+    __m128 v = of(a);
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x4::hmax(F32x4 a) noexcept {
+    __m128 v = of(a);
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 F32x4::cmpeq(F32x4 a, F32x4 b) noexcept {
+    return to_i(_mm_castps_si128(_mm_cmpeq_ps(of(a), of(b))));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 F32x4::cmplt(F32x4 a, F32x4 b) noexcept {
+    return to_i(_mm_castps_si128(_mm_cmplt_ps(of(a), of(b))));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 F32x4::cmple(F32x4 a, F32x4 b) noexcept {
+    return to_i(_mm_castps_si128(_mm_cmple_ps(of(a), of(b))));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::select(I32x4 mask, F32x4 a, F32x4 b) noexcept {
+    return to(_mm_blendv_ps(of(b), of(a), _mm_castsi128_ps(of(mask))));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 F32x4::to_i32(F32x4 a) noexcept {
+    return to_i(_mm_cvttps_epi32(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::from_i32(I32x4 a) noexcept {
+    return to(_mm_cvtepi32_ps(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 F32x4::to_bits(F32x4 a) noexcept {
+    return to_i(_mm_castps_si128(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::from_bits(I32x4 a) noexcept {
+    return to(_mm_castsi128_ps(of(a)));
+}
+
+// The estimate is good to 12 bits, and one Newton step roughly doubles that.
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::rsqrt(F32x4 a) noexcept {
+    __m128 e = _mm_rsqrt_ps(of(a));
+    __m128 h = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), of(a)), e);
+    return to(_mm_mul_ps(e, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(h, e))));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::set1(i32 v) noexcept {
+    return to_i(_mm_set1_epi32(v));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::set(i32 x, i32 y, i32 z, i32 w) noexcept {
+    return to_i(_mm_set_epi32(w, z, y, x));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::zero() noexcept {
+    return to_i(_mm_setzero_si128());
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::load(const i32* src) noexcept {
+    return to_i(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::load(Slice<i32> src, u64 offset) noexcept {
+    assert(offset + 4 <= src.length());
+    return load(src.data() + offset);
+}
+
+RPP_SIMD_API void I32x4::store(I32x4 a, i32* dst) noexcept {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), of(a));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::gather(const i32* base, I32x4 idx) noexcept {
+#ifdef __AVX2__
+    return to_i(_mm_i32gather_epi32(base, of(idx), 4));
+#else
+    return set(base[idx.data[0]], base[idx.data[1]], base[idx.data[2]], base[idx.data[3]]);
+#endif
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::add(I32x4 a, I32x4 b) noexcept {
+    return to_i(_mm_add_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::sub(I32x4 a, I32x4 b) noexcept {
+    return to_i(_mm_sub_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::mul(I32x4 a, I32x4 b) noexcept {
+    return to_i(_mm_mullo_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::min(I32x4 a, I32x4 b) noexcept {
+    return to_i(_mm_min_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::max(I32x4 a, I32x4 b) noexcept {
+    return to_i(_mm_max_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::bit_and(I32x4 a, I32x4 b) noexcept {
+    return to_i(_mm_and_si128(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::bit_or(I32x4 a, I32x4 b) noexcept {
+    return to_i(_mm_or_si128(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::bit_xor(I32x4 a, I32x4 b) noexcept {
+    return to_i(_mm_xor_si128(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::shl(I32x4 a, u32 bits) noexcept {
+    return to_i(_mm_sll_epi32(of(a), _mm_cvtsi32_si128(static_cast<i32>(bits))));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::shr(I32x4 a, u32 bits) noexcept {
+    return to_i(_mm_srl_epi32(of(a), _mm_cvtsi32_si128(static_cast<i32>(bits))));
+}
+
+[[nodiscard]] RPP_SIMD_API i32 I32x4::hsum(I32x4 a) noexcept {
+    __m128i v = of(a);
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtsi128_si32(v);
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::cmpeq(I32x4 a, I32x4 b) noexcept {
+    return to_i(_mm_cmpeq_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::cmpgt(I32x4 a, I32x4 b) noexcept {
+    return to_i(_mm_cmpgt_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::select(I32x4 mask, I32x4 a, I32x4 b) noexcept {
+    return to_i(_mm_blendv_epi8(of(b), of(a), of(mask)));
+}
+
+[[nodiscard]] RPP_SIMD_API u32 I32x4::movemask(I32x4 a) noexcept {
+    return static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(of(a))));
+}
+
+#ifdef __AVX2__
+
+[[nodiscard]] RPP_FORCE_INLINE __m256 of(F32x8 a) noexcept {
+    return *reinterpret_cast<__m256*>(a.data);
+}
+
+[[nodiscard]] RPP_FORCE_INLINE F32x8 to(__m256 a) noexcept {
+    return *reinterpret_cast<F32x8*>(&a);
+}
+
+[[nodiscard]] RPP_FORCE_INLINE __m256i of(I32x8 a) noexcept {
+    return *reinterpret_cast<__m256i*>(a.data);
+}
+
+[[nodiscard]] RPP_FORCE_INLINE I32x8 to_i(__m256i a) noexcept {
+    return *reinterpret_cast<I32x8*>(&a);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::set1(f32 v) noexcept {
+    return to(_mm256_set1_ps(v));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::zero() noexcept {
+    return to(_mm256_setzero_ps());
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::load(const f32* src) noexcept {
+    return to(_mm256_loadu_ps(src));
+}
+
+RPP_SIMD_API void F32x8::store(F32x8 a, f32* dst) noexcept {
+    _mm256_storeu_ps(dst, of(a));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::gather(const f32* base, I32x8 idx) noexcept {
+    return to(_mm256_i32gather_ps(base, of(idx), 4));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::combine(F32x4 low, F32x4 high) noexcept {
+    return to(_mm256_set_m128(of(high), of(low)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x8::low(F32x8 a) noexcept {
+    return to(_mm256_castps256_ps128(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x8::high(F32x8 a) noexcept {
+    return to(_mm256_extractf128_ps(of(a), 1));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::add(F32x8 a, F32x8 b) noexcept {
+    return to(_mm256_add_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::sub(F32x8 a, F32x8 b) noexcept {
+    return to(_mm256_sub_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::mul(F32x8 a, F32x8 b) noexcept {
+    return to(_mm256_mul_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::div(F32x8 a, F32x8 b) noexcept {
+    return to(_mm256_div_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::fma(F32x8 a, F32x8 b, F32x8 c) noexcept {
+    return to(_mm256_fmadd_ps(of(a), of(b), of(c)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::min(F32x8 a, F32x8 b) noexcept {
+    return to(_mm256_min_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::max(F32x8 a, F32x8 b) noexcept {
+    return to(_mm256_max_ps(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::abs(F32x8 a) noexcept {
+    return to(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::sqrt(F32x8 a) noexcept {
+    return to(_mm256_sqrt_ps(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::cmpeq(F32x8 a, F32x8 b) noexcept {
+    return to_i(_mm256_castps_si256(_mm256_cmp_ps(of(a), of(b), _CMP_EQ_OQ)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::cmplt(F32x8 a, F32x8 b) noexcept {
+    return to_i(_mm256_castps_si256(_mm256_cmp_ps(of(a), of(b), _CMP_LT_OQ)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::cmple(F32x8 a, F32x8 b) noexcept {
+    return to_i(_mm256_castps_si256(_mm256_cmp_ps(of(a), of(b), _CMP_LE_OQ)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::select(I32x8 mask, F32x8 a, F32x8 b) noexcept {
+    return to(_mm256_blendv_ps(of(b), of(a), _mm256_castsi256_ps(of(mask))));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::floor(F32x8 a) noexcept {
+    return to(_mm256_floor_ps(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::to_i32(F32x8 a) noexcept {
+    return to_i(_mm256_cvttps_epi32(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::from_i32(I32x8 a) noexcept {
+    return to(_mm256_cvtepi32_ps(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::to_bits(F32x8 a) noexcept {
+    return to_i(_mm256_castps_si256(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::from_bits(I32x8 a) noexcept {
+    return to(_mm256_castsi256_ps(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::rsqrt(F32x8 a) noexcept {
+    __m256 e = _mm256_rsqrt_ps(of(a));
+    __m256 h = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), of(a)), e);
+    return to(_mm256_mul_ps(e, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(h, e))));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::set1(i32 v) noexcept {
+    return to_i(_mm256_set1_epi32(v));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::zero() noexcept {
+    return to_i(_mm256_setzero_si256());
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::load(const i32* src) noexcept {
+    return to_i(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)));
+}
+
+RPP_SIMD_API void I32x8::store(I32x8 a, i32* dst) noexcept {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), of(a));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::gather(const i32* base, I32x8 idx) noexcept {
+    return to_i(_mm256_i32gather_epi32(base, of(idx), 4));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::combine(I32x4 low, I32x4 high) noexcept {
+    return to_i(_mm256_set_m128i(of(high), of(low)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x8::low(I32x8 a) noexcept {
+    return to_i(_mm256_castsi256_si128(of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x8::high(I32x8 a) noexcept {
+    return to_i(_mm256_extracti128_si256(of(a), 1));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::add(I32x8 a, I32x8 b) noexcept {
+    return to_i(_mm256_add_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::sub(I32x8 a, I32x8 b) noexcept {
+    return to_i(_mm256_sub_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::mul(I32x8 a, I32x8 b) noexcept {
+    return to_i(_mm256_mullo_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::min(I32x8 a, I32x8 b) noexcept {
+    return to_i(_mm256_min_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::max(I32x8 a, I32x8 b) noexcept {
+    return to_i(_mm256_max_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::bit_and(I32x8 a, I32x8 b) noexcept {
+    return to_i(_mm256_and_si256(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::bit_or(I32x8 a, I32x8 b) noexcept {
+    return to_i(_mm256_or_si256(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::bit_xor(I32x8 a, I32x8 b) noexcept {
+    return to_i(_mm256_xor_si256(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::shl(I32x8 a, u32 bits) noexcept {
+    return to_i(_mm256_sll_epi32(of(a), _mm_cvtsi32_si128(static_cast<i32>(bits))));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::shr(I32x8 a, u32 bits) noexcept {
+    return to_i(_mm256_srl_epi32(of(a), _mm_cvtsi32_si128(static_cast<i32>(bits))));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::cmpeq(I32x8 a, I32x8 b) noexcept {
+    return to_i(_mm256_cmpeq_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::cmpgt(I32x8 a, I32x8 b) noexcept {
+    return to_i(_mm256_cmpgt_epi32(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::select(I32x8 mask, I32x8 a, I32x8 b) noexcept {
+    return to_i(_mm256_blendv_epi8(of(b), of(a), of(mask)));
+}
+
+[[nodiscard]] RPP_SIMD_API u32 I32x8::movemask(I32x8 a) noexcept {
+    return static_cast<u32>(_mm256_movemask_ps(_mm256_castsi256_ps(of(a))));
+}
+
+#else
+
+// Without AVX2, 8-wide operations run on two SSE halves.
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::set1(f32 v) noexcept {
+    return combine(F32x4::set1(v), F32x4::set1(v));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::zero() noexcept {
+    return combine(F32x4::zero(), F32x4::zero());
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::load(const f32* src) noexcept {
+    return combine(F32x4::load(src), F32x4::load(src + 4));
+}
+
+RPP_SIMD_API void F32x8::store(F32x8 a, f32* dst) noexcept {
+    F32x4::store(low(a), dst);
+    F32x4::store(high(a), dst + 4);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::gather(const f32* base, I32x8 idx) noexcept {
+    return combine(F32x4::gather(base, I32x8::low(idx)), F32x4::gather(base, I32x8::high(idx)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::combine(F32x4 low, F32x4 high) noexcept {
+    F32x8 ret;
+    _mm_store_ps(ret.data, of(low));
+    _mm_store_ps(ret.data + 4, of(high));
+    return ret;
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x8::low(F32x8 a) noexcept {
+    return to(_mm_load_ps(a.data));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x8::high(F32x8 a) noexcept {
+    return to(_mm_load_ps(a.data + 4));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::add(F32x8 a, F32x8 b) noexcept {
+    return combine(F32x4::add(low(a), low(b)), F32x4::add(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::sub(F32x8 a, F32x8 b) noexcept {
+    return combine(F32x4::sub(low(a), low(b)), F32x4::sub(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::mul(F32x8 a, F32x8 b) noexcept {
+    return combine(F32x4::mul(low(a), low(b)), F32x4::mul(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::div(F32x8 a, F32x8 b) noexcept {
+    return combine(F32x4::div(low(a), low(b)), F32x4::div(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::fma(F32x8 a, F32x8 b, F32x8 c) noexcept {
+    return combine(F32x4::fma(low(a), low(b), low(c)), F32x4::fma(high(a), high(b), high(c)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::min(F32x8 a, F32x8 b) noexcept {
+    return combine(F32x4::min(low(a), low(b)), F32x4::min(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::max(F32x8 a, F32x8 b) noexcept {
+    return combine(F32x4::max(low(a), low(b)), F32x4::max(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::abs(F32x8 a) noexcept {
+    return combine(F32x4::abs(low(a)), F32x4::abs(high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::sqrt(F32x8 a) noexcept {
+    return combine(F32x4::sqrt(low(a)), F32x4::sqrt(high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::cmpeq(F32x8 a, F32x8 b) noexcept {
+    return I32x8::combine(F32x4::cmpeq(low(a), low(b)), F32x4::cmpeq(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::cmplt(F32x8 a, F32x8 b) noexcept {
+    return I32x8::combine(F32x4::cmplt(low(a), low(b)), F32x4::cmplt(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::cmple(F32x8 a, F32x8 b) noexcept {
+    return I32x8::combine(F32x4::cmple(low(a), low(b)), F32x4::cmple(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::select(I32x8 mask, F32x8 a, F32x8 b) noexcept {
+    return combine(F32x4::select(I32x8::low(mask), low(a), low(b)),
+                   F32x4::select(I32x8::high(mask), high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::floor(F32x8 a) noexcept {
+    return combine(F32x4::floor(low(a)), F32x4::floor(high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::to_i32(F32x8 a) noexcept {
+    return I32x8::combine(F32x4::to_i32(low(a)), F32x4::to_i32(high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::from_i32(I32x8 a) noexcept {
+    return combine(F32x4::from_i32(I32x8::low(a)), F32x4::from_i32(I32x8::high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::to_bits(F32x8 a) noexcept {
+    return I32x8::combine(F32x4::to_bits(low(a)), F32x4::to_bits(high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::from_bits(I32x8 a) noexcept {
+    return combine(F32x4::from_bits(I32x8::low(a)), F32x4::from_bits(I32x8::high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::rsqrt(F32x8 a) noexcept {
+    return combine(F32x4::rsqrt(low(a)), F32x4::rsqrt(high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::set1(i32 v) noexcept {
+    return combine(I32x4::set1(v), I32x4::set1(v));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::zero() noexcept {
+    return combine(I32x4::zero(), I32x4::zero());
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::load(const i32* src) noexcept {
+    return combine(I32x4::load(src), I32x4::load(src + 4));
+}
+
+RPP_SIMD_API void I32x8::store(I32x8 a, i32* dst) noexcept {
+    I32x4::store(low(a), dst);
+    I32x4::store(high(a), dst + 4);
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::gather(const i32* base, I32x8 idx) noexcept {
+    return combine(I32x4::gather(base, low(idx)), I32x4::gather(base, high(idx)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::combine(I32x4 low, I32x4 high) noexcept {
+    I32x8 ret;
+    _mm_store_si128(reinterpret_cast<__m128i*>(ret.data), of(low));
+    _mm_store_si128(reinterpret_cast<__m128i*>(ret.data + 4), of(high));
+    return ret;
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x8::low(I32x8 a) noexcept {
+    return to_i(_mm_load_si128(reinterpret_cast<const __m128i*>(a.data)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x8::high(I32x8 a) noexcept {
+    return to_i(_mm_load_si128(reinterpret_cast<const __m128i*>(a.data + 4)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::add(I32x8 a, I32x8 b) noexcept {
+    return combine(I32x4::add(low(a), low(b)), I32x4::add(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::sub(I32x8 a, I32x8 b) noexcept {
+    return combine(I32x4::sub(low(a), low(b)), I32x4::sub(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::mul(I32x8 a, I32x8 b) noexcept {
+    return combine(I32x4::mul(low(a), low(b)), I32x4::mul(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::min(I32x8 a, I32x8 b) noexcept {
+    return combine(I32x4::min(low(a), low(b)), I32x4::min(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::max(I32x8 a, I32x8 b) noexcept {
+    return combine(I32x4::max(low(a), low(b)), I32x4::max(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::bit_and(I32x8 a, I32x8 b) noexcept {
+    return combine(I32x4::bit_and(low(a), low(b)), I32x4::bit_and(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::bit_or(I32x8 a, I32x8 b) noexcept {
+    return combine(I32x4::bit_or(low(a), low(b)), I32x4::bit_or(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::bit_xor(I32x8 a, I32x8 b) noexcept {
+    return combine(I32x4::bit_xor(low(a), low(b)), I32x4::bit_xor(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::shl(I32x8 a, u32 bits) noexcept {
+    return combine(I32x4::shl(low(a), bits), I32x4::shl(high(a), bits));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::shr(I32x8 a, u32 bits) noexcept {
+    return combine(I32x4::shr(low(a), bits), I32x4::shr(high(a), bits));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::cmpeq(I32x8 a, I32x8 b) noexcept {
+    return combine(I32x4::cmpeq(low(a), low(b)), I32x4::cmpeq(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::cmpgt(I32x8 a, I32x8 b) noexcept {
+    return combine(I32x4::cmpgt(low(a), low(b)), I32x4::cmpgt(high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::select(I32x8 mask, I32x8 a, I32x8 b) noexcept {
+    return combine(I32x4::select(low(mask), low(a), low(b)),
+                   I32x4::select(high(mask), high(a), high(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API u32 I32x8::movemask(I32x8 a) noexcept {
+    return I32x4::movemask(low(a)) | (I32x4::movemask(high(a)) << 4);
+}
+
+#endif // __AVX2__
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::load(Slice<f32> src, u64 offset) noexcept {
+    assert(offset + 8 <= src.length());
+    return load(src.data() + offset);
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::load(Slice<i32> src, u64 offset) noexcept {
+    assert(offset + 8 <= src.length());
+    return load(src.data() + offset);
+}
+
+// Reducing the halves first keeps 8-wide sums in the same order on every target.
+[[nodiscard]] RPP_SIMD_API f32 F32x8::hsum(F32x8 a) noexcept {
+    return F32x4::hsum(F32x4::add(low(a), high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x8::hmin(F32x8 a) noexcept {
+    return F32x4::hmin(F32x4::min(low(a), high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x8::hmax(F32x8 a) noexcept {
+    return F32x4::hmax(F32x4::max(low(a), high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API i32 I32x8::hsum(I32x8 a) noexcept {
+    return I32x4::hsum(I32x4::add(low(a), high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::set1(u8 v) noexcept {
+    return to_u8(_mm_set1_epi8(static_cast<char>(v)));
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::load(Slice<u8> src, u64 offset) noexcept {
+    assert(offset + 16 <= src.length());
+    return load(src.data() + offset);
+}
+
+RPP_SIMD_API void U8x16::store(U8x16 a, u8* dst) noexcept {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), of(a));
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::bit_and(U8x16 a, U8x16 b) noexcept {
+    return to_u8(_mm_and_si128(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::bit_or(U8x16 a, U8x16 b) noexcept {
+    return to_u8(_mm_or_si128(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::bit_andnot(U8x16 a, U8x16 b) noexcept {
+    return to_u8(_mm_andnot_si128(of(b), of(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::sub(U8x16 a, U8x16 b) noexcept {
+    return to_u8(_mm_sub_epi8(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::min(U8x16 a, U8x16 b) noexcept {
+    return to_u8(_mm_min_epu8(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::cmpeq(U8x16 a, U8x16 b) noexcept {
+    return to_u8(_mm_cmpeq_epi8(of(a), of(b)));
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::shuffle(U8x16 a, U8x16 idx) noexcept {
+    // pshufb only zeroes lanes whose index has its high bit set.
+    __m128i saturated = _mm_adds_epu8(of(idx), _mm_set1_epi8(0x70));
+    return to_u8(_mm_shuffle_epi8(of(a), saturated));
+}
+
+#else
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::set(f32 x, f32 y, f32 z, f32 w) noexcept {
+    return {f32x4{x, y, z, w}};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::set1(f32 v) noexcept {
+    return {f32x4{v, v, v, v}};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::zero() noexcept {
+    return set1(0.0f);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::one() noexcept {
+    return set1(1.0f);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::add(F32x4 a, F32x4 b) noexcept {
+    return {a.data + b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::sub(F32x4 a, F32x4 b) noexcept {
+    return {a.data - b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::mul(F32x4 a, F32x4 b) noexcept {
+    return {a.data * b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::div(F32x4 a, F32x4 b) noexcept {
+    return {a.data / b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::min(F32x4 a, F32x4 b) noexcept {
+    return {__builtin_elementwise_min(a.data, b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::max(F32x4 a, F32x4 b) noexcept {
+    return {__builtin_elementwise_max(a.data, b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::floor(F32x4 a) noexcept {
+    return {__builtin_elementwise_floor(a.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::ceil(F32x4 a) noexcept {
+    return {__builtin_elementwise_ceil(a.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::abs(F32x4 a) noexcept {
+    return {__builtin_elementwise_abs(a.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x4::dp(F32x4 a, F32x4 b) noexcept {
+    F32x4 m = mul(a, b);
+    // No built-in to reduce float vectors
+    f32 ret = 0.f;
+    for(i32 i = 0; i < 4; i++) {
+        ret += m.data[i];
+    }
+    return ret;
+}
+
+[[nodiscard]] RPP_SIMD_API bool F32x4::cmpeq_all(F32x4 a, F32x4 b) noexcept {
+    // Element-wise comparison produces -1 (all 1's) when equal, 0 otherwise
+    // Reducing via & to get equality of all members
+    return __builtin_reduce_and(a.data == b.data) == -1;
+}
+
+// Boolean vectors are bit-packed, so converting a comparison to one yields a movemask.
+using b16 = bool __attribute__((ext_vector_type(16)));
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::load(const u8* src) noexcept {
+    U8x16 ret;
+    __builtin_memcpy(&ret.data, src, sizeof(ret.data));
+    return ret;
+}
+
+[[nodiscard]] RPP_SIMD_API u32 U8x16::cmpeq_mask(U8x16 a, u8 v) noexcept {
+    return __builtin_bit_cast(u16, __builtin_convertvector(a.data == v, b16));
+}
+
+[[nodiscard]] RPP_SIMD_API u32 U8x16::high_mask(U8x16 a) noexcept {
+    return __builtin_bit_cast(u16, __builtin_convertvector(a.data >= u8{0x80}, b16));
+}
+
+using b4 = bool __attribute__((ext_vector_type(4)));
+using b8 = bool __attribute__((ext_vector_type(8)));
+using u32x4 = u32 __attribute__((ext_vector_type(4)));
+using u32x8 = u32 __attribute__((ext_vector_type(8)));
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::load(const f32* src) noexcept {
+    F32x4 ret;
+    __builtin_memcpy(&ret.data, src, sizeof(ret.data));
+    return ret;
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::load(Slice<f32> src, u64 offset) noexcept {
+    assert(offset + 4 <= src.length());
+    return load(src.data() + offset);
+}
+
+RPP_SIMD_API void F32x4::store(F32x4 a, f32* dst) noexcept {
+    __builtin_memcpy(dst, &a.data, sizeof(a.data));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::gather(const f32* base, I32x4 idx) noexcept {
+    return {f32x4{base[idx.data[0]], base[idx.data[1]], base[idx.data[2]], base[idx.data[3]]}};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::fma(F32x4 a, F32x4 b, F32x4 c) noexcept {
+#if __has_builtin(__builtin_elementwise_fma)
+    return {__builtin_elementwise_fma(a.data, b.data, c.data)};
+#else
+    return {a.data * b.data + c.data};
+#endif
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::sqrt(F32x4 a) noexcept {
+#if __has_builtin(__builtin_elementwise_sqrt)
+    return {__builtin_elementwise_sqrt(a.data)};
+#else
+    return set(__builtin_sqrtf(a.data[0]), __builtin_sqrtf(a.data[1]), __builtin_sqrtf(a.data[2]),
+               __builtin_sqrtf(a.data[3]));
+#endif
+}
+
+// Reductions pair lanes in the same order as the SSE versions, so results match across targets.
+[[nodiscard]] RPP_SIMD_API f32 F32x4::hsum(F32x4 a) noexcept {
+    return (a.data[0] + a.data[1]) + (a.data[2] + a.data[3]);
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x4::hmin(F32x4 a) noexcept {
+    F32x4 v = min(a, shuffle<2, 3, 0, 1>(a));
+    return min(v, shuffle<1, 0, 3, 2>(v)).data[0];
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x4::hmax(F32x4 a) noexcept {
+    F32x4 v = max(a, shuffle<2, 3, 0, 1>(a));
+    return max(v, shuffle<1, 0, 3, 2>(v)).data[0];
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 F32x4::cmpeq(F32x4 a, F32x4 b) noexcept {
+    return {a.data == b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 F32x4::cmplt(F32x4 a, F32x4 b) noexcept {
+    return {a.data < b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 F32x4::cmple(F32x4 a, F32x4 b) noexcept {
+    return {a.data <= b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::select(I32x4 mask, F32x4 a, F32x4 b) noexcept {
+    I32x4 bits = I32x4::select(mask, {__builtin_bit_cast(I32x4::i32x4, a.data)},
+                               {__builtin_bit_cast(I32x4::i32x4, b.data)});
+    return {__builtin_bit_cast(f32x4, bits.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 F32x4::to_i32(F32x4 a) noexcept {
+    return {__builtin_convertvector(a.data, I32x4::i32x4)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::from_i32(I32x4 a) noexcept {
+    return {__builtin_convertvector(a.data, f32x4)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 F32x4::to_bits(F32x4 a) noexcept {
+    return {__builtin_bit_cast(I32x4::i32x4, a.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::from_bits(I32x4 a) noexcept {
+    return {__builtin_bit_cast(f32x4, a.data)};
+}
+
+// The SSE estimate is good to 12 bits and NEON's to 8; each Newton step roughly doubles that.
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::rsqrt(F32x4 a) noexcept {
+#if defined __SSE2__
+    __m128 x = __builtin_bit_cast(__m128, a.data);
+    __m128 e = _mm_rsqrt_ps(x);
+    __m128 h = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), e);
+    __m128 r = _mm_mul_ps(e, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(h, e)));
+    return {__builtin_bit_cast(f32x4, r)};
+#elif defined __ARM_NEON
+    float32x4_t x = __builtin_bit_cast(float32x4_t, a.data);
+    float32x4_t e = vrsqrteq_f32(x);
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(x, e), e));
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(x, e), e));
+    return {__builtin_bit_cast(f32x4, e)};
+#else
+    return div(one(), sqrt(a));
+#endif
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::set1(f32 v) noexcept {
+    return {f32x8{v, v, v, v, v, v, v, v}};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::zero() noexcept {
+    return set1(0.0f);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::load(const f32* src) noexcept {
+    F32x8 ret;
+    __builtin_memcpy(&ret.data, src, sizeof(ret.data));
+    return ret;
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::load(Slice<f32> src, u64 offset) noexcept {
+    assert(offset + 8 <= src.length());
+    return load(src.data() + offset);
+}
+
+RPP_SIMD_API void F32x8::store(F32x8 a, f32* dst) noexcept {
+    __builtin_memcpy(dst, &a.data, sizeof(a.data));
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::gather(const f32* base, I32x8 idx) noexcept {
+    return {f32x8{base[idx.data[0]], base[idx.data[1]], base[idx.data[2]], base[idx.data[3]],
+                  base[idx.data[4]], base[idx.data[5]], base[idx.data[6]], base[idx.data[7]]}};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::combine(F32x4 low, F32x4 high) noexcept {
+    return {__builtin_shufflevector(low.data, high.data, 0, 1, 2, 3, 4, 5, 6, 7)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x8::low(F32x8 a) noexcept {
+    return {__builtin_shufflevector(a.data, a.data, 0, 1, 2, 3)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x8::high(F32x8 a) noexcept {
+    return {__builtin_shufflevector(a.data, a.data, 4, 5, 6, 7)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::add(F32x8 a, F32x8 b) noexcept {
+    return {a.data + b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::sub(F32x8 a, F32x8 b) noexcept {
+    return {a.data - b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::mul(F32x8 a, F32x8 b) noexcept {
+    return {a.data * b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::div(F32x8 a, F32x8 b) noexcept {
+    return {a.data / b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::fma(F32x8 a, F32x8 b, F32x8 c) noexcept {
+#if __has_builtin(__builtin_elementwise_fma)
+    return {__builtin_elementwise_fma(a.data, b.data, c.data)};
+#else
+    return {a.data * b.data + c.data};
+#endif
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::min(F32x8 a, F32x8 b) noexcept {
+    return {__builtin_elementwise_min(a.data, b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::max(F32x8 a, F32x8 b) noexcept {
+    return {__builtin_elementwise_max(a.data, b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::abs(F32x8 a) noexcept {
+    return {__builtin_elementwise_abs(a.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::sqrt(F32x8 a) noexcept {
+    return combine(F32x4::sqrt(low(a)), F32x4::sqrt(high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x8::hsum(F32x8 a) noexcept {
+    return F32x4::hsum(F32x4::add(low(a), high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x8::hmin(F32x8 a) noexcept {
+    return F32x4::hmin(F32x4::min(low(a), high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API f32 F32x8::hmax(F32x8 a) noexcept {
+    return F32x4::hmax(F32x4::max(low(a), high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::cmpeq(F32x8 a, F32x8 b) noexcept {
+    return {a.data == b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::cmplt(F32x8 a, F32x8 b) noexcept {
+    return {a.data < b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::cmple(F32x8 a, F32x8 b) noexcept {
+    return {a.data <= b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::select(I32x8 mask, F32x8 a, F32x8 b) noexcept {
+    I32x8 bits = I32x8::select(mask, {__builtin_bit_cast(I32x8::i32x8, a.data)},
+                               {__builtin_bit_cast(I32x8::i32x8, b.data)});
+    return {__builtin_bit_cast(f32x8, bits.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::floor(F32x8 a) noexcept {
+    return {__builtin_elementwise_floor(a.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::to_i32(F32x8 a) noexcept {
+    return {__builtin_convertvector(a.data, I32x8::i32x8)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::from_i32(I32x8 a) noexcept {
+    return {__builtin_convertvector(a.data, f32x8)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 F32x8::to_bits(F32x8 a) noexcept {
+    return {__builtin_bit_cast(I32x8::i32x8, a.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::from_bits(I32x8 a) noexcept {
+    return {__builtin_bit_cast(f32x8, a.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::rsqrt(F32x8 a) noexcept {
+    return combine(F32x4::rsqrt(low(a)), F32x4::rsqrt(high(a)));
+}
+
+// Integer arithmetic goes through unsigned lanes, so overflow wraps as it does in registers.
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::set1(i32 v) noexcept {
+    return {i32x4{v, v, v, v}};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::set(i32 x, i32 y, i32 z, i32 w) noexcept {
+    return {i32x4{x, y, z, w}};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::zero() noexcept {
+    return set1(0);
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::load(const i32* src) noexcept {
+    I32x4 ret;
+    __builtin_memcpy(&ret.data, src, sizeof(ret.data));
+    return ret;
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::load(Slice<i32> src, u64 offset) noexcept {
+    assert(offset + 4 <= src.length());
+    return load(src.data() + offset);
+}
+
+RPP_SIMD_API void I32x4::store(I32x4 a, i32* dst) noexcept {
+    __builtin_memcpy(dst, &a.data, sizeof(a.data));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::gather(const i32* base, I32x4 idx) noexcept {
+    return {i32x4{base[idx.data[0]], base[idx.data[1]], base[idx.data[2]], base[idx.data[3]]}};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::add(I32x4 a, I32x4 b) noexcept {
+    u32x4 r = __builtin_bit_cast(u32x4, a.data) + __builtin_bit_cast(u32x4, b.data);
+    return {__builtin_bit_cast(i32x4, r)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::sub(I32x4 a, I32x4 b) noexcept {
+    u32x4 r = __builtin_bit_cast(u32x4, a.data) - __builtin_bit_cast(u32x4, b.data);
+    return {__builtin_bit_cast(i32x4, r)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::mul(I32x4 a, I32x4 b) noexcept {
+    u32x4 r = __builtin_bit_cast(u32x4, a.data) * __builtin_bit_cast(u32x4, b.data);
+    return {__builtin_bit_cast(i32x4, r)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::min(I32x4 a, I32x4 b) noexcept {
+    return {__builtin_elementwise_min(a.data, b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::max(I32x4 a, I32x4 b) noexcept {
+    return {__builtin_elementwise_max(a.data, b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::bit_and(I32x4 a, I32x4 b) noexcept {
+    return {a.data & b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::bit_or(I32x4 a, I32x4 b) noexcept {
+    return {a.data | b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::bit_xor(I32x4 a, I32x4 b) noexcept {
+    return {a.data ^ b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::shl(I32x4 a, u32 bits) noexcept {
+    if(bits >= 32) return zero();
+    return {__builtin_bit_cast(i32x4, __builtin_bit_cast(u32x4, a.data) << bits)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::shr(I32x4 a, u32 bits) noexcept {
+    if(bits >= 32) return zero();
+    return {__builtin_bit_cast(i32x4, __builtin_bit_cast(u32x4, a.data) >> bits)};
+}
+
+[[nodiscard]] RPP_SIMD_API i32 I32x4::hsum(I32x4 a) noexcept {
+    u32x4 v = __builtin_bit_cast(u32x4, a.data);
+    return static_cast<i32>((v[0] + v[1]) + (v[2] + v[3]));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::cmpeq(I32x4 a, I32x4 b) noexcept {
+    return {a.data == b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::cmpgt(I32x4 a, I32x4 b) noexcept {
+    return {a.data > b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x4::select(I32x4 mask, I32x4 a, I32x4 b) noexcept {
+    return {(mask.data & a.data) | (~mask.data & b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API u32 I32x4::movemask(I32x4 a) noexcept {
+    return __builtin_bit_cast(u8, __builtin_convertvector(a.data < 0, b4)) & 0xf;
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::set1(i32 v) noexcept {
+    return {i32x8{v, v, v, v, v, v, v, v}};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::zero() noexcept {
+    return set1(0);
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::load(const i32* src) noexcept {
+    I32x8 ret;
+    __builtin_memcpy(&ret.data, src, sizeof(ret.data));
+    return ret;
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::load(Slice<i32> src, u64 offset) noexcept {
+    assert(offset + 8 <= src.length());
+    return load(src.data() + offset);
+}
+
+RPP_SIMD_API void I32x8::store(I32x8 a, i32* dst) noexcept {
+    __builtin_memcpy(dst, &a.data, sizeof(a.data));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::gather(const i32* base, I32x8 idx) noexcept {
+    return {i32x8{base[idx.data[0]], base[idx.data[1]], base[idx.data[2]], base[idx.data[3]],
+                  base[idx.data[4]], base[idx.data[5]], base[idx.data[6]], base[idx.data[7]]}};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::combine(I32x4 low, I32x4 high) noexcept {
+    return {__builtin_shufflevector(low.data, high.data, 0, 1, 2, 3, 4, 5, 6, 7)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x8::low(I32x8 a) noexcept {
+    return {__builtin_shufflevector(a.data, a.data, 0, 1, 2, 3)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x4 I32x8::high(I32x8 a) noexcept {
+    return {__builtin_shufflevector(a.data, a.data, 4, 5, 6, 7)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::add(I32x8 a, I32x8 b) noexcept {
+    u32x8 r = __builtin_bit_cast(u32x8, a.data) + __builtin_bit_cast(u32x8, b.data);
+    return {__builtin_bit_cast(i32x8, r)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::sub(I32x8 a, I32x8 b) noexcept {
+    u32x8 r = __builtin_bit_cast(u32x8, a.data) - __builtin_bit_cast(u32x8, b.data);
+    return {__builtin_bit_cast(i32x8, r)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::mul(I32x8 a, I32x8 b) noexcept {
+    u32x8 r = __builtin_bit_cast(u32x8, a.data) * __builtin_bit_cast(u32x8, b.data);
+    return {__builtin_bit_cast(i32x8, r)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::min(I32x8 a, I32x8 b) noexcept {
+    return {__builtin_elementwise_min(a.data, b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::max(I32x8 a, I32x8 b) noexcept {
+    return {__builtin_elementwise_max(a.data, b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::bit_and(I32x8 a, I32x8 b) noexcept {
+    return {a.data & b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::bit_or(I32x8 a, I32x8 b) noexcept {
+    return {a.data | b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::bit_xor(I32x8 a, I32x8 b) noexcept {
+    return {a.data ^ b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::shl(I32x8 a, u32 bits) noexcept {
+    if(bits >= 32) return zero();
+    return {__builtin_bit_cast(i32x8, __builtin_bit_cast(u32x8, a.data) << bits)};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::shr(I32x8 a, u32 bits) noexcept {
+    if(bits >= 32) return zero();
+    return {__builtin_bit_cast(i32x8, __builtin_bit_cast(u32x8, a.data) >> bits)};
+}
+
+[[nodiscard]] RPP_SIMD_API i32 I32x8::hsum(I32x8 a) noexcept {
+    return I32x4::hsum(I32x4::add(low(a), high(a)));
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::cmpeq(I32x8 a, I32x8 b) noexcept {
+    return {a.data == b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::cmpgt(I32x8 a, I32x8 b) noexcept {
+    return {a.data > b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API I32x8 I32x8::select(I32x8 mask, I32x8 a, I32x8 b) noexcept {
+    return {(mask.data & a.data) | (~mask.data & b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API u32 I32x8::movemask(I32x8 a) noexcept {
+    return __builtin_bit_cast(u8, __builtin_convertvector(a.data < 0, b8));
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::set1(u8 v) noexcept {
+    return {u8x16{v, v, v, v, v, v, v, v, v, v, v, v, v, v, v, v}};
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::load(Slice<u8> src, u64 offset) noexcept {
+    assert(offset + 16 <= src.length());
+    return load(src.data() + offset);
+}
+
+RPP_SIMD_API void U8x16::store(U8x16 a, u8* dst) noexcept {
+    __builtin_memcpy(dst, &a.data, sizeof(a.data));
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::bit_and(U8x16 a, U8x16 b) noexcept {
+    return {a.data & b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::bit_or(U8x16 a, U8x16 b) noexcept {
+    return {a.data | b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::bit_andnot(U8x16 a, U8x16 b) noexcept {
+    return {a.data & ~b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::sub(U8x16 a, U8x16 b) noexcept {
+    return {a.data - b.data};
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::min(U8x16 a, U8x16 b) noexcept {
+    return {__builtin_elementwise_min(a.data, b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::cmpeq(U8x16 a, U8x16 b) noexcept {
+    return {__builtin_bit_cast(u8x16, a.data == b.data)};
+}
+
+[[nodiscard]] RPP_SIMD_API U8x16 U8x16::shuffle(U8x16 a, U8x16 idx) noexcept {
+#if defined __SSSE3__
+    // pshufb only zeroes lanes whose index has its high bit set.
+    __m128i saturated = _mm_adds_epu8(__builtin_bit_cast(__m128i, idx.data), _mm_set1_epi8(0x70));
+    __m128i ret = _mm_shuffle_epi8(__builtin_bit_cast(__m128i, a.data), saturated);
+    return {__builtin_bit_cast(u8x16, ret)};
+#elif defined __ARM_NEON
+    uint8x16_t ret = vqtbl1q_u8(__builtin_bit_cast(uint8x16_t, a.data),
+                                __builtin_bit_cast(uint8x16_t, idx.data));
+    return {__builtin_bit_cast(u8x16, ret)};
+#else
+    U8x16 ret;
+    for(u64 i = 0; i < 16; i++) ret.data[i] = idx.data[i] < 16 ? a.data[idx.data[i]] : 0;
+    return ret;
+#endif
+}
+
+#endif // RPP_COMPILER_MSVC
+
+// The approximations are written once over the 4- and 8-wide types. Polynomials and reduction
+// constants are from Cephes; the error bounds in simd.h were measured both with and without FMA.
+namespace detail {
+
+template<typename F, typename I>
+[[nodiscard]] RPP_SIMD_API F sign_bit() noexcept {
+    return F::from_bits(I::set1(Limits<i32>::min()));
+}
+
+// Reduces by the nearest multiple q of pi/2, split in three parts so the remainder stays exact,
+// then evaluates sine or cosine on [-pi/4, pi/4] depending on the quadrant. Cosine shifts the
+// quadrant by one.
+template<typename F, typename I>
+[[nodiscard]] RPP_SIMD_API F sin_cos(F a, i32 shift) noexcept {
+    F q = F::floor(F::fma(a, F::set1(0.636619772367581343f), F::set1(0.5f)));
+    I n = I::add(F::to_i32(q), I::set1(shift));
+    F r = F::fma(q, F::set1(-1.5703125f), a);
+    r = F::fma(q, F::set1(-4.837512969970703125e-4f), r);
+    r = F::fma(q, F::set1(-7.54978995489188216e-8f), r);
+
+    F z = F::mul(r, r);
+    F s = F::fma(F::set1(-1.9515295891e-4f), z, F::set1(8.3321608736e-3f));
+    s = F::fma(s, z, F::set1(-1.6666654611e-1f));
+    s = F::fma(s, F::mul(z, r), r);
+    F c = F::fma(F::set1(2.443315711809948e-5f), z, F::set1(-1.388731625493765e-3f));
+    c = F::fma(c, z, F::set1(4.166664568298827e-2f));
+    c = F::fma(c, z, F::set1(-0.5f));
+    c = F::fma(c, z, F::set1(1.0f));
+
+    I odd = I::cmpeq(I::bit_and(n, I::set1(1)), I::set1(1));
+    I negate = I::shl(I::bit_and(n, I::set1(2)), 30);
+    return F::from_bits(I::bit_xor(F::to_bits(F::select(odd, c, s)), negate));
+}
+
+// Splits a into k ln 2 + r, evaluates e^r, and scales by 2^k through the exponent bits. At the
+// top of the range k is 128, so positive k scale by 2^(k - 1) and then double.
+template<typename F, typename I>
+[[nodiscard]] RPP_SIMD_API F exp(F a) noexcept {
+    F lowest = F::set1(-87.3365447505531f);
+    F highest = F::set1(88.7228390520683f);
+    F x = F::min(F::max(a, lowest), highest);
+    F k = F::floor(F::fma(x, F::set1(1.44269504088896341f), F::set1(0.5f)));
+    F r = F::fma(k, F::set1(-0.693359375f), x);
+    r = F::fma(k, F::set1(2.12194440e-4f), r);
+
+    F p = F::fma(F::set1(1.9875691500e-4f), r, F::set1(1.3981999507e-3f));
+    p = F::fma(p, r, F::set1(8.3334519073e-3f));
+    p = F::fma(p, r, F::set1(4.1665795894e-2f));
+    p = F::fma(p, r, F::set1(1.6666665459e-1f));
+    p = F::fma(p, r, F::set1(5.0000001201e-1f));
+    F y = F::add(F::fma(p, F::mul(r, r), r), F::set1(1.0f));
+
+    I n = F::to_i32(k);
+    I positive = I::cmpgt(n, I::zero());
+    y = F::mul(y, F::from_bits(I::shl(I::add(I::add(n, positive), I::set1(127)), 23)));
+    y = F::select(positive, F::add(y, y), y);
+
+    y = F::select(F::cmplt(highest, a), F::from_bits(I::set1(0x7f800000)), y);
+    y = F::select(F::cmplt(a, lowest), F::zero(), y);
+    return F::select(F::cmpeq(a, a), y, a);
+}
+
+// Splits a into 2^e m with m in [sqrt(1/2), sqrt(2)) and evaluates log(m) around one.
+template<typename F, typename I>
+[[nodiscard]] RPP_SIMD_API F log(F a) noexcept {
+    I subnormal = F::cmplt(a, F::set1(Limits<f32>::smallest_norm()));
+    F x = F::select(subnormal, F::mul(a, F::set1(8388608.0f)), a);
+    I bits = F::to_bits(x);
+    F e = F::from_i32(I::sub(I::shr(bits, 23), I::set1(126)));
+    e = F::select(subnormal, F::sub(e, F::set1(23.0f)), e);
+    F m = F::from_bits(I::bit_or(I::bit_and(bits, I::set1(0x007fffff)), I::set1(0x3f000000)));
+    I small = F::cmplt(m, F::set1(0.707106781186547524f));
+    e = F::select(small, F::sub(e, F::set1(1.0f)), e);
+    m = F::sub(F::select(small, F::add(m, m), m), F::set1(1.0f));
+
+    F p = F::fma(F::set1(7.0376836292e-2f), m, F::set1(-1.1514610310e-1f));
+    p = F::fma(p, m, F::set1(1.1676998740e-1f));
+    p = F::fma(p, m, F::set1(-1.2420140846e-1f));
+    p = F::fma(p, m, F::set1(1.4249322787e-1f));
+    p = F::fma(p, m, F::set1(-1.6668057665e-1f));
+    p = F::fma(p, m, F::set1(2.0000714765e-1f));
+    p = F::fma(p, m, F::set1(-2.4999993993e-1f));
+    p = F::fma(p, m, F::set1(3.3333331174e-1f));
+    F z = F::mul(m, m);
+    F y = F::mul(F::mul(p, m), z);
+    y = F::fma(e, F::set1(-2.12194440e-4f), y);
+    y = F::fma(z, F::set1(-0.5f), y);
+    F r = F::fma(e, F::set1(0.693359375f), F::add(m, y));
+
+    F inf = F::from_bits(I::set1(0x7f800000));
+    r = F::select(F::cmpeq(a, inf), inf, r);
+    r = F::select(F::cmpeq(a, F::zero()), F::sub(F::zero(), inf), r);
+    return F::select(F::cmple(F::zero(), a), r, F::from_bits(I::set1(0x7fc00000)));
+}
+
+// Evaluates atan on the ratio of the smaller to the larger magnitude, reduced to |t| <= tan(pi/8),
+// then unfolds the octant from the magnitudes and signs.
+template<typename F, typename I>
+[[nodiscard]] RPP_SIMD_API F atan2(F y, F x) noexcept {
+    F ax = F::abs(x);
+    F ay = F::abs(y);
+    F big = F::max(ax, ay);
+    F a = F::select(F::cmpeq(big, F::zero()), F::zero(), F::div(F::min(ax, ay), big));
+
+    I reduce = F::cmplt(F::set1(0.4142135623730950f), a);
+    F one = F::set1(1.0f);
+    F t = F::select(reduce, F::div(F::sub(a, one), F::add(a, one)), a);
+    F z = F::mul(t, t);
+    F p = F::fma(F::set1(8.05374449538e-2f), z, F::set1(-1.38776856032e-1f));
+    p = F::fma(p, z, F::set1(1.99777106478e-1f));
+    p = F::fma(p, z, F::set1(-3.33329491539e-1f));
+    F r = F::fma(F::mul(p, z), t, t);
+    r = F::add(r, F::select(reduce, F::set1(0.785398163397448309616f), F::zero()));
+
+    r = F::select(F::cmplt(ax, ay), F::sub(F::set1(1.57079632679489661923f), r), r);
+    I negative_x = I::cmpgt(I::zero(), F::to_bits(x));
+    r = F::select(negative_x, F::sub(F::set1(3.14159265358979323846f), r), r);
+    I sign = I::bit_and(F::to_bits(y), F::to_bits(sign_bit<F, I>()));
+    return F::from_bits(I::bit_or(F::to_bits(r), sign));
+}
+
+template<typename F, typename I>
+[[nodiscard]] RPP_SIMD_API F pow(F a, F b) noexcept {
+    F r = exp<F, I>(F::mul(b, log<F, I>(a)));
+    return F::select(F::cmpeq(b, F::zero()), F::set1(1.0f), r);
+}
+
+} // namespace detail
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::sin(F32x4 a) noexcept {
+    return detail::sin_cos<F32x4, I32x4>(a, 0);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::cos(F32x4 a) noexcept {
+    return detail::sin_cos<F32x4, I32x4>(a, 1);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::exp(F32x4 a) noexcept {
+    return detail::exp<F32x4, I32x4>(a);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::log(F32x4 a) noexcept {
+    return detail::log<F32x4, I32x4>(a);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::atan2(F32x4 y, F32x4 x) noexcept {
+    return detail::atan2<F32x4, I32x4>(y, x);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x4 F32x4::pow(F32x4 a, F32x4 b) noexcept {
+    return detail::pow<F32x4, I32x4>(a, b);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::sin(F32x8 a) noexcept {
+    return detail::sin_cos<F32x8, I32x8>(a, 0);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::cos(F32x8 a) noexcept {
+    return detail::sin_cos<F32x8, I32x8>(a, 1);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::exp(F32x8 a) noexcept {
+    return detail::exp<F32x8, I32x8>(a);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::log(F32x8 a) noexcept {
+    return detail::log<F32x8, I32x8>(a);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::atan2(F32x8 y, F32x8 x) noexcept {
+    return detail::atan2<F32x8, I32x8>(y, x);
+}
+
+[[nodiscard]] RPP_SIMD_API F32x8 F32x8::pow(F32x8 a, F32x8 b) noexcept {
+    return detail::pow<F32x8, I32x8>(a, b);
+}
+
+} // namespace rpp::SIMD
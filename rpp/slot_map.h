@@ -0,0 +1,216 @@
+
+#pragma once
+
+#include "base.h"
+
+namespace rpp {
+
+// Names one element of a Slot_Map. The generation changes whenever the slot is erased, so a
+// stale handle never refers to a later element that reused the slot.
+struct Slot_Handle {
+    [[nodiscard]] bool operator==(const Slot_Handle& other) const noexcept = default;
+
+    [[nodiscard]] u64 raw() const noexcept {
+        return static_cast<u64>(generation) << 32 | index;
+    }
+    [[nodiscard]] static Slot_Handle from_raw(u64 raw) noexcept {
+        return Slot_Handle{static_cast<u32>(raw), static_cast<u32>(raw >> 32)};
+    }
+
+    u32 index = 0;
+    u32 generation = 0;
+};
+
+namespace detail {
+
+struct Slot_Map_Slot {
+    // Position in the dense arrays while live; the next free slot while free.
+    u32 dense = 0;
+    // Odd while live.
+    u32 generation = 0;
+};
+
+} // namespace detail
+
+// Stores values densely, in no particular order, and hands out generational handles that stay
+// valid until their element is erased. Erasing swaps the last element into the hole, so
+// iterating values() or each() always walks contiguous memory.
+template<Movable T, Allocator A = Mdefault>
+struct Slot_Map {
+
+    Slot_Map() noexcept = default;
+
+    explicit Slot_Map(u64 capacity) noexcept {
+        reserve(capacity);
+    }
+
+    ~Slot_Map() noexcept = default;
+
+    Slot_Map(const Slot_Map& src) noexcept = delete;
+    Slot_Map& operator=(const Slot_Map& src) noexcept = delete;
+
+    Slot_Map(Slot_Map&& src) noexcept = default;
+    Slot_Map& operator=(Slot_Map&& src) noexcept = default;
+
+    void reserve(u64 capacity) noexcept {
+        values_.reserve(capacity);
+        owners_.reserve(capacity);
+        slots_.reserve(capacity);
+    }
+
+    // Erases every element; all outstanding handles become stale.
+    void clear() noexcept {
+        for(u32 slot : owners_) release(slot);
+        values_.clear();
+        owners_.clear();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return values_.empty();
+    }
+    [[nodiscard]] u64 length() const noexcept {
+        return values_.length();
+    }
+
+    [[nodiscard]] Slice<T> values() const noexcept {
+        return values_.slice();
+    }
+    [[nodiscard]] T& value(u64 idx) noexcept {
+        return values_[idx];
+    }
+    [[nodiscard]] const T& value(u64 idx) const noexcept {
+        return values_[idx];
+    }
+    // Handle of the element at position idx of values().
+    [[nodiscard]] Slot_Handle handle(u64 idx) const noexcept {
+        u32 slot = owners_[idx];
+        return Slot_Handle{slot, slots_[slot].generation};
+    }
+
+    [[nodiscard]] T* begin() noexcept {
+        return values_.begin();
+    }
+    [[nodiscard]] T* end() noexcept {
+        return values_.end();
+    }
+    [[nodiscard]] const T* begin() const noexcept {
+        return values_.begin();
+    }
+    [[nodiscard]] const T* end() const noexcept {
+        return values_.end();
+    }
+
+    Slot_Handle insert(T&& value) noexcept {
+        values_.push(rpp::move(value));
+        return acquire();
+    }
+    Slot_Handle insert(const T& value) noexcept
+        requires Copy_Constructable<T>
+    {
+        values_.push(value);
+        return acquire();
+    }
+    template<typename... Args>
+        requires Constructable<T, Args...>
+    Slot_Handle emplace(Args&&... args) noexcept {
+        values_.emplace(rpp::forward<Args>(args)...);
+        return acquire();
+    }
+
+    [[nodiscard]] bool contains(Slot_Handle handle) const noexcept {
+        return handle.index < slots_.length() &&
+               slots_[handle.index].generation == handle.generation && (handle.generation & 1);
+    }
+
+    [[nodiscard]] Opt<Ref<T>> try_get(Slot_Handle handle) noexcept {
+        if(!contains(handle)) return {};
+        return Opt{Ref{values_[slots_[handle.index].dense]}};
+    }
+    [[nodiscard]] Opt<Ref<const T>> try_get(Slot_Handle handle) const noexcept {
+        if(!contains(handle)) return {};
+        return Opt{Ref<const T>{values_[slots_[handle.index].dense]}};
+    }
+
+    [[nodiscard]] T& get(Slot_Handle handle) noexcept {
+        if(!contains(handle)) die("Stale slot handle %!", handle);
+        return values_[slots_[handle.index].dense];
+    }
+    [[nodiscard]] const T& get(Slot_Handle handle) const noexcept {
+        if(!contains(handle)) die("Stale slot handle %!", handle);
+        return values_[slots_[handle.index].dense];
+    }
+
+    [[nodiscard]] bool try_erase(Slot_Handle handle) noexcept {
+        if(!contains(handle)) return false;
+        u32 dense = slots_[handle.index].dense;
+        u32 last = static_cast<u32>(values_.length() - 1);
+        if(dense != last) {
+            rpp::swap(values_[dense], values_[last]);
+            owners_[dense] = owners_[last];
+            slots_[owners_[dense]].dense = dense;
+        }
+        values_.pop();
+        owners_.pop();
+        release(handle.index);
+        return true;
+    }
+    void erase(Slot_Handle handle) noexcept {
+        if(!try_erase(handle)) die("Stale slot handle %!", handle);
+    }
+
+    // Calls f(handle, value) for every element in dense order.
+    template<typename F>
+        requires Invocable<F, Slot_Handle, T&>
+    void each(F&& f) noexcept {
+        for(u64 i = 0; i < values_.length(); i++) f(handle(i), values_[i]);
+    }
+    template<typename F>
+        requires Invocable<F, Slot_Handle, const T&>
+    void each(F&& f) const noexcept {
+        for(u64 i = 0; i < values_.length(); i++) f(handle(i), values_[i]);
+    }
+
+private:
+    constexpr static u32 NONE = Limits<u32>::max();
+
+    // Binds a slot to the value just pushed onto values_.
+    [[nodiscard]] Slot_Handle acquire() noexcept {
+        u32 dense = static_cast<u32>(values_.length() - 1);
+        u32 slot = free_;
+        if(slot == NONE) {
+            assert(slots_.length() < NONE);
+            slot = static_cast<u32>(slots_.length());
+            slots_.push(detail::Slot_Map_Slot{});
+        } else {
+            free_ = slots_[slot].dense;
+        }
+        slots_[slot].dense = dense;
+        slots_[slot].generation++;
+        owners_.push(slot);
+        return Slot_Handle{slot, slots_[slot].generation};
+    }
+
+    void release(u32 slot) noexcept {
+        slots_[slot].generation++;
+        slots_[slot].dense = free_;
+        free_ = slot;
+    }
+
+    Vec<T, A> values_;
+    Vec<u32, A> owners_;
+    Vec<detail::Slot_Map_Slot, A> slots_;
+    u32 free_ = NONE;
+
+    friend struct Reflect::Refl<Slot_Map>;
+};
+
+RPP_RECORD(Slot_Handle, RPP_FIELD(index), RPP_FIELD(generation));
+
+RPP_NAMED_RECORD(::rpp::detail::Slot_Map_Slot, "Slot_Map_Slot", RPP_FIELD(dense),
+                 RPP_FIELD(generation));
+
+template<Movable T, Allocator A>
+RPP_TEMPLATE_RECORD(Slot_Map, RPP_PACK(T, A), RPP_FIELD(values_), RPP_FIELD(owners_),
+                    RPP_FIELD(slots_), RPP_FIELD(free_));
+
+} // namespace rpp
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "base.h"
+
+namespace rpp {
+
+// Stores each field of a reflected record in its own contiguous array, all in one allocation
+// with every column aligned to a cache line. Loops that touch a few fields only stream those
+// columns, and each column is a ready-made SIMD input. Records are gathered and scattered field by
+// field, so they must be trivially copyable.
+template<Reflect::Record T, Allocator A = Mdefault>
+    requires Trivially_Copyable<T> && Default_Constructable<T>
+struct Soa_Vec {
+    using Members = typename Reflect::Refl<T>::members;
+
+    constexpr static u64 fields = Reflect::List_Length<Members>;
+    constexpr static u64 column_align = 64;
+
+    template<u64 I>
+    using Field = Reflect::Nth<Members, I>;
+    template<u64 I>
+    using Field_Type = typename Field<I>::type;
+
+    template<Literal N>
+    constexpr static u64 index_of = Reflect::Index_Of<Members, N>;
+
+    // A reference to one row, reading and writing through to the columns.
+    template<bool is_const>
+    struct Row {
+        using Owner = If<is_const, const Soa_Vec, Soa_Vec>;
+
+        template<Literal N>
+            requires(index_of<N> < fields)
+        [[nodiscard]] auto& get() const noexcept {
+            return vec.template column<index_of<N>>()[idx];
+        }
+        template<u64 I>
+        [[nodiscard]] auto& get() const noexcept {
+            return vec.template column<I>()[idx];
+        }
+
+        [[nodiscard]] operator T() const noexcept {
+            return vec.get(idx);
+        }
+        void operator=(const T& value) const noexcept
+            requires(!is_const)
+        {
+            vec.set(idx, value);
+        }
+
+        Owner& vec;
+        u64 idx;
+    };
+
+    Soa_Vec() noexcept = default;
+    explicit Soa_Vec(u64 capacity) noexcept {
+        reserve(capacity);
+    }
+    ~Soa_Vec() noexcept {
+        A::free(data_);
+        data_ = null;
+        length_ = 0;
+        capacity_ = 0;
+    }
+
+    Soa_Vec(const Soa_Vec&) noexcept = delete;
+    Soa_Vec& operator=(const Soa_Vec&) noexcept = delete;
+
+    Soa_Vec(Soa_Vec&& src) noexcept {
+        take(src);
+    }
+    Soa_Vec& operator=(Soa_Vec&& src) noexcept {
+        this->~Soa_Vec();
+        take(src);
+        return *this;
+    }
+
+    [[nodiscard]] u64 length() const noexcept {
+        return length_;
+    }
+    [[nodiscard]] u64 capacity() const noexcept {
+        return capacity_;
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return length_ == 0;
+    }
+
+    void clear() noexcept {
+        length_ = 0;
+    }
+
+    void reserve(u64 new_capacity) noexcept {
+        if(new_capacity <= capacity_) return;
+
+        u64 bytes = 0;
+        u64 offsets[fields] = {};
+        for_each_field([&]<u64 I>() {
+            offsets[I] = bytes;
+            bytes += Math::align_pow2(new_capacity * sizeof(Field_Type<I>), column_align);
+        });
+
+        u8* new_data = reinterpret_cast<u8*>(alloc_aligned<A, column_align>(bytes));
+        for_each_field([&]<u64 I>() {
+            if(length_) {
+                Libc::memcpy(new_data + offsets[I], columns_[I], length_ * sizeof(Field_Type<I>));
+            }
+            columns_[I] = new_data + offsets[I];
+        });
+        A::free(data_);
+
+        data_ = new_data;
+        capacity_ = new_capacity;
+    }
+
+    void grow() noexcept {
+        reserve(capacity_ ? 2 * capacity_ : 8);
+    }
+
+    void push(const T& value) noexcept {
+        if(length_ == capacity_) grow();
+        set(length_++, value);
+    }
+
+    void pop() noexcept {
+        assert(length_ > 0);
+        length_--;
+    }
+
+    // Moves the last row into idx.
+    void swap_remove(u64 idx) noexcept {
+        assert(idx < length_);
+        length_--;
+        if(idx == length_) return;
+        for_each_field([&]<u64 I>() { column<I>()[idx] = column<I>()[length_]; });
+    }
+
+    [[nodiscard]] T get(u64 idx) const noexcept {
+        assert(idx < length_);
+        T ret{};
+        u8* out = reinterpret_cast<u8*>(&ret);
+        for_each_field([&]<u64 I>() {
+            Libc::memcpy(out + Field<I>::offset, &column<I>()[idx], sizeof(Field_Type<I>));
+        });
+        return ret;
+    }
+
+    void set(u64 idx, const T& value) noexcept {
+        assert(idx < length_);
+        const u8* in = reinterpret_cast<const u8*>(&value);
+        for_each_field([&]<u64 I>() {
+            Libc::memcpy(&column<I>()[idx], in + Field<I>::offset, sizeof(Field_Type<I>));
+        });
+    }
+
+    [[nodiscard]] Row<false> operator[](u64 idx) noexcept {
+        assert(idx < length_);
+        return Row<false>{*this, idx};
+    }
+    [[nodiscard]] Row<true> operator[](u64 idx) const noexcept {
+        assert(idx < length_);
+        return Row<true>{*this, idx};
+    }
+
+    template<u64 I>
+        requires(I < fields)
+    [[nodiscard]] Field_Type<I>* column() noexcept {
+        return reinterpret_cast<Field_Type<I>*>(columns_[I]);
+    }
+    template<u64 I>
+        requires(I < fields)
+    [[nodiscard]] const Field_Type<I>* column() const noexcept {
+        return reinterpret_cast<const Field_Type<I>*>(columns_[I]);
+    }
+
+    template<Literal N>
+        requires(index_of<N> < fields)
+    [[nodiscard]] auto* column() noexcept {
+        return column<index_of<N>>();
+    }
+    template<Literal N>
+        requires(index_of<N> < fields)
+    [[nodiscard]] const auto* column() const noexcept {
+        return column<index_of<N>>();
+    }
+
+    template<u64 I>
+        requires(I < fields)
+    [[nodiscard]] Slice<Field_Type<I>> slice() const noexcept {
+        return Slice<Field_Type<I>>{column<I>(), length_};
+    }
+    template<Literal N>
+        requires(index_of<N> < fields)
+    [[nodiscard]] auto slice() const noexcept {
+        return slice<index_of<N>>();
+    }
+
+private:
+    template<u64 I = 0, typename F>
+    static void for_each_field(F&& f) noexcept {
+        if constexpr(I < fields) {
+            f.template operator()<I>();
+            for_each_field<I + 1>(rpp::forward<F>(f));
+        }
+    }
+
+    void take(Soa_Vec& src) noexcept {
+        for(u64 i = 0; i < fields; i++) {
+            columns_[i] = src.columns_[i];
+            src.columns_[i] = null;
+        }
+        data_ = src.data_;
+        length_ = src.length_;
+        capacity_ = src.capacity_;
+        src.data_ = null;
+        src.length_ = 0;
+        src.capacity_ = 0;
+    }
+
+    u8* columns_[fields] = {};
+    u8* data_ = null;
+    u64 length_ = 0;
+    u64 capacity_ = 0;
+
+    friend struct Reflect::Refl<Soa_Vec>;
+};
+
+template<typename T, Allocator A>
+RPP_TEMPLATE_RECORD(Soa_Vec, RPP_PACK(T, A), RPP_FIELD(data_), RPP_FIELD(length_),
+                    RPP_FIELD(capacity_));
+
+} // namespace rpp
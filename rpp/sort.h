@@ -0,0 +1,139 @@
+
+#pragma once
+
+#include "base.h"
+#include "simd.h"
+
+namespace rpp::Sort {
+
+namespace detail {
+
+template<typename T>
+void insertion_sort(T* data, u64 length) noexcept {
+    for(u64 i = 1; i < length; i++) {
+        T value = rpp::move(data[i]);
+        u64 j = i;
+        for(; j > 0 && value < data[j - 1]; j--) data[j] = rpp::move(data[j - 1]);
+        data[j] = rpp::move(value);
+    }
+}
+
+template<typename T>
+void sift_down(T* data, u64 root, u64 length) noexcept {
+    for(;;) {
+        u64 child = 2 * root + 1;
+        if(child >= length) return;
+        if(child + 1 < length && data[child] < data[child + 1]) child++;
+        if(!(data[root] < data[child])) return;
+        rpp::swap(data[root], data[child]);
+        root = child;
+    }
+}
+
+template<typename T>
+void heap_sort(T* data, u64 length) noexcept {
+    for(u64 i = length / 2; i > 0; i--) sift_down(data, i - 1, length);
+    for(u64 end = length; end > 1; end--) {
+        rpp::swap(data[0], data[end - 1]);
+        sift_down(data, 0, end - 1);
+    }
+}
+
+// Hoare partition around the median of three, returning the length of the left part. Both parts
+// are non-empty. The median is moved to data[0], outside the scanned range, so the scans compare
+// against it in place instead of against a copy.
+template<typename T>
+[[nodiscard]] u64 partition(T* data, u64 length) noexcept {
+    u64 mid = length / 2;
+    if(data[mid] < data[1]) rpp::swap(data[mid], data[1]);
+    if(data[length - 1] < data[mid]) {
+        rpp::swap(data[length - 1], data[mid]);
+        if(data[mid] < data[1]) rpp::swap(data[mid], data[1]);
+    }
+    rpp::swap(data[0], data[mid]);
+    const T& pivot = data[0];
+
+    // data[1] and data[length - 1] bound the first scans, and each swap bounds the next ones.
+    u64 i = 1;
+    u64 j = length;
+    for(;;) {
+        while(data[i] < pivot) i++;
+        j--;
+        while(pivot < data[j]) j--;
+        if(i >= j) return i;
+        rpp::swap(data[i++], data[j]);
+    }
+}
+
+constexpr u64 INSERTION_SORT_LENGTH = 16;
+
+// Introsort: quicksort that falls back to heap sort when the partitions degenerate.
+template<typename T>
+void sort(T* data, u64 length, u64 depth) noexcept {
+    while(length > INSERTION_SORT_LENGTH) {
+        if(depth-- == 0) {
+            heap_sort(data, length);
+            return;
+        }
+        u64 left = partition(data, length);
+        sort(data, left, depth);
+        data += left;
+        length -= left;
+    }
+    insertion_sort(data, length);
+}
+
+[[nodiscard]] inline u64 depth(u64 length) noexcept {
+    return length ? 2 * (Math::log2(length) + 1) : 0;
+}
+
+// Windows at most this long are searched by counting smaller keys instead of bisecting.
+constexpr u64 SCAN_LENGTH = 16;
+
+template<typename T>
+[[nodiscard]] u64 count_less(const T* data, u64 length, const T& key) noexcept {
+    u64 count = 0;
+    u64 i = 0;
+    if constexpr(Same<T, i32> || Same<T, u32>) {
+        // Flipping the sign bit orders unsigned keys as signed ones.
+        SIMD::I32x4 bias = SIMD::I32x4::set1(Same<T, u32> ? Limits<i32>::min() : 0);
+        SIMD::I32x4 needle = SIMD::I32x4::bit_xor(SIMD::I32x4::set1(static_cast<i32>(key)), bias);
+        for(; i + 4 <= length; i += 4) {
+            SIMD::I32x4 v = SIMD::I32x4::load(reinterpret_cast<const i32*>(data + i));
+            SIMD::I32x4 less = SIMD::I32x4::cmpgt(needle, SIMD::I32x4::bit_xor(v, bias));
+            count += Math::popcount(SIMD::I32x4::movemask(less));
+        }
+    }
+    for(; i < length; i++) count += data[i] < key;
+    return count;
+}
+
+} // namespace detail
+
+// Sorts data in place by operator<. The sort is not stable.
+template<Ordered T>
+void sort(T* data, u64 length) noexcept {
+    detail::sort(data, length, detail::depth(length));
+}
+
+template<Ordered T, Allocator A>
+void sort(Vec<T, A>& vec) noexcept {
+    sort(vec.data(), vec.length());
+}
+
+// Index of the first element of sorted data that is not less than key. The search bisects
+// without branching on the data until a short window is left, then counts that window, which is
+// vectorized for i32 and u32.
+template<Ordered T>
+[[nodiscard]] u64 lower_bound(const T* data, u64 length, const T& key) noexcept {
+    u64 base = 0;
+    while(length > detail::SCAN_LENGTH) {
+        u64 half = length / 2;
+        bool right = data[base + half] < key;
+        base += right ? half + 1 : 0;
+        length = right ? length - half - 1 : half;
+    }
+    return base + detail::count_less(data + base, length, key);
+}
+
+} // namespace rpp::Sort
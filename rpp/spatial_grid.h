@@ -0,0 +1,365 @@
+
+#pragma once
+
+#include "async.h"
+#include "base.h"
+#include "parallel.h"
+#include "pool.h"
+#include "vmath.h"
+
+namespace rpp::Math {
+
+// Hashed uniform grid over a slice of points, for neighbour queries. Points are identified by
+// their index in the slice. Cells are cubes of the given size; each maps to one of a power of two
+// buckets, at least as many as there are points, so the grid needs no bounds.
+//
+// Building counting-sorts the points by bucket, so the indices and positions of a bucket are
+// contiguous and a query reads each cell it covers as one run. Points are expected to lie within
+// 2^30 cells of the origin. Building on a pool computes bucket keys and sorts in parallel; the
+// result is identical to building serially.
+template<Allocator A = Mdefault>
+struct Spatial_Grid {
+
+    // Building on a pool first partitions the points by the top bits of their bucket, then sorts
+    // each partition on its own.
+    constexpr static u32 PART_BITS = 8;
+    // Chunks of points below this size are keyed by the worker that split them.
+    constexpr static u64 CHUNK_SIZE = 4096;
+
+    Spatial_Grid() noexcept = default;
+    explicit Spatial_Grid(f32 cell_size) noexcept
+        : cell_size_(cell_size), inv_cell_size_(1.0f / cell_size) {
+        assert(cell_size > 0.0f);
+    }
+    ~Spatial_Grid() noexcept = default;
+
+    Spatial_Grid(const Spatial_Grid&) noexcept = delete;
+    Spatial_Grid& operator=(const Spatial_Grid&) noexcept = delete;
+
+    Spatial_Grid(Spatial_Grid&&) noexcept = default;
+    Spatial_Grid& operator=(Spatial_Grid&&) noexcept = default;
+
+    // Rebuilding reuses the storage of the previous build.
+    void build(Slice<Vec3> points) noexcept {
+        u32 n = prepare(points.length());
+        cell_keys(points, 0, n);
+        sort_part(points, keys_.data(), null, 0, n, 0, buckets());
+        starts_[buckets()] = n;
+    }
+
+    template<Allocator P>
+    [[nodiscard]] Async::Task<void> build(Async::Pool<P>& pool, Slice<Vec3> points) noexcept {
+        co_await pool.suspend();
+        u64 threads = Math::max<u64>(pool.n_threads(), 1);
+        u64 chunk = Math::max(CHUNK_SIZE, points.length() / (4 * threads) + 1);
+        if(points.length() <= chunk) {
+            build(points);
+            co_return;
+        }
+        u32 n = prepare(points.length());
+        u32 part_bits = Math::min(PART_BITS, bucket_bits_);
+        u32 shift = bucket_bits_ - part_bits;
+        u32 parts = 1u << part_bits;
+        part_keys_.resize(n);
+        part_index_.resize(n);
+
+        chunks_.clear();
+        for(u64 begin = 0; begin < n; begin += chunk) {
+            chunks_.push(Pair<u32, u32>{static_cast<u32>(begin),
+                                        static_cast<u32>(Math::min<u64>(begin + chunk, n))});
+        }
+        u64 n_chunks = chunks_.length();
+        part_counts_.clear();
+        part_counts_.resize(n_chunks * parts);
+
+        co_await Async::parallel_for(pool, Slice{chunks_}, 1,
+                                     [&](u64 c, const Pair<u32, u32>& range) {
+                                         cell_keys(points, range.first, range.second);
+                                         u32* counts = part_counts_.data() + c * parts;
+                                         for(u32 i = range.first; i < range.second; i++) {
+                                             counts[keys_[i] >> shift]++;
+                                         }
+                                     });
+
+        // Each chunk scatters its points of a partition after those of the chunks before it.
+        part_starts_.clear();
+        part_starts_.resize(parts + 1);
+        u32 running = 0;
+        for(u32 p = 0; p < parts; p++) {
+            part_starts_[p] = running;
+            for(u64 c = 0; c < n_chunks; c++) {
+                u32 count = part_counts_[c * parts + p];
+                part_counts_[c * parts + p] = running;
+                running += count;
+            }
+        }
+        part_starts_[parts] = running;
+
+        co_await Async::parallel_for(pool, Slice{chunks_}, 1,
+                                     [&](u64 c, const Pair<u32, u32>& range) {
+                                         u32* cursors = part_counts_.data() + c * parts;
+                                         for(u32 i = range.first; i < range.second; i++) {
+                                             u32 slot = cursors[keys_[i] >> shift]++;
+                                             part_keys_[slot] = keys_[i];
+                                             part_index_[slot] = i;
+                                         }
+                                     });
+
+        co_await Async::parallel_for(pool, Slice<u32>{part_starts_.data(), parts}, 1,
+                                     [&](u64 p, const u32& begin) {
+                                         u32 lo = static_cast<u32>(p) << shift;
+                                         sort_part(points, part_keys_.data(), part_index_.data(),
+                                                   begin, part_starts_[p + 1], lo,
+                                                   lo + (1u << shift));
+                                     });
+        starts_[buckets()] = n;
+    }
+
+    // Iterates the indices of the points inside a box or a sphere, in no particular order.
+    struct Query {
+
+        struct Iterator {
+            Iterator operator++() noexcept {
+                query_->pos_++;
+                query_->seek();
+                return *this;
+            }
+
+            [[nodiscard]] u32 operator*() const noexcept {
+                return query_->grid_.indices_[query_->pos_];
+            }
+
+            [[nodiscard]] bool operator==(const Iterator& rhs) const noexcept {
+                return done() == rhs.done();
+            }
+
+        private:
+            explicit Iterator(Query* query) noexcept : query_(query) {
+            }
+
+            [[nodiscard]] bool done() const noexcept {
+                return !query_ || query_->done_;
+            }
+
+            Query* query_ = null;
+
+            friend struct Query;
+        };
+
+        [[nodiscard]] Iterator begin() noexcept {
+            return Iterator{this};
+        }
+        [[nodiscard]] Iterator end() noexcept {
+            return Iterator{null};
+        }
+
+    private:
+        explicit Query(const Spatial_Grid& grid, BBox box, Vec3 center, f32 radius_sq,
+                       bool sphere) noexcept
+            : grid_(grid), box_(box), center_(center), radius_sq_(radius_sq), sphere_(sphere) {
+            if(grid.indices_.empty() || box.empty()) {
+                done_ = true;
+                return;
+            }
+            // Boxes covering more cells than there are buckets scan every point instead.
+            f64 cells = 1.0;
+            constexpr f32 LIMIT = static_cast<f32>(1 << 30);
+            for(u64 i = 0; i < 3; i++) {
+                f32 lo = box.min[i] * grid.inv_cell_size_;
+                f32 hi = box.max[i] * grid.inv_cell_size_;
+                if(Math::abs(lo) > LIMIT || Math::abs(hi) > LIMIT) all_ = true;
+                cells *= static_cast<f64>(Math::floor(hi) - Math::floor(lo)) + 1.0;
+            }
+            if(all_ || cells > static_cast<f64>(grid.buckets())) {
+                all_ = true;
+                pos_ = 0;
+                end_ = static_cast<u32>(grid.indices_.length());
+            } else {
+                lo_ = grid.cell(box.min);
+                hi_ = grid.cell(box.max);
+                cell_ = lo_;
+                enter();
+            }
+            seek();
+        }
+
+        // Moves pos_ to the next accepted point, at or after it.
+        void seek() noexcept {
+            for(;;) {
+                for(; pos_ < end_; pos_++) {
+                    if(accept(grid_.points_[pos_])) return;
+                }
+                if(all_ || !next_cell()) {
+                    done_ = true;
+                    return;
+                }
+            }
+        }
+
+        [[nodiscard]] bool next_cell() noexcept {
+            if(++cell_.x > hi_.x) {
+                cell_.x = lo_.x;
+                if(++cell_.y > hi_.y) {
+                    cell_.y = lo_.y;
+                    if(++cell_.z > hi_.z) return false;
+                }
+            }
+            enter();
+            return true;
+        }
+
+        void enter() noexcept {
+            u32 bucket = grid_.bucket(cell_);
+            pos_ = grid_.starts_[bucket];
+            end_ = grid_.starts_[bucket + 1];
+        }
+
+        // Buckets may hold other cells, whose points are reported when their own cell is visited.
+        [[nodiscard]] bool accept(Vec3 p) const noexcept {
+            if(!all_ && grid_.cell(p) != cell_) return false;
+            if(sphere_) {
+                Vec3 d = p - center_;
+                return dot(d, d) <= radius_sq_;
+            }
+            return p.x >= box_.min.x && p.y >= box_.min.y && p.z >= box_.min.z &&
+                   p.x <= box_.max.x && p.y <= box_.max.y && p.z <= box_.max.z;
+        }
+
+        const Spatial_Grid& grid_;
+        BBox box_;
+        Vec3 center_;
+        f32 radius_sq_ = 0.0f;
+        bool sphere_ = false;
+        bool all_ = false;
+        bool done_ = false;
+        Vec3i lo_, hi_, cell_;
+        u32 pos_ = 0;
+        u32 end_ = 0;
+
+        friend struct Spatial_Grid;
+    };
+
+    [[nodiscard]] Query in_box(BBox box) const noexcept {
+        return Query{*this, box, Vec3{}, 0.0f, false};
+    }
+    [[nodiscard]] Query in_radius(Vec3 center, f32 radius) const noexcept {
+        BBox box{center - Vec3{radius}, center + Vec3{radius}};
+        return Query{*this, box, center, radius * radius, true};
+    }
+
+    [[nodiscard]] Vec3i cell(Vec3 p) const noexcept {
+        return Vec3i{static_cast<i32>(Math::floor(p.x * inv_cell_size_)),
+                     static_cast<i32>(Math::floor(p.y * inv_cell_size_)),
+                     static_cast<i32>(Math::floor(p.z * inv_cell_size_))};
+    }
+    [[nodiscard]] u32 bucket(Vec3i cell) const noexcept {
+        u32 h = (static_cast<u32>(cell.x) * HASH_X) ^ (static_cast<u32>(cell.y) * HASH_Y) ^
+                (static_cast<u32>(cell.z) * HASH_Z);
+        return h & mask_;
+    }
+
+    [[nodiscard]] f32 cell_size() const noexcept {
+        return cell_size_;
+    }
+    [[nodiscard]] u32 buckets() const noexcept {
+        return starts_.empty() ? 0 : 1u << bucket_bits_;
+    }
+    // Indices of the points, sorted by bucket.
+    [[nodiscard]] Slice<u32> indices() const noexcept {
+        return Slice<u32>{indices_};
+    }
+    // Positions in the same order as indices().
+    [[nodiscard]] Slice<Vec3> points() const noexcept {
+        return Slice<Vec3>{points_};
+    }
+    // Points in bucket b are at starts()[b] up to starts()[b + 1].
+    [[nodiscard]] Slice<u32> starts() const noexcept {
+        return Slice<u32>{starts_};
+    }
+
+private:
+    constexpr static u32 HASH_X = 73856093;
+    constexpr static u32 HASH_Y = 19349663;
+    constexpr static u32 HASH_Z = 83492791;
+
+    [[nodiscard]] u32 prepare(u64 length) noexcept {
+        assert(length <= (1ull << 31));
+        u32 n = static_cast<u32>(length);
+        bucket_bits_ = 0;
+        while((1ull << bucket_bits_) < n) bucket_bits_++;
+        mask_ = (1u << bucket_bits_) - 1;
+        starts_.clear();
+        starts_.resize((1ull << bucket_bits_) + 1);
+        indices_.resize(n);
+        points_.resize(n);
+        keys_.resize(n);
+        return n;
+    }
+
+    // Fills keys_ from begin to end, four points at a time; matches bucket(cell(p)).
+    void cell_keys(Slice<Vec3> points, u32 begin, u32 end) noexcept {
+        using SIMD::F32x4;
+        using SIMD::I32x4;
+        F32x4 scale = F32x4::set1(inv_cell_size_);
+        I32x4 hx = I32x4::set1(static_cast<i32>(HASH_X));
+        I32x4 hy = I32x4::set1(static_cast<i32>(HASH_Y));
+        I32x4 hz = I32x4::set1(static_cast<i32>(HASH_Z));
+        I32x4 mask = I32x4::set1(static_cast<i32>(mask_));
+        u32 i = begin;
+        for(; i + 4 <= end; i += 4) {
+            const Vec3* p = &points[i];
+            F32x4 x = F32x4::set(p[0].x, p[1].x, p[2].x, p[3].x);
+            F32x4 y = F32x4::set(p[0].y, p[1].y, p[2].y, p[3].y);
+            F32x4 z = F32x4::set(p[0].z, p[1].z, p[2].z, p[3].z);
+            I32x4 cx = F32x4::to_i32(F32x4::floor(F32x4::mul(x, scale)));
+            I32x4 cy = F32x4::to_i32(F32x4::floor(F32x4::mul(y, scale)));
+            I32x4 cz = F32x4::to_i32(F32x4::floor(F32x4::mul(z, scale)));
+            I32x4 h = I32x4::bit_xor(I32x4::bit_xor(I32x4::mul(cx, hx), I32x4::mul(cy, hy)),
+                                     I32x4::mul(cz, hz));
+            I32x4::store(I32x4::bit_and(h, mask), reinterpret_cast<i32*>(keys_.data() + i));
+        }
+        for(; i < end; i++) keys_[i] = bucket(cell(points[i]));
+    }
+
+    // Counting-sorts the points from begin to end, whose buckets lie in lo up to hi, into the same
+    // range of indices_ and points_. Without an index, the points are in their original order.
+    void sort_part(Slice<Vec3> points, const u32* keys, const u32* index, u32 begin, u32 end,
+                   u32 lo, u32 hi) noexcept {
+        u32* starts = starts_.data();
+        for(u32 b = lo; b < hi; b++) starts[b] = 0;
+        for(u32 i = begin; i < end; i++) starts[keys[i]]++;
+        u32 running = begin;
+        for(u32 b = lo; b < hi; b++) {
+            u32 count = starts[b];
+            starts[b] = running;
+            running += count;
+        }
+        for(u32 i = begin; i < end; i++) {
+            u32 primitive = index ? index[i] : i;
+            u32 slot = starts[keys[i]]++;
+            indices_[slot] = primitive;
+            points_[slot] = points[primitive];
+        }
+        // Each start was advanced to the start of the next bucket.
+        for(u32 b = hi - 1; b > lo; b--) starts[b] = starts[b - 1];
+        starts[lo] = begin;
+    }
+
+    f32 cell_size_ = 1.0f;
+    f32 inv_cell_size_ = 1.0f;
+    u32 bucket_bits_ = 0;
+    u32 mask_ = 0;
+    Vec<u32, A> starts_;
+    Vec<u32, A> indices_;
+    Vec<Vec3, A> points_;
+
+    // Scratch space for building.
+    Vec<u32, A> keys_;
+    Vec<u32, A> part_keys_;
+    Vec<u32, A> part_index_;
+    Vec<u32, A> part_counts_;
+    Vec<u32, A> part_starts_;
+    Vec<Pair<u32, u32>, A> chunks_;
+};
+
+} // namespace rpp::Math
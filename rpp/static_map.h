@@ -0,0 +1,192 @@
+
+#pragma once
+
+#include "base.h"
+
+namespace rpp {
+
+namespace detail {
+
+[[nodiscard]] constexpr u64 static_map_slots(u64 n) noexcept {
+    u64 slots = 1;
+    while(slots < n + n / 4) slots <<= 1;
+    return slots;
+}
+
+template<typename K, typename Q>
+[[nodiscard]] constexpr bool static_map_equal(const K& key, const Q& query) noexcept {
+    return key == query;
+}
+[[nodiscard]] inline bool static_map_equal(const Literal& key, String_View query) noexcept {
+    return String_View{key} == query;
+}
+
+} // namespace detail
+
+// Immutable map over a fixed key set, built at compile time when declared constexpr. Keys are
+// hashed into buckets of about two, and each bucket stores the seed that sends its keys to free
+// slots, so every key has its own slot and a lookup reads one. String keys are stored as
+// Literals and looked up with String_Views; their hashes agree.
+template<Key K, typename V, u64 N>
+    requires(N > 0) && Default_Constructable<K> && Default_Constructable<V>
+struct Static_Map {
+    using Index = If<(N < 255), u8, If<(N < 65535), u16, u32>>;
+
+    constexpr static u64 SLOTS = detail::static_map_slots(N);
+    constexpr static u64 MASK = SLOTS - 1;
+    constexpr static u64 BUCKETS = N / 2 + 1;
+
+    template<typename... Ss>
+        requires(sizeof...(Ss) == N) && All_Are<Pair<K, V>, Ss...>
+    constexpr explicit Static_Map(Ss&&... entries) noexcept {
+        u64 i = 0;
+        ((keys_[i] = rpp::move(entries.first), values_[i] = rpp::move(entries.second), i++), ...);
+        build();
+    }
+
+    // Copies rather than clones, since clone() copies trivial types with a memcpy that is not
+    // allowed in constant evaluation.
+    constexpr explicit Static_Map(const Array<K, N>& keys, const Array<V, N>& values) noexcept
+        requires Copy_Constructable<K> && Copy_Constructable<V>
+        : keys_(keys), values_(values) {
+        build();
+    }
+
+    [[nodiscard]] constexpr u64 length() const noexcept {
+        return N;
+    }
+
+    [[nodiscard]] const K& key(u64 idx) const noexcept {
+        return keys_[idx];
+    }
+    [[nodiscard]] const V& value(u64 idx) const noexcept {
+        return values_[idx];
+    }
+
+    // Index of key in the order the entries were given.
+    template<Hashable Q>
+    [[nodiscard]] Opt<u64> find(const Q& key) const noexcept {
+        u64 h = rpp::hash(key);
+        Index slot = slots_[Hash::hash_combine(h, pilots_[h % BUCKETS]) & MASK];
+        if(slot && detail::static_map_equal(keys_[slot - 1], key)) return Opt<u64>{slot - 1};
+        return {};
+    }
+
+    template<Hashable Q>
+    [[nodiscard]] Opt<Ref<const V>> try_get(const Q& key) const noexcept {
+        if(Opt<u64> idx = find(key); idx.ok()) return Opt{Ref<const V>{values_[*idx]}};
+        return {};
+    }
+
+    template<Hashable Q>
+    [[nodiscard]] bool contains(const Q& key) const noexcept {
+        return find(key).ok();
+    }
+
+    template<Hashable Q>
+    [[nodiscard]] const V& get(const Q& key) const noexcept {
+        Opt<u64> idx = find(key);
+        if(!idx.ok()) die("Failed to find key %!", key);
+        return values_[*idx];
+    }
+
+    // Calls f(key, value) for every entry in the order they were given.
+    template<typename F>
+        requires Invocable<F, const K&, const V&>
+    void each(F&& f) const noexcept {
+        for(u64 i = 0; i < N; i++) f(keys_[i], values_[i]);
+    }
+
+private:
+    constexpr void build() noexcept {
+        u64 hashes[N] = {};
+        u64 sizes[BUCKETS] = {};
+        for(u64 i = 0; i < N; i++) {
+            for(u64 j = 0; j < i; j++) {
+                if(keys_[j] == keys_[i]) die("Duplicate key in Static_Map!");
+            }
+            hashes[i] = rpp::hash(keys_[i]);
+            sizes[hashes[i] % BUCKETS]++;
+        }
+
+        // Largest buckets first, while most slots are still free.
+        u64 order[BUCKETS] = {};
+        for(u64 b = 0; b < BUCKETS; b++) {
+            u64 j = b;
+            for(; j > 0 && sizes[order[j - 1]] < sizes[b]; j--) order[j] = order[j - 1];
+            order[j] = b;
+        }
+
+        u64 members[N] = {};
+        for(u64 bucket : order) {
+            if(!sizes[bucket]) break;
+            u64 count = 0;
+            for(u64 i = 0; i < N; i++) {
+                if(hashes[i] % BUCKETS == bucket) members[count++] = i;
+            }
+            u64 pilot = 0;
+            while(!place(hashes, members, count, pilot)) {
+                if(++pilot > Limits<u16>::max()) die("Failed to find a perfect hash!");
+            }
+            pilots_[bucket] = static_cast<u16>(pilot);
+        }
+    }
+
+    // Claims a slot for each member of a bucket, or none if any slot is taken.
+    [[nodiscard]] constexpr bool place(const u64* hashes, const u64* members, u64 count,
+                                       u64 pilot) noexcept {
+        for(u64 m = 0; m < count; m++) {
+            u64 slot = Hash::hash_combine(hashes[members[m]], pilot) & MASK;
+            if(slots_[slot]) {
+                for(u64 k = 0; k < m; k++) {
+                    slots_[Hash::hash_combine(hashes[members[k]], pilot) & MASK] = 0;
+                }
+                return false;
+            }
+            slots_[slot] = static_cast<Index>(members[m] + 1);
+        }
+        return true;
+    }
+
+    Array<K, N> keys_;
+    Array<V, N> values_;
+    // One past the index of the entry in each slot, or zero.
+    Array<Index, SLOTS> slots_;
+    Array<u16, BUCKETS> pilots_;
+};
+
+template<typename K, typename V, typename... Ss>
+Static_Map(Pair<K, V>, Ss...) -> Static_Map<K, V, 1 + sizeof...(Ss)>;
+
+namespace Reflect {
+
+template<typename E>
+    requires(Refl<E>::kind == Kind::enum_)
+[[nodiscard]] consteval auto enum_names() noexcept {
+    constexpr u64 N = List_Length<typename Refl<E>::members>;
+    Array<Literal, N> names;
+    Array<E, N> values;
+    u64 i = 0;
+    iterate_enum<E>([&](const Literal& name, E value) {
+        names[i] = name;
+        values[i] = value;
+        i++;
+    });
+    return Static_Map<Literal, E, N>{names, values};
+}
+
+// Case names of a reflected enum, mapped to their values.
+template<typename E>
+    requires(Refl<E>::kind == Kind::enum_)
+constexpr auto ENUM_NAMES = enum_names<E>();
+
+template<typename E>
+    requires(Refl<E>::kind == Kind::enum_)
+[[nodiscard]] Opt<E> enum_from_name(String_View name) noexcept {
+    if(Opt<u64> idx = ENUM_NAMES<E>.find(name); idx.ok()) return Opt<E>{ENUM_NAMES<E>.value(*idx)};
+    return {};
+}
+
+} // namespace Reflect
+
+} // namespace rpp
@@ -10,6 +10,11 @@ namespace rpp {
 template<Allocator A = Mdefault>
 struct String;
 
+template<typename T>
+struct Opt;
+
+struct String_Split;
+
 struct String_View {
 
     constexpr String_View() noexcept = default;
@@ -70,6 +75,24 @@ struct String_View {
 
     [[nodiscard]] constexpr String_View sub(u64 start, u64 end) const noexcept;
 
+    // Searches compare 16 or 32 bytes per step with SIMD::U8x16 and return the index of the
+    // first match.
+    [[nodiscard]] Opt<u64> find(u8 c) const noexcept;
+    [[nodiscard]] Opt<u64> find(String_View needle) const noexcept;
+    // First byte that is any of the bytes in set.
+    [[nodiscard]] Opt<u64> find_any(String_View set) const noexcept;
+
+    [[nodiscard]] constexpr bool starts_with(String_View prefix) const noexcept;
+    [[nodiscard]] constexpr bool ends_with(String_View suffix) const noexcept;
+
+    // Iterates the pieces between delimiters, as views into this string. Adjacent delimiters
+    // give empty pieces, and a string without delimiters is a single piece.
+    [[nodiscard]] String_Split split(u8 delimiter) const noexcept;
+
+    // Rejects overlong encodings, surrogates and code points above U+10FFFF. ASCII runs are
+    // skipped 32 bytes at a time.
+    [[nodiscard]] bool valid_utf8() const noexcept;
+
     [[nodiscard]] constexpr String_View clone() const noexcept {
         return String_View{data_, length_};
     }
@@ -81,16 +104,25 @@ private:
     friend struct Reflect::Refl<String_View>;
 };
 
+// Strings of up to SMALL bytes are stored inline: the text overlays data_, length_ and the low
+// bytes of capacity_, and the high byte of capacity_ holds the length. Heap strings set the top
+// bit of capacity_ instead, which the inline length never reaches. A zeroed string is empty and
+// inline. Moving a string moves short text, so views don't survive moving the string.
 template<Allocator A>
 struct String {
 
+    constexpr static u64 SMALL = 23;
+
     String() noexcept = default;
-    explicit String(u64 capacity) noexcept
-        : data_(reinterpret_cast<u8*>(A::alloc(capacity))), length_(0), capacity_(capacity) {
+    explicit String(u64 capacity) noexcept {
+        if(capacity > SMALL) {
+            data_ = reinterpret_cast<u8*>(A::alloc(capacity));
+            capacity_ = capacity | HEAP;
+        }
     }
 
     ~String() noexcept {
-        A::free(data_);
+        if(!small()) A::free(data_);
         data_ = null;
         capacity_ = 0;
         length_ = 0;
@@ -99,6 +131,7 @@ struct String {
     String(const String& src) noexcept = delete;
     String& operator=(const String& src) noexcept = delete;
 
+    // Copying the three fields copies the inline text along with them.
     String(String&& src) noexcept
         : data_(src.data_), length_(src.length_), capacity_(src.capacity_) {
         src.data_ = null;
@@ -118,11 +151,9 @@ struct String {
 
     template<Allocator B = A>
     [[nodiscard]] String<B> clone() const noexcept {
-        String<B> ret;
-        ret.data_ = reinterpret_cast<u8*>(B::alloc(capacity_));
-        ret.length_ = length_;
-        ret.capacity_ = capacity_;
-        Libc::memcpy(ret.data_, data_, length_);
+        String<B> ret{capacity()};
+        ret.set_length(length());
+        Libc::memcpy(ret.data(), data(), length());
         return ret;
     }
 
@@ -132,7 +163,7 @@ struct String {
     [[nodiscard]] const u8& operator[](u64 idx) const noexcept;
 
     [[nodiscard]] String_View view() const noexcept {
-        return String_View{data_, length_};
+        return String_View{data(), length()};
     }
     [[nodiscard]] String_View sub(u64 start, u64 end) const noexcept;
 
@@ -142,33 +173,33 @@ struct String {
     [[nodiscard]] u64 write(u64 i, String_View text) noexcept;
 
     [[nodiscard]] u8* begin() noexcept {
-        return data_;
+        return data();
     }
     [[nodiscard]] u8* end() noexcept {
-        return data_ + length_;
+        return data() + length();
     }
     [[nodiscard]] const u8* begin() const noexcept {
-        return data_;
+        return data();
     }
     [[nodiscard]] const u8* end() const noexcept {
-        return data_ + length_;
+        return data() + length();
     }
 
     [[nodiscard]] u8* data() noexcept {
-        return data_;
+        return small() ? inline_data() : data_;
     }
     [[nodiscard]] const u8* data() const noexcept {
-        return data_;
+        return small() ? inline_data() : data_;
     }
     [[nodiscard]] u64 length() const noexcept {
-        return length_;
+        return small() ? inline_data()[SMALL] : length_;
     }
     [[nodiscard]] u64 capacity() const noexcept {
-        return capacity_;
+        return small() ? SMALL : capacity_ & ~HEAP;
     }
 
     [[nodiscard]] bool empty() const noexcept {
-        return length_ == 0;
+        return length() == 0;
     }
 
     template<Allocator RA>
@@ -178,6 +209,19 @@ struct String {
     [[nodiscard]] String<RA> append(const String<B>& next) const noexcept;
 
 private:
+    constexpr static u64 HEAP = u64{1} << 63;
+
+    // The high byte of capacity_ is the last byte of the object on little endian targets.
+    [[nodiscard]] bool small() const noexcept {
+        return (capacity_ & HEAP) == 0;
+    }
+    [[nodiscard]] u8* inline_data() noexcept {
+        return reinterpret_cast<u8*>(this);
+    }
+    [[nodiscard]] const u8* inline_data() const noexcept {
+        return reinterpret_cast<const u8*>(this);
+    }
+
     u8* data_ = null;
     u64 length_ = 0;
     u64 capacity_ = 0;
@@ -188,58 +232,56 @@ private:
 
 template<Allocator A>
 [[nodiscard]] String<A> String_View::string() const noexcept {
-    String<A> ret;
-    ret.data_ = reinterpret_cast<u8*>(A::alloc(length_));
-    ret.length_ = length_;
-    ret.capacity_ = length_;
-    Libc::memcpy(ret.data_, data_, length_);
+    String<A> ret{length_};
+    ret.set_length(length_);
+    Libc::memcpy(ret.data(), data_, length_);
     return ret;
 }
 
+// Comparisons go through memcmp, which libc vectorizes, and compare every byte: unlike strncmp,
+// they don't stop at a zero byte.
 [[nodiscard]] constexpr bool operator==(String_View l, String_View r) noexcept {
     if(l.length() != r.length()) return false;
-    return Libc::strncmp(reinterpret_cast<const char*>(l.data()),
-                         reinterpret_cast<const char*>(r.data()), l.length()) == 0;
+    if(l.empty()) return true;
+    if(!is_constexpr()) return Libc::memcmp(l.data(), r.data(), l.length()) == 0;
+    for(u64 i = 0; i < l.length(); i++) {
+        if(l.data()[i] != r.data()[i]) return false;
+    }
+    return true;
 }
 
 [[nodiscard]] constexpr bool operator<(String_View l, String_View r) noexcept {
     u64 length = l.length() < r.length() ? l.length() : r.length();
+    if(!is_constexpr()) {
+        i32 order = length ? Libc::memcmp(l.data(), r.data(), length) : 0;
+        if(order) return order < 0;
+        return l.length() < r.length();
+    }
     for(u64 i = 0; i < length; i++) {
-        if(l[i] < r[i]) return true;
-        if(l[i] > r[i]) return false;
+        if(l.data()[i] < r.data()[i]) return true;
+        if(l.data()[i] > r.data()[i]) return false;
     }
     return l.length() < r.length();
 }
 
 template<Allocator A>
 [[nodiscard]] bool operator==(const String<A>& l, String_View r) noexcept {
-    if(l.length() != r.length()) return false;
-    return Libc::strncmp(reinterpret_cast<const char*>(l.data()),
-                         reinterpret_cast<const char*>(r.data()), l.length()) == 0;
+    return l.view() == r;
 }
 
 template<Allocator B>
 [[nodiscard]] bool operator==(String_View l, const String<B>& r) noexcept {
-    if(l.length() != r.length()) return false;
-    return Libc::strncmp(reinterpret_cast<const char*>(l.data()),
-                         reinterpret_cast<const char*>(r.data()), l.length()) == 0;
+    return l == r.view();
 }
 
 template<Allocator A, Allocator B>
 [[nodiscard]] bool operator==(const String<A>& l, const String<B>& r) noexcept {
-    if(l.length() != r.length()) return false;
-    return Libc::strncmp(reinterpret_cast<const char*>(l.data()),
-                         reinterpret_cast<const char*>(r.data()), l.length()) == 0;
+    return l.view() == r.view();
 }
 
 template<Allocator A, Allocator B>
 [[nodiscard]] bool operator<(const String<A>& l, const String<B>& r) noexcept {
-    u64 length = l.length() < r.length() ? l.length() : r.length();
-    for(u64 i = 0; i < length; i++) {
-        if(l[i] < r[i]) return true;
-        if(l[i] > r[i]) return false;
-    }
-    return l.length() < r.length();
+    return l.view() < r.view();
 }
 
 namespace ascii {
@@ -255,6 +297,8 @@ namespace ascii {
 [[nodiscard]] constexpr bool is_whitespace(u8 c) noexcept {
     return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v';
 }
+// Folds A-Z to a-z sixteen bytes at a time. Other bytes, including UTF-8, must match exactly.
+[[nodiscard]] bool equal_ignore_case(String_View l, String_View r) noexcept;
 
 } // namespace ascii
 
@@ -275,6 +319,48 @@ struct Is_String<String<A>> {
 template<typename T>
 concept Any_String = detail::Is_String<T>::value;
 
+struct String_Split {
+
+    struct Iterator {
+        Iterator() noexcept = default;
+        explicit Iterator(String_View rest, u8 delimiter) noexcept
+            : rest{rest}, delimiter{delimiter}, done{false} {
+            next();
+        }
+
+        [[nodiscard]] String_View operator*() const noexcept {
+            return piece;
+        }
+        Iterator& operator++() noexcept {
+            next();
+            return *this;
+        }
+        // Only compares whether iteration has ended, which is all range-for needs.
+        [[nodiscard]] bool operator==(const Iterator& other) const noexcept {
+            return done == other.done;
+        }
+
+    private:
+        void next() noexcept;
+
+        String_View rest;
+        String_View piece;
+        u8 delimiter = 0;
+        bool last = false;
+        bool done = true;
+    };
+
+    [[nodiscard]] Iterator begin() const noexcept {
+        return Iterator{text, delimiter};
+    }
+    [[nodiscard]] Iterator end() const noexcept {
+        return Iterator{};
+    }
+
+    String_View text;
+    u8 delimiter = 0;
+};
+
 RPP_RECORD(String_View, RPP_FIELD(data_), RPP_FIELD(length_));
 
 template<Allocator A>
@@ -285,18 +371,14 @@ namespace Hash {
 template<Allocator A>
 struct Hash<String<A>> {
     [[nodiscard]] static u64 hash(const String<A>& string) noexcept {
-        u64 h = 0;
-        for(u8 c : string) h = hash_combine(h, rpp::hash(c));
-        return h;
+        return bytes(string.data(), string.length());
     }
 };
 
 template<>
 struct Hash<String_View> {
     [[nodiscard]] constexpr static u64 hash(const String_View& string) noexcept {
-        u64 h = 0;
-        for(u8 c : string) h = hash_combine(h, rpp::hash(c));
-        return h;
+        return bytes(string.data(), string.length());
     }
 };
 
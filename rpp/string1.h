@@ -9,27 +9,31 @@ namespace rpp {
 
 template<Allocator A>
 void String<A>::set_length(u64 length) noexcept {
-    assert(length <= capacity_);
-    length_ = length;
+    assert(length <= capacity());
+    if(small()) {
+        inline_data()[SMALL] = static_cast<u8>(length);
+    } else {
+        length_ = length;
+    }
 }
 
 template<Allocator A>
 [[nodiscard]] const u8& String<A>::operator[](u64 idx) const noexcept {
-    assert(idx < length_);
-    return data_[idx];
+    assert(idx < length());
+    return data()[idx];
 }
 
 template<Allocator A>
 [[nodiscard]] u8& String<A>::operator[](u64 idx) noexcept {
-    assert(idx < length_);
-    return data_[idx];
+    assert(idx < length());
+    return data()[idx];
 }
 
 template<Allocator A>
 [[nodiscard]] String_View String<A>::sub(u64 start, u64 end) const noexcept {
     assert(start <= end);
-    assert(end <= length_);
-    return String_View{data_ + start, end - start};
+    assert(end <= length());
+    return String_View{data() + start, end - start};
 }
 
 template<Allocator A>
@@ -44,11 +48,7 @@ template<Allocator A>
 template<Allocator SA>
 template<Allocator RA>
 [[nodiscard]] String<RA> String<SA>::terminate() const noexcept {
-    String<RA> ret{length_ + 1};
-    ret.set_length(length_ + 1);
-    Libc::memcpy(ret.data(), data_, length_);
-    ret[length_] = '\0';
-    return ret;
+    return view().template terminate<RA>();
 }
 
 [[nodiscard]] constexpr String_View String_View::sub(u64 start, u64 end) const noexcept {
@@ -62,6 +62,33 @@ template<Allocator RA>
     return data_[idx];
 }
 
+[[nodiscard]] constexpr bool String_View::starts_with(String_View prefix) const noexcept {
+    return prefix.length_ <= length_ && String_View{data_, prefix.length_} == prefix;
+}
+
+[[nodiscard]] constexpr bool String_View::ends_with(String_View suffix) const noexcept {
+    return suffix.length_ <= length_ &&
+           String_View{data_ + length_ - suffix.length_, suffix.length_} == suffix;
+}
+
+[[nodiscard]] inline String_Split String_View::split(u8 delimiter) const noexcept {
+    return String_Split{*this, delimiter};
+}
+
+inline void String_Split::Iterator::next() noexcept {
+    if(last) {
+        done = true;
+        return;
+    }
+    if(Opt<u64> i = rest.find(delimiter); i.ok()) {
+        piece = rest.sub(0, *i);
+        rest = rest.sub(*i + 1, rest.length());
+    } else {
+        piece = rest;
+        last = true;
+    }
+}
+
 [[nodiscard]] constexpr String_View String_View::file_suffix() const noexcept {
 
     if(length_ == 0) return String_View{};
@@ -112,23 +139,23 @@ template<Allocator RA>
 
 template<Allocator A>
 [[nodiscard]] u64 String<A>::write(u64 i, char c) noexcept {
-    assert(i < length_);
-    data_[i] = c;
+    assert(i < length());
+    data()[i] = c;
     return i + 1;
 }
 
 template<Allocator A>
 template<Allocator B>
 [[nodiscard]] u64 String<A>::write(u64 i, const String<B>& text) noexcept {
-    assert(i + text.length() <= length_);
-    Libc::memcpy(data_ + i, text.data(), text.length());
+    assert(i + text.length() <= length());
+    Libc::memcpy(data() + i, text.data(), text.length());
     return i + text.length();
 }
 
 template<Allocator A>
 [[nodiscard]] u64 String<A>::write(u64 i, String_View text) noexcept {
-    assert(i + text.length() <= length_);
-    Libc::memcpy(data_ + i, text.data(), text.length());
+    assert(i + text.length() <= length());
+    Libc::memcpy(data() + i, text.data(), text.length());
     return i + text.length();
 }
 
@@ -144,11 +171,7 @@ template<Allocator A>
 template<Allocator A>
 template<Allocator RA, Allocator B>
 [[nodiscard]] String<RA> String<A>::append(const String<B>& next) const noexcept {
-    String<RA> ret{length_ + next.length()};
-    ret.set_length(length_ + next.length());
-    Libc::memcpy(ret.data(), data_, length_);
-    Libc::memcpy(ret.data() + length_, next.data(), next.length());
-    return ret;
+    return view().template append<RA>(next.view());
 }
 
 namespace Format {
@@ -0,0 +1,135 @@
+
+#pragma once
+
+#include "base.h"
+
+namespace rpp {
+
+// Builds large text by appending into a list of chunks, so earlier output is never measured,
+// copied or reallocated again. The chunks can be passed straight to gathering writes like
+// Files::write or Net::Tcp_Stream::write through slices().
+template<Allocator A = Mdefault>
+struct String_Builder {
+
+    constexpr static u64 CHUNK = 4096;
+
+    explicit String_Builder(u64 chunk = CHUNK) noexcept : chunk_(chunk) {
+        assert(chunk_ > 0);
+    }
+    ~String_Builder() noexcept = default;
+
+    String_Builder(const String_Builder&) noexcept = delete;
+    String_Builder& operator=(const String_Builder&) noexcept = delete;
+
+    String_Builder(String_Builder&&) noexcept = default;
+    String_Builder& operator=(String_Builder&&) noexcept = default;
+
+    [[nodiscard]] u64 length() const noexcept {
+        return length_;
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return length_ == 0;
+    }
+    [[nodiscard]] const Vec<String<A>, A>& chunks() const noexcept {
+        return chunks_;
+    }
+
+    // Copies text into the remaining space of the last chunk, continuing in new chunks.
+    void append(String_View text) noexcept {
+        u64 done = 0;
+        while(done < text.length()) {
+            if(chunks_.empty() || room() == 0) {
+                chunks_.push(String<A>{Math::max(chunk_, text.length() - done)});
+            }
+            String<A>& tail = chunks_.back();
+            u64 n = Math::min(room(), text.length() - done);
+            u64 used = tail.length();
+            tail.set_length(used + n);
+            Libc::memcpy(tail.data() + used, text.data() + done, n);
+            done += n;
+        }
+        length_ += text.length();
+    }
+    template<Allocator B>
+    void append(const String<B>& text) noexcept {
+        append(text.view());
+    }
+
+    // Any formattable value is measured and written in place, so it never spans two chunks.
+    template<Reflectable T>
+    void append(const T& value) noexcept {
+        emit(Format::Measure<T>::measure(value), [&](String<A>& tail, u64 idx) {
+            return Format::Write<A, T>::write(tail, idx, value);
+        });
+    }
+
+    template<typename... Ts>
+        requires(Reflectable<Ts> && ...)
+    void format(Format_String<Identity<Ts>...> fmt, const Ts&... args) noexcept {
+        segment(fmt.text, fmt.segments[0]);
+        u64 i = 1;
+        ((append(args), segment(fmt.text, fmt.segments[i++])), ...);
+    }
+
+    // Drops all chunks but the first, which is kept for reuse.
+    void clear() noexcept {
+        if(chunks_.empty()) return;
+        String<A> first = rpp::move(chunks_[0]);
+        first.set_length(0);
+        chunks_.clear();
+        chunks_.push(rpp::move(first));
+        length_ = 0;
+    }
+
+    // The filled part of every chunk, in order; valid until the builder is modified.
+    template<Allocator B = A>
+    [[nodiscard]] Vec<Slice<u8>, B> slices() const noexcept {
+        Vec<Slice<u8>, B> ret(chunks_.length());
+        for(const String<A>& chunk : chunks_) {
+            if(chunk.length()) ret.push(Slice<u8>{chunk.data(), chunk.length()});
+        }
+        return ret;
+    }
+
+    // Copies the whole output into one string, for callers that need contiguous text.
+    template<Allocator B = A>
+    [[nodiscard]] String<B> string() const noexcept {
+        String<B> ret{length_};
+        ret.set_length(length_);
+        u64 idx = 0;
+        for(const String<A>& chunk : chunks_) idx = ret.write(idx, chunk.view());
+        return ret;
+    }
+
+private:
+    [[nodiscard]] u64 room() const noexcept {
+        const String<A>& tail = chunks_.back();
+        return tail.capacity() - tail.length();
+    }
+
+    // Reserves bound bytes at the end of the last chunk for write, which returns the index one
+    // past what it actually wrote.
+    template<typename F>
+    void emit(u64 bound, F&& write) noexcept {
+        if(chunks_.empty() || room() < bound) chunks_.push(String<A>{Math::max(chunk_, bound)});
+        String<A>& tail = chunks_.back();
+        u64 used = tail.length();
+        tail.set_length(used + bound);
+        u64 idx = write(tail, used);
+        assert(idx <= used + bound);
+        tail.set_length(idx);
+        length_ += idx - used;
+    }
+
+    void segment(const char* text, Format::detail::Fmt_Segment piece) noexcept {
+        emit(piece.length, [&](String<A>& tail, u64 idx) {
+            return Format::detail::write_segment(tail, idx, text, piece);
+        });
+    }
+
+    Vec<String<A>, A> chunks_;
+    u64 length_ = 0;
+    u64 chunk_ = CHUNK;
+};
+
+} // namespace rpp
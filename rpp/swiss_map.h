@@ -0,0 +1,350 @@
+#pragma once
+
+#include "base.h"
+#include "simd.h"
+
+namespace rpp {
+
+// Open addressing map that keeps one control byte per slot, holding 7 bits of the key's hash, in
+// an array separate from the keys and values. Lookups compare groups of 16 control bytes at once
+// and only touch the slot array on a fragment match, so probing stays within a cache line or two
+// even when values are large.
+template<Key K, Movable V, Allocator A = Mdefault>
+struct Swiss_Map {
+    using Entry = Pair<K, V>;
+
+    Swiss_Map() noexcept = default;
+
+    explicit Swiss_Map(u64 capacity) noexcept {
+        reserve(capacity);
+    }
+
+    Swiss_Map(const Swiss_Map& src) noexcept = delete;
+    Swiss_Map& operator=(const Swiss_Map& src) noexcept = delete;
+
+    Swiss_Map(Swiss_Map&& src) noexcept {
+        ctrl_ = src.ctrl_;
+        slots_ = src.slots_;
+        capacity_ = src.capacity_;
+        length_ = src.length_;
+        growth_left_ = src.growth_left_;
+        src.ctrl_ = null;
+        src.slots_ = null;
+        src.capacity_ = 0;
+        src.length_ = 0;
+        src.growth_left_ = 0;
+    }
+    Swiss_Map& operator=(Swiss_Map&& src) noexcept {
+        this->~Swiss_Map();
+        ctrl_ = src.ctrl_;
+        slots_ = src.slots_;
+        capacity_ = src.capacity_;
+        length_ = src.length_;
+        growth_left_ = src.growth_left_;
+        src.ctrl_ = null;
+        src.slots_ = null;
+        src.capacity_ = 0;
+        src.length_ = 0;
+        src.growth_left_ = 0;
+        return *this;
+    }
+
+    ~Swiss_Map() noexcept {
+        destruct_all();
+        A::free(ctrl_);
+        A::free(slots_);
+        ctrl_ = null;
+        slots_ = null;
+        capacity_ = 0;
+        length_ = 0;
+        growth_left_ = 0;
+    }
+
+    void reserve(u64 new_capacity) noexcept {
+        u64 slots = Math::next_pow2(Math::max<u64>(GROUP, new_capacity + new_capacity / 7 + 1));
+        if(slots <= capacity_) return;
+        rehash(slots);
+    }
+
+    void clear() noexcept {
+        destruct_all();
+        if(ctrl_) Libc::memset(ctrl_, EMPTY, capacity_ + GROUP);
+        length_ = 0;
+        growth_left_ = usable(capacity_);
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return length_ == 0;
+    }
+    [[nodiscard]] u64 length() const noexcept {
+        return length_;
+    }
+
+    V& insert(const K& key, const V& value) noexcept
+        requires Copy_Constructable<K> && Copy_Constructable<V>
+    {
+        return insert(K{key}, V{value});
+    }
+
+    V& insert(K&& key, const V& value) noexcept
+        requires Copy_Constructable<V>
+    {
+        return insert(rpp::move(key), V{value});
+    }
+
+    V& insert(const K& key, V&& value) noexcept
+        requires Copy_Constructable<K>
+    {
+        return insert(K{key}, rpp::move(value));
+    }
+
+    V& insert(K&& key, V&& value) noexcept {
+        u64 hash = hash_of(key);
+        if(Opt<u64> idx = find(key, hash); idx.ok()) {
+            slots_[*idx].destruct();
+            slots_[*idx].construct(rpp::move(key), rpp::move(value));
+            return slots_[*idx]->second;
+        }
+        u64 idx = prepare_insert(hash);
+        slots_[idx].construct(rpp::move(key), rpp::move(value));
+        return slots_[idx]->second;
+    }
+
+    [[nodiscard]] Opt<Ref<V>> try_get(const K& key) noexcept {
+        if(empty()) return {};
+        if(Opt<u64> idx = find(key, hash_of(key)); idx.ok()) {
+            return Opt{Ref{slots_[*idx]->second}};
+        }
+        return {};
+    }
+
+    [[nodiscard]] Opt<Ref<const V>> try_get(const K& key) const noexcept {
+        if(empty()) return {};
+        if(Opt<u64> idx = find(key, hash_of(key)); idx.ok()) {
+            return Opt{Ref<const V>{slots_[*idx]->second}};
+        }
+        return {};
+    }
+
+    [[nodiscard]] bool contains(const K& key) const noexcept {
+        return try_get(key).ok();
+    }
+
+    [[nodiscard]] V& get(const K& key) noexcept {
+        Opt<Ref<V>> value = try_get(key);
+        if(!value.ok()) die("Failed to find key %!", key);
+        return **value;
+    }
+
+    [[nodiscard]] const V& get(const K& key) const noexcept {
+        Opt<Ref<const V>> value = try_get(key);
+        if(!value.ok()) die("Failed to find key %!", key);
+        return **value;
+    }
+
+    [[nodiscard]] V& get_or_insert(const K& key) noexcept
+        requires Copy_Constructable<K> && Default_Constructable<V>
+    {
+        Opt<Ref<V>> entry = try_get(key);
+        if(entry.ok()) {
+            return **entry;
+        }
+        return insert(K{key}, V{});
+    }
+
+    [[nodiscard]] bool try_erase(const K& key) noexcept {
+        if(empty()) return false;
+        Opt<u64> idx = find(key, hash_of(key));
+        if(!idx.ok()) return false;
+        slots_[*idx].destruct();
+        // Other keys may have probed past this slot, so it can't become empty again until the
+        // next rehash.
+        set_ctrl(*idx, DELETED);
+        length_ -= 1;
+        return true;
+    }
+
+    void erase(const K& key) noexcept {
+        if(!try_erase(key)) die("Failed to erase key %!", key);
+    }
+
+    template<bool is_const>
+    struct Iterator {
+        using M = If<is_const, const Swiss_Map, Swiss_Map>;
+
+        Iterator operator++(int) noexcept {
+            Iterator i = *this;
+            count_++;
+            skip();
+            return i;
+        }
+        Iterator operator++() noexcept {
+            count_++;
+            skip();
+            return *this;
+        }
+
+        [[nodiscard]] Pair<const K, V>& operator*() const noexcept
+            requires(!is_const)
+        {
+            return reinterpret_cast<Pair<const K, V>&>(*map_.slots_[count_]);
+        }
+        [[nodiscard]] const Pair<K, V>& operator*() const noexcept {
+            return *map_.slots_[count_];
+        }
+
+        [[nodiscard]] Pair<const K, V>* operator->() const noexcept
+            requires(!is_const)
+        {
+            return reinterpret_cast<Pair<const K, V>*>(&*map_.slots_[count_]);
+        }
+        [[nodiscard]] const Pair<K, V>* operator->() const noexcept {
+            return &*map_.slots_[count_];
+        }
+
+        [[nodiscard]] bool operator==(const Iterator& rhs) const noexcept {
+            return &map_ == &rhs.map_ && count_ == rhs.count_;
+        }
+
+    private:
+        void skip() noexcept {
+            while(count_ < map_.capacity_ && !is_full(map_.ctrl_[count_])) count_++;
+        }
+        Iterator(M& map, u64 count) noexcept : map_(map), count_(count) {
+            skip();
+        }
+        M& map_;
+        u64 count_ = 0;
+
+        friend struct Swiss_Map;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return const_iterator(*this, 0);
+    }
+    [[nodiscard]] const_iterator end() const noexcept {
+        return const_iterator(*this, capacity_);
+    }
+    [[nodiscard]] iterator begin() noexcept {
+        return iterator(*this, 0);
+    }
+    [[nodiscard]] iterator end() noexcept {
+        return iterator(*this, capacity_);
+    }
+
+private:
+    constexpr static u64 GROUP = 16;
+    constexpr static u8 EMPTY = 0x80;
+    constexpr static u8 DELETED = 0xfe;
+
+    [[nodiscard]] static u64 hash_of(const K& key) noexcept {
+        return Hash::Hash<K>::hash(key);
+    }
+    [[nodiscard]] static u64 h1(u64 hash) noexcept {
+        return hash >> 7;
+    }
+    [[nodiscard]] static u8 h2(u64 hash) noexcept {
+        return static_cast<u8>(hash & 0x7f);
+    }
+    [[nodiscard]] static bool is_full(u8 ctrl) noexcept {
+        return (ctrl & 0x80) == 0;
+    }
+    [[nodiscard]] static u64 usable(u64 capacity) noexcept {
+        return capacity - capacity / 8;
+    }
+
+    // The first GROUP control bytes are mirrored past the end, so a group starting anywhere in
+    // the table can be loaded without wrapping.
+    void set_ctrl(u64 idx, u8 ctrl) noexcept {
+        ctrl_[idx] = ctrl;
+        if(idx < GROUP) ctrl_[capacity_ + idx] = ctrl;
+    }
+
+    [[nodiscard]] Opt<u64> find(const K& key, u64 hash) const noexcept {
+        if(!capacity_) return {};
+        u64 mask = capacity_ - 1;
+        u64 pos = h1(hash) & mask;
+        u8 tag = h2(hash);
+        for(u64 step = GROUP;; step += GROUP) {
+            SIMD::U8x16 group = SIMD::U8x16::load(ctrl_ + pos);
+            for(u32 m = SIMD::U8x16::cmpeq_mask(group, tag); m; m &= m - 1) {
+                u64 idx = (pos + Math::cttz(m)) & mask;
+                if(slots_[idx]->first == key) return Opt<u64>{idx};
+            }
+            if(SIMD::U8x16::cmpeq_mask(group, EMPTY)) return {};
+            pos = (pos + step) & mask;
+        }
+    }
+
+    [[nodiscard]] u64 find_free(u64 hash) const noexcept {
+        u64 mask = capacity_ - 1;
+        u64 pos = h1(hash) & mask;
+        for(u64 step = GROUP;; step += GROUP) {
+            u32 m = SIMD::U8x16::high_mask(SIMD::U8x16::load(ctrl_ + pos));
+            if(m) return (pos + Math::cttz(m)) & mask;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    [[nodiscard]] u64 prepare_insert(u64 hash) noexcept {
+        if(growth_left_ == 0) grow();
+        u64 idx = find_free(hash);
+        if(ctrl_[idx] == EMPTY) growth_left_ -= 1;
+        set_ctrl(idx, h2(hash));
+        length_ += 1;
+        return idx;
+    }
+
+    void grow() noexcept {
+        // Mostly tombstones: rehash in place to reclaim them.
+        if(capacity_ && length_ * 2 <= usable(capacity_)) {
+            rehash(capacity_);
+        } else {
+            rehash(capacity_ ? 2 * capacity_ : GROUP);
+        }
+    }
+
+    void rehash(u64 new_capacity) noexcept {
+        u8* old_ctrl = ctrl_;
+        Storage<Entry>* old_slots = slots_;
+        u64 old_capacity = capacity_;
+
+        ctrl_ = reinterpret_cast<u8*>(A::alloc(new_capacity + GROUP));
+        Libc::memset(ctrl_, EMPTY, new_capacity + GROUP);
+        slots_ = reinterpret_cast<Storage<Entry>*>(
+            alloc_aligned<A, alignof(Storage<Entry>)>(new_capacity * sizeof(Storage<Entry>)));
+        capacity_ = new_capacity;
+        growth_left_ = usable(new_capacity) - length_;
+
+        for(u64 i = 0; i < old_capacity; i++) {
+            if(!is_full(old_ctrl[i])) continue;
+            u64 hash = hash_of(old_slots[i]->first);
+            u64 idx = find_free(hash);
+            set_ctrl(idx, h2(hash));
+            slots_[idx].construct(rpp::move(*old_slots[i]));
+            old_slots[i].destruct();
+        }
+
+        A::free(old_ctrl);
+        A::free(old_slots);
+    }
+
+    void destruct_all() noexcept {
+        if constexpr(Must_Destruct<Entry>) {
+            for(u64 i = 0; i < capacity_; i++) {
+                if(is_full(ctrl_[i])) slots_[i].destruct();
+            }
+        }
+    }
+
+    u8* ctrl_ = null;
+    Storage<Entry>* slots_ = null;
+    u64 capacity_ = 0;
+    u64 length_ = 0;
+    u64 growth_left_ = 0;
+};
+
+} // namespace rpp
@@ -0,0 +1,77 @@
+#pragma once
+
+#ifndef RPP_BASE
+#error "Include base.h instead."
+#endif
+
+namespace rpp {
+
+// Interned string. Equal text always interns to the same 32-bit id, so symbols compare and hash
+// as integers. The table is global: lookups are lock-free, and only inserting new text takes a
+// lock. Interned text lives until Profile::finalize. The default symbol is the empty string.
+struct Symbol {
+
+    constexpr Symbol() noexcept = default;
+
+    [[nodiscard]] static Symbol intern(String_View text) noexcept;
+    // Looks up text without interning it.
+    [[nodiscard]] static Opt<Symbol> find(String_View text) noexcept;
+
+    [[nodiscard]] String_View view() const noexcept;
+    // Equal to rpp::hash(view()), computed once when the text was interned.
+    [[nodiscard]] u64 hash() const noexcept;
+
+    [[nodiscard]] constexpr u32 id() const noexcept {
+        return id_;
+    }
+    [[nodiscard]] constexpr bool empty() const noexcept {
+        return id_ == 0;
+    }
+
+    [[nodiscard]] constexpr bool operator==(const Symbol& other) const noexcept {
+        return id_ == other.id_;
+    }
+
+private:
+    constexpr explicit Symbol(u32 id) noexcept : id_{id} {
+    }
+
+    u32 id_ = 0;
+
+    friend struct Reflect::Refl<Symbol>;
+};
+
+static_assert(sizeof(Symbol) == 4);
+
+namespace Hash {
+
+template<>
+struct Hash<Symbol> {
+    [[nodiscard]] static u64 hash(Symbol symbol) noexcept {
+        return symbol.hash();
+    }
+};
+
+} // namespace Hash
+
+namespace Format {
+
+template<>
+struct Measure<Symbol> {
+    [[nodiscard]] static u64 measure(Symbol symbol) noexcept {
+        return symbol.view().length();
+    }
+};
+
+template<Allocator O>
+struct Write<O, Symbol> {
+    [[nodiscard]] static u64 write(String<O>& output, u64 idx, Symbol symbol) noexcept {
+        return output.write(idx, symbol.view());
+    }
+};
+
+} // namespace Format
+
+RPP_RECORD(Symbol, RPP_FIELD(id_));
+
+} // namespace rpp
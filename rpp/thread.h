@@ -85,9 +85,22 @@ private:
     friend struct Reflect::Refl<Promise<void>>;
 };
 
-template<typename T, Scalar_Allocator A = Alloc>
+// Futures come from pooled blocks, so spawning does not hit the system allocator for them.
+template<typename T, Scalar_Allocator A = Mpool_Classes<>>
 using Future = Arc<Promise<T>, A>;
 
+// A logical processor. Processors with the same core are SMT siblings of one physical core.
+struct Processor {
+    // As taken by set_affinity.
+    u64 index = 0;
+    u64 core = 0;
+    u64 node = 0;
+};
+
+// Lists every logical processor by index. Where the OS does not report placement, each processor
+// is its own core on node zero.
+[[nodiscard]] Vec<Processor, Alloc> topology() noexcept;
+
 template<Allocator A = Alloc>
 struct Thread {
 
@@ -95,7 +108,7 @@ struct Thread {
 
     template<Invocable F>
     explicit Thread(F&& f) noexcept {
-        F* data = reinterpret_cast<F*>(A::alloc(sizeof(F)));
+        F* data = reinterpret_cast<F*>(alloc_aligned<A, alignof(F)>(sizeof(F)));
         new(data) F{rpp::forward<F>(f)};
         thread = sys_start(&invoke<F>, data);
     }
@@ -147,27 +160,115 @@ private:
     friend struct Reflect::Refl<Thread<A>>;
 };
 
-template<Allocator A = Alloc, typename F, typename... Args>
+// How spawn runs a function. Dedicated starts and detaches an OS thread per call. Pooled hands
+// it to shared worker threads that are started on demand and then reused, so short tasks do not
+// pay for thread creation. Thread-local state, like log rings, outlives each task on a worker.
+enum class Spawn : u8 { dedicated, pooled };
+
+namespace detail {
+
+// Workers behind Spawn::pooled. A job is only queued when an idle worker is left to take it;
+// otherwise another worker starts, so jobs that wait on each other can not starve the pool.
+// Idle workers sleep until Profile::finalize stops and joins them.
+struct Workers {
+    static void submit(Function<void()>&& job) noexcept {
+        Lock lock(mutex);
+        if(!state) {
+            state = new(Alloc::alloc(sizeof(State))) State{};
+            Profile::finalizer([]() { stop(); });
+        }
+        state->jobs.push(rpp::move(job));
+        if(state->jobs.length() > state->idle) {
+            state->threads.push(Thread<Alloc>{[pool = state]() { work(*pool); }});
+        } else {
+            state->cond.signal();
+        }
+    }
+
+    static void stop() noexcept {
+        State* stopping = null;
+        {
+            Lock lock(mutex);
+            stopping = state;
+            state = null;
+            if(!stopping) return;
+            stopping->stopped = true;
+            stopping->cond.broadcast();
+        }
+        // Joining also waits out each worker's thread-local destructors.
+        stopping->threads.clear();
+        stopping->~State();
+        Alloc::free(stopping);
+    }
+
+private:
+    struct State {
+        Cond cond;
+        Queue<Function<void()>, Alloc> jobs;
+        Vec<Thread<Alloc>, Alloc> threads;
+        u64 idle = 0;
+        bool stopped = false;
+    };
+
+    static void work(State& pool) noexcept {
+        mutex.lock();
+        for(;;) {
+            while(pool.jobs.empty() && !pool.stopped) {
+                pool.idle++;
+                pool.cond.wait(mutex);
+                pool.idle--;
+            }
+            if(pool.jobs.empty()) break;
+            {
+                Function<void()> job = rpp::move(pool.jobs.front());
+                pool.jobs.pop();
+                mutex.unlock();
+                job();
+            }
+            mutex.lock();
+        }
+        mutex.unlock();
+    }
+
+    static inline Mutex mutex;
+    static inline State* state = null;
+};
+
+} // namespace detail
+
+template<Scalar_Allocator A = Mpool_Classes<>, typename F, typename... Args>
     requires Invocable<F, Args...>
-[[nodiscard]] auto spawn(F&& f, Args&&... args) noexcept -> Future<Invoke_Result<F, Args...>, A> {
+[[nodiscard]] auto spawn(Spawn mode, F&& f, Args&&... args) noexcept
+    -> Future<Invoke_Result<F, Args...>, A> {
 
     using Result = Invoke_Result<F, Args...>;
     auto future = Future<Result, A>::make();
 
-    Thread thread{[future = future.dup(), f = rpp::forward<F>(f),
-                   ... args = rpp::forward<Args>(args)]() mutable {
+    auto run = [future = future.dup(), f = rpp::forward<F>(f),
+                ... args = rpp::forward<Args>(args)]() mutable {
         if constexpr(Same<Result, void>) {
             f(rpp::forward<Args>(args)...);
             future->fill();
         } else {
             future->fill(f(rpp::forward<Args>(args)...));
         }
-    }};
-    thread.detach();
+    };
+    if(mode == Spawn::pooled) {
+        detail::Workers::submit(Function<void()>{rpp::move(run)});
+    } else {
+        Thread thread{rpp::move(run)};
+        thread.detach();
+    }
 
     return future;
 }
 
+template<Scalar_Allocator A = Mpool_Classes<>, typename F, typename... Args>
+    requires Invocable<F, Args...>
+[[nodiscard]] auto spawn(F&& f, Args&&... args) noexcept -> Future<Invoke_Result<F, Args...>, A> {
+    return spawn<A>(Spawn::dedicated, rpp::forward<F>(f), rpp::forward<Args>(args)...);
+}
+
 } // namespace Thread
 
 template<typename T>
@@ -179,4 +280,9 @@ RPP_NAMED_TEMPLATE_RECORD(::rpp::Thread::Promise, "Promise", void, RPP_FIELD(fla
 template<Allocator A>
 RPP_NAMED_TEMPLATE_RECORD(::rpp::Thread::Thread, "Thread", A, RPP_FIELD(thread));
 
+RPP_NAMED_RECORD(Thread::Processor, "Processor", RPP_FIELD(index), RPP_FIELD(core),
+                 RPP_FIELD(node));
+
+RPP_NAMED_ENUM(Thread::Spawn, "Spawn", dedicated, RPP_CASE(dedicated), RPP_CASE(pooled));
+
 } // namespace rpp
@@ -25,10 +25,17 @@ void pause() noexcept;
 [[nodiscard]] u64 perf_frequency() noexcept;
 [[nodiscard]] u64 hardware_threads() noexcept;
 
+// Sleeps while *address equals expected, or until woken. May return spuriously.
+void sys_wait(u32* address, u32 expected) noexcept;
+// Wakes up to count threads sleeping on address.
+void sys_wake(u32* address, u32 count) noexcept;
+
+// Spin-then-sleep lock in one 32-bit word: 0 when unlocked, 1 when locked, and 2 when locked
+// with possible sleepers, so unlocking only enters the kernel if someone may be waiting.
 struct Mutex {
 
-    Mutex() noexcept;
-    ~Mutex() noexcept;
+    constexpr Mutex() noexcept = default;
+    ~Mutex() noexcept = default;
 
     Mutex(const Mutex&) noexcept = delete;
     Mutex(Mutex&&) noexcept = delete;
@@ -41,11 +48,9 @@ struct Mutex {
     [[nodiscard]] bool try_lock() noexcept;
 
 private:
-#ifdef RPP_OS_WINDOWS
-    void* lock_ = null;
-#else
-    pthread_mutex_t lock_ = PTHREAD_MUTEX_INITIALIZER;
-#endif
+    void lock_contended() noexcept;
+
+    u32 state_ = 0;
 
     friend struct Cond;
     friend struct Reflect::Refl<Mutex>;
@@ -72,40 +77,281 @@ private:
     friend struct Reflect::Refl<Lock>;
 };
 
-struct Atomic {
+enum class Order : u8 { relaxed, acquire, release, acq_rel, seq_cst };
+
+template<typename T>
+concept Atomic_Value = Trivially_Copyable<T> && (sizeof(T) == 1 || sizeof(T) == 2 ||
+                                                 sizeof(T) == 4 || sizeof(T) == 8);
+
+namespace detail {
+
+#ifdef RPP_COMPILER_MSVC
+
+// MSVC has no generic atomic builtins, so values are bit cast to the interlocked word of the same
+// size. Read-modify-write operations are always full barriers.
+
+template<u64 N>
+struct Word;
+template<>
+struct Word<1> {
+    using Type = char;
+};
+template<>
+struct Word<2> {
+    using Type = short;
+};
+template<>
+struct Word<4> {
+    using Type = long;
+};
+template<>
+struct Word<8> {
+    using Type = __int64;
+};
+
+#define RPP_INTERLOCKED(RET, OP, PTR, ...)                                                         \
+    if constexpr(sizeof(T) == 1)                                                                   \
+        RET = OP##8(reinterpret_cast<volatile char*>(PTR), __VA_ARGS__);                           \
+    else if constexpr(sizeof(T) == 2)                                                              \
+        RET = OP##16(reinterpret_cast<volatile short*>(PTR), __VA_ARGS__);                         \
+    else if constexpr(sizeof(T) == 4)                                                              \
+        RET = OP(reinterpret_cast<volatile long*>(PTR), __VA_ARGS__);                              \
+    else                                                                                           \
+        RET = OP##64(reinterpret_cast<volatile __int64*>(PTR), __VA_ARGS__);
+
+RPP_FORCE_INLINE void fence() noexcept {
+#ifdef RPP_ARCH_ARM64
+    __dmb(_ARM64_BARRIER_ISH);
+#else
+    _ReadWriteBarrier();
+#endif
+}
+
+template<typename T>
+[[nodiscard]] RPP_FORCE_INLINE T atomic_load(const T* src, Order order) noexcept {
+    typename Word<sizeof(T)>::Type ret;
+    if constexpr(sizeof(T) == 1)
+        ret = __iso_volatile_load8(reinterpret_cast<const volatile __int8*>(src));
+    else if constexpr(sizeof(T) == 2)
+        ret = __iso_volatile_load16(reinterpret_cast<const volatile __int16*>(src));
+    else if constexpr(sizeof(T) == 4)
+        ret = __iso_volatile_load32(reinterpret_cast<const volatile __int32*>(src));
+    else
+        ret = __iso_volatile_load64(reinterpret_cast<const volatile __int64*>(src));
+    if(order != Order::relaxed) fence();
+    return __builtin_bit_cast(T, ret);
+}
+
+template<typename T>
+[[nodiscard]] RPP_FORCE_INLINE T atomic_exchange(T* dst, T value, Order) noexcept {
+    using W = typename Word<sizeof(T)>::Type;
+    W ret;
+    RPP_INTERLOCKED(ret, _InterlockedExchange, dst, __builtin_bit_cast(W, value));
+    return __builtin_bit_cast(T, ret);
+}
+
+template<typename T>
+RPP_FORCE_INLINE void atomic_store(T* dst, T value, Order order) noexcept {
+    using W = typename Word<sizeof(T)>::Type;
+    if(order == Order::seq_cst) {
+        (void)atomic_exchange(dst, value, order);
+        return;
+    }
+    if(order != Order::relaxed) fence();
+    *reinterpret_cast<volatile W*>(dst) = __builtin_bit_cast(W, value);
+}
+
+template<typename T>
+[[nodiscard]] RPP_FORCE_INLINE T atomic_compare_and_swap(T* dst, T compare_with, T set_to,
+                                                         Order) noexcept {
+    using W = typename Word<sizeof(T)>::Type;
+    W ret;
+    RPP_INTERLOCKED(ret, _InterlockedCompareExchange, dst, __builtin_bit_cast(W, set_to),
+                    __builtin_bit_cast(W, compare_with));
+    return __builtin_bit_cast(T, ret);
+}
+
+#define RPP_ATOMIC_FETCH(NAME, OP)                                                                 \
+    template<typename T>                                                                           \
+    RPP_FORCE_INLINE T NAME(T* dst, T value, Order) noexcept {                                     \
+        using W = typename Word<sizeof(T)>::Type;                                                  \
+        W ret;                                                                                     \
+        RPP_INTERLOCKED(ret, OP, dst, static_cast<W>(value));                                      \
+        return static_cast<T>(ret);                                                                \
+    }
+
+RPP_ATOMIC_FETCH(atomic_fetch_add, _InterlockedExchangeAdd)
+RPP_ATOMIC_FETCH(atomic_fetch_or, _InterlockedOr)
+RPP_ATOMIC_FETCH(atomic_fetch_and, _InterlockedAnd)
+RPP_ATOMIC_FETCH(atomic_fetch_xor, _InterlockedXor)
+
+#undef RPP_ATOMIC_FETCH
+#undef RPP_INTERLOCKED
 
-    Atomic() noexcept = default;
-    ~Atomic() noexcept = default;
+#else
 
-    explicit Atomic(i64 value) noexcept : value_(value) {
+[[nodiscard]] constexpr i32 builtin_order(Order order) noexcept {
+    switch(order) {
+    case Order::relaxed: return __ATOMIC_RELAXED;
+    case Order::acquire: return __ATOMIC_ACQUIRE;
+    case Order::release: return __ATOMIC_RELEASE;
+    case Order::acq_rel: return __ATOMIC_ACQ_REL;
+    default: return __ATOMIC_SEQ_CST;
     }
+}
+
+// A failed compare-and-swap only loads, so it may not release.
+[[nodiscard]] constexpr i32 builtin_failure_order(Order order) noexcept {
+    if(order == Order::release) return __ATOMIC_RELAXED;
+    if(order == Order::acq_rel) return __ATOMIC_ACQUIRE;
+    return builtin_order(order);
+}
+
+template<typename T>
+[[nodiscard]] RPP_FORCE_INLINE T atomic_load(const T* src, Order order) noexcept {
+    T ret;
+    __atomic_load(src, &ret, builtin_order(order));
+    return ret;
+}
+
+template<typename T>
+RPP_FORCE_INLINE void atomic_store(T* dst, T value, Order order) noexcept {
+    __atomic_store(dst, &value, builtin_order(order));
+}
+
+template<typename T>
+[[nodiscard]] RPP_FORCE_INLINE T atomic_exchange(T* dst, T value, Order order) noexcept {
+    T ret;
+    __atomic_exchange(dst, &value, &ret, builtin_order(order));
+    return ret;
+}
+
+template<typename T>
+[[nodiscard]] RPP_FORCE_INLINE T atomic_compare_and_swap(T* dst, T compare_with, T set_to,
+                                                         Order order) noexcept {
+    __atomic_compare_exchange(dst, &compare_with, &set_to, false, builtin_order(order),
+                              builtin_failure_order(order));
+    return compare_with;
+}
+
+template<typename T>
+RPP_FORCE_INLINE T atomic_fetch_add(T* dst, T value, Order order) noexcept {
+    return __atomic_fetch_add(dst, value, builtin_order(order));
+}
+template<typename T>
+RPP_FORCE_INLINE T atomic_fetch_or(T* dst, T value, Order order) noexcept {
+    return __atomic_fetch_or(dst, value, builtin_order(order));
+}
+template<typename T>
+RPP_FORCE_INLINE T atomic_fetch_and(T* dst, T value, Order order) noexcept {
+    return __atomic_fetch_and(dst, value, builtin_order(order));
+}
+template<typename T>
+RPP_FORCE_INLINE T atomic_fetch_xor(T* dst, T value, Order order) noexcept {
+    return __atomic_fetch_xor(dst, value, builtin_order(order));
+}
+
+#endif
+
+} // namespace detail
 
-    Atomic(const Atomic&) noexcept = default;
-    Atomic(Atomic&&) noexcept = default;
-    Atomic& operator=(const Atomic&) noexcept = default;
-    Atomic& operator=(Atomic&&) noexcept = default;
+// Lock-free atomic integer, pointer, or small trivially copyable value. Operations default to
+// sequential consistency; pass a weaker order where the surrounding protocol allows it.
+template<Atomic_Value T>
+struct Atomic_Of {
+
+    constexpr Atomic_Of() noexcept = default;
+    ~Atomic_Of() noexcept = default;
+
+    constexpr explicit Atomic_Of(T value) noexcept : value_(value) {
+    }
 
-    [[nodiscard]] i64 load() const noexcept;
-    i64 incr() noexcept;
-    i64 decr() noexcept;
-    i64 exchange(i64 value) noexcept;
-    [[nodiscard]] i64 compare_and_swap(i64 compare_with, i64 set_to) noexcept;
+    Atomic_Of(const Atomic_Of&) noexcept = default;
+    Atomic_Of(Atomic_Of&&) noexcept = default;
+    Atomic_Of& operator=(const Atomic_Of&) noexcept = default;
+    Atomic_Of& operator=(Atomic_Of&&) noexcept = default;
+
+    [[nodiscard]] RPP_FORCE_INLINE T load(Order order = Order::seq_cst) const noexcept {
+        return detail::atomic_load(&value_, order);
+    }
+    RPP_FORCE_INLINE void store(T value, Order order = Order::seq_cst) noexcept {
+        detail::atomic_store(&value_, value, order);
+    }
+    RPP_FORCE_INLINE T exchange(T value, Order order = Order::seq_cst) noexcept {
+        return detail::atomic_exchange(&value_, value, order);
+    }
+    // Returns the previous value, which equals compare_with if and only if the swap happened.
+    [[nodiscard]] RPP_FORCE_INLINE T compare_and_swap(T compare_with, T set_to,
+                                                      Order order = Order::seq_cst) noexcept {
+        return detail::atomic_compare_and_swap(&value_, compare_with, set_to, order);
+    }
+
+    // The fetch operations return the previous value.
+    RPP_FORCE_INLINE T fetch_add(T value, Order order = Order::seq_cst) noexcept
+        requires Int<T>
+    {
+        return detail::atomic_fetch_add(&value_, value, order);
+    }
+    RPP_FORCE_INLINE T fetch_sub(T value, Order order = Order::seq_cst) noexcept
+        requires Int<T>
+    {
+        return detail::atomic_fetch_add(&value_, static_cast<T>(T{0} - value), order);
+    }
+    RPP_FORCE_INLINE T fetch_or(T value, Order order = Order::seq_cst) noexcept
+        requires Int<T>
+    {
+        return detail::atomic_fetch_or(&value_, value, order);
+    }
+    RPP_FORCE_INLINE T fetch_and(T value, Order order = Order::seq_cst) noexcept
+        requires Int<T>
+    {
+        return detail::atomic_fetch_and(&value_, value, order);
+    }
+    RPP_FORCE_INLINE T fetch_xor(T value, Order order = Order::seq_cst) noexcept
+        requires Int<T>
+    {
+        return detail::atomic_fetch_xor(&value_, value, order);
+    }
+
+    // incr and decr return the new value.
+    RPP_FORCE_INLINE T incr(Order order = Order::seq_cst) noexcept
+        requires Int<T>
+    {
+        return static_cast<T>(fetch_add(T{1}, order) + T{1});
+    }
+    RPP_FORCE_INLINE T decr(Order order = Order::seq_cst) noexcept
+        requires Int<T>
+    {
+        return static_cast<T>(fetch_sub(T{1}, order) - T{1});
+    }
 
     template<Int I>
-    [[nodiscard]] I load() const noexcept {
-        return static_cast<I>(load());
+    [[nodiscard]] I load(Order order = Order::seq_cst) const noexcept
+        requires Int<T>
+    {
+        return static_cast<I>(load(order));
     }
 
 private:
-    i64 value_ = 0;
+    alignas(sizeof(T)) T value_{};
 
-    friend struct Reflect::Refl<Atomic>;
+    friend struct Reflect::Refl<Atomic_Of>;
 };
 
+using Atomic = Atomic_Of<i64>;
+
+// Atomic alone on its cache line, for counters that different threads hammer.
+template<Atomic_Value T>
+struct alignas(64) Padded_Atomic : Atomic_Of<T> {
+    using Atomic_Of<T>::Atomic_Of;
+};
+
+// Sequence counter that waiters sleep on; signals bump it so a waiter that releases the mutex
+// before a signal still sees the change.
 struct Cond {
 
-    Cond() noexcept;
-    ~Cond() noexcept;
+    constexpr Cond() noexcept = default;
+    ~Cond() noexcept = default;
 
     Cond(Cond&&) noexcept = delete;
     Cond(const Cond&) noexcept = delete;
@@ -118,15 +364,145 @@ struct Cond {
     void wait(Mutex& mut) noexcept;
 
 private:
-#ifdef RPP_OS_WINDOWS
-    void* cond_ = null;
-#else
-    pthread_cond_t cond_ = PTHREAD_COND_INITIALIZER;
-#endif
+    u32 sequence_ = 0;
 
     friend struct Reflect::Refl<Cond>;
 };
 
+// Writer-preferring reader-writer lock. Writers queue on a mutex, then announce themselves in the
+// state word so new readers wait while existing ones drain.
+struct RwLock {
+
+    constexpr RwLock() noexcept = default;
+    ~RwLock() noexcept = default;
+
+    RwLock(const RwLock&) noexcept = delete;
+    RwLock(RwLock&&) noexcept = delete;
+
+    RwLock& operator=(const RwLock&) noexcept = delete;
+    RwLock& operator=(RwLock&&) noexcept = delete;
+
+    void lock() noexcept;
+    void unlock() noexcept;
+    [[nodiscard]] bool try_lock() noexcept;
+
+    void lock_shared() noexcept;
+    void unlock_shared() noexcept;
+    [[nodiscard]] bool try_lock_shared() noexcept;
+
+private:
+    // Reader count in the low bits.
+    constexpr static u32 WRITER = 1u << 31;
+    constexpr static u32 SLEEPERS = 1u << 30;
+    constexpr static u32 READERS = SLEEPERS - 1;
+
+    u32 state_ = 0;
+    Mutex writers;
+};
+
+struct Shared_Lock {
+
+    Shared_Lock(RwLock& lock) noexcept : lock_(lock) {
+        lock_->lock_shared();
+    }
+    ~Shared_Lock() noexcept {
+        if(lock_.ok()) lock_->unlock_shared();
+    }
+
+    Shared_Lock(const Shared_Lock&) noexcept = delete;
+    Shared_Lock& operator=(const Shared_Lock&) noexcept = delete;
+
+    Shared_Lock(Shared_Lock&& src) noexcept = default;
+    Shared_Lock& operator=(Shared_Lock&& src) noexcept = default;
+
+private:
+    Ref<RwLock> lock_;
+};
+
+struct Exclusive_Lock {
+
+    Exclusive_Lock(RwLock& lock) noexcept : lock_(lock) {
+        lock_->lock();
+    }
+    ~Exclusive_Lock() noexcept {
+        if(lock_.ok()) lock_->unlock();
+    }
+
+    Exclusive_Lock(const Exclusive_Lock&) noexcept = delete;
+    Exclusive_Lock& operator=(const Exclusive_Lock&) noexcept = delete;
+
+    Exclusive_Lock(Exclusive_Lock&& src) noexcept = default;
+    Exclusive_Lock& operator=(Exclusive_Lock&& src) noexcept = default;
+
+private:
+    Ref<RwLock> lock_;
+};
+
+// Write counter behind Seqlock, odd while a write is in progress. Readers retry if the count
+// moved while they copied.
+struct Sequence {
+
+    constexpr Sequence() noexcept = default;
+    ~Sequence() noexcept = default;
+
+    Sequence(const Sequence&) noexcept = delete;
+    Sequence(Sequence&&) noexcept = delete;
+
+    Sequence& operator=(const Sequence&) noexcept = delete;
+    Sequence& operator=(Sequence&&) noexcept = delete;
+
+    // Waits out any write in progress. Reads after this call see at least that write.
+    [[nodiscard]] u32 read_begin() const noexcept;
+    // Whether reads since read_begin returned begin may have raced with a write.
+    [[nodiscard]] bool read_retry(u32 begin) const noexcept;
+
+    void write_begin() noexcept;
+    void write_end() noexcept;
+
+private:
+    u32 value_ = 0;
+};
+
+// Publishes small snapshots to any number of readers without making them write shared memory:
+// a read copies the value and retries if a writer got in the way, so readers never block writers
+// or each other.
+template<typename T>
+    requires Trivially_Copyable<T> && Default_Constructable<T>
+struct Seqlock {
+
+    Seqlock() noexcept = default;
+    explicit Seqlock(const T& value) noexcept : value_{value} {
+    }
+    ~Seqlock() noexcept = default;
+
+    Seqlock(const Seqlock&) noexcept = delete;
+    Seqlock(Seqlock&&) noexcept = delete;
+
+    Seqlock& operator=(const Seqlock&) noexcept = delete;
+    Seqlock& operator=(Seqlock&&) noexcept = delete;
+
+    [[nodiscard]] T read() const noexcept {
+        T ret;
+        for(;;) {
+            u32 begin = sequence.read_begin();
+            Libc::memcpy(&ret, &value_, sizeof(T));
+            if(!sequence.read_retry(begin)) return ret;
+        }
+    }
+
+    void write(const T& value) noexcept {
+        Lock lock(writer);
+        sequence.write_begin();
+        Libc::memcpy(&value_, &value, sizeof(T));
+        sequence.write_end();
+    }
+
+private:
+    Mutex writer;
+    Sequence sequence;
+    T value_{};
+};
+
 struct Flag {
     Flag() noexcept = default;
     ~Flag() noexcept = default;
@@ -153,9 +529,34 @@ private:
 #endif
 };
 
+// A reusable 32-bit word that threads may sleep on until it changes: a futex on Linux,
+// WaitOnAddress on Windows, and ulock on macOS.
+struct Futex {
+    Futex() noexcept = default;
+    ~Futex() noexcept = default;
+
+    Futex(const Futex&) noexcept = delete;
+    Futex(Futex&&) noexcept = delete;
+
+    Futex& operator=(const Futex&) noexcept = delete;
+    Futex& operator=(Futex&&) noexcept = delete;
+
+    [[nodiscard]] u32 load() const noexcept;
+
+    // Sleeps while the value is still expected. May return spuriously.
+    void wait(u32 expected) noexcept;
+
+    // Increments the value and wakes up to count sleeping threads.
+    void incr_and_wake(u32 count) noexcept;
+
+private:
+    u32 value_ = 0;
+};
+
 } // namespace Thread
 
-RPP_NAMED_RECORD(Thread::Atomic, "Atomic", RPP_FIELD(value_));
+template<typename T>
+RPP_NAMED_TEMPLATE_RECORD(::rpp::Thread::Atomic_Of, "Atomic", T, RPP_FIELD(value_));
 
 RPP_NAMED_ENUM(Thread::Priority, "Priority", normal, RPP_CASE(low), RPP_CASE(normal),
                RPP_CASE(high), RPP_CASE(critical));
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "base.h"
+
+namespace rpp::Async {
+
+// Hierarchical timer wheel over millisecond ticks. Each level has 64 slots, and each slot spans
+// 64 slots of the level below it, so four levels cover about four and a half hours with O(1)
+// insertion; timers further out wait in an overflow list. A timer lives at the level of the
+// highest base-64 digit in which its deadline differs from the current tick and is cascaded one
+// level down each time the wheel reaches its slot.
+template<Movable T, Allocator A = Mdefault>
+struct Timer_Wheel {
+
+    constexpr static u64 NEVER = static_cast<u64>(-1);
+
+    Timer_Wheel() noexcept = default;
+    ~Timer_Wheel() noexcept = default;
+
+    Timer_Wheel(const Timer_Wheel&) noexcept = delete;
+    Timer_Wheel& operator=(const Timer_Wheel&) noexcept = delete;
+
+    Timer_Wheel(Timer_Wheel&&) noexcept = default;
+    Timer_Wheel& operator=(Timer_Wheel&&) noexcept = default;
+
+    [[nodiscard]] u64 length() const noexcept {
+        return length_;
+    }
+    [[nodiscard]] bool empty() const noexcept {
+        return length_ == 0;
+    }
+    [[nodiscard]] u64 now() const noexcept {
+        return current;
+    }
+
+    // Timers due at or before the current tick fire on the next advance. Advance an empty wheel
+    // to the present before inserting, since cascading starts from the current tick.
+    void insert(u64 deadline, T&& value) noexcept {
+        place(Math::max(deadline, current + 1), rpp::move(value));
+        length_++;
+    }
+
+    // Moves the wheel forward to tick now, pushing the value of every expired timer to expired.
+    template<typename F>
+    void advance(u64 now, F&& expired) noexcept {
+        if(length_ == 0) {
+            current = Math::max(current, now);
+            return;
+        }
+        while(current < now) {
+            // Nothing can expire before the next cascade, so skip ahead to it.
+            if(occupied[0] == 0) {
+                u64 boundary = current | (SLOTS - 1);
+                if(boundary >= now) {
+                    current = now;
+                    return;
+                }
+                current = boundary;
+            }
+            current++;
+            cascade();
+
+            u64 slot = current & (SLOTS - 1);
+            if(!(occupied[0] & (u64{1} << slot))) continue;
+
+            Vec<Timer, A>& due = slots[0][slot];
+            occupied[0] &= ~(u64{1} << slot);
+            for(Timer& timer : due) {
+                length_--;
+                expired(rpp::move(timer.value));
+            }
+            due.clear();
+        }
+    }
+
+    // The next tick at which advance has work to do: either a level 0 expiry or the cascade of
+    // the nearest occupied higher slot, after which callers should ask again. Every timer at a
+    // level is later in that level's digit than the current tick, so the first occupied slot
+    // after the current digit is the nearest.
+    [[nodiscard]] u64 next_deadline() const noexcept {
+        if(length_ == 0) return NEVER;
+
+        for(u64 level = 0; level < LEVELS; level++) {
+            u64 shift = level * BITS;
+            u64 digit = (current >> shift) & (SLOTS - 1);
+            u64 later = digit == SLOTS - 1 ? 0 : occupied[level] & ~((u64{2} << digit) - 1);
+            if(later) {
+                u64 span = u64{1} << (shift + BITS);
+                u64 slot = Math::cttz(later);
+                return (current & ~(span - 1)) | (slot << shift);
+            }
+        }
+        u64 span = u64{1} << (LEVELS * BITS);
+        return (current | (span - 1)) + 1;
+    }
+
+private:
+    constexpr static u64 BITS = 6;
+    constexpr static u64 SLOTS = u64{1} << BITS;
+    constexpr static u64 LEVELS = 4;
+
+    struct Timer {
+        u64 deadline;
+        T value;
+    };
+
+    void place(u64 deadline, T&& value) noexcept {
+        u64 diff = deadline ^ current;
+        u64 level = diff == 0 ? 0 : Math::log2(diff) / BITS;
+        if(level >= LEVELS) {
+            overflow.push(Timer{deadline, rpp::move(value)});
+            return;
+        }
+        u64 slot = (deadline >> (level * BITS)) & (SLOTS - 1);
+        slots[level][slot].push(Timer{deadline, rpp::move(value)});
+        occupied[level] |= u64{1} << slot;
+    }
+
+    // On reaching a slot boundary, redistribute the timers of the slots that begin here, from the
+    // highest level down so each level's timers can land in the slot cascaded next.
+    void cascade() noexcept {
+        if(current & (SLOTS - 1)) return;
+
+        u64 top = 1;
+        while(top < LEVELS && ((current >> (top * BITS)) & (SLOTS - 1)) == 0) top++;
+
+        if(top == LEVELS) {
+            Vec<Timer, A> far = rpp::move(overflow);
+            for(Timer& timer : far) place(timer.deadline, rpp::move(timer.value));
+            top = LEVELS - 1;
+        }
+
+        for(u64 level = top; level >= 1; level--) {
+            u64 slot = (current >> (level * BITS)) & (SLOTS - 1);
+            if(!(occupied[level] & (u64{1} << slot))) continue;
+
+            // Cascaded timers always land on a lower level, so the slot keeps its capacity.
+            Vec<Timer, A>& timers = slots[level][slot];
+            occupied[level] &= ~(u64{1} << slot);
+            for(Timer& timer : timers) place(timer.deadline, rpp::move(timer.value));
+            timers.clear();
+        }
+    }
+
+    Vec<Timer, A> slots[LEVELS][SLOTS];
+    Vec<Timer, A> overflow;
+    u64 occupied[LEVELS] = {};
+    u64 current = 0;
+    u64 length_ = 0;
+};
+
+} // namespace rpp::Async
@@ -249,6 +249,11 @@ struct Decay<T&&> {
     using type = typename Decay<T>::type;
 };
 
+template<typename T>
+struct Identity {
+    using type = T;
+};
+
 template<typename T>
 constexpr bool True = true;
 
@@ -548,6 +553,10 @@ using Index_Sequence_For = Make_Index_Sequence<sizeof...(Ts)>;
 template<typename T>
 using Decay = typename detail::Decay<T>::type;
 
+// Blocks template argument deduction through a parameter.
+template<typename T>
+using Identity = typename detail::Identity<T>::type;
+
 template<bool b, typename T, typename F>
 using If = typename detail::If<b, T, F>::type;
 
@@ -617,4 +626,17 @@ constexpr void swap(T& a, T& b) noexcept {
     return __builtin_is_constant_evaluated();
 }
 
+// Hints that the cache line holding address will be read soon.
+RPP_FORCE_INLINE void prefetch(const void* address) noexcept {
+#ifdef RPP_COMPILER_MSVC
+#ifdef RPP_ARCH_X64
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    __prefetch(address);
+#endif
+#else
+    __builtin_prefetch(address);
+#endif
+}
+
 } // namespace rpp
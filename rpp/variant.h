@@ -28,9 +28,12 @@ struct Named {
 };
 
 template<typename... Ts>
-    requires(sizeof...(Ts) > 0 && sizeof...(Ts) <= 255 && Distinct<Ts...>)
+    requires(sizeof...(Ts) > 0 && sizeof...(Ts) < 65535 && Distinct<Ts...>)
 struct Variant {
 private:
+    // The index is as small as the alternative count allows: one byte below 255 alternatives.
+    using Index = If<(sizeof...(Ts) < 255), u8, u16>;
+
     template<typename T>
     using Lvalue_Ref = T&;
     template<typename T>
@@ -117,7 +120,7 @@ public:
         return Accessors<Const_Lvalue_Ref, const u8>::apply(rpp::forward<F>(f), data_, index_);
     }
 
-    [[nodiscard]] u8 index() const noexcept {
+    [[nodiscard]] Index index() const noexcept {
         assert(index_ != INVALID);
         return index_;
     }
@@ -125,13 +128,13 @@ public:
 private:
     Variant() = default;
 
-    constexpr static u8 INVALID = 255;
+    constexpr static Index INVALID = Limits<Index>::max();
 
     template<typename V>
         requires One_Is<V, Ts...>
     void construct(V&& value) noexcept {
         static_assert(alignof(Variant<Ts...>) == align);
-        static_assert(sizeof(Variant<Ts...>) == Math::align(size + 1, align));
+        static_assert(sizeof(Variant<Ts...>) == Math::align(size + sizeof(Index), align));
         new(data_) V{rpp::forward<V>(value)};
         index_ = Index_Of<V, Ts...>;
     }
@@ -154,14 +157,15 @@ private:
     constexpr static u64 align = Math::max({alignof(Ts)...});
 
     alignas(align) u8 data_[size] = {};
-    u8 index_ = INVALID;
+    Index index_ = INVALID;
 
     template<template<typename> typename Ref, typename Data>
     struct Accessors {
         constexpr static u64 N = sizeof...(Ts);
 
-        // For variants with up to 8 cases, we branch on the index.
-        // Larger variants will use a table of function pointers.
+        // For variants with up to 8 cases, we branch on the index. Up to 256 cases, we switch
+        // over every index so the compiler emits a jump table with the handlers inlined. Larger
+        // variants use a table of function pointers.
 
 #define INDEX(n)                                                                                   \
     if constexpr(N > n)                                                                            \
@@ -169,7 +173,7 @@ private:
 
         template<typename F>
             requires(N <= 8)
-        [[nodiscard]] static auto apply(F&& f, Data* data, u8 index) noexcept {
+        [[nodiscard]] static auto apply(F&& f, Data* data, Index index) noexcept {
             INDEX(7);
             INDEX(6);
             INDEX(5);
@@ -182,8 +186,45 @@ private:
 
 #undef INDEX
 
+#define CASE(n)                                                                                    \
+    case n: {                                                                                      \
+        if constexpr(N > n) return apply_one<F, Choose<n, Ts...>>(rpp::forward<F>(f), data);      \
+    } break;
+#define CASES4(n) CASE(n) CASE(n + 1) CASE(n + 2) CASE(n + 3)
+#define CASES16(n) CASES4(n) CASES4(n + 4) CASES4(n + 8) CASES4(n + 12)
+#define CASES64(n) CASES16(n) CASES16(n + 16) CASES16(n + 32) CASES16(n + 48)
+
+        template<typename F>
+            requires(N > 8 && N <= 64)
+        [[nodiscard]] static auto apply(F&& f, Data* data, Index index) noexcept {
+            switch(index) {
+                CASES64(0)
+                default: break;
+            }
+            return apply_one<F, Choose<0, Ts...>>(rpp::forward<F>(f), data);
+        }
+
+        template<typename F>
+            requires(N > 64 && N <= 256)
+        [[nodiscard]] static auto apply(F&& f, Data* data, Index index) noexcept {
+            switch(index) {
+                CASES64(0)
+                CASES64(64)
+                CASES64(128)
+                CASES64(192)
+                default: break;
+            }
+            return apply_one<F, Choose<0, Ts...>>(rpp::forward<F>(f), data);
+        }
+
+#undef CASES64
+#undef CASES16
+#undef CASES4
+#undef CASE
+
         template<typename F>
-        [[nodiscard]] static auto apply(F&& f, Data* data, u8 index) noexcept {
+            requires(N > 256)
+        [[nodiscard]] static auto apply(F&& f, Data* data, Index index) noexcept {
             return apply_n(rpp::forward<F>(f), data, index, Index_Sequence_For<Ts...>{});
         }
 
@@ -193,7 +234,7 @@ private:
             return rpp::forward<F>(f)(reinterpret_cast<Ref<T>>(*data));
         }
         template<typename F, u64... Is>
-        [[nodiscard]] static auto apply_n(F&& f, Data* data, u8 index,
+        [[nodiscard]] static auto apply_n(F&& f, Data* data, Index index,
                                           Index_Sequence<Is...>) noexcept {
             using T = Choose<0, Ts...>;
             using R = Invoke_Result<F, Ref<T>>;
@@ -10,21 +10,29 @@ namespace rpp {
 template<typename T>
 struct Slice;
 
-template<typename T, Allocator A = Mdefault>
+template<typename T, u64 N, Allocator A>
+struct Small_Vec;
+
+template<typename T, Allocator_Instance A = Mdefault>
 struct Vec {
 
     Vec() noexcept = default;
 
     explicit Vec(u64 capacity) noexcept
-        : data_(reinterpret_cast<T*>(A::alloc(capacity * sizeof(T)))), length_(0),
-          capacity_(capacity) {
+        : data_(reinterpret_cast<T*>(alloc_aligned<alignof(T)>(alloc_, capacity * sizeof(T)))),
+          length_(0), capacity_(capacity) {
+    }
+
+    // For stateful allocators, which can not be default constructed usefully.
+    explicit Vec(A allocator, u64 capacity = 0) noexcept : alloc_(allocator) {
+        reserve(capacity);
     }
 
     [[nodiscard]] static Vec make(u64 length) noexcept
         requires Default_Constructable<T>
     {
         Vec ret;
-        ret.data_ = reinterpret_cast<T*>(A::alloc(length * sizeof(T)));
+        ret.data_ = reinterpret_cast<T*>(alloc_aligned<alignof(T)>(ret.alloc_, length * sizeof(T)));
         new(ret.data_) T[length]{};
         ret.capacity_ = length;
         ret.length_ = length;
@@ -41,7 +49,7 @@ struct Vec {
     Vec(const Vec& src) noexcept = delete;
     Vec& operator=(const Vec& src) noexcept = delete;
 
-    Vec(Vec&& src) noexcept {
+    Vec(Vec&& src) noexcept : alloc_(src.alloc_) {
         data_ = src.data_;
         length_ = src.length_;
         capacity_ = src.capacity_;
@@ -54,6 +62,7 @@ struct Vec {
         data_ = src.data_;
         length_ = src.length_;
         capacity_ = src.capacity_;
+        alloc_ = src.alloc_;
         src.data_ = null;
         src.length_ = 0;
         src.capacity_ = 0;
@@ -66,17 +75,20 @@ struct Vec {
                 data_[i].~T();
             }
         }
-        A::free(data_);
+        alloc_.free(data_);
         data_ = null;
         length_ = 0;
         capacity_ = 0;
     }
 
-    template<Allocator B = A>
+    // Clones into the same allocator instance, or a default constructed B.
+    template<Allocator_Instance B = A>
     [[nodiscard]] Vec<T, B> clone() const noexcept
         requires(Clone<T> || Copy_Constructable<T>)
     {
-        Vec<T, B> ret(capacity_);
+        Vec<T, B> ret;
+        if constexpr(Same<A, B>) ret.alloc_ = alloc_;
+        ret.reserve(capacity_);
         ret.length_ = length_;
         if constexpr(Trivially_Copyable<T>) {
             Libc::memcpy(ret.data_, data_, length_ * sizeof(T));
@@ -110,7 +122,13 @@ struct Vec {
     void reserve(u64 new_capacity) noexcept {
         if(new_capacity <= capacity_) return;
 
-        T* new_data = reinterpret_cast<T*>(A::alloc(new_capacity * sizeof(T)));
+        if(alloc_expand(alloc_, data_, capacity_ * sizeof(T), new_capacity * sizeof(T))) {
+            capacity_ = new_capacity;
+            return;
+        }
+
+        T* new_data =
+            reinterpret_cast<T*>(alloc_aligned<alignof(T)>(alloc_, new_capacity * sizeof(T)));
 
         if(data_ && new_data) {
             if constexpr(Trivially_Movable<T>) {
@@ -122,7 +140,7 @@ struct Vec {
                 }
             }
         }
-        A::free(data_);
+        alloc_.free(data_);
 
         capacity_ = new_capacity;
         data_ = new_data;
@@ -251,17 +269,275 @@ struct Vec {
         return Slice<T>{data_, length_};
     }
 
+    [[nodiscard]] const A& allocator() const noexcept {
+        return alloc_;
+    }
+
 private:
     T* data_ = null;
     u64 length_ = 0;
     u64 capacity_ = 0;
+    RPP_NO_UNIQUE_ADDRESS A alloc_;
 
+    template<typename, Allocator_Instance>
+    friend struct Vec;
     friend struct Reflect::Refl<Vec>;
 };
 
+// Keeps up to N elements inline and only allocates from A once it outgrows them, so the many
+// vectors that stay tiny never touch the heap. Moving an inline vector moves its elements.
+template<typename T, u64 N, Allocator A = Mdefault>
+struct Small_Vec {
+    static_assert(N > 0);
+
+    Small_Vec() noexcept = default;
+
+    template<typename... Ss>
+        requires All_Are<T, Ss...> && Move_Constructable<T>
+    explicit Small_Vec(Ss&&... init) noexcept {
+        reserve(sizeof...(Ss));
+        (push(rpp::move(init)), ...);
+    }
+
+    Small_Vec(const Small_Vec& src) noexcept = delete;
+    Small_Vec& operator=(const Small_Vec& src) noexcept = delete;
+
+    Small_Vec(Small_Vec&& src) noexcept {
+        take(rpp::move(src));
+    }
+    Small_Vec& operator=(Small_Vec&& src) noexcept {
+        this->~Small_Vec();
+        take(rpp::move(src));
+        return *this;
+    }
+
+    ~Small_Vec() noexcept {
+        clear();
+        if(!is_inline()) A::free(data_);
+        data_ = inline_data();
+        capacity_ = N;
+    }
+
+    template<Allocator B = A>
+    [[nodiscard]] Small_Vec<T, N, B> clone() const noexcept
+        requires(Clone<T> || Copy_Constructable<T>)
+    {
+        Small_Vec<T, N, B> ret;
+        ret.reserve(length_);
+        for(u64 i = 0; i < length_; i++) {
+            if constexpr(Clone<T>) {
+                ret.push(data_[i].clone());
+            } else {
+                ret.push(T{data_[i]});
+            }
+        }
+        return ret;
+    }
+
+    void grow() noexcept {
+        reserve(2 * capacity_);
+    }
+
+    void clear() noexcept {
+        if constexpr(Must_Destruct<T>) {
+            for(u64 i = 0; i < length_; i++) {
+                data_[i].~T();
+            }
+        }
+        length_ = 0;
+    }
+
+    void reserve(u64 new_capacity) noexcept {
+        if(new_capacity <= capacity_) return;
+
+        if(!is_inline() &&
+           alloc_expand<A>(data_, capacity_ * sizeof(T), new_capacity * sizeof(T))) {
+            capacity_ = new_capacity;
+            return;
+        }
+
+        T* new_data = reinterpret_cast<T*>(alloc_aligned<A, alignof(T)>(new_capacity * sizeof(T)));
+        relocate(new_data, data_, length_);
+        if(!is_inline()) A::free(data_);
+
+        capacity_ = new_capacity;
+        data_ = new_data;
+    }
+
+    void extend(u64 additional_length) noexcept
+        requires Default_Constructable<T>
+    {
+        resize(length_ + additional_length);
+    }
+
+    void resize(u64 new_length) noexcept
+        requires Default_Constructable<T>
+    {
+        reserve(new_length);
+        if(new_length > length_) {
+            new(&data_[length_]) T[new_length - length_]{};
+        } else if constexpr(Must_Destruct<T>) {
+            for(u64 i = new_length; i < length_; i++) {
+                data_[i].~T();
+            }
+        }
+        length_ = new_length;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return length_ == 0;
+    }
+    [[nodiscard]] bool full() const noexcept {
+        return length_ == capacity_;
+    }
+    [[nodiscard]] bool is_inline() const noexcept {
+        return data_ == inline_data();
+    }
+
+    T& push(const T& value) noexcept
+        requires Copy_Constructable<T>
+    {
+        return push(T{value});
+    }
+
+    T& push(T&& value) noexcept
+        requires Move_Constructable<T>
+    {
+        if(full()) grow();
+        assert(length_ < capacity_);
+        new(&data_[length_]) T{rpp::move(value)};
+        return data_[length_++];
+    }
+
+    template<typename... Args>
+        requires Constructable<T, Args...>
+    T& emplace(Args&&... args) noexcept {
+        if(full()) grow();
+        assert(length_ < capacity_);
+        new(&data_[length_]) T{rpp::forward<Args>(args)...};
+        return data_[length_++];
+    }
+
+    void pop() noexcept {
+        assert(length_ > 0);
+        length_--;
+        if constexpr(Must_Destruct<T>) {
+            data_[length_].~T();
+        }
+    }
+
+    [[nodiscard]] T& front() noexcept {
+        assert(length_ > 0);
+        return data_[0];
+    }
+    [[nodiscard]] const T& front() const noexcept {
+        assert(length_ > 0);
+        return data_[0];
+    }
+
+    [[nodiscard]] T& back() noexcept {
+        assert(length_ > 0);
+        return data_[length_ - 1];
+    }
+    [[nodiscard]] const T& back() const noexcept {
+        assert(length_ > 0);
+        return data_[length_ - 1];
+    }
+
+    [[nodiscard]] T& operator[](u64 idx) noexcept {
+        assert(idx < length_);
+        return data_[idx];
+    }
+    [[nodiscard]] const T& operator[](u64 idx) const noexcept {
+        assert(idx < length_);
+        return data_[idx];
+    }
+
+    [[nodiscard]] const T* begin() const noexcept {
+        return data_;
+    }
+    [[nodiscard]] const T* end() const noexcept {
+        return data_ + length_;
+    }
+    [[nodiscard]] T* begin() noexcept {
+        return data_;
+    }
+    [[nodiscard]] T* end() noexcept {
+        return data_ + length_;
+    }
+
+    [[nodiscard]] u64 length() const noexcept {
+        return length_;
+    }
+    [[nodiscard]] u64 capacity() const noexcept {
+        return capacity_;
+    }
+    [[nodiscard]] u64 bytes() const noexcept {
+        return length_ * sizeof(T);
+    }
+
+    [[nodiscard]] T* data() noexcept {
+        return data_;
+    }
+    [[nodiscard]] const T* data() const noexcept {
+        return data_;
+    }
+
+    [[nodiscard]] Slice<T> slice() const noexcept {
+        return Slice<T>{data_, length_};
+    }
+
+private:
+    [[nodiscard]] T* inline_data() noexcept {
+        return reinterpret_cast<T*>(storage_);
+    }
+    [[nodiscard]] const T* inline_data() const noexcept {
+        return reinterpret_cast<const T*>(storage_);
+    }
+
+    static void relocate(T* dst, T* src, u64 length) noexcept {
+        if constexpr(Trivially_Movable<T>) {
+            if(length) Libc::memcpy((void*)dst, src, sizeof(T) * length);
+        } else {
+            static_assert(Move_Constructable<T>);
+            for(u64 i = 0; i < length; i++) {
+                new(&dst[i]) T{rpp::move(src[i])};
+                if constexpr(Must_Destruct<T>) {
+                    src[i].~T();
+                }
+            }
+        }
+    }
+
+    void take(Small_Vec&& src) noexcept {
+        if(src.is_inline()) {
+            relocate(data_, src.data_, src.length_);
+        } else {
+            data_ = src.data_;
+            capacity_ = src.capacity_;
+            src.data_ = src.inline_data();
+            src.capacity_ = N;
+        }
+        length_ = src.length_;
+        src.length_ = 0;
+    }
+
+    alignas(T) u8 storage_[N * sizeof(T)];
+    T* data_ = inline_data();
+    u64 length_ = 0;
+    u64 capacity_ = N;
+
+    template<typename, u64, Allocator>
+    friend struct Small_Vec;
+    friend struct Reflect::Refl<Small_Vec>;
+};
+
 template<typename T>
 Slice(Vec<T>) -> Slice<T>;
 
+template<typename T, u64 N, Allocator A>
+Slice(Small_Vec<T, N, A>) -> Slice<T>;
+
 template<typename T, u64 N>
 Slice(Array<T, N>) -> Slice<T>;
 
@@ -276,12 +552,18 @@ struct Slice {
 
     constexpr Slice() noexcept = default;
 
-    template<Allocator A>
+    template<Allocator_Instance A>
     explicit Slice(const Vec<T, A>& v) noexcept {
         data_ = v.data();
         length_ = v.length();
     }
 
+    template<u64 N, Allocator A>
+    explicit Slice(const Small_Vec<T, N, A>& v) noexcept {
+        data_ = v.data();
+        length_ = v.length();
+    }
+
     template<u64 N>
     constexpr explicit Slice(const Array<T, N>& a) noexcept {
         data_ = a.data();
@@ -367,16 +649,20 @@ private:
     friend struct Reflect::Refl<Slice<T>>;
 };
 
-template<typename T, Allocator A>
+template<typename T, Allocator_Instance A>
 RPP_TEMPLATE_RECORD(Vec, RPP_PACK(T, A), RPP_FIELD(data_), RPP_FIELD(length_),
                     RPP_FIELD(capacity_));
 
+template<typename T, u64 N, Allocator A>
+RPP_TEMPLATE_RECORD(Small_Vec, RPP_PACK(T, N, A), RPP_FIELD(data_), RPP_FIELD(length_),
+                    RPP_FIELD(capacity_));
+
 template<typename T>
 RPP_TEMPLATE_RECORD(Slice, T, RPP_FIELD(data_), RPP_FIELD(length_));
 
 namespace Format {
 
-template<Reflectable T, Allocator A>
+template<Reflectable T, Allocator_Instance A>
 struct Measure<Vec<T, A>> {
     [[nodiscard]] constexpr static u64 measure(const Vec<T, A>& vec) noexcept {
         u64 length = 5;
@@ -387,6 +673,17 @@ struct Measure<Vec<T, A>> {
         return length;
     }
 };
+template<Reflectable T, u64 N, Allocator A>
+struct Measure<Small_Vec<T, N, A>> {
+    [[nodiscard]] constexpr static u64 measure(const Small_Vec<T, N, A>& vec) noexcept {
+        u64 length = 11;
+        for(u64 i = 0; i < vec.length(); i++) {
+            length += Measure<T>::measure(vec[i]);
+            if(i + 1 < vec.length()) length += 2;
+        }
+        return length;
+    }
+};
 template<Reflectable T>
 struct Measure<Slice<T>> {
     [[nodiscard]] static u64 measure(const Slice<T>& slice) noexcept {
@@ -399,7 +696,7 @@ struct Measure<Slice<T>> {
     }
 };
 
-template<Allocator O, Reflectable T, Allocator A>
+template<Allocator O, Reflectable T, Allocator_Instance A>
 struct Write<O, Vec<T, A>> {
     [[nodiscard]] static u64 write(String<O>& output, u64 idx, const Vec<T, A>& vec) noexcept {
         idx = output.write(idx, "Vec["_v);
@@ -410,6 +707,18 @@ struct Write<O, Vec<T, A>> {
         return output.write(idx, ']');
     }
 };
+template<Allocator O, Reflectable T, u64 N, Allocator A>
+struct Write<O, Small_Vec<T, N, A>> {
+    [[nodiscard]] static u64 write(String<O>& output, u64 idx,
+                                   const Small_Vec<T, N, A>& vec) noexcept {
+        idx = output.write(idx, "Small_Vec["_v);
+        for(u64 i = 0; i < vec.length(); i++) {
+            idx = Write<O, T>::write(output, idx, vec[i]);
+            if(i + 1 < vec.length()) idx = output.write(idx, ", "_v);
+        }
+        return output.write(idx, ']');
+    }
+};
 template<Allocator O, Reflectable T>
 struct Write<O, Slice<T>> {
     [[nodiscard]] static u64 write(String<O>& output, u64 idx, const Slice<T>& slice) noexcept {
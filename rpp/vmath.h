@@ -560,6 +560,205 @@ constexpr Vect<T, N> normalize(Vect<T, N> x) noexcept {
     return x.unit();
 }
 
+// Vec3 padded to 16 bytes, so each operation is a single F32x4 instruction. The fourth lane is
+// padding: operations may leave anything in it and never read it. Results are bit-identical to
+// the same operations on Vec3, unless the compiler fuses Vec3's scalar multiply-adds.
+struct Vec3A {
+
+    union {
+        struct {
+            f32 x, y, z, pad;
+        };
+        f32 data[4];
+        F32x4 pack;
+    };
+
+    Vec3A() noexcept : pack{F32x4::zero()} {
+    }
+    explicit Vec3A(F32x4 p) noexcept : pack{p} {
+    }
+    explicit Vec3A(f32 s) noexcept : pack{F32x4::set(s, s, s, 0.0f)} {
+    }
+    explicit Vec3A(f32 x, f32 y, f32 z) noexcept : pack{F32x4::set(x, y, z, 0.0f)} {
+    }
+    explicit Vec3A(Vec3 v) noexcept : pack{F32x4::set(v.x, v.y, v.z, 0.0f)} {
+    }
+
+    ~Vec3A() noexcept = default;
+
+    Vec3A(const Vec3A&) noexcept = default;
+    Vec3A& operator=(const Vec3A&) noexcept = default;
+    Vec3A(Vec3A&&) noexcept = default;
+    Vec3A& operator=(Vec3A&&) noexcept = default;
+
+    [[nodiscard]] Vec3 to_vec3() const noexcept {
+        return Vec3{x, y, z};
+    }
+
+    f32& operator[](u64 idx) noexcept {
+        return data[idx];
+    }
+    f32 operator[](u64 idx) const noexcept {
+        return data[idx];
+    }
+
+    Vec3A operator+(Vec3A o) const noexcept {
+        return Vec3A{F32x4::add(pack, o.pack)};
+    }
+    Vec3A operator-(Vec3A o) const noexcept {
+        return Vec3A{F32x4::sub(pack, o.pack)};
+    }
+    Vec3A operator*(Vec3A o) const noexcept {
+        return Vec3A{F32x4::mul(pack, o.pack)};
+    }
+    Vec3A operator/(Vec3A o) const noexcept {
+        return Vec3A{F32x4::div(pack, o.pack)};
+    }
+
+    Vec3A operator+(f32 s) const noexcept {
+        return Vec3A{F32x4::add(pack, F32x4::set1(s))};
+    }
+    Vec3A operator-(f32 s) const noexcept {
+        return Vec3A{F32x4::sub(pack, F32x4::set1(s))};
+    }
+    Vec3A operator*(f32 s) const noexcept {
+        return Vec3A{F32x4::mul(pack, F32x4::set1(s))};
+    }
+    Vec3A operator/(f32 s) const noexcept {
+        return Vec3A{F32x4::div(pack, F32x4::set1(s))};
+    }
+
+    Vec3A& operator+=(Vec3A o) noexcept {
+        return *this = *this + o;
+    }
+    Vec3A& operator-=(Vec3A o) noexcept {
+        return *this = *this - o;
+    }
+    Vec3A& operator*=(Vec3A o) noexcept {
+        return *this = *this * o;
+    }
+    Vec3A& operator/=(Vec3A o) noexcept {
+        return *this = *this / o;
+    }
+    Vec3A& operator*=(f32 s) noexcept {
+        return *this = *this * s;
+    }
+    Vec3A& operator/=(f32 s) noexcept {
+        return *this = *this / s;
+    }
+
+    // Multiplying by -1 flips the sign of zeros too, like scalar negation.
+    Vec3A operator-() const noexcept {
+        return Vec3A{F32x4::mul(pack, F32x4::set1(-1.0f))};
+    }
+
+    bool operator==(Vec3A o) const noexcept {
+        return (SIMD::I32x4::movemask(F32x4::cmpeq(pack, o.pack)) & 0x7) == 0x7;
+    }
+    bool operator!=(Vec3A o) const noexcept {
+        return !(*this == o);
+    }
+
+    Vec3A abs() const noexcept {
+        return Vec3A{F32x4::abs(pack)};
+    }
+    Vec3A floor() const noexcept {
+        return Vec3A{F32x4::floor(pack)};
+    }
+    Vec3A ceil() const noexcept {
+        return Vec3A{F32x4::ceil(pack)};
+    }
+
+    // Summed in the same order as Vec3, which starts from zero.
+    f32 norm2() const noexcept {
+        Vec3A p{F32x4::mul(pack, pack)};
+        return ((0.0f + p.x) + p.y) + p.z;
+    }
+    f32 norm() const noexcept {
+        return Math::sqrt(norm2());
+    }
+    Vec3A unit() const noexcept {
+        return *this / norm();
+    }
+    Vec3A normalize() noexcept {
+        return *this = unit();
+    }
+
+    f32 min() const noexcept {
+        return Math::min(Math::min(x, y), z);
+    }
+    f32 max() const noexcept {
+        return Math::max(Math::max(x, y), z);
+    }
+
+    const f32* begin() const noexcept {
+        return data;
+    }
+    const f32* end() const noexcept {
+        return data + 3;
+    }
+    f32* begin() noexcept {
+        return data;
+    }
+    f32* end() noexcept {
+        return data + 3;
+    }
+};
+
+static_assert(sizeof(Vec3A) == 16 && alignof(Vec3A) == 16);
+
+inline f32 dot(Vec3A l, Vec3A r) noexcept {
+    Vec3A p{F32x4::mul(l.pack, r.pack)};
+    return ((0.0f + p.x) + p.y) + p.z;
+}
+
+inline Vec3A cross(Vec3A l, Vec3A r) noexcept {
+    F32x4 a = F32x4::mul(F32x4::shuffle<1, 2, 0, 3>(l.pack), F32x4::shuffle<2, 0, 1, 3>(r.pack));
+    F32x4 b = F32x4::mul(F32x4::shuffle<2, 0, 1, 3>(l.pack), F32x4::shuffle<1, 2, 0, 3>(r.pack));
+    return Vec3A{F32x4::sub(a, b)};
+}
+
+// Selects like Math::min and Math::max, so NaNs and signed zeros match the scalar versions.
+inline Vec3A min(Vec3A x, Vec3A y) noexcept {
+    return Vec3A{F32x4::select(F32x4::cmplt(x.pack, y.pack), x.pack, y.pack)};
+}
+
+inline Vec3A max(Vec3A x, Vec3A y) noexcept {
+    return Vec3A{F32x4::select(F32x4::cmplt(y.pack, x.pack), x.pack, y.pack)};
+}
+
+inline Vec3A abs(Vec3A x) noexcept {
+    return x.abs();
+}
+
+inline Vec3A lerp(Vec3A min, Vec3A max, f32 dist) noexcept {
+    return min + (max - min) * dist;
+}
+
+inline Vec3A clamp(Vec3A x, Vec3A min, Vec3A max) noexcept {
+    return Math::max(Math::min(x, max), min);
+}
+
+inline Vec3A normalize(Vec3A x) noexcept {
+    return x.unit();
+}
+
+// Ray with its reciprocal direction precomputed for slab tests. Zero direction components give
+// infinite reciprocals, so rays parallel to a slab only hit boxes whose slab contains them.
+struct Ray {
+
+    Ray() noexcept = default;
+    explicit Ray(Vec3 origin, Vec3 direction) noexcept
+        : origin{origin}, direction{direction}, inv_direction{Vec3A{1.0f} / Vec3A{direction}} {
+    }
+
+    [[nodiscard]] Vec3 at(f32 t) const noexcept {
+        return (origin + direction * t).to_vec3();
+    }
+
+    Vec3A origin, direction, inv_direction;
+};
+
 struct Mat4 {
 
     union {
@@ -652,6 +851,9 @@ struct Quat : detail::Vect_Base<f32, 4> {
     }
     constexpr explicit Quat(Vec4 src) noexcept : Base{src} {
     }
+    constexpr explicit Quat(F32x4 p) noexcept : Base{} {
+        pack = p;
+    }
 
     constexpr ~Quat() noexcept = default;
 
@@ -713,11 +915,25 @@ struct Quat : detail::Vect_Base<f32, 4> {
         return Math::sqrt(norm2());
     }
     Quat unit() const noexcept {
-        f32 n = norm();
-        return Quat(x / n, y / n, z / n, w / n);
+        return Quat{F32x4::div(pack, F32x4::set1(norm()))};
     }
 
+    // Outside constant evaluation, products and to_mat() are computed in F32x4 lanes. Terms are
+    // grouped like the scalar expressions, so both round the same.
     constexpr Quat operator*(const Quat& r) const noexcept {
+        if(!is_constexpr()) {
+            F32x4 flip = F32x4::set(1.0f, 1.0f, 1.0f, -1.0f);
+            F32x4 a =
+                F32x4::mul(F32x4::shuffle<1, 2, 0, 3>(pack), F32x4::shuffle<2, 0, 1, 3>(r.pack));
+            F32x4 b =
+                F32x4::mul(F32x4::shuffle<2, 0, 1, 0>(pack), F32x4::shuffle<1, 2, 0, 0>(r.pack));
+            F32x4 c =
+                F32x4::mul(F32x4::shuffle<0, 1, 2, 1>(pack), F32x4::shuffle<3, 3, 3, 1>(r.pack));
+            F32x4 d =
+                F32x4::mul(F32x4::shuffle<3, 3, 3, 2>(pack), F32x4::shuffle<0, 1, 2, 2>(r.pack));
+            F32x4 ab_c = F32x4::add(F32x4::sub(a, b), F32x4::mul(c, flip));
+            return Quat{F32x4::add(ab_c, F32x4::mul(d, flip))};
+        }
         return Quat(y * r.z - z * r.y + x * r.w + w * r.x, z * r.x - x * r.z + y * r.w + w * r.y,
                     x * r.y - y * r.x + z * r.w + w * r.z, w * r.w - x * r.x - y * r.y - z * r.z);
     }
@@ -740,6 +956,31 @@ struct Quat : detail::Vect_Base<f32, 4> {
     }
 
     constexpr Mat4 to_mat() const noexcept {
+        if(!is_constexpr()) {
+            // Doubling is exact, so x * 2y rounds like 2 * x * y.
+            F32x4 q2 = F32x4::add(pack, pack);
+            auto column = [&](F32x4 unit, F32x4 u, F32x4 u_sign, F32x4 v, F32x4 v_sign) {
+                return Vec4{F32x4::add(F32x4::add(unit, F32x4::mul(u, u_sign)),
+                                       F32x4::mul(v, v_sign))};
+            };
+            return Mat4{
+                column(F32x4::set(1.0f, 0.0f, 0.0f, 0.0f),
+                       F32x4::mul(F32x4::shuffle<1, 0, 0, 3>(pack), F32x4::shuffle<1, 1, 2, 3>(q2)),
+                       F32x4::set(-1.0f, 1.0f, 1.0f, 0.0f),
+                       F32x4::mul(F32x4::shuffle<2, 3, 3, 3>(pack), F32x4::shuffle<2, 2, 1, 3>(q2)),
+                       F32x4::set(-1.0f, 1.0f, -1.0f, 0.0f)),
+                column(F32x4::set(0.0f, 1.0f, 0.0f, 0.0f),
+                       F32x4::mul(F32x4::shuffle<0, 0, 1, 3>(pack), F32x4::shuffle<1, 0, 2, 3>(q2)),
+                       F32x4::set(1.0f, -1.0f, 1.0f, 0.0f),
+                       F32x4::mul(F32x4::shuffle<3, 2, 3, 3>(pack), F32x4::shuffle<2, 2, 0, 3>(q2)),
+                       F32x4::set(-1.0f, -1.0f, 1.0f, 0.0f)),
+                column(F32x4::set(0.0f, 0.0f, 1.0f, 0.0f),
+                       F32x4::mul(F32x4::shuffle<0, 1, 0, 3>(pack), F32x4::shuffle<2, 2, 0, 3>(q2)),
+                       F32x4::set(1.0f, 1.0f, -1.0f, 0.0f),
+                       F32x4::mul(F32x4::shuffle<3, 3, 1, 3>(pack), F32x4::shuffle<1, 0, 1, 3>(q2)),
+                       F32x4::set(1.0f, -1.0f, -1.0f, 0.0f)),
+                Vec4{0.0f, 0.0f, 0.0f, 1.0f}};
+        }
         return Mat4{
             Vec4{1 - 2 * y * y - 2 * z * z, 2 * x * y + 2 * z * w, 2 * x * z - 2 * y * w, 0.0f},
             Vec4{2 * x * y - 2 * z * w, 1 - 2 * x * x - 2 * z * z, 2 * y * z + 2 * x * w, 0.0f},
@@ -747,8 +988,17 @@ struct Quat : detail::Vect_Base<f32, 4> {
             Vec4{0.0f, 0.0f, 0.0f, 1.0f}};
     }
 
+    // |q|^2 v + 2w(u x v) + 2u x (u x v) for the complex part u, which expands
+    // q * v * conjugate() without the two full products. Like that product, it also scales v by
+    // |q|^2, so non-unit quaternions give the same result on both paths.
     constexpr Vec3 rotate(Vec3 v) const noexcept {
-        return (((*this) * Quat(v, 0)) * conjugate()).complex();
+        if(!is_constexpr()) {
+            Vec3A u{pack}, a{v};
+            Vec3A t = cross(u, a) * 2.0f;
+            return (a * norm2() + t * w + cross(u, t)).to_vec3();
+        }
+        Vec3 t = cross(complex(), v) * 2.0f;
+        return v * norm2() + t * w + cross(complex(), t);
     }
 
     constexpr bool operator==(const Quat& v) const noexcept {
@@ -832,6 +1082,11 @@ struct BBox {
         }
     }
 
+    // Distance at which the ray enters the box, if it does so between t_min and t_max. Rays that
+    // start inside the box enter at t_min.
+    [[nodiscard]] Opt<f32> hit(const Ray& ray, f32 t_min = 0.0f,
+                               f32 t_max = Limits<f32>::max()) const noexcept;
+
     constexpr void project(const Mat4& proj, Vec2& min_out, Vec2& max_out) const noexcept {
 
         min_out = Vec2(Limits<f32>::max());
@@ -865,10 +1120,46 @@ struct BBox {
     Vec3 min, max;
 };
 
+// Eight boxes in lanes, so a ray can be tested against all of them at once. Unset lanes hold
+// empty boxes, which nothing hits.
+struct BBox8 {
+
+    BBox8() noexcept;
+
+    void set(u64 i, const BBox& box) noexcept;
+    [[nodiscard]] BBox get(u64 i) const noexcept;
+
+    // Bit i is set when the ray enters box i between t_min and t_max. If t is given, it receives
+    // the entry distances of every lane.
+    [[nodiscard]] u32 hit(const Ray& ray, f32 t_min = 0.0f, f32 t_max = Limits<f32>::max(),
+                          SIMD::F32x8* t = null) const noexcept;
+
+    SIMD::F32x8 min[3], max[3];
+};
+
+// Batch transforms. out must hold in.length() elements, and may be in itself. Eight elements are
+// transposed into lanes per step, so each output component costs a few 8-wide multiply-adds.
+// Results match transforming each element on its own.
+void transform_points(const Mat4& T, Slice<Vec3> in, Vec3* out) noexcept;
+void transform_points(const Mat4& T, Slice<Vec4> in, Vec4* out) noexcept;
+// Ignores translation, like Mat4::rotate.
+void transform_vectors(const Mat4& T, Slice<Vec3> in, Vec3* out) noexcept;
+void transform_bboxes(const Mat4& T, Slice<BBox> in, BBox* out) noexcept;
+
+// Spherical interpolation along the shorter arc, falling back to normalized lerp for nearly
+// equal rotations. Angles come from F32x4::atan2 and F32x4::sin, so the batch version below
+// matches this one.
+[[nodiscard]] Quat slerp(Quat from, Quat to, f32 t) noexcept;
+
+// Batch quaternion ops, laid out like the transforms above. from and to must be the same length.
+void slerp(Slice<Quat> from, Slice<Quat> to, f32 t, Quat* out) noexcept;
+void normalize(Slice<Quat> in, Quat* out) noexcept;
+
 } // namespace Math
 
 using Math::Vec2;
 using Math::Vec3;
+using Math::Vec3A;
 using Math::Vec4;
 using Math::VecN;
 
@@ -883,8 +1174,10 @@ using Math::Vec4u;
 using Math::VecNu;
 
 using Math::BBox;
+using Math::BBox8;
 using Math::Mat4;
 using Math::Quat;
+using Math::Ray;
 
 template<typename T, u64 N>
 constexpr Math::Vect<T, N> operator+(T s, Math::Vect<T, N> v) noexcept {
@@ -919,6 +1212,10 @@ constexpr Math::Vect<T, N> operator*(T s, Math::Vect<T, N> v) noexcept {
     }
 }
 
+inline Math::Vec3A operator*(f32 s, Math::Vec3A v) noexcept {
+    return v * s;
+}
+
 template<typename T, u64 N>
 constexpr Math::Vect<T, N> operator/(T s, Math::Vect<T, N> v) noexcept {
     if constexpr(Math::Vect<T, N>::is_simd)
@@ -932,6 +1229,7 @@ constexpr Math::Vect<T, N> operator/(T s, Math::Vect<T, N> v) noexcept {
 
 RPP_RECORD(Vec2, RPP_FIELD(x), RPP_FIELD(y));
 RPP_RECORD(Vec3, RPP_FIELD(x), RPP_FIELD(y), RPP_FIELD(z));
+RPP_RECORD(Vec3A, RPP_FIELD(x), RPP_FIELD(y), RPP_FIELD(z));
 RPP_RECORD(Vec4, RPP_FIELD(x), RPP_FIELD(y), RPP_FIELD(z), RPP_FIELD(w));
 template<u64 N>
 RPP_TEMPLATE_RECORD(VecN, N, RPP_FIELD(data));
@@ -963,6 +1261,13 @@ struct Hash<Math::Vect<T, N>> {
     }
 };
 
+template<>
+struct Hash<Math::Vec3A> {
+    static u64 hash(const Math::Vec3A& v) noexcept {
+        return rpp::hash(v.to_vec3());
+    }
+};
+
 } // namespace Hash
 
 namespace Format {
@@ -992,6 +1297,12 @@ struct Measure<Math::Vect<I, N>> {
     }
 };
 template<>
+struct Measure<Math::Vec3A> {
+    static u64 measure(const Math::Vec3A& vect) noexcept {
+        return 1 + Measure<Math::Vec3>::measure(vect.to_vec3());
+    }
+};
+template<>
 struct Measure<Math::Mat4> {
     constexpr static u64 measure(const Math::Mat4& mat) noexcept {
         u64 length = 6;
@@ -1072,6 +1383,17 @@ struct Write<O, Math::Vect<I, N>> {
     }
 };
 template<Allocator O>
+struct Write<O, Math::Vec3A> {
+    static u64 write(String<O>& output, u64 idx, const Math::Vec3A& vect) noexcept {
+        idx = output.write(idx, "Vec3A{"_v);
+        for(u64 i = 0; i < 3; i++) {
+            idx = Write<O, f32>::write(output, idx, vect[i]);
+            if(i + 1 < 3) idx = output.write(idx, ", "_v);
+        }
+        return output.write(idx, '}');
+    }
+};
+template<Allocator O>
 struct Write<O, Math::Mat4> {
     static u64 write(String<O>& output, u64 idx, const Math::Mat4& mat) noexcept {
         idx = output.write(idx, "Mat4{"_v);
@@ -0,0 +1,38 @@
+#include "../base.h"
+
+#include <windows.h>
+
+namespace rpp {
+
+[[nodiscard]] void* sys_reserve(u64 size) noexcept {
+    void* ret = VirtualAlloc(null, size, MEM_RESERVE, PAGE_NOACCESS);
+    if(!ret) {
+        die("Failed to reserve % bytes: %", size, Log::sys_error());
+    }
+    return ret;
+}
+
+void sys_commit(void* mem, u64 size) noexcept {
+    if(!VirtualAlloc(mem, size, MEM_COMMIT, PAGE_READWRITE)) {
+        die("Failed to commit % bytes: %", size, Log::sys_error());
+    }
+}
+
+void sys_decommit(void* mem, u64 size) noexcept {
+    if(!VirtualFree(mem, size, MEM_DECOMMIT)) {
+        die("Failed to decommit % bytes: %", size, Log::sys_error());
+    }
+}
+
+void sys_release(void* mem, u64) noexcept {
+    if(!VirtualFree(mem, 0, MEM_RELEASE)) {
+        die("Failed to release region: %", Log::sys_error());
+    }
+}
+
+// Reservations can not be extended after the fact.
+[[nodiscard]] bool sys_extend(void*, u64, u64) noexcept {
+    return false;
+}
+
+} // namespace rpp
@@ -69,6 +69,10 @@ void Event::signal() const noexcept {
     }
 }
 
+[[nodiscard]] u64 Event::key() const noexcept {
+    return reinterpret_cast<u64>(event_);
+}
+
 [[nodiscard]] u64 Event::wait_any(Slice<Event> events) noexcept {
     assert(!events.empty());
     const HANDLE* handles = reinterpret_cast<const HANDLE*>(events.data());
@@ -80,4 +84,139 @@ void Event::signal() const noexcept {
     return ret - WAIT_OBJECT_0;
 }
 
+// Wait completion packets bind a waitable object to a completion port without a waiting thread.
+// ntdll exports them on Windows 8 and newer, but the SDK doesn't declare them.
+using Nt_Create_Packet = LONG(NTAPI*)(PHANDLE packet, ACCESS_MASK access, PVOID attributes);
+using Nt_Associate_Packet = LONG(NTAPI*)(HANDLE packet, HANDLE port, HANDLE target, PVOID key,
+                                         PVOID apc_context, LONG status, ULONG_PTR information,
+                                         PBOOLEAN already_signaled);
+using Nt_Cancel_Packet = LONG(NTAPI*)(HANDLE packet, BOOLEAN remove_signaled);
+
+constexpr LONG NT_STATUS_PENDING = 0x103;
+
+struct Wait_Packets {
+    Nt_Create_Packet create = null;
+    Nt_Associate_Packet associate = null;
+    Nt_Cancel_Packet cancel = null;
+};
+
+[[nodiscard]] static const Wait_Packets& wait_packets() noexcept {
+    static const Wait_Packets packets = []() {
+        HMODULE ntdll = GetModuleHandleW(L"ntdll.dll");
+        if(!ntdll) {
+            die("Failed to find ntdll: %", Log::sys_error());
+        }
+        Wait_Packets ret;
+        ret.create = reinterpret_cast<Nt_Create_Packet>(
+            reinterpret_cast<void*>(GetProcAddress(ntdll, "NtCreateWaitCompletionPacket")));
+        ret.associate = reinterpret_cast<Nt_Associate_Packet>(
+            reinterpret_cast<void*>(GetProcAddress(ntdll, "NtAssociateWaitCompletionPacket")));
+        ret.cancel = reinterpret_cast<Nt_Cancel_Packet>(
+            reinterpret_cast<void*>(GetProcAddress(ntdll, "NtCancelWaitCompletionPacket")));
+        if(!ret.create || !ret.associate || !ret.cancel) {
+            die("Wait completion packets are not supported.");
+        }
+        return ret;
+    }();
+    return packets;
+}
+
+Reactor::Reactor() noexcept {
+    port = reinterpret_cast<void*>(CreateIoCompletionPort(INVALID_HANDLE_VALUE, null, 0, 1));
+    if(!port) {
+        die("Failed to create completion port: %", Log::sys_error());
+    }
+}
+
+Reactor::~Reactor() noexcept {
+    for(auto& [key, packet] : packets) {
+        static_cast<void>(wait_packets().cancel(reinterpret_cast<HANDLE>(packet), TRUE));
+        CloseHandle(reinterpret_cast<HANDLE>(packet));
+    }
+    packets.clear();
+    for(void* packet : spare) {
+        CloseHandle(reinterpret_cast<HANDLE>(packet));
+    }
+    spare.clear();
+    BOOL ret = CloseHandle(reinterpret_cast<HANDLE>(port));
+    assert(ret);
+    port = null;
+}
+
+void Reactor::add(const Event& event, u64 id) noexcept {
+    const Wait_Packets& nt = wait_packets();
+
+    HANDLE packet = null;
+    if(spare.empty()) {
+        LONG status = nt.create(&packet, GENERIC_ALL, null);
+        if(status < 0) {
+            die("Failed to create wait packet: %", static_cast<u32>(status));
+        }
+    } else {
+        packet = reinterpret_cast<HANDLE>(spare.back());
+        spare.pop();
+    }
+
+    // The packet fires once, even if the event is already signaled.
+    LONG status = nt.associate(packet, reinterpret_cast<HANDLE>(port),
+                               reinterpret_cast<HANDLE>(event.event_),
+                               reinterpret_cast<PVOID>(static_cast<uptr>(id)), null, 0, 0, null);
+    if(status < 0) {
+        die("Failed to associate wait packet: %", static_cast<u32>(status));
+    }
+    packets.insert(event.key(), reinterpret_cast<void*>(packet));
+}
+
+void Reactor::remove(const Event& event) noexcept {
+    Opt<Ref<void*>> packet = packets.try_get(event.key());
+    if(!packet.ok()) return;
+
+    // Dropping a signaled packet also removes its completion if it wasn't dequeued yet. A packet
+    // that is still being delivered can't be reassociated, so it is closed instead of reused.
+    HANDLE handle = reinterpret_cast<HANDLE>(**packet);
+    packets.erase(event.key());
+    if(wait_packets().cancel(handle, TRUE) == NT_STATUS_PENDING) {
+        CloseHandle(handle);
+    } else {
+        spare.push(reinterpret_cast<void*>(handle));
+    }
+}
+
+void Reactor::wake() noexcept {
+    // Coalesce wake-ups, so a burst of them doesn't fill the next batch.
+    if(woken.exchange(1) == 0) {
+        BOOL ret = PostQueuedCompletionStatus(reinterpret_cast<HANDLE>(port), 0,
+                                              static_cast<ULONG_PTR>(WAKE), null);
+        if(!ret) {
+            die("Failed to post to completion port: %", Log::sys_error());
+        }
+    }
+}
+
+[[nodiscard]] u64 Reactor::wait(u64* ready, u64 capacity, u64 timeout_ms) noexcept {
+    assert(capacity > 0);
+
+    OVERLAPPED_ENTRY entries[MAX_BATCH];
+    ULONG max = static_cast<ULONG>(Math::min(capacity, MAX_BATCH));
+    DWORD timeout = timeout_ms == FOREVER
+                        ? INFINITE
+                        : static_cast<DWORD>(Math::min<u64>(timeout_ms, INFINITE - 1));
+
+    // Completions are dequeued in the order the events were signaled.
+    ULONG n = 0;
+    if(!GetQueuedCompletionStatusEx(reinterpret_cast<HANDLE>(port), entries, max, &n, timeout,
+                                    FALSE)) {
+        if(GetLastError() == WAIT_TIMEOUT) return 0;
+        die("Failed to wait on completion port: %", Log::sys_error());
+    }
+
+    for(ULONG i = 0; i < n; i++) {
+        u64 id = static_cast<u64>(entries[i].lpCompletionKey);
+        // Reset before the caller handles the wake-up, so a wake sent in the meantime is kept.
+        if(id == WAKE) woken.store(0);
+        ready[i] = id;
+    }
+    return n;
+}
+
 } // namespace rpp::Async
@@ -64,6 +64,68 @@ constexpr u64 SECTOR_SIZE = 4096;
     co_return Opt{rpp::move(data)};
 }
 
+[[nodiscard]] Task<Opt<u64>> read(Pool<>& pool, String_View path, u64 offset, u8* data,
+                                  u64 length) noexcept {
+
+    auto [ucs2_path, ucs2_path_len] = utf8_to_ucs2(path);
+    if(ucs2_path_len == 0) {
+        warn("Failed to convert file path %!", path);
+        co_return {};
+    }
+
+    // Buffered, since the caller's offset and buffer need not be sector aligned.
+    HANDLE handle = CreateFileW(ucs2_path, GENERIC_READ, FILE_SHARE_READ, null, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, null);
+    if(handle == INVALID_HANDLE_VALUE) {
+        warn("Failed to create file %: %", path, Log::sys_error());
+        co_return {};
+    }
+
+    u64 done = 0;
+    while(done < length) {
+        HANDLE event = CreateEventEx(null, null, 0, EVENT_ALL_ACCESS);
+        if(!event) {
+            warn("Failed to create event: %", Log::sys_error());
+            CloseHandle(handle);
+            co_return {};
+        }
+
+        u64 at = offset + done;
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = event;
+        overlapped.Offset = static_cast<DWORD>(at);
+        overlapped.OffsetHigh = static_cast<DWORD>(at >> 32);
+
+        DWORD chunk = static_cast<DWORD>(Math::min<u64>(length - done, RPP_UINT32_MAX));
+        BOOL ret = ReadFile(handle, data + done, chunk, null, &overlapped);
+        if(ret == FALSE && GetLastError() != ERROR_IO_PENDING) {
+            if(GetLastError() == ERROR_HANDLE_EOF) {
+                CloseHandle(event);
+                break;
+            }
+            warn("Failed to initiate async read of file %: %", path, Log::sys_error());
+            CloseHandle(event);
+            CloseHandle(handle);
+            co_return {};
+        }
+
+        co_await pool.event(Event::of_sys(event));
+
+        DWORD read = 0;
+        if(GetOverlappedResult(handle, &overlapped, &read, FALSE) == FALSE) {
+            if(GetLastError() == ERROR_HANDLE_EOF) break;
+            warn("Failed to read file %: %", path, Log::sys_error());
+            CloseHandle(handle);
+            co_return {};
+        }
+        if(read == 0) break;
+        done += read;
+    }
+
+    CloseHandle(handle);
+    co_return Opt{done};
+}
+
 [[nodiscard]] Task<bool> write(Pool<>& pool, String_View path, Slice<u8> data) noexcept {
 
     auto [ucs2_path, ucs2_path_len] = utf8_to_ucs2(path);
@@ -127,26 +189,4 @@ constexpr u64 SECTOR_SIZE = 4096;
     co_return true;
 }
 
-[[nodiscard]] Task<void> wait(Pool<>& pool, u64 ms) noexcept {
-
-    HANDLE timer = CreateWaitableTimer(NULL, TRUE, NULL);
-    if(timer == INVALID_HANDLE_VALUE) {
-        warn("Failed to create waitable timer: %", Log::sys_error());
-        co_return;
-    }
-
-    LARGE_INTEGER liDueTime;
-    liDueTime.QuadPart = -static_cast<LONGLONG>(ms * 10000);
-
-    if(SetWaitableTimer(timer, &liDueTime, 0, NULL, NULL, 0) == FALSE) {
-        warn("Failed to set waitable timer: %", Log::sys_error());
-        CloseHandle(timer);
-        co_return;
-    }
-
-    co_await pool.event(Event::of_sys(timer));
-
-    co_return;
-}
-
 } // namespace rpp::Async
@@ -0,0 +1,21 @@
+
+#include <windows.h>
+
+namespace rpp {
+
+// Reading other counters on Windows requires a kernel-mode ETW session, so only the thread's
+// cycle time is reported.
+[[nodiscard]] bool Profile::open_counters() noexcept {
+    return true;
+}
+
+void Profile::close_counters() noexcept {
+}
+
+[[nodiscard]] Profile::Counters Profile::read_counters() noexcept {
+    ULONG64 cycles = 0;
+    QueryThreadCycleTime(GetCurrentThread(), &cycles);
+    return Counters{static_cast<u64>(cycles), 0, 0, 0};
+}
+
+} // namespace rpp
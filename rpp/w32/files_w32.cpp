@@ -25,6 +25,21 @@ namespace rpp::Files {
                static_cast<u64>(attrib.ftLastWriteTime.dwLowDateTime)};
 }
 
+[[nodiscard]] bool remove(String_View path) noexcept {
+
+    auto [ucs2_path, ucs2_path_len] = utf8_to_ucs2(path);
+    if(ucs2_path_len == 0) {
+        warn("Failed to convert file path %!", path);
+        return false;
+    }
+
+    if(DeleteFileW(ucs2_path) == 0) {
+        warn("Failed to remove file %: %", path, Log::sys_error());
+        return false;
+    }
+    return true;
+}
+
 [[nodiscard]] bool before(const File_Time& first, const File_Time& second) noexcept {
     FILETIME f, s;
     f.dwLowDateTime = static_cast<u32>(first);
@@ -34,34 +49,62 @@ namespace rpp::Files {
     return CompareFileTime(&f, &s) == -1;
 }
 
-[[nodiscard]] Opt<Vec<u8, Alloc>> read(String_View path) noexcept {
+[[nodiscard]] static HANDLE open_read(String_View path) noexcept {
 
     auto [ucs2_path, ucs2_path_len] = utf8_to_ucs2(path);
     if(ucs2_path_len == 0) {
         warn("Failed to convert file path %!", path);
-        return {};
+        return INVALID_HANDLE_VALUE;
     }
 
     HANDLE handle = CreateFileW(ucs2_path, GENERIC_READ, FILE_SHARE_READ, null, OPEN_EXISTING,
                                 FILE_ATTRIBUTE_NORMAL, null);
     if(handle == INVALID_HANDLE_VALUE) {
         warn("Failed to create file %: %", path, Log::sys_error());
-        return {};
     }
+    return handle;
+}
+
+// ReadFile takes a 32 bit length and may return short, so read in a loop until EOF.
+[[nodiscard]] static Opt<u64> read_at(HANDLE handle, u64 offset, u8* data, u64 length) noexcept {
+    u64 done = 0;
+    while(done < length) {
+        u64 at = offset + done;
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(at);
+        overlapped.OffsetHigh = static_cast<DWORD>(at >> 32);
+
+        DWORD chunk = static_cast<DWORD>(Math::min<u64>(length - done, RPP_UINT32_MAX));
+        DWORD read = 0;
+        if(ReadFile(handle, data + done, chunk, &read, &overlapped) == FALSE) {
+            if(GetLastError() == ERROR_HANDLE_EOF) break;
+            return {};
+        }
+        if(read == 0) break;
+        done += read;
+    }
+    return Opt{done};
+}
+
+[[nodiscard]] Opt<Vec<u8, Alloc>> read(String_View path) noexcept {
+
+    HANDLE handle = open_read(path);
+    if(handle == INVALID_HANDLE_VALUE) return {};
 
     LARGE_INTEGER full_size;
     if(GetFileSizeEx(handle, &full_size) == FALSE) {
         warn("Failed to size file %: %", path, Log::sys_error());
+        CloseHandle(handle);
         return {};
     }
 
     u64 size = static_cast<u64>(full_size.QuadPart);
-    assert(size <= RPP_UINT32_MAX);
 
     Vec<u8, Alloc> data(size);
     data.resize(size);
 
-    if(ReadFile(handle, data.data(), static_cast<u32>(size), null, null) == FALSE) {
+    Opt<u64> read = read_at(handle, 0, data.data(), size);
+    if(!read.ok()) {
         warn("Failed to read file %: %", path, Log::sys_error());
         CloseHandle(handle);
         return {};
@@ -69,10 +112,173 @@ namespace rpp::Files {
 
     CloseHandle(handle);
 
+    data.resize(*read);
     return Opt{rpp::move(data)};
 }
 
+[[nodiscard]] Opt<u64> read(String_View path, u64 offset, u8* data, u64 length) noexcept {
+
+    HANDLE handle = open_read(path);
+    if(handle == INVALID_HANDLE_VALUE) return {};
+
+    Opt<u64> read = read_at(handle, offset, data, length);
+    if(!read.ok()) {
+        warn("Failed to read file %: %", path, Log::sys_error());
+    }
+
+    CloseHandle(handle);
+    return read;
+}
+
+[[nodiscard]] Opt<Reader> Reader::open(String_View path) noexcept {
+
+    HANDLE handle = open_read(path);
+    if(handle == INVALID_HANDLE_VALUE) return {};
+
+    LARGE_INTEGER full_size;
+    if(GetFileSizeEx(handle, &full_size) == FALSE) {
+        warn("Failed to size file %: %", path, Log::sys_error());
+        CloseHandle(handle);
+        return {};
+    }
+
+    Reader reader;
+    reader.handle = reinterpret_cast<void*>(handle);
+    reader.size_ = static_cast<u64>(full_size.QuadPart);
+    return Opt{rpp::move(reader)};
+}
+
+Reader::~Reader() noexcept {
+    if(handle) CloseHandle(reinterpret_cast<HANDLE>(handle));
+    handle = null;
+    size_ = 0;
+    offset_ = 0;
+}
+
+Reader::Reader(Reader&& src) noexcept
+    : handle{src.handle}, size_{src.size_}, offset_{src.offset_} {
+    src.handle = null;
+    src.size_ = 0;
+    src.offset_ = 0;
+}
+
+Reader& Reader::operator=(Reader&& src) noexcept {
+    this->~Reader();
+    handle = src.handle;
+    size_ = src.size_;
+    offset_ = src.offset_;
+    src.handle = null;
+    src.size_ = 0;
+    src.offset_ = 0;
+    return *this;
+}
+
+[[nodiscard]] Opt<Slice<u8>> Reader::next(u8* data, u64 length) noexcept {
+    assert(handle);
+    Opt<u64> read = read_at(reinterpret_cast<HANDLE>(handle), offset_, data, length);
+    if(!read.ok()) {
+        warn("Failed to read file: %", Log::sys_error());
+        return {};
+    }
+    offset_ += *read;
+    return Opt{Slice<u8>{data, *read}};
+}
+
+[[nodiscard]] Opt<Mapping> Mapping::open(String_View path, Access access) noexcept {
+
+    HANDLE handle = open_read(path);
+    if(handle == INVALID_HANDLE_VALUE) return {};
+
+    LARGE_INTEGER full_size;
+    if(GetFileSizeEx(handle, &full_size) == FALSE) {
+        warn("Failed to size file %: %", path, Log::sys_error());
+        CloseHandle(handle);
+        return {};
+    }
+
+    Mapping mapping;
+    mapping.access_ = access;
+    mapping.length_ = static_cast<u64>(full_size.QuadPart);
+
+    // Empty files can't be mapped.
+    if(mapping.length_ == 0) {
+        CloseHandle(handle);
+        return Opt{rpp::move(mapping)};
+    }
+
+    DWORD protect = access == Access::read ? PAGE_READONLY : PAGE_WRITECOPY;
+    HANDLE file_mapping = CreateFileMappingW(handle, null, protect, 0, 0, null);
+    CloseHandle(handle);
+    if(!file_mapping) {
+        warn("Failed to create mapping of file %: %", path, Log::sys_error());
+        return {};
+    }
+
+    // The view keeps the file and mapping object alive once their handles are closed.
+    DWORD view_access = access == Access::read ? FILE_MAP_READ : FILE_MAP_COPY;
+    void* data = MapViewOfFile(file_mapping, view_access, 0, 0, 0);
+    CloseHandle(file_mapping);
+    if(!data) {
+        warn("Failed to map view of file %: %", path, Log::sys_error());
+        return {};
+    }
+
+    mapping.data_ = reinterpret_cast<u8*>(data);
+    return Opt{rpp::move(mapping)};
+}
+
+Mapping::~Mapping() noexcept {
+    if(data_) {
+        BOOL ret = UnmapViewOfFile(data_);
+        assert(ret);
+    }
+    data_ = null;
+    length_ = 0;
+}
+
+Mapping::Mapping(Mapping&& src) noexcept
+    : data_{src.data_}, length_{src.length_}, access_{src.access_} {
+    src.data_ = null;
+    src.length_ = 0;
+}
+
+Mapping& Mapping::operator=(Mapping&& src) noexcept {
+    this->~Mapping();
+    data_ = src.data_;
+    length_ = src.length_;
+    access_ = src.access_;
+    src.data_ = null;
+    src.length_ = 0;
+    return *this;
+}
+
+// Windows has no access pattern hints for views, only prefetching and trimming.
+void Mapping::advise(Advice advice) noexcept {
+    if(!data_) return;
+    if(advice == Advice::will_need) {
+        prefetch(0, length_);
+    } else if(advice == Advice::dont_need) {
+        // Unlocking pages that aren't locked removes them from the working set.
+        static_cast<void>(VirtualUnlock(data_, length_));
+    }
+}
+
+void Mapping::prefetch(u64 offset, u64 length) noexcept {
+    if(!data_ || offset >= length_) return;
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = data_ + offset;
+    range.NumberOfBytes = Math::min(length, length_ - offset);
+    if(PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) == FALSE) {
+        warn("Failed to prefetch mapping: %", Log::sys_error());
+    }
+}
+
 [[nodiscard]] bool write(String_View path, Slice<u8> data) noexcept {
+    return write(path, Slice<Slice<u8>>{&data, 1});
+}
+
+// WriteFileGather needs page sized buffers and unbuffered handles, so write each buffer in turn.
+[[nodiscard]] bool write(String_View path, Slice<Slice<u8>> buffers) noexcept {
 
     auto [ucs2_path, ucs2_path_len] = utf8_to_ucs2(path);
     if(ucs2_path_len == 0) {
@@ -87,12 +293,19 @@ namespace rpp::Files {
         return false;
     }
 
-    assert(data.length() <= RPP_UINT32_MAX);
-
-    if(WriteFile(handle, data.data(), static_cast<u32>(data.length()), null, null) == FALSE) {
-        warn("Failed to write file %: %", path, Log::sys_error());
-        CloseHandle(handle);
-        return false;
+    for(Slice<u8> buffer : buffers) {
+        u64 done = 0;
+        while(done < buffer.length()) {
+            u64 length = Math::min(buffer.length() - done, u64{RPP_UINT32_MAX});
+            DWORD written = 0;
+            if(WriteFile(handle, buffer.data() + done, static_cast<DWORD>(length), &written,
+                         null) == FALSE) {
+                warn("Failed to write file %: %", path, Log::sys_error());
+                CloseHandle(handle);
+                return false;
+            }
+            done += written;
+        }
     }
 
     CloseHandle(handle);
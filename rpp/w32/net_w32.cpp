@@ -1,4 +1,5 @@
 
+#include "../async.h"
 #include "../net.h"
 
 #include <windows.h>
@@ -44,20 +45,42 @@ struct WSA_Startup {
 
 static WSA_Startup g_wsa_startup;
 
-static_assert(sizeof(sockaddr_in) == 16);
-static_assert(alignof(sockaddr_in) == 4);
+static_assert(sizeof(sockaddr_in6) == 28);
+static_assert(alignof(sockaddr_in6) <= 4);
+
+[[nodiscard]] static sockaddr_in& v4(u8* storage) noexcept {
+    return *reinterpret_cast<sockaddr_in*>(storage);
+}
+[[nodiscard]] static const sockaddr_in& v4(const u8* storage) noexcept {
+    return *reinterpret_cast<const sockaddr_in*>(storage);
+}
+[[nodiscard]] static sockaddr_in6& v6(u8* storage) noexcept {
+    return *reinterpret_cast<sockaddr_in6*>(storage);
+}
+[[nodiscard]] static const sockaddr_in6& v6(const u8* storage) noexcept {
+    return *reinterpret_cast<const sockaddr_in6*>(storage);
+}
 
 Address::Address(String_View address_, u16 port) noexcept {
-    Region(R) {
-        auto address = address_.terminate<Mregion<R>>();
+    Libc::memset(sockaddr_storage, 0, sizeof(sockaddr_storage));
 
-        sockaddr_in& sockaddr_ = *reinterpret_cast<sockaddr_in*>(sockaddr_storage);
-        sockaddr_ = {};
-        sockaddr_.sin_family = AF_INET;
-        sockaddr_.sin_port = htons(port);
+    bool ipv6 = false;
+    for(u8 c : address_) ipv6 = ipv6 || c == ':';
 
-        int ret = inet_pton(AF_INET, reinterpret_cast<const char*>(address.data()),
-                            &sockaddr_.sin_addr.s_addr);
+    Region(R) {
+        auto address = address_.terminate<Mregion<R>>();
+        const char* text = reinterpret_cast<const char*>(address.data());
+
+        int ret = 0;
+        if(ipv6) {
+            v6(sockaddr_storage).sin6_family = AF_INET6;
+            v6(sockaddr_storage).sin6_port = htons(port);
+            ret = inet_pton(AF_INET6, text, &v6(sockaddr_storage).sin6_addr);
+        } else {
+            v4(sockaddr_storage).sin_family = AF_INET;
+            v4(sockaddr_storage).sin_port = htons(port);
+            ret = inet_pton(AF_INET, text, &v4(sockaddr_storage).sin_addr.s_addr);
+        }
 
         if(ret == 0) {
             warn("Failed to create address: Invalid address.");
@@ -68,20 +91,72 @@ Address::Address(String_View address_, u16 port) noexcept {
     }
 }
 
-Address::Address(u16 port) noexcept {
-    sockaddr_in& sockaddr_ = *reinterpret_cast<sockaddr_in*>(sockaddr_storage);
-    sockaddr_ = {};
-    sockaddr_.sin_family = AF_INET;
-    sockaddr_.sin_port = htons(port);
-    sockaddr_.sin_addr.s_addr = INADDR_ANY;
+Address::Address(u16 port, Family family) noexcept {
+    Libc::memset(sockaddr_storage, 0, sizeof(sockaddr_storage));
+    if(family == Family::ipv6) {
+        v6(sockaddr_storage).sin6_family = AF_INET6;
+        v6(sockaddr_storage).sin6_port = htons(port);
+        v6(sockaddr_storage).sin6_addr = in6addr_any;
+    } else {
+        v4(sockaddr_storage).sin_family = AF_INET;
+        v4(sockaddr_storage).sin_port = htons(port);
+        v4(sockaddr_storage).sin_addr.s_addr = INADDR_ANY;
+    }
 }
 
-Udp::Udp() noexcept {
+[[nodiscard]] Family Address::family() const noexcept {
+    return v4(sockaddr_storage).sin_family == AF_INET6 ? Family::ipv6 : Family::ipv4;
+}
+
+[[nodiscard]] u16 Address::port() const noexcept {
+    return ntohs(family() == Family::ipv6 ? v6(sockaddr_storage).sin6_port
+                                          : v4(sockaddr_storage).sin_port);
+}
 
-    socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+[[nodiscard]] bool Address::operator==(const Address& other) const noexcept {
+    if(family() != other.family() || port() != other.port()) return false;
+    if(family() == Family::ipv6) {
+        const sockaddr_in6& a = v6(sockaddr_storage);
+        const sockaddr_in6& b = v6(other.sockaddr_storage);
+        return a.sin6_scope_id == b.sin6_scope_id &&
+               Libc::memcmp(&a.sin6_addr, &b.sin6_addr, sizeof(in6_addr)) == 0;
+    }
+    return v4(sockaddr_storage).sin_addr.s_addr == v4(other.sockaddr_storage).sin_addr.s_addr;
+}
+
+[[nodiscard]] u32 Address::length() const noexcept {
+    return family() == Family::ipv6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+}
+
+[[nodiscard]] Address Address::to_ipv6() const noexcept {
+    if(family() == Family::ipv6) return *this;
+    Address mapped;
+    Libc::memset(mapped.sockaddr_storage, 0, sizeof(mapped.sockaddr_storage));
+    sockaddr_in6& to = v6(mapped.sockaddr_storage);
+    to.sin6_family = AF_INET6;
+    to.sin6_port = v4(sockaddr_storage).sin_port;
+    to.sin6_addr.s6_addr[10] = 0xff;
+    to.sin6_addr.s6_addr[11] = 0xff;
+    Libc::memcpy(&to.sin6_addr.s6_addr[12], &v4(sockaddr_storage).sin_addr.s_addr, 4);
+    return mapped;
+}
+
+// IPv6 sockets are created dual-stack.
+static void clear_v6only(u64 socket) noexcept {
+    DWORD zero = 0;
+    if(setsockopt(socket, IPPROTO_IPV6, IPV6_V6ONLY, reinterpret_cast<const char*>(&zero),
+                  sizeof(zero)) == SOCKET_ERROR) {
+        warn("Failed to clear IPV6_V6ONLY: %", wsa_error());
+    }
+}
+
+Udp::Udp(Family family_) noexcept : family{family_} {
+
+    socket = ::socket(family == Family::ipv6 ? AF_INET6 : AF_INET, SOCK_DGRAM, IPPROTO_UDP);
     if(socket == INVALID_SOCKET) {
         die("Failed to open socket: %", wsa_error());
     }
+    if(family == Family::ipv6) clear_v6only(socket);
 
     u_long imode = 1;
     if(ioctlsocket(socket, FIONBIO, &imode) != NO_ERROR) {
@@ -99,48 +174,290 @@ Udp::~Udp() noexcept {
 Udp::Udp(Udp&& src) noexcept {
     socket = src.socket;
     src.socket = INVALID_SOCKET;
+    family = src.family;
 }
 
 Udp& Udp::operator=(Udp&& src) noexcept {
     socket = src.socket;
     src.socket = INVALID_SOCKET;
+    family = src.family;
     return *this;
 }
 
 void Udp::bind(Address address) noexcept {
 
-    if(::bind(socket, reinterpret_cast<SOCKADDR*>(address.sockaddr_storage), sizeof(sockaddr_in)) ==
-       SOCKET_ERROR) {
+    address = target(address);
+    if(::bind(socket, reinterpret_cast<SOCKADDR*>(address.sockaddr_storage),
+              static_cast<i32>(address.length())) == SOCKET_ERROR) {
         die("Failed to bind socket: %", wsa_error());
     }
 }
 
 [[nodiscard]] Opt<Udp::Data> Udp::recv(Packet& in) noexcept {
 
-    sockaddr_in src;
+    Address src;
 
-    i32 src_len = sizeof(src);
+    i32 src_len = sizeof(src.sockaddr_storage);
     i32 ret = recvfrom(socket, reinterpret_cast<char*>(in.data()), static_cast<i32>(in.length()), 0,
-                       reinterpret_cast<SOCKADDR*>(&src), &src_len);
+                       reinterpret_cast<SOCKADDR*>(src.sockaddr_storage), &src_len);
     if(ret == SOCKET_ERROR) {
         return {};
     }
 
-    Address retaddr;
-    *reinterpret_cast<sockaddr_in*>(retaddr.sockaddr_storage) = src;
-
-    return Opt{Data{static_cast<u64>(ret), rpp::move(retaddr)}};
+    return Opt{Data{static_cast<u64>(ret), rpp::move(src)}};
 }
 
 [[nodiscard]] u64 Udp::send(Address address, const Packet& out, u64 length) noexcept {
 
-    i32 ret =
-        sendto(socket, reinterpret_cast<const char*>(out.data()), static_cast<i32>(length), 0,
-               reinterpret_cast<const SOCKADDR*>(address.sockaddr_storage), sizeof(sockaddr_in));
+    address = target(address);
+    i32 ret = sendto(socket, reinterpret_cast<const char*>(out.data()), static_cast<i32>(length),
+                     0, reinterpret_cast<const SOCKADDR*>(address.sockaddr_storage),
+                     static_cast<i32>(address.length()));
     if(ret == SOCKET_ERROR) {
         warn("Failed send packet: %", wsa_error());
     }
     return ret;
 }
 
+[[nodiscard]] Opt<u64> Udp::try_send(Address address, const Packet& out, u64 length) noexcept {
+
+    address = target(address);
+    i32 ret = sendto(socket, reinterpret_cast<const char*>(out.data()), static_cast<i32>(length),
+                     0, reinterpret_cast<const SOCKADDR*>(address.sockaddr_storage),
+                     static_cast<i32>(address.length()));
+    if(ret == SOCKET_ERROR) {
+        if(WSAGetLastError() == WSAEWOULDBLOCK) return {};
+        warn("Failed send packet: %", wsa_error());
+        return Opt<u64>{0};
+    }
+    return Opt{static_cast<u64>(ret)};
+}
+
+// Selecting a new event replaces the socket's previous association, hence one live event.
+[[nodiscard]] static Async::Event select_event(u64 socket, long events) noexcept {
+    HANDLE event = CreateEventEx(null, null, CREATE_EVENT_MANUAL_RESET, EVENT_ALL_ACCESS);
+    if(!event) {
+        die("Failed to create event: %", Log::sys_error());
+    }
+    if(WSAEventSelect(socket, event, events) == SOCKET_ERROR) {
+        die("Failed to select socket event: %", wsa_error());
+    }
+    return Async::Event::of_sys(reinterpret_cast<void*>(event));
+}
+
+[[nodiscard]] Async::Event Udp::readable() const noexcept {
+    return select_event(socket, FD_READ);
+}
+
+[[nodiscard]] Async::Event Udp::writable() const noexcept {
+    return select_event(socket, FD_WRITE);
+}
+
+[[nodiscard]] u64 Udp::send(Slice<Packet> out, Slice<Message> messages) noexcept {
+    assert(out.length() == messages.length());
+    for(u64 i = 0; i < out.length(); i++) {
+        static_cast<void>(send(messages[i].to, out[i], messages[i].length));
+    }
+    return out.length();
+}
+
+[[nodiscard]] u64 Udp::recv(Packet* in, Data* data, u64 count) noexcept {
+    u64 received = 0;
+    for(; received < count; received++) {
+        Opt<Data> next = recv(in[received]);
+        if(!next.ok()) break;
+        data[received] = rpp::move(*next);
+    }
+    return received;
+}
+
+// Windows does not balance datagrams between sockets sharing a port, so a group is one socket.
+Udp_Group::Udp_Group(Address address, u64 count, bool) noexcept {
+    assert(count > 0);
+    sockets.push(Udp{address.family()}).bind(address);
+}
+
+constexpr u64 WSABUF_BATCH = 64;
+
+[[nodiscard]] static u64 open_tcp(Family family) noexcept {
+    u64 socket = ::socket(family == Family::ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if(socket == INVALID_SOCKET) return INVALID_SOCKET;
+
+    u_long imode = 1;
+    if(ioctlsocket(socket, FIONBIO, &imode) != NO_ERROR) {
+        closesocket(socket);
+        return INVALID_SOCKET;
+    }
+    return socket;
+}
+
+Tcp_Stream::~Tcp_Stream() noexcept {
+    if(socket != INVALID_SOCKET) {
+        closesocket(socket);
+    }
+    socket = INVALID_SOCKET;
+}
+
+Tcp_Stream::Tcp_Stream(Tcp_Stream&& src) noexcept {
+    socket = src.socket;
+    src.socket = INVALID_SOCKET;
+}
+
+Tcp_Stream& Tcp_Stream::operator=(Tcp_Stream&& src) noexcept {
+    if(socket != INVALID_SOCKET) closesocket(socket);
+    socket = src.socket;
+    src.socket = INVALID_SOCKET;
+    return *this;
+}
+
+[[nodiscard]] Opt<Tcp_Stream> Tcp_Stream::connect(Address address) noexcept {
+    Tcp_Stream stream;
+    stream.socket = open_tcp(address.family());
+    if(stream.socket == INVALID_SOCKET) {
+        warn("Failed to open socket: %", wsa_error());
+        return {};
+    }
+
+    if(::connect(stream.socket, reinterpret_cast<const SOCKADDR*>(address.sockaddr_storage),
+                 static_cast<i32>(address.length())) == SOCKET_ERROR &&
+       WSAGetLastError() != WSAEWOULDBLOCK) {
+        warn("Failed to connect socket: %", wsa_error());
+        return {};
+    }
+    return Opt{rpp::move(stream)};
+}
+
+[[nodiscard]] bool Tcp_Stream::finish_connect() noexcept {
+    int error = 0;
+    int length = sizeof(error);
+    if(getsockopt(socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length) ==
+       SOCKET_ERROR) {
+        warn("Failed to query socket: %", wsa_error());
+        return false;
+    }
+    if(error != 0) {
+        warn("Failed to connect socket: %", wsa_error_code(error));
+        return false;
+    }
+    return true;
+}
+
+void Tcp_Stream::set_nodelay(bool enable) noexcept {
+    BOOL value = enable ? TRUE : FALSE;
+    if(setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&value),
+                  sizeof(value)) == SOCKET_ERROR) {
+        warn("Failed to set TCP_NODELAY: %", wsa_error());
+    }
+}
+
+[[nodiscard]] Opt<u64> Tcp_Stream::read(u8* data, u64 length) noexcept {
+    i32 ret = ::recv(socket, reinterpret_cast<char*>(data),
+                     static_cast<i32>(Math::min(length, u64{0x7fffffff})), 0);
+    if(ret == SOCKET_ERROR) {
+        if(WSAGetLastError() == WSAEWOULDBLOCK) return {};
+        warn("Failed to read socket: %", wsa_error());
+        return Opt<u64>{0};
+    }
+    return Opt{static_cast<u64>(ret)};
+}
+
+[[nodiscard]] Opt<u64> Tcp_Stream::write(Slice<Slice<u8>> buffers, u64 offset) noexcept {
+    WSABUF bufs[WSABUF_BATCH];
+    u64 n = 0;
+    for(u64 i = 0; i < buffers.length() && n < WSABUF_BATCH; i++) {
+        Slice<u8> buffer = buffers[i];
+        if(offset >= buffer.length()) {
+            offset -= buffer.length();
+            continue;
+        }
+        bufs[n].buf = reinterpret_cast<char*>(const_cast<u8*>(buffer.data() + offset));
+        bufs[n].len = static_cast<ULONG>(Math::min(buffer.length() - offset, u64{0x7fffffff}));
+        offset = 0;
+        n++;
+    }
+    if(n == 0) return Opt<u64>{0};
+
+    DWORD sent = 0;
+    if(WSASend(socket, bufs, static_cast<DWORD>(n), &sent, 0, null, null) == SOCKET_ERROR) {
+        if(WSAGetLastError() == WSAEWOULDBLOCK) return {};
+        warn("Failed to write socket: %", wsa_error());
+        return Opt<u64>{0};
+    }
+    return Opt{static_cast<u64>(sent)};
+}
+
+[[nodiscard]] Async::Event Tcp_Stream::readable() const noexcept {
+    return select_event(socket, FD_READ | FD_CLOSE);
+}
+
+[[nodiscard]] Async::Event Tcp_Stream::writable() const noexcept {
+    // FD_CONNECT also reports failed connection attempts.
+    return select_event(socket, FD_WRITE | FD_CONNECT | FD_CLOSE);
+}
+
+Tcp_Listener::Tcp_Listener(Address address) noexcept {
+    socket = open_tcp(address.family());
+    if(socket == INVALID_SOCKET) {
+        die("Failed to open socket: %", wsa_error());
+    }
+    if(address.family() == Family::ipv6) clear_v6only(socket);
+
+    BOOL exclusive = TRUE;
+    if(setsockopt(socket, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, reinterpret_cast<const char*>(&exclusive),
+                  sizeof(exclusive)) == SOCKET_ERROR) {
+        warn("Failed to set SO_EXCLUSIVEADDRUSE: %", wsa_error());
+    }
+    if(::bind(socket, reinterpret_cast<SOCKADDR*>(address.sockaddr_storage),
+              static_cast<i32>(address.length())) == SOCKET_ERROR) {
+        die("Failed to bind socket: %", wsa_error());
+    }
+    if(listen(socket, SOMAXCONN) == SOCKET_ERROR) {
+        die("Failed to listen on socket: %", wsa_error());
+    }
+}
+
+Tcp_Listener::~Tcp_Listener() noexcept {
+    if(socket != INVALID_SOCKET) {
+        closesocket(socket);
+    }
+    socket = INVALID_SOCKET;
+}
+
+Tcp_Listener::Tcp_Listener(Tcp_Listener&& src) noexcept {
+    socket = src.socket;
+    src.socket = INVALID_SOCKET;
+}
+
+Tcp_Listener& Tcp_Listener::operator=(Tcp_Listener&& src) noexcept {
+    if(socket != INVALID_SOCKET) closesocket(socket);
+    socket = src.socket;
+    src.socket = INVALID_SOCKET;
+    return *this;
+}
+
+[[nodiscard]] Opt<Tcp_Stream> Tcp_Listener::accept() noexcept {
+    u64 client = ::accept(socket, null, null);
+    if(client == INVALID_SOCKET) {
+        if(WSAGetLastError() != WSAEWOULDBLOCK) {
+            warn("Failed to accept connection: %", wsa_error());
+        }
+        return {};
+    }
+
+    // Accepted sockets inherit the listener's event selection, so clear it before use.
+    Tcp_Stream stream;
+    stream.socket = client;
+    u_long imode = 1;
+    if(WSAEventSelect(client, null, 0) == SOCKET_ERROR ||
+       ioctlsocket(client, FIONBIO, &imode) != NO_ERROR) {
+        warn("Failed to configure socket: %", wsa_error());
+        return {};
+    }
+    return Opt{rpp::move(stream)};
+}
+
+[[nodiscard]] Async::Event Tcp_Listener::readable() const noexcept {
+    return select_event(socket, FD_ACCEPT);
+}
+
 } // namespace rpp::Net
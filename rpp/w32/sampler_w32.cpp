@@ -0,0 +1,81 @@
+
+#include <windows.h>
+
+namespace rpp {
+
+static HANDLE g_sampler_thread = null;
+static HANDLE g_sampler_stop = null;
+static DWORD g_sampler_interval = 0;
+
+[[nodiscard]] static u64 suspended_pc(HANDLE thread) noexcept {
+    alignas(16) CONTEXT context = {};
+    context.ContextFlags = CONTEXT_CONTROL;
+    if(!GetThreadContext(thread, &context)) return 0;
+#ifdef RPP_ARCH_X64
+    return static_cast<u64>(context.Rip);
+#elif defined RPP_ARCH_ARM64
+    return static_cast<u64>(context.Pc);
+#else
+    return 0;
+#endif
+}
+
+[[nodiscard]] bool Profile::Sampler::start_timer(u64 hz) noexcept {
+    g_sampler_stop = CreateEventA(null, true, false, null);
+    if(!g_sampler_stop) {
+        warn("Failed to create sampler event: %", Log::sys_error());
+        return false;
+    }
+
+    g_sampler_interval = static_cast<DWORD>(Math::max(u64{1}, 1000 / hz));
+
+    auto sample = [](LPVOID) -> DWORD {
+        while(WaitForSingleObject(g_sampler_stop, g_sampler_interval) == WAIT_TIMEOUT) {
+            Thread::Lock lock(rings_lock);
+            for(Sample_Ring* ring = rings; ring; ring = ring->next) {
+                if(!ring->stack) {
+                    if(ring->handle) CloseHandle(ring->handle);
+                    ring->handle = null;
+                    continue;
+                }
+                if(!ring->handle) {
+                    ring->handle = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT, false,
+                                              static_cast<DWORD>(ring->thread));
+                    if(!ring->handle) continue;
+                }
+                // Only record_sample runs while the thread is suspended: it must not lock or
+                // allocate, as the thread may hold the heap lock.
+                if(SuspendThread(ring->handle) == static_cast<DWORD>(-1)) continue;
+                record_sample(*ring->stack, suspended_pc(ring->handle));
+                ResumeThread(ring->handle);
+            }
+        }
+        return 0;
+    };
+
+    g_sampler_thread = CreateThread(null, 0, sample, null, 0, null);
+    if(!g_sampler_thread) {
+        warn("Failed to create sampler thread: %", Log::sys_error());
+        CloseHandle(g_sampler_stop);
+        g_sampler_stop = null;
+        return false;
+    }
+    return true;
+}
+
+void Profile::Sampler::stop_timer() noexcept {
+    SetEvent(g_sampler_stop);
+    WaitForSingleObject(g_sampler_thread, INFINITE);
+    CloseHandle(g_sampler_thread);
+    CloseHandle(g_sampler_stop);
+    g_sampler_thread = null;
+    g_sampler_stop = null;
+
+    Thread::Lock lock(rings_lock);
+    for(Sample_Ring* ring = rings; ring; ring = ring->next) {
+        if(ring->handle) CloseHandle(ring->handle);
+        ring->handle = null;
+    }
+}
+
+} // namespace rpp
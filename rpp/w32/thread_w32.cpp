@@ -41,9 +41,7 @@ void pause() noexcept {
 }
 
 [[nodiscard]] u64 hardware_threads() noexcept {
-    SYSTEM_INFO info;
-    GetNativeSystemInfo(&info);
-    return static_cast<u64>(info.dwNumberOfProcessors);
+    return static_cast<u64>(GetActiveProcessorCount(ALL_PROCESSOR_GROUPS));
 }
 
 void set_priority(Priority p) noexcept {
@@ -61,21 +59,78 @@ void set_priority(Priority p) noexcept {
     }
 }
 
+// Processor indices count through the processor groups in order.
 void set_affinity(u64 core) noexcept {
     assert(core < hardware_threads());
-    if(core >= 64) {
-        warn("Can't set affinity for more than 64 cores!");
-        return;
+    u64 bit = core;
+    WORD group = 0;
+    for(WORD groups = GetActiveProcessorGroupCount(); group + 1 < groups; group++) {
+        u64 count = GetActiveProcessorCount(group);
+        if(bit < count) break;
+        bit -= count;
     }
-    DWORD_PTR mask = 1ll << core;
-    DWORD_PTR ret = SetThreadAffinityMask(GetCurrentThread(), mask);
-    if(!ret) {
+    GROUP_AFFINITY affinity = {};
+    affinity.Mask = static_cast<KAFFINITY>(1) << bit;
+    affinity.Group = group;
+    if(!SetThreadGroupAffinity(GetCurrentThread(), &affinity, null)) {
         warn("Failed to set thread affinity to %: %", core, Log::sys_error());
     }
 }
 
-static_assert(sizeof(SRWLOCK) == sizeof(void*));
-static_assert(sizeof(CONDITION_VARIABLE) == sizeof(void*));
+template<typename F>
+static void for_each_processor(const GROUP_AFFINITY& mask, F&& f) noexcept {
+    u64 base = 0;
+    for(WORD group = 0; group < mask.Group; group++) base += GetActiveProcessorCount(group);
+    for(u64 bit = 0; bit < 64; bit++) {
+        if((mask.Mask >> bit) & 1) f(base + bit);
+    }
+}
+
+[[nodiscard]] Vec<Processor, Alloc> topology() noexcept {
+    u64 n = hardware_threads();
+    auto ret = Vec<Processor, Alloc>::make(n);
+    for(u64 i = 0; i < n; i++) {
+        ret[i].index = i;
+        ret[i].core = i;
+    }
+
+    DWORD length = 0;
+    if(GetLogicalProcessorInformationEx(RelationAll, null, &length) ||
+       GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+        warn("Failed to query processor topology: %", Log::sys_error());
+        return ret;
+    }
+    u8* buffer = reinterpret_cast<u8*>(Alloc::alloc(length));
+    if(!GetLogicalProcessorInformationEx(
+           RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer),
+           &length)) {
+        warn("Failed to query processor topology: %", Log::sys_error());
+        Alloc::free(buffer);
+        return ret;
+    }
+
+    u64 core = 0;
+    for(DWORD offset = 0; offset < length;) {
+        auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer + offset);
+        if(info->Relationship == RelationProcessorCore) {
+            for(WORD g = 0; g < info->Processor.GroupCount; g++) {
+                for_each_processor(info->Processor.GroupMask[g], [&](u64 i) {
+                    if(i < n) ret[i].core = core;
+                });
+            }
+            core++;
+        } else if(info->Relationship == RelationNumaNode) {
+            u64 node = info->NumaNode.NodeNumber;
+            for_each_processor(info->NumaNode.GroupMask, [&](u64 i) {
+                if(i < n) ret[i].node = node;
+            });
+        }
+        offset += info->Size;
+    }
+    Alloc::free(buffer);
+    return ret;
+}
+
 static_assert(sizeof(HANDLE) == sizeof(OS_Thread));
 
 void Flag::block() noexcept {
@@ -97,68 +152,165 @@ void Flag::signal() noexcept {
     return value_ != 0;
 }
 
-Mutex::Mutex() noexcept {
-    InitializeSRWLock(reinterpret_cast<PSRWLOCK>(&lock_));
+void sys_wait(u32* address, u32 expected) noexcept {
+    if(!WaitOnAddress(address, &expected, sizeof(u32), INFINITE)) {
+        die("Failed to wait on address: %", Log::sys_error());
+    }
+}
+
+void sys_wake(u32* address, u32 count) noexcept {
+    if(count == 1) {
+        WakeByAddressSingle(address);
+    } else {
+        WakeByAddressAll(address);
+    }
+}
+
+[[nodiscard]] static volatile LONG* as_long(u32* value) noexcept {
+    return reinterpret_cast<volatile LONG*>(value);
+}
+
+[[nodiscard]] u32 Futex::load() const noexcept {
+    return static_cast<u32>(InterlockedCompareExchange(as_long(const_cast<u32*>(&value_)), 0, 0));
+}
+
+void Futex::wait(u32 expected) noexcept {
+    sys_wait(&value_, expected);
 }
 
-Mutex::~Mutex() noexcept {
-    lock_ = null;
+void Futex::incr_and_wake(u32 count) noexcept {
+    InterlockedIncrement(as_long(&value_));
+    sys_wake(&value_, count);
 }
 
+// Spinning only pays off while the owner is running, so give up once others have gone to sleep.
+constexpr u32 MUTEX_SPIN = 128;
+
 void Mutex::lock() noexcept {
-    AcquireSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&lock_));
+    if(InterlockedCompareExchangeAcquire(as_long(&state_), 1, 0) == 0) return;
+    for(u32 i = 0; i < MUTEX_SPIN; i++) {
+        LONG state = *as_long(&state_);
+        if(state == 2) break;
+        if(state == 0 && InterlockedCompareExchangeAcquire(as_long(&state_), 1, 0) == 0) return;
+        pause();
+    }
+    lock_contended();
+}
+
+void Mutex::lock_contended() noexcept {
+    while(InterlockedExchangeAcquire(as_long(&state_), 2) != 0) sys_wait(&state_, 2);
 }
 
 void Mutex::unlock() noexcept {
-    ReleaseSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&lock_));
+    if(InterlockedExchange(as_long(&state_), 0) == 2) sys_wake(&state_, 1);
 }
 
 [[nodiscard]] bool Mutex::try_lock() noexcept {
-    return TryAcquireSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&lock_));
+    return InterlockedCompareExchangeAcquire(as_long(&state_), 1, 0) == 0;
+}
+
+[[nodiscard]] static bool compare_and_swap(u32* value, u32 compare_with, u32 set_to) noexcept {
+    return static_cast<u32>(InterlockedCompareExchange(as_long(value), static_cast<LONG>(set_to),
+                                                       static_cast<LONG>(compare_with))) ==
+           compare_with;
+}
+
+void RwLock::lock_shared() noexcept {
+    for(u32 spins = 0;;) {
+        u32 state = static_cast<u32>(*as_long(&state_));
+        if(!(state & WRITER)) {
+            if(compare_and_swap(&state_, state, state + 1)) return;
+            continue;
+        }
+        if(spins++ < MUTEX_SPIN) {
+            pause();
+            continue;
+        }
+        if(!(state & SLEEPERS) && !compare_and_swap(&state_, state, state | SLEEPERS)) continue;
+        sys_wait(&state_, state | SLEEPERS);
+    }
 }
 
-[[nodiscard]] i64 Atomic::load() const noexcept {
-    return value_;
+void RwLock::unlock_shared() noexcept {
+    u32 state = static_cast<u32>(InterlockedDecrement(as_long(&state_)));
+    // The last reader out lets a draining writer in.
+    if((state & ~SLEEPERS) == WRITER) sys_wake(&state_, RPP_UINT32_MAX);
 }
 
-i64 Atomic::incr() noexcept {
-    return InterlockedIncrement64(&value_);
+[[nodiscard]] bool RwLock::try_lock_shared() noexcept {
+    for(;;) {
+        u32 state = static_cast<u32>(*as_long(&state_));
+        if(state & WRITER) return false;
+        if(compare_and_swap(&state_, state, state + 1)) return true;
+    }
 }
 
-i64 Atomic::decr() noexcept {
-    return InterlockedDecrement64(&value_);
+void RwLock::lock() noexcept {
+    writers.lock();
+    u32 state = static_cast<u32>(InterlockedOr(as_long(&state_), static_cast<LONG>(WRITER))) |
+                WRITER;
+    for(u32 spins = 0; state & READERS; spins++) {
+        if(spins < MUTEX_SPIN) {
+            pause();
+        } else {
+            sys_wait(&state_, state);
+        }
+        state = static_cast<u32>(*as_long(&state_));
+    }
 }
 
-i64 Atomic::exchange(i64 value) noexcept {
-    return InterlockedExchange64(&value_, value);
+void RwLock::unlock() noexcept {
+    u32 state = static_cast<u32>(InterlockedExchange(as_long(&state_), 0));
+    if(state & SLEEPERS) sys_wake(&state_, RPP_UINT32_MAX);
+    writers.unlock();
 }
 
-[[nodiscard]] i64 Atomic::compare_and_swap(i64 compare_with, i64 set_to) noexcept {
-    return InterlockedCompareExchange64(&value_, set_to, compare_with);
+[[nodiscard]] bool RwLock::try_lock() noexcept {
+    if(!writers.try_lock()) return false;
+    if(compare_and_swap(&state_, 0, WRITER)) return true;
+    writers.unlock();
+    return false;
 }
 
-Cond::Cond() noexcept {
-    InitializeConditionVariable(reinterpret_cast<PCONDITION_VARIABLE>(&cond_));
+[[nodiscard]] u32 Sequence::read_begin() const noexcept {
+    for(;;) {
+        u32 value = static_cast<u32>(*as_long(const_cast<u32*>(&value_)));
+        MemoryBarrier();
+        if(!(value & 1)) return value;
+        pause();
+    }
 }
 
-Cond::~Cond() noexcept {
-    cond_ = CONDITION_VARIABLE_INIT;
+[[nodiscard]] bool Sequence::read_retry(u32 begin) const noexcept {
+    // Keeps the reads of the protected data before the second load of the counter.
+    MemoryBarrier();
+    return static_cast<u32>(*as_long(const_cast<u32*>(&value_))) != begin;
+}
+
+void Sequence::write_begin() noexcept {
+    InterlockedIncrement(as_long(&value_));
+}
+
+void Sequence::write_end() noexcept {
+    InterlockedIncrement(as_long(&value_));
 }
 
 void Cond::wait(Mutex& mut) noexcept {
-    bool ret = SleepConditionVariableSRW(reinterpret_cast<PCONDITION_VARIABLE>(&cond_),
-                                         reinterpret_cast<PSRWLOCK>(&mut.lock_), INFINITE, 0);
-    if(!ret) {
-        die("Failed to wait on cond: %", Log::sys_error());
-    }
+    u32 sequence = static_cast<u32>(InterlockedCompareExchange(as_long(&sequence_), 0, 0));
+    mut.unlock();
+    sys_wait(&sequence_, sequence);
+    // Other waiters may have been woken along with us, so relock as contended.
+    mut.lock_contended();
 }
 
 void Cond::signal() noexcept {
-    WakeConditionVariable(reinterpret_cast<PCONDITION_VARIABLE>(&cond_));
+    InterlockedIncrement(as_long(&sequence_));
+    sys_wake(&sequence_, 1);
 }
 
 void Cond::broadcast() noexcept {
-    WakeAllConditionVariable(reinterpret_cast<PCONDITION_VARIABLE>(&cond_));
+    InterlockedIncrement(as_long(&sequence_));
+    sys_wake(&sequence_, RPP_UINT32_MAX);
 }
 
 [[nodiscard]] Id sys_id(OS_Thread thread_) noexcept {
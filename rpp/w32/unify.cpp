@@ -1,7 +1,11 @@
+#include "alloc_w32.cpp"
 
 #include "async_w32.cpp"
 #include "asyncio_w32.cpp"
+#include "counters_w32.cpp"
 #include "files_w32.cpp"
 #include "net_w32.cpp"
+#include "sampler_w32.cpp"
 #include "thread_w32.cpp"
 #include "w32_util.cpp"
+#include "watch_w32.cpp"
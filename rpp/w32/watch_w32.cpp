@@ -0,0 +1,159 @@
+
+#include "../watch.h"
+
+#include "w32_util.h"
+#include <windows.h>
+
+namespace rpp::Files {
+
+// Change notifications are per directory, so files that share a directory share a watch.
+struct Watch_Directory {
+    String<Alloc> path;
+    Vec<Pair<String<Alloc>, u64>, Alloc> files;
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    OVERLAPPED overlapped = {};
+    alignas(DWORD) u8 buffer[4096] = {};
+};
+
+constexpr DWORD WATCH_FILTER =
+    FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_FILE_NAME;
+
+[[nodiscard]] static bool issue(Watch_Directory& dir, HANDLE signal) noexcept {
+    dir.overlapped = {};
+    dir.overlapped.hEvent = signal;
+    return ReadDirectoryChangesW(dir.handle, dir.buffer, sizeof(dir.buffer), FALSE, WATCH_FILTER,
+                                 null, &dir.overlapped, null) == TRUE;
+}
+
+Watch_Set::Watch_Set() noexcept {
+    HANDLE event = CreateEventEx(null, null, CREATE_EVENT_MANUAL_RESET, EVENT_ALL_ACCESS);
+    if(!event) {
+        die("Failed to create event: %", Log::sys_error());
+    }
+    signal = reinterpret_cast<void*>(event);
+}
+
+Watch_Set::~Watch_Set() noexcept {
+    for(void* ptr : directories) {
+        Watch_Directory* dir = reinterpret_cast<Watch_Directory*>(ptr);
+        if(CancelIoEx(dir->handle, &dir->overlapped) == TRUE) {
+            DWORD bytes = 0;
+            static_cast<void>(GetOverlappedResult(dir->handle, &dir->overlapped, &bytes, TRUE));
+        }
+        CloseHandle(dir->handle);
+        dir->~Watch_Directory();
+        Alloc::free(dir);
+    }
+    directories.clear();
+    if(signal) CloseHandle(reinterpret_cast<HANDLE>(signal));
+    signal = null;
+}
+
+[[nodiscard]] Opt<u64> Watch_Set::add(String_View path) noexcept {
+    String_View dir_path = path.remove_file_suffix();
+    if(dir_path.empty()) dir_path = "."_v;
+    String_View name = path.file_suffix();
+
+    Watch_Directory* dir = null;
+    for(void* ptr : directories) {
+        Watch_Directory* d = reinterpret_cast<Watch_Directory*>(ptr);
+        if(d->path == dir_path) {
+            dir = d;
+            break;
+        }
+    }
+
+    if(!dir) {
+        auto [ucs2_path, ucs2_path_len] = utf8_to_ucs2(dir_path);
+        if(ucs2_path_len == 0) {
+            warn("Failed to convert file path %!", dir_path);
+            return {};
+        }
+
+        HANDLE handle = CreateFileW(ucs2_path, FILE_LIST_DIRECTORY,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, null,
+                                    OPEN_EXISTING,
+                                    FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, null);
+        if(handle == INVALID_HANDLE_VALUE) {
+            warn("Failed to open directory %: %", dir_path, Log::sys_error());
+            return {};
+        }
+
+        dir = reinterpret_cast<Watch_Directory*>(
+            alloc_aligned<Alloc, alignof(Watch_Directory)>(sizeof(Watch_Directory)));
+        new(dir) Watch_Directory{};
+        dir->path = dir_path.string<Alloc>();
+        dir->handle = handle;
+
+        if(!issue(*dir, reinterpret_cast<HANDLE>(signal))) {
+            warn("Failed to watch directory %: %", dir_path, Log::sys_error());
+            CloseHandle(handle);
+            dir->~Watch_Directory();
+            Alloc::free(dir);
+            return {};
+        }
+        directories.push(reinterpret_cast<void*>(dir));
+    }
+
+    u64 id = paths.length();
+    paths.push(path.string<Alloc>());
+    marked.push(false);
+    dir->files.push(Pair<String<Alloc>, u64>{name.string<Alloc>(), id});
+    return Opt{id};
+}
+
+[[nodiscard]] Async::Event Watch_Set::event() const noexcept {
+    // The pool closes the event once it fires, so hand out a duplicate handle.
+    HANDLE event = null;
+    if(DuplicateHandle(GetCurrentProcess(), reinterpret_cast<HANDLE>(signal),
+                       GetCurrentProcess(), &event, 0, FALSE, DUPLICATE_SAME_ACCESS) == FALSE) {
+        die("Failed to duplicate event: %", Log::sys_error());
+    }
+    return Async::Event::of_sys(reinterpret_cast<void*>(event));
+}
+
+[[nodiscard]] Slice<u64> Watch_Set::poll() noexcept {
+    changed.clear();
+
+    // Reset first, so a completion racing with the scan signals again.
+    ResetEvent(reinterpret_cast<HANDLE>(signal));
+
+    for(void* ptr : directories) {
+        Watch_Directory& dir = *reinterpret_cast<Watch_Directory*>(ptr);
+
+        DWORD bytes = 0;
+        if(GetOverlappedResult(dir.handle, &dir.overlapped, &bytes, FALSE) == FALSE) {
+            if(GetLastError() != ERROR_IO_INCOMPLETE) {
+                warn("Failed to read changes in %: %", dir.path, Log::sys_error());
+            }
+            continue;
+        }
+
+        if(bytes == 0) {
+            // The notification buffer overflowed, so assume everything changed.
+            for(auto& [name, id] : dir.files) mark(id);
+        } else {
+            u8* at = dir.buffer;
+            for(;;) {
+                const FILE_NOTIFY_INFORMATION* info =
+                    reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(at);
+                String_View name = ucs2_to_utf8(info->FileName,
+                                                static_cast<int>(info->FileNameLength / 2));
+                for(auto& [file, id] : dir.files) {
+                    if(file == name) mark(id);
+                }
+                if(info->NextEntryOffset == 0) break;
+                at += info->NextEntryOffset;
+            }
+        }
+
+        if(!issue(dir, reinterpret_cast<HANDLE>(signal))) {
+            warn("Failed to watch directory %: %", dir.path, Log::sys_error());
+        }
+    }
+
+    for(u64 id : changed) marked[id] = false;
+    return Slice<u64>{changed};
+}
+
+} // namespace rpp::Files
@@ -0,0 +1,65 @@
+
+#pragma once
+
+#include "async.h"
+#include "base.h"
+#include "files.h"
+
+namespace rpp::Files {
+
+// Watches a set of files for writes through one OS notification handle (inotify, kqueue, or
+// directory change notifications), so the cost scales with the number of changes rather than
+// the number of watched files. Await event() on a pool to sleep until something changes, then
+// poll() to collect which files were written.
+struct Watch_Set {
+
+    Watch_Set() noexcept;
+    ~Watch_Set() noexcept;
+
+    Watch_Set(const Watch_Set&) noexcept = delete;
+    Watch_Set& operator=(const Watch_Set&) noexcept = delete;
+
+    Watch_Set(Watch_Set&&) noexcept = delete;
+    Watch_Set& operator=(Watch_Set&&) noexcept = delete;
+
+    // Returns the id reported by poll when path is written.
+    [[nodiscard]] Opt<u64> add(String_View path) noexcept;
+
+    // A new event signaled whenever changes are pending, to be passed to Pool::event.
+    [[nodiscard]] Async::Event event() const noexcept;
+
+    // Ids of the files written since the last poll, each reported once. Never blocks, and the
+    // result is valid until the next poll.
+    [[nodiscard]] Slice<u64> poll() noexcept;
+
+    [[nodiscard]] u64 length() const noexcept {
+        return paths.length();
+    }
+    [[nodiscard]] String_View path(u64 id) const noexcept {
+        return paths[id].view();
+    }
+
+private:
+    void mark(u64 id) noexcept {
+        if(marked[id]) return;
+        marked[id] = true;
+        changed.push(id);
+    }
+
+    Vec<String<Alloc>, Alloc> paths;
+    Vec<bool, Alloc> marked;
+    Vec<u64, Alloc> changed;
+
+#ifdef RPP_OS_WINDOWS
+    Vec<void*, Alloc> directories;
+    void* signal = null;
+#elif defined RPP_OS_LINUX
+    Map<i32, u64, Alloc> watches;
+    i32 fd = -1;
+#elif defined RPP_OS_MACOS
+    Vec<i32, Alloc> files;
+    i32 fd = -1;
+#endif
+};
+
+} // namespace rpp::Files
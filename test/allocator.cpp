@@ -2,6 +2,16 @@
 #include "test.h"
 
 #include <rpp/rc.h>
+#include <rpp/thread.h>
+
+struct alignas(64) Cache_Line {
+    u64 value = 0;
+};
+
+template<typename T>
+bool is_aligned(const T* ptr) {
+    return reinterpret_cast<u64>(ptr) % alignof(T) == 0;
+}
 
 i32 main() {
     Profile::begin_frame();
@@ -23,6 +33,40 @@ i32 main() {
                 }
             }
         }
+        Trace("Aligned") {
+            Vec<Cache_Line> lines;
+            for(u64 i = 0; i < 10; i++) {
+                lines.push(Cache_Line{i});
+                assert(is_aligned(lines.data()));
+            }
+            Region(R) {
+                auto v0 = Vec<u8, Mregion<R>>::make(3);
+                auto v1 = Vec<Cache_Line, Mregion<R>>::make(3);
+                assert(is_aligned(v1.data()));
+            }
+            Box<Cache_Line, Mpool> box{Cache_Line{1}};
+            assert(is_aligned(&*box));
+        }
+        Trace("Expand") {
+            Region(R) {
+                Vec<u8, Mregion<R>> v(64);
+                for(u8 i = 0; i < 64; i++) v.push(i);
+                const u8* data = v.data();
+                v.reserve(128);
+                assert(v.data() == data && v.capacity() == 128);
+
+                // Once another allocation sits on top, growing has to move.
+                auto blocker = Vec<u8, Mregion<R>>::make(16);
+                v.reserve(256);
+                assert(v.data() != data && v.capacity() == 256);
+                for(u8 i = 0; i < 64; i++) assert(v[i] == i);
+            }
+            Vec<u8, Mallocator<"Test">> big(Math::MB(1));
+            big.resize(Math::MB(1));
+            big[0] = 1;
+            big.reserve(Math::MB(4));
+            assert(big.capacity() == Math::MB(4) && big[0] == 1);
+        }
         Trace("Alloc0") {
             using A = Mallocator<"Test">;
             void* ptr = A::alloc(100);
@@ -54,6 +98,27 @@ i32 main() {
                 Arc<Box<i32, Mpool>, Mpool> pool_arc1{1};
                 Arc<Box<i32, Mpool>, Mpool> pool_arc2{2};
             }
+            {
+                // Blocks allocated on one thread and freed on another.
+                Vec<i64*> blocks;
+                for(u64 i = 0; i < 100; i++) {
+                    blocks.push(Mpool::make<i64>(static_cast<i64>(i)));
+                }
+                auto freed = Thread::spawn([&blocks]() {
+                    for(i64* b : blocks) {
+                        Mpool::destroy(b);
+                    }
+                });
+                freed->block();
+
+                for(u64 i = 0; i < 100; i++) {
+                    i64* a = Mpool_Cache<0>::make<i64>(1);
+                    i64* b = Mpool_Cache<1>::make<i64>(2);
+                    assert(*a == 1 && *b == 2);
+                    Mpool_Cache<0>::destroy(a);
+                    Mpool_Cache<1>::destroy(b);
+                }
+            }
         }
     }
     Profile::end_frame();
@@ -0,0 +1,59 @@
+
+#include "test.h"
+
+#include <rpp/arena.h>
+
+using Linear = Marena<Linear_Arena<>>;
+using Frame = Marena<Frame_Arena<>>;
+
+static_assert(sizeof(Vec<u64>) == 3 * sizeof(u64));
+static_assert(sizeof(Vec<u64, Linear>) == 4 * sizeof(u64));
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Linear") {
+        Linear_Arena<> a{256}, b{256};
+        Vec<u64, Linear> x{Linear{a}};
+        Vec<u64, Linear> y{Linear{b}, 4};
+        for(u64 i = 0; i < 100; i++) {
+            x.push(i);
+            y.push(2 * i);
+        }
+        assert(x.allocator().arena() == &a && y.allocator().arena() == &b);
+        assert(a.used() >= 100 * sizeof(u64) && b.used() >= 100 * sizeof(u64));
+        assert(x[99] == 99 && y[99] == 198);
+
+        Vec<u64, Linear> z = x.clone();
+        assert(z.allocator().arena() == &a && z.length() == 100 && z[42] == 42);
+        Vec<u64, Linear> w = rpp::move(y);
+        assert(w.allocator().arena() == &b && w[1] == 2);
+
+        a.reset();
+        assert(a.used() == 0);
+    }
+    Trace("Expand") {
+        // The newest allocation in a chunk grows in place.
+        Linear_Arena<> a{4096};
+        Vec<u64, Linear> v{Linear{a}, 4};
+        u64* data = v.data();
+        v.reserve(8);
+        assert(v.data() == data && a.used() == 8 * sizeof(u64));
+        Vec<u64, Linear> u{Linear{a}, 4};
+        v.reserve(16);
+        assert(v.data() != data && a.used() == 28 * sizeof(u64));
+    }
+    Trace("Frame") {
+        Frame_Arena<> frames{128};
+        Vec<u64, Frame> last{Frame{frames}};
+        for(u64 frame = 0; frame < 4; frame++) {
+            frames.begin_frame();
+            Vec<u64, Frame> now{Frame{frames}};
+            for(u64 i = 0; i < 10; i++) now.push(frame * 10 + i);
+            if(frame) assert(last[9] == frame * 10 - 1);
+            last = rpp::move(now);
+            assert(frames.current().used() == 16 * sizeof(u64));
+        }
+        assert(last[0] == 30);
+    }
+    return 0;
+}
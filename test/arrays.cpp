@@ -129,6 +129,33 @@ i32 main() {
         (void)s3;
         (void)s5;
     }
+    Trace("Small_Vec") {
+        Small_Vec<i32, 4> v;
+        for(i32 i = 0; i < 4; i++) v.push(i);
+        assert(v.is_inline() && v.length() == 4 && v.capacity() == 4);
+
+        Small_Vec<i32, 4> moved = move(v);
+        assert(moved.is_inline() && moved.length() == 4 && v.empty());
+
+        moved.push(4);
+        assert(!moved.is_inline() && moved.length() == 5);
+        for(i32 i = 0; i < 5; i++) assert(moved[i] == i);
+
+        Small_Vec<i32, 4> spilled = move(moved);
+        assert(!spilled.is_inline() && moved.is_inline() && moved.empty());
+
+        Slice<i32> s{spilled};
+        assert(s.length() == 5 && s[4] == 4);
+
+        Small_Vec<String_View, 2> sv{"Hello"_v, "World"_v};
+        Small_Vec<String_View, 2> sv2 = sv.clone();
+        assert(sv2.length() == 2 && sv2[1] == "World"_v);
+
+        Small_Vec<Box<i32>, 2> boxes;
+        for(i32 i = 0; i < 3; i++) boxes.emplace(i);
+        Small_Vec<Box<i32>, 2> boxes2 = move(boxes);
+        assert(*boxes2[2] == 2);
+    }
     Trace("Stack") {
         Stack<i32> v;
         v.push(1);
@@ -291,6 +318,39 @@ i32 main() {
 
         assert(sv3.length() == 2);
 
+        {
+            Heap<u64, Mdefault, 8> wide;
+            for(u64 i = 0; i < 1000; i++) wide.push((i * 7919) % 1000);
+            for(u64 i = 0; i < 1000; i++) {
+                assert(wide.top() == i);
+                wide.pop();
+            }
+            assert(wide.empty());
+        }
+        {
+            Handle_Heap<i32> h;
+            auto a = h.push(5);
+            auto b = h.push(3);
+            auto c = h.push(8);
+            assert(h.top() == 3 && h.top_handle() == b);
+
+            h.update(c, 1);
+            assert(h.top() == 1 && h.top_handle() == c);
+            h.update(c, 9);
+            assert(h.top() == 3);
+
+            h.erase(b);
+            assert(!h.contains(b) && h.length() == 2);
+            assert(h.top() == 5 && h.get(a) == 5);
+
+            auto d = h.push(0);
+            assert(d == b && h.top_handle() == d);
+            h.pop();
+            h.pop();
+            assert(h.top() == 9);
+            h.pop();
+            assert(h.empty());
+        }
         Heap<String_View> o{"a"_v, "aa"_v, "ab"_v, "bb"_v, "aab"_v};
         while(o.length() > 0) {
             o.pop();
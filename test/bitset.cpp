@@ -0,0 +1,125 @@
+
+#include "test.h"
+
+#include <rpp/bitset.h>
+#include <rpp/rng.h>
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Bitset") {
+        Bitset<130> bits;
+        assert(bits.none() && !bits.first().ok());
+        bits.set(3);
+        bits.set(64);
+        bits.set(129);
+        assert(bits.test(64) && !bits.test(65));
+        assert(bits.count() == 3);
+        assert(*bits.first() == 3 && *bits.next(4) == 64 && *bits.next(65) == 129);
+        assert(!bits.next(130).ok());
+
+        bits.flip(3);
+        bits.reset(64);
+        assert(bits.count() == 1 && *bits.first() == 129);
+
+        Bitset<130> all;
+        all.fill();
+        assert(all.count() == 130);
+        all.subtract(bits);
+        assert(all.count() == 129 && !all.test(129));
+
+        Bitset<130> odd;
+        for(u64 i = 1; i < 130; i += 2) odd.set(i);
+        all.intersect(odd);
+        assert(all.count() == 64 && !all.test(129));
+        all.unite(bits);
+        assert(all.count() == 65);
+
+        u64 sum = 0;
+        all.each([&](u64 i) { sum += i; });
+        assert(sum == 64 * 64 + 129);
+    }
+    Trace("Dynamic") {
+        Dynamic_Bitset<> a{1000};
+        Dynamic_Bitset<> b{1000};
+        for(u64 i = 0; i < 1000; i += 3) a.set(i);
+        for(u64 i = 0; i < 1000; i += 5) b.set(i);
+        assert(a.count() == 334 && b.count() == 200);
+
+        Dynamic_Bitset<> both = a.clone();
+        both.intersect(b);
+        assert(both.count() == 67);
+        Dynamic_Bitset<> either = a.clone();
+        either.unite(b);
+        assert(either.count() == 467);
+        Dynamic_Bitset<> only = a.clone();
+        only.subtract(b);
+        assert(only.count() == 267 && !only.test(15) && only.test(3));
+
+        a.fill();
+        assert(a.count() == 1000);
+        a.resize(70);
+        assert(a.count() == 70);
+        a.resize(200);
+        assert(a.count() == 70 && !a.test(70) && *a.next(69) == 69);
+        a.clear();
+        assert(a.none());
+    }
+    Trace("Roaring") {
+        Roaring_Bitmap<> map;
+        assert(map.empty() && map.count() == 0);
+        assert(map.add(7) && !map.add(7));
+        assert(map.add(0x10000) && map.add(0xffffffff));
+        assert(map.contains(7) && map.contains(0x10000) && !map.contains(8));
+        assert(map.count() == 3);
+        assert(map.remove(0x10000) && !map.remove(0x10000));
+        assert(map.count() == 2);
+
+        Vec<u32> seen;
+        map.each([&](u32 id) { seen.push(id); });
+        assert(seen.length() == 2 && seen[0] == 7 && seen[1] == 0xffffffff);
+    }
+    Trace("Roaring Dense") {
+        Roaring_Bitmap<> evens, threes;
+        for(u32 i = 0; i < 200000; i += 2) evens.add(i);
+        for(u32 i = 0; i < 200000; i += 3) threes.add(i);
+        assert(evens.count() == 100000 && threes.count() == 66667);
+
+        Roaring_Bitmap<> both = evens.clone();
+        both.intersect(threes);
+        assert(both.count() == 33334);
+        Roaring_Bitmap<> either = evens.clone();
+        either.unite(threes);
+        assert(either.count() == 133333);
+        Roaring_Bitmap<> only = evens.clone();
+        only.subtract(threes);
+        assert(only.count() == 66666);
+        assert(only.contains(4) && !only.contains(6) && !only.contains(3));
+
+        // Removing most of a dense container converts it back to an array.
+        for(u32 i = 0; i < 65536; i++) evens.remove(i);
+        assert(evens.count() == 100000 - 32768 && !evens.contains(0));
+    }
+    Trace("Roaring Random") {
+        RNG::Stream rng{7};
+        Roaring_Bitmap<> a, b;
+        Dynamic_Bitset<> da{1 << 20}, db{1 << 20};
+        for(u64 i = 0; i < 20000; i++) {
+            u32 x = static_cast<u32>(rng.range(u64{0}, u64{1 << 20}));
+            u32 y = static_cast<u32>(rng.range(u64{0}, u64{1 << 18}));
+            a.add(x);
+            da.set(x);
+            b.add(y);
+            db.set(y);
+        }
+        a.unite(b);
+        da.unite(db);
+        assert(a.count() == da.count());
+        a.each([&](u32 id) { assert(da.test(id)); });
+        a.subtract(b);
+        da.subtract(db);
+        assert(a.count() == da.count());
+        a.intersect(b);
+        assert(a.empty());
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+
+#include "test.h"
+
+#include <rpp/btree_map.h>
+#include <rpp/rng.h>
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Insert") {
+        BTree_Map<i32, i32> map;
+        assert(map.empty() && !map.contains(1));
+        assert(BTree_Map<i32, i32>::WIDTH == 64);
+        for(i32 i = 0; i < 10000; i++) map.insert((i * 7919) % 10000, i32{i});
+        map.insert(42, -1);
+        assert(map.length() == 10000 && map.get(42) == -1);
+
+        i32 last = -1;
+        u64 count = 0;
+        map.each([&](const i32& key, const i32&) {
+            assert(key > last);
+            last = key;
+            count++;
+        });
+        assert(count == 10000);
+
+        count = 0;
+        map.each_in(4000, 6000, [&](const i32& key, i32&) {
+            assert(key == 4000 + static_cast<i32>(count));
+            count++;
+        });
+        assert(count == 2000);
+        assert(format<Mdefault>("%"_v, BTree_Map<i32, i32>{}) == "BTree_Map[]"_v);
+    }
+    Trace("Random") {
+        BTree_Map<String<>, u64> map;
+        Map<String<>, u64> expected;
+        RNG::Stream rng(3);
+        for(u64 i = 0; i < 20000; i++) {
+            u64 n = rng.range(u64{0}, u64{5000});
+            String<> key = format<Mdefault>("key%"_v, n);
+            if(rng.range(u64{0}, u64{4}) == 0) {
+                assert(map.try_erase(key) == expected.try_erase(key));
+            } else {
+                expected.insert(key.clone(), u64{i});
+                map.insert(rpp::move(key), u64{i});
+            }
+        }
+        assert(map.length() == expected.length());
+        for(auto& item : expected) assert(map.get(item.first) == item.second);
+
+        u64 count = 0;
+        String<> previous;
+        map.each([&](const String<>& key, u64 value) {
+            assert(count == 0 || previous.view() < key.view());
+            assert(expected.get(key) == value);
+            previous = key.clone();
+            count++;
+        });
+        assert(count == expected.length());
+
+        count = 0;
+        map.each_in("key2"_v.string<Mdefault>(), "key3"_v.string<Mdefault>(),
+                    [&](const String<>& key, u64&) {
+                        assert(key.view().starts_with("key2"_v));
+                        count++;
+                    });
+        u64 twos = 0;
+        for(auto& item : expected) twos += item.first.view().starts_with("key2"_v);
+        assert(count == twos);
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+
+#include "test.h"
+
+#include <rpp/bvh.h>
+#include <rpp/rng.h>
+
+using namespace rpp::Math;
+
+[[nodiscard]] static f32 coord(RNG::Stream& rng) noexcept {
+    return static_cast<f32>(rng.range(0, 2000)) * 0.1f - 100.0f;
+}
+
+// Offset from the grid of box corners, so no ray starts on a slab it is parallel to.
+[[nodiscard]] static Ray random_ray(RNG::Stream& rng) noexcept {
+    Vec3 origin{coord(rng) + 0.05f, coord(rng) + 0.05f, coord(rng) + 0.05f};
+    return Ray{origin, Vec3{coord(rng), coord(rng), coord(rng)}};
+}
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Hit") {
+        BBox box{Vec3{-1.0f}, Vec3{1.0f}};
+        Opt<f32> t = box.hit(Ray{Vec3{-5.0f, 0.0f, 0.0f}, Vec3{1.0f, 0.0f, 0.0f}});
+        assert(t.ok() && *t == 4.0f);
+        assert(!box.hit(Ray{Vec3{-5.0f, 2.0f, 0.0f}, Vec3{1.0f, 0.0f, 0.0f}}).ok());
+        assert(!box.hit(Ray{Vec3{5.0f, 0.0f, 0.0f}, Vec3{1.0f, 0.0f, 0.0f}}).ok());
+        assert(!box.hit(Ray{Vec3{-5.0f, 0.0f, 0.0f}, Vec3{1.0f, 0.0f, 0.0f}}, 0.0f, 3.0f).ok());
+        assert(*box.hit(Ray{Vec3{0.0f}, Vec3{0.0f, 0.0f, 1.0f}}) == 0.0f);
+        assert(!BBox{}.hit(Ray{Vec3{0.0f}, Vec3{1.0f, 1.0f, 1.0f}}).ok());
+
+        RNG::Stream rng{3};
+        BBox8 boxes;
+        for(u64 i = 0; i < 7; i++) {
+            Vec3 min{coord(rng), coord(rng), coord(rng)};
+            boxes.set(i, BBox{min, min + Vec3{20.0f}});
+        }
+        for(u64 r = 0; r < 100; r++) {
+            Ray ray = random_ray(rng);
+            SIMD::F32x8 t8;
+            u32 mask = boxes.hit(ray, 0.0f, Limits<f32>::max(), &t8);
+            assert(!(mask & 0x80));
+            for(u64 i = 0; i < 7; i++) {
+                Opt<f32> hit = boxes.get(i).hit(ray);
+                assert(hit.ok() == ((mask >> i) & 1));
+                if(hit.ok()) assert(*hit == t8.data[i]);
+            }
+        }
+    }
+    Trace("BVH") {
+        RNG::Stream rng{1};
+        Vec<BBox> boxes;
+        for(u64 i = 0; i < 10000; i++) {
+            Vec3 min{coord(rng), coord(rng), coord(rng)};
+            boxes.push(BBox{min, min + Vec3{0.5f, 1.0f, 2.0f}});
+        }
+
+        BVH<> bvh = BVH<>::build(Slice{boxes});
+        assert(bvh.primitives().length() == boxes.length());
+        BBox bounds;
+        for(const BBox& box : boxes) bounds.enclose(box);
+        assert(bvh.bounds().min == bounds.min && bvh.bounds().max == bounds.max);
+        for(u64 i = 0; i < bvh.nodes().length(); i++) {
+            const BVH<>::Node& node = bvh.nodes()[i];
+            if(node.leaf()) {
+                assert(node.count <= BVH<>::LEAF_SIZE);
+            } else {
+                assert(node.offset > i + 1 && node.offset < bvh.nodes().length());
+            }
+        }
+
+        for(u64 r = 0; r < 200; r++) {
+            Ray ray = random_ray(rng);
+
+            f32 expected = Limits<f32>::max();
+            for(const BBox& box : boxes) {
+                if(Opt<f32> t = box.hit(ray); t.ok()) expected = Math::min(expected, *t);
+            }
+            f32 closest = Limits<f32>::max();
+            bvh.traverse(ray, Limits<f32>::max(), [&](u32 primitive, f32 t_max) {
+                if(Opt<f32> t = boxes[primitive].hit(ray, 0.0f, t_max); t.ok()) closest = *t;
+                return closest;
+            });
+            assert(closest == expected);
+        }
+
+        Async::Pool pool;
+        BVH<> parallel = BVH<>::build(pool, Slice{boxes}).block();
+        assert(parallel.nodes().length() == bvh.nodes().length());
+        for(u64 i = 0; i < bvh.nodes().length(); i++) {
+            const BVH<>::Node& a = bvh.nodes()[i];
+            const BVH<>::Node& b = parallel.nodes()[i];
+            assert(a.offset == b.offset && a.count == b.count);
+        }
+        for(u64 i = 0; i < bvh.primitives().length(); i++) {
+            assert(bvh.primitives()[i] == parallel.primitives()[i]);
+        }
+
+        assert(BVH<>::build(Slice<BBox>{}).nodes().empty());
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "test.h"
+
+#include <rpp/channel.h>
+
+i32 main() {
+    Test test{"empty"_v};
+    Async::Pool pool;
+    Trace("Pipeline") {
+        constexpr u64 COUNT = 10000;
+        Async::Channel<u64, 4> decoded{pool};
+        Async::Channel<u64, 2> transformed{pool};
+
+        auto produce = [&]() -> Async::Task<void> {
+            co_await pool.suspend();
+            for(u64 i = 0; i < COUNT; i++) {
+                bool sent = co_await decoded.send(i);
+                assert(sent);
+            }
+            decoded.close();
+        };
+        auto transform = [&]() -> Async::Task<void> {
+            co_await pool.suspend();
+            for(;;) {
+                Opt<u64> value = co_await decoded.recv();
+                if(!value.ok()) break;
+                bool sent = co_await transformed.send(*value * 2);
+                assert(sent);
+            }
+            transformed.close();
+        };
+        auto consume = [&]() -> Async::Task<u64> {
+            co_await pool.suspend();
+            u64 sum = 0, count = 0;
+            for(;;) {
+                Opt<u64> value = co_await transformed.recv();
+                if(!value.ok()) break;
+                sum += *value;
+                count++;
+            }
+            assert(count == COUNT);
+            co_return sum;
+        };
+
+        auto consumer = consume();
+        auto transformer = transform();
+        auto producer = produce();
+        assert(consumer.block() == COUNT * (COUNT - 1));
+        transformer.block();
+        producer.block();
+    }
+    Trace("Fan in") {
+        Async::Channel<u64, 1> channel{pool};
+        auto produce = [&](u64 n) -> Async::Task<void> {
+            co_await pool.suspend();
+            for(u64 i = 0; i < n; i++) {
+                bool sent = co_await channel.send(1);
+                assert(sent);
+            }
+        };
+        auto p0 = produce(1000);
+        auto p1 = produce(1000);
+        auto p2 = produce(1000);
+
+        auto consume = [&]() -> Async::Task<u64> {
+            u64 sum = 0;
+            for(u64 i = 0; i < 3000; i++) sum += *co_await channel.recv();
+            co_return sum;
+        };
+        assert(consume().block() == 3000);
+        p0.block();
+        p1.block();
+        p2.block();
+
+        assert(channel.try_send(5) && !channel.try_send(6));
+        channel.close();
+        assert(!channel.try_send(7));
+        assert(*channel.try_recv() == 5 && !channel.try_recv().ok());
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "test.h"
+
+#include <rpp/concurrent_map.h>
+#include <rpp/thread.h>
+
+i32 main() {
+    Profile::begin_frame();
+    {
+        Test test{"empty"_v};
+        {
+            Concurrent_Map<u64, u64> map;
+            assert(map.empty());
+            assert(!map.try_get(1).ok());
+
+            map.insert(1, 2);
+            map.insert(1, 3);
+            assert(map.length() == 1);
+            assert(*map.try_get(1) == 3);
+            assert(map.try_erase(1));
+            assert(!map.try_erase(1));
+            assert(map.empty());
+        }
+        {
+            constexpr u64 N = 10000;
+            Concurrent_Map<u64, u64> map;
+
+            Vec<Thread::Future<bool>> readers;
+            for(u64 t = 0; t < 4; t++) {
+                readers.push(Thread::spawn([&map]() {
+                    bool ok = true;
+                    for(u64 i = 0; i < N; i++) {
+                        if(Opt<u64> v = map.try_get(i); v.ok()) ok = ok && *v == 2 * i;
+                    }
+                    return ok;
+                }));
+            }
+            for(u64 i = 0; i < N; i++) {
+                map.insert(i, 2 * i);
+            }
+            for(auto& reader : readers) {
+                assert(reader->block());
+            }
+
+            assert(map.length() == N);
+            u64 sum = 0;
+            map.for_each([&sum](const u64&, const u64& v) { sum += v; });
+            assert(sum == N * (N - 1));
+
+            for(u64 i = 0; i < N; i += 2) {
+                assert(map.try_erase(i));
+            }
+            assert(map.length() == N / 2);
+            for(u64 i = 0; i < N; i++) {
+                assert(map.contains(i) == (i % 2 == 1));
+            }
+        }
+    }
+    Profile::end_frame();
+    Profile::finalize();
+    return 0;
+}
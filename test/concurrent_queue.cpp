@@ -0,0 +1,65 @@
+#include "test.h"
+
+#include <rpp/concurrent_queue.h>
+#include <rpp/thread.h>
+
+template<Queue_Mode M, u64 Producers, u64 Consumers>
+void transfer() {
+    constexpr u64 N = 10000;
+    Concurrent_Queue<u64, 64, M> queue;
+
+    Vec<Thread::Future<u64>> consumers;
+    for(u64 t = 0; t < Consumers; t++) {
+        consumers.push(Thread::spawn([&queue]() {
+            u64 sum = 0;
+            for(u64 i = 0; i < Producers * N / Consumers; i++) sum += queue.pop();
+            return sum;
+        }));
+    }
+    Vec<Thread::Future<bool>> producers;
+    for(u64 t = 0; t < Producers; t++) {
+        producers.push(Thread::spawn([&queue]() {
+            for(u64 i = 0; i < N; i++) queue.push(i);
+            return true;
+        }));
+    }
+
+    for(auto& producer : producers) {
+        assert(producer->block());
+    }
+    u64 sum = 0;
+    for(auto& consumer : consumers) {
+        sum += consumer->block();
+    }
+    assert(sum == Producers * N * (N - 1) / 2);
+    assert(queue.empty());
+}
+
+i32 main() {
+    Profile::begin_frame();
+    {
+        Test test{"empty"_v};
+        {
+            Concurrent_Queue<u64, 4> queue;
+            assert(queue.empty() && queue.capacity() == 4);
+            assert(!queue.try_pop().ok());
+            for(u64 i = 0; i < 4; i++) assert(queue.try_push(i));
+            assert(!queue.try_push(4));
+            assert(queue.length() == 4);
+            for(u64 i = 0; i < 4; i++) assert(*queue.try_pop() == i);
+            assert(queue.empty());
+        }
+        {
+            Concurrent_Queue<Box<u64>, 2> queue;
+            assert(queue.try_push(Box<u64>{1}));
+            assert(queue.try_emplace(2));
+            assert(**queue.try_pop() == 1);
+        }
+        transfer<Queue_Mode::spsc, 1, 1>();
+        transfer<Queue_Mode::mpsc, 4, 1>();
+        transfer<Queue_Mode::mpmc, 4, 4>();
+    }
+    Profile::end_frame();
+    Profile::finalize();
+    return 0;
+}
@@ -99,6 +99,83 @@ i32 main() {
             assert(task.done());
             assert(task.block() == 1);
         }
+        {
+            auto co = [](i32 i, Async::Task<void>& gate) -> Async::Task<i32> {
+                co_await gate;
+                co_return i;
+            };
+            auto gate = []() -> Async::Task<void> { co_await Async::Suspend{}; };
+
+            Vec<Async::Task<void>> gates;
+            for(i32 i = 0; i < 5; i++) gates.push(gate());
+
+            Async::Task_Group<i32> group;
+            for(i32 i = 0; i < 5; i++) group.spawn(co(i, gates[i]));
+            assert(group.length() == 5);
+
+            auto any = [&group]() -> Async::Task<u64> { co_return co_await group.when_any(); };
+            auto all = [&group]() -> Async::Task<i32> {
+                co_await group.when_all();
+                i32 sum = 0;
+                for(u64 i = 0; i < group.length(); i++) sum += co_await group[i];
+                co_return sum;
+            };
+
+            Async::Task<u64> first = any();
+            assert(!first.done());
+            gates[2].resume();
+            assert(first.done() && first.block() == 2);
+
+            Async::Task<i32> sum = all();
+            gates[0].resume();
+            gates[3].resume();
+            gates[4].resume();
+            assert(!sum.done());
+            gates[1].resume();
+            assert(sum.done() && sum.block() == 10);
+        }
+        {
+            i32 ran = 0;
+            auto co = [&ran]() -> Async::Lazy<i32> {
+                ran++;
+                co_return 1;
+            };
+            Async::Lazy<i32> task = co();
+            assert(ran == 0 && !task.started() && !task.done());
+            assert(task.block() == 1 && ran == 1);
+            // Dropping a task that never started destroys it without running it.
+            static_cast<void>(co());
+            assert(ran == 1);
+        }
+        {
+            // Each level is resumed by symmetric transfer, so the chain does not grow the stack.
+            struct Chain {
+                static Async::Lazy<u64> sum(u64 depth) noexcept {
+                    if(depth == 0) co_return 0;
+                    co_return depth + co_await sum(depth - 1);
+                }
+            };
+            auto root = []() -> Async::Task<u64> { co_return co_await Chain::sum(100000); };
+            assert(root().block() == 100000ull * 100001 / 2);
+        }
+        {
+            auto gate = []() -> Async::Task<void> { co_await Async::Suspend{}; };
+            Async::Task<void> blocker = gate();
+            auto co = [&blocker]() -> Async::Lazy<i32> {
+                co_await blocker;
+                co_return 2;
+            };
+            auto outer = [](Async::Lazy<i32>& task) -> Async::Task<i32> {
+                co_return co_await task;
+            };
+            Async::Lazy<i32> task = co();
+            task.start();
+            assert(task.started() && !task.done());
+            Async::Task<i32> waiter = outer(task);
+            assert(!waiter.done());
+            blocker.resume();
+            assert(task.done() && waiter.done() && waiter.block() == 2);
+        }
     }
     return 0;
 }
@@ -0,0 +1,92 @@
+
+#include "test.h"
+
+#include <rpp/deque.h>
+#include <rpp/rng.h>
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Basic") {
+        Deque<i32> deque;
+        assert(deque.empty());
+        deque.push(2);
+        deque.push(3);
+        deque.push_front(1);
+        deque.emplace_front(0);
+        assert(deque.length() == 4 && deque.front() == 0 && deque.back() == 3);
+        for(i32 i = 0; i < 4; i++) assert(deque[i] == i);
+
+        deque.pop();
+        deque.pop_back();
+        assert(deque.length() == 2 && deque.front() == 1 && deque.back() == 2);
+
+        i32 sum = 0;
+        for(i32 value : deque) sum += value;
+        assert(sum == 3);
+
+        deque.clear();
+        assert(deque.empty() && deque.blocks() == 0);
+    }
+    Trace("Stable") {
+        Deque<u64> deque;
+        u64& first = deque.push(7);
+        u64* middle = null;
+        for(u64 i = 0; i < 10 * Deque<u64>::BLOCK; i++) {
+            u64& value = deque.push(i);
+            if(i == Deque<u64>::BLOCK) middle = &value;
+            deque.push_front(i);
+        }
+        assert(first == 7 && *middle == Deque<u64>::BLOCK);
+        assert(deque.length() == 20 * Deque<u64>::BLOCK + 1);
+
+        // Draining from both ends releases blocks as they empty.
+        while(deque.length() > 1) {
+            deque.pop();
+            if(deque.length() > 1) deque.pop_back();
+        }
+        assert(deque.blocks() == 1);
+    }
+    Trace("Strings") {
+        Deque<String<>> deque;
+        for(u64 i = 0; i < 1000; i++) {
+            if(i % 2) deque.push(format<Mdefault>("%"_v, i));
+            else deque.push_front(format<Mdefault>("%"_v, i));
+        }
+        assert(deque.front().view() == "998"_v && deque.back().view() == "999"_v);
+        Deque<String<>> moved = rpp::move(deque);
+        assert(deque.empty() && moved.length() == 1000);
+        moved.pop();
+        assert(moved.front().view() == "996"_v);
+    }
+    Trace("Churn") {
+        Deque<u64> deque;
+        Vec<u64> model;
+        RNG::Stream rng{5};
+        for(u64 i = 0; i < 20000; i++) {
+            u64 op = rng.range(u64{0}, u64{4});
+            if(op == 0) {
+                deque.push(i);
+                model.push(i);
+            } else if(op == 1) {
+                deque.push_front(i);
+                Vec<u64> next;
+                next.push(i);
+                for(u64 v : model) next.push(v);
+                model = rpp::move(next);
+            } else if(op == 2 && !model.empty()) {
+                assert(deque.front() == model[0]);
+                deque.pop();
+                Vec<u64> next;
+                for(u64 j = 1; j < model.length(); j++) next.push(model[j]);
+                model = rpp::move(next);
+            } else if(op == 3 && !model.empty()) {
+                assert(deque.back() == model.back());
+                deque.pop_back();
+                model.pop();
+            }
+            assert(deque.length() == model.length());
+        }
+        for(u64 i = 0; i < model.length(); i++) assert(deque[i] == model[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "test.h"
+
+#include <rpp/watch.h>
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Range") {
+        Opt<Vec<u8, Files::Alloc>> all = Files::read("pool.expect"_v);
+        assert(all.ok() && all->length() > 16);
+
+        u8 part[8] = {};
+        Opt<u64> n = Files::read("pool.expect"_v, 4, part, 8);
+        assert(n.ok() && *n == 8);
+        for(u64 i = 0; i < 8; i++) assert(part[i] == (*all)[4 + i]);
+
+        n = Files::read("pool.expect"_v, all->length() - 2, part, 8);
+        assert(n.ok() && *n == 2);
+    }
+    Trace("Reader") {
+        Opt<Vec<u8, Files::Alloc>> all = Files::read("pool.expect"_v);
+        Opt<Files::Reader> reader = Files::Reader::open("pool.expect"_v);
+        assert(all.ok() && reader.ok());
+        assert(reader->size() == all->length());
+
+        Array<u8, 7> chunk;
+        u64 offset = 0;
+        for(;;) {
+            Opt<Slice<u8>> next = reader->next(chunk);
+            assert(next.ok());
+            if(next->empty()) break;
+            for(u8 c : *next) assert(c == (*all)[offset++]);
+        }
+        assert(offset == all->length());
+        assert(reader->done());
+    }
+    Trace("Mapping") {
+        Opt<Vec<u8, Files::Alloc>> all = Files::read("pool.expect"_v);
+        Opt<Files::Mapping> mapping = Files::Mapping::open("pool.expect"_v);
+        assert(all.ok() && mapping.ok());
+        assert(mapping->length() == all->length());
+        mapping->advise(Files::Mapping::Advice::sequential);
+        mapping->prefetch(0, mapping->length());
+
+        Slice<u8> bytes = mapping->bytes();
+        for(u64 i = 0; i < bytes.length(); i++) assert(bytes[i] == (*all)[i]);
+
+        Opt<Files::Mapping> copy =
+            Files::Mapping::open("pool.expect"_v, Files::Mapping::Access::copy_on_write);
+        assert(copy.ok());
+        copy->data()[0] = static_cast<u8>(~(*all)[0]);
+        assert(copy->bytes()[0] != (*all)[0]);
+        assert(mapping->bytes()[0] == (*all)[0]);
+
+        Files::Write_Watcher watcher{"pool.expect"_v};
+        assert(!watcher.remap(*mapping));
+    }
+    Trace("Watch_Set") {
+        String_View path = "watch_set.tmp"_v;
+        auto write = [&](String_View text) {
+            return Files::write(path, Slice<u8>{text.data(), text.length()});
+        };
+        assert(write("before"_v));
+
+        Files::Watch_Set watches;
+        Opt<u64> id = watches.add(path);
+        assert(id.ok() && watches.length() == 1);
+        assert(watches.path(*id) == path);
+        assert(watches.poll().empty());
+        Async::Event event = watches.event();
+
+        assert(write("after"_v));
+        // Directory notifications on Windows arrive asynchronously.
+        Slice<u64> changed;
+        for(u64 i = 0; i < 100 && changed.empty(); i++) {
+            changed = watches.poll();
+            if(changed.empty()) Thread::sleep(10);
+        }
+        assert(changed.length() == 1 && changed[0] == *id);
+        assert(Files::remove(path));
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+
+#include "test.h"
+
+#include <rpp/flat.h>
+
+enum class Asset_Kind : u8 { mesh, texture = 3 };
+
+struct Point {
+    f32 x;
+    f32 y;
+};
+
+struct Asset {
+    String<> name;
+    Asset_Kind kind;
+    bool streamed;
+    Point bounds[2] = {};
+    Vec<u32> lods;
+    Opt<u64> parent;
+};
+
+struct Catalog {
+    u32 version;
+    Vec<Asset> assets;
+    Vec<Point> points;
+    Map<String<>, u32> by_name;
+    Map<u64, Point> anchors;
+};
+
+RPP_ENUM(Asset_Kind, mesh, RPP_CASE(mesh), RPP_CASE(texture));
+RPP_RECORD(Point, RPP_FIELD(x), RPP_FIELD(y));
+RPP_RECORD(Asset, RPP_FIELD(name), RPP_FIELD(kind), RPP_FIELD(streamed), RPP_FIELD(bounds),
+           RPP_FIELD(lods), RPP_FIELD(parent));
+RPP_RECORD(Catalog, RPP_FIELD(version), RPP_FIELD(assets), RPP_FIELD(points),
+           RPP_FIELD(by_name), RPP_FIELD(anchors));
+
+static_assert(Flat::Layout<Point>::plain && Flat::Layout<Point[2]>::plain);
+static_assert(!Flat::Layout<Asset>::plain && !Flat::Layout<Asset_Kind>::plain);
+
+[[nodiscard]] static Catalog make_catalog() noexcept {
+    Catalog catalog;
+    catalog.version = 7;
+    for(u32 i = 0; i < 50; i++) {
+        Asset asset;
+        asset.name = format<Mdefault>("asset%"_v, i);
+        asset.kind = i % 2 ? Asset_Kind::texture : Asset_Kind::mesh;
+        asset.streamed = i % 3 == 0;
+        asset.bounds[1] = Point{static_cast<f32>(i), 1.0f};
+        for(u32 j = 0; j < i % 4; j++) asset.lods.push(i * 10 + j);
+        if(i) asset.parent = Opt<u64>{u64{i - 1}};
+        catalog.by_name.insert(asset.name.clone(), u32{i});
+        catalog.assets.push(rpp::move(asset));
+    }
+    for(u32 i = 0; i < 1000; i++) catalog.points.push(Point{static_cast<f32>(i), 0.5f});
+    catalog.anchors.insert(u64{3}, Point{1.0f, 2.0f});
+    catalog.anchors.insert(u64{1} << 50, Point{3.0f, 4.0f});
+    return catalog;
+}
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Views") {
+        Vec<u8> bytes;
+        u64 root = Flat::write(bytes, make_catalog());
+        assert(root == 0);
+
+        auto opened = Flat::open<Catalog>(Slice<u8>{bytes});
+        assert(opened.ok());
+        Flat::View<Catalog> catalog = *opened;
+        assert(catalog.get<"version">().get() == 7);
+
+        auto assets = catalog.get<"assets">();
+        assert(assets.length() == 50);
+        for(u32 i = 0; i < 50; i++) {
+            auto asset = assets[i];
+            assert(asset.get<"name">().view() == format<Mdefault>("asset%"_v, i).view());
+            assert(asset.get<"kind">().get() == (i % 2 ? Asset_Kind::texture : Asset_Kind::mesh));
+            assert(asset.get<"streamed">().get() == (i % 3 == 0));
+            assert(asset.get<"bounds">()[1].get().x == static_cast<f32>(i));
+            auto lods = asset.get<"lods">();
+            assert(lods.length() == i % 4);
+            for(u32 j = 0; j < lods.length(); j++) assert(lods[j].get() == i * 10 + j);
+            auto parent = asset.get<"parent">();
+            assert(parent.ok() == (i > 0));
+            if(i) assert((*parent).get() == i - 1);
+        }
+
+        // Plain vectors are read in place.
+        Slice<Point> points = catalog.get<"points">().slice();
+        assert(points.length() == 1000 && points[999].x == 999.0f);
+        assert(reinterpret_cast<const u8*>(points.data()) > bytes.data());
+        assert(reinterpret_cast<const u8*>(points.data()) < bytes.data() + bytes.length());
+
+        auto by_name = catalog.get<"by_name">();
+        assert(by_name.length() == 50);
+        assert((*by_name.find("asset42"_v)).get() == 42);
+        assert(!by_name.find("asset50"_v).ok());
+        u64 entries = 0;
+        by_name.each([&](Flat::View<String<>> name, Flat::View<u32> index) {
+            assert(name.view() == assets[index.get()].get<"name">().view());
+            entries++;
+        });
+        assert(entries == 50);
+
+        auto anchors = catalog.get<"anchors">();
+        assert((*anchors.find(u64{1} << 50)).get().y == 4.0f);
+        assert(!anchors.find(u64{4}).ok());
+    }
+    Trace("Validate") {
+        Vec<u8> bytes;
+        (void)Flat::write(bytes, make_catalog());
+        Slice<u8> all{bytes};
+
+        for(u64 length : {u64{0}, u64{8}, bytes.length() / 2, bytes.length() - 1}) {
+            assert(!Flat::open<Catalog>(all.sub(0, length)).ok());
+        }
+        assert(!Flat::open<Catalog>(all.sub(1, bytes.length() - 1)).ok());
+
+        // The assets header follows the version at offset 8.
+        u64 offset = 0;
+        Libc::memcpy(&offset, bytes.data() + 8, 8);
+        u64 corrupt = bytes.length();
+        Libc::memcpy(bytes.data() + 8, &corrupt, 8);
+        assert(!Flat::open<Catalog>(all).ok());
+        Libc::memcpy(bytes.data() + 8, &offset, 8);
+        assert(Flat::open<Catalog>(all).ok());
+
+        // So does an out of range enum, found through the first asset.
+        u64 first = 8 + offset;
+        u8& kind = bytes[first + 16];
+        kind = 2;
+        assert(!Flat::open<Catalog>(all).ok());
+        kind = 3;
+        assert(Flat::open<Catalog>(all).ok());
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+
+#include "test.h"
+
+#include <rpp/flat_map.h>
+#include <rpp/rng.h>
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Insert") {
+        Flat_Map<u32, String<>> map;
+        assert(map.empty() && !map.contains(1u));
+        for(u32 i = 0; i < 100; i++) {
+            u32 key = (i * 37) % 100;
+            map.insert(key, format<Mdefault>("%"_v, key));
+        }
+        map.insert(5u, "five"_v.string<Mdefault>());
+        assert(map.length() == 100 && map.get(5u) == "five"_v);
+        for(u32 i = 1; i < map.length(); i++) assert(map.key(i - 1) < map.key(i));
+
+        assert(map.lower_bound(50u) == 50 && map.upper_bound(50u) == 51);
+        assert(map.lower_bound(1000u) == 100);
+        assert(map.try_erase(50u) && !map.try_erase(50u));
+        assert(map.lower_bound(50u) == 50 && map.key(50) == 51);
+
+        u64 count = 0;
+        map.each_in(10u, 20u, [&](const u32& key, String<>& value) {
+            assert(key >= 10 && key < 20 && value.length());
+            count++;
+        });
+        assert(count == 10);
+        assert(format<Mdefault>("%"_v, Flat_Map<i32, i32>{}) == "Flat_Map[]"_v);
+    }
+    Trace("Search") {
+        // Unsigned keys above the signed range still order correctly in the vector scan.
+        Flat_Map<u32, u32> map;
+        for(u32 i = 0; i < 1000; i++) map.insert(u32{0xffffffff} - i * 4000000, u32{i});
+        for(u32 i = 0; i < 1000; i++) {
+            u32 key = u32{0xffffffff} - i * 4000000;
+            assert(map.get(key) == i);
+            assert(!map.contains(key - 1));
+            assert(map.lower_bound(key) == 999 - i);
+        }
+
+        Flat_Map<i32, i32> signs;
+        for(i32 i = -500; i < 500; i++) signs.insert(i * 7, i32{i});
+        for(i32 i = -500; i < 500; i++) {
+            assert(signs.lower_bound(i * 7 - 1) == static_cast<u64>(i + 500));
+        }
+    }
+    Trace("Commit") {
+        Flat_Map<u64, u64> map;
+        Map<u64, u64> expected;
+        RNG::Stream rng(5);
+        for(u64 round = 0; round < 10; round++) {
+            for(u64 i = 0; i < 500; i++) {
+                u64 key = rng.range(u64{0}, u64{2000});
+                u64 value = round * 1000 + i;
+                map.stage(key, value);
+                expected.insert(u64{key}, u64{value});
+            }
+            map.commit();
+            assert(map.length() == expected.length());
+            for(auto& item : expected) assert(map.get(item.first) == item.second);
+            for(u64 i = 1; i < map.length(); i++) assert(map.key(i - 1) < map.key(i));
+        }
+    }
+    return 0;
+}
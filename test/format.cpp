@@ -149,5 +149,29 @@ i32 main() {
                        9.0f, 10.0f, 11.0f, 12.0f, //
                        13.0f, 14.0f, 15.0f, 16.0f});
     }
+    {
+        auto check = [](String_View expected, const auto& value) {
+            Region(R) assert(format<Mregion<R>>("%"_v, value).view() == expected);
+        };
+        check("0"_v, 0);
+        check("-7"_v, static_cast<i8>(-7));
+        check("-9223372036854775808"_v, Limits<i64>::min());
+        check("18446744073709551615"_v, Limits<u64>::max());
+        check("1000000"_v, 1000000u);
+        check("0.1"_v, 0.1f);
+        check("0.1"_v, 0.1);
+        check("-2.5"_v, -2.5);
+        check("1e21"_v, 1e21);
+        check("1.5e-7"_v, 1.5e-7);
+        check("3.4028235e38"_v, 3.4028235e38f);
+        check("(0x10)"_v, reinterpret_cast<void*>(16));
+        Region(R) assert(format<Mregion<R>>("a%b%c"_v, 1.0f, 22).view() == "a1.0b22c"_v);
+        Region(R) {
+            assert(format<Mregion<R>>("a%b%c", 1.0f, 22).view() == "a1.0b22c"_v);
+            assert(format<Mregion<R>>("100%% % %%%", 5, 6).view() == "100% 5 %6"_v);
+            assert(format<Mregion<R>>("%%").view() == "%"_v);
+            assert(format<Mregion<R>>("").view().empty());
+        }
+    }
     return 0;
 }
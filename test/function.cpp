@@ -82,5 +82,59 @@ i32 main() {
             },
         };
     }
+    {
+        struct Huge {
+            u64 data[16];
+        };
+        Huge huge{};
+        huge.data[15] = 7;
+
+        static_assert(!Function<u64()>::fits<Huge>);
+        Function<u64()> spilled{[huge]() { return huge.data[15]; }};
+        Function<u64()> moved = move(spilled);
+        assert(moved() == 7);
+
+        static u64 drops = 0;
+        struct Probe {
+            Probe() noexcept = default;
+            Probe(Probe&&) noexcept = default;
+            ~Probe() noexcept {
+                drops++;
+            }
+            Huge huge{};
+        };
+        {
+            Function<void()> owner{[probe = Probe{}]() { (void)probe; }};
+            drops = 0;
+            Function<void()> next = move(owner);
+            next();
+        }
+        assert(drops == 1);
+    }
+    {
+        struct Free {
+            static i32 add(i32 a, i32 b) noexcept {
+                return a + b;
+            }
+        };
+        Function<i32(i32, i32)> direct{&Free::add};
+        assert(direct(2, 3) == 5);
+        Function<i32(i32, i32)> direct2 = move(direct);
+        assert(direct2(3, 4) == 7);
+
+        i32 total = 0;
+        auto accumulate = [&total](i32 i) { total += i; };
+        auto each = [](Function_Ref<void(i32)> f) {
+            for(i32 i = 0; i < 4; i++) f(i);
+        };
+        each(accumulate);
+        each([&total](i32 i) { total -= i; });
+        assert(total == 0);
+
+        Function_Ref<i32(i32, i32)> ref{&Free::add};
+        Function_Ref<i32(i32, i32)> ref2 = ref;
+        assert(ref2(1, 1) == 2);
+        static_assert(sizeof(Function_Ref<void()>) == 16);
+    }
     return 0;
 }
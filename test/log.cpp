@@ -0,0 +1,73 @@
+
+#include "test.h"
+
+#include <rpp/thread.h>
+
+i32 main() {
+    Test test{"log"_v};
+    Trace("Async") {
+        Log::start_async();
+        info("Async %", 1);
+        warn("Async %", 2);
+        Log::flush();
+
+        Vec<Thread::Future<void>> tasks;
+        for(u64 i = 0; i < 4; i++) {
+            tasks.push(Thread::spawn([]() {
+                for(u64 j = 0; j < 4; j++) info("Hello from thread");
+            }));
+        }
+        for(auto& task : tasks) {
+            task->block();
+        }
+        Log::stop_async();
+        assert(Log::dropped() == 0);
+        info("Sync");
+    }
+    Trace("Overflow") {
+        Log::start_async(Log::Async_Config{.ring_size = 256});
+        Thread::spawn([]() {
+            Region(R) {
+                String<Mregion<R>> big{512};
+                big.set_length(512);
+                for(u8& c : big) c = 'x';
+                info("%", big);
+            }
+        })->block();
+        Log::stop_async();
+        assert(Log::dropped() == 1);
+    }
+    Trace("Binary") {
+        Log::start_async(Log::Async_Config{.binary = "log.rpplog"_v});
+        info("Binary % % %", 1, 2.5, true);
+        info("Formatted %", "text"_v);
+        Log::stop_async();
+
+        auto binary = Files::read("log.rpplog"_v);
+        assert(binary.ok());
+        Vec<String<>> messages;
+        assert(Log::read_binary(Slice<u8>{*binary}, [&](Log::Level level, Thread::Id, Log::Time,
+                                                       Log::Location, String_View msg) {
+            assert(level == Log::Level::info);
+            messages.push(msg.string<Mdefault>());
+        }));
+        assert(messages.length() == 1 && messages[0].view() == "Binary 1 2.5 true"_v);
+        assert(!Log::print_binary(Slice<u8>{binary->data(), 4}));
+        assert(Files::remove("log.rpplog"_v));
+    }
+    Trace("Filter") {
+        u64 evaluated = 0;
+        trace("Trace %", evaluated++);
+        assert(evaluated == 0);
+
+        Log::set_min_level(Log::Level::warn);
+        info("Hidden %", evaluated++);
+        assert(evaluated == 0 && Log::min_level() == Log::Level::warn);
+        Log::set_min_level(Log::Level::trace);
+
+        Log::set_rate_limit(2);
+        for(u64 i = 0; i < 8; i++) info("Limited");
+        Log::set_rate_limit(0);
+    }
+    return 0;
+}
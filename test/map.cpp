@@ -45,6 +45,10 @@ i32 main() {
         assert(v.length() == 3);
         assert(v.get(1) == 1);
 
+        v.insert(1, 10);
+        assert(v.length() == 3 && v.get(1) == 10);
+        v.insert(1, 1);
+
         v.erase(2);
         assert(v.length() == 2);
         assert(v.get(3) == 3);
@@ -68,6 +72,62 @@ i32 main() {
         for(i32 i = 0; i < 40; i++) {
             ff.insert(i, []() { info("Hello"); });
         }
+
+        Map<i32, i32> inc;
+        inc.set_incremental(true);
+        for(i32 i = 0; i < 10000; i++) {
+            inc.insert(i, i);
+            if(i % 3 == 0) inc.erase(i);
+            if(inc.migrating()) {
+                for(i32 j = 0; j <= i; j += 7) assert(inc.contains(j) == (j % 3 != 0));
+            }
+        }
+        u64 count = 0;
+        for(auto& [k, vv] : inc) {
+            assert(k == vv && k % 3 != 0);
+            count++;
+        }
+        assert(count == inc.length());
+        for(i32 i = 0; i < 10000; i++) {
+            assert(inc.contains(i) == (i % 3 != 0));
+        }
+        inc.finish_migration();
+        assert(!inc.migrating());
+        assert(inc.length() == count);
+    }
+    Trace("Batch") {
+        Vec<Pair<i32, i32>> pairs;
+        for(i32 i = 0; i < 1000; i++) pairs.push(Pair{i, i * 2});
+        Map<i32, i32> map;
+        map.insert_batch(Slice<Pair<i32, i32>>{pairs});
+        assert(map.length() == 1000);
+        map.insert_batch(Slice<Pair<i32, i32>>{pairs});
+        assert(map.length() == 1000 && map.get(999) == 1998);
+
+        Map<i32, String<>> strings;
+        Vec<Pair<i32, String<>>> owned;
+        for(i32 i = 0; i < 100; i++) owned.push(Pair{i, format<Mdefault>("%"_v, i)});
+        strings.set_incremental(true);
+        strings.insert(-1, "x"_v.string<Mdefault>());
+        strings.insert_batch(rpp::move(owned));
+        assert(strings.length() == 101 && !strings.migrating());
+        assert(strings.get(42).view() == "42"_v);
+
+        Vec<i32> keys;
+        for(i32 i = -50; i < 1050; i += 3) keys.push(i);
+        Vec<Opt<Ref<i32>>> found;
+        map.get_batch(Slice<i32>{keys}, found);
+        assert(found.length() == keys.length());
+        for(u64 i = 0; i < keys.length(); i++) {
+            bool present = keys[i] >= 0 && keys[i] < 1000;
+            assert(found[i].ok() == present);
+            if(present) assert(**found[i] == keys[i] * 2);
+        }
+
+        const Map<i32, i32>& constmap = map;
+        Vec<Opt<Ref<const i32>>> found_const;
+        constmap.get_batch(Slice<i32>{keys}, found_const);
+        assert(found_const.length() == keys.length() && **found_const[17] == keys[17] * 2);
     }
     return 0;
 }
@@ -1,7 +1,9 @@
 
 #include "test.h"
 
+#include <rpp/asyncio.h>
 #include <rpp/net.h>
+#include <rpp/pool.h>
 
 i32 main() {
     Test test{"net"_v};
@@ -24,5 +26,154 @@ i32 main() {
         assert(data->length == 5);
         info("%", String_View{packet.data(), data->length});
     }
+    {
+        Net::Address addr{"127.0.0.1"_v, 25566};
+        Net::Udp udp;
+        udp.bind(addr);
+
+        Array<Net::Packet, 8> out;
+        Array<Net::Udp::Message, 8> messages;
+        for(u64 i = 0; i < 8; i++) {
+            out[i][0] = static_cast<u8>(i);
+            // A run of equal lengths followed by singles.
+            messages[i] = Net::Udp::Message{addr, i < 5 ? 100 : 10 + i};
+        }
+        assert(udp.send(Slice<Net::Packet>{out}, Slice<Net::Udp::Message>{messages}) == 8);
+
+        Thread::sleep(100);
+
+        Array<Net::Packet, 8> in;
+        Array<Net::Udp::Data, 8> data;
+        u64 n = udp.recv(in, data);
+        assert(n == 8);
+        for(u64 i = 0; i < n; i++) {
+            assert(in[i][0] == i);
+            assert(data[i].length == (i < 5 ? 100 : 10 + i));
+        }
+    }
+    {
+        Async::Pool pool;
+        Net::Address addr{"127.0.0.1"_v, 25567};
+        Net::Udp udp;
+        udp.bind(addr);
+
+        auto job = [&pool_ = pool, &udp_ = udp, addr]() -> Async::Task<u64> {
+            auto& pool = pool_;
+            auto& udp = udp_;
+            Net::Packet packet;
+            packet[0] = 42;
+            u64 sent = co_await Async::send(pool, udp, addr, packet, 1);
+            assert(sent == 1);
+            packet[0] = 0;
+            Net::Udp::Data data = co_await Async::recv(pool, udp, packet);
+            assert(packet[0] == 42);
+            co_return data.length;
+        };
+        assert(job().block() == 1);
+    }
+    {
+        Async::Pool pool;
+        Net::Address addr{"127.0.0.1"_v, 25568};
+        Net::Tcp_Listener listener{addr};
+
+        auto server = [&pool_ = pool, &listener_ = listener]() -> Async::Task<u64> {
+            auto& pool = pool_;
+            auto& listener = listener_;
+            Opt<Net::Tcp_Stream> stream = co_await Async::accept(pool, listener);
+            assert(stream.ok());
+            u8 data[16] = {};
+            u64 received = 0;
+            while(received < 11) {
+                u64 n = co_await Async::read(pool, *stream, data + received, 16 - received);
+                if(n == 0) break;
+                received += n;
+            }
+            assert(String_View{data, received} == "Hello world"_v);
+            co_return received;
+        };
+        auto client = [&pool_ = pool, addr]() -> Async::Task<bool> {
+            auto& pool = pool_;
+            Opt<Net::Tcp_Stream> stream = co_await Async::connect(pool, addr);
+            assert(stream.ok());
+            stream->set_nodelay(true);
+            String_View hello = "Hello "_v;
+            String_View world = "world"_v;
+            Slice<u8> buffers[2] = {Slice<u8>{hello.data(), hello.length()},
+                                    Slice<u8>{world.data(), world.length()}};
+            co_return co_await Async::write(pool, *stream, Slice<Slice<u8>>{buffers, 2});
+        };
+        auto received = server();
+        assert(client().block());
+        assert(received.block() == 11);
+    }
+    {
+        Async::Pool pool;
+        Net::Address addr{"127.0.0.1"_v, 25569};
+        Net::Udp udp;
+        udp.bind(addr);
+
+        auto job = [&pool_ = pool, &udp_ = udp, addr]() -> Async::Task<Net::Packet_Ref> {
+            auto& pool = pool_;
+            auto& udp = udp_;
+            Net::Packet_Ref out = Net::Packet_Pool::acquire();
+            out->data[0] = 7;
+            out->length = 1;
+            assert(udp.send(addr, out) == 1);
+            co_return co_await Async::recv(pool, udp);
+        };
+        Net::Packet_Ref in = job().block();
+        assert(in.ok() && in->length == 1 && in->data[0] == 7);
+        Net::Packet_Ref shared = in.dup();
+        assert(in.references() == 2);
+    }
+    {
+        Net::Address v6{"::1"_v, 25570};
+        assert(v6.family() == Net::Family::ipv6 && v6.port() == 25570);
+        Net::Address v4{"127.0.0.1"_v, 25570};
+        assert(v4.family() == Net::Family::ipv4 && !(v4 == v6));
+        assert(v4 == (Net::Address{"127.0.0.1"_v, 25570}));
+
+        // A dual-stack socket exchanges datagrams with IPv4 peers.
+        Net::Udp server{Net::Family::ipv6};
+        server.bind(Net::Address{25570, Net::Family::ipv6});
+        Net::Udp client;
+        Net::Packet packet;
+        packet[0] = 4;
+        assert(client.send(v4, packet, 1) == 1);
+
+        Thread::sleep(100);
+
+        Opt<Net::Udp::Data> data = server.recv(packet);
+        assert(data.ok() && data->length == 1 && data->from.family() == Net::Family::ipv6);
+        packet[0] = 6;
+        assert(server.send(data->from, packet, 1) == 1);
+
+        Thread::sleep(100);
+
+        packet[0] = 0;
+        Opt<Net::Udp::Data> reply = client.recv(packet);
+        assert(reply.ok() && reply->length == 1 && packet[0] == 6);
+        assert(reply->from == v4);
+    }
+    {
+        Async::Pool pool;
+        Net::Address addr{"127.0.0.1"_v, 25571};
+        Net::Udp_Group group{addr, pool.n_threads()};
+        assert(group.length() >= 1);
+
+        // Datagrams from many source ports, spread over the group's sockets.
+        constexpr u64 SENDERS = 32;
+        Vec<Net::Udp> senders = Vec<Net::Udp>::make(SENDERS);
+        Net::Packet packet;
+        for(Net::Udp& sender : senders) assert(sender.send(addr, packet, 1) == 1);
+
+        Thread::sleep(100);
+
+        u64 received = 0;
+        for(u64 i = 0; i < group.length(); i++) {
+            while(group[i].recv(packet).ok()) received++;
+        }
+        assert(received == SENDERS);
+    }
     return 0;
 }
@@ -0,0 +1,63 @@
+#include "test.h"
+
+#include <rpp/parallel.h>
+#include <rpp/rng.h>
+
+i32 main() {
+    Test test{"empty"_v};
+    Async::Pool pool;
+    Trace("For") {
+        Vec<u64> in;
+        for(u64 i = 0; i < 10000; i++) in.push(i);
+        Vec<u64> out = Vec<u64>::make(in.length());
+
+        Async::parallel_for(pool, Slice{in}, 64, [&](u64 i, const u64& value) {
+            out[i] = value * 2;
+        }).block();
+        for(u64 i = 0; i < in.length(); i++) assert(out[i] == 2 * i);
+
+        Async::parallel_for(pool, Slice<u64>{}, 0, [](u64, const u64&) { assert(false); }).block();
+    }
+    Trace("Reduce") {
+        Vec<u64> in;
+        for(u64 i = 0; i < 10000; i++) in.push(i);
+
+        u64 sum = Async::parallel_reduce(
+                      pool, Slice{in}, 0, u64{0}, [](const u64& value) { return value; },
+                      [](u64 a, u64 b) { return a + b; })
+                      .block();
+        assert(sum == 10000 * 9999 / 2);
+
+        // Chunks are joined in order.
+        u64 last = Async::parallel_reduce(
+                       pool, Slice{in}, 16, u64{0}, [](const u64& value) { return value; },
+                       [](u64 a, u64 b) {
+                           assert(a <= b || b == 0);
+                           return b == 0 ? a : b;
+                       })
+                       .block();
+        assert(last == 9999);
+    }
+    Trace("Transform") {
+        Mat4 T = Mat4::translate(Vec3{1.0f, 2.0f, 3.0f}) * Mat4::scale(Vec3{2.0f});
+        Vec<Vec3> points;
+        for(u64 i = 0; i < 20000; i++) points.push(Vec3{static_cast<f32>(i), 1.0f, -1.0f});
+        Vec<Vec3> out = Vec<Vec3>::make(points.length());
+
+        Async::parallel_transform_points(pool, T, Slice{points}, out.data()).block();
+        for(u64 i = 0; i < points.length(); i++) assert(out[i] == T * points[i]);
+
+        Async::parallel_transform_vectors(pool, T, Slice{points}, out.data(), 100).block();
+        for(u64 i = 0; i < points.length(); i++) assert(out[i] == T.rotate(points[i]));
+    }
+    Trace("Sort") {
+        RNG::Stream rng{1};
+        for(u64 length : {0, 1, 15, 100, 10000}) {
+            Vec<u32> data;
+            for(u64 i = 0; i < length; i++) data.push(rng.range(0u, 100u));
+            Async::parallel_sort(pool, data, 32).block();
+            for(u64 i = 1; i < data.length(); i++) assert(data[i - 1] <= data[i]);
+        }
+    }
+    return 0;
+}
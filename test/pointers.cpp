@@ -1,6 +1,7 @@
 
 #include "test.h"
 #include <rpp/rc.h>
+#include <rpp/thread.h>
 
 i32 main() {
     Test test{"empty"_v};
@@ -68,5 +69,80 @@ i32 main() {
         assert(r1.references() == 2 && r3.references() == 2);
         assert(!r2.ok() && r2.references() == 0);
     }
+    Trace("Intrusive") {
+        struct Node {
+            explicit Node(i32 value) noexcept : value(value) {
+            }
+            Arc_Count references;
+            i32 value;
+        };
+        static_assert(Arc<Node>::intrusive && !Arc<i32>::intrusive);
+
+        Arc<Node> a{5};
+        assert(a->value == 5 && a.references() == 1 && a->references.value.load() == 1);
+        {
+            Arc<Node> b = Arc<Node>::from_this(&*a);
+            assert(a.references() == 2 && &*a == &*b);
+        }
+        assert(a.references() == 1);
+
+        struct Leaf {
+            Rc_Count references;
+            u64 value = 7;
+        };
+        Rc<Leaf> r = Rc<Leaf>::make();
+        Rc<Leaf> r2 = r.borrow().dup();
+        assert(r.references() == 2 && r2->value == 7);
+    }
+    Trace("Borrow") {
+        Arc<i32> a{5};
+        Borrow<i32, Arc<i32>> b = a.borrow();
+        assert(b.ok() && *b == 5 && a.references() == 1);
+
+        Arc<i32> a2 = b.dup();
+        assert(a.references() == 2 && *a2 == 5);
+
+        Rc<i32> r{6};
+        assert(*r.borrow() == 6 && r.references() == 1);
+    }
+    Trace("Biased_Arc") {
+        struct Probe {
+            Thread::Atomic* destroyed;
+            ~Probe() {
+                destroyed->incr();
+            }
+        };
+        Thread::Atomic destroyed;
+
+        Biased_Arc<Probe> r1{&destroyed};
+        assert(r1.ok() && r1.references() == 1);
+
+        Biased_Arc<Probe> r2 = r1.dup();
+        assert(r1.references() == 2 && r2.borrow()->destroyed == &destroyed);
+
+        Vec<Thread::Future<void>> tasks;
+        for(u64 i = 0; i < 4; i++) {
+            tasks.push(Thread::spawn([r = r1.dup()]() mutable {
+                for(u64 j = 0; j < 1000; j++) {
+                    Biased_Arc<Probe> copy = r.dup();
+                    assert(copy.ok());
+                }
+                r.clear();
+            }));
+        }
+        for(auto& task : tasks) {
+            task->block();
+        }
+        assert(r1.references() == 2 && destroyed.load() == 0);
+
+        // Drop the owner's references first, so the last one goes on another thread.
+        Biased_Arc<Probe> moved = r1.dup();
+        r1.clear();
+        r2.clear();
+        assert(destroyed.load() == 0);
+        auto last = Thread::spawn([r = move(moved)]() mutable { r.clear(); });
+        last->block();
+        assert(destroyed.load() == 1);
+    }
     return 0;
 }
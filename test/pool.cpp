@@ -4,6 +4,8 @@
 #include <rpp/asyncio.h>
 #include <rpp/pool.h>
 
+#include <stdio.h>
+
 auto lots_of_jobs(Async::Pool<>& pool, u64 depth) -> Async::Task<u64> {
     if(depth == 0) {
         co_return 1;
@@ -16,6 +18,64 @@ auto lots_of_jobs(Async::Pool<>& pool, u64 depth) -> Async::Task<u64> {
 
 i32 main() {
     Test test{"pool"_v};
+    {
+        Async::Pool pool{Async::Pool_Config{.threads = 3, .placement = Async::Placement::cores}};
+        assert(pool.n_threads() == 3);
+        assert(lots_of_jobs(pool, 8).block() == 256);
+    }
+    {
+        u64 cores[] = {0};
+        Async::Pool pool{Async::Pool_Config{.threads = 2, .cores = Slice<u64>{cores, 1}}};
+        assert(lots_of_jobs(pool, 8).block() == 256);
+    }
+    {
+        Async::Pool pool{Async::Pool_Config{.threads = 1}};
+        Vec<i32> order;
+
+        auto job = [&](Thread::Priority priority, i32 id) -> Async::Task<void> {
+            co_await pool.suspend(priority);
+            order.push(id);
+        };
+        auto deadline = [&](u64 ms, i32 id) -> Async::Task<void> {
+            co_await pool.suspend_until(Async::Pool<>::now() + ms);
+            order.push(id);
+        };
+        auto root = [&]() -> Async::Task<void> {
+            co_await pool.suspend();
+            Vec<Async::Task<void>> tasks;
+            tasks.push(job(Thread::Priority::low, 0));
+            tasks.push(job(Thread::Priority::normal, 1));
+            tasks.push(deadline(100, 2));
+            tasks.push(deadline(50, 3));
+            tasks.push(job(Thread::Priority::high, 4));
+            tasks.push(job(Thread::Priority::critical, 5));
+            for(auto& task : tasks) co_await task;
+        };
+        root().block();
+        assert(order.length() == 6);
+        for(u64 i = 0; i < 6; i++) assert(order[i] == static_cast<i32>(5 - i));
+    }
+    {
+        Async::Pool pool{Async::Pool_Config{.threads = 3}};
+
+        auto leaf = [&pool](u64 i) -> Async::Lazy<u64> {
+            co_await pool.suspend();
+            co_return i;
+        };
+        auto root = [&]() -> Async::Task<u64> {
+            co_await pool.suspend();
+            Vec<Async::Lazy<u64>> children;
+            for(u64 i = 0; i < 1000; i++) {
+                children.push(leaf(i));
+                pool.launch(children.back());
+            }
+            Async::Lazy<u64> inline_child = leaf(1000);
+            u64 sum = co_await inline_child;
+            for(auto& child : children) sum += co_await child;
+            co_return sum;
+        };
+        assert(root().block() == 1000 * 1001 / 2);
+    }
     {
         Async::Pool pool;
 
@@ -141,5 +201,103 @@ i32 main() {
             info("Waited 100ms.");
         }
     }
+    for(u64 event_threads = 1; event_threads <= 2; event_threads++) {
+        Async::Pool pool{event_threads};
+        assert(pool.n_event_threads() == event_threads);
+        {
+            Vec<Async::Task<void>> waits;
+            for(u64 i = 0; i < 100; i++) {
+                waits.push(Async::wait(pool, 10));
+            }
+            for(auto& wait : waits) {
+                wait.block();
+            }
+        }
+    }
+    {
+        Async::Pool pool{Async::Pool_Config{.threads = 4}};
+        auto child = [&pool](u64 i) -> Async::Task<u64> {
+            co_await pool.suspend();
+            Vec<u64, Async::Mtask> scratch(8);
+            for(u64 j = 0; j < 8; j++) scratch.push(i + j);
+            co_await pool.suspend();
+            u64 sum = 0;
+            for(u64 v : scratch) sum += v;
+            co_return sum;
+        };
+        auto request = [&]() -> Async::Task<bool> {
+            Async::Task_Arena& arena = co_await Async::arena();
+            Vec<u64, Async::Mtask> ids;
+            for(u64 i = 0; i < 1000; i++) {
+                ids.push(i);
+                if(i % 100 == 0) co_await pool.suspend();
+            }
+            // Created while the arena is current, so the children allocate from it too.
+            Vec<Async::Task<u64>> children;
+            for(u64 i = 0; i < 4; i++) children.push(child(i));
+            u64 total = 0;
+            for(auto& task : children) total += co_await task;
+            co_return ids.length() == 1000 && ids[999] == 999 && total == 160 &&
+                Async::Task_Arena::current() == &arena && arena.size() > 0;
+        };
+        assert(request().block());
+        assert(!Async::Task_Arena::current());
+    }
+    {
+        Async::Pool pool;
+        {
+            Async::Cancel_Token token;
+            Async::Task<bool> sleeper = Async::wait(pool, 60000, token);
+            Async::Task<bool> short_sleep = Async::wait(pool, 1, token);
+            assert(short_sleep.block());
+            token.cancel();
+            assert(!sleeper.block() && token.cancelled());
+            // Shed without suspending once cancelled.
+            assert(!Async::wait(pool, 60000, token).block());
+        }
+        {
+            Async::Cancel_Token token{Async::Pool<>::now() + 20};
+            assert(!Async::wait(pool, 60000, token).block());
+        }
+        {
+            Async::Cancel_Token parent;
+            Async::Cancel_Token child{parent, Async::Pool<>::now() + 60000};
+            assert(child.deadline() && !child.cancelled());
+
+            Net::Udp udp;
+            udp.bind(Net::Address{"127.0.0.1"_v, 25599});
+            Net::Packet packet;
+            Async::Task<Opt<Net::Udp::Data>> recv = Async::recv(pool, udp, packet, child);
+            parent.cancel();
+            assert(!recv.block().ok() && child.cancelled());
+        }
+        {
+            Net::Udp udp;
+            udp.bind(Net::Address{"127.0.0.1"_v, 25598});
+            Net::Packet packet;
+            Async::Cancel_Token token{Async::Pool<>::now() + 20};
+            assert(!Async::recv(pool, udp, packet, token).block().ok());
+        }
+    }
+    {
+        Async::Pool pool;
+        {
+            auto job = [&pool_ = pool]() -> Async::Task<bool> {
+                auto& pool = pool_;
+                u8 bytes[] = {1, 2, 3, 4, 5, 6, 7, 8};
+                if(!co_await Async::write(pool, "pool_io.tmp"_v, Slice<u8>{bytes, 8})) {
+                    co_return false;
+                }
+                Opt<Vec<u8, Files::Alloc>> all = co_await Async::read(pool, "pool_io.tmp"_v);
+                if(!all.ok() || all->length() != 8 || (*all)[7] != 8) co_return false;
+
+                u8 part[4] = {};
+                Opt<u64> n = co_await Async::read(pool, "pool_io.tmp"_v, 6, part, 4);
+                co_return n.ok() && *n == 2 && part[0] == 7 && part[1] == 8;
+            };
+            assert(job().block());
+        }
+        ::remove("pool_io.tmp");
+    }
     return 0;
 }
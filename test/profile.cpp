@@ -0,0 +1,153 @@
+#include "test.h"
+
+#include <rpp/files.h>
+
+i32 main() {
+    {
+        Test test{"empty"_v};
+
+        Profile::begin_frame();
+        for(u64 i = 0; i < 3; i++) {
+            Trace("Outer") {
+                Trace("Inner") {
+                }
+            }
+        }
+        Trace("Other") {
+        }
+        Profile::end_frame();
+
+        u64 nodes = 0;
+        Profile::iterate_timings([&](Thread::Id, const Profile::Timing_Node& node) {
+            nodes++;
+            if(node.loc.function == "Outer"_v) {
+                assert(node.calls == 3 && node.children.length() == 1);
+            } else if(node.loc.function == "Inner"_v) {
+                assert(node.calls == 3 && node.children.empty());
+            } else if(node.loc.function == "Other"_v) {
+                assert(node.calls == 1 && node.parent == 0);
+            } else {
+                assert(node.loc.function == "Frame"_v);
+                assert(node.children.length() == (DO_PROFILE ? 2 : 0));
+                assert(node.heir_time >= node.self_time);
+            }
+        });
+        assert(nodes == (DO_PROFILE ? 4 : 1));
+
+        // More frames than the history holds, so the oldest are recycled.
+        for(u64 frame = 0; frame < 20; frame++) {
+            Profile::begin_frame();
+            for(u64 i = 0; i <= frame % 3; i++) {
+                Trace("Recycled") {
+                }
+            }
+            Profile::end_frame();
+            nodes = 0;
+            Profile::iterate_timings([&](Thread::Id, const Profile::Timing_Node& node) {
+                nodes++;
+                if(node.loc.function == "Recycled"_v) {
+                    assert(node.calls == frame % 3 + 1 && node.children.empty());
+                }
+            });
+            assert(nodes == (DO_PROFILE ? 2 : 1));
+        }
+
+        Profile::set_counters(true);
+        Profile::begin_frame();
+        Trace("Counted") {
+            u64 sum = 0;
+            for(u64 i = 0; i < 1000; i++) sum = sum + i;
+            assert(sum == 499500);
+        }
+        Profile::end_frame();
+        Profile::set_counters(false);
+        // Machines without a PMU, such as most VMs, leave every count at zero.
+        if(Profile::counters_open()) {
+            Profile::iterate_timings([&](Thread::Id, const Profile::Timing_Node& node) {
+                assert(node.heir_counters.cycles >= node.self_counters.cycles);
+                assert(node.heir_counters.instructions >= node.self_counters.instructions);
+            });
+        }
+
+        assert(Profile::Sampler::start(1000));
+        Trace("Sampled") {
+            Profile::Time_Point start = Profile::timestamp();
+            while(Profile::s(Profile::timestamp() - start) < 0.1f) {
+            }
+        }
+        Profile::Sampler::stop();
+        u64 samples = 0;
+        Profile::Sampler::collect([&](const Profile::Sampler::Sample& sample) {
+            assert(sample.depth == 0 || sample.scopes[0] == "Sampled"_v);
+            samples++;
+        });
+        assert(samples > 0);
+
+        using Snapshot_Alloc = Mallocator<"Snapshot">;
+        void* kept[2] = {};
+        Trace("Allocating") {
+            kept[0] = Snapshot_Alloc::alloc(100);
+            kept[1] = Snapshot_Alloc::alloc(100);
+            Snapshot_Alloc::free(Snapshot_Alloc::alloc(100));
+        }
+        {
+            bool found = false;
+            for(auto& snapshot : Profile::snapshot_allocs()) {
+                if(snapshot.name != "Snapshot"_v) continue;
+                found = true;
+                assert(snapshot.allocates == 3 && snapshot.frees == 1);
+                assert(snapshot.live == 2 && snapshot.live_size == 200);
+                assert(snapshot.sizes[6] == 3);
+                assert(snapshot.sites.length() == 1 && snapshot.sites[0].site == "Allocating"_v);
+                assert(snapshot.sites[0].live == 2);
+            }
+            assert(found == DO_PROFILE);
+        }
+        Snapshot_Alloc::free(kept[0]);
+        Snapshot_Alloc::free(kept[1]);
+
+        Profile::begin_capture();
+        Trace("Captured") {
+        }
+        Profile::end_capture();
+        Trace("Ignored") {
+        }
+        String_View path = "profile_trace.tmp.json"_v;
+        assert(Profile::write_chrome_trace(path));
+        {
+            auto json = Files::read(path);
+            assert(json.ok());
+            String_View text{json->data(), json->length()};
+
+            // Only the timestamps vary between runs, so everything else is compared exactly.
+            u64 at = 0;
+            auto expect = [&](String_View part) {
+                assert(text.sub(at, Math::min(at + part.length(), text.length())) == part);
+                at += part.length();
+            };
+            auto number = [&]() {
+                u64 start = at;
+                while(at < text.length() && ((text[at] >= '0' && text[at] <= '9') ||
+                                             text[at] == '.' || text[at] == 'e' ||
+                                             text[at] == '-' || text[at] == '+')) {
+                    at++;
+                }
+                assert(at > start);
+            };
+            String<> where = format<Mdefault>(",\"pid\":0,\"tid\":%}"_v, Thread::this_id());
+
+            expect("{\"traceEvents\":[\n"_v);
+            expect("{\"ph\":\"B\",\"name\":\"Captured\",\"ts\":"_v);
+            number();
+            expect(where.view());
+            expect(",\n{\"ph\":\"E\",\"ts\":"_v);
+            number();
+            expect(where.view());
+            expect("\n]}\n"_v);
+            assert(at == text.length());
+        }
+        assert(Files::remove(path));
+    }
+    Profile::finalize();
+    return 0;
+}
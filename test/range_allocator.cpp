@@ -2,6 +2,7 @@
 #include "test.h"
 
 #include <rpp/range_allocator.h>
+#include <rpp/thread.h>
 
 i32 main() {
     Test test{"empty"_v};
@@ -27,5 +28,140 @@ i32 main() {
         }
         allocator.statistics().assert_clear();
     }
+
+    {
+        using Tlsf = Range_Allocator<Mdefault, 24, 8, Range_Mode::tlsf>;
+        Tlsf tlsf(Math::GB(1));
+        for(u64 i = 0; i < 20; i++) {
+            Vec<Tlsf::Range> allocations;
+            for(u64 j = 0; j < 1000; j++) {
+                u64 align = u64{1} << rng.range(u64{0}, u64{12});
+                u64 size = rng.range(static_cast<u64>(1), Math::KB(512));
+                auto mem = *tlsf.allocate(size, align);
+                assert(mem->offset % align == 0 && mem->length() >= size);
+                allocations.push(mem);
+            }
+            rng.shuffle(allocations);
+            for(u64 j = 0; j < allocations.length(); j += 2) tlsf.free(allocations[j]);
+            (void)tlsf.compact(64);
+            for(u64 j = 1; j < allocations.length(); j += 2) tlsf.free(allocations[j]);
+            tlsf.statistics().assert_clear();
+        }
+
+        // Sizes above the last class still find the block that fits them.
+        Tlsf huge(Math::GB(64));
+        auto whole = huge.allocate(Math::GB(64), 1);
+        assert(whole.ok() && !huge.allocate(1, 1).ok());
+        huge.free(*whole);
+        huge.statistics().assert_clear();
+    }
+
+    {
+        Range_Allocator<> small(Math::KB(64));
+        u64 sizes[] = {Math::KB(16), Math::KB(16), Math::KB(16)};
+        Range_Allocator<>::Range ranges[3];
+        assert(small.allocate(Slice<u64>{sizes, 3}, 256, ranges));
+        for(u64 i = 0; i < 3; i++) assert(ranges[i]->offset % 256 == 0);
+        u64 more[] = {Math::KB(8), Math::KB(32)};
+        Range_Allocator<>::Range extra[2];
+        assert(!small.allocate(Slice<u64>{more, 2}, 1, extra));
+        assert(small.statistics().allocated_blocks == 3);
+        small.free(Slice<Range_Allocator<>::Range>{ranges, 3});
+        small.statistics().assert_clear();
+    }
+
+    {
+        using Heap = Range_Allocator<>;
+        constexpr u64 N = 64;
+        Heap heap(Math::MB(1));
+        Vec<u8> memory = Vec<u8>::make(Math::MB(1));
+        RNG::Stream rng(1);
+
+        Heap::Range ranges[N];
+        for(u64 i = 0; i < N; i++) {
+            u64 size = rng.range(static_cast<u64>(1), Math::KB(8));
+            ranges[i] = *heap.allocate(size, 64);
+            Libc::memset(memory.data() + ranges[i]->offset, static_cast<i32>(i), size);
+        }
+        for(u64 i = 0; i < N; i += 2) heap.free(ranges[i]);
+        assert(heap.statistics().fragmentation() > 0.0);
+
+        auto apply = [&](const Vec<Heap::Move>& moves) {
+            u64 moved = 0;
+            for(const Heap::Move& move : moves) {
+                assert(move.to < move.from && move.to % 64 == 0);
+                assert(move.range->offset == move.to && move.range->length() == move.length);
+                Libc::memmove(memory.data() + move.to, memory.data() + move.from, move.length);
+                moved += move.length;
+            }
+            return moved;
+        };
+
+        // A budget too small for the first live range moves nothing.
+        assert(heap.compact(64, 0).empty());
+        u64 moved = apply(heap.compact(64, Math::KB(16)));
+        assert(moved > 0 && moved <= Math::KB(16));
+        assert(heap.statistics().allocated_blocks == N / 2);
+
+        apply(heap.compact(64));
+        Heap::Stats compacted = heap.statistics();
+        assert(compacted.free_blocks == 1);
+        assert(compacted.largest_free == compacted.free_size && compacted.fragmentation() == 0.0);
+        assert(compacted.free_size + compacted.allocated_size == Math::MB(1));
+        assert(heap.compact(64).empty());
+
+        for(u64 i = 1; i < N; i += 2) {
+            assert(ranges[i]->offset % 64 == 0);
+            for(u64 j = 0; j < ranges[i]->length(); j++) {
+                assert(memory[ranges[i]->offset + j] == i);
+            }
+            heap.free(ranges[i]);
+        }
+        heap.statistics().assert_clear();
+        assert(heap.statistics().largest_free == Math::MB(1));
+    }
+
+    {
+        using Sharded = Sharded_Range_Allocator<Mdefault, 4>;
+        Sharded sharded(Math::MB(64));
+
+        Vec<Thread::Future<bool>> threads;
+        for(u64 t = 0; t < 4; t++) {
+            threads.push(Thread::spawn([&sharded, t]() {
+                RNG::Stream rng(t);
+                Sharded::Cache cache(sharded);
+                Vec<Sharded::Range> live;
+                for(u64 i = 0; i < 10000; i++) {
+                    if(live.length() < 64 && (live.empty() || rng.range(u64{0}, u64{2}))) {
+                        u64 align = u64{1} << rng.range(u64{0}, u64{8});
+                        u64 size = rng.range(static_cast<u64>(1), Math::KB(64));
+                        auto range = *sharded.allocate(cache, size, align);
+                        assert(range->offset % align == 0 && range->length() >= size);
+                        live.push(range);
+                    } else {
+                        sharded.free(cache, live.back());
+                        live.pop();
+                    }
+                }
+                u64 sizes[8] = {};
+                for(u64 i = 0; i < 8; i++) sizes[i] = Math::KB(4) * (i + 1);
+                Sharded::Range batch[8];
+                assert(sharded.allocate(Slice<u64>{sizes, 8}, 64, batch));
+                sharded.free(Slice<Sharded::Range>{batch, 8});
+                for(auto range : live) sharded.free(cache, range);
+                return true;
+            }));
+        }
+        for(auto& thread : threads) assert(thread->block());
+
+        // Spans every shard, so it only fits when spread across several.
+        u64 sizes[8] = {};
+        for(u64 i = 0; i < 8; i++) sizes[i] = Math::MB(8);
+        Sharded::Range ranges[8];
+        assert(sharded.allocate(Slice<u64>{sizes, 8}, 1, ranges));
+        assert(!sharded.allocate(Math::MB(1), 1).ok());
+        sharded.free(Slice<Sharded::Range>{ranges, 8});
+        for(u64 i = 0; i < 4; i++) sharded.shard(i).statistics().assert_clear();
+    }
     return 0;
 }
@@ -0,0 +1,75 @@
+
+#include "test.h"
+
+#include <rpp/rng.h>
+
+using namespace rpp::SIMD;
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Noise") {
+        static_assert(RNG::noise(0, 0) == 0x16791e00u);
+        static_assert(RNG::noise(1, 0) == 0xc895cb1du);
+        static_assert(RNG::noise(1, 7) == 0xfcfd811cu);
+    }
+    Trace("Lanes") {
+        auto same = [](I32x8 a, I32x8 b) { return I32x8::movemask(I32x8::cmpeq(a, b)) == 0xff; };
+
+        RNG::Lanes a{1}, b{1}, c{1, 1};
+        for(u64 i = 0; i < 100; i++) {
+            I32x8 x = a.bits();
+            assert(same(x, b.bits()));
+            assert(!same(x, c.bits()));
+            i32 lanes[8];
+            I32x8::store(x, lanes);
+            for(u64 j = 1; j < 8; j++) assert(lanes[j] != lanes[0]);
+        }
+        assert(a.position() == 100);
+
+        RNG::Lanes skip{1};
+        skip.jump(50);
+        RNG::Lanes walk{1};
+        for(u64 i = 0; i < 50; i++) (void)walk.bits();
+        assert(same(skip.bits(), walk.bits()));
+
+        // Crossing into the upper half of the position rekeys the lanes.
+        RNG::Lanes wrap{1};
+        wrap.jump(Limits<u32>::max());
+        I32x8 last = wrap.bits();
+        assert(wrap.position() == u64{1} << 32);
+        RNG::Lanes start{1};
+        I32x8 first = wrap.bits();
+        assert(!same(first, start.bits()) && !same(first, last));
+    }
+    Trace("Distributions") {
+        constexpr u64 N = 100003;
+        Vec<f32> samples = Vec<f32>::make(N);
+        RNG::Lanes lanes{7, 3};
+
+        lanes.uniform(samples.data(), N);
+        f64 sum = 0.0;
+        for(f32 s : samples) {
+            assert(s >= 0.0f && s < 1.0f);
+            sum += s;
+        }
+        assert(Math::abs(sum / N - 0.5) < 0.01);
+
+        lanes.normal(samples.data(), N);
+        f64 mean = 0.0, square = 0.0;
+        for(f32 s : samples) {
+            mean += s;
+            square += static_cast<f64>(s) * s;
+        }
+        mean /= N;
+        assert(Math::abs(mean) < 0.02);
+        assert(Math::abs(square / N - mean * mean - 1.0) < 0.03);
+
+        RNG::Lanes other{7, 3};
+        F32x8 u = other.uniform();
+        RNG::Lanes again{7, 3};
+        f32 first[8];
+        again.uniform(first, 5);
+        for(u64 i = 0; i < 5; i++) assert(first[i] == u.data[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+
+#include <rpp/base.h>
+#include <rpp/files.h>
+#include <rpp/pool.h>
+
+#ifdef RPP_OS_WINDOWS
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+using namespace rpp;
+
+using Alloc = Mallocator<"Runner">;
+
+struct Case {
+    String_View path;
+    String_View name;
+    String<Alloc> output;
+    bool passed = false;
+    u64 ms = 0;
+};
+
+// Runs the executable at path with its output redirected to the file output, and reports whether
+// it exited with status zero.
+[[nodiscard]] static bool spawn(String_View path, const char* exe, String_View output,
+                                const char* out) noexcept {
+#ifdef RPP_OS_WINDOWS
+    SECURITY_ATTRIBUTES inherit = {sizeof(SECURITY_ATTRIBUTES), null, TRUE};
+    HANDLE file = CreateFileA(out, GENERIC_WRITE, FILE_SHARE_READ, &inherit, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, null);
+    if(file == INVALID_HANDLE_VALUE) {
+        warn("Failed to create %: %", output, Log::sys_error());
+        return false;
+    }
+
+    STARTUPINFOA startup = {};
+    startup.cb = sizeof(startup);
+    startup.dwFlags = STARTF_USESTDHANDLES;
+    startup.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    startup.hStdOutput = file;
+    startup.hStdError = file;
+
+    PROCESS_INFORMATION process = {};
+    if(!CreateProcessA(exe, null, null, null, TRUE, 0, null, null, &startup, &process)) {
+        warn("Failed to run %: %", path, Log::sys_error());
+        CloseHandle(file);
+        return false;
+    }
+    WaitForSingleObject(process.hProcess, INFINITE);
+    DWORD code = 1;
+    GetExitCodeProcess(process.hProcess, &code);
+
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+    CloseHandle(file);
+    return code == 0;
+#else
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, out, O_WRONLY | O_CREAT | O_TRUNC,
+                                     0644);
+    posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+
+    char* argv[] = {const_cast<char*>(exe), null};
+    pid_t pid = 0;
+    int err = posix_spawn(&pid, exe, &actions, null, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if(err) {
+        errno = err;
+        warn("Failed to run %: %", path, Log::sys_error());
+        return false;
+    }
+
+    int status = 0;
+    while(waitpid(pid, &status, 0) == -1 && errno == EINTR) {
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+[[nodiscard]] static bool execute(String_View path, String_View output) noexcept {
+    bool passed = false;
+    Region(R) {
+        auto exe = path.terminate<Mregion<R>>();
+        auto out = output.terminate<Mregion<R>>();
+        passed = spawn(path, reinterpret_cast<const char*>(exe.data()), output,
+                       reinterpret_cast<const char*>(out.data()));
+    }
+    return passed;
+}
+
+// The workers block on their child processes, so the pool runs one test per worker at a time.
+[[nodiscard]] static Async::Task<void> run(Async::Pool<>& pool, Case& test) noexcept {
+    co_await pool.suspend();
+    u64 begin = Async::Pool<>::now();
+    test.passed = execute(test.path, test.output.view());
+    test.ms = Async::Pool<>::now() - begin;
+}
+
+// Executable name without its directory and extension, which is the name of the test.
+[[nodiscard]] static String_View stem(String_View path) noexcept {
+    u64 start = 0, end = path.length();
+    for(u64 i = 0; i < path.length(); i++) {
+        if(path[i] == '/' || path[i] == '\\') start = i + 1;
+    }
+    if(path.ends_with(".exe"_v) && end - start > 4) end -= 4;
+    return path.sub(start, end);
+}
+
+// Runs every test executable given on the command line in parallel, from the current directory
+// so that each finds its .expect file. The output of a test goes to <name>.output, and is printed
+// if the test fails.
+i32 main(i32 argc, char** argv) {
+    Vec<Case, Alloc> cases(static_cast<u64>(argc));
+    for(i32 i = 1; i < argc; i++) {
+        String_View path{argv[i]};
+        String_View name = stem(path);
+        cases.push(Case{path, name, name.append<Alloc>(".output"_v)});
+    }
+
+    u64 begin = Async::Pool<>::now();
+    {
+        Async::Pool pool;
+        Vec<Async::Task<void>, Alloc> tasks(cases.length());
+        for(Case& test : cases) tasks.push(run(pool, test));
+        for(Async::Task<void>& task : tasks) task.block();
+    }
+    u64 ms = Async::Pool<>::now() - begin;
+
+    u64 failed = 0;
+    for(Case& test : cases) {
+        if(test.passed) {
+            info("Passed % (% ms)", test.name, test.ms);
+            continue;
+        }
+        failed++;
+        warn("Failed % (% ms)", test.name, test.ms);
+        if(Opt<Vec<u8, Files::Alloc>> output = Files::read(test.output.view()); output.ok()) {
+            info("%", String_View{output->data(), output->length()});
+        }
+    }
+    info("% of % tests passed in % ms.", cases.length() - failed, cases.length(), ms);
+    return failed ? 1 : 0;
+}
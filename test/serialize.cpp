@@ -0,0 +1,177 @@
+
+#include "test.h"
+
+#include <rpp/serialize.h>
+
+using namespace rpp::Serialize;
+
+enum class Shape : u8 { circle = 1, square = 4 };
+
+struct Point {
+    f32 x;
+    f32 y;
+};
+
+struct Item {
+    bool visible;
+    char tag;
+    Shape shape;
+    i32 depth;
+    Point points[2];
+};
+
+struct Scene {
+    String<> name;
+    Vec<Point> outline;
+    Vec<Item> items;
+    Map<u64, Vec<i64>> layers;
+    Opt<u16> version;
+};
+
+RPP_ENUM(Shape, circle, RPP_CASE(circle), RPP_CASE(square));
+RPP_RECORD(Point, RPP_FIELD(x), RPP_FIELD(y));
+RPP_RECORD(Item, RPP_FIELD(visible), RPP_FIELD(tag), RPP_FIELD(shape), RPP_FIELD(depth),
+           RPP_FIELD(points));
+RPP_RECORD(Scene, RPP_FIELD(name), RPP_FIELD(outline), RPP_FIELD(items), RPP_FIELD(layers),
+           RPP_FIELD(version));
+
+static_assert(detail::Raw<Point, Integers::fixed>);
+static_assert(!detail::Raw<Point[2], Integers::varint>);
+static_assert(!detail::Raw<Item, Integers::fixed>);
+static_assert(!detail::Raw<Scene, Integers::fixed>);
+
+[[nodiscard]] static Scene make_scene() noexcept {
+    Scene scene;
+    scene.name = "scene"_v.string<Mdefault>();
+    for(u64 i = 0; i < 100; i++) {
+        scene.outline.push(Point{static_cast<f32>(i), -static_cast<f32>(i)});
+    }
+    scene.items.push(Item{true, 'a', Shape::square, -3, {Point{1.0f, 2.0f}, Point{3.0f, 4.0f}}});
+    scene.items.push(Item{false, 'b', Shape::circle, 1 << 20, {}});
+    scene.layers.insert(u64{7}, Vec<i64>{i64{-1}, i64{2}, Limits<i64>::min()});
+    scene.layers.insert(u64{1} << 40, Vec<i64>{});
+    scene.version = Opt<u16>{u16{3}};
+    return scene;
+}
+
+static void check_scene(const Scene& scene) noexcept {
+    Scene expected = make_scene();
+    assert(scene.name.view() == expected.name.view());
+    assert(scene.outline.length() == expected.outline.length());
+    for(u64 i = 0; i < scene.outline.length(); i++) {
+        assert(scene.outline[i].x == expected.outline[i].x);
+        assert(scene.outline[i].y == expected.outline[i].y);
+    }
+    assert(scene.items.length() == 2);
+    for(u64 i = 0; i < 2; i++) {
+        const Item& a = scene.items[i];
+        const Item& b = expected.items[i];
+        assert(a.visible == b.visible && a.tag == b.tag && a.shape == b.shape);
+        assert(a.depth == b.depth && a.points[1].y == b.points[1].y);
+    }
+    assert(scene.layers.length() == 2);
+    const Vec<i64>& layer = scene.layers.get(u64{7});
+    assert(layer.length() == 3 && layer[0] == -1 && layer[2] == Limits<i64>::min());
+    assert(scene.layers.get(u64{1} << 40).empty());
+    assert(scene.version.ok() && *scene.version == 3);
+}
+
+template<Integers I>
+[[nodiscard]] static u64 round_trip() noexcept {
+    Vec<u8> bytes;
+    write<I>(bytes, make_scene());
+
+    Scene scene;
+    assert(read<I>(Slice<u8>{bytes}, scene));
+    check_scene(scene);
+
+    // Every truncation is rejected.
+    for(u64 i = 0; i < bytes.length(); i++) {
+        Scene partial;
+        assert(!read<I>(Slice<u8>{bytes.data(), i}, partial));
+    }
+    bytes.push(0);
+    assert(!read<I>(Slice<u8>{bytes}, scene));
+    return bytes.length() - 1;
+}
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Scalars") {
+        Vec<u8> bytes;
+        Writer<Mdefault, Integers::varint> writer{bytes};
+        writer.integer(u64{0});
+        writer.integer(u64{127});
+        writer.integer(u64{128});
+        writer.integer(Limits<u64>::max());
+        writer.integer(i32{-1});
+        writer.integer(Limits<i64>::min());
+        writer.integer(i8{-128});
+        assert(bytes.length() == 1 + 1 + 2 + 10 + 1 + 10 + 2);
+        assert(bytes[0] == 0 && bytes[2] == 0x80 && bytes[3] == 0x01 && bytes[14] == 0x01);
+
+        Reader<Integers::varint> reader{Slice<u8>{bytes}};
+        u64 u = 1;
+        i32 i = 0;
+        i64 l = 0;
+        i8 c = 0;
+        assert(reader.integer(u) && u == 0);
+        assert(reader.integer(u) && u == 127);
+        assert(reader.integer(u) && u == 128);
+        assert(reader.integer(u) && u == Limits<u64>::max());
+        assert(reader.integer(i) && i == -1);
+        assert(reader.integer(l) && l == Limits<i64>::min());
+        assert(reader.integer(c) && c == -128);
+        assert(reader.done() && !reader.integer(u));
+
+        // Out of range values fail instead of truncating.
+        u8 overflow[] = {0x80, 0x02};
+        u8 small = 0;
+        Reader<Integers::varint> narrow{Slice<u8>{overflow, 2}};
+        assert(!narrow.integer(small));
+
+        f64 value = 0.0;
+        bool flag = false;
+        Shape shape = Shape::circle;
+        u8 bad_bool[] = {2};
+        u8 bad_shape[] = {2};
+        u8 good_shape[] = {4};
+        assert(!read(Slice<u8>{bad_bool, 1}, flag));
+        assert(!read(Slice<u8>{bad_shape, 1}, shape));
+        assert(read(Slice<u8>{good_shape, 1}, shape) && shape == Shape::square);
+
+        Vec<u8> f;
+        write(f, 0.25);
+        assert(f.length() == 8 && read(Slice<u8>{f}, value) && value == 0.25);
+    }
+    Trace("Records") {
+        u64 fixed = round_trip<Integers::fixed>();
+        u64 varint = round_trip<Integers::varint>();
+        assert(varint < fixed);
+
+        // Raw vectors are one length and a single copy.
+        Vec<u8> bytes;
+        Vec<Point> points{Point{1.0f, 2.0f}, Point{3.0f, 4.0f}};
+        write(bytes, points);
+        assert(bytes.length() == 8 + 2 * sizeof(Point));
+        assert(Libc::memcmp(bytes.data() + 8, points.data(), 2 * sizeof(Point)) == 0);
+
+        // A corrupt length can't make the reader allocate past the input.
+        u64 huge = Limits<u64>::max() / 2;
+        Vec<u8> lie;
+        write(lie, huge);
+        Vec<Point> none;
+        assert(!read(Slice<u8>{lie}, none));
+    }
+    Trace("Views") {
+        Vec<u8> bytes;
+        write(bytes, "hello"_v);
+        write(bytes, "world"_v);
+        Reader reader{Slice<u8>{bytes}};
+        String_View a, b;
+        assert(reader.read(a) && reader.read(b) && reader.done());
+        assert(a == "hello"_v && b == "world"_v);
+        assert(a.data() == bytes.data() + 8);
+    }
+    return 0;
+}
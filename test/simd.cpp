@@ -7,6 +7,11 @@
 
 using namespace rpp::SIMD;
 
+[[nodiscard]] static bool near_rel(f32 a, f64 b, f64 tolerance) noexcept {
+    f64 scale = rpp::Math::max(rpp::Math::abs(b), 1e-30);
+    return rpp::Math::abs(static_cast<f64>(a) - b) <= tolerance * scale;
+}
+
 i32 main() {
     Trace("SetZero4") {
         F32x4 f = F32x4::zero();
@@ -107,5 +112,167 @@ i32 main() {
         assert_near(dot_rev, 10949.15f); // should be commutative
     }
 
+    Trace("Reduce4") {
+        F32x4 a = F32x4::set(4.0f, -2.0f, 8.0f, 1.0f);
+        assert(F32x4::hsum(a) == 11.0f);
+        assert(F32x4::hmin(a) == -2.0f);
+        assert(F32x4::hmax(a) == 8.0f);
+
+        F32x4 fma = F32x4::fma(a, F32x4::set1(2.0f), F32x4::one());
+        assert(F32x4::cmpeq_all(fma, F32x4::set(9.0f, -3.0f, 17.0f, 3.0f)));
+
+        F32x4 shuffled = F32x4::shuffle<3, 2, 1, 0>(a);
+        assert(F32x4::cmpeq_all(shuffled, F32x4::set(1.0f, 8.0f, -2.0f, 4.0f)));
+
+        F32x4 root = F32x4::sqrt(F32x4::set(4.0f, 9.0f, 16.0f, 0.0f));
+        assert(F32x4::cmpeq_all(root, F32x4::set(2.0f, 3.0f, 4.0f, 0.0f)));
+    }
+
+    Trace("Masks4") {
+        F32x4 a = F32x4::set(1.0f, 2.0f, 3.0f, 4.0f);
+        F32x4 b = F32x4::set(4.0f, 2.0f, 1.0f, 5.0f);
+        assert(I32x4::movemask(F32x4::cmplt(a, b)) == 0b1001);
+        assert(I32x4::movemask(F32x4::cmple(a, b)) == 0b1011);
+        assert(I32x4::movemask(F32x4::cmpeq(a, b)) == 0b0010);
+
+        F32x4 lesser = F32x4::select(F32x4::cmplt(a, b), a, b);
+        assert(F32x4::cmpeq_all(lesser, F32x4::min(a, b)));
+
+        I32x4 truncated = F32x4::to_i32(F32x4::set(1.5f, -1.5f, 2.9f, 0.0f));
+        assert(I32x4::movemask(I32x4::cmpeq(truncated, I32x4::set(1, -1, 2, 0))) == 0xf);
+        assert(F32x4::cmpeq_all(F32x4::from_i32(I32x4::set(1, 2, 3, 4)), a));
+    }
+
+    Trace("Memory") {
+        f32 values[8] = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f};
+        Slice<f32> slice{values, 8};
+
+        F32x4 a = F32x4::load(slice, 4);
+        assert(F32x4::cmpeq_all(a, F32x4::set(4.0f, 5.0f, 6.0f, 7.0f)));
+
+        F32x4 gathered = F32x4::gather(values, I32x4::set(7, 0, 3, 3));
+        assert(F32x4::cmpeq_all(gathered, F32x4::set(7.0f, 0.0f, 3.0f, 3.0f)));
+
+        f32 out[4] = {};
+        F32x4::store(a, out);
+        assert(out[0] == 4.0f && out[3] == 7.0f);
+
+        F32x8 wide = F32x8::load(slice);
+        assert(F32x8::hsum(wide) == 28.0f);
+        assert(F32x8::hmin(wide) == 0.0f && F32x8::hmax(wide) == 7.0f);
+        assert(F32x4::cmpeq_all(F32x8::high(wide), a));
+    }
+
+    Trace("Operations8") {
+        F32x8 a = F32x8::combine(F32x4::set(1.0f, 2.0f, 3.0f, 4.0f),
+                                 F32x4::set(-1.0f, -2.0f, -3.0f, -4.0f));
+        F32x8 b = F32x8::set1(2.0f);
+
+        F32x8 sum = F32x8::add(a, b);
+        assert(F32x4::cmpeq_all(F32x8::low(sum), F32x4::set(3.0f, 4.0f, 5.0f, 6.0f)));
+        assert(F32x4::cmpeq_all(F32x8::high(sum), F32x4::set(1.0f, 0.0f, -1.0f, -2.0f)));
+
+        F32x8 fma = F32x8::fma(a, b, F32x8::set1(1.0f));
+        assert(F32x8::hsum(fma) == 8.0f);
+
+        assert(I32x8::movemask(F32x8::cmplt(a, b)) == 0b11110001);
+        F32x8 clamped = F32x8::select(F32x8::cmplt(a, F32x8::zero()), F32x8::zero(), a);
+        assert(F32x8::hmin(clamped) == 0.0f && F32x8::hsum(clamped) == 10.0f);
+        assert(F32x8::hsum(F32x8::abs(a)) == 20.0f);
+    }
+
+    Trace("Integers") {
+        I32x4 a = I32x4::set(1, -2, 3, -4);
+        I32x4 b = I32x4::set1(3);
+        assert(I32x4::hsum(I32x4::add(a, b)) == 10);
+        assert(I32x4::hsum(I32x4::mul(a, b)) == -6);
+        assert(I32x4::movemask(I32x4::cmpgt(b, a)) == 0b1011);
+        assert(I32x4::hsum(I32x4::max(a, I32x4::zero())) == 4);
+        assert(I32x4::hsum(I32x4::shl(I32x4::set1(1), 4)) == 64);
+        assert(I32x4::movemask(I32x4::shr(I32x4::set1(-1), 31)) == 0);
+        assert(I32x4::hsum(I32x4::bit_and(I32x4::set1(6), I32x4::set1(3))) == 8);
+
+        I32x8 wide = I32x8::combine(a, b);
+        assert(I32x8::hsum(wide) == 10);
+        assert(I32x8::movemask(wide) == 0b1010);
+        assert(I32x8::hsum(I32x8::sub(wide, I32x8::set1(1))) == 2);
+
+        i32 table[4] = {10, 20, 30, 40};
+        assert(I32x4::hsum(I32x4::gather(table, I32x4::set(0, 1, 2, 3))) == 100);
+    }
+
+    Trace("Bytes") {
+        u8 bytes[16] = {};
+        for(u8 i = 0; i < 16; i++) bytes[i] = i;
+        U8x16 a = U8x16::load(bytes);
+
+        u8 reverse[16] = {};
+        for(u8 i = 0; i < 16; i++) reverse[i] = i == 0 ? 0xff : static_cast<u8>(15 - i);
+        U8x16 shuffled = U8x16::shuffle(a, U8x16::load(reverse));
+        u8 out[16] = {};
+        U8x16::store(shuffled, out);
+        assert(out[0] == 0 && out[1] == 14 && out[15] == 0);
+
+        assert(U8x16::high_mask(U8x16::cmpeq(a, U8x16::set1(3))) == 0b1000);
+        assert(U8x16::cmpeq_mask(U8x16::bit_or(a, U8x16::set1(1)), 1) == 0b11);
+        assert(U8x16::cmpeq_mask(U8x16::bit_andnot(a, U8x16::set1(1)), 0) == 0b11);
+    }
+
+    Trace("Transcendental") {
+        constexpr f64 E = 2.718281828459045;
+        for(i32 i = -400; i <= 400; i++) {
+            f32 x = static_cast<f32>(i) * 0.25f;
+            f32 sin = F32x4::sin(F32x4::set1(x)).data[0];
+            f32 cos = F32x4::cos(F32x4::set1(x)).data[0];
+            assert(rpp::Math::abs(sin - rpp::Math::sin(x)) < 1e-6f);
+            assert(rpp::Math::abs(cos - rpp::Math::cos(x)) < 1e-6f);
+            assert(rpp::Math::fast_sin(x) == sin && rpp::Math::fast_cos(x) == cos);
+
+            f32 e = static_cast<f32>(i) * 0.2f;
+            assert(near_rel(rpp::Math::fast_exp(e), rpp::Math::pow(E, static_cast<f64>(e)), 1e-6));
+
+            f32 y = static_cast<f32>(i % 7) - 3.0f;
+            f64 atan2 = rpp::Math::atan2(static_cast<f64>(y), static_cast<f64>(x));
+            assert(near_rel(rpp::Math::fast_atan2(y, x), atan2, 1e-6));
+        }
+        for(i32 i = 1; i <= 1000; i++) {
+            f32 x = static_cast<f32>(i) * 0.1f;
+            assert(near_rel(rpp::Math::fast_exp(rpp::Math::fast_log(x)), x, 1e-5));
+            assert(near_rel(rpp::Math::fast_rsqrt(x), 1.0 / rpp::Math::sqrt(static_cast<f64>(x)),
+                            1e-6));
+            assert(near_rel(rpp::Math::fast_pow(x, 1.5f),
+                            rpp::Math::pow(static_cast<f64>(x), 1.5), 1e-5));
+        }
+        assert(near_rel(rpp::Math::fast_log(8.0f), 3.0 * 0.6931471805599453, 1e-7));
+        assert(near_rel(rpp::Math::fast_log(Limits<f32>::smallest_denorm()), -103.27892990343185,
+                        1e-7));
+
+        assert(rpp::Math::fast_log(0.0f) < Limits<f32>::min());
+        f32 nan = rpp::Math::fast_log(-1.0f);
+        assert(nan != nan);
+        assert(rpp::Math::fast_exp(100.0f) > Limits<f32>::max());
+        assert(rpp::Math::fast_exp(-100.0f) == 0.0f);
+        assert(rpp::Math::fast_pow(0.0f, 0.0f) == 1.0f && rpp::Math::fast_pow(5.0f, 0.0f) == 1.0f);
+        assert(rpp::Math::fast_atan2(0.0f, 0.0f) == 0.0f);
+
+        f32 as[8] = {-3.0f, -0.5f, 0.25f, 1.0f, 2.0f, 10.0f, 50.0f, 99.0f};
+        f32 bs[8] = {0.5f, 2.0f, -1.0f, 3.0f, -2.5f, 0.0f, 1.0f, -4.0f};
+        F32x8 a = F32x8::load(as), b = F32x8::load(bs);
+        F32x8 sin = F32x8::sin(a), cos = F32x8::cos(a), exp = F32x8::exp(b);
+        F32x8 log = F32x8::log(a), atan2 = F32x8::atan2(b, a), rsqrt = F32x8::rsqrt(a);
+        F32x8 pow = F32x8::pow(F32x8::abs(a), b);
+        for(u64 i = 0; i < 8; i++) {
+            f32 x = a.data[i], y = b.data[i];
+            assert(sin.data[i] == rpp::Math::fast_sin(x) && cos.data[i] == rpp::Math::fast_cos(x));
+            assert(exp.data[i] == rpp::Math::fast_exp(y));
+            assert(atan2.data[i] == rpp::Math::fast_atan2(y, x));
+            assert(pow.data[i] == rpp::Math::fast_pow(rpp::Math::abs(x), y));
+            if(x > 0.0f) {
+                assert(log.data[i] == rpp::Math::fast_log(x));
+                assert(rsqrt.data[i] == rpp::Math::fast_rsqrt(x));
+            }
+        }
+    }
+
     return 0;
 }
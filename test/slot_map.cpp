@@ -0,0 +1,66 @@
+
+#include "test.h"
+
+#include <rpp/rng.h>
+#include <rpp/slot_map.h>
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Basic") {
+        Slot_Map<String<>> map;
+        assert(map.empty());
+        Slot_Handle a = map.insert("a"_v.string<Mdefault>());
+        Slot_Handle b = map.insert("b"_v.string<Mdefault>());
+        Slot_Handle c = map.emplace("c"_v.string<Mdefault>());
+        assert(map.length() == 3);
+        assert(map.get(a).view() == "a"_v && map.get(c).view() == "c"_v);
+        assert(Slot_Handle::from_raw(b.raw()) == b);
+
+        assert(map.try_erase(a) && !map.try_erase(a));
+        assert(!map.contains(a) && !map.try_get(a).ok());
+        assert(map.contains(b) && map.get(b).view() == "b"_v);
+        assert(map.get(c).view() == "c"_v);
+        assert(map.length() == 2);
+
+        // The freed slot is reused under a new generation.
+        Slot_Handle d = map.insert("d"_v.string<Mdefault>());
+        assert(d.index == a.index && d.generation != a.generation);
+        assert(!map.contains(a) && map.get(d).view() == "d"_v);
+
+        u64 count = 0;
+        map.each([&](Slot_Handle handle, String<>& value) {
+            assert(map.get(handle).view() == value.view());
+            count++;
+        });
+        assert(count == 3);
+
+        map.clear();
+        assert(map.empty() && !map.contains(b) && !map.contains(d));
+    }
+    Trace("Churn") {
+        Slot_Map<u64> map;
+        Vec<Slot_Handle> live;
+        RNG::Stream rng{11};
+        for(u64 i = 0; i < 10000; i++) {
+            if(live.empty() || rng.range(u64{0}, u64{3}) != 0) {
+                live.push(map.insert(i));
+                continue;
+            }
+            u64 idx = rng.range(u64{0}, live.length());
+            Slot_Handle handle = live[idx];
+            rpp::swap(live[idx], live.back());
+            live.pop();
+            map.erase(handle);
+            assert(!map.contains(handle));
+        }
+        assert(map.length() == live.length());
+        for(Slot_Handle handle : live) assert(map.contains(handle));
+
+        u64 dense = 0;
+        for(u64 value : map) dense += value;
+        u64 sum = 0;
+        for(Slot_Handle handle : live) sum += map.get(handle);
+        assert(dense == sum);
+    }
+    return 0;
+}
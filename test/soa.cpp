@@ -0,0 +1,49 @@
+#include "test.h"
+
+#include <rpp/soa.h>
+
+struct Particle {
+    f32 x, y, z;
+    u8 alive;
+    u64 id;
+};
+
+RPP_RECORD(Particle, RPP_FIELD(x), RPP_FIELD(y), RPP_FIELD(z), RPP_FIELD(alive), RPP_FIELD(id));
+
+i32 main() {
+    Test test{"empty"_v};
+    {
+        Soa_Vec<Particle> particles;
+        assert(particles.empty());
+        static_assert(Soa_Vec<Particle>::fields == 5);
+        static_assert(Soa_Vec<Particle>::index_of<"alive"> == 3);
+
+        for(u64 i = 0; i < 100; i++) {
+            particles.push(Particle{static_cast<f32>(i), 2.0f * i, 0.0f, 1, i});
+        }
+        assert(particles.length() == 100);
+
+        Slice<f32> xs = particles.slice<"x">();
+        assert(xs.length() == 100 && xs[10] == 10.0f);
+        assert(reinterpret_cast<u64>(particles.column<"id">()) % 64 == 0);
+
+        f32* ys = particles.column<"y">();
+        for(u64 i = 0; i < particles.length(); i++) ys[i] += 1.0f;
+
+        Particle p = particles[5];
+        assert(p.x == 5.0f && p.y == 11.0f && p.alive == 1 && p.id == 5);
+
+        particles[5].get<"alive">() = 0;
+        particles[6] = Particle{-1.0f, -1.0f, -1.0f, 0, 600};
+        assert(particles.get(5).alive == 0);
+        assert(particles[6].get<4>() == 600);
+
+        particles.swap_remove(0);
+        assert(particles.length() == 99 && particles.get(0).id == 99);
+
+        Soa_Vec<Particle> moved = move(particles);
+        assert(moved.length() == 99 && particles.empty());
+        assert(moved.slice<1>()[1] == 3.0f);
+    }
+    return 0;
+}
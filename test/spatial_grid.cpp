@@ -0,0 +1,110 @@
+
+#include "test.h"
+
+#include <rpp/rng.h>
+#include <rpp/spatial_grid.h>
+
+using namespace rpp::Math;
+
+[[nodiscard]] static f32 coord(RNG::Stream& rng) noexcept {
+    return static_cast<f32>(rng.range(0, 2000)) * 0.1f - 100.0f;
+}
+
+[[nodiscard]] static bool inside(const BBox& box, Vec3 p) noexcept {
+    return p.x >= box.min.x && p.y >= box.min.y && p.z >= box.min.z && p.x <= box.max.x &&
+           p.y <= box.max.y && p.z <= box.max.z;
+}
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Keys") {
+        RNG::Stream rng{2};
+        Vec<Vec3> points;
+        for(u64 i = 0; i < 1003; i++) points.push(Vec3{coord(rng), coord(rng), coord(rng)});
+
+        Spatial_Grid<> grid{2.5f};
+        grid.build(Slice{points});
+        assert(grid.buckets() == 1024 && grid.indices().length() == points.length());
+        for(u32 b = 0; b < grid.buckets(); b++) {
+            for(u32 i = grid.starts()[b]; i < grid.starts()[b + 1]; i++) {
+                Vec3 p = grid.points()[i];
+                assert(p == points[grid.indices()[i]]);
+                assert(grid.bucket(grid.cell(p)) == b);
+            }
+        }
+        assert(grid.starts()[grid.buckets()] == points.length());
+    }
+    Trace("Queries") {
+        RNG::Stream rng{1};
+        Vec<Vec3> points;
+        for(u64 i = 0; i < 5000; i++) points.push(Vec3{coord(rng), coord(rng), coord(rng)});
+
+        Spatial_Grid<> grid{4.0f};
+        grid.build(Slice{points});
+
+        Vec<u8> seen = Vec<u8>::make(points.length());
+        for(u64 q = 0; q < 100; q++) {
+            Vec3 center{coord(rng), coord(rng), coord(rng)};
+            f32 radius = static_cast<f32>(rng.range(1, 300)) * 0.1f;
+            for(u8& s : seen) s = 0;
+            u64 found = 0;
+            for(u32 i : grid.in_radius(center, radius)) {
+                assert(!seen[i]);
+                seen[i] = 1;
+                found++;
+            }
+            u64 expected = 0;
+            for(u64 i = 0; i < points.length(); i++) {
+                Vec3 d = points[i] - center;
+                bool hit = dot(d, d) <= radius * radius;
+                assert(hit == (seen[i] == 1));
+                expected += hit;
+            }
+            assert(found == expected);
+
+            BBox box{center, center + Vec3{radius, 2.0f * radius, 0.5f * radius}};
+            for(u8& s : seen) s = 0;
+            for(u32 i : grid.in_box(box)) {
+                assert(!seen[i]);
+                seen[i] = 1;
+            }
+            for(u64 i = 0; i < points.length(); i++) {
+                assert(inside(box, points[i]) == (seen[i] == 1));
+            }
+        }
+
+        // Covers more cells than there are buckets, so every point is scanned.
+        u64 all = 0;
+        for(u32 i : grid.in_box(BBox{Vec3{-1000.0f}, Vec3{1000.0f}})) all += i < points.length();
+        assert(all == points.length());
+
+        u64 none = 0;
+        for(u32 i : grid.in_box(BBox{})) none += i + 1;
+        assert(none == 0);
+    }
+    Trace("Pool") {
+        RNG::Stream rng{4};
+        Vec<Vec3> points;
+        for(u64 i = 0; i < 100000; i++) points.push(Vec3{coord(rng), coord(rng), coord(rng)});
+
+        Spatial_Grid<> serial{1.5f}, parallel{1.5f};
+        serial.build(Slice{points});
+        Async::Pool pool;
+        parallel.build(pool, Slice{points}).block();
+        assert(serial.buckets() == parallel.buckets());
+        for(u64 i = 0; i < serial.starts().length(); i++) {
+            assert(serial.starts()[i] == parallel.starts()[i]);
+        }
+        for(u64 i = 0; i < points.length(); i++) {
+            assert(serial.indices()[i] == parallel.indices()[i]);
+        }
+
+        // Rebuilding from fewer points reuses the grid.
+        parallel.build(pool, Slice{points}.sub(0, 10)).block();
+        assert(parallel.buckets() == 16 && parallel.indices().length() == 10);
+        u64 found = 0;
+        for(u32 i : parallel.in_radius(points[3], 0.0f)) found += i == 3;
+        assert(found == 1);
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+
+#include "test.h"
+
+#include <rpp/static_map.h>
+
+constexpr Static_Map SQUARES{Pair{1, 1}, Pair{2, 4}, Pair{3, 9}, Pair{4, 16}, Pair{5, 25}};
+
+constexpr Static_Map COMMANDS{Pair{Literal{"quit"}, 0}, Pair{Literal{"open"}, 1},
+                              Pair{Literal{"save"}, 2}, Pair{Literal{"close"}, 3}};
+
+constexpr auto SPREAD = [] {
+    Array<u64, 200> keys;
+    Array<u64, 200> values;
+    for(u64 i = 0; i < 200; i++) {
+        keys[i] = i * 7919;
+        values[i] = i;
+    }
+    return Static_Map<u64, u64, 200>{keys, values};
+}();
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Integers") {
+        static_assert(SQUARES.length() == 5);
+        for(i32 i = 1; i <= 5; i++) assert(SQUARES.get(i) == i * i);
+        assert(!SQUARES.contains(0) && !SQUARES.contains(6) && !SQUARES.try_get(-1).ok());
+        assert(*SQUARES.find(3) == 2 && SQUARES.key(2) == 3);
+
+        i32 sum = 0;
+        SQUARES.each([&](const i32&, const i32& value) { sum += value; });
+        assert(sum == 55);
+    }
+    Trace("Strings") {
+        assert(COMMANDS.get("quit"_v) == 0 && COMMANDS.get("close"_v) == 3);
+        assert(!COMMANDS.contains("load"_v) && !COMMANDS.contains("clos"_v));
+        assert(!COMMANDS.contains(""_v));
+        assert(COMMANDS.contains(Literal{"save"}));
+    }
+    Trace("Large") {
+        for(u64 i = 0; i < 200; i++) assert(SPREAD.get(i * 7919) == i);
+        for(u64 i = 0; i < 200; i++) assert(!SPREAD.contains(i * 7919 + 1));
+    }
+    Trace("Enum") {
+        assert(*Reflect::enum_from_name<Log::Level>("warn"_v) == Log::Level::warn);
+        assert(*Reflect::enum_from_name<Log::Level>("trace"_v) == Log::Level::trace);
+        assert(!Reflect::enum_from_name<Log::Level>("warning"_v).ok());
+        static_assert(Reflect::ENUM_NAMES<Log::Level>.length() == 5);
+    }
+    return 0;
+}
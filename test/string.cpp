@@ -29,6 +29,121 @@ i32 main() {
         (void)s4;
         (void)sv4;
     }
+    Trace("Small") {
+        String<> empty;
+        assert(empty.empty() && empty.capacity() == String<>::SMALL);
+
+        // Short text lives in the string itself and moves with it.
+        String<> key = "identifier_23_bytes_max"_v.string<Mdefault>();
+        assert(key.length() == 23 && key.capacity() == 23);
+        assert(key.data() == reinterpret_cast<const u8*>(&key));
+        String<> moved = move(key);
+        assert(key.empty() && moved.view() == "identifier_23_bytes_max"_v);
+        assert(moved.data() == reinterpret_cast<const u8*>(&moved));
+
+        String<> heap = "twenty four bytes long.."_v.string<Mdefault>();
+        assert(heap.capacity() == 24 && heap.data() != reinterpret_cast<const u8*>(&heap));
+        String<> copy = heap.clone();
+        assert(copy.view() == heap.view() && copy.data() != heap.data());
+
+        String<> grow{10};
+        grow.set_length(3);
+        assert(grow.write(0, "abc"_v) == 3 && grow.view() == "abc"_v);
+        String<> terminated = grow.terminate<Mdefault>();
+        assert(terminated.length() == 4 && terminated[3] == '\0');
+        assert(moved.view().append<Mdefault>(heap.view()).length() == 47);
+
+        Map<String<>, u64> map;
+        for(u64 i = 0; i < 100; i++) map.insert(format<Mdefault>("k%"_v, i), u64{i});
+        assert(map.get("k42"_v) == 42);
+        assert(format<Mdefault>("%"_v, moved) == moved.view());
+    }
+    Trace("Hash") {
+        static_assert(Hash::bytes("", 0) == 0x93228a4de0eec5a2ul);
+        static_assert(hash_literal("literal") == Hash::bytes("literal", 7));
+
+        String<> long_key{301};
+        long_key.set_length(301);
+        for(u64 i = 0; i < 301; i++) long_key[i] = static_cast<u8>('a' + i % 26);
+        for(u64 length = 0; length <= 300; length++) {
+            String_View prefix = long_key.sub(0, length);
+            assert(hash(prefix) == Hash::bytes(long_key.data(), length));
+            if(length) assert(hash(prefix) != hash(long_key.sub(1, length + 1)));
+        }
+        assert(hash(long_key) == hash(long_key.view()));
+    }
+
+    Trace("Search") {
+        // Long enough to exercise the 32 and 16 byte steps and the scalar tail.
+        String_View text = "key=value; other = thing; last_key=final_value, trailing text"_v;
+        assert(*text.find('=') == 3);
+        assert(*text.find(',') == 46);
+        assert(!text.find('#').ok());
+        assert(*text.find("_value"_v) == 40);
+        assert(*text.find("key"_v) == 0 && *text.find("last_key"_v) == 26);
+        assert(*text.find("text"_v) == text.length() - 4);
+        assert(!text.find("keys"_v).ok() && *text.find(""_v) == 0);
+        assert(*text.find_any(";,"_v) == 9 && *text.find_any(",x"_v) == 46);
+        assert(*text.find_any("!@#$%^&*()_"_v) == 30 && !text.find_any(""_v).ok());
+
+        for(u64 i = 0; i < text.length(); i++) {
+            String_View rest = text.sub(i, text.length());
+            Opt<u64> expected;
+            for(u64 j = 0; j < rest.length() && !expected.ok(); j++) {
+                if(rest[j] == 'e') expected = Opt<u64>{j};
+            }
+            Opt<u64> found = rest.find('e');
+            assert(found.ok() == expected.ok() && (!found.ok() || *found == *expected));
+            assert(rest.starts_with(rest.sub(0, rest.length() / 2)));
+            assert(rest.ends_with(rest.sub(rest.length() / 2, rest.length())));
+        }
+        assert(!"ab"_v.starts_with("abc"_v) && !"ab"_v.ends_with("b "_v));
+
+        String_View nul{reinterpret_cast<const u8*>("a\0b"), 3};
+        String_View nul_other{reinterpret_cast<const u8*>("a\0c"), 3};
+        assert(nul != nul_other && nul < nul_other);
+    }
+    Trace("Split") {
+        String_View pieces[] = {"a"_v, ""_v, "bc"_v, ""_v};
+        u64 i = 0;
+        for(String_View piece : "a,,bc,"_v.split(',')) assert(piece == pieces[i++]);
+        assert(i == 4);
+        i = 0;
+        for(String_View piece : ""_v.split(',')) {
+            assert(piece.empty());
+            i++;
+        }
+        assert(i == 1);
+    }
+    Trace("Case") {
+        assert(ascii::equal_ignore_case("Content-Length: 42 AND MORE"_v,
+                                        "content-length: 42 and more"_v));
+        assert(!ascii::equal_ignore_case("Content-Length: 42 AND MORE"_v,
+                                         "content-length: 42 and mord"_v));
+        assert(!ascii::equal_ignore_case("[@`{"_v, "{`@["_v));
+        for(u32 c = 0; c < 256; c++) {
+            u8 upper[16], lower[16];
+            for(u64 j = 0; j < 16; j++) {
+                upper[j] = static_cast<u8>(c);
+                lower[j] = ascii::to_lowercase(static_cast<u8>(c));
+            }
+            assert(ascii::equal_ignore_case(String_View{upper, 16}, String_View{lower, 16}));
+            if(lower[0] != upper[0]) {
+                assert(!(String_View{upper, 16} == String_View{lower, 16}));
+            }
+        }
+    }
+    Trace("UTF8") {
+        assert("plain ascii text that is longer than thirty two bytes"_v.valid_utf8());
+        String_View mixed = "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 and some padding after it"_v;
+        assert(mixed.valid_utf8());
+        assert(!"\xc0\xaf"_v.valid_utf8());
+        assert(!"\xe0\x80\xaf"_v.valid_utf8());
+        assert(!"\xed\xa0\x80"_v.valid_utf8());
+        assert(!"\xf4\x90\x80\x80"_v.valid_utf8());
+        assert(!"padding padding padding padding \xe2\x82"_v.valid_utf8());
+        assert(!"\x80"_v.valid_utf8() && ""_v.valid_utf8());
+    }
 
     return 0;
 }
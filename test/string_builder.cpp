@@ -0,0 +1,66 @@
+
+#include "test.h"
+
+#include <rpp/files.h>
+#include <rpp/string_builder.h>
+
+struct Entry {
+    u32 id;
+    bool live;
+};
+
+RPP_RECORD(Entry, RPP_FIELD(id), RPP_FIELD(live));
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Append") {
+        String_Builder<> builder{32};
+        assert(builder.empty());
+        builder.append("0123456789"_v);
+        builder.append("abcdefghijklmnopqrstuvwxyz"_v);
+        assert(builder.length() == 36 && builder.chunks().length() == 2);
+        assert(builder.chunks()[0].length() == 32);
+
+        // Formatted values never straddle chunks.
+        builder.append(u64{1234567});
+        builder.append(' ');
+        builder.append(Entry{7, true});
+        builder.format(" %% [%, %]", 1.5f, "x"_v);
+        String<> flat = builder.string();
+        assert(flat.sub(0, 36) == "0123456789abcdefghijklmnopqrstuvwxyz"_v);
+        assert(flat.sub(36, flat.length()) == "1234567 Entry{id : 7, live : true} % [1.5, x]"_v);
+        assert(flat.length() == builder.length());
+
+        u64 total = 0;
+        Vec<Slice<u8>> slices = builder.slices();
+        for(Slice<u8> slice : slices) total += slice.length();
+        assert(total == builder.length());
+
+        builder.clear();
+        assert(builder.empty() && builder.chunks().length() == 1);
+        builder.append("again"_v);
+        assert(builder.string().view() == "again"_v);
+    }
+    Trace("Large") {
+        String_Builder<> builder;
+        for(u64 i = 0; i < 5000; i++) builder.format("line %\n", i);
+        assert(builder.chunks().length() > 1);
+
+        String<> flat = builder.string();
+        u64 at = 0;
+        for(u64 i = 0; i < 5000; i++) {
+            String<> line = format<Mdefault>("line %\n"_v, i);
+            assert(flat.sub(at, at + line.length()) == line.view());
+            at += line.length();
+        }
+        assert(at == flat.length());
+
+        Vec<Slice<u8>> slices = builder.slices();
+        assert(Files::write("string_builder.out"_v, Slice<Slice<u8>>{slices}));
+        Opt<Vec<u8, Files::Alloc>> read = Files::read("string_builder.out"_v);
+        assert(read.ok() && read->length() == flat.length());
+        assert(Libc::memcmp(read->data(), flat.data(), flat.length()) == 0);
+        assert(Files::remove("string_builder.out"_v));
+    }
+    return 0;
+}
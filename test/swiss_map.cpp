@@ -0,0 +1,52 @@
+#include "test.h"
+
+#include <rpp/swiss_map.h>
+
+i32 main() {
+    Profile::begin_frame();
+    {
+        Test test{"empty"_v};
+        {
+            Swiss_Map<i32, i32> map;
+            assert(map.empty());
+            assert(!map.try_get(1).ok());
+
+            map.insert(1, 1);
+            map.insert(1, 2);
+            assert(map.length() == 1);
+            assert(map.get(1) == 2);
+            map.erase(1);
+            assert(!map.contains(1));
+        }
+        {
+            Swiss_Map<u64, String<>> map;
+            for(u64 i = 0; i < 1000; i++) {
+                map.insert(i, format<Mdefault>("%"_v, i));
+            }
+            assert(map.length() == 1000);
+            for(u64 i = 0; i < 1000; i += 2) {
+                assert(map.try_erase(i));
+            }
+            // Reuses tombstones and rehashes them away.
+            for(u64 i = 1000; i < 3000; i++) {
+                map.insert(i, format<Mdefault>("%"_v, i));
+                assert(map.try_erase(i));
+            }
+            assert(map.length() == 500);
+
+            u64 count = 0;
+            for(auto& [key, value] : map) {
+                assert(key % 2 == 1);
+                assert(value == format<Mdefault>("%"_v, key));
+                count++;
+            }
+            assert(count == 500);
+            for(u64 i = 0; i < 1000; i++) {
+                assert(map.contains(i) == (i % 2 == 1));
+            }
+        }
+    }
+    Profile::end_frame();
+    Profile::finalize();
+    return 0;
+}
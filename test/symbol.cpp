@@ -0,0 +1,53 @@
+
+#include "test.h"
+
+#include <rpp/thread.h>
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Symbol") {
+        Symbol a = Symbol::intern("alpha"_v);
+        Symbol b = Symbol::intern("beta"_v);
+        assert(a != b && !a.empty());
+        assert(Symbol::intern("alpha"_v.string().view()) == a);
+        assert(a.view() == "alpha"_v && b.view() == "beta"_v);
+        assert(a.hash() == hash("alpha"_v));
+
+        assert(Symbol{}.empty() && Symbol::intern(""_v).empty());
+        assert(Symbol{}.view().empty() && Symbol{}.hash() == hash(String_View{}));
+
+        assert(Symbol::find("gamma"_v).ok() == false);
+        assert(*Symbol::find("beta"_v) == b);
+
+        Map<Symbol, i32> map;
+        map.insert(a, 1);
+        map.insert(b, 2);
+        assert(map.get(Symbol::intern("beta"_v)) == 2);
+    }
+    Trace("Concurrent") {
+        constexpr u64 N = 2000;
+        Vec<Thread::Future<Vec<Symbol>>> tasks;
+        for(u64 t = 0; t < 4; t++) {
+            tasks.push(Thread::spawn([]() {
+                Vec<Symbol> symbols;
+                Region(R) {
+                    for(u64 i = 0; i < N; i++) {
+                        symbols.push(Symbol::intern(format<Mregion<R>>("symbol %"_v, i).view()));
+                    }
+                }
+                return symbols;
+            }));
+        }
+        Vec<Symbol> first = tasks[0]->block();
+        for(u64 t = 1; t < tasks.length(); t++) {
+            Vec<Symbol> other = tasks[t]->block();
+            for(u64 i = 0; i < N; i++) assert(other[i] == first[i]);
+        }
+        Region(R) {
+            for(u64 i = 0; i < N; i++) {
+                assert(first[i].view() == format<Mregion<R>>("symbol %"_v, i).view());
+            }
+        }
+    }
+    return 0;
+}
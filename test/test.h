@@ -8,13 +8,17 @@ using namespace rpp;
 struct Test {
     using Alloc = Mallocator<"Test">;
 
-    explicit Test(String_View name) : name(name) {
+    // Room for the longest expected log, so capturing doesn't allocate while the test runs.
+    constexpr static u64 CAPACITY = 1 << 16;
+
+    explicit Test(String_View name) : name(name), result(CAPACITY) {
         token = Log::subscribe(
             [&](Log::Level lvl, Thread::Id, Log::Time, Log::Location, String_View msg) {
-                auto m = format<Alloc>("[%] %\n"_v, lvl, msg);
-                for(u8 c : m) {
-                    result.push(c);
-                }
+                append("[Level::"_v);
+                append(level(lvl));
+                append("] "_v);
+                append(msg);
+                append("\n"_v);
             });
     }
     ~Test() {
@@ -23,17 +27,9 @@ struct Test {
         auto expect = name.append<Alloc>(".expect"_v);
         expected = move(*Files::read(expect.view()));
 
-        bool differs = false;
-        if(result.length() != expected.length()) {
-            differs = true;
-        } else {
-            for(u64 i = 0; i < result.length(); i++) {
-                if(result[i] != expected[i]) {
-                    differs = true;
-                    break;
-                }
-            }
-        }
+        bool differs = result.length() != expected.length() ||
+                       (result.length() &&
+                        Libc::memcmp(result.data(), expected.data(), result.length()) != 0);
 
         if(differs) {
             auto corrected = name.append<Alloc>(".corrected"_v);
@@ -42,6 +38,26 @@ struct Test {
         }
     }
 
+    void append(String_View text) {
+        u64 at = result.length();
+        if(at + text.length() > result.capacity()) {
+            result.reserve(Math::max(2 * result.capacity(), at + text.length()));
+        }
+        result.extend(text.length());
+        Libc::memcpy(result.data() + at, text.data(), text.length());
+    }
+
+    [[nodiscard]] static String_View level(Log::Level lvl) {
+        switch(lvl) {
+        case Log::Level::trace: return "trace"_v;
+        case Log::Level::debug: return "debug"_v;
+        case Log::Level::info: return "info"_v;
+        case Log::Level::warn: return "warn"_v;
+        case Log::Level::fatal: return "fatal"_v;
+        }
+        RPP_UNREACHABLE;
+    }
+
     String_View name;
     Vec<u8, Alloc> result;
     Vec<u8, Files::Alloc> expected;
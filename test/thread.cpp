@@ -35,5 +35,147 @@ i32 main() {
             task->block();
         }
     }
+    Trace("Pooled") {
+        u64 sum = 0;
+        for(u64 i = 0; i < 100; i++) {
+            sum += Thread::spawn(Thread::Spawn::pooled, [](u64 x) { return x; }, i)->block();
+        }
+        assert(sum == 4950);
+
+        // Each task waits for the one before it, so the pool has to grow instead of queueing.
+        Thread::Mutex mut;
+        Thread::Cond cond;
+        u64 turn = 0;
+        Vec<Thread::Future<void>> tasks;
+        for(u64 i = 8; i > 0; i--) {
+            tasks.push(Thread::spawn(Thread::Spawn::pooled, [&, i]() {
+                Thread::Lock lock{mut};
+                while(turn != i - 1) cond.wait(mut);
+                turn++;
+                cond.broadcast();
+            }));
+        }
+        for(auto& task : tasks) {
+            task->block();
+        }
+        assert(turn == 8);
+    }
+    Trace("Topology") {
+        auto processors = Thread::topology();
+        assert(processors.length() == Thread::hardware_threads());
+        for(u64 i = 0; i < processors.length(); i++) assert(processors[i].index == i);
+    }
+    Trace("Contention") {
+        static_assert(sizeof(Thread::Mutex) == 4 && sizeof(Thread::Cond) == 4);
+
+        Thread::Mutex mut;
+        Thread::Cond cond;
+        u64 count = 0;
+        u64 turn = 0;
+
+        Vec<Thread::Future<void>> tasks;
+        for(u64 i = 0; i < 4; i++) {
+            tasks.push(Thread::spawn([&, i]() {
+                for(u64 j = 0; j < 10000; j++) {
+                    Thread::Lock lock{mut};
+                    count++;
+                }
+                Thread::Lock lock{mut};
+                while(turn != i) cond.wait(mut);
+                turn++;
+                cond.broadcast();
+            }));
+        }
+        for(auto& task : tasks) {
+            task->block();
+        }
+        assert(count == 40000 && turn == 4);
+    }
+    Trace("Atomic") {
+        static_assert(sizeof(Thread::Atomic_Of<u8>) == 1);
+        static_assert(sizeof(Thread::Padded_Atomic<u32>) == 64);
+
+        Thread::Atomic_Of<u32> bits;
+        assert(bits.fetch_or(5, Thread::Order::relaxed) == 0);
+        assert(bits.fetch_and(4, Thread::Order::acq_rel) == 5 && bits.load() == 4);
+        assert(bits.fetch_xor(6) == 4 && bits.load(Thread::Order::acquire) == 2);
+
+        Thread::Atomic_Of<u8> small{250};
+        assert(small.fetch_sub(251) == 250 && small.load() == 255);
+
+        i32 target = 0;
+        Thread::Atomic_Of<i32*> ptr;
+        assert(ptr.compare_and_swap(null, &target, Thread::Order::acq_rel) == null);
+        assert(ptr.exchange(null) == &target);
+
+        struct Pair {
+            u32 a, b;
+        };
+        Thread::Atomic_Of<Pair> pair;
+        pair.store(Pair{1, 2}, Thread::Order::release);
+        assert(pair.load(Thread::Order::acquire).b == 2);
+
+        Thread::Padded_Atomic<i64> count;
+        Vec<Thread::Future<void>> tasks;
+        for(u64 i = 0; i < 4; i++) {
+            tasks.push(Thread::spawn([&count]() {
+                for(u64 j = 0; j < 10000; j++) count.incr(Thread::Order::relaxed);
+            }));
+        }
+        for(auto& task : tasks) {
+            task->block();
+        }
+        assert(count.load() == 40000);
+    }
+    Trace("RwLock") {
+        Thread::RwLock rw;
+        assert(rw.try_lock_shared() && rw.try_lock_shared());
+        assert(!rw.try_lock());
+        rw.unlock_shared();
+        rw.unlock_shared();
+        assert(rw.try_lock() && !rw.try_lock_shared());
+        rw.unlock();
+
+        u64 a = 0, b = 0;
+        Vec<Thread::Future<bool>> tasks;
+        for(u64 i = 0; i < 4; i++) {
+            tasks.push(Thread::spawn([&, i]() {
+                bool ok = true;
+                for(u64 j = 0; j < 10000; j++) {
+                    if(i == 0) {
+                        Thread::Exclusive_Lock lock{rw};
+                        a++;
+                        b++;
+                    } else {
+                        Thread::Shared_Lock lock{rw};
+                        ok = ok && a == b;
+                    }
+                }
+                return ok;
+            }));
+        }
+        for(auto& task : tasks) {
+            assert(task->block());
+        }
+        assert(a == 10000);
+    }
+    Trace("Seqlock") {
+        struct Snapshot {
+            u64 a = 0, b = 0;
+        };
+        Thread::Seqlock<Snapshot> seq;
+        assert(seq.read().a == 0);
+
+        auto writer = Thread::spawn([&seq]() {
+            for(u64 i = 1; i <= 10000; i++) seq.write(Snapshot{i, i});
+        });
+        u64 last = 0;
+        while(last < 10000) {
+            Snapshot pair = seq.read();
+            assert(pair.a == pair.b && pair.a >= last);
+            last = pair.a;
+        }
+        writer->block();
+    }
     return 0;
 }
@@ -0,0 +1,56 @@
+#include "test.h"
+
+#include <rpp/timer.h>
+
+using Wheel = Async::Timer_Wheel<u64>;
+
+i32 main() {
+    Test test{"empty"_v};
+    Trace("Order") {
+        Wheel wheel;
+        assert(wheel.empty() && wheel.next_deadline() == Wheel::NEVER);
+
+        u64 deadlines[] = {5, 1, 64, 63, 4096, 70, 262144, 300000, 20000000};
+        for(u64 deadline : deadlines) wheel.insert(deadline, u64{deadline});
+        assert(wheel.length() == 9);
+
+        Vec<u64> fired;
+        u64 last = 0;
+        while(!wheel.empty()) {
+            u64 next = wheel.next_deadline();
+            assert(next > wheel.now());
+            wheel.advance(next, [&](u64&& deadline) { fired.push(u64{deadline}); });
+            for(u64 deadline : fired) {
+                assert(deadline <= wheel.now() && deadline >= last);
+                last = deadline;
+            }
+            fired.clear();
+        }
+        assert(last == 20000000);
+    }
+    Trace("Advance") {
+        Wheel wheel;
+        wheel.advance(1000, [](u64&&) { assert(false); });
+        assert(wheel.now() == 1000);
+
+        // Deadlines in the past fire on the next tick.
+        wheel.insert(10, 0);
+        wheel.insert(1000, 1);
+        wheel.insert(1100, 2);
+        wheel.insert(5000, 3);
+
+        u64 count = 0;
+        wheel.advance(1099, [&](u64&& value) {
+            assert(value < 2);
+            count++;
+        });
+        assert(count == 2 && wheel.length() == 2);
+
+        wheel.advance(10000, [&](u64&& value) {
+            assert(value == count);
+            count++;
+        });
+        assert(count == 4 && wheel.empty());
+    }
+    return 0;
+}
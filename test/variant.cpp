@@ -3,6 +3,27 @@
 
 #include <rpp/variant.h>
 
+template<u64 I>
+struct Tag {
+    u64 value;
+};
+
+// Large variants dispatch through a switch; 40 alternatives still use a one byte index.
+template<u64... Is>
+static void check_tags(Index_Sequence<Is...>) noexcept {
+    using V = Variant<Tag<Is>...>;
+    static_assert(sizeof(V) == 2 * sizeof(u64));
+    u64 sum = 0;
+    auto check = [&]<u64 I>(Tag<I> tag) {
+        V v{move(tag)};
+        V w = move(v);
+        assert(w.index() == I);
+        sum += w.match([](const auto& t) { return t.value; });
+    };
+    (check(Tag<Is>{Is * 3}), ...);
+    assert(sum == 3 * (sizeof...(Is) * (sizeof...(Is) - 1) / 2));
+}
+
 i32 main() {
     Test test{"variant"_v};
     {
@@ -10,6 +31,7 @@ i32 main() {
             Variant<i8, i16, i32, i64, u8, u16, u32, u64, f32, f64> v{1.0f};
             v.match([](auto i) { info("variant has %", i); });
         }
+        check_tags(Make_Index_Sequence<40>{});
         {
             Variant<String<>> v{"Hello"_v.string()};
             auto s = move(v);
@@ -39,5 +39,121 @@ i32 main() {
         Mat4 inv = Mat4::inverse(m);
         assert(m == inv);
     }
+
+    Trace("Vec3A") {
+        Vec3 values[] = {Vec3{1.5f, -2.0f, 3.25f}, Vec3{0.0f, -0.0f, 1e-3f},
+                         Vec3{-7.0f, 100.0f, 0.1f}, Vec3{1e20f, -1e-20f, 3.0f}};
+        auto same = [](Vec3A a, Vec3 b) {
+            return Libc::memcmp(a.data, b.data, sizeof(b.data)) == 0;
+        };
+        for(Vec3 a : values) {
+            Vec3A A{a};
+            assert(A.to_vec3() == a && A == A);
+            assert(same(-A, Vec3{-a.x, -a.y, -a.z}));
+            assert(same(A.abs(), a.abs()));
+            assert(A.norm2() == a.norm2() && A.min() == a.min() && A.max() == a.max());
+            if(a.norm2() > 0.0f) assert(same(A.unit(), a.unit()));
+            for(Vec3 b : values) {
+                Vec3A B{b};
+                assert(same(A + B, a + b) && same(A - B, a - b));
+                assert(same(A * B, a * b) && same(A * 2.0f, a * 2.0f));
+                assert(same(A / 4.0f, a / 4.0f));
+                assert(same(cross(A, B), cross(a, b)));
+                assert(same(min(A, B), min(a, b)) && same(max(A, B), max(a, b)));
+                assert(dot(A, B) == dot(a, b));
+                assert((A == B) == (a == b));
+            }
+        }
+    }
+
+    Trace("Quat") {
+        constexpr Quat a{0.1f, -0.7f, 0.3f, 0.6f};
+        constexpr Quat b{-0.4f, 0.2f, 0.8f, 0.1f};
+        constexpr Vec3 v{1.0f, -2.0f, 3.0f};
+        constexpr Quat ab = a * b;
+        constexpr Mat4 m = a.to_mat();
+        constexpr Vec3 r = a.rotate(v);
+        Quat x = a, y = b;
+        assert(x * y == ab);
+        assert(x.to_mat() == m);
+        assert(x.rotate(v) == r);
+
+        auto near = [](Quat p, Quat q) {
+            Vec4 d = abs(Vec4{p.x, p.y, p.z, p.w} - Vec4{q.x, q.y, q.z, q.w});
+            return d.max() < 1e-5f;
+        };
+        Quat q = Quat::axis_angle(Vec3{1.0f, 2.0f, -0.5f}, 40.0f);
+        assert((q.rotate(v) - q.to_mat() * v).norm() < 1e-5f);
+        assert((q.rotate(v) - ((q * Quat{v, 0.0f}) * q.conjugate()).complex()).norm() < 1e-5f);
+        Quat scaled = q * 2.0f;
+        Vec3 product = ((scaled * Quat{v, 0.0f}) * scaled.conjugate()).complex();
+        assert((scaled.rotate(v) - product).norm() < 1e-4f);
+
+        Quat from = Quat::axis_angle(Vec3{0.0f, 0.0f, 1.0f}, 0.0f);
+        Quat to = Quat::axis_angle(Vec3{0.0f, 0.0f, 1.0f}, 90.0f);
+        assert(near(slerp(from, to, 0.0f), from) && near(slerp(from, to, 1.0f), to));
+        assert(near(slerp(from, to, 0.5f), Quat::axis_angle(Vec3{0.0f, 0.0f, 1.0f}, 45.0f)));
+        // The shorter arc of the same rotation.
+        assert(near(slerp(from, -to, 0.5f), Quat::axis_angle(Vec3{0.0f, 0.0f, 1.0f}, 45.0f)));
+        assert_near(slerp(q, q, 0.3f).norm(), 1.0f);
+
+        Vec<Quat> starts, ends;
+        for(u64 i = 0; i < 37; i++) {
+            f32 f = static_cast<f32>(i);
+            starts.push(Quat::axis_angle(Vec3{1.0f, f, 2.0f - f}, 10.0f * f));
+            Quat end = Quat::axis_angle(Vec3{f - 3.0f, 1.0f, 0.5f}, 170.0f - 9.0f * f);
+            // Opposite hemispheres, and pairs close enough to fall back to lerp.
+            if(i % 3 == 1) end = -end;
+            if(i % 5 == 2) end = Quat{starts[i].x + 1e-4f, starts[i].y, starts[i].z, starts[i].w};
+            ends.push(end);
+        }
+        Vec<Quat> out = Vec<Quat>::make(starts.length());
+        slerp(Slice{starts}, Slice{ends}, 0.3f, out.data());
+        for(u64 i = 0; i < starts.length(); i++) {
+            assert(out[i] == slerp(starts[i], ends[i], 0.3f));
+            assert_near(out[i].norm(), 1.0f);
+        }
+        for(Quat& end : ends) end = end * 3.0f;
+        normalize(Slice{ends}, out.data());
+        for(u64 i = 0; i < ends.length(); i++) assert(out[i] == ends[i].unit());
+    }
+
+    Trace("BatchTransform") {
+        Mat4 T = Mat4::translate(Vec3{1.0f, -2.0f, 3.0f}) *
+                 Mat4::rotate(30.0f, Vec3{1.0f, 1.0f, 0.0f}) * Mat4::scale(Vec3{2.0f, 0.5f, -1.0f});
+
+        Vec<Vec3> points;
+        Vec<Vec4> homogeneous;
+        Vec<BBox> boxes;
+        for(u64 i = 0; i < 37; i++) {
+            f32 f = static_cast<f32>(i);
+            points.push(Vec3{f, 0.5f * f - 3.0f, 7.0f - f});
+            homogeneous.push(Vec4{f, -f, 2.0f * f, 1.0f - 0.1f * f});
+            boxes.push(BBox{Vec3{-f, 1.0f, f - 4.0f}, Vec3{f, 2.0f + f, f}});
+        }
+
+        Vec<Vec3> out = Vec<Vec3>::make(points.length());
+        transform_points(T, Slice{points}, out.data());
+        for(u64 i = 0; i < points.length(); i++) assert(out[i] == T * points[i]);
+        transform_vectors(T, Slice{points}, out.data());
+        for(u64 i = 0; i < points.length(); i++) assert(out[i] == T.rotate(points[i]));
+
+        Vec<Vec4> out4 = Vec<Vec4>::make(homogeneous.length());
+        transform_points(T, Slice{homogeneous}, out4.data());
+        for(u64 i = 0; i < homogeneous.length(); i++) assert(out4[i] == T * homogeneous[i]);
+
+        Vec<BBox> out_boxes = Vec<BBox>::make(boxes.length());
+        transform_bboxes(T, Slice{boxes}, out_boxes.data());
+        for(u64 i = 0; i < boxes.length(); i++) {
+            BBox box = boxes[i];
+            box.transform(T);
+            assert(out_boxes[i].min == box.min && out_boxes[i].max == box.max);
+        }
+
+        // In place.
+        transform_points(T, Slice{points}, out.data());
+        transform_points(T, Slice{points}, points.data());
+        for(u64 i = 0; i < points.length(); i++) assert(points[i] == out[i]);
+    }
     return 0;
 }